@@ -86,6 +86,14 @@
  * @typedef hse_kvdb_txn
  * @brief Opaque structure, a pointer to which is a handle to a transaction
  *        within a KVDB.
+ *
+ * @typedef hse_kvs_pin
+ * @brief Opaque structure, a pointer to which is a handle to a value
+ *        obtained by hse_kvs_get_pinned()
+ *
+ * @typedef hse_kvs_load
+ * @brief Opaque structure, a pointer to which is a handle to a bulk load
+ *        started by hse_kvs_load_begin()
  */
 
 typedef uint64_t hse_err_t;
@@ -94,6 +102,8 @@ struct hse_kvdb;
 struct hse_kvs;
 struct hse_kvs_cursor;
 struct hse_kvdb_txn;
+struct hse_kvs_pin;
+struct hse_kvs_load;
 
 /**
  * @typedef hse_kvdb_opspec
@@ -102,15 +112,20 @@ struct hse_kvdb_txn;
  *
  * This structure may evolve as the HSE API grows. Failure to use the macro
  * HSE_KVDB_OPSPEC_INIT() to initialize an hse_kvdb_opspec will cause calls using it to
- * fail. Once init'd the programmer can freely manipulate the kop_flags and kop_txn
- * fields. Modifying kop_opaque or relying in any way on its structure will result in
- * undefined behavior.
+ * fail. Once init'd the programmer can freely manipulate the kop_flags, kop_txn
+ * and kop_ttl fields. Modifying kop_opaque or relying in any way on its structure
+ * will result in undefined behavior.
+ *
+ * A non-zero kop_ttl given to a put is the number of seconds after which the
+ * value expires.  An expired value reads as if the key had been deleted at the
+ * time of the put, and is dropped from media by compaction.
  */
 
 struct hse_kvdb_opspec {
     unsigned int         kop_opaque; /**< opaque data */
     unsigned int         kop_flags;  /**< opspec flags */
     struct hse_kvdb_txn *kop_txn;    /**< transaction context */
+    unsigned int         kop_ttl;    /**< put: seconds until the value expires */
 };
 
 #define HSE_KVDB_OPSPEC_INIT(os)       \
@@ -118,6 +133,7 @@ struct hse_kvdb_opspec {
         (os)->kop_opaque = 0xb0de0001; \
         (os)->kop_flags = 0x00000000;  \
         (os)->kop_txn = NULL;          \
+        (os)->kop_ttl = 0;             \
     } while (0)
 
 #define HSE_KVDB_KOP_FLAG_REVERSE 0x01     /**< reverse cursor */
@@ -386,6 +402,10 @@ hse_kvdb_kvs_close(struct hse_kvs *kvs);
  * second marked as PRIORITY is likely an issue. On the other hand, doing 1K small puts
  * per second marked as PRIORITY is almost certainly fine.
  *
+ * Setting kop_ttl in the opspec makes the value expire that many seconds after the
+ * put. Expiry is checked against the wall clock on each read, so it is accurate to
+ * about a second.
+ *
  * @param kvs:     KVS handle from hse_kvdb_kvs_open()
  * @param opspec:  Specification for put operation
  * @param key:     Key to put into kvs
@@ -404,6 +424,36 @@ hse_kvs_put(
     const void *            val,
     size_t                  val_len);
 
+/**
+ * Put a vector of KV pairs into KVS
+ *
+ * Semantically equivalent to calling hse_kvs_put() once for each KV pair in order, but
+ * the per-call overhead (health check, throttling, and c0 locking) is paid once for the
+ * whole batch. The number of KV pairs must be in the range [1, HSE_KVS_BATCH_MAX] and
+ * each key and value length is subject to the same limits as for hse_kvs_put(). The
+ * batch may not be part of a transaction, and it is not atomic: if an error is returned
+ * then some of the KV pairs may have been put. This function is thread safe.
+ *
+ * @param kvs:      KVS handle from hse_kvdb_kvs_open()
+ * @param opspec:   Specification for put operation
+ * @param count:    Number of KV pairs in the batch
+ * @param keys:     Vector of keys to put into kvs
+ * @param key_lens: Vector of key lengths
+ * @param vals:     Vector of values associated with keys
+ * @param val_lens: Vector of value lengths
+ * @return The function's error status
+ */
+/* MTF_MOCK */
+hse_err_t
+hse_kvs_put_batch(
+    struct hse_kvs *        kvs,
+    struct hse_kvdb_opspec *opspec,
+    unsigned int            count,
+    const void *const *     keys,
+    const size_t *          key_lens,
+    const void *const *     vals,
+    const size_t *          val_lens);
+
 /**
  * Retrieve the value for a given key from KVS
  *
@@ -435,6 +485,133 @@ hse_kvs_get(
     size_t                  buf_len,
     size_t *                val_len);
 
+/**
+ * Retrieve the values for a vector of keys from KVS
+ *
+ * Semantically equivalent to calling hse_kvs_get() once for each key, except that all
+ * keys are looked up at the same view of the KVS and the per-call overhead is paid once
+ * for the whole batch. For each key i, if the key exists in the KVS then found[i] is set
+ * to true, up to buf_lens[i] bytes of its value are copied into bufs[i], and the actual
+ * length of the value is placed in val_lens[i]. If bufs[i] is NULL and buf_lens[i] is
+ * zero then only found[i] and val_lens[i] are returned. The number of keys must be in the
+ * range [1, HSE_KVS_BATCH_MAX]. This function is thread safe.
+ *
+ * @param kvs:      KVS handle from hse_kvdb_kvs_open()
+ * @param opspec:   Specification for get operation
+ * @param count:    Number of keys in the batch
+ * @param keys:     Vector of keys to get from kvs
+ * @param key_lens: Vector of key lengths
+ * @param found:    [out] Vector of flags indicating whether each key was found
+ * @param bufs:     Vector of buffers into which the values will be copied
+ * @param buf_lens: Vector of buffer lengths
+ * @param val_lens: [out] Vector of actual value lengths for keys that were found
+ * @return The function's error status
+ */
+/* MTF_MOCK */
+hse_err_t
+hse_kvs_get_batch(
+    struct hse_kvs *        kvs,
+    struct hse_kvdb_opspec *opspec,
+    unsigned int            count,
+    const void *const *     keys,
+    const size_t *          key_lens,
+    bool *                  found,
+    void *const *           bufs,
+    const size_t *          buf_lens,
+    size_t *                val_lens);
+
+/**
+ * Completion callback for hse_kvs_get_async()
+ *
+ * @param arg:     Argument given to hse_kvs_get_async()
+ * @param err:     The get's error status
+ * @param found:   Whether or not key was found
+ * @param val_len: Actual length of value if key was found
+ */
+typedef void
+hse_kvs_get_cb(void *arg, hse_err_t err, bool found, size_t val_len);
+
+/**
+ * Retrieve the value for a given key from KVS asynchronously
+ *
+ * Semantically equivalent to hse_kvs_get(), except that the result is delivered by
+ * calling "cb". The key is looked up before this function returns. If its value must be
+ * read from media then the read is queued to a pool of KVS I/O threads (see the
+ * "cn_aget_threads" KVS run-time parameter) and "cb" is called from one of those threads
+ * once the value has been copied into "buf". Otherwise "cb" is called before this function
+ * returns. The buffer must remain valid until "cb" has been called, but the key need not.
+ * If this function returns an error then "cb" is not called. All outstanding gets must
+ * have completed before the KVS is closed. This function is thread safe.
+ *
+ * @param kvs:     KVS handle from hse_kvdb_kvs_open()
+ * @param opspec:  Specification for get operation
+ * @param key:     Key to get from kvs
+ * @param key_len: Length of key
+ * @param buf:     Buffer into which the value associated with key will be copied
+ * @param buf_len: Length of buffer
+ * @param cb:      Function to call upon completion
+ * @param arg:     Argument passed to cb
+ * @return The function's error status
+ */
+/* MTF_MOCK */
+hse_err_t
+hse_kvs_get_async(
+    struct hse_kvs *        kvs,
+    struct hse_kvdb_opspec *opspec,
+    const void *            key,
+    size_t                  key_len,
+    void *                  buf,
+    size_t                  buf_len,
+    hse_kvs_get_cb *        cb,
+    void *                  arg);
+
+/**
+ * Retrieve a read-only reference to the value for a given key from KVS
+ *
+ * Semantically equivalent to hse_kvs_get(), except that rather than copying the value
+ * into a caller supplied buffer the referent of "val" is set to point at the value and
+ * the referent of "pin" is set to a handle that must be passed to hse_kvs_pin_release()
+ * once the caller is done with the value. An uncompressed value that has been ingested
+ * into the KVS's persistent storage is referenced in place, avoiding a copy. Doing so
+ * holds off the reclamation of the storage which holds the value until the pin is
+ * released, or until the pin outlives the "cn_pin_lease" KVS run-time parameter (in
+ * milliseconds, 0 for no limit) after which "val" must no longer be dereferenced. All
+ * other values are copied into memory owned by the pin. If the key is not found then
+ * the referent of "pin" is set to NULL. Pins should be released before the KVS is
+ * closed; closing the KVS ends the lease of any pin still held, which must then still
+ * be released (but not concurrently with the close). This function is thread safe.
+ *
+ * @param kvs:     KVS handle from hse_kvdb_kvs_open()
+ * @param opspec:  Specification for get operation
+ * @param key:     Key to get from kvs
+ * @param key_len: Length of key
+ * @param found:   [out] Whether or not key was found
+ * @param val:     [out] Pointer to the value if key was found
+ * @param val_len: [out] Length of value if key was found
+ * @param pin:     [out] Handle by which to release the value if key was found
+ * @return The function's error status
+ */
+/* MTF_MOCK */
+hse_err_t
+hse_kvs_get_pinned(
+    struct hse_kvs *        kvs,
+    struct hse_kvdb_opspec *opspec,
+    const void *            key,
+    size_t                  key_len,
+    bool *                  found,
+    const void **           val,
+    size_t *                val_len,
+    struct hse_kvs_pin **   pin);
+
+/**
+ * Release a value obtained by hse_kvs_get_pinned()
+ *
+ * @param pin: Handle from hse_kvs_get_pinned(), may be NULL
+ */
+/* MTF_MOCK */
+void
+hse_kvs_pin_release(struct hse_kvs_pin *pin);
+
 /**
  * Delete the key and its associated value from KVS
  *
@@ -456,6 +633,44 @@ hse_kvs_delete(
     const void *            key,
     size_t                  key_len);
 
+/**
+ * struct hse_kvdb_write_op - a single put or delete in an hse_kvdb_write_batch()
+ */
+struct hse_kvdb_write_op {
+    struct hse_kvs *kwo_kvs;     /**< target KVS */
+    unsigned int    kwo_flags;   /**< write op flags */
+    const void *    kwo_key;     /**< key */
+    size_t          kwo_key_len; /**< length of key */
+    const void *    kwo_val;     /**< value (ignored for a delete) */
+    size_t          kwo_val_len; /**< length of value */
+};
+
+#define HSE_KVDB_WRITE_OP_FLAG_DELETE 0x01 /**< delete kwo_key rather than put */
+
+/**
+ * Apply a vector of puts and deletes to one or more KVSes
+ *
+ * Semantically equivalent to calling hse_kvs_put() or hse_kvs_delete() once for each
+ * write op in order, but the per-call overhead is paid once for the whole batch. Every
+ * KVS referenced by the batch must be open in the given KVDB. The number of write ops
+ * must be in the range [1, HSE_KVS_BATCH_MAX]. The batch may not be part of a
+ * transaction, and it is not atomic: if an error is returned then some of the write ops
+ * may have been applied. This function is thread safe.
+ *
+ * @param kvdb:   KVDB handle from hse_kvdb_open()
+ * @param opspec: Specification for write operation
+ * @param count:  Number of write ops in the batch
+ * @param ops:    Vector of write ops
+ * @return The function's error status
+ */
+/* MTF_MOCK */
+hse_err_t
+hse_kvdb_write_batch(
+    struct hse_kvdb *               kvdb,
+    struct hse_kvdb_opspec *        opspec,
+    unsigned int                    count,
+    const struct hse_kvdb_write_op *ops);
+
 /**
  * Delete all KV pairs matching the key prefix from a KVS storing multi-segment keys
  *
@@ -481,6 +696,193 @@ hse_kvs_prefix_delete(
     size_t                  filt_len,
     size_t *                kvs_pfx_len);
 
+/**
+ * Delete all KV pairs whose keys fall in the range [start_key, end_key) from a KVS
+ *
+ * The range is recorded as a single range tombstone, so the cost of the call does not
+ * depend on the number of keys in the range, and compaction later reclaims the deleted
+ * data without reading it. It is not an error if no keys exist in the range. Keys written
+ * after this call returns are not affected. Range deletes may not be part of a
+ * transaction. The range delete is durable when this call returns, which entails a
+ * sync of the KVDB's in-memory data (see hse_kvdb_sync()), so range deletes should be
+ * used to remove many keys at once rather than a few. This function is thread safe.
+ *
+ * @param kvs:       KVS handle from hse_kvdb_kvs_open()
+ * @param opspec:    KVDB op struct
+ * @param start_key: First key of the range (inclusive)
+ * @param start_len: Length of start_key
+ * @param end_key:   End of the range (exclusive), must be greater than start_key
+ * @param end_len:   Length of end_key
+ * @return The function's error status
+ */
+/* MTF_MOCK */
+hse_err_t
+hse_kvs_range_delete(
+    struct hse_kvs *        kvs,
+    struct hse_kvdb_opspec *opspec,
+    const void *            start_key,
+    size_t                  start_len,
+    const void *            end_key,
+    size_t                  end_len);
+
+/**
+ * User merge function for a KVS whose "merge_op" run-time parameter is "user"
+ *
+ * Apply one operand given to hse_kvs_merge() to the value it was merged into, writing
+ * the result to "out". The function must be deterministic and must not call back into
+ * HSE, as it may be called while a value is read or while the KVS is being compacted.
+ *
+ * @param arg:         Argument given to hse_kvs_merge_fn_set()
+ * @param key:         Key whose value is being merged
+ * @param key_len:     Length of key
+ * @param base:        Current value, or NULL if the key has no value
+ * @param base_len:    Length of base
+ * @param operand:     Operand to apply
+ * @param operand_len: Length of operand
+ * @param out:         Buffer into which the new value is to be written
+ * @param out_sz:      Size of out (HSE_KVS_VLEN_MAX)
+ * @param out_len:     [out] Length of the new value
+ * @return Zero on success, otherwise an errno value
+ */
+typedef int
+hse_kvs_merge_fn(
+    void *      arg,
+    const void *key,
+    size_t      key_len,
+    const void *base,
+    size_t      base_len,
+    const void *operand,
+    size_t      operand_len,
+    void *      out,
+    size_t      out_sz,
+    size_t *    out_len);
+
+/**
+ * Merge an operand into the value of a key in a KVS
+ *
+ * Rather than reading the current value, modifying it and writing it back (which
+ * requires a transaction to be safe against concurrent updates), the operand is stored
+ * as is and applied to the value by the KVS's merge operator when the key is next read,
+ * or when the KVS is compacted. The merge operator is selected by the "merge_op" KVS
+ * run-time parameter, which must not change across opens of a KVS that holds operands:
+ *
+ *   add:    operands and values are 8-byte little-endian signed integers to be summed
+ *   max:    operands and values are 8-byte little-endian unsigned integers, the largest
+ *           of which is kept
+ *   append: operands are appended to the value
+ *   user:   operands are applied by the function given to hse_kvs_merge_fn_set()
+ *
+ * A key without a value merges as if its value were zero (add, max), empty (append), or
+ * NULL (user). Merges may not be part of a transaction. This function is thread safe.
+ *
+ * @param kvs:         KVS handle from hse_kvdb_kvs_open()
+ * @param opspec:      KVDB op struct
+ * @param key:         Key whose value the operand is merged into
+ * @param key_len:     Length of key
+ * @param operand:     Operand to merge, at most HSE_KVS_MERGE_LEN_MAX bytes
+ * @param operand_len: Length of operand
+ * @return The function's error status
+ */
+/* MTF_MOCK */
+hse_err_t
+hse_kvs_merge(
+    struct hse_kvs *        kvs,
+    struct hse_kvdb_opspec *opspec,
+    const void *            key,
+    size_t                  key_len,
+    const void *            operand,
+    size_t                  operand_len);
+
+/**
+ * Set the user merge function of a KVS
+ *
+ * Must be called after hse_kvdb_kvs_open() and before the KVS is accessed if its
+ * "merge_op" run-time parameter is "user", as values cannot be read or compacted
+ * without it. This function is not thread safe.
+ *
+ * @param kvs: KVS handle from hse_kvdb_kvs_open()
+ * @param fn:  Merge function
+ * @param arg: Argument passed to fn
+ * @return The function's error status
+ */
+/* MTF_MOCK */
+hse_err_t
+hse_kvs_merge_fn_set(struct hse_kvs *kvs, hse_kvs_merge_fn *fn, void *arg);
+
+/**
+ * Start a bulk load of sorted keys into a KVS
+ *
+ * A bulk load writes keys given in strictly increasing order by hse_kvs_load_put()
+ * straight to media, bypassing the in-memory and journaling layers of the KVDB and the
+ * compactions that would follow. Nothing is visible to readers until the load is
+ * committed by hse_kvs_load_commit(), at which point all of it becomes visible at once.
+ * A load that is aborted, or interrupted by a crash, leaves no trace.
+ *
+ * The loaded values behave as if they were put when hse_kvs_load_begin() was called.
+ * Writes to the KVS made while a load is open must not fall within the range of keys
+ * loaded, else the commit fails. The load must be committed or aborted before the KVS
+ * is closed. If the opspec
+ * has a kop_ttl then every value in the load expires that many seconds after this call.
+ * Loads may not be part of a transaction. This function is thread safe.
+ *
+ * @param kvs:    KVS handle from hse_kvdb_kvs_open()
+ * @param opspec: KVDB op struct
+ * @param load:   [out] Bulk load handle
+ * @return The function's error status
+ */
+/* MTF_MOCK */
+hse_err_t
+hse_kvs_load_begin(
+    struct hse_kvs *        kvs,
+    struct hse_kvdb_opspec *opspec,
+    struct hse_kvs_load **  load);
+
+/**
+ * Add the next key and its value to a bulk load
+ *
+ * The key must be greater than the key given to the previous call. Keys compare as by
+ * memcmp(), with a key that is a prefix of another being the lesser. This function is
+ * not thread safe with respect to other calls on the same load.
+ *
+ * @param load:    Bulk load handle from hse_kvs_load_begin()
+ * @param key:     Key to put
+ * @param key_len: Length of key
+ * @param val:     Value to put
+ * @param val_len: Length of value
+ * @return The function's error status, EINVAL if the key is out of order
+ */
+/* MTF_MOCK */
+hse_err_t
+hse_kvs_load_put(
+    struct hse_kvs_load *load,
+    const void *         key,
+    size_t               key_len,
+    const void *         val,
+    size_t               val_len);
+
+/**
+ * Make the keys of a bulk load visible
+ *
+ * The load handle is freed whether or not the commit succeeds. A failed commit leaves
+ * no trace of the load. This function is thread safe.
+ *
+ * @param load: Bulk load handle from hse_kvs_load_begin()
+ * @return The function's error status, ESTALE if a key written to the KVS since the
+ *         load began may fall between the first and last keys of the load
+ */
+/* MTF_MOCK */
+hse_err_t
+hse_kvs_load_commit(struct hse_kvs_load *load);
+
+/**
+ * Discard a bulk load and free its handle
+ *
+ * @param load: Bulk load handle from hse_kvs_load_begin()
+ */
+/* MTF_MOCK */
+void
+hse_kvs_load_abort(struct hse_kvs_load *load);
+
 /**@}*/
 
 
@@ -808,6 +1210,51 @@ hse_kvs_cursor_read(
     size_t *                val_len,
     bool *                  eof);
 
+/**
+ * struct hse_kvs_cursor_kvoff - location of a KV pair within an hse_kvs_cursor_read_many()
+ *                               buffer
+ */
+struct hse_kvs_cursor_kvoff {
+    uint32_t kvo_koff; /**< offset of key within buffer */
+    uint32_t kvo_klen; /**< length of key */
+    uint32_t kvo_voff; /**< offset of value within buffer */
+    uint32_t kvo_vlen; /**< length of value */
+};
+
+/**
+ * Read a run of KV pairs from the cursor into a caller-provided buffer
+ *
+ * Semantically equivalent to calling hse_kvs_cursor_read() up to "max_cnt" times and
+ * copying each KV pair into "buf", but the per-call overhead is paid once for the whole
+ * run. Reading stops when "max_cnt" KV pairs have been read, when the next KV pair does
+ * not fit in what remains of "buf", or at EOF. A KV pair that does not fit is returned by
+ * the next read. If the next KV pair does not fit in "buf" at all then EMSGSIZE is
+ * returned and the cursor is not advanced; at most HSE_KVS_KLEN_MAX + HSE_KVS_VLEN_MAX
+ * bytes are required for any KV pair. Only the first 4GiB of "buf" is used. This
+ * function is thread safe across disparate cursors.
+ *
+ * @param cursor:  Cursor handle from hse_kvs_cursor_create()
+ * @param opspec:  Ignored; may be zero
+ * @param buf:     Buffer into which keys and values are copied
+ * @param buf_sz:  Size of buffer
+ * @param kvov:    [out] Vector of locations of each KV pair within buf
+ * @param max_cnt: Maximum number of KV pairs to read, the length of kvov
+ * @param cnt:     [out] Number of KV pairs read
+ * @param eof:     [out] If true, no more key/value pairs in sequence
+ * @return The function's error status
+ */
+/* MTF_MOCK */
+hse_err_t
+hse_kvs_cursor_read_many(
+    struct hse_kvs_cursor *      cursor,
+    struct hse_kvdb_opspec *     opspec,
+    void *                       buf,
+    size_t                       buf_sz,
+    struct hse_kvs_cursor_kvoff *kvov,
+    unsigned int                 max_cnt,
+    unsigned int *               cnt,
+    bool *                       eof);
+
 /**
  * Destroy cursor
  *
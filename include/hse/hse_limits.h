@@ -28,6 +28,14 @@
 /* Max value length is 1MiB */
 #define HSE_KVS_VLEN_MAX (1024 * 1024)
 
+/* Max number of keys in a single batched operation */
+#define HSE_KVS_BATCH_MAX (1024)
+
+/* Max merge operand length.  Operands are stored inline with the key
+ * metadata until they are folded into a value, so they must be small.
+ */
+#define HSE_KVS_MERGE_LEN_MAX (128)
+
 /* Max key prefix length */
 #define HSE_KVS_MAX_PFXLEN 32
 
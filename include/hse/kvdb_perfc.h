@@ -14,9 +14,17 @@ enum kvdb_perfc_sidx_kvdbop {
     PERFC_RA_KVDBOP_KVS_GET,
     PERFC_BA_KVDBOP_KVS_GETB,
     PERFC_RA_KVDBOP_KVS_CURSOR_READ,
+    PERFC_RA_KVDBOP_KVS_CURSOR_READ_MANY,
+    PERFC_RA_KVDBOP_KVS_GET_BATCH,
+    PERFC_RA_KVDBOP_KVS_GET_PINNED,
+    PERFC_RA_KVDBOP_KVS_GET_ASYNC,
 
     PERFC_RA_KVDBOP_KVS_PUT,
     PERFC_BA_KVDBOP_KVS_PUTB,
+    PERFC_RA_KVDBOP_KVS_PUT_BATCH,
+    PERFC_RA_KVDBOP_KVDB_WRITE_BATCH,
+    PERFC_RA_KVDBOP_KVS_LOAD,
+    PERFC_BA_KVDBOP_KVS_LOADB,
 
     PERFC_RA_KVDBOP_KVDB_SYNC,
 
@@ -34,6 +42,8 @@ enum kvdb_perfc_sidx_kvdbop {
 
     PERFC_RA_KVDBOP_KVS_DEL,
     PERFC_RA_KVDBOP_KVS_PFX_DEL,
+    PERFC_RA_KVDBOP_KVS_RANGE_DEL,
+    PERFC_RA_KVDBOP_KVS_MERGE,
     PERFC_RA_KVDBOP_KVS_PFXPROBE,
 
     PERFC_RA_KVDBOP_KVDB_FLUSH,
@@ -58,12 +68,25 @@ enum kvdb_perfc_sidx_c0skop {
     PERFC_LT_C0SKOP_PUT,
     PERFC_RA_C0SKOP_DEL,
     PERFC_LT_C0SKOP_DEL,
+    PERFC_RA_C0SKOP_FILTER_PROBE,
+    PERFC_RA_C0SKOP_FILTER_SKIP,
+    PERFC_RA_C0SKOP_PUT_LOCAL,
+    PERFC_RA_C0SKOP_PUT_REMOTE,
+    PERFC_RA_C0SKOP_GET_LOCAL,
+    PERFC_RA_C0SKOP_GET_REMOTE,
+    PERFC_RA_C0SKOP_NEGC_HIT,
+    PERFC_RA_C0SKOP_NEGC_MISS,
+    PERFC_RA_C0SKOP_NEGC_INSERT,
+    PERFC_RA_C0SKOP_NEGC_INVAL,
     PERFC_EN_C0SKOP
 };
 
 enum kvdb_perfc_sidx_c0sking {
     PERFC_BA_C0SKING_QLEN,
     PERFC_BA_C0SKING_WIDTH,
+    PERFC_BA_C0SKING_HEAP,
+    PERFC_BA_C0SKING_HUGETLB,
+    PERFC_BA_C0SKING_THP,
     PERFC_DI_C0SKING_KVMSDSIZE,
     PERFC_DI_C0SKING_PREP,
     PERFC_DI_C0SKING_FIN,
@@ -115,6 +138,9 @@ enum kvdb_perfc_sidx_cnget {
     PERFC_RA_CNGET_MISS,
     PERFC_LT_CNGET_MISS,
     PERFC_RA_CNGET_TOMB,
+    PERFC_RA_CNGET_FSKIP,
+    PERFC_RA_CNGET_PFXCHK,
+    PERFC_RA_CNGET_PFXSKIP,
     PERFC_EN_CNGET
 };
 
@@ -247,20 +273,34 @@ enum kvdb_perfc_sidx_cursordist {
     PERFC_EN_CD
 };
 
+enum kvdb_perfc_sidx_vcache {
+    PERFC_BA_VC_HIT,
+    PERFC_BA_VC_MISS,
+    PERFC_BA_VC_INSERT,
+    PERFC_BA_VC_EVICT,
+    PERFC_EN_VC
+};
+
 /* "PKVSL" stands for Public KVS interface Latencies" */
 enum kvdb_perfc_sidx_pkvsl {
     PERFC_LT_PKVSL_KVS_PUT,
     PERFC_LT_PKVSL_KVS_GET,
     PERFC_LT_PKVSL_KVS_DEL,
+    PERFC_LT_PKVSL_KVS_GET_BATCH,
+    PERFC_LT_PKVSL_KVS_GET_PINNED,
+    PERFC_LT_PKVSL_KVS_GET_ASYNC,
 
     PERFC_LT_PKVSL_KVS_PFX_PROBE,
     PERFC_LT_PKVSL_KVS_PFX_DEL,
+    PERFC_LT_PKVSL_KVS_RANGE_DEL,
+    PERFC_LT_PKVSL_KVS_MERGE,
 
     PERFC_LT_PKVSL_KVS_CURSOR_CREATE,
     PERFC_LT_PKVSL_KVS_CURSOR_UPDATE,
     PERFC_LT_PKVSL_KVS_CURSOR_SEEK,
     PERFC_LT_PKVSL_KVS_CURSOR_READFWD,
     PERFC_LT_PKVSL_KVS_CURSOR_READREV,
+    PERFC_LT_PKVSL_KVS_CURSOR_READMANY,
     PERFC_LT_PKVSL_KVS_CURSOR_DESTROY,
 
     PERFC_EN_PKVSL,
@@ -148,6 +148,7 @@ hse_kvs_prefix_probe_exp(
         case NOT_FOUND:
         case FOUND_PTMB:
         case FOUND_TMB:
+        case FOUND_MOP:
             *found = HSE_KVS_PFX_FOUND_ZERO;
             break;
 
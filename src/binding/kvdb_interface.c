@@ -13,6 +13,7 @@
 
 #include <hse_ikvdb/ikvdb.h>
 #include <hse_ikvdb/kvdb_ctxn.h>
+#include <hse_ikvdb/kvs.h>
 #include <hse_ikvdb/limits.h>
 #include <hse_ikvdb/kvdb_perfc.h>
 #include <hse_ikvdb/wp.h>
@@ -393,6 +394,128 @@ hse_kvs_put(
     return err;
 }
 
+static merr_t
+kvdb_batch_op_init(
+    struct ikvdb_batch_op *bo,
+    struct hse_kvs *       kvs,
+    const void *           key,
+    size_t                 key_len,
+    const void *           val,
+    size_t                 val_len,
+    bool                   tomb)
+{
+    if (unlikely( !kvs || !key || (!tomb && val_len > 0 && !val) ))
+        return merr(EINVAL);
+    if (unlikely( key_len > HSE_KVS_KLEN_MAX ))
+        return merr(ENAMETOOLONG);
+    if (unlikely( key_len == 0 ))
+        return merr(ENOENT);
+    if (unlikely( !tomb && val_len > HSE_KVS_VLEN_MAX ))
+        return merr(EMSGSIZE);
+
+    bo->bo_kvs = kvs;
+    bo->bo_tomb = tomb;
+
+    kvs_ktuple_init_nohash(&bo->bo_kt, key, key_len);
+    kvs_vtuple_init(&bo->bo_vt, tomb ? NULL : (void *)val, tomb ? 0 : val_len);
+
+    return 0;
+}
+
+hse_err_t
+hse_kvs_put_batch(
+    struct hse_kvs *        handle,
+    struct hse_kvdb_opspec *os,
+    unsigned int            count,
+    const void *const *     keys,
+    const size_t *          key_lens,
+    const void *const *     vals,
+    const size_t *          val_lens)
+{
+    struct ikvdb_batch_op *opv;
+    merr_t                 err;
+    u64                    sum;
+    uint                   i;
+
+    if (unlikely( !handle || !keys || !key_lens || !vals || !val_lens ))
+        return merr(EINVAL);
+    if (unlikely( os && (((os->kop_opaque >> 16) != 0xb0de) || ((os->kop_opaque & 0x0000ffff) != 1)) ))
+        return merr(EINVAL);
+    if (unlikely( count == 0 || count > HSE_KVS_BATCH_MAX ))
+        return merr(EINVAL);
+
+    opv = malloc(sizeof(*opv) * count);
+    if (ev(!opv))
+        return merr(ENOMEM);
+
+    for (i = sum = 0; i < count; ++i) {
+        err = kvdb_batch_op_init(opv + i, handle, keys[i], key_lens[i], vals[i], val_lens[i], false);
+        if (ev(err))
+            goto errout;
+
+        sum += key_lens[i] + val_lens[i];
+    }
+
+    PERFC_INCADD_RU(&kvdb_pc, PERFC_RA_KVDBOP_KVS_PUT_BATCH, PERFC_BA_KVDBOP_KVS_PUTB, sum, 128);
+
+    err = ikvdb_kvs_put_batch(handle, os, opv, count);
+
+errout:
+    free(opv);
+
+    return err;
+}
+
+hse_err_t
+hse_kvdb_write_batch(
+    struct hse_kvdb *               handle,
+    struct hse_kvdb_opspec *        os,
+    unsigned int                    count,
+    const struct hse_kvdb_write_op *ops)
+{
+    struct ikvdb_batch_op *opv;
+    merr_t                 err;
+    u64                    sum;
+    uint                   i;
+
+    if (unlikely( !handle || !ops ))
+        return merr(EINVAL);
+    if (unlikely( os && (((os->kop_opaque >> 16) != 0xb0de) || ((os->kop_opaque & 0x0000ffff) != 1)) ))
+        return merr(EINVAL);
+    if (unlikely( count == 0 || count > HSE_KVS_BATCH_MAX ))
+        return merr(EINVAL);
+
+    opv = malloc(sizeof(*opv) * count);
+    if (ev(!opv))
+        return merr(ENOMEM);
+
+    for (i = sum = 0; i < count; ++i) {
+        const struct hse_kvdb_write_op *op = ops + i;
+        bool tomb = op->kwo_flags & HSE_KVDB_WRITE_OP_FLAG_DELETE;
+
+        if (unlikely( op->kwo_flags & ~HSE_KVDB_WRITE_OP_FLAG_DELETE )) {
+            err = merr(EINVAL);
+            goto errout;
+        }
+
+        err = kvdb_batch_op_init(
+            opv + i, op->kwo_kvs, op->kwo_key, op->kwo_key_len, op->kwo_val, op->kwo_val_len, tomb);
+        if (ev(err))
+            goto errout;
+
+        sum += op->kwo_key_len + (tomb ? 0 : op->kwo_val_len);
+    }
+
+    PERFC_INCADD_RU(&kvdb_pc, PERFC_RA_KVDBOP_KVDB_WRITE_BATCH, PERFC_BA_KVDBOP_KVS_PUTB, sum, 128);
+
+    err = ikvdb_write_batch((struct ikvdb *)handle, os, opv, count);
+
+errout:
+    free(opv);
+
+    return err;
+}
+
 hse_err_t
 hse_kvs_get(
     struct hse_kvs *        handle,
@@ -450,6 +573,186 @@ hse_kvs_get(
     return 0UL;
 }
 
+hse_err_t
+hse_kvs_get_batch(
+    struct hse_kvs *        handle,
+    struct hse_kvdb_opspec *os,
+    unsigned int            count,
+    const void *const *     keys,
+    const size_t *          key_lens,
+    bool *                  found,
+    void *const *           bufs,
+    const size_t *          buf_lens,
+    size_t *                val_lens)
+{
+    struct kvs_ktuple *  ktv;
+    struct kvs_buf *     vbufv;
+    enum key_lookup_res *resv;
+    merr_t               err;
+    size_t               sz;
+    u64                  sum;
+    uint                 i;
+
+    if (unlikely( !handle || !keys || !key_lens || !found || !bufs || !buf_lens || !val_lens ))
+        return merr(EINVAL);
+    if (unlikely( os && (((os->kop_opaque >> 16) != 0xb0de) || ((os->kop_opaque & 0x0000ffff) != 1)) ))
+        return merr(EINVAL);
+    if (unlikely( count == 0 || count > HSE_KVS_BATCH_MAX ))
+        return merr(EINVAL);
+
+    sz = count * (sizeof(*ktv) + sizeof(*vbufv) + sizeof(*resv));
+
+    ktv = malloc(sz);
+    if (ev(!ktv))
+        return merr(ENOMEM);
+
+    vbufv = (void *)(ktv + count);
+    resv = (void *)(vbufv + count);
+
+    for (i = 0; i < count; ++i) {
+        void *valbuf = bufs[i];
+
+        if (unlikely( !keys[i] || (!valbuf && buf_lens[i] > 0) )) {
+            err = merr(EINVAL);
+            goto errout;
+        }
+        if (unlikely( key_lens[i] > HSE_KVS_KLEN_MAX )) {
+            err = merr(ENAMETOOLONG);
+            goto errout;
+        }
+        if (unlikely( key_lens[i] == 0 )) {
+            err = merr(ENOENT);
+            goto errout;
+        }
+
+        /* See hse_kvs_get() for why a probe uses a non-NULL valbuf. */
+        if (!valbuf && buf_lens[i] == 0)
+            valbuf = (void *)-1;
+
+        kvs_ktuple_init_nohash(ktv + i, keys[i], key_lens[i]);
+        kvs_buf_init(vbufv + i, valbuf, buf_lens[i]);
+    }
+
+    err = ikvdb_kvs_get_batch(handle, os, ktv, resv, vbufv, count);
+    if (ev(err))
+        goto errout;
+
+    sum = 0;
+
+    for (i = 0; i < count; ++i) {
+        if (ev(resv[i] == FOUND_MULTIPLE)) {
+            err = merr(EPROTO);
+            goto errout;
+        }
+
+        found[i] = (resv[i] == FOUND_VAL);
+        val_lens[i] = vbufv[i].b_len;
+
+        if (found[i])
+            sum += val_lens[i];
+    }
+
+    PERFC_INCADD_RU(&kvdb_pc, PERFC_RA_KVDBOP_KVS_GET_BATCH, PERFC_BA_KVDBOP_KVS_GETB, sum, 128);
+
+errout:
+    free(ktv);
+
+    return err;
+}
+
+hse_err_t
+hse_kvs_get_async(
+    struct hse_kvs *        handle,
+    struct hse_kvdb_opspec *os,
+    const void *            key,
+    size_t                  key_len,
+    void *                  valbuf,
+    size_t                  valbuf_sz,
+    hse_kvs_get_cb *        cb,
+    void *                  arg)
+{
+    struct kvs_ktuple kt;
+    struct kvs_buf    vbuf;
+    merr_t            err;
+
+    if (unlikely( !handle || !key || !cb ))
+        return merr(EINVAL);
+    if (unlikely( os && (((os->kop_opaque >> 16) != 0xb0de) || ((os->kop_opaque & 0x0000ffff) != 1)) ))
+        return merr(EINVAL);
+    if (unlikely( !valbuf && valbuf_sz > 0 ))
+        return merr(EINVAL);
+    if (unlikely( key_len > HSE_KVS_KLEN_MAX ))
+        return merr(ENAMETOOLONG);
+    if (unlikely( key_len == 0 ))
+        return merr(ENOENT);
+
+    /* See hse_kvs_get() for why a probe uses a non-NULL valbuf. */
+    if (!valbuf && valbuf_sz == 0)
+        valbuf = (void *)-1;
+
+    kvs_ktuple_init_nohash(&kt, key, key_len);
+    kvs_buf_init(&vbuf, valbuf, valbuf_sz);
+
+    err = ikvdb_kvs_get_async(handle, os, &kt, &vbuf, cb, arg);
+    if (ev(err))
+        return err;
+
+    PERFC_INC_RU(&kvdb_pc, PERFC_RA_KVDBOP_KVS_GET_ASYNC, 128);
+
+    return 0UL;
+}
+
+hse_err_t
+hse_kvs_get_pinned(
+    struct hse_kvs *        handle,
+    struct hse_kvdb_opspec *os,
+    const void *            key,
+    size_t                  key_len,
+    bool *                  found,
+    const void **           val,
+    size_t *                val_len,
+    struct hse_kvs_pin **   pin)
+{
+    struct kvs_ktuple   kt;
+    struct kvs_pin *    kpin;
+    enum key_lookup_res res;
+    merr_t              err;
+
+    if (unlikely( !handle || !key || !found || !val || !val_len || !pin ))
+        return merr(EINVAL);
+    if (unlikely( os && (((os->kop_opaque >> 16) != 0xb0de) || ((os->kop_opaque & 0x0000ffff) != 1)) ))
+        return merr(EINVAL);
+    if (unlikely( key_len > HSE_KVS_KLEN_MAX ))
+        return merr(ENAMETOOLONG);
+    if (unlikely( key_len == 0 ))
+        return merr(ENOENT);
+
+    kvs_ktuple_init_nohash(&kt, key, key_len);
+
+    err = ikvdb_kvs_get_pinned(handle, os, &kt, &res, &kpin);
+    if (ev(err))
+        return err;
+
+    if (ev(res == FOUND_MULTIPLE))
+        return merr(EPROTO);
+
+    *found = (res == FOUND_VAL);
+    *val = *found ? kpin->kp_data : NULL;
+    *val_len = *found ? kpin->kp_len : 0;
+    *pin = (struct hse_kvs_pin *)kpin;
+
+    PERFC_INCADD_RU(
+        &kvdb_pc, PERFC_RA_KVDBOP_KVS_GET_PINNED, PERFC_BA_KVDBOP_KVS_GETB, *val_len, 128);
+
+    return 0UL;
+}
+
+void
+hse_kvs_pin_release(struct hse_kvs_pin *pin)
+{
+    ikvdb_kvs_pin_release((struct kvs_pin *)pin);
+}
+
 /**
  * hse_kvs_delete() - remove the supplied key and associated value from the KVS
  */
@@ -507,6 +810,142 @@ hse_kvs_prefix_delete(
     return err;
 }
 
+hse_err_t
+hse_kvs_range_delete(
+    struct hse_kvs *        handle,
+    struct hse_kvdb_opspec *os,
+    const void *            start_key,
+    size_t                  start_len,
+    const void *            end_key,
+    size_t                  end_len)
+{
+    merr_t            err = 0;
+    struct kvs_ktuple start, end;
+
+    if (!handle || !start_key || !end_key)
+        err = merr(EINVAL);
+    else if (os && (((os->kop_opaque >> 16) != 0xb0de) || ((os->kop_opaque & 0x0000ffff) != 1)))
+        err = merr(EINVAL);
+    else if (start_len > HSE_KVS_KLEN_MAX || end_len > HSE_KVS_KLEN_MAX)
+        err = merr(ENAMETOOLONG);
+    else if (start_len == 0 || end_len == 0)
+        err = merr(ENOENT);
+
+    if (ev(err))
+        return err;
+
+    perfc_inc(&kvdb_pc, PERFC_RA_KVDBOP_KVS_RANGE_DEL);
+
+    kvs_ktuple_init_nohash(&start, start_key, start_len);
+    kvs_ktuple_init_nohash(&end, end_key, end_len);
+
+    err = ikvdb_kvs_range_delete(handle, os, &start, &end);
+
+    return err;
+}
+
+hse_err_t
+hse_kvs_merge(
+    struct hse_kvs *        handle,
+    struct hse_kvdb_opspec *os,
+    const void *            key,
+    size_t                  key_len,
+    const void *            operand,
+    size_t                  operand_len)
+{
+    struct kvs_ktuple kt;
+    merr_t            err = 0;
+
+    if (!handle || !key || !operand)
+        err = merr(EINVAL);
+    else if (os && (((os->kop_opaque >> 16) != 0xb0de) || ((os->kop_opaque & 0x0000ffff) != 1)))
+        err = merr(EINVAL);
+    else if (key_len > HSE_KVS_KLEN_MAX)
+        err = merr(ENAMETOOLONG);
+    else if (key_len == 0)
+        err = merr(ENOENT);
+    else if (operand_len == 0 || operand_len > HSE_KVS_MERGE_LEN_MAX)
+        err = merr(EINVAL);
+
+    if (ev(err))
+        return err;
+
+    perfc_inc(&kvdb_pc, PERFC_RA_KVDBOP_KVS_MERGE);
+
+    kvs_ktuple_init_nohash(&kt, key, key_len);
+
+    err = ikvdb_kvs_merge(handle, os, &kt, operand, operand_len);
+
+    return err;
+}
+
+hse_err_t
+hse_kvs_merge_fn_set(struct hse_kvs *handle, hse_kvs_merge_fn *fn, void *arg)
+{
+    if (ev(!handle || !fn))
+        return merr(EINVAL);
+
+    return ikvdb_kvs_merge_fn_set(handle, fn, arg);
+}
+
+hse_err_t
+hse_kvs_load_begin(
+    struct hse_kvs *        handle,
+    struct hse_kvdb_opspec *os,
+    struct hse_kvs_load **  load)
+{
+    if (ev(!handle || !load))
+        return merr(EINVAL);
+    if (ev(os && (((os->kop_opaque >> 16) != 0xb0de) || ((os->kop_opaque & 0x0000ffff) != 1))))
+        return merr(EINVAL);
+
+    return ikvdb_kvs_load_begin(handle, os, load);
+}
+
+hse_err_t
+hse_kvs_load_put(
+    struct hse_kvs_load *load,
+    const void *         key,
+    size_t               key_len,
+    const void *         val,
+    size_t               val_len)
+{
+    struct kvs_ktuple kt;
+    struct kvs_vtuple vt;
+
+    if (unlikely( !load || !key || (val_len > 0 && !val) ))
+        return merr(EINVAL);
+    if (unlikely( key_len > HSE_KVS_KLEN_MAX ))
+        return merr(ENAMETOOLONG);
+    if (unlikely( key_len == 0 ))
+        return merr(ENOENT);
+    if (unlikely( val_len > HSE_KVS_VLEN_MAX ))
+        return merr(EMSGSIZE);
+
+    PERFC_INCADD_RU(
+        &kvdb_pc, PERFC_RA_KVDBOP_KVS_LOAD, PERFC_BA_KVDBOP_KVS_LOADB, key_len + val_len, 128);
+
+    kvs_ktuple_init_nohash(&kt, key, key_len);
+    kvs_vtuple_init(&vt, (void *)val, val_len);
+
+    return ikvdb_kvs_load_put(load, &kt, &vt);
+}
+
+hse_err_t
+hse_kvs_load_commit(struct hse_kvs_load *load)
+{
+    if (ev(!load))
+        return merr(EINVAL);
+
+    return ikvdb_kvs_load_commit(load);
+}
+
+void
+hse_kvs_load_abort(struct hse_kvs_load *load)
+{
+    ikvdb_kvs_load_abort(load);
+}
+
 hse_err_t
 hse_kvdb_sync(struct hse_kvdb *handle)
 {
@@ -774,6 +1213,40 @@ hse_kvs_cursor_read(
     return err;
 }
 
+hse_err_t
+hse_kvs_cursor_read_many(
+    struct hse_kvs_cursor *      cursor,
+    struct hse_kvdb_opspec *     os,
+    void *                       buf,
+    size_t                       buf_sz,
+    struct hse_kvs_cursor_kvoff *kvov,
+    unsigned int                 max_cnt,
+    unsigned int *               cnt,
+    bool *                       eof)
+{
+    merr_t err;
+
+    if (ev(!cursor || !buf || !kvov || !cnt || !eof || max_cnt == 0))
+        return merr(EINVAL);
+    if (ev(os && (((os->kop_opaque >> 16) != 0xb0de) || ((os->kop_opaque & 0x0000ffff) != 1))))
+        return merr(EINVAL);
+
+    err = ikvdb_kvs_cursor_read_many(cursor, os, buf, buf_sz, kvov, max_cnt, cnt, eof);
+
+    if (!err && *cnt > 0) {
+        u64 sum = 0;
+        uint i;
+
+        for (i = 0; i < *cnt; ++i)
+            sum += kvov[i].kvo_klen + kvov[i].kvo_vlen;
+
+        PERFC_INCADD_RU(
+            &kvdb_pc, PERFC_RA_KVDBOP_KVS_CURSOR_READ_MANY, PERFC_BA_KVDBOP_KVS_GETB, sum, 128);
+    }
+
+    return err;
+}
+
 hse_err_t
 hse_kvs_cursor_destroy(struct hse_kvs_cursor *cursor)
 {
@@ -14,10 +14,18 @@
 
 struct perfc_name kvdb_perfc_op[] = {
     NE(PERFC_RA_KVDBOP_KVS_PUT, 1, "Count of kvs_put", "c_kvs_put(/s)"),
+    NE(PERFC_RA_KVDBOP_KVS_PUT_BATCH, 1, "Count of kvs_put_batch", "c_kvs_put_batch(/s)"),
+    NE(PERFC_RA_KVDBOP_KVDB_WRITE_BATCH, 1, "Count of kvdb_write_batch", "c_kvdb_write_batch(/s)"),
+    NE(PERFC_RA_KVDBOP_KVS_LOAD, 1, "Count of kvs_load_put", "c_kvs_load_put(/s)"),
     NE(PERFC_RA_KVDBOP_KVS_GET, 1, "Count of kvs_get", "c_kvs_get(/s)"),
+    NE(PERFC_RA_KVDBOP_KVS_GET_BATCH, 1, "Count of kvs_get_batch", "c_kvs_get_batch(/s)"),
+    NE(PERFC_RA_KVDBOP_KVS_GET_PINNED, 1, "Count of kvs_get_pinned", "c_kvs_get_pinned(/s)"),
+    NE(PERFC_RA_KVDBOP_KVS_GET_ASYNC, 1, "Count of kvs_get_async", "c_kvs_get_async(/s)"),
     NE(PERFC_RA_KVDBOP_KVS_DEL, 1, "Count of kvs_delete", "c_kvs_delete(/s)"),
     NE(PERFC_RA_KVDBOP_KVS_PFXPROBE, 1, "Count of kvs_prefix_probe", "c_kvs_prefix_probe(/s)"),
     NE(PERFC_RA_KVDBOP_KVS_PFX_DEL, 1, "Count of kvs_prefix_delete", "c_kvs_prefix_delete(/s)"),
+    NE(PERFC_RA_KVDBOP_KVS_RANGE_DEL, 1, "Count of kvs_range_delete", "c_kvs_range_delete(/s)"),
+    NE(PERFC_RA_KVDBOP_KVS_MERGE, 1, "Count of kvs_merge", "c_kvs_merge(/s)"),
     NE(PERFC_RA_KVDBOP_KVDB_SYNC, 1, "Count of kvdb_sync", "c_kvdb_sync(/s)"),
     NE(PERFC_RA_KVDBOP_KVDB_TXN_ALLOC, 1, "Count of kvdb_txn_alloc", "c_kvdb_txn_alloc(/s)"),
     NE(PERFC_RA_KVDBOP_KVDB_TXN_FREE, 1, "Count of kvdb_txn_free", "c_kvdb_txn_free(/s)"),
@@ -34,12 +42,17 @@ struct perfc_name kvdb_perfc_op[] = {
        "c_kvs_cursor_update(/s)"),
     NE(PERFC_RA_KVDBOP_KVS_CURSOR_SEEK, 1, "Count of kvs_cursor_seek", "c_kvs_cursor_seek(/s)"),
     NE(PERFC_RA_KVDBOP_KVS_CURSOR_READ, 1, "Count of kvs_cursor_read", "c_kvs_cursor_read(/s)"),
+    NE(PERFC_RA_KVDBOP_KVS_CURSOR_READ_MANY,
+       1,
+       "Count of kvs_cursor_read_many",
+       "c_kvs_cursor_read_many(/s)"),
     NE(PERFC_RA_KVDBOP_KVS_CURSOR_DESTROY,
        1,
        "Count of kvs_cursor_destroy",
        "c_kvs_cursor_destroy(/s)"),
 
     NE(PERFC_BA_KVDBOP_KVS_PUTB, 1, "Total puts size (bytes)", "c_kvs_put_bytes"),
+    NE(PERFC_BA_KVDBOP_KVS_LOADB, 1, "Total bulk load size (bytes)", "c_kvs_load_bytes"),
     NE(PERFC_BA_KVDBOP_KVS_GETB, 1, "Total gets size (bytes)", "c_kvs_get_bytes"),
 
     NE(PERFC_RA_KVDBOP_KVDB_MAKE, 3, "Count of kvdb_make", "c_kvdb_make(/s)"),
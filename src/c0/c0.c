@@ -111,6 +111,15 @@ c0_prefix_del(struct c0 *handle, struct kvs_ktuple *kt, u64 seqno)
     return c0sk_prefix_del(self->c0_c0sk, self->c0_index, kt, seqno);
 }
 
+merr_t
+c0_range_del(struct c0 *handle, struct kvs_ktuple *start, struct kvs_ktuple *end, u64 *seqno)
+{
+    struct c0_impl *self = c0_h2r(handle);
+
+    assert(self->c0_index < HSE_KVS_COUNT_MAX);
+    return c0sk_range_del(self->c0_c0sk, self->c0_index, start, end, seqno);
+}
+
 /*
  * Tombstone indicated by:
  *     return value == 0 && res == FOUND_TOMB
@@ -133,6 +142,38 @@ c0_get(
         self->c0_c0sk, self->c0_index, self->c0_pfx_len, kt, view_seqno, seqnoref, res, vbuf);
 }
 
+bool
+c0_miss_lookup(struct c0 *handle, const struct kvs_ktuple *kt, bool probe)
+{
+    struct c0_impl *self = c0_h2r(handle);
+
+    return c0sk_negc_lookup(self->c0_c0sk, self->c0_index, kt, probe);
+}
+
+void
+c0_miss_insert(struct c0 *handle, const struct kvs_ktuple *kt, bool probe, u64 view)
+{
+    struct c0_impl *self = c0_h2r(handle);
+
+    c0sk_negc_insert(self->c0_c0sk, self->c0_index, kt, probe, view);
+}
+
+void
+c0_vcache_set(struct c0 *handle, struct kvs_vcache *vc)
+{
+    struct c0_impl *self = c0_h2r(handle);
+
+    c0sk_vcache_set(self->c0_c0sk, self->c0_index, vc);
+}
+
+uint
+c0_vcache_insert(struct c0 *handle, struct kvs_ktuple *kt, u64 view, struct kvs_buf *vbuf)
+{
+    struct c0_impl *self = c0_h2r(handle);
+
+    return c0sk_vcache_insert(self->c0_c0sk, self->c0_index, kt, view, vbuf);
+}
+
 merr_t
 c0_pfx_probe(
     struct c0 *              handle,
@@ -301,6 +342,12 @@ c0_cursor_read(struct c0_cursor *c0cur, struct kvs_kvtuple *kvt, bool *eof)
     return ev(err);
 }
 
+u64
+c0_cursor_rtomb_lookup(struct c0_cursor *c0cur, const void *key, u32 klen)
+{
+    return c0sk_cursor_rtomb_lookup(c0cur, key, klen);
+}
+
 merr_t
 c0_cursor_save(struct c0_cursor *c0cur)
 {
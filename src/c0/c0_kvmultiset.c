@@ -42,6 +42,7 @@
  * @c0ms_ingest_work:   data used to orchestrate c0+cn ingest
  * @c0ms_destroy_work   work struct for c0kvms_destroy() offload
  * @c0ms_wq:            workqueue for c0kvms_destroy() offload
+ * @c0ms_index_work:    work struct for c0kvms_index_build()
  * @c0ms_refcnt:        used to manage the lifetime of the kvms
  * @c0ms_priv_cur:      current offset into priv memory pool
  * @c0ms_priv_cv:       used to synchronize with ingest processing
@@ -54,6 +55,9 @@
  * @c0ms_mutating:      used if c0ms_ingesting > 0
  * @c0ms_mut_tracked:   mutations tracked or not
  * @c0ms_mut_sz:        mutation size (in bytes)
+ * @c0ms_kvdb_seq:      ptr to kvdb seqno, for assigning rtomb seqnos
+ * @c0ms_rtomb_lock:    serializes range tombstone insertion
+ * @c0ms_rtombs:        list of range tombstones (newest first)
  * @c0ms_num_sets:      the number of c0 kvsets
  * @c0ms_resetsz:       size used by fully set up c0kvms
  * @c0ms_sets:          vector of c0 kvset pointers
@@ -75,6 +79,7 @@ struct c0_kvmultiset_impl {
     struct c0_ingest_work *  c0ms_ingest_work;
     struct workqueue_struct *c0ms_wq;
     struct work_struct       c0ms_destroy_work;
+    struct work_struct       c0ms_index_work;
 
     __aligned(SMP_CACHE_BYTES) atomic_t c0ms_refcnt;
 
@@ -93,6 +98,10 @@ struct c0_kvmultiset_impl {
     size_t c0ms_used;
     size_t c0ms_mut_sz;
 
+    atomic64_t *     c0ms_kvdb_seq;
+    spinlock_t       c0ms_rtomb_lock;
+    struct c0_rtomb *c0ms_rtombs;
+
     __aligned(SMP_CACHE_BYTES) u32 c0ms_num_sets;
     u32              c0ms_resetsz;
     struct c0_kvset *c0ms_sets[HSE_C0_INGEST_WIDTH_MAX];
@@ -155,6 +164,65 @@ c0kvms_finalize(struct c0_kvmultiset *handle, struct workqueue_struct *wq)
     self->c0ms_wq = wq;
 }
 
+static void
+c0kvms_index_cb(struct work_struct *work)
+{
+    struct c0_kvmultiset_impl *self;
+    int                        i;
+
+    self = container_of(work, struct c0_kvmultiset_impl, c0ms_index_work);
+
+    c0kvms_priv_wait(&self->c0ms_handle);
+
+    /* Skip the ptomb c0kvset, and stop early if the kvms has been
+     * ingested since it will soon have no readers.
+     */
+    for (i = 1; i < self->c0ms_num_sets; ++i) {
+        if (c0kvms_is_ingested(&self->c0ms_handle))
+            break;
+
+        c0kvs_index_build(self->c0ms_sets[i]);
+    }
+
+    c0kvms_putref(&self->c0ms_handle);
+}
+
+void
+c0kvms_index_build(struct c0_kvmultiset *handle, struct workqueue_struct *wq)
+{
+    struct c0_kvmultiset_impl *self = c0_kvmultiset_h2r(handle);
+
+    assert(self->c0ms_finalized);
+
+    c0kvms_getref(handle);
+
+    INIT_WORK(&self->c0ms_index_work, c0kvms_index_cb);
+    queue_work(wq, &self->c0ms_index_work);
+}
+
+void
+c0kvms_numa_bind(struct c0_kvmultiset *handle, uint nodec)
+{
+    struct c0_kvmultiset_impl *self = c0_kvmultiset_h2r(handle);
+    int                        i;
+
+    if (nodec < 2)
+        return;
+
+    for (i = 1; i < self->c0ms_num_sets; ++i)
+        c0kvs_numa_bind(self->c0ms_sets[i], (i - 1) % nodec);
+}
+
+void
+c0kvms_pfx_dedup(struct c0_kvmultiset *handle, const u8 *pfx_lenv)
+{
+    struct c0_kvmultiset_impl *self = c0_kvmultiset_h2r(handle);
+    int                        i;
+
+    for (i = 1; i < self->c0ms_num_sets; ++i)
+        c0kvs_pfx_dedup(self->c0ms_sets[i], pfx_lenv);
+}
+
 bool
 c0kvms_is_finalized(struct c0_kvmultiset *handle)
 {
@@ -211,6 +279,87 @@ c0kvms_rsvd_sn_get(struct c0_kvmultiset *handle)
     return self->c0ms_rsvd_sn;
 }
 
+merr_t
+c0kvms_rtomb_add(
+    struct c0_kvmultiset *   handle,
+    u16                      skidx,
+    const struct kvs_ktuple *start,
+    const struct kvs_ktuple *end,
+    u64 *                    seqno)
+{
+    struct c0_kvmultiset_impl *self = c0_kvmultiset_h2r(handle);
+    struct c0_rtomb *          rt;
+    atomic64_t *               sref;
+    char *                     keys;
+
+    assert(!c0kvms_is_finalized(handle));
+
+    /* Range tombstones are few and small, so keep them in the ptomb
+     * c0kvset where they are reclaimed along with the kvms.
+     */
+    rt = c0kvs_alloc(self->c0ms_sets[0], __alignof(*rt), sizeof(*rt) + start->kt_len + end->kt_len);
+    if (ev(!rt))
+        return merr(ENOMEM);
+
+    keys = rt->c0rt_keys;
+    memcpy(keys, start->kt_data, start->kt_len);
+    memcpy(keys + start->kt_len, end->kt_data, end->kt_len);
+
+    rt->c0rt_skidx = skidx;
+    rt->c0rt_rt.rt_start = keys;
+    rt->c0rt_rt.rt_slen = start->kt_len;
+    rt->c0rt_rt.rt_end = keys + start->kt_len;
+    rt->c0rt_rt.rt_elen = end->kt_len;
+
+    /* Like a ptomb, a range tombstone takes a new seqno so that it
+     * hides only the values written before it.
+     */
+    sref = self->c0ms_kvdb_seq;
+    if (unlikely(atomic64_read(&self->c0ms_seqno) != HSE_SQNREF_INVALID))
+        sref = &self->c0ms_seqno;
+
+    spin_lock(&self->c0ms_rtomb_lock);
+    rt->c0rt_rt.rt_seq = atomic64_add_return(1, sref);
+    rt->c0rt_next = self->c0ms_rtombs;
+    rcu_assign_pointer(self->c0ms_rtombs, rt);
+    spin_unlock(&self->c0ms_rtomb_lock);
+
+    *seqno = rt->c0rt_rt.rt_seq;
+
+    return 0;
+}
+
+u64
+c0kvms_rtomb_lookup(
+    struct c0_kvmultiset *handle,
+    u16                   skidx,
+    const void *          key,
+    u32                   klen,
+    u64                   view_seq)
+{
+    struct c0_rtomb *rt;
+    u64              seq = 0;
+
+    for (rt = c0kvms_rtombs(handle); rt; rt = rt->c0rt_next) {
+        if (rt->c0rt_skidx != skidx)
+            continue;
+
+        if (rt->c0rt_rt.rt_seq > seq && rt->c0rt_rt.rt_seq <= view_seq &&
+            rtomb_covers(&rt->c0rt_rt, key, klen))
+            seq = rt->c0rt_rt.rt_seq;
+    }
+
+    return seq;
+}
+
+struct c0_rtomb *
+c0kvms_rtombs(struct c0_kvmultiset *handle)
+{
+    struct c0_kvmultiset_impl *self = c0_kvmultiset_h2r(handle);
+
+    return rcu_dereference(self->c0ms_rtombs);
+}
+
 void
 c0kvms_rsvd_sn_set(struct c0_kvmultiset *handle, u64 seqno)
 {
@@ -303,6 +452,9 @@ c0kvms_usage(struct c0_kvmultiset *handle, struct c0_usage *usage)
         usage->u_tombs += u.u_tombs;
         usage->u_keyb += u.u_keyb;
         usage->u_valb += u.u_valb;
+        usage->u_lockops += u.u_lockops;
+        usage->u_lockcont += u.u_lockcont;
+        usage->u_lockwait += u.u_lockwait;
 
         if (i == 0)
             continue;
@@ -482,6 +634,9 @@ c0kvms_cursor_skip_pfx(struct c0_kvmultiset_cursor *cur, struct bonsai_kv *pt_bk
      * that matches. If not, skip seeking this kvms.
      */
 
+    /* Prefix tombstones are never split (see c0kvs_skey_pfx()). */
+    assert(!pt_bkv->bkv_pfx_len);
+
     klen = key_imm_klen(&pt_bkv->bkv_key_imm);
     iter = cur->c0mc_iterv;
 
@@ -685,8 +840,10 @@ c0kvms_cursor_update(struct c0_kvmultiset_cursor *cur, void *key, u32 klen, u32
      * return the duplicate.  Fix that here.
      */
     if (bin_heap2_peek(cur->c0mc_bh, (void **)&bkv)) {
+        struct key_obj ko, bko;
+
         if (bkv->bkv_es != cur->c0mc_esrcv[0] &&
-            !keycmp(key, klen, bkv->bkv_key, key_imm_klen(&bkv->bkv_key_imm)))
+            !key_obj_cmp(key2kobj(&ko, key, klen), bn_kv_kobj(bkv, &bko)))
             bin_heap2_pop(cur->c0mc_bh, (void **)&bkv);
     }
 
@@ -748,7 +905,7 @@ c0kvms_cursor_debug(struct c0_kvmultiset *handle, int skidx)
     void *                      item;
     merr_t                      err;
 
-    char disp[256];
+    char disp[256], kbuf[HSE_KVS_KLEN_MAX];
     int  max = sizeof(disp);
 
     /*
@@ -779,11 +936,11 @@ c0kvms_cursor_debug(struct c0_kvmultiset *handle, int skidx)
             if (cur.c0mc_esrcv[idx] == es)
                 break;
 
-        fmt_pe(disp, max, kv->bkv_key, len);
+        fmt_pe(disp, max, bn_kv_key(kv, kbuf), len);
         printf("es %2d: %3d, %s = ", idx, len, disp);
 
         for (v = kv->bkv_values; v; v = v->bv_next) {
-            len = v->bv_xlen;
+            len = bonsai_val_vlen(v);
             fmt_pe(disp, max, v->bv_value, len);
             printf(
                 "%s, len %d seqref 0x%lx%s",
@@ -933,6 +1090,9 @@ c0kvms_create(
     /* mark this seqno 'not in use'. */
     atomic64_set(&kvms->c0ms_seqno, HSE_SQNREF_INVALID);
 
+    kvms->c0ms_kvdb_seq = kvdb_seq;
+    spin_lock_init(&kvms->c0ms_rtomb_lock);
+
     /* The first kvset is reserved for ptombs and needn't be as large
      * as the rest, so we leverage it for the priv buffer.  Note that
      * we needn't fail the create if we cannot allocate all c0kvsets,
@@ -1059,6 +1219,9 @@ c0kvms_reset(struct c0_kvmultiset *handle)
     self->c0ms_ingested = false;
     self->c0ms_mutating = true;
 
+    /* The rtombs live in the ptomb c0kvset, which is reset below. */
+    self->c0ms_rtombs = NULL;
+
     resetsz = self->c0ms_resetsz;
 
     for (i = 0; i < self->c0ms_num_sets; ++i) {
@@ -9,9 +9,11 @@
 #include <hse_util/log2.h>
 #include <hse_util/fmt.h>
 #include <hse_util/compression_lz4.h>
+#include <hse_util/hash.h>
 
 #include <hse_ikvdb/limits.h>
 #include <hse_ikvdb/c0_kvset.h>
+#include <hse_ikvdb/c0sk.h>
 #include <hse_ikvdb/c0_kvset_iterator.h>
 
 #include "c0_kvset_internal.h"
@@ -52,6 +54,7 @@ struct c0kvs_cbkt {
  * struct c0kvs_ccache - cache of initialized cheap-based c0kvs objects
  * @cc_cbktv:   vector of cache buckets
  * @cc_init:    set to %true if initialized
+ * @cc_huge:    huge page backing for new cheaps (enum cheap_huge)
  *
  * Creating and destroying cheap-backed c0kvsets is relatively expensive,
  * so we keep a small cache of them ready for immediate use.  The cache
@@ -62,6 +65,7 @@ struct c0kvs_cbkt {
 struct c0kvs_ccache {
     struct c0kvs_cbkt cc_bktv[8];
     bool              cc_init;
+    uint              cc_huge;
 };
 
 static struct c0kvs_ccache c0kvs_ccache;
@@ -654,6 +658,105 @@ c0kvsm_init(struct c0_kvset *handle)
     set->c0s_mindex = 0;
 }
 
+/* Multiplier used to derive the filter bit positions from a key hash
+ * independently of the bits that select the c0kvset and filter block.
+ */
+#define C0KVS_FILTER_MULT (0x9e3779b97f4a7c15ull)
+
+/**
+ * c0kvs_filter_init() - size the membership filter for the c0kvset's capacity
+ * @set:    c0kvset
+ *
+ * The filter is retained across c0kvs_reset() and reuse from the cheap
+ * cache, and is reallocated only if the capacity grows.  If allocation
+ * fails the c0kvset simply runs without a filter.
+ */
+static void
+c0kvs_filter_init(struct c0_kvset_impl *set)
+{
+    size_t nblks, sz;
+
+    nblks = roundup_pow_of_two(max_t(size_t, set->c0s_alloc_sz >> C0KVS_FILTER_SHIFT, 1));
+    sz = nblks * C0KVS_FILTER_WORDS * sizeof(*set->c0s_filter);
+
+    if (sz > set->c0s_filter_sz) {
+        free_aligned(set->c0s_filter);
+
+        set->c0s_filter = alloc_aligned(sz, SMP_CACHE_BYTES, GFP_KERNEL);
+        set->c0s_filter_sz = 0;
+
+        if (ev(!set->c0s_filter)) {
+            set->c0s_filter_mask = 0;
+            return;
+        }
+
+        memset(set->c0s_filter, 0, sz);
+        set->c0s_filter_sz = sz;
+    }
+
+    set->c0s_filter_mask = nblks - 1;
+}
+
+static __always_inline atomic64_t *
+c0kvs_filter_block(struct c0_kvset_impl *self, u64 hash)
+{
+    return self->c0s_filter + ((hash >> 32) & self->c0s_filter_mask) * C0KVS_FILTER_WORDS;
+}
+
+/**
+ * c0kvs_filter_add() - add a key hash to the c0kvset's membership filter
+ * @self:   c0kvset
+ * @hash:   key hash (kt_hash)
+ *
+ * Must be called before the key is inserted into the bonsai tree, so that
+ * a reader that finds the key's bits clear cannot have missed the key.
+ * Bits that are already set are not written, to keep the blocks of hot
+ * keys shared among the cpus.
+ */
+static void
+c0kvs_filter_add(struct c0_kvset_impl *self, u64 hash)
+{
+    atomic64_t *blk;
+    int         i;
+
+    if (!self->c0s_filter)
+        return;
+
+    blk = c0kvs_filter_block(self, hash);
+    hash *= C0KVS_FILTER_MULT;
+
+    for (i = 0; i < C0KVS_FILTER_K; ++i, hash <<= 9) {
+        uint bit = hash >> 55;
+        long mask = 1ul << (bit % 64);
+
+        if (!(atomic64_read(blk + bit / 64) & mask))
+            atomic64_or(mask, blk + bit / 64);
+    }
+}
+
+bool
+c0kvs_may_contain(struct c0_kvset *handle, u64 hash)
+{
+    struct c0_kvset_impl *self = c0_kvset_h2r(handle);
+    atomic64_t *          blk;
+    int                   i;
+
+    if (!self->c0s_filter)
+        return true;
+
+    blk = c0kvs_filter_block(self, hash);
+    hash *= C0KVS_FILTER_MULT;
+
+    for (i = 0; i < C0KVS_FILTER_K; ++i, hash <<= 9) {
+        uint bit = hash >> 55;
+
+        if (!(atomic64_read(blk + bit / 64) & (1ul << (bit % 64))))
+            return false;
+    }
+
+    return true;
+}
+
 merr_t
 c0kvs_create(
     size_t            alloc_sz,
@@ -665,6 +768,7 @@ c0kvs_create(
     struct c0_kvset_impl *set;
     struct cheap *        cheap;
     merr_t                err;
+    int                   i;
 
     *handlep = NULL;
 
@@ -675,7 +779,7 @@ c0kvs_create(
     if (set)
         goto created;
 
-    cheap = cheap_create(sizeof(void *) * 2, HSE_C0_CHEAP_SZ_MAX);
+    cheap = cheap_create_huge(sizeof(void *) * 2, HSE_C0_CHEAP_SZ_MAX, c0kvs_ccache.cc_huge);
     if (ev(!cheap))
         return merr(ENOMEM);
 
@@ -687,11 +791,20 @@ c0kvs_create(
 
     set->c0s_alloc_sz = alloc_sz;
     set->c0s_cheap = cheap;
+    set->c0s_filter = NULL;
+    set->c0s_filter_sz = 0;
+    set->c0s_node = -1;
     set->c0s_ingesting = &c0kvs_ingesting;
     atomic_set(&set->c0s_finalized, 0);
     mutex_init(&set->c0s_mutex);
     mutex_init(&set->c0s_mlock);
 
+    for (i = 0; i < C0KVS_ARENA_MAX; ++i) {
+        spin_lock_init(&set->c0s_arenav[i].ca_lock);
+        set->c0s_arenav[i].ca_cur = NULL;
+        set->c0s_arenav[i].ca_end = NULL;
+    }
+
     err = bn_create(cheap, HSE_C0_BNODE_SLAB_SZ, c0kvs_ior_cb, set, &set->c0s_broot);
     if (ev(err)) {
         c0kvs_destroy_impl(set);
@@ -701,6 +814,11 @@ c0kvs_create(
     set->c0s_reset_sz = cheap_used(cheap);
 
 created:
+    c0kvs_filter_init(set);
+
+    set->c0s_pfx_lenv = NULL;
+    memset(set->c0s_pfxv, 0, sizeof(set->c0s_pfxv));
+
     set->c0s_kvdb_seqno = kvdb_seqno;
     set->c0s_kvms_seqno = kvms_seqno;
     set->c0s_mut_tracked = tracked;
@@ -718,6 +836,8 @@ c0kvs_destroy_impl(struct c0_kvset_impl *set)
     mutex_destroy(&set->c0s_mutex);
     mutex_destroy(&set->c0s_mlock);
 
+    free_aligned(set->c0s_filter);
+
     cheap_destroy(set->c0s_cheap);
 }
 
@@ -734,6 +854,38 @@ c0kvs_destroy(struct c0_kvset *handle)
     c0kvs_ccache_free(set);
 }
 
+void
+c0kvs_numa_bind(struct c0_kvset *handle, int node)
+{
+    struct c0_kvset_impl *self = c0_kvset_h2r(handle);
+
+    if (self->c0s_node == node)
+        return;
+
+    /* Leave the c0kvs unbound if mbind() fails (e.g., the node is
+     * offline or the process is confined by a cpuset).
+     */
+    self->c0s_node = cheap_bind(self->c0s_cheap, node) ? -1 : node;
+}
+
+void
+c0kvs_pfx_dedup(struct c0_kvset *handle, const u8 *pfx_lenv)
+{
+    struct c0_kvset_impl *self = c0_kvset_h2r(handle);
+
+    /* Mutation tracking hands raw key pointers to c1. */
+    if (self->c0s_mut_tracked)
+        return;
+
+    self->c0s_pfx_lenv = pfx_lenv;
+}
+
+int
+c0kvs_numa_node(struct c0_kvset *handle)
+{
+    return c0_kvset_h2r(handle)->c0s_node;
+}
+
 size_t
 c0kvs_used(struct c0_kvset *handle)
 {
@@ -758,6 +910,7 @@ void
 c0kvs_reset(struct c0_kvset *handle, size_t sz)
 {
     struct c0_kvset_impl *set;
+    int                   i;
 
     set = c0_kvset_h2r(handle);
 
@@ -765,8 +918,19 @@ c0kvs_reset(struct c0_kvset *handle, size_t sz)
 
     cheap_reset(set->c0s_cheap, max_t(size_t, sz, set->c0s_reset_sz));
 
+    for (i = 0; i < C0KVS_ARENA_MAX; ++i) {
+        set->c0s_arenav[i].ca_cur = NULL;
+        set->c0s_arenav[i].ca_end = NULL;
+    }
+
     bn_reset(set->c0s_broot);
 
+    if (set->c0s_filter)
+        memset(set->c0s_filter, 0, set->c0s_filter_sz);
+
+    /* The interned prefixes lived in the cheap. */
+    memset(set->c0s_pfxv, 0, sizeof(set->c0s_pfxv));
+
     atomic_set(&set->c0s_finalized, 0);
     set->c0s_ingesting = &c0kvs_ingesting;
     set->c0s_num_entries = 0;
@@ -774,6 +938,9 @@ c0kvs_reset(struct c0_kvset *handle, size_t sz)
     set->c0s_total_key_bytes = 0;
     set->c0s_total_value_bytes = 0;
     set->c0s_num_keys = 0;
+    set->c0s_lock_ops = 0;
+    set->c0s_lock_cont = 0;
+    set->c0s_lock_wait = 0;
 
     c0kvsm_init(handle);
 }
@@ -786,10 +953,22 @@ c0kvs_ingesting_init(struct c0_kvset *handle, atomic_t *ingesting)
     self->c0s_ingesting = ingesting;
 }
 
+/* Contended acquisitions and the time spent waiting for them are
+ * accumulated (under the lock) to guide the ingest width tuner.
+ */
 static __always_inline void
 c0kvs_lock(struct c0_kvset_impl *self)
 {
-    mutex_lock(&self->c0s_mutex);
+    u64 start;
+
+    if (!mutex_trylock(&self->c0s_mutex)) {
+        start = get_cycles();
+        mutex_lock(&self->c0s_mutex);
+        self->c0s_lock_wait += get_cycles() - start;
+        ++self->c0s_lock_cont;
+    }
+
+    ++self->c0s_lock_ops;
 }
 
 static __always_inline void
@@ -811,19 +990,189 @@ c0kvs_alloc(struct c0_kvset *handle, size_t align, size_t sz)
     return mem;
 }
 
+#define C0KVS_ARENA_ALIGN (sizeof(void *) * 2)
+
+/**
+ * c0kvs_arena_alloc() - allocate memory from this cpu's arena
+ * @self:   c0kvset
+ * @sz:     number of bytes required
+ * @arenap: (output) arena from which the memory was allocated
+ *
+ * Arenas are refilled from the c0kvset's cheap under %c0s_mutex, but
+ * otherwise allow callers to build kvs concurrently.  Returns NULL if
+ * the c0kvset hasn't enough space left for a new arena.
+ */
+static void *
+c0kvs_arena_alloc(struct c0_kvset_impl *self, size_t sz, struct c0kvs_arena **arenap)
+{
+    struct c0kvs_arena *arena;
+    void *              mem;
+
+    sz = ALIGN(sz, C0KVS_ARENA_ALIGN);
+
+    arena = self->c0s_arenav + (raw_smp_processor_id() % C0KVS_ARENA_MAX);
+
+    spin_lock(&arena->ca_lock);
+    if (unlikely((size_t)(arena->ca_end - arena->ca_cur) < sz)) {
+        spin_unlock(&arena->ca_lock);
+
+        mem = NULL;
+
+        c0kvs_lock(self);
+        if (C0KVS_ARENA_SZ + HSE_C0_BNODE_SLAB_SZ + PAGE_SIZE < c0kvs_avail(&self->c0s_handle))
+            mem = cheap_memalign(self->c0s_cheap, SMP_CACHE_BYTES, C0KVS_ARENA_SZ);
+        c0kvs_unlock(self);
+
+        if (!mem)
+            return NULL;
+
+        /* Whatever remains of the current region is abandoned, which
+         * is harmless even if another thread just refilled it.
+         */
+        spin_lock(&arena->ca_lock);
+        arena->ca_cur = mem;
+        arena->ca_end = mem + C0KVS_ARENA_SZ;
+    }
+
+    mem = arena->ca_cur;
+    arena->ca_cur += sz;
+    spin_unlock(&arena->ca_lock);
+
+    *arenap = arena;
+
+    return mem;
+}
+
+/**
+ * c0kvs_arena_free() - return the tail of an allocation to its arena
+ * @arena: arena from which @mem was allocated
+ * @mem:   start of the memory to release
+ * @end:   end of the original allocation
+ *
+ * The memory is reclaimed only if no one has allocated from the arena
+ * since, otherwise it remains in the cheap until the c0kvset is reset.
+ */
+static void
+c0kvs_arena_free(struct c0kvs_arena *arena, void *mem, void *end)
+{
+    spin_lock(&arena->ca_lock);
+    if (arena->ca_cur == end)
+        arena->ca_cur = mem;
+    spin_unlock(&arena->ca_lock);
+}
+
+/**
+ * c0kvs_pfx_intern() - find or create the interned copy of a key prefix
+ * @self:   c0kvset
+ * @key:    key whose first @plen bytes are the prefix
+ * @plen:   prefix length
+ * @locked: caller holds %c0s_mutex
+ *
+ * Entries are never removed before the c0kvset is reset, so lookups
+ * need no locking and concurrent inserts race only for empty slots.
+ *
+ * Return: the interned prefix, or NULL if none is available
+ */
+static const void *
+c0kvs_pfx_intern(struct c0_kvset_impl *self, const void *key, uint plen, bool locked)
+{
+    struct c0kvs_arena *arena = NULL;
+    struct c0kvs_pfx *  pfx, *new = NULL;
+    size_t              sz;
+    u64                 hash;
+    uint                i;
+
+    sz = sizeof(*new) + plen;
+    hash = hse_hash64(key, plen);
+
+    for (i = 0; i < C0KVS_PFX_PROBES; ++i) {
+        struct c0kvs_pfx **slot = self->c0s_pfxv + (hash + i) % C0KVS_PFX_SLOTS;
+
+        pfx = rcu_dereference(*slot);
+        if (!pfx) {
+            if (!new) {
+                if (locked)
+                    new = cheap_memalign(self->c0s_cheap, __alignof(*new), sz);
+                else
+                    new = c0kvs_arena_alloc(self, sz, &arena);
+                if (ev(!new))
+                    return NULL;
+
+                new->cp_len = plen;
+                memcpy(new->cp_data, key, plen);
+            }
+
+            pfx = atomic_ptr_cmpxchg((void **)slot, NULL, new);
+            if (pfx == new)
+                return new->cp_data;
+        }
+
+        if (pfx->cp_len == plen && !memcmp(pfx->cp_data, key, plen))
+            break;
+
+        pfx = NULL;
+    }
+
+    if (new && arena)
+        c0kvs_arena_free(arena, new, (void *)new + ALIGN(sz, C0KVS_ARENA_ALIGN));
+
+    return pfx ? pfx->cp_data : NULL;
+}
+
+/* Split a key around an interned copy of its kvs prefix, provided the
+ * c0kvset dedups prefixes and the prefix is longer than a pointer.
+ * Prefix tombstones are never split.
+ */
+static __always_inline void
+c0kvs_skey_pfx(struct c0_kvset_impl *self, struct bonsai_skey *skey, u16 skidx, bool locked)
+{
+    const void *pfx;
+    uint        plen;
+
+    if (!self->c0s_pfx_lenv)
+        return;
+
+    plen = self->c0s_pfx_lenv[skidx];
+    if (plen <= sizeof(void *) || plen >= key_imm_klen(&skey->bsk_key_imm))
+        return;
+
+    pfx = c0kvs_pfx_intern(self, skey->bsk_key, plen, locked);
+    if (pfx)
+        bn_skey_pfx(skey, pfx, plen);
+}
+
 static merr_t
 c0kvs_putdel(
     struct c0_kvset_impl *self,
     struct bonsai_skey *  skey,
     struct bonsai_sval *  sval,
+    u64                   hash,
     size_t                sz,
     bool                  tomb)
 {
-    merr_t err;
-    u64    avail;
+    struct c0kvs_arena *arena = NULL;
+    void *              mem = NULL;
+    size_t              prepsz;
+    merr_t              err;
+    u64                 avail;
+
+    /* Copy small keys and values into this cpu's arena before taking
+     * the lock, so that the critical section need only allocate and
+     * link tree nodes.
+     */
+    prepsz = bn_kv_prep_sz(skey, sval);
+    if (prepsz <= C0KVS_ARENA_PREPMAX) {
+        mem = c0kvs_arena_alloc(self, prepsz, &arena);
+        if (mem) {
+            bn_kv_prep(skey, sval, mem);
+            sz = 0;
+        }
+    }
 
     sz += HSE_C0_BNODE_SLAB_SZ + PAGE_SIZE;
 
+    c0kvs_filter_add(self, hash);
+
     c0kvs_lock(self);
     avail = c0kvs_avail(&self->c0s_handle);
 
@@ -833,6 +1182,15 @@ c0kvs_putdel(
         err = (sz > self->c0s_alloc_sz) ? merr(EFBIG) : merr(ENOMEM);
     c0kvs_unlock(self);
 
+    if (mem) {
+        void *end = mem + ALIGN(prepsz, C0KVS_ARENA_ALIGN);
+
+        if (err)
+            c0kvs_arena_free(arena, mem, end);
+        else if (!bn_kv_prep_used(sval))
+            c0kvs_arena_free(arena, mem + ALIGN(bn_kv_prep_kvoff(sval), C0KVS_ARENA_ALIGN), end);
+    }
+
     /* Callers putting keys into the active kvms must hold the
      * RCU read lock.  As such, a c0kvset undergoing ingest will
      * be finalized (i.e., frozen) the end of the grace period,
@@ -857,9 +1215,82 @@ c0kvs_put(
     struct bonsai_sval    sval;
 
     bn_skey_init(key->kt_data, key->kt_len, skidx, &skey);
+    c0kvs_skey_pfx(self, &skey, skidx, false);
     bn_sval_init(value->vt_data, value->vt_xlen, seqnoref, &sval);
+    sval.bsv_expiry = value->vt_expiry;
+
+    return c0kvs_putdel(
+        self, &skey, &sval, key->kt_hash, key->kt_len + kvs_vtuple_vlen(value), false);
+}
 
-    return c0kvs_putdel(self, &skey, &sval, key->kt_len + kvs_vtuple_vlen(value), false);
+static __always_inline size_t
+c0kvs_op_sz(const struct c0sk_batch_op *op)
+{
+    return op->op_kt.kt_len + (op->op_tomb ? 0 : kvs_vtuple_vlen(&op->op_vt));
+}
+
+merr_t
+c0kvs_putdelv(
+    struct c0_kvset *            handle,
+    struct c0sk_batch_op *const *opv,
+    uint                         opc,
+    uintptr_t                    seqnoref,
+    uint *                       nputp)
+{
+    struct c0_kvset_impl *self = c0_kvset_h2r(handle);
+    struct bonsai_skey    skey;
+    struct bonsai_sval    sval;
+    size_t                need, sz;
+    merr_t                err = 0;
+    u64                   avail;
+    uint                  i;
+
+    need = PAGE_SIZE;
+    for (i = 0; i < opc; ++i)
+        need += c0kvs_op_sz(opv[i]) + HSE_C0_BNODE_SLAB_SZ;
+
+    c0kvs_lock(self);
+    avail = c0kvs_avail(&self->c0s_handle);
+
+    for (i = 0; i < opc; ++i) {
+        const struct c0sk_batch_op *op = opv[i];
+
+        /* Fall back to checking each op only if the whole
+         * vector might not fit in what remains of the cheap.
+         */
+        if (unlikely(need >= avail)) {
+            sz = c0kvs_op_sz(op) + HSE_C0_BNODE_SLAB_SZ + PAGE_SIZE;
+
+            if (sz >= c0kvs_avail(&self->c0s_handle)) {
+                err = (sz > self->c0s_alloc_sz) ? merr(EFBIG) : merr(ENOMEM);
+                break;
+            }
+        }
+
+        bn_skey_init(op->op_kt.kt_data, op->op_kt.kt_len, op->op_skidx, &skey);
+        c0kvs_skey_pfx(self, &skey, op->op_skidx, true);
+
+        if (op->op_tomb)
+            bn_sval_init(HSE_CORE_TOMB_REG, 0, seqnoref, &sval);
+        else {
+            bn_sval_init(op->op_vt.vt_data, op->op_vt.vt_xlen, seqnoref, &sval);
+            sval.bsv_expiry = op->op_vt.vt_expiry;
+        }
+
+        c0kvs_filter_add(self, op->op_kt.kt_hash);
+
+        err = bn_insert_or_replace(self->c0s_broot, &skey, &sval, op->op_tomb);
+        if (ev(err))
+            break;
+    }
+    c0kvs_unlock(self);
+
+    /* See c0kvs_putdel() */
+    assert(atomic_read(&self->c0s_finalized) == 0);
+
+    *nputp = i;
+
+    return err;
 }
 
 merr_t
@@ -870,9 +1301,10 @@ c0kvs_del(struct c0_kvset *handle, u16 skidx, const struct kvs_ktuple *key, uint
     struct bonsai_sval    sval;
 
     bn_skey_init(key->kt_data, key->kt_len, skidx, &skey);
+    c0kvs_skey_pfx(self, &skey, skidx, false);
     bn_sval_init(HSE_CORE_TOMB_REG, 0, seqnoref, &sval);
 
-    return c0kvs_putdel(self, &skey, &sval, key->kt_len, true);
+    return c0kvs_putdel(self, &skey, &sval, key->kt_hash, key->kt_len, true);
 }
 
 merr_t
@@ -889,7 +1321,7 @@ c0kvs_prefix_del(
     bn_skey_init(key->kt_data, key->kt_len, skidx, &skey);
     bn_sval_init(HSE_CORE_TOMB_PFX, 0, seqnoref, &sval);
 
-    return c0kvs_putdel(self, &skey, &sval, key->kt_len, false);
+    return c0kvs_putdel(self, &skey, &sval, key->kt_hash, key->kt_len, false);
 }
 
 void
@@ -933,6 +1365,9 @@ c0kvs_usage(struct c0_kvset *handle, struct c0_usage *usage)
     usage->u_tombs = self->c0s_num_tombstones;
     usage->u_keyb = self->c0s_total_key_bytes;
     usage->u_valb = self->c0s_total_value_bytes;
+    usage->u_lockops = self->c0s_lock_ops;
+    usage->u_lockcont = self->c0s_lock_cont;
+    usage->u_lockwait = self->c0s_lock_wait;
     usage->u_count = 1;
 }
 
@@ -941,6 +1376,9 @@ c0kvs_usage(struct c0_kvset *handle, struct c0_usage *usage)
  *     return value == 0 && *res == FOUND_VAL && *oseqnoref == seqnoref of match
  * If tombstone is found:
  *     return value == 0 && *res == FOUND_TMB && *oseqnoref == seqnoref of match
+ * If merge operand is found:
+ *     return value == 0 && *res == FOUND_MOP && *oseqnoref == seqnoref of match
+ *         and vbuf->b_seq == ordinal seqno of match
  * If key is not found:
  *     return value == 0 && *res == NOT_FOUND &&
  *         *oseqnoref = HSE_ORDNL_TO_SQNREF(0) (invalid ordinal)
@@ -981,7 +1419,7 @@ c0kvs_get_excl(
 
     *oseqnoref = val->bv_seqnoref;
 
-    if (HSE_CORE_IS_TOMB(val->bv_valuep)) {
+    if (HSE_CORE_IS_TOMB(val->bv_valuep) || kvs_expired(val->bv_expiry)) {
         *res = FOUND_TMB;
         return 0;
     }
@@ -1013,6 +1451,11 @@ c0kvs_get_excl(
 
     *res = FOUND_VAL;
 
+    if (val->bv_xlen & HSE_XLEN_MOP) {
+        vbuf->b_seq = HSE_SQNREF_TO_ORDNL(val->bv_seqnoref);
+        *res = FOUND_MOP;
+    }
+
     return 0;
 }
 
@@ -1051,6 +1494,7 @@ c0kvs_pfx_probe_excl(
     struct bonsai_skey    skey;
     struct bonsai_kv *    kv;
     struct bonsai_val *   val;
+    char                  kvbuf[HSE_KVS_KLEN_MAX];
     bool                  found;
     u64                   val_seq;
     merr_t                err = 0;
@@ -1073,27 +1517,28 @@ c0kvs_pfx_probe_excl(
 
     /* found a key with the requested pfx */
     for (; kv != &root->br_kv; kv = rcu_dereference(kv->bkv_next)) {
-        u32 klen = key_imm_klen(&kv->bkv_key_imm);
+        u32         klen = key_imm_klen(&kv->bkv_key_imm);
+        const void *kdata = bn_kv_key(kv, kvbuf);
 
-        if (keycmp_prefix(key->kt_data, key->kt_len, kv->bkv_key, klen))
+        if (keycmp_prefix(key->kt_data, key->kt_len, kdata, klen))
             break; /* eof */
 
         if (qctx->seen &&
-            !keycmp(kv->bkv_key, klen,
+            !keycmp(kdata, klen,
                     kbuf->b_buf, min_t(size_t, kbuf->b_len, kbuf->b_buf_sz)))
             continue; /* duplicate */
 
         /* Skip key if there is a matching tomb */
-        if (qctx_tomb_seen(qctx, kv->bkv_key + key->kt_len, klen))
+        if (qctx_tomb_seen(qctx, kdata + key->kt_len, klen))
             continue;
 
         val = c0kvs_findval(handle, kv, view_seqno, seqnoref);
         if (!val)
             continue;
 
-        /* add to tomblist if a tombstone was encountered */
-        if (HSE_CORE_IS_TOMB(val->bv_valuep)) {
-            err = qctx_tomb_insert(qctx, kv->bkv_key + key->kt_len, klen);
+        /* add to tomblist if a tombstone (or an expired value) was encountered */
+        if (HSE_CORE_IS_TOMB(val->bv_valuep) || kvs_expired(val->bv_expiry)) {
+            err = qctx_tomb_insert(qctx, kdata + key->kt_len, klen);
             if (ev(err))
                 break;
 
@@ -1116,9 +1561,10 @@ c0kvs_pfx_probe_excl(
             /* copyout key and value */
             kbuf->b_len = klen;
             copylen = min_t(size_t, kbuf->b_len, kbuf->b_buf_sz);
-            memcpy(kbuf->b_buf, kv->bkv_key, copylen);
+            memcpy(kbuf->b_buf, kdata, copylen);
 
             vbuf->b_len = bonsai_val_vlen(val);
+            vbuf->b_seq = (val->bv_xlen & HSE_XLEN_MOP) ? val_seq : 0;
             copylen = vbuf->b_len;
 
             if (copylen > vbuf->b_buf_sz)
@@ -1228,6 +1674,18 @@ c0kvs_finalize(struct c0_kvset *handle)
     bn_finalize(self->c0s_broot);
 }
 
+void
+c0kvs_index_build(struct c0_kvset *handle)
+{
+    struct c0_kvset_impl *self = c0_kvset_h2r(handle);
+    merr_t                err;
+
+    assert(atomic_read(&self->c0s_finalized));
+
+    err = bn_index_build(self->c0s_broot);
+    ev(err);
+}
+
 void
 c0kvs_iterator_init(struct c0_kvset *handle, struct c0_kvset_iterator *iter, uint flags, int skidx)
 {
@@ -1244,7 +1702,7 @@ c0kvs_debug(struct c0_kvset *handle, void *key, int klen)
     struct bonsai_kv * kv, *end;
     struct bonsai_val *v;
 
-    char   disp[256];
+    char   disp[256], kbuf[HSE_KVS_KLEN_MAX];
     size_t max = sizeof(disp);
 
     printf("%p nkey %d ntomb %d\n", self, self->c0s_num_keys, self->c0s_num_tombstones);
@@ -1253,12 +1711,13 @@ c0kvs_debug(struct c0_kvset *handle, void *key, int klen)
     end = &self->c0s_broot->br_kv;
 
     for (kv = end->bkv_next; kv != end; kv = rcu_dereference(kv->bkv_next)) {
-        char *comma = "";
+        const void *kdata = bn_kv_key(kv, kbuf);
+        char *      comma = "";
 
-        if (klen && memcmp(key, kv->bkv_key, klen) != 0)
+        if (klen && memcmp(key, kdata, klen) != 0)
             continue;
 
-        fmt_hex(disp, max, kv->bkv_key, key_imm_klen(&kv->bkv_key_imm));
+        fmt_hex(disp, max, kdata, key_imm_klen(&kv->bkv_key_imm));
         printf("\t%s: ", disp);
 
         for (v = kv->bkv_values; v; v = rcu_dereference(v->bv_next)) {
@@ -1277,7 +1736,7 @@ c0kvs_debug(struct c0_kvset *handle, void *key, int klen)
 }
 
 void
-c0kvs_reinit(size_t cb_max)
+c0kvs_reinit(size_t cb_max, uint huge)
 {
     struct c0_kvset_impl *head, *next;
     struct c0kvs_cbkt *   bkt;
@@ -1286,6 +1745,8 @@ c0kvs_reinit(size_t cb_max)
     if (!c0kvs_ccache.cc_init)
         return;
 
+    c0kvs_ccache.cc_huge = min_t(uint, huge, CHEAP_HUGE_1G);
+
     cb_max = cb_max / C0KVS_CBKT_MAX;
 
     for (i = 0; i < C0KVS_CBKT_MAX; ++i) {
@@ -1330,7 +1791,7 @@ c0kvs_fini(void)
     if (atomic_dec_return(&c0kvs_init_ref) > 0)
         return;
 
-    c0kvs_reinit(0);
+    c0kvs_reinit(0, CHEAP_HUGE_NONE);
 }
 
 bool
@@ -1359,8 +1820,10 @@ c0kvs_preserve_tombspan(
     rcu_read_lock();
     found = bn_skiptombs_GE(self->c0s_broot, &skey_min, &kv);
     if (found) {
+        struct key_obj ko, kvko;
+
         assert(kv);
-        cmp = keycmp(kv->bkv_key, key_imm_klen(&kv->bkv_key_imm), kmax, kmax_len);
+        cmp = key_obj_cmp(bn_kv_kobj(kv, &kvko), key2kobj(&ko, kmax, kmax_len));
     }
     rcu_read_unlock();
 
@@ -11,6 +11,52 @@
 
 #define c0_kvset_h2r(handle) container_of(handle, struct c0_kvset_impl, c0s_handle)
 
+#define C0KVS_ARENA_MAX     (16)
+#define C0KVS_ARENA_SZ      (32 * 1024)
+#define C0KVS_ARENA_PREPMAX (C0KVS_ARENA_SZ / 8)
+
+/* The membership filter has one 64-byte block per (1 << C0KVS_FILTER_SHIFT)
+ * bytes of c0kvset capacity, and sets C0KVS_FILTER_K bits per key.
+ */
+#define C0KVS_FILTER_SHIFT  (13)
+#define C0KVS_FILTER_WORDS  (8)
+#define C0KVS_FILTER_K      (4)
+
+/* Interned key prefixes are found via an open addressed table of
+ * C0KVS_PFX_SLOTS entries, of which at most C0KVS_PFX_PROBES are
+ * examined per lookup.
+ */
+#define C0KVS_PFX_SLOTS     (256)
+#define C0KVS_PFX_PROBES    (8)
+
+/**
+ * struct c0kvs_pfx - an interned key prefix
+ * @cp_len:  prefix length
+ * @cp_data: prefix bytes
+ *
+ * Keys that share a prefix store a pointer to one copy of it rather
+ * than the prefix itself (see bn_skey_pfx()).
+ */
+struct c0kvs_pfx {
+    u32  cp_len;
+    char cp_data[];
+};
+
+/**
+ * struct c0kvs_arena - per-cpu allocation region carved from a c0kvset's cheap
+ * @ca_lock:    protects @ca_cur and @ca_end
+ * @ca_cur:     next free byte in the region
+ * @ca_end:     end of the region
+ *
+ * Small puts build their bonsai kv and value in an arena (see bn_kv_prep())
+ * so that only the tree update itself is serialized by %c0s_mutex.
+ */
+struct c0kvs_arena {
+    spinlock_t ca_lock;
+    void *     ca_cur;
+    void *     ca_end;
+} __aligned(SMP_CACHE_BYTES);
+
 /**
  * c0_kvset_impl - private representation of a c0 kvset
  * @c0s_handle:            handle for users of struct c0_kvset_impl's
@@ -21,6 +67,10 @@
  * @c0s_finalized:         kvset is frozen and undergoing c0 ingest
  * @c0s_reset_sz:          size of cheap used by fully setup c0kkvs
  * @c0s_next:              cheap cache linkage
+ * @c0s_filter:            blocked bloom filter over the hashes of all keys
+ * @c0s_filter_mask:       number of blocks in @c0s_filter minus one
+ * @c0s_filter_sz:         bytes allocated for @c0s_filter
+ * @c0s_pfx_lenv:          per-skidx prefix lengths to intern (may be NULL)
  * @c0s_kvdb_seqno:        pointer to kvdb seqno
  * @c0s_kvms_seqno:        pointer to kvms seqno
  * @c0s_total_key_bytes:   total # of key bytes
@@ -35,6 +85,8 @@
  * @c0s_txpend:            tx pending list
  * @c0s_mut_tracked:       whether mutations tracked or not
  * @c0s_mindex:            mutation index
+ * @c0s_arenav:            per-cpu arenas for building kvs outside %c0s_mutex
+ * @c0s_pfxv:              table of interned key prefixes
  *
  * Note:  To improve performance in the face of heavy contention, %c0s_mutex
  * is laid out so that it straddles two cache lines:  The lock word and other
@@ -54,6 +106,11 @@ struct c0_kvset_impl {
     atomic_t              c0s_finalized;
     u32                   c0s_reset_sz;
     struct c0_kvset_impl *c0s_next;
+    atomic64_t *          c0s_filter;
+    u32                   c0s_filter_mask;
+    size_t                c0s_filter_sz;
+    const u8 *            c0s_pfx_lenv;
+    int                   c0s_node;
 
     /* these apply only to non-txn operations. */
     atomic64_t *c0s_kvdb_seqno;
@@ -65,6 +122,9 @@ struct c0_kvset_impl {
     u32          c0s_num_keys;
     u32          c0s_num_tombstones;
     u64          c0s_pad;
+    ulong        c0s_lock_ops;
+    ulong        c0s_lock_cont;
+    u64          c0s_lock_wait;
     struct mutex c0s_mutex;
 
     __aligned(SMP_CACHE_BYTES) struct mutex c0s_mlock;
@@ -75,6 +135,10 @@ struct c0_kvset_impl {
 
     __aligned(SMP_CACHE_BYTES) bool c0s_mut_tracked;
     u8 c0s_mindex;
+
+    struct c0kvs_arena c0s_arenav[C0KVS_ARENA_MAX];
+
+    __aligned(SMP_CACHE_BYTES) struct c0kvs_pfx *c0s_pfxv[C0KVS_PFX_SLOTS];
 };
 
 #endif
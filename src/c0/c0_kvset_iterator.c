@@ -191,6 +191,7 @@ c0_kvset_iterator_seek(
         kv = &iter->c0it_root->br_kv;
 
     if (kt) {
+        assert(!kv->bkv_pfx_len);
         kt->kt_len = key_imm_klen(&kv->bkv_key_imm);
         kt->kt_data = kv->bkv_key;
     }
@@ -208,6 +209,27 @@ c0_kvset_iterator_seek(
     rcu_read_unlock();
 }
 
+void
+c0_kvset_iterator_seek_skey(struct c0_kvset_iterator *iter, const struct bonsai_skey *skey)
+{
+    struct bonsai_kv *kv = NULL;
+
+    assert(!(iter->c0it_flags & C0_KVSET_ITER_FLAG_REVERSE));
+
+    rcu_read_lock();
+
+    if (!bn_findGE(iter->c0it_root, skey, &kv))
+        kv = &iter->c0it_root->br_kv;
+
+    iter->c0it_handle.es_eof = false;
+    iter->c0it_next = kv;
+    iter->c0it_prev = kv->bkv_prev;
+
+    __builtin_prefetch(kv->bkv_values);
+
+    rcu_read_unlock();
+}
+
 void
 c0_kvset_iterator_skip_pfx(
     struct c0_kvset_iterator *iter,
@@ -232,6 +254,7 @@ c0_kvset_iterator_skip_pfx(
         kv = &iter->c0it_root->br_kv;
 
     if (kt) {
+        assert(!kv->bkv_pfx_len);
         kt->kt_len = key_imm_klen(&kv->bkv_key_imm);
         kt->kt_data = kv->bkv_key;
     }
@@ -329,6 +329,9 @@ c0kvsm_add_txpend(
     size_t sfx_len;
     size_t hashlen;
 
+    /* Mutation tracking disables prefix dedup (see c0kvs_pfx_dedup()). */
+    assert(!bkv->bkv_pfx_len);
+
     klen = key_imm_klen(&bkv->bkv_key_imm);
     set = c0skm_get_perfc_kv(c0skm);
     cn = c0sk_get_cn(c0skm->c0skm_c0skh, skidx);
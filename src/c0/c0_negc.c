@@ -0,0 +1,294 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2015-2020 Micron Technology, Inc.  All rights reserved.
+ */
+
+#include <hse_util/platform.h>
+#include <hse_util/alloc.h>
+#include <hse_util/slab.h>
+#include <hse_util/atomic.h>
+#include <hse_util/spinlock.h>
+#include <hse_util/log2.h>
+#include <hse_util/minmax.h>
+#include <hse_util/event_counter.h>
+
+#include "c0_negc.h"
+
+#define NEGC_SHARDS (16)
+#define NEGC_SLOTS  (4)
+#define NEGC_KICKS  (8)
+
+/**
+ * struct negc_bkt - a cuckoo filter bucket
+ * @nb_floor: misses observed at views older than this may not be inserted
+ * @nb_tagv:  key tags, zero if the slot is empty
+ */
+struct negc_bkt {
+    u64 nb_floor;
+    u64 nb_tagv[NEGC_SLOTS];
+};
+
+/**
+ * struct negc_shard - an independently locked partition of the filter
+ * @ns_lock: protects all fields
+ * @ns_mask: number of buckets minus one
+ * @ns_kick: rotor used to choose cuckoo victims
+ * @ns_bktv: buckets
+ */
+struct negc_shard {
+    spinlock_t       ns_lock;
+    u32              ns_mask;
+    u32              ns_kick;
+    struct negc_bkt *ns_bktv;
+} __aligned(SMP_CACHE_BYTES);
+
+struct c0_negc {
+    atomic64_t        nc_floor;
+    atomic_t          nc_busy;
+    struct negc_shard nc_shardv[NEGC_SHARDS];
+};
+
+static inline struct negc_shard *
+negc_shard(struct c0_negc *nc, u64 tag)
+{
+    return nc->nc_shardv + (tag >> 60) % NEGC_SHARDS;
+}
+
+/* The two candidate buckets of a tag differ by an odd offset, so they
+ * are always distinct, and each is the alternate of the other.
+ */
+static inline u32
+negc_alt(const struct negc_shard *ns, u64 tag)
+{
+    return ((tag >> 32) | 1) & ns->ns_mask;
+}
+
+static bool
+negc_bkt_find(const struct negc_bkt *bkt, u64 tag)
+{
+    int i;
+
+    for (i = 0; i < NEGC_SLOTS; ++i)
+        if (bkt->nb_tagv[i] == tag)
+            return true;
+
+    return false;
+}
+
+static bool
+negc_bkt_add(struct negc_bkt *bkt, u64 tag)
+{
+    int i;
+
+    for (i = 0; i < NEGC_SLOTS; ++i) {
+        if (!bkt->nb_tagv[i]) {
+            bkt->nb_tagv[i] = tag;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void
+negc_floor_raise(atomic64_t *floor, u64 seq)
+{
+    u64 old = atomic64_read(floor);
+
+    while (old < seq) {
+        u64 cur = atomic64_cmpxchg(floor, old, seq);
+
+        if (cur == old)
+            break;
+        old = cur;
+    }
+}
+
+bool
+c0_negc_lookup(struct c0_negc *nc, u64 tag)
+{
+    struct negc_shard *ns = negc_shard(nc, tag);
+    u32                b;
+    bool               found;
+
+    spin_lock(&ns->ns_lock);
+    b = tag & ns->ns_mask;
+    found = negc_bkt_find(ns->ns_bktv + b, tag) ||
+            negc_bkt_find(ns->ns_bktv + (b ^ negc_alt(ns, tag)), tag);
+    spin_unlock(&ns->ns_lock);
+
+    return found;
+}
+
+bool
+c0_negc_insert(struct c0_negc *nc, u64 tag, u64 view)
+{
+    struct negc_shard *ns = negc_shard(nc, tag);
+    struct negc_bkt *  b1, *b2, *bkt;
+    int                i;
+
+    if (atomic_read(&nc->nc_busy) > 0)
+        return false;
+
+    smp_rmb();
+
+    if (view < atomic64_read(&nc->nc_floor))
+        return false;
+
+    spin_lock(&ns->ns_lock);
+    b1 = ns->ns_bktv + (tag & ns->ns_mask);
+    b2 = ns->ns_bktv + ((tag & ns->ns_mask) ^ negc_alt(ns, tag));
+
+    if (view < b1->nb_floor || view < b2->nb_floor) {
+        spin_unlock(&ns->ns_lock);
+        return false;
+    }
+
+    if (negc_bkt_find(b1, tag) || negc_bkt_find(b2, tag) || negc_bkt_add(b1, tag) ||
+        negc_bkt_add(b2, tag)) {
+        spin_unlock(&ns->ns_lock);
+        return true;
+    }
+
+    /* Both buckets are full, so displace a victim to its alternate
+     * bucket, and so on.  If that doesn't settle within a few kicks
+     * then the last victim is simply forgotten.
+     */
+    bkt = (ns->ns_kick & 1) ? b2 : b1;
+
+    for (i = 0; i < NEGC_KICKS; ++i) {
+        u32 slot = ns->ns_kick++ % NEGC_SLOTS;
+        u64 victim = bkt->nb_tagv[slot];
+
+        bkt->nb_tagv[slot] = tag;
+        tag = victim;
+
+        bkt = ns->ns_bktv + ((bkt - ns->ns_bktv) ^ negc_alt(ns, tag));
+        if (negc_bkt_add(bkt, tag))
+            break;
+    }
+    spin_unlock(&ns->ns_lock);
+
+    return true;
+}
+
+bool
+c0_negc_invalidate(struct c0_negc *nc, u64 tag, u64 seq)
+{
+    struct negc_shard *ns = negc_shard(nc, tag);
+    struct negc_bkt *  bktv[2];
+    bool               found = false;
+    int                i, j;
+
+    spin_lock(&ns->ns_lock);
+    bktv[0] = ns->ns_bktv + (tag & ns->ns_mask);
+    bktv[1] = ns->ns_bktv + ((tag & ns->ns_mask) ^ negc_alt(ns, tag));
+
+    for (i = 0; i < 2; ++i) {
+        struct negc_bkt *bkt = bktv[i];
+
+        for (j = 0; j < NEGC_SLOTS; ++j) {
+            if (bkt->nb_tagv[j] == tag) {
+                bkt->nb_tagv[j] = 0;
+                found = true;
+            }
+        }
+
+        bkt->nb_floor = max_t(u64, bkt->nb_floor, seq + 1);
+    }
+    spin_unlock(&ns->ns_lock);
+
+    return found;
+}
+
+void
+c0_negc_flush(struct c0_negc *nc, u64 seq)
+{
+    int i;
+
+    negc_floor_raise(&nc->nc_floor, seq + 1);
+
+    for (i = 0; i < NEGC_SHARDS; ++i) {
+        struct negc_shard *ns = nc->nc_shardv + i;
+        u32                j;
+
+        spin_lock(&ns->ns_lock);
+        for (j = 0; j <= ns->ns_mask; ++j)
+            memset(ns->ns_bktv[j].nb_tagv, 0, sizeof(ns->ns_bktv[j].nb_tagv));
+        spin_unlock(&ns->ns_lock);
+    }
+}
+
+void
+c0_negc_hold(struct c0_negc *nc)
+{
+    atomic_inc(&nc->nc_busy);
+}
+
+void
+c0_negc_release(struct c0_negc *nc, u64 seq)
+{
+    /* Raise the floor before dropping the hold, a lookup whose view
+     * predates the commit may have missed its keys.
+     */
+    if (seq)
+        negc_floor_raise(&nc->nc_floor, seq);
+
+    smp_wmb();
+    atomic_dec(&nc->nc_busy);
+}
+
+merr_t
+c0_negc_create(size_t memsz, struct c0_negc **ncp)
+{
+    struct c0_negc *nc;
+    size_t          nbkts;
+    int             i;
+
+    *ncp = NULL;
+
+    nbkts = memsz / (sizeof(struct negc_bkt) * NEGC_SHARDS);
+    if (ev(nbkts < 2))
+        return merr(EINVAL);
+
+    nbkts = rounddown_pow_of_two(min_t(size_t, nbkts, U32_MAX));
+
+    nc = alloc_aligned(sizeof(*nc), __alignof(*nc), GFP_KERNEL);
+    if (ev(!nc))
+        return merr(ENOMEM);
+
+    memset(nc, 0, sizeof(*nc));
+    atomic64_set(&nc->nc_floor, 0);
+    atomic_set(&nc->nc_busy, 0);
+
+    for (i = 0; i < NEGC_SHARDS; ++i) {
+        struct negc_shard *ns = nc->nc_shardv + i;
+
+        ns->ns_bktv = calloc(nbkts, sizeof(*ns->ns_bktv));
+        if (ev(!ns->ns_bktv)) {
+            c0_negc_destroy(nc);
+            return merr(ENOMEM);
+        }
+
+        spin_lock_init(&ns->ns_lock);
+        ns->ns_mask = nbkts - 1;
+    }
+
+    *ncp = nc;
+
+    return 0;
+}
+
+void
+c0_negc_destroy(struct c0_negc *nc)
+{
+    int i;
+
+    if (!nc)
+        return;
+
+    for (i = 0; i < NEGC_SHARDS; ++i)
+        free(nc->nc_shardv[i].ns_bktv);
+
+    free_aligned(nc);
+}
@@ -0,0 +1,103 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2015-2020 Micron Technology, Inc.  All rights reserved.
+ */
+
+#ifndef HSE_C0_NEGC_H
+#define HSE_C0_NEGC_H
+
+#include <hse_util/inttypes.h>
+#include <hse_util/hse_err.h>
+
+#include <hse_ikvdb/key_hash.h>
+
+/*
+ * The c0 negative cache remembers keys (and kvs prefixes) recently found
+ * to be absent from both c0 and cN, so that repeated gets and probes of
+ * missing keys can skip the search.  It is a cuckoo filter of 64-bit key tags, with
+ * each tag holding a hash of the whole key seeded by its kvs index.
+ *
+ * Puts must invalidate the tags of the keys they write.  To keep a miss
+ * observed before such a put from being inserted after it, each bucket
+ * carries a seqno floor raised by invalidation: an insert is refused if
+ * the view of the lookup that missed is older than the floor of either
+ * of its buckets.  The cache-wide floor and busy count serve the same
+ * purpose for transaction commits and bulk loads, whose data becomes
+ * visible at a seqno that is not known when their keys are written.
+ */
+
+struct c0_negc;
+
+static inline u64
+c0_negc_tag(u32 skidx, bool probe, const void *key, size_t klen)
+{
+    u64 tag = key_hash64_seed(key, klen, ((u64)skidx << 1) | probe);
+
+    return tag ?: 1; /* zero marks an empty slot */
+}
+
+/**
+ * c0_negc_create() - create a negative cache
+ * @memsz: memory budget (bytes)
+ * @ncp:   (output) negative cache handle
+ */
+merr_t
+c0_negc_create(size_t memsz, struct c0_negc **ncp);
+
+void
+c0_negc_destroy(struct c0_negc *nc);
+
+/**
+ * c0_negc_lookup() - check whether a key is known to be absent
+ * @nc:  negative cache handle
+ * @tag: tag from c0_negc_tag()
+ */
+bool
+c0_negc_lookup(struct c0_negc *nc, u64 tag);
+
+/**
+ * c0_negc_insert() - record a miss
+ * @nc:   negative cache handle
+ * @tag:  tag from c0_negc_tag()
+ * @view: view seqno of the lookup that missed
+ *
+ * Return: %true if the miss was recorded.
+ */
+bool
+c0_negc_insert(struct c0_negc *nc, u64 tag, u64 view);
+
+/**
+ * c0_negc_invalidate() - forget a key that has just been written
+ * @nc:  negative cache handle
+ * @tag: tag from c0_negc_tag()
+ * @seq: current kvdb seqno, read after the write was applied
+ *
+ * Return: %true if the tag was cached.
+ */
+bool
+c0_negc_invalidate(struct c0_negc *nc, u64 tag, u64 seq);
+
+/**
+ * c0_negc_flush() - forget all keys
+ * @nc:  negative cache handle
+ * @seq: current kvdb seqno, read after the writes were made visible
+ */
+void
+c0_negc_flush(struct c0_negc *nc, u64 seq);
+
+/**
+ * c0_negc_hold() - refuse inserts while a commit is in progress
+ * @nc: negative cache handle
+ */
+void
+c0_negc_hold(struct c0_negc *nc);
+
+/**
+ * c0_negc_release() - undo a hold
+ * @nc:  negative cache handle
+ * @seq: seqno at which the commit became visible (zero if aborted)
+ */
+void
+c0_negc_release(struct c0_negc *nc, u64 seq);
+
+#endif
@@ -33,11 +33,13 @@
 #include <hse_ikvdb/kvdb_ctxn.h>
 #include <hse_ikvdb/cursor.h>
 #include <hse_ikvdb/kvdb_rparams.h>
+#include <hse_ikvdb/kvs_vcache.h>
 #include <hse_ikvdb/rparam_debug_flags.h>
 
 #include "c0sk_internal.h"
 #include "c0skm_internal.h"
 #include "c0_cursor.h"
+#include "c0_negc.h"
 
 void
 c0sk_perfc_alloc(struct c0sk_impl *self)
@@ -204,6 +206,7 @@ c0sk_c0_register(struct c0sk *handle, struct cn *cn, u16 *skidx)
 
             cn_ref_get(cn);
             self->c0sk_cnv[i] = cn;
+            self->c0sk_pfx_lenv[i] = cn_get_cparams(cn)->cp_pfx_len;
             *skidx = i;
 
             c0skm_skidx_register(self, i, cn);
@@ -233,6 +236,8 @@ c0sk_c0_deregister(struct c0sk *handle, u16 skidx)
 
     c0skm_skidx_deregister(self, skidx);
 
+    self->c0sk_vcachev[skidx] = NULL;
+
     if (self->c0sk_cnv[skidx]) {
         cn_ref_put(self->c0sk_cnv[skidx]);
         self->c0sk_cnv[skidx] = 0;
@@ -284,6 +289,26 @@ c0sk_del(struct c0sk *handle, u16 skidx, const struct kvs_ktuple *kt, u64 seqno)
     return err;
 }
 
+merr_t
+c0sk_putdelv(struct c0sk *handle, struct c0sk_batch_op *opv, uint opc, u64 seqno)
+{
+    struct c0sk_impl *self = c0sk_h2r(handle);
+    merr_t            err;
+    uint              ndel, i;
+
+    err = c0sk_putdel_batch(self, opv, opc, seqno);
+
+    if (!err && perfc_ison(&self->c0sk_pc_op, PERFC_RA_C0SKOP_PUT)) {
+        for (i = ndel = 0; i < opc; ++i)
+            ndel += opv[i].op_tomb;
+
+        perfc_add2(
+            &self->c0sk_pc_op, PERFC_RA_C0SKOP_PUT, opc - ndel, PERFC_RA_C0SKOP_DEL, ndel);
+    }
+
+    return err;
+}
+
 merr_t
 c0sk_prefix_del(struct c0sk *handle, u16 skidx, const struct kvs_ktuple *kt, u64 seqno)
 {
@@ -292,6 +317,19 @@ c0sk_prefix_del(struct c0sk *handle, u16 skidx, const struct kvs_ktuple *kt, u64
     return c0sk_putdel(self, skidx, C0SK_OP_PREFIX_DEL, kt, NULL, seqno);
 }
 
+merr_t
+c0sk_range_del(
+    struct c0sk *            handle,
+    u16                      skidx,
+    const struct kvs_ktuple *start,
+    const struct kvs_ktuple *end,
+    u64 *                    seqno)
+{
+    struct c0sk_impl *self = c0sk_h2r(handle);
+
+    return c0sk_rangedel(self, skidx, start, end, seqno);
+}
+
 /*
  * Tombstone indicated by:
  *     return value == 0 && res == FOUND_TOMB
@@ -311,7 +349,8 @@ c0sk_get(
     struct c0sk_impl *    self;
     uintptr_t             key_seqref = 0, ptomb_seqref = 0;
     u64                   start;
-    u64                   pfx_seq = 0, val_seq = 0;
+    u64                   pfx_seq = 0, val_seq = 0, rt_seq = 0;
+    uint                  nprobe = 0, nskip = 0;
     u64                   seq;
     merr_t                err = 0;
 
@@ -344,13 +383,31 @@ c0sk_get(
                 pfx_seq = seq;
         }
 
-        /* Search for latest value of key w/ seqno <= iseqno. */
+        /* Search for latest value of key w/ seqno <= iseqno, unless
+         * the c0kvset's filter shows that it doesn't have the key.
+         */
         c0kvs = c0kvms_get_hashed_c0kvset(c0kvms, kt->kt_hash);
-        err = c0kvs_get_rcu(c0kvs, skidx, kt, view_seq, seqref, res, vbuf, &key_seqref);
-        if (ev(err))
-            break;
+        ++nprobe;
+
+        if (self->c0sk_numa_nodes > 1)
+            c0sk_numa_rec(self, c0kvs, PERFC_RA_C0SKOP_GET_LOCAL);
 
-        val_seq = HSE_SQNREF_TO_ORDNL(key_seqref);
+        if (c0kvs_may_contain(c0kvs, kt->kt_hash)) {
+            err = c0kvs_get_rcu(c0kvs, skidx, kt, view_seq, seqref, res, vbuf, &key_seqref);
+            if (ev(err))
+                break;
+
+            val_seq = HSE_SQNREF_TO_ORDNL(key_seqref);
+        } else {
+            ++nskip;
+        }
+
+        /* Range tombstones in this kvms may hide the key in any kvms
+         * (or in cn), so keep the newest one that covers the key.
+         */
+        seq = c0kvms_rtomb_lookup(c0kvms, skidx, kt->kt_data, kt->kt_len, view_seq);
+        if (seq > rt_seq)
+            rt_seq = seq;
 
         if (*res != NOT_FOUND)
             break;
@@ -362,11 +419,21 @@ c0sk_get(
         vbuf->b_len = 0;
     }
 
+    if (rt_seq > val_seq && rt_seq > pfx_seq) {
+        *res = FOUND_TMB;
+        vbuf->b_len = 0;
+    }
+
     if (start > 0) {
         perfc_lat_record(&self->c0sk_pc_op, PERFC_LT_C0SKOP_GET, start);
         perfc_inc(&self->c0sk_pc_op, PERFC_RA_C0SKOP_GET);
     }
 
+    if (perfc_ison(&self->c0sk_pc_op, PERFC_RA_C0SKOP_FILTER_PROBE))
+        perfc_add2(
+            &self->c0sk_pc_op, PERFC_RA_C0SKOP_FILTER_PROBE, nprobe,
+            PERFC_RA_C0SKOP_FILTER_SKIP, nskip);
+
     return err;
 }
 
@@ -449,6 +516,33 @@ c0sk_calibrate(struct c0sk_impl *self)
         self->c0sk_kvdb_rp->throttle_sleep_min_ns = self->c0sk_nslpmin;
 }
 
+/* Return the number of online NUMA nodes (i.e., one more than the highest
+ * node ID in the "online" node list), or 1 if it cannot be determined.
+ */
+static uint
+c0sk_numa_nodes(void)
+{
+    char  buf[128], *end;
+    ulong node = 0;
+    FILE *fp;
+
+    fp = fopen("/sys/devices/system/node/online", "r");
+    if (!fp)
+        return 1;
+
+    if (fgets(buf, sizeof(buf), fp)) {
+        end = buf + strcspn(buf, "\n");
+        while (end > buf && isdigit(end[-1]))
+            --end;
+
+        node = strtoul(end, NULL, 10);
+    }
+
+    fclose(fp);
+
+    return min_t(ulong, node + 1, sizeof(ulong) * 8);
+}
+
 merr_t
 c0sk_open(
     struct kvdb_rparams *kvdb_rp,
@@ -518,6 +612,34 @@ c0sk_open(
         goto errout;
     }
 
+    tdmax = min_t(u64, kvdb_rp->c0_ingest_parts, HSE_C0_INGEST_PARTS_MAX);
+    tdmax = max_t(int, tdmax, 1);
+
+    c0sk->c0sk_wq_merge = alloc_workqueue("c0sk_merge", 0, tdmax);
+    if (!c0sk->c0sk_wq_merge) {
+        err = merr(ev(ENOMEM));
+        goto errout;
+    }
+
+    /* Frozen kvms are indexed for lookups only if requested. */
+    tdmax = min_t(u64, kvdb_rp->c0_wide_index, HSE_C0_INDEX_THREADS_MAX);
+    if (tdmax > 0) {
+        c0sk->c0sk_wq_index = alloc_workqueue("c0sk_index", 0, tdmax);
+        if (!c0sk->c0sk_wq_index) {
+            err = merr(ev(ENOMEM));
+            goto errout;
+        }
+    }
+
+    if (kvdb_rp->c0_numa_bind)
+        c0sk->c0sk_numa_nodes = c0sk_numa_nodes();
+
+    if (kvdb_rp->c0_negc_sz > 0) {
+        err = c0_negc_create(kvdb_rp->c0_negc_sz, &c0sk->c0sk_negc);
+        if (ev(err))
+            goto errout;
+    }
+
     c0sk->c0sk_ingest_width_max = HSE_C0_INGEST_WIDTH_MAX - 18;
     if (kvdb_rp->c0_ingest_width == 0)
         c0sk->c0sk_ingest_width = c0sk->c0sk_ingest_width_max / 2;
@@ -532,6 +654,8 @@ c0sk_open(
     if (ev(err))
         goto errout;
 
+    c0kvms_numa_bind(c0kvms, c0sk->c0sk_numa_nodes);
+
     if (!c0sk_install_c0kvms(c0sk, NULL, c0kvms)) {
         assert(0);
         c0kvms_putref(c0kvms); /* release birth reference */
@@ -551,8 +675,11 @@ errout:
 
         if (c0sk) {
             destroy_workqueue(c0sk->c0sk_wq_ingest);
+            destroy_workqueue(c0sk->c0sk_wq_index);
             destroy_workqueue(c0sk->c0sk_wq_maint);
+            destroy_workqueue(c0sk->c0sk_wq_merge);
             c0sk_free_concurrency_control(c0sk);
+            c0_negc_destroy(c0sk->c0sk_negc);
             free_aligned(c0sk);
         }
     }
@@ -603,9 +730,12 @@ c0sk_close(struct c0sk *handle)
     }
 
     destroy_workqueue(self->c0sk_wq_ingest);
+    destroy_workqueue(self->c0sk_wq_index);
     destroy_workqueue(self->c0sk_wq_maint);
+    destroy_workqueue(self->c0sk_wq_merge);
     c0sk_free_concurrency_control(self);
     c0sk_perfc_free(self);
+    c0_negc_destroy(self->c0sk_negc);
 
     free_aligned(self);
 
@@ -636,6 +766,7 @@ merr_t
 c0sk_flush(struct c0sk *handle, struct c0_kvmultiset *new)
 {
     struct c0sk_impl *self;
+    merr_t            err;
 
     if (!handle)
         return merr(ev(EINVAL));
@@ -645,7 +776,162 @@ c0sk_flush(struct c0sk *handle, struct c0_kvmultiset *new)
     if (self->c0sk_kvdb_rp->read_only)
         return 0;
 
-    return c0sk_flush_current_multiset(self, new, NULL);
+    err = c0sk_flush_current_multiset(self, new, NULL);
+
+    /* A transaction's kvms installed here bypasses the per-key
+     * invalidation done by c0sk_merge().
+     */
+    if (!err && new)
+        c0sk_cache_flush(handle);
+
+    return err;
+}
+
+bool
+c0sk_negc_lookup(struct c0sk *handle, u16 skidx, const struct kvs_ktuple *kt, bool probe)
+{
+    struct c0sk_impl *self = c0sk_h2r(handle);
+    bool              found;
+
+    if (!self->c0sk_negc)
+        return false;
+
+    found = c0_negc_lookup(self->c0sk_negc, c0_negc_tag(skidx, probe, kt->kt_data, kt->kt_len));
+
+    perfc_inc(&self->c0sk_pc_op, found ? PERFC_RA_C0SKOP_NEGC_HIT : PERFC_RA_C0SKOP_NEGC_MISS);
+
+    return found;
+}
+
+void
+c0sk_negc_insert(
+    struct c0sk *            handle,
+    u16                      skidx,
+    const struct kvs_ktuple *kt,
+    bool                     probe,
+    u64                      view)
+{
+    struct c0sk_impl *self = c0sk_h2r(handle);
+    u64               tag;
+
+    if (!self->c0sk_negc)
+        return;
+
+    tag = c0_negc_tag(skidx, probe, kt->kt_data, kt->kt_len);
+
+    if (c0_negc_insert(self->c0sk_negc, tag, view))
+        perfc_inc(&self->c0sk_pc_op, PERFC_RA_C0SKOP_NEGC_INSERT);
+}
+
+void
+c0sk_vcache_set(struct c0sk *handle, u16 skidx, struct kvs_vcache *vc)
+{
+    struct c0sk_impl *self = c0sk_h2r(handle);
+
+    assert(skidx < HSE_KVS_COUNT_MAX);
+
+    self->c0sk_vcachev[skidx] = vc;
+}
+
+uint
+c0sk_vcache_insert(
+    struct c0sk *       handle,
+    u16                 skidx,
+    struct kvs_ktuple * kt,
+    u64                 view,
+    struct kvs_buf *    vbuf)
+{
+    struct c0sk_impl * self = c0sk_h2r(handle);
+    struct kvs_vcache *vc = self->c0sk_vcachev[skidx];
+
+    if (!vc || atomic_read(&self->c0sk_vcache_busy) > 0)
+        return 0;
+
+    smp_rmb();
+
+    if (view < atomic64_read(&self->c0sk_vcache_floor))
+        return 0;
+
+    return kvs_vcache_insert(vc, kt, view, vbuf);
+}
+
+void
+c0sk_cache_flush(struct c0sk *handle)
+{
+    struct c0sk_impl *self;
+    u64               seq;
+    int               i;
+
+    if (!handle)
+        return;
+
+    self = c0sk_h2r(handle);
+
+    smp_mb();
+    seq = atomic64_read(self->c0sk_kvdb_seq);
+
+    if (self->c0sk_negc)
+        c0_negc_flush(self->c0sk_negc, seq);
+
+    /* A kvs being closed clears its slot and waits for a grace period
+     * before destroying its value cache.
+     */
+    rcu_read_lock();
+    for (i = 0; i < HSE_KVS_COUNT_MAX; ++i) {
+        struct kvs_vcache *vc = self->c0sk_vcachev[i];
+
+        if (vc)
+            kvs_vcache_flush(vc, seq);
+    }
+    rcu_read_unlock();
+}
+
+void
+c0sk_cache_hold(struct c0sk *handle)
+{
+    struct c0sk_impl *self;
+
+    if (!handle)
+        return;
+
+    self = c0sk_h2r(handle);
+
+    if (self->c0sk_negc)
+        c0_negc_hold(self->c0sk_negc);
+
+    atomic_inc(&self->c0sk_vcache_busy);
+}
+
+void
+c0sk_cache_release(struct c0sk *handle, u64 seq)
+{
+    struct c0sk_impl *self;
+
+    if (!handle)
+        return;
+
+    self = c0sk_h2r(handle);
+
+    if (self->c0sk_negc)
+        c0_negc_release(self->c0sk_negc, seq);
+
+    /* Raise the floor before dropping the hold, a lookup whose view
+     * predates the commit may have missed its keys in c0.
+     */
+    if (seq) {
+        u64 old = atomic64_read(&self->c0sk_vcache_floor);
+
+        while (old < seq) {
+            u64 cur = atomic64_cmpxchg(&self->c0sk_vcache_floor, old, seq);
+
+            if (cur == old)
+                break;
+            old = cur;
+        }
+    }
+
+    smp_wmb();
+    atomic_dec(&self->c0sk_vcache_busy);
 }
 
 merr_t
@@ -1457,11 +1743,12 @@ c0sk_cursor_seek(
 
         kv = valid ? bkv : &zero;
 
-        kt->kt_data = kv->bkv_key;
+        /* remember this for updates, which need implicit seek */
+        kt->kt_data = bn_kv_key(kv, cur->c0cur_buf);
         kt->kt_len = key_imm_klen(&kv->bkv_key_imm);
 
-        /* remember this for updates, which need implicit seek */
-        memcpy(cur->c0cur_buf, kt->kt_data, kt->kt_len);
+        if (kt->kt_data != cur->c0cur_buf)
+            memcpy(cur->c0cur_buf, kt->kt_data, kt->kt_len);
         cur->c0cur_keylen = kt->kt_len;
     }
     return 0;
@@ -1472,15 +1759,21 @@ copy_kv(void *buf, struct kvs_kvtuple *kvt, struct bonsai_kv *bkv, struct bonsai
 {
     struct key_immediate *imm = &bkv->bkv_key_imm;
     u32 klen = key_imm_klen(imm);
+    struct key_obj ko;
 
     kvt->kvt_key.kt_len = klen;
-    kvt->kvt_key.kt_data = memcpy(buf, bkv->bkv_key, klen);
+    kvt->kvt_key.kt_data = key_obj_copy(buf, klen, NULL, bn_kv_kobj(bkv, &ko));
 
     kvt->kvt_value.vt_xlen = val->bv_xlen;
+    kvt->kvt_value.vt_expiry = val->bv_expiry;
 
-    if (HSE_CORE_IS_TOMB(val->bv_valuep))
+    if (HSE_CORE_IS_TOMB(val->bv_valuep)) {
         kvt->kvt_value.vt_data = val->bv_valuep;
-    else
+    } else if (kvs_expired(val->bv_expiry)) {
+        /* An expired value hides older values just as a tomb would */
+        kvt->kvt_value.vt_data = HSE_CORE_TOMB_REG;
+        kvt->kvt_value.vt_xlen = 0;
+    } else
         kvt->kvt_value.vt_data = memcpy(buf + klen, val->bv_value, bonsai_val_vlen(val));
 }
 
@@ -1519,11 +1812,33 @@ c0sk_cursor_skip_pfx(struct c0_cursor *cur, struct bonsai_kv *bkv)
  *         If ptomb is cached, that means it was from a regular kvms. Output
  *         according to seqnos.
  */
+u64
+c0sk_cursor_rtomb_lookup(struct c0_cursor *cur, const void *key, u32 klen)
+{
+    u64 seq = 0;
+    int i;
+
+    for (i = 0; i < cur->c0cur_cnt; ++i) {
+        struct c0_kvmultiset *kvms = cur->c0cur_kvmsv[i];
+        u64                   rt_seq;
+
+        if (!kvms)
+            continue;
+
+        rt_seq = c0kvms_rtomb_lookup(kvms, cur->c0cur_skidx, key, klen, cur->c0cur_seqno);
+        if (rt_seq > seq)
+            seq = rt_seq;
+    }
+
+    return seq;
+}
+
 merr_t
 c0sk_cursor_read(struct c0_cursor *cur, struct kvs_kvtuple *kvt, bool *eof)
 {
     struct bonsai_kv *bkv, *dup;
     uintptr_t         seqnoref;
+    char              kbuf[HSE_KVS_KLEN_MAX];
 
     if (cur->c0cur_state != C0CUR_STATE_READY) {
         char * last = cur->c0cur_buf;
@@ -1547,10 +1862,11 @@ c0sk_cursor_read(struct c0_cursor *cur, struct kvs_kvtuple *kvt, bool *eof)
         struct bonsai_val    *val;
         u32                   klen = key_imm_klen(imm);
         bool                  is_ptomb = bkv->bkv_flags & BKV_FLAG_PTOMB;
+        const void *          kdata = bn_kv_key(bkv, kbuf);
 
         if (cur->c0cur_pfx_len) {
             int len = min_t(int, klen, cur->c0cur_pfx_len);
-            int rc = memcmp(bkv->bkv_key, cur->c0cur_prefix, len);
+            int rc = memcmp(kdata, cur->c0cur_prefix, len);
 
             /* Check eof condition */
             if ((cur->c0cur_reverse && rc < 0) || (!cur->c0cur_reverse && rc > 0))
@@ -1566,7 +1882,7 @@ c0sk_cursor_read(struct c0_cursor *cur, struct kvs_kvtuple *kvt, bool *eof)
 
         if (cur->c0cur_filter &&
             keycmp(
-                bkv->bkv_key, klen,
+                kdata, klen,
                 cur->c0cur_filter->kcf_maxkey,
                 cur->c0cur_filter->kcf_maxklen) > 0) {
             /* eof */
@@ -1584,7 +1900,7 @@ c0sk_cursor_read(struct c0_cursor *cur, struct kvs_kvtuple *kvt, bool *eof)
 
         if (cur->c0cur_ptomb_key) {
             if (keycmp_prefix(
-                    cur->c0cur_ptomb_key, cur->c0cur_ct_pfx_len, bkv->bkv_key, klen) == 0) {
+                    cur->c0cur_ptomb_key, cur->c0cur_ct_pfx_len, kdata, klen) == 0) {
                 /* If this val is from txn kvms, do not compare
                  * seqnos.
                  */
@@ -1596,6 +1912,15 @@ c0sk_cursor_read(struct c0_cursor *cur, struct kvs_kvtuple *kvt, bool *eof)
             }
         }
 
+        /* Skip values hidden by a range tombstone.  Older versions of
+         * the key in other kvmses are hidden too, and are skipped here
+         * as they are popped.
+         */
+        if (!is_ptomb && (!seqnoref || seqnoref != val->bv_seqnoref) &&
+            c0sk_cursor_rtomb_lookup(cur, kdata, klen) >
+                HSE_SQNREF_TO_ORDNL(val->bv_seqnoref))
+            continue;
+
         /* If ptomb, move iterators past prefix for all KVMS older than
          * current.
          */
@@ -1612,6 +1937,9 @@ c0sk_cursor_read(struct c0_cursor *cur, struct kvs_kvtuple *kvt, bool *eof)
 
             } else if (HSE_SQNREF_TO_ORDNL(val->bv_seqnoref) > cur->c0cur_ptomb_seq) {
 
+                /* Prefix tombstones are never split (see c0kvs_skey_pfx()). */
+                assert(!bkv->bkv_pfx_len);
+
                 cur->c0cur_ptomb_key = bkv->bkv_key;
                 cur->c0cur_ptomb_klen = klen;
                 cur->c0cur_ptomb_seq = HSE_SQNREF_TO_ORDNL(val->bv_seqnoref);
@@ -1628,8 +1956,7 @@ c0sk_cursor_read(struct c0_cursor *cur, struct kvs_kvtuple *kvt, bool *eof)
             struct bonsai_val *   dupv;
             struct key_immediate *dupi = &dup->bkv_key_imm;
 
-            if (key_imm_klen(imm) != key_imm_klen(dupi) ||
-                memcmp(bkv->bkv_key, dup->bkv_key, key_imm_klen(imm)))
+            if (key_imm_klen(imm) != key_imm_klen(dupi) || bn_kv_cmp(bkv, dup))
                 break;
 
             /* if dup is a ptomb, and current key is NOT a ptomb,
@@ -1917,9 +2244,9 @@ __used __cold
 static void
 c0sk_cursor_debug_val(struct c0_cursor *cur, uintptr_t seqnoref, struct bonsai_kv *bkv)
 {
-    char buf[256];
+    char buf[256], kbuf[HSE_KVS_KLEN_MAX];
 
-    fmt_hex(buf, sizeof(buf), bkv->bkv_key, key_imm_klen(&bkv->bkv_key_imm));
+    fmt_hex(buf, sizeof(buf), bn_kv_key(bkv, kbuf), key_imm_klen(&bkv->bkv_key_imm));
     printf(
         "debug: discard bkv %p view 0x%lx ref 0x%lx rock 0x%lx key %s\n",
         bkv,
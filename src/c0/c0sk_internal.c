@@ -13,6 +13,7 @@
 #include <hse_util/table.h>
 #include <hse_util/cds_list.h>
 #include <hse_util/bonsai_tree.h>
+#include <hse_util/cursor_heap.h>
 
 #include <hse/hse.h>
 
@@ -29,12 +30,16 @@
 #include <hse_ikvdb/c0_kvset_iterator.h>
 #include <hse_ikvdb/throttle.h>
 #include <hse_ikvdb/kvdb_rparams.h>
+#include <hse_ikvdb/kvs_vcache.h>
 #include <hse_ikvdb/rparam_debug_flags.h>
 
 #include "c0sk_internal.h"
 #include "c0skm_internal.h"
 #include "c0_kvmsm.h"
 #include "c0_ingest_work.h"
+#include "c0_negc.h"
+
+#include <syscall.h>
 
 merr_t
 c0sk_initialize_concurrency_control(struct c0sk_impl *c0sk)
@@ -234,6 +239,16 @@ c0sk_install_c0kvms(struct c0sk_impl *self, struct c0_kvmultiset *old, struct c0
 
     perfc_set(&self->c0sk_pc_ingest, PERFC_BA_C0SKING_WIDTH, self->c0sk_ingest_width);
 
+    if (perfc_ison(&self->c0sk_pc_ingest, PERFC_BA_C0SKING_HEAP)) {
+        size_t mapped, hugetlb, thp;
+
+        cheap_huge_stats(&mapped, &hugetlb, &thp);
+
+        perfc_set(&self->c0sk_pc_ingest, PERFC_BA_C0SKING_HEAP, mapped >> 20);
+        perfc_set(&self->c0sk_pc_ingest, PERFC_BA_C0SKING_HUGETLB, hugetlb >> 20);
+        perfc_set(&self->c0sk_pc_ingest, PERFC_BA_C0SKING_THP, thp >> 20);
+    }
+
     return (first == old);
 }
 
@@ -382,9 +397,12 @@ c0sk_builder_add(
         else
             seqno_prev = seqno;
 
-        err = kvset_builder_add_val(
-            bldr, seqno, bonsai_val_vlen(val) ? val->bv_value : val->bv_valuep,
-            bonsai_val_ulen(val), bonsai_val_clen(val));
+        if (val->bv_xlen & HSE_XLEN_MOP)
+            err = kvset_builder_add_mop(bldr, seqno, val->bv_value, bonsai_val_ulen(val));
+        else
+            err = kvset_builder_add_val_expiry(
+                bldr, seqno, bonsai_val_vlen(val) ? val->bv_value : val->bv_valuep,
+                bonsai_val_ulen(val), bonsai_val_clen(val), val->bv_expiry);
 
         if (ev(err))
             return err;
@@ -393,8 +411,7 @@ c0sk_builder_add(
     {
         struct key_obj ko;
 
-        key2kobj(&ko, bkv->bkv_key, key_imm_klen(&bkv->bkv_key_imm));
-        err = kvset_builder_add_key(bldr, &ko);
+        err = kvset_builder_add_key(bldr, bn_kv_kobj(bkv, &ko));
     }
 
     return err;
@@ -411,98 +428,135 @@ c0sk_ingest_rec_perfc(struct perfc_set *perfc, u32 sidx, u64 cycles)
     perfc_rec_sample(perfc, sidx, cycles);
 }
 
-void
-c0sk_ingest_worker(struct work_struct *work)
-{
-    struct bin_heap2 *minheap __aligned(64);
-    struct bonsai_kv *        bkv_prev;
-    struct bonsai_kv *        bkv;
-    struct kvset_builder *    bldr;
-    struct kvset_builder **   bldrs;
-    const void *              last_key = NULL;
-    u16                       last_klen = 0;
-    struct bonsai_val *       val_head;
-    struct bonsai_val **      val_tailp;
-    struct bonsai_val **      val_prevp;
-    struct bonsai_val *       val;
-    u64                       seqno;
-    u64                       last_skidx = 0;
-    u16                       unsorted;
-    s16                       debug;
-    u16                       skidx_prev;
-    u16                       skidx;
-    merr_t                    err;
-    struct cn *               cn;
-    u64                       go = 0;
+struct c0sk_merge;
 
-    /* Maintain separate ptomb seqno prev to distinguish b/w a key and a
-     * ptomb from different KVMSes that have the same seqno.
-     */
-    u64 seqno_prev, pt_seqno_prev;
-
-    struct c0_ingest_work *ingest;
-    struct kvset_mblocks * mblocks;
-    struct c0_kvmultiset * kvms;
-    struct c0sk_impl *     c0sk;
-    u32                    iterc;
-    int                    i;
-    int *                  mbc;
-    struct kvset_mblocks **mbv;
-    u32 *                  cmtv;
-    bool                   do_cn_ingest = false;
-    u64                    ingestid;
-
-    ingest = container_of(work, struct c0_ingest_work, c0iw_work);
-
-    minheap = ingest->c0iw_minheap;
-    bldrs = ingest->c0iw_bldrs;
-    mblocks = ingest->c0iw_mblocks;
-    iterc = ingest->c0iw_iterc;
-    kvms = ingest->c0iw_c0kvms;
-    mbc = ingest->c0iw_mbc;
-    mbv = ingest->c0iw_mbv;
-    cmtv = ingest->c0iw_cmtv;
-
-    val_tailp = &val_head;
-    val_prevp = NULL;
-    val_head = NULL;
+/**
+ * struct c0sk_ingest_part - one key range of a c0 ingest
+ * @cp_work:       work struct for merging the range on c0sk_wq_merge
+ * @cp_merge:      merge to which this part belongs
+ * @cp_minheap:    bin heap over the c0kvset iterators, positioned at the
+ *                 first key of the range
+ * @cp_end:        first key past the range, or NULL for the last part
+ * @cp_skidx_lo:   first skidx of the range
+ * @cp_skidx_hi:   last skidx of the range (inclusive)
+ * @cp_bldrv:      kvset builders, indexed by skidx
+ * @cp_mblocks:    mblocks produced by @cp_bldrv, indexed by skidx
+ * @cp_last_kv:    kv of the last key merged, if any
+ * @cp_last_klen:  length of the key of @cp_last_kv
+ * @cp_last_skidx: skidx of @cp_last_kv
+ * @cp_err:        merge status
+ * @cp_iterv:      c0kvset iterators (multi-part merges only)
+ * @cp_sourcev:    element sources of @cp_iterv
+ *
+ * The parts of an ingest partition the (skidx, key) space, hence each
+ * builds kvsets from disjoint sets of bonsai kvs and may run in parallel
+ * with the others.
+ */
+struct c0sk_ingest_part {
+    struct work_struct        cp_work;
+    struct c0sk_merge *       cp_merge;
+    struct bin_heap2 *        cp_minheap;
+    const struct bonsai_skey *cp_end;
+    u16                       cp_skidx_lo;
+    u16                       cp_skidx_hi;
+    struct kvset_builder **   cp_bldrv;
+    struct kvset_mblocks *    cp_mblocks;
+    const struct bonsai_kv *  cp_last_kv;
+    u16                       cp_last_klen;
+    u16                       cp_last_skidx;
+    merr_t                    cp_err;
+    struct c0_kvset_iterator *cp_iterv;
+    struct element_source **  cp_sourcev;
+};
 
-    c0sk = c0sk_h2r(ingest->c0iw_c0);
-    debug = c0sk->c0sk_kvdb_rp->c0_debug & C0_DEBUG_INGSPILL;
-    ingestid = CNDB_DFLT_INGESTID;
-    err = 0;
+/**
+ * struct c0sk_merge - state shared by the parts of an ingest
+ * @cm_c0sk:       c0sk
+ * @cm_ingest:     ingest work
+ * @cm_have_rtombs: the ingest includes range tombstones
+ * @cm_lock:       protects @cm_pending
+ * @cm_cv:         signaled when @cm_pending drops to zero
+ * @cm_pending:    number of parts queued and not yet merged
+ * @cm_partc:      number of parts
+ * @cm_splitv:     first key of each part but the first
+ * @cm_partv:      parts, in key order
+ */
+struct c0sk_merge {
+    struct c0sk_impl *       cm_c0sk;
+    struct c0_ingest_work *  cm_ingest;
+    bool                     cm_have_rtombs;
+    struct mutex             cm_lock;
+    struct cv                cm_cv;
+    uint                     cm_pending;
+    uint                     cm_partc;
+    struct bonsai_skey       cm_splitv[HSE_C0_INGEST_PARTS_MAX - 1];
+    struct c0sk_ingest_part *cm_partv[HSE_C0_INGEST_PARTS_MAX];
+};
 
-    assert(c0sk->c0sk_kvdb_health);
+static merr_t
+c0sk_ingest_bldr_get(struct c0sk_impl *c0sk, struct kvset_builder **bldrv, u16 skidx)
+{
+    struct kvset_builder *bldr;
+    struct cn *           cn;
+    merr_t                err;
 
-    if (debug)
-        ingest->t0 = get_time_ns();
+    if (bldrv[skidx])
+        return 0;
 
-    c0kvms_priv_wait(kvms);
+    cn = c0sk->c0sk_cnv[skidx];
+    assert(cn);
 
-    if (ev(iterc == 0))
-        goto exit_err;
+    err = kvset_builder_create(
+        &bldr, cn, cn_get_ingest_perfc(cn), get_time_ns(), KVSET_BUILDER_FLAGS_INGEST);
+    if (ev(err))
+        return err;
 
-    if (c0sk->c0sk_kvdb_rp->c0_diag_mode)
-        goto exit_err;
+    kvset_builder_set_agegroup(bldr, HSE_MPOLICY_AGE_ROOT);
 
-    while (unlikely((c0sk->c0sk_kvdb_rp->c0_debug & C0_DEBUG_ACCUMULATE) && !c0sk->c0sk_syncing))
-        cpu_relax();
+    bldrv[skidx] = bldr;
 
-    /* ingests do not stop on block deletion failures. */
-    err = kvdb_health_check(
-        c0sk->c0sk_kvdb_health, KVDB_HEALTH_FLAG_ALL & ~KVDB_HEALTH_FLAG_DELBLKFAIL);
-    if (ev(err))
-        goto exit_err;
+    return 0;
+}
 
-    go = perfc_lat_start(&c0sk->c0sk_pc_ingest);
+/**
+ * c0sk_ingest_merge() - merge one key range of an ingest into kvset builders
+ * @merge:  merge state
+ * @part:   the part to merge
+ *
+ * Pops keys from the part's bin heap until it is empty or returns a key
+ * past the end of the range, adds the range tombstones whose skidx lies
+ * within the part, and then finishes each builder the part created.
+ */
+static merr_t
+c0sk_ingest_merge(struct c0sk_merge *merge, struct c0sk_ingest_part *part)
+{
+    struct c0sk_impl *     c0sk = merge->cm_c0sk;
+    struct c0_ingest_work *ingest = merge->cm_ingest;
+    struct c0_kvmultiset * kvms = ingest->c0iw_c0kvms;
+    struct bin_heap2 *     minheap = part->cp_minheap;
+    struct kvset_builder **bldrs = part->cp_bldrv;
+    struct kvset_builder * bldr;
+    struct bonsai_kv *     bkv_prev;
+    struct bonsai_kv *     bkv;
+    struct bonsai_val *    val_head;
+    struct bonsai_val **   val_tailp;
+    struct bonsai_val **   val_prevp;
+    struct bonsai_val *    val;
+    u64                    seqno;
+    u16                    unsorted;
+    u16                    skidx_prev;
+    u16                    skidx;
+    merr_t                 err = 0;
+    int                    i;
 
-    /* this logic error cannot result in WA, not kvdb_health recordable */
-    err = bin_heap2_prepare(minheap, iterc, ingest->c0iw_sourcev + HSE_C0_KVSET_ITER_MAX - iterc);
-    if (ev(err))
-        goto exit_err;
+    /* Maintain separate ptomb seqno prev to distinguish b/w a key and a
+     * ptomb from different KVMSes that have the same seqno.
+     */
+    u64 seqno_prev, pt_seqno_prev;
 
-    if (debug)
-        ingest->t3 = get_time_ns();
+    val_tailp = &val_head;
+    val_prevp = NULL;
+    val_head = NULL;
 
     seqno_prev = U64_MAX;
     pt_seqno_prev = U64_MAX;
@@ -512,13 +566,6 @@ c0sk_ingest_worker(struct work_struct *work)
     bldr = NULL;
     seqno = 0;
 
-    ingestid = c0kvms_rsvd_sn_get(kvms);
-
-    /*
-     */
-    if (ingestid == HSE_SQNREF_INVALID)
-        ingestid = CNDB_DFLT_INGESTID;
-
     /* Due to how sourcev[] is constructed by c0sk_coalesce(), the bin
      * heap returns identicals keys in order of youngest to oldest
      * disambiguated by skidx.
@@ -538,14 +585,18 @@ c0sk_ingest_worker(struct work_struct *work)
     while (bin_heap2_pop(minheap, (void **)&bkv)) {
         bool have_val = false;
 
-        last_skidx = skidx = key_immediate_index(&bkv->bkv_key_imm);
+        if (part->cp_end &&
+            bn_kv_key_cmp(&part->cp_end->bsk_key_imm, part->cp_end->bsk_key, bkv) <= 0)
+            break;
+
+        skidx = key_immediate_index(&bkv->bkv_key_imm);
 
         if (val_head && (bn_kv_cmp(bkv, bkv_prev) || skidx != skidx_prev)) {
             *val_tailp = NULL;
 
             err = c0sk_builder_add(bldr, kvms, bkv_prev, val_head, unsorted);
             if (ev(err))
-                goto health_err;
+                goto errout;
 
             seqno_prev = U64_MAX;
             pt_seqno_prev = U64_MAX;
@@ -556,8 +607,9 @@ c0sk_ingest_worker(struct work_struct *work)
         }
 
         bkv_prev = bkv;
-        last_klen = key_imm_klen(&bkv->bkv_key_imm);
-        last_key = bkv->bkv_key;
+        part->cp_last_skidx = skidx;
+        part->cp_last_klen = key_imm_klen(&bkv->bkv_key_imm);
+        part->cp_last_kv = bkv;
 
         /* Append values from the current key to the list of values
          * from previous identical keys.  Swap adjacent values that
@@ -570,94 +622,548 @@ c0sk_ingest_worker(struct work_struct *work)
 
             state = seqnoref_to_seqno(val->bv_seqnoref, &seqno);
 
-            rc = seq_prev_cmp(val->bv_valuep, seqno, seqno_prev, pt_seqno_prev);
+            rc = seq_prev_cmp(val->bv_valuep, seqno, seqno_prev, pt_seqno_prev);
+
+            if (state != HSE_SQNREF_STATE_DEFINED || rc == 0)
+                continue;
+
+            assert(seqno < U64_MAX);
+
+            have_val = true;
+
+            assert(!HSE_CORE_IS_PTOMB(val->bv_valuep) || (bkv->bkv_flags & BKV_FLAG_PTOMB));
+
+            /* Insert value as penultimate if seqno is out-of-order.
+             */
+            if (rc > 0) {
+                /* [HSE_REVISIT] Need to choose the right
+                 * penultimate position when current key is
+                 * non-ptomb and last key was a ptomb. Or vice
+                 * versa.
+                 * i.e. ptomb must be inserted before last
+                 * ptomb and non-ptomb must be inserted before
+                 * last non-ptomb instead of always inserting
+                 * at previous position.
+                 */
+                val->bv_free = *val_prevp;
+                *val_prevp = val;
+                val_prevp = &val->bv_free;
+
+                ++unsorted;
+                continue;
+            }
+
+            /* Otherwise, append value to the tail of the list.
+             */
+            val_prevp = val_tailp;
+            *val_tailp = val;
+            val_tailp = &val->bv_free;
+
+            if (HSE_CORE_IS_PTOMB(val->bv_valuep))
+                pt_seqno_prev = seqno;
+            else
+                seqno_prev = seqno;
+        }
+
+        if (have_val && skidx != skidx_prev) {
+            skidx_prev = skidx;
+
+            err = c0sk_ingest_bldr_get(c0sk, bldrs, skidx);
+            if (ev(err))
+                goto errout;
+
+            bldr = bldrs[skidx];
+        }
+    }
+
+    if (val_head) {
+        *val_tailp = NULL;
+
+        err = c0sk_builder_add(bldr, kvms, bkv_prev, val_head, unsorted);
+        if (ev(err))
+            goto errout;
+
+        val_head = NULL;
+    }
+
+    /* Range tombstones are not part of the bonsai trees, add them
+     * to the ingest kvsets directly.  A kvs that has range tombstones
+     * is never split across parts (see c0sk_ingest_split()).
+     */
+    for (i = 0; i < ingest->c0iw_coalescec && merge->cm_have_rtombs; ++i) {
+        struct c0_rtomb *rt;
+
+        for (rt = c0kvms_rtombs(ingest->c0iw_coalscedkvms[i]); rt; rt = rt->c0rt_next) {
+            skidx = rt->c0rt_skidx;
+
+            if (skidx < part->cp_skidx_lo || skidx > part->cp_skidx_hi)
+                continue;
+
+            err = c0sk_ingest_bldr_get(c0sk, bldrs, skidx);
+            if (ev(err))
+                goto errout;
+
+            err = kvset_builder_add_rtomb(bldrs[skidx], &rt->c0rt_rt);
+            if (ev(err))
+                goto errout;
+        }
+    }
+
+    for (i = part->cp_skidx_lo; i <= part->cp_skidx_hi; ++i) {
+        if (!bldrs[i])
+            continue;
+
+        err = kvset_builder_get_mblocks(bldrs[i], &part->cp_mblocks[i]);
+        if (ev(err))
+            goto errout;
+    }
+
+errout:
+    if (err) {
+        *val_tailp = NULL;
+
+        while ((val = val_head)) {
+            val_head = val->bv_free;
+            val->bv_free = NULL;
+        }
+    }
+
+    return err;
+}
+
+static void
+c0sk_ingest_merge_cb(struct work_struct *work)
+{
+    struct c0sk_ingest_part *part;
+    struct c0sk_merge *      merge;
+
+    part = container_of(work, struct c0sk_ingest_part, cp_work);
+    merge = part->cp_merge;
+
+    part->cp_err = c0sk_ingest_merge(merge, part);
+
+    mutex_lock(&merge->cm_lock);
+    if (--merge->cm_pending == 0)
+        cv_signal(&merge->cm_cv);
+    mutex_unlock(&merge->cm_lock);
+}
+
+/**
+ * c0sk_ingest_split() - choose the key ranges of a parallel ingest
+ * @merge:  merge state, receives the split keys in cm_splitv[]
+ *
+ * Ingests are divided into as many as c0_ingest_parts ranges of at least
+ * c0_ingest_part_mb each, by keys taken from the top levels of the tallest
+ * c0kvset's bonsai tree.
+ * Since the trees of a kvms are populated alike, these keys divide every
+ * c0kvset into parts of roughly equal size.
+ *
+ * A split key that falls within a kvs that may have prefix or range
+ * tombstones is moved to the start of that kvs, so that its kvset covers
+ * every key the tombstones might delete.
+ *
+ * Return: the number of split keys, zero if the ingest is not split
+ */
+static uint
+c0sk_ingest_split(struct c0sk_merge *merge)
+{
+    struct c0sk_impl *       c0sk = merge->cm_c0sk;
+    struct c0_ingest_work *  ingest = merge->cm_ingest;
+    struct bonsai_kv *       kvv[HSE_C0_INGEST_PARTS_MAX - 1];
+    struct bonsai_root *     root = NULL;
+    struct element_source ** sourcev;
+    struct c0_kvset_iterator *iter;
+    size_t                   used = 0;
+    uint                     partc, partmb, kvc, splitc, i;
+    s32                      height = 0;
+
+    partc = min_t(uint, c0sk->c0sk_kvdb_rp->c0_ingest_parts, HSE_C0_INGEST_PARTS_MAX);
+    partmb = max_t(uint, c0sk->c0sk_kvdb_rp->c0_ingest_part_mb, 1);
+
+    for (i = 0; i < ingest->c0iw_coalescec; ++i)
+        used += c0kvms_used(ingest->c0iw_coalscedkvms[i]);
+
+    partc = min_t(size_t, partc, (used >> 20) / partmb);
+    if (partc < 2)
+        return 0;
+
+    sourcev = ingest->c0iw_sourcev + HSE_C0_KVSET_ITER_MAX - ingest->c0iw_iterc;
+
+    rcu_read_lock();
+    for (i = 0; i < ingest->c0iw_iterc; ++i) {
+        struct bonsai_node *node;
+
+        iter = container_of(sourcev[i], struct c0_kvset_iterator, c0it_handle);
+
+        node = rcu_dereference(iter->c0it_root->br_root);
+        if (node && node->bn_height > height) {
+            height = node->bn_height;
+            root = iter->c0it_root;
+        }
+    }
+
+    kvc = root ? bn_split_keys(root, ilog2(partc), kvv) : 0;
+
+    for (i = splitc = 0; i < kvc; ++i) {
+        struct bonsai_skey *skey = merge->cm_splitv + splitc;
+        struct cn *         cn;
+        u16                 skidx;
+
+        skidx = key_immediate_index(&kvv[i]->bkv_key_imm);
+        cn = c0sk->c0sk_cnv[skidx];
+
+        if (!merge->cm_have_rtombs && cn && !cn_get_cparams(cn)->cp_pfx_len) {
+            assert(!kvv[i]->bkv_pfx_len);
+            bn_skey_init(kvv[i]->bkv_key, key_imm_klen(&kvv[i]->bkv_key_imm), skidx, skey);
+        } else {
+            if (skidx == 0)
+                continue;
+
+            bn_skey_init("", 0, skidx, skey);
+        }
+
+        if (splitc > 0 &&
+            key_full_cmp(&skey[-1].bsk_key_imm, skey[-1].bsk_key,
+                         &skey->bsk_key_imm, skey->bsk_key) >= 0)
+            continue;
+
+        ++splitc;
+    }
+    rcu_read_unlock();
+
+    return splitc;
+}
+
+static void
+c0sk_ingest_parts_destroy(struct c0sk_merge *merge)
+{
+    struct c0sk_ingest_part *part;
+    uint                     i, j;
+
+    for (i = 0; i < merge->cm_partc; ++i) {
+        part = merge->cm_partv[i];
+        if (!part)
+            continue;
+
+        for (j = 0; j < HSE_KVS_COUNT_MAX; ++j) {
+            if (!part->cp_bldrv[j])
+                continue;
+
+            kvset_mblocks_destroy(&part->cp_mblocks[j]);
+            kvset_builder_destroy(part->cp_bldrv[j]);
+        }
+
+        bin_heap2_destroy(part->cp_minheap);
+        free(part);
+
+        merge->cm_partv[i] = NULL;
+    }
+}
+
+#pragma push_macro("c0sk_ingest_parts_create")
+#undef c0sk_ingest_parts_create
+
+merr_t
+c0sk_ingest_parts_create(struct c0sk_merge *merge)
+{
+    struct c0_ingest_work *  ingest = merge->cm_ingest;
+    struct element_source ** sourcev;
+    struct c0sk_ingest_part *part;
+    uint                     iterc = ingest->c0iw_iterc;
+    size_t                   sz;
+    merr_t                   err;
+    uint                     i, j;
+
+    sourcev = ingest->c0iw_sourcev + HSE_C0_KVSET_ITER_MAX - iterc;
+
+    sz = sizeof(*part);
+    sz += sizeof(*part->cp_bldrv) * HSE_KVS_COUNT_MAX;
+    sz += sizeof(*part->cp_mblocks) * HSE_KVS_COUNT_MAX;
+    sz += sizeof(*part->cp_iterv) * iterc;
+    sz += sizeof(*part->cp_sourcev) * iterc;
+
+    for (i = 0; i < merge->cm_partc; ++i) {
+        const struct bonsai_skey *start;
+
+        part = calloc(1, sz);
+        if (ev(!part)) {
+            err = merr(ENOMEM);
+            goto errout;
+        }
+
+        merge->cm_partv[i] = part;
+
+        part->cp_mblocks = (void *)(part + 1);
+        part->cp_iterv = (void *)(part->cp_mblocks + HSE_KVS_COUNT_MAX);
+        part->cp_bldrv = (void *)(part->cp_iterv + iterc);
+        part->cp_sourcev = (void *)(part->cp_bldrv + HSE_KVS_COUNT_MAX);
+
+        start = i > 0 ? merge->cm_splitv + i - 1 : NULL;
+
+        part->cp_merge = merge;
+        part->cp_end = i + 1 < merge->cm_partc ? merge->cm_splitv + i : NULL;
+        part->cp_skidx_lo = start ? key_immediate_index(&start->bsk_key_imm) : 0;
+        part->cp_skidx_hi = HSE_KVS_COUNT_MAX - 1;
+
+        if (part->cp_end) {
+            part->cp_skidx_hi = key_immediate_index(&part->cp_end->bsk_key_imm);
+
+            /* A split at the start of a kvs ends the range at the prior kvs. */
+            if (!key_imm_klen(&part->cp_end->bsk_key_imm))
+                part->cp_skidx_hi--;
+        }
+
+        for (j = 0; j < iterc; ++j) {
+            struct c0_kvset_iterator *iter, *orig;
+
+            orig = container_of(sourcev[j], struct c0_kvset_iterator, c0it_handle);
+            iter = part->cp_iterv + j;
+
+            c0_kvset_iterator_init(iter, orig->c0it_root, orig->c0it_flags, orig->c0it_index);
+            if (start)
+                c0_kvset_iterator_seek_skey(iter, start);
+
+            part->cp_sourcev[j] = c0_kvset_iterator_get_es(iter);
+        }
+
+        err = bin_heap2_create(iterc, bn_kv_cmp, &part->cp_minheap);
+        if (ev(err))
+            goto errout;
+
+        err = bin_heap2_prepare(part->cp_minheap, iterc, part->cp_sourcev);
+        if (ev(err))
+            goto errout;
+    }
+
+    return 0;
+
+errout:
+    c0sk_ingest_parts_destroy(merge);
+
+    return err;
+}
+
+#pragma pop_macro("c0sk_ingest_parts_create")
+
+/**
+ * c0sk_ingest_mblocks() - gather the mblocks of each kvs from the parts
+ * @merge:  merge state
+ * @mbv:    (output) vector of kvset mblocks, indexed by skidx
+ * @mbc:    (output) number of kvsets in each element of @mbv
+ *
+ * A kvs split across several parts gets one kvset from each, in key order.
+ * Ownership of the mblocks moves from the parts to @mbv.
+ */
+static merr_t
+c0sk_ingest_mblocks(struct c0sk_merge *merge, struct kvset_mblocks **mbv, int *mbc)
+{
+    struct c0_ingest_work *ingest = merge->cm_ingest;
+    struct kvset_mblocks * mblocks;
+    uint                   i, j, n;
+
+    for (i = 0; i < HSE_KVS_COUNT_MAX; ++i) {
+        for (j = n = 0; j < merge->cm_partc; ++j)
+            n += !!merge->cm_partv[j]->cp_bldrv[i];
+
+        if (!n)
+            continue;
+
+        mblocks = ingest->c0iw_mblocks + i;
+        if (n > 1) {
+            mblocks = malloc(n * sizeof(*mblocks));
+            if (ev(!mblocks))
+                return merr(ENOMEM);
+        }
+
+        mbv[i] = mblocks;
+
+        for (j = 0; j < merge->cm_partc; ++j) {
+            struct c0sk_ingest_part *part = merge->cm_partv[j];
+
+            if (!part->cp_bldrv[i])
+                continue;
+
+            mbv[i][mbc[i]++] = part->cp_mblocks[i];
+            memset(part->cp_mblocks + i, 0, sizeof(part->cp_mblocks[i]));
+        }
+    }
+
+    return 0;
+}
+
+/* Fold the merge time per key of the given ingest into the moving
+ * average used by c0sk_ingest_tune().
+ */
+static void
+c0sk_ingest_nspk_update(struct c0sk_impl *c0sk, struct c0_ingest_work *ingest, u64 ns)
+{
+    u64 keys = 0, nspk;
+    int i;
+
+    for (i = 0; i < ingest->c0iw_coalescec; ++i)
+        keys += c0kvms_get_element_count(ingest->c0iw_coalscedkvms[i]);
+
+    if (keys == 0)
+        return;
+
+    ns /= keys;
+
+    nspk = atomic64_read(&c0sk->c0sk_ingest_nspk);
+    nspk = nspk ? (ns + nspk * 3) / 4 : ns;
+    atomic64_set(&c0sk->c0sk_ingest_nspk, nspk);
+}
+
+void
+c0sk_ingest_worker(struct work_struct *work)
+{
+    struct c0sk_ingest_part   part0 = {};
+    struct c0sk_ingest_part * last;
+    struct c0sk_merge         merge;
+    struct c0_ingest_work *   ingest;
+    struct kvset_mblocks *    mblocks;
+    struct c0_kvmultiset *    kvms;
+    struct c0sk_impl *        c0sk;
+    struct kvset_builder **   bldrs;
+    struct kvset_mblocks **   mbv;
+    const void *              last_key = NULL;
+    char                      last_kbuf[HSE_KVS_KLEN_MAX];
+    u16                       last_klen = 0;
+    u64                       last_skidx = 0;
+    u32                       iterc;
+    int                       i, j;
+    int *                     mbc;
+    u32 *                     cmtv;
+    bool                      do_cn_ingest = false;
+    bool                      have_rtombs = false;
+    u64                       ingestid;
+    s16                       debug;
+    merr_t                    err;
+    u64                       go = 0;
+    u64                       tmerge;
+
+    ingest = container_of(work, struct c0_ingest_work, c0iw_work);
+
+    bldrs = ingest->c0iw_bldrs;
+    mblocks = ingest->c0iw_mblocks;
+    iterc = ingest->c0iw_iterc;
+    kvms = ingest->c0iw_c0kvms;
+    mbc = ingest->c0iw_mbc;
+    mbv = ingest->c0iw_mbv;
+    cmtv = ingest->c0iw_cmtv;
+
+    c0sk = c0sk_h2r(ingest->c0iw_c0);
+    debug = c0sk->c0sk_kvdb_rp->c0_debug & C0_DEBUG_INGSPILL;
+    ingestid = CNDB_DFLT_INGESTID;
+    err = 0;
+
+    memset(&merge, 0, sizeof(merge));
+    merge.cm_c0sk = c0sk;
+    merge.cm_ingest = ingest;
+    mutex_init(&merge.cm_lock);
+    cv_init(&merge.cm_cv, "c0sk_merge_cv");
+
+    assert(c0sk->c0sk_kvdb_health);
+
+    if (debug)
+        ingest->t0 = get_time_ns();
+
+    c0kvms_priv_wait(kvms);
+
+    for (i = 0; i < ingest->c0iw_coalescec && !have_rtombs; ++i)
+        have_rtombs = !!c0kvms_rtombs(ingest->c0iw_coalscedkvms[i]);
+
+    merge.cm_have_rtombs = have_rtombs;
+
+    if (ev(iterc == 0) && !have_rtombs)
+        goto exit_err;
+
+    if (c0sk->c0sk_kvdb_rp->c0_diag_mode)
+        goto exit_err;
+
+    while (unlikely((c0sk->c0sk_kvdb_rp->c0_debug & C0_DEBUG_ACCUMULATE) && !c0sk->c0sk_syncing))
+        cpu_relax();
+
+    /* ingests do not stop on block deletion failures. */
+    err = kvdb_health_check(
+        c0sk->c0sk_kvdb_health, KVDB_HEALTH_FLAG_ALL & ~KVDB_HEALTH_FLAG_DELBLKFAIL);
+    if (ev(err))
+        goto exit_err;
+
+    go = perfc_lat_start(&c0sk->c0sk_pc_ingest);
+    tmerge = get_time_ns();
+
+    /* Large ingests are merged in parallel by key range, falling back
+     * to a single merge over the ingest's own bin heap and builders.
+     */
+    merge.cm_partc = c0sk_ingest_split(&merge) + 1;
+    if (merge.cm_partc > 1 && c0sk_ingest_parts_create(&merge))
+        merge.cm_partc = 1;
+
+    if (merge.cm_partc == 1) {
+        /* this logic error cannot result in WA, not kvdb_health recordable */
+        err = bin_heap2_prepare(
+            ingest->c0iw_minheap, iterc, ingest->c0iw_sourcev + HSE_C0_KVSET_ITER_MAX - iterc);
+        if (ev(err))
+            goto exit_err;
+
+        part0.cp_merge = &merge;
+        part0.cp_minheap = ingest->c0iw_minheap;
+        part0.cp_skidx_hi = HSE_KVS_COUNT_MAX - 1;
+        part0.cp_bldrv = bldrs;
+        part0.cp_mblocks = mblocks;
 
-            if (state != HSE_SQNREF_STATE_DEFINED || rc == 0)
-                continue;
+        merge.cm_partv[0] = &part0;
+    }
 
-            assert(seqno < U64_MAX);
+    if (debug)
+        ingest->t3 = get_time_ns();
 
-            have_val = true;
+    ingestid = c0kvms_rsvd_sn_get(kvms);
 
-            assert(!HSE_CORE_IS_PTOMB(val->bv_valuep) || (bkv->bkv_flags & BKV_FLAG_PTOMB));
+    /*
+     */
+    if (ingestid == HSE_SQNREF_INVALID)
+        ingestid = CNDB_DFLT_INGESTID;
 
-            /* Insert value as penultimate if seqno is out-of-order.
-             */
-            if (rc > 0) {
-                /* [HSE_REVISIT] Need to choose the right
-                 * penultimate position when current key is
-                 * non-ptomb and last key was a ptomb. Or vice
-                 * versa.
-                 * i.e. ptomb must be inserted before last
-                 * ptomb and non-ptomb must be inserted before
-                 * last non-ptomb instead of always inserting
-                 * at previous position.
-                 */
-                val->bv_free = *val_prevp;
-                *val_prevp = val;
-                val_prevp = &val->bv_free;
+    merge.cm_pending = merge.cm_partc - 1;
 
-                ++unsorted;
-                continue;
-            }
+    for (i = 1; i < merge.cm_partc; ++i) {
+        INIT_WORK(&merge.cm_partv[i]->cp_work, c0sk_ingest_merge_cb);
+        queue_work(c0sk->c0sk_wq_merge, &merge.cm_partv[i]->cp_work);
+    }
 
-            /* Otherwise, append value to the tail of the list.
-             */
-            val_prevp = val_tailp;
-            *val_tailp = val;
-            val_tailp = &val->bv_free;
+    merge.cm_partv[0]->cp_err = c0sk_ingest_merge(&merge, merge.cm_partv[0]);
 
-            if (HSE_CORE_IS_PTOMB(val->bv_valuep))
-                pt_seqno_prev = seqno;
-            else
-                seqno_prev = seqno;
-        }
+    mutex_lock(&merge.cm_lock);
+    while (merge.cm_pending > 0)
+        cv_wait(&merge.cm_cv, &merge.cm_lock);
+    mutex_unlock(&merge.cm_lock);
 
-        if (have_val && skidx != skidx_prev) {
-            skidx_prev = skidx;
-            bldr = bldrs[skidx];
-            if (!bldr) {
-                cn = c0sk->c0sk_cnv[skidx];
-                assert(cn);
-                err = kvset_builder_create(
-                    &bldr,
-                    cn,
-                    cn_get_ingest_perfc(c0sk->c0sk_cnv[skidx]),
-                    get_time_ns(),
-                    KVSET_BUILDER_FLAGS_INGEST);
-                if (ev(err))
-                    goto health_err;
-
-                kvset_builder_set_agegroup(bldr, HSE_MPOLICY_AGE_ROOT);
-
-                bldrs[skidx] = bldr;
-            }
-        }
+    last = NULL;
+    for (i = 0; i < merge.cm_partc; ++i) {
+        if (!err)
+            err = merge.cm_partv[i]->cp_err;
+        if (merge.cm_partv[i]->cp_last_kv)
+            last = merge.cm_partv[i];
     }
 
-    if (val_head) {
-        *val_tailp = NULL;
+    if (ev(err))
+        goto health_err;
 
-        err = c0sk_builder_add(bldr, kvms, bkv_prev, val_head, unsorted);
-        if (ev(err))
-            goto health_err;
+    c0sk_ingest_nspk_update(c0sk, ingest, get_time_ns() - tmerge);
 
-        val_head = NULL;
+    if (last) {
+        last_skidx = last->cp_last_skidx;
+        last_key = bn_kv_key(last->cp_last_kv, last_kbuf);
+        last_klen = last->cp_last_klen;
     }
 
     if (debug)
         ingest->t4 = get_time_ns();
 
-    for (i = 0; i < HSE_KVS_COUNT_MAX; ++i) {
-        if (bldrs[i] == 0)
-            continue;
-
-        mbc[i] = 1;
-        mbv[i] = &mblocks[i];
-        err = kvset_builder_get_mblocks(bldrs[i], &mblocks[i]);
-        if (ev(err))
-            goto health_err;
-    }
+    err = c0sk_ingest_mblocks(&merge, mbv, mbc);
+    if (ev(err))
+        goto health_err;
 
     if (debug)
         ingest->t5 = get_time_ns();
@@ -669,15 +1175,6 @@ health_err:
         kvdb_health_error(c0sk->c0sk_kvdb_health, err);
 
 exit_err:
-    if (err) {
-        *val_tailp = NULL;
-
-        while ((val = val_head)) {
-            val_head = val->bv_free;
-            val->bv_free = NULL;
-        }
-    }
-
     mutex_lock(&c0sk->c0sk_kvms_mutex);
     while (1) {
         if (kvms == c0sk_get_last_c0kvms(&c0sk->c0sk_handle))
@@ -712,6 +1209,17 @@ exit_err:
     if (ev(err))
         hse_elog(HSE_ERR "c0 ingest failed on %p: @@e", err, kvms);
 
+    for (i = 0; i < HSE_KVS_COUNT_MAX; ++i) {
+        if (!mbv[i])
+            continue;
+
+        for (j = 0; j < mbc[i]; ++j)
+            kvset_mblocks_destroy(&mbv[i][j]);
+
+        if (mbv[i] != &mblocks[i])
+            free(mbv[i]);
+    }
+
     for (i = 0; i < HSE_KVS_COUNT_MAX; ++i) {
         if (bldrs[i] == 0)
             continue;
@@ -722,6 +1230,12 @@ exit_err:
         bldrs[i] = NULL;
     }
 
+    if (merge.cm_partv[0] != &part0)
+        c0sk_ingest_parts_destroy(&merge);
+
+    cv_destroy(&merge.cm_cv);
+    mutex_destroy(&merge.cm_lock);
+
     if (debug) {
         ingest->t7 = get_time_ns();
 
@@ -856,7 +1370,12 @@ c0sk_coalesce(struct c0sk_impl *self, struct c0_kvmultiset *kvms)
         self->c0sk_coalesce_head = NULL;
         self->c0sk_coalesce_sz = 0;
         self->c0sk_coalesce_cnt = 0;
-    } else {
+    }
+
+    /* Range tombstones are gathered from c0iw_coalscedkvms[] at ingest
+     * time, so record the kvms here if it was not coalesced into @old.
+     */
+    if (new) {
         new->c0iw_coalscedkvms[0] = kvms;
         new->c0iw_coalescec = 1;
     }
@@ -925,6 +1444,10 @@ c0sk_rcu_sync_cb(struct work_struct *work)
         }
 
         c0kvms_finalize(kvms, self->c0sk_wq_maint);
+
+        if (self->c0sk_wq_index)
+            c0kvms_index_build(kvms, self->c0sk_wq_index);
+
         c0sk_coalesce(self, kvms);
     }
 
@@ -1061,6 +1584,61 @@ conc2width(struct c0sk_impl *self, uint conc)
     return min_t(uint, cwtab[conc], self->c0sk_ingest_width_max);
 }
 
+/* Contended c0kvset lock acquisitions per thousand above which the
+ * next kvms is widened, and below which it may be narrowed.
+ */
+#define C0SK_CONT_HI (20)
+#define C0SK_CONT_LO (2)
+
+/**
+ * c0sk_ingest_feedback() - adjust a width hint from measured costs
+ * @self:   ptr to c0sk_impl
+ * @usage:  usage statistics of most recently ingested kvms
+ * @width:  width hint based on concurrency
+ * @contp:  (output) contended lock acquisitions per thousand
+ *
+ * Writers contending on c0kvset locks argue for a wider kvms, whereas
+ * a kvms that takes longer to merge than it took to fill (or a backlog
+ * of kvms awaiting ingest) argues for a narrower one, since the merge
+ * cost per key grows with the width.
+ */
+static uint
+c0sk_ingest_feedback(struct c0sk_impl *self, struct c0_usage *usage, uint width, uint *contp)
+{
+    u64  now, fill_ns, merge_ns;
+    uint prev, cont;
+    bool merge_bound;
+
+    now = get_time_ns();
+    fill_ns = now - self->c0sk_ingest_tuned;
+    self->c0sk_ingest_tuned = now;
+
+    prev = self->c0sk_ingest_width;
+    cont = 0;
+
+    if (usage->u_lockops > 0)
+        cont = usage->u_lockcont * 1000 / usage->u_lockops;
+
+    *contp = cont;
+
+    if (cont >= C0SK_CONT_HI)
+        return max_t(uint, width, prev + prev / 4 + 1);
+
+    if (cont >= C0SK_CONT_LO)
+        return width;
+
+    merge_ns = atomic64_read(&self->c0sk_ingest_nspk) * (usage->u_keys + usage->u_tombs);
+    merge_bound = merge_ns * 2 > fill_ns;
+
+    if (self->c0sk_sensor && throttle_sensor_get(self->c0sk_sensor) > THROTTLE_SENSOR_SCALE / 2)
+        merge_bound = true;
+
+    if (merge_bound)
+        width = min_t(uint, width, prev - prev / 8);
+
+    return width;
+}
+
 /**
  * c0sk_ingest_tune() - dynamically tune c0sk for next ingest buffer size
  * @self:       ptr to c0sk_impl
@@ -1073,9 +1651,10 @@ c0sk_ingest_tune(struct c0sk_impl *self, struct c0_usage *usage)
 
     size_t oldsz, newsz, pct_used, pct_diff;
     bool   changed;
-    uint   width;
+    uint   width, cont;
 
     oldsz = pct_used = pct_diff = 0;
+    cont = 0;
 
     /* c1_replay() requires a maximally provisioned kvms, as does a
      * mongod replication secondary node (the latter to reduce contention
@@ -1107,11 +1686,14 @@ c0sk_ingest_tune(struct c0sk_impl *self, struct c0_usage *usage)
     }
 
     /* Determine the ingest width hint for the next ingest based on
-     * the number of threads waiting for this ingest to complete.
+     * the number of threads waiting for this ingest to complete,
+     * as adjusted by c0kvset lock contention and ingest merge cost.
      */
     width = rp->c0_ingest_width;
     if (width == 0) {
         width = conc2width(self, self->c0sk_ingest_conc);
+        width = c0sk_ingest_feedback(self, usage, width, &cont);
+        width = clamp_t(uint, width, HSE_C0_INGEST_WIDTH_MIN, self->c0sk_ingest_width_max);
 
         if (width < self->c0sk_ingest_width)
             width = (width + self->c0sk_ingest_width * 15) / 16;
@@ -1163,7 +1745,8 @@ errout:
     if (rp->c0_debug & C0_DEBUG_INGTUNE && changed)
         hse_log(
             HSE_NOTICE "%s: used %zu%% diff %zu%%, %zu -> %zu (%zu) "
-                       "width %u/%u, conc %u, keys %lu",
+                       "width %u/%u, conc %u, keys %lu, cont %u/1000, "
+                       "wait %lu, nspk %lu",
             __func__,
             pct_used,
             pct_diff,
@@ -1173,7 +1756,10 @@ errout:
             width,
             self->c0sk_ingest_width_max,
             self->c0sk_ingest_conc,
-            usage->u_keys);
+            usage->u_keys,
+            cont,
+            (ulong)(usage->u_lockcont ? usage->u_lockwait / usage->u_lockcont : 0),
+            (ulong)atomic64_read(&self->c0sk_ingest_nspk));
 }
 
 BullseyeCoverageSaveOff
@@ -1264,6 +1850,12 @@ genchk:
             &new);
 
         created = !err;
+        if (created) {
+            c0kvms_numa_bind(new, self->c0sk_numa_nodes);
+
+            if (self->c0sk_pfx_dedup)
+                c0kvms_pfx_dedup(new, self->c0sk_pfx_lenv);
+        }
     }
 
     if (new) {
@@ -1332,6 +1924,103 @@ again:
     return ev(err);
 }
 
+void
+c0sk_numa_rec(struct c0sk_impl *self, struct c0_kvset *c0kvs, u32 cidx)
+{
+    static __thread struct {
+        uint node;
+        uint cnt;
+    } tls;
+
+    uint cpuid;
+    int  node;
+
+    if (!perfc_ison(&self->c0sk_pc_op, cidx))
+        return;
+
+    node = c0kvs_numa_node(c0kvs);
+    if (node < 0)
+        return;
+
+    /* getcpu() is a system call, so refresh the calling thread's
+     * node only once every so often.
+     */
+    if (tls.cnt++ % 64 == 0) {
+        if (syscall(SYS_getcpu, &cpuid, &tls.node))
+            tls.node = 0;
+    }
+
+    perfc_inc(&self->c0sk_pc_op, (int)tls.node == node ? cidx : cidx + 1);
+}
+
+void
+c0sk_cache_inval(struct c0sk_impl *self, u32 skidx, const struct kvs_ktuple *kt, bool put)
+{
+    struct kvs_vcache *vc = self->c0sk_vcachev[skidx];
+    struct cn *        cn = self->c0sk_cnv[skidx];
+    size_t             pfx_len = 0;
+    bool               found;
+    u64                seq;
+
+    if (!vc && !(put && self->c0sk_negc))
+        return;
+
+    /* The seqno must be read after the write became visible in c0.
+     */
+    smp_mb();
+    seq = atomic64_read(self->c0sk_kvdb_seq);
+
+    if (vc)
+        kvs_vcache_invalidate(vc, kt, seq);
+
+    /* A delete cannot make a cached miss stale.
+     */
+    if (!put || !self->c0sk_negc)
+        return;
+
+    /* Only probes for exactly the kvs prefix are cached, as a put can
+     * then invalidate every probe that would find it.
+     */
+    if (cn && cn_get_sfx_len(cn) > 0)
+        pfx_len = cn_get_cparams(cn)->cp_pfx_len;
+
+    found = c0_negc_invalidate(
+        self->c0sk_negc, c0_negc_tag(skidx, false, kt->kt_data, kt->kt_len), seq);
+
+    if (pfx_len > 0 && kt->kt_len >= pfx_len)
+        found |= c0_negc_invalidate(
+            self->c0sk_negc, c0_negc_tag(skidx, true, kt->kt_data, pfx_len), seq);
+
+    if (found)
+        perfc_inc(&self->c0sk_pc_op, PERFC_RA_C0SKOP_NEGC_INVAL);
+}
+
+void
+c0sk_vcache_flush(struct c0sk_impl *self, u32 skidx)
+{
+    struct kvs_vcache *vc = self->c0sk_vcachev[skidx];
+
+    if (!vc)
+        return;
+
+    smp_mb();
+    kvs_vcache_flush(vc, atomic64_read(self->c0sk_kvdb_seq));
+}
+
+void
+c0sk_pfx_dedup_enable(struct c0sk_impl *self)
+{
+    struct c0_kvmultiset *c0kvms;
+
+    self->c0sk_pfx_dedup = true;
+
+    rcu_read_lock();
+    c0kvms = c0sk_get_first_c0kvms(&self->c0sk_handle);
+    if (c0kvms)
+        c0kvms_pfx_dedup(c0kvms, self->c0sk_pfx_lenv);
+    rcu_read_unlock();
+}
+
 static merr_t
 c0sk_merge_bkv(
     struct c0sk_impl *    self,
@@ -1345,6 +2034,10 @@ c0sk_merge_bkv(
     merr_t             err;
     u32                skidx;
     size_t             sfx_len;
+    bool               put, ptomb;
+
+    /* Transaction kvmses never split keys. */
+    assert(!bkv->bkv_pfx_len);
 
     kvs_ktuple_init_nohash(&kt, bkv->bkv_key, key_imm_klen(&bkv->bkv_key_imm));
 
@@ -1354,6 +2047,7 @@ c0sk_merge_bkv(
 
     c0kvs = c0kvms_get_hashed_c0kvset(dst, kt.kt_hash);
     err = 0;
+    put = ptomb = false;
 
     bv = bkv->bkv_values;
     while (bv) {
@@ -1361,13 +2055,16 @@ c0sk_merge_bkv(
             struct kvs_vtuple vt;
 
             kvs_vtuple_init(&vt, bv->bv_value, bv->bv_xlen);
+            vt.vt_expiry = bv->bv_expiry;
             err = c0kvs_put(c0kvs, skidx, &kt, &vt, seqnoref);
+            put = true;
         } else if (bv->bv_valuep == HSE_CORE_TOMB_REG) {
             err = c0kvs_del(c0kvs, skidx, &kt, seqnoref);
         } else {
             assert(bv->bv_valuep == HSE_CORE_TOMB_PFX);
 
             err = c0kvs_prefix_del(c0kvms_ptomb_c0kvset_get(dst), skidx, &kt, seqnoref);
+            ptomb = true;
         }
 
         if (ev(err))
@@ -1376,6 +2073,11 @@ c0sk_merge_bkv(
         bv = bv->bv_next;
     }
 
+    if (ptomb)
+        c0sk_vcache_flush(self, skidx);
+    else
+        c0sk_cache_inval(self, skidx, &kt, put);
+
     return err;
 }
 
@@ -1559,16 +2261,25 @@ c0sk_putdel(
 
         kvs = c0kvms_get_hashed_c0kvset(dst, kt->kt_hash);
 
+        if (self->c0sk_numa_nodes > 1 && op != C0SK_OP_PREFIX_DEL)
+            c0sk_numa_rec(self, kvs, PERFC_RA_C0SKOP_PUT_LOCAL);
+
         if (op == C0SK_OP_PUT) {
             err = c0kvs_put(kvs, skidx, kt, vt, seqnoref);
+            if (!err)
+                c0sk_cache_inval(self, skidx, kt, true);
         } else if (op == C0SK_OP_DEL) {
             err = c0kvs_del(kvs, skidx, kt, seqnoref);
+            if (!err)
+                c0sk_cache_inval(self, skidx, kt, false);
         } else {
             assert(op == C0SK_OP_PREFIX_DEL);
 
             /* Ignore hashed kvset. Use ptomb kvset. */
             kvs = c0kvms_ptomb_c0kvset_get(dst);
             err = c0kvs_prefix_del(kvs, skidx, kt, seqnoref);
+            if (!err)
+                c0sk_vcache_flush(self, skidx);
         }
 
         assert(!c0kvms_is_finalized(dst)); /* See c0kvs_putdel() */
@@ -1592,6 +2303,173 @@ c0sk_putdel(
     return err;
 }
 
+merr_t
+c0sk_rangedel(
+    struct c0sk_impl *       self,
+    u32                      skidx,
+    const struct kvs_ktuple *start,
+    const struct kvs_ktuple *end,
+    u64 *                    seqno)
+{
+    u64    coalescesz = self->c0sk_kvdb_rp->c0_coalesce_sz;
+    merr_t err;
+
+    while (1) {
+        struct c0_kvmultiset *dst;
+
+        rcu_read_lock();
+        dst = c0sk_get_first_c0kvms(&self->c0sk_handle);
+        if (ev(!dst, HSE_WARNING)) {
+            rcu_read_unlock();
+            return merr(EINVAL);
+        }
+
+        if (ev(c0kvms_should_ingest(dst, coalescesz)) && atomic_read(&self->c0sk_replaying) == 0)
+            err = merr(ENOMEM);
+        else
+            err = c0kvms_rtomb_add(dst, skidx, start, end, seqno);
+
+        assert(!c0kvms_is_finalized(dst)); /* See c0sk_putdel() */
+
+        if (merr_errno(err) == ENOMEM)
+            c0kvms_getref(dst);
+
+        rcu_read_unlock();
+
+        if (merr_errno(err) != ENOMEM)
+            break;
+
+        c0sk_queue_ingest(self, dst, NULL);
+        c0kvms_putref(dst);
+    }
+
+    if (!err)
+        c0sk_vcache_flush(self, skidx);
+
+    return err;
+}
+
+/* Max number of ops c0sk_putdel_batch() sorts and applies per pass */
+#define C0SK_PUTDEL_BATCH_MAX (256)
+
+static __always_inline uint
+c0sk_batch_op_setidx(const struct c0sk_batch_op *op, uint width)
+{
+    /* Must agree with c0kvms_get_hashed_c0kvset() */
+    return 1 + (op->op_kt.kt_hash % (width - 1));
+}
+
+merr_t
+c0sk_putdel_batch(
+    struct c0sk_impl *    self,
+    struct c0sk_batch_op *opv,
+    uint                  opc,
+    uintptr_t             seqnoref)
+{
+    struct c0sk_batch_op *pendv[C0SK_PUTDEL_BATCH_MAX];
+    struct c0sk_batch_op *sortv[C0SK_PUTDEL_BATCH_MAX];
+    uint                  endv[HSE_C0_INGEST_WIDTH_MAX + 2];
+    u64                   coalescesz = self->c0sk_kvdb_rp->c0_coalesce_sz;
+    struct c0sk_batch_op *batchv = opv;
+    uint                  batchc = opc;
+    u64                   start = 0;
+    merr_t                err = 0;
+    uint                  pendc = 0;
+    uint                  i;
+
+    while (opc > 0 || pendc > 0) {
+        struct c0_kvmultiset *dst;
+        uint                  width, beg, nput;
+
+        /* Refill the pending vector from the caller's ops.  Ops left
+         * pending from a failed pass are retried first.
+         */
+        while (opc > 0 && pendc < NELEM(pendv)) {
+            pendv[pendc++] = opv++;
+            --opc;
+        }
+
+        rcu_read_lock();
+        dst = c0sk_get_first_c0kvms(&self->c0sk_handle);
+        if (ev(!dst, HSE_WARNING)) {
+            rcu_read_unlock();
+            return merr(EINVAL);
+        }
+
+        if (ev(c0kvms_should_ingest(dst, coalescesz)) && atomic_read(&self->c0sk_replaying) == 0) {
+            err = merr(ENOMEM);
+            goto unlock;
+        }
+
+        if (c0kvms_is_tracked(dst))
+            start = jclock_ns;
+
+        /* Stable counting sort of the pending ops by target c0kvset,
+         * such that each c0kvset's mutex is acquired just once per
+         * pass while the ops on any given key retain their order.
+         */
+        width = c0kvms_width(dst);
+        assert(width > 1 && width < NELEM(endv));
+
+        memset(endv, 0, sizeof(endv[0]) * (width + 1));
+
+        for (i = 0; i < pendc; ++i)
+            endv[c0sk_batch_op_setidx(pendv[i], width) + 1]++;
+
+        for (i = 1; i <= width; ++i)
+            endv[i] += endv[i - 1];
+
+        for (i = 0; i < pendc; ++i)
+            sortv[endv[c0sk_batch_op_setidx(pendv[i], width)]++] = pendv[i];
+
+        /* endv[i] is now the end of c0kvset i's ops in sortv[] */
+        for (i = beg = 0; i < width; beg = endv[i++]) {
+            if (beg == endv[i])
+                continue;
+
+            err = c0kvs_putdelv(
+                c0kvms_get_c0kvset(dst, i), sortv + beg, endv[i] - beg, seqnoref, &nput);
+            if (err) {
+                beg += nput;
+                break;
+            }
+        }
+
+        /* On error, retain the unapplied ops for the next pass.
+         */
+        pendc = err ? pendc - beg : 0;
+        if (pendc > 0)
+            memmove(pendv, sortv + beg, sizeof(pendv[0]) * pendc);
+
+        assert(!c0kvms_is_finalized(dst)); /* See c0kvs_putdel() */
+
+    unlock:
+        if (merr_errno(err) == ENOMEM)
+            c0kvms_getref(dst);
+
+        rcu_read_unlock();
+
+        if (err && merr_errno(err) != ENOMEM)
+            break;
+
+        if (err) {
+            c0sk_queue_ingest(self, dst, NULL);
+            c0kvms_putref(dst);
+            err = 0;
+        }
+    }
+
+    if (start > 0)
+        c0skm_reqtime_set(self->c0sk_mhandle, start);
+
+    /* Invalidating an op that failed to apply is harmless.
+     */
+    for (i = 0; i < batchc; ++i)
+        c0sk_cache_inval(self, batchv[i].op_skidx, &batchv[i].op_kt, !batchv[i].op_tomb);
+
+    return err;
+}
+
 merr_t
 c0sk_kvset_builder_create(struct c0sk *c0sk, u32 skidx, struct kvset_builder **bldrout)
 {
@@ -1639,3 +2517,4 @@ c0sk_get_mhandle(struct c0sk *handle)
 #if defined(HSE_UNIT_TEST_MODE) && HSE_UNIT_TEST_MODE == 1
 #include "c0sk_internal_ut_impl.i"
 #endif /* HSE_UNIT_TEST_MODE */
+
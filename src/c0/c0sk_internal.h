@@ -17,7 +17,11 @@
 
 struct rcu_head;
 struct c0_kvmultiset;
+struct c0_kvset;
+struct c0_negc;
+struct kvs_vcache;
 struct csched;
+struct c0sk_merge;
 
 #define TOMBSPAN_INVALIDATE_COUNT 256
 #define c0sk_h2r(handle) container_of(handle, struct c0sk_impl, c0sk_handle)
@@ -32,6 +36,8 @@ struct c0sk {
  * @c0sk_ds:              mpool dataset
  * @c0sk_wq_ingest        workqueue for ingest processing (one thread)
  * @c0sk_wq_maint         workqueue for concurrent maintenance tasks
+ * @c0sk_wq_merge         workqueue for the key range merges of an ingest
+ * @c0sk_wq_index         workqueue for indexing frozen kvms (may be NULL)
  * @c0sk_mtx_pool:        mutex/condvar pool for ingest synchronization
  * @c0sk_kvms_mutex:      mutex protecting the list of c0_kvmultisets
  * @c0sk_kvmultisets_cnt: how many struct c0_kvmultiset's does this c0sk have
@@ -51,6 +57,16 @@ struct c0sk {
  * @c0sk_ingest_conc:     number of waiters for last ingest
  * @c0sk_ingest_width:    ingest width hint/suggestion to use for next kvms
  * @c0sk_cheap_sz:        ingest cheap size hint to use for next kvms create
+ * @c0sk_ingest_tuned:    time of last ingest tuning (nsecs)
+ * @c0sk_ingest_nspk:     moving average of ingest merge time per key (nsecs)
+ * @c0sk_numa_nodes:      number of nodes over which to spread c0kvsets
+ * @c0sk_negc:            negative lookup cache (may be NULL)
+ * @c0sk_vcachev:         value cache of each registered kvs (may be NULL)
+ * @c0sk_vcache_floor:    values read at older views may not be cached
+ * @c0sk_vcache_busy:     number of commits in progress, values read while
+ *                        it is not zero may not be cached
+ * @c0sk_pfx_dedup:       new kvms store key prefixes once per c0kvset
+ * @c0sk_pfx_lenv:        prefix length of each registered kvs
  * @c0sk_closing:         set to %true when c0sk is closing
  * @c0sk_release_gen:     generation count of most recently released multiset
  * @c0sk_mpname:          mpool name
@@ -68,12 +84,16 @@ struct c0sk_impl {
     struct mpool *           c0sk_ds;      /* not owned by c0sk */
     struct workqueue_struct *c0sk_wq_ingest;
     struct workqueue_struct *c0sk_wq_maint;
+    struct workqueue_struct *c0sk_wq_merge;
+    struct workqueue_struct *c0sk_wq_index;
     struct mtx_pool *        c0sk_mtx_pool;
     struct kvdb_health *     c0sk_kvdb_health;
     struct kvdb_callback *   c0sk_callback; /* not owned by c0sk */
     struct csched *          c0sk_csched;
     struct throttle_sensor * c0sk_sensor;
     struct cn *              c0sk_cnv[HSE_KVS_COUNT_MAX];
+    u8                       c0sk_pfx_lenv[HSE_KVS_COUNT_MAX];
+    struct kvs_vcache *      c0sk_vcachev[HSE_KVS_COUNT_MAX];
 
     __aligned(SMP_CACHE_BYTES) struct mutex c0sk_kvms_mutex;
     s32                  c0sk_kvmultisets_cnt;
@@ -97,6 +117,13 @@ struct c0sk_impl {
     u32      c0sk_ingest_width_max;
     u32      c0sk_ingest_width;
     u32      c0sk_cheap_sz;
+    u32      c0sk_numa_nodes;
+    struct c0_negc *c0sk_negc;
+    atomic64_t c0sk_vcache_floor;
+    atomic_t   c0sk_vcache_busy;
+    bool     c0sk_pfx_dedup;
+    u64      c0sk_ingest_tuned;
+    atomic64_t c0sk_ingest_nspk;
     int      c0sk_nslpmin;
     u64      c0sk_release_gen;
 
@@ -177,6 +204,18 @@ c0sk_install_c0kvms(struct c0sk_impl *self, struct c0_kvmultiset *old, struct c0
 void
 c0sk_release_multiset(struct c0sk_impl *self, struct c0_kvmultiset *multiset);
 
+/**
+ * c0sk_ingest_parts_create() - create the parts of a parallel ingest
+ * @merge:  merge state, with cm_partc and cm_splitv[] initialized
+ *
+ * Each part gets its own iterator over each c0kvset of the ingest,
+ * positioned at the first key of its range.  On failure no parts remain
+ * and the caller falls back to a single merge.
+ */
+/* MTF_MOCK */
+merr_t
+c0sk_ingest_parts_create(struct c0sk_merge *merge);
+
 /**
  * flush_current_multiset() - enqueue current kvmultiset for ingest
  * @self:   struct c0sk owning the struct c0_kvmultiset
@@ -232,9 +271,90 @@ c0sk_putdel(
     const struct kvs_vtuple *vt,
     uintptr_t                seqnoref);
 
+/**
+ * c0sk_putdel_batch() - apply a vector of puts and tombstones
+ * @self:        struct c0sk_impl in which to put
+ * @opv:         vector of ops
+ * @opc:         number of ops in @opv
+ * @seqnoref:    seqnoref for all ops
+ *
+ * Batched counterpart of c0sk_putdel(), see c0sk_putdelv().
+ */
+merr_t
+c0sk_putdel_batch(
+    struct c0sk_impl *    self,
+    struct c0sk_batch_op *opv,
+    uint                  opc,
+    uintptr_t             seqnoref);
+
+/**
+ * c0sk_rangedel() - add a range tombstone to the active kvms
+ * @self:        struct c0sk_impl in which to delete
+ * @skidx:       which kvs the range delete is targeted to
+ * @start:       first key of the range (inclusive)
+ * @end:         end key of the range (exclusive)
+ * @seqno:       (output) seqno assigned to the range tombstone
+ */
+merr_t
+c0sk_rangedel(
+    struct c0sk_impl *       self,
+    u32                      skidx,
+    const struct kvs_ktuple *start,
+    const struct kvs_ktuple *end,
+    u64 *                    seqno);
+
 struct cn *
 c0sk_get_cn(struct c0sk_impl *c0sk, u64 skidx);
 
+/**
+ * c0sk_numa_rec() - count a c0kvset access as node-local or remote
+ * @self:       struct c0sk_impl
+ * @c0kvs:      the c0kvset accessed
+ * @cidx:       local counter index (the remote counter must follow it)
+ *
+ * Does nothing unless the counters are enabled and the c0kvset is
+ * bound to a NUMA node (see c0kvs_numa_bind()).
+ */
+void
+c0sk_numa_rec(struct c0sk_impl *self, struct c0_kvset *c0kvs, u32 cidx);
+
+/**
+ * c0sk_cache_inval() - drop a written key from the lookup caches
+ * @self:       struct c0sk_impl
+ * @skidx:      kvs index of the key
+ * @kt:         the key
+ * @put:        %true if the key was put, %false if it was deleted
+ *
+ * Drops the key from its kvs's value cache and, if it was put, drops both
+ * the key and (if its kvs is suffixed) the key's kvs prefix as seen by
+ * prefix probes from the negative cache.  Must be called after the write
+ * has been applied to c0.
+ */
+void
+c0sk_cache_inval(struct c0sk_impl *self, u32 skidx, const struct kvs_ktuple *kt, bool put);
+
+/**
+ * c0sk_vcache_flush() - empty the value cache of one kvs
+ * @self:       struct c0sk_impl
+ * @skidx:      kvs index
+ *
+ * For writes that may affect any number of keys, i.e., prefix and range
+ * deletes.  Must be called after the write has been applied to c0.
+ */
+void
+c0sk_vcache_flush(struct c0sk_impl *self, u32 skidx);
+
+/**
+ * c0sk_pfx_dedup_enable() - intern key prefixes in c0
+ * @self:       struct c0sk_impl
+ *
+ * Applies to the active kvms and to all kvms created hereafter.  Must
+ * only be called once it is known that mutations will not be tracked,
+ * as c1 requires contiguous keys.
+ */
+void
+c0sk_pfx_dedup_enable(struct c0sk_impl *self);
+
 #if defined(HSE_UNIT_TEST_MODE) && HSE_UNIT_TEST_MODE == 1
 #include "c0sk_internal_ut.h"
 #endif
@@ -23,6 +23,16 @@ struct perfc_name c0sk_perfc_op[] = {
     NE(PERFC_LT_C0SKOP_PUT, 3, "Latency of c0sk puts", "l_put(/s)"),
     NE(PERFC_RA_C0SKOP_DEL, 3, "Count of c0sk dels", "c_del(/s)"),
     NE(PERFC_LT_C0SKOP_DEL, 3, "Latency of c0sk dels", "l_del(/s)"),
+    NE(PERFC_RA_C0SKOP_FILTER_PROBE, 3, "Count of c0kvset filter probes", "c_fprobe(/s)"),
+    NE(PERFC_RA_C0SKOP_FILTER_SKIP, 3, "Count of c0kvset searches skipped", "c_fskip(/s)"),
+    NE(PERFC_RA_C0SKOP_PUT_LOCAL, 3, "Count of node-local c0kvset puts", "c_putl(/s)"),
+    NE(PERFC_RA_C0SKOP_PUT_REMOTE, 3, "Count of remote-node c0kvset puts", "c_putr(/s)"),
+    NE(PERFC_RA_C0SKOP_GET_LOCAL, 3, "Count of node-local c0kvset gets", "c_getl(/s)"),
+    NE(PERFC_RA_C0SKOP_GET_REMOTE, 3, "Count of remote-node c0kvset gets", "c_getr(/s)"),
+    NE(PERFC_RA_C0SKOP_NEGC_HIT, 3, "Count of negative cache hits", "c_negchit(/s)"),
+    NE(PERFC_RA_C0SKOP_NEGC_MISS, 3, "Count of negative cache misses", "c_negcmiss(/s)"),
+    NE(PERFC_RA_C0SKOP_NEGC_INSERT, 3, "Count of negative cache inserts", "c_negcins(/s)"),
+    NE(PERFC_RA_C0SKOP_NEGC_INVAL, 3, "Count of negative cache invalidates", "c_negcinv(/s)"),
 };
 
 struct perfc_name c0sk_perfc_ingest[] = {
@@ -32,6 +42,9 @@ struct perfc_name c0sk_perfc_ingest[] = {
     NE(PERFC_DI_C0SKING_KVMSDSIZE, 2, "kvms size", "c_kvmsdsz(mb)"),
 
     NE(PERFC_BA_C0SKING_WIDTH, 3, "Ingest width", "d_width"),
+    NE(PERFC_BA_C0SKING_HEAP, 3, "Cheap memory mapped (MiB)", "d_heap(mb)"),
+    NE(PERFC_BA_C0SKING_HUGETLB, 3, "Cheap memory in hugetlb pages (MiB)", "d_hugetlb(mb)"),
+    NE(PERFC_BA_C0SKING_THP, 3, "Cheap memory advised for THP (MiB)", "d_thp(mb)"),
     NE(PERFC_DI_C0SKING_THRSR, 3, "Throttle sensor", "c_thrsr", 10),
     NE(PERFC_DI_C0SKING_MEM, 3, "Ingest memory limit", "c_ingmem"),
 };
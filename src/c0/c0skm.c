@@ -48,6 +48,10 @@ c0skm_open(struct c0sk *handle, struct kvdb_rparams *rp, struct c1 *c1h, const c
 
     if (!c1h || rp->read_only) {
         self->c0sk_mhandle = NULL;
+
+        if (rp->c0_pfx_dedup && !rp->read_only)
+            c0sk_pfx_dedup_enable(self);
+
         return 0;
     }
 
@@ -312,6 +312,9 @@ kvb_builder_kvtuple_add(
 
     klen = key_imm_klen(&bkv->bkv_key_imm);
 
+    /* c1 requires contiguous keys (see c0kvs_pfx_dedup()). */
+    assert(!bkv->bkv_pfx_len);
+
     c1_kvtuple_init(kvt, klen, bkv->bkv_key, cnid, skidx, bkv);
 
     c1_kvbundle_set_seqno(kvb, minseqno, maxseqno);
@@ -465,7 +468,7 @@ kvb_builder_vtuple_add(
         if (*maxseqno < seqno)
             *maxseqno = seqno;
 
-        c1_vtuple_init(cvt, len, seqno, data, tomb);
+        c1_vtuple_init(cvt, len, seqno, data, tomb ? 0 : val->bv_expiry, tomb);
 
         c1_kvtuple_addval(ckvt, cvt, &tail);
     }
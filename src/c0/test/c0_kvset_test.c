@@ -23,6 +23,7 @@
 #include <assert.h>
 #include <stdlib.h>
 #include <unistd.h>
+#include <pthread.h>
 
 int
 test_collection_setup(struct mtf_test_info *info)
@@ -1021,4 +1022,188 @@ MTF_DEFINE_UTEST_PREPOST(c0_kvset_test, iterator, no_fail_pre, no_fail_post)
     c0kvs_destroy(kvs);
 }
 
+struct concurrent_put_arg {
+    struct c0_kvset *kvs;
+    u32              base;
+    u32              nkeys;
+    merr_t           err;
+};
+
+static void *
+concurrent_put_main(void *arg)
+{
+    struct concurrent_put_arg *cpa = arg;
+    struct kvs_ktuple          kt;
+    struct kvs_vtuple          vt;
+    u32                        key, val;
+    u32                        i, j;
+
+    /* Put each key twice so that both the insert and replace
+     * paths run concurrently with other threads.
+     */
+    for (j = 0; j < 2; ++j) {
+        for (i = 0; i < cpa->nkeys; ++i) {
+            key = cpu_to_be32(cpa->base + i);
+            val = cpa->base + i + j;
+
+            kvs_ktuple_init(&kt, &key, sizeof(key));
+            kvs_vtuple_init(&vt, &val, sizeof(val));
+
+            cpa->err = c0kvs_put(cpa->kvs, 0, &kt, &vt, HSE_ORDNL_TO_SQNREF(j));
+            if (cpa->err)
+                return NULL;
+        }
+    }
+
+    return NULL;
+}
+
+MTF_DEFINE_UTEST_PREPOST(c0_kvset_test, concurrent_put, no_fail_pre, no_fail_post)
+{
+    struct concurrent_put_arg argv[8];
+    pthread_t                 tidv[8];
+    struct c0_kvset *         kvs;
+    struct kvs_ktuple         kt;
+    struct kvs_buf            vb;
+    enum key_lookup_res       res;
+    uintptr_t                 oseqnoref;
+    merr_t                    err;
+    u32                       key, val;
+    u32                       nkeys = 1000;
+    int                       i, j, rc;
+
+    err = c0kvs_create(HSE_C0_CHEAP_SZ_DFLT, 0, 0, false, &kvs);
+    ASSERT_EQ(0, err);
+
+    for (i = 0; i < NELEM(tidv); ++i) {
+        argv[i].kvs = kvs;
+        argv[i].base = i * nkeys;
+        argv[i].nkeys = nkeys;
+        argv[i].err = 0;
+
+        rc = pthread_create(tidv + i, NULL, concurrent_put_main, argv + i);
+        ASSERT_EQ(0, rc);
+    }
+
+    for (i = 0; i < NELEM(tidv); ++i) {
+        rc = pthread_join(tidv[i], NULL);
+        ASSERT_EQ(0, rc);
+        ASSERT_EQ(0, argv[i].err);
+    }
+
+    ASSERT_EQ(NELEM(tidv) * nkeys * 2, c0kvs_get_element_count(kvs));
+
+    for (i = 0; i < NELEM(tidv); ++i) {
+        for (j = 0; j < nkeys; ++j) {
+            key = cpu_to_be32(i * nkeys + j);
+
+            kvs_ktuple_init(&kt, &key, sizeof(key));
+            kvs_buf_init(&vb, &val, sizeof(val));
+
+            res = (enum key_lookup_res) - 1;
+            err = c0kvs_get_excl(kvs, 0, &kt, 1, 0, &res, &vb, &oseqnoref);
+            ASSERT_EQ(0, err);
+            ASSERT_EQ(FOUND_VAL, res);
+            ASSERT_EQ(i * nkeys + j + 1, val);
+        }
+    }
+
+    synchronize_rcu();
+    rcu_barrier();
+
+    c0kvs_destroy(kvs);
+}
+
+MTF_DEFINE_UTEST_PREPOST(c0_kvset_test, filter, no_fail_pre, no_fail_post)
+{
+    struct c0_kvset * kvs;
+    struct kvs_ktuple kt;
+    struct kvs_vtuple vt;
+    const int         nkeys = 4096;
+    int               i, fp;
+    merr_t            err;
+    u64               key;
+
+    err = c0kvs_create(HSE_C0_CHEAP_SZ_DFLT, 0, 0, false, &kvs);
+    ASSERT_EQ(0, err);
+
+    for (i = 0; i < nkeys; ++i) {
+        key = i;
+        kvs_ktuple_init(&kt, &key, sizeof(key));
+        kvs_vtuple_init(&vt, &key, sizeof(key));
+
+        if (i % 2)
+            err = c0kvs_put(kvs, 0, &kt, &vt, HSE_ORDNL_TO_SQNREF(i));
+        else
+            err = c0kvs_del(kvs, 0, &kt, HSE_ORDNL_TO_SQNREF(i));
+        ASSERT_EQ(0, err);
+    }
+
+    /* No false negatives, and few false positives.
+     */
+    for (i = fp = 0; i < nkeys * 2; ++i) {
+        key = i;
+        kvs_ktuple_init(&kt, &key, sizeof(key));
+
+        if (i < nkeys)
+            ASSERT_TRUE(c0kvs_may_contain(kvs, kt.kt_hash));
+        else
+            fp += c0kvs_may_contain(kvs, kt.kt_hash);
+    }
+
+    ASSERT_LT(fp, nkeys / 20);
+
+    /* The filter is cleared by a reset.
+     */
+    c0kvs_reset(kvs, 0);
+
+    for (i = fp = 0; i < nkeys; ++i) {
+        key = i;
+        kvs_ktuple_init(&kt, &key, sizeof(key));
+        fp += c0kvs_may_contain(kvs, kt.kt_hash);
+    }
+
+    ASSERT_EQ(0, fp);
+
+    c0kvs_destroy(kvs);
+}
+
+MTF_DEFINE_UTEST(c0_kvset_test, lock_usage)
+{
+    struct c0_kvset * kvs;
+    struct c0_usage   usage;
+    struct kvs_ktuple kt;
+    struct kvs_vtuple vt;
+    const int         nkeys = 1000;
+    merr_t            err;
+    u64               key;
+    int               i;
+
+    err = c0kvs_create(HSE_C0_CHEAP_SZ_DFLT, 0, 0, false, &kvs);
+    ASSERT_EQ(0, err);
+
+    for (i = 0; i < nkeys; ++i) {
+        key = i;
+        kvs_ktuple_init(&kt, &key, sizeof(key));
+        kvs_vtuple_init(&vt, &key, sizeof(key));
+
+        err = c0kvs_put(kvs, 0, &kt, &vt, HSE_ORDNL_TO_SQNREF(i));
+        ASSERT_EQ(0, err);
+    }
+
+    /* Every put takes the c0kvs lock, none of them contended.
+     */
+    c0kvs_usage(kvs, &usage);
+    ASSERT_GE(usage.u_lockops, nkeys);
+    ASSERT_EQ(0, usage.u_lockcont);
+    ASSERT_EQ(0, usage.u_lockwait);
+
+    c0kvs_reset(kvs, 0);
+
+    c0kvs_usage(kvs, &usage);
+    ASSERT_EQ(0, usage.u_lockops);
+
+    c0kvs_destroy(kvs);
+}
+
 MTF_END_UTEST_COLLECTION(c0_kvset_test)
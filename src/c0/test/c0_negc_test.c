@@ -0,0 +1,148 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2015-2020 Micron Technology, Inc.  All rights reserved.
+ */
+
+#include <hse_ut/framework.h>
+#include <hse_util/hse_err.h>
+
+#include "../c0_negc.h"
+
+static u64
+negc_tag(u32 skidx, uint i)
+{
+    char buf[32];
+    int  n = snprintf(buf, sizeof(buf), "key%08u", i);
+
+    return c0_negc_tag(skidx, false, buf, n);
+}
+
+MTF_BEGIN_UTEST_COLLECTION(c0_negc_test)
+
+MTF_DEFINE_UTEST(c0_negc_test, create)
+{
+    struct c0_negc *nc;
+    merr_t          err;
+
+    err = c0_negc_create(0, &nc);
+    ASSERT_EQ(EINVAL, merr_errno(err));
+    ASSERT_EQ(NULL, nc);
+
+    err = c0_negc_create(1 << 20, &nc);
+    ASSERT_EQ(0, err);
+    ASSERT_NE(NULL, nc);
+
+    c0_negc_destroy(nc);
+    c0_negc_destroy(NULL);
+}
+
+MTF_DEFINE_UTEST(c0_negc_test, tags)
+{
+    /* The same key in different kvs, or as a probe, has distinct tags. */
+    ASSERT_NE(negc_tag(0, 1), negc_tag(1, 1));
+    ASSERT_NE(c0_negc_tag(0, false, "key", 3), c0_negc_tag(0, true, "key", 3));
+    ASSERT_EQ(negc_tag(3, 7), negc_tag(3, 7));
+    ASSERT_NE(0, c0_negc_tag(0, false, "", 0));
+}
+
+MTF_DEFINE_UTEST(c0_negc_test, insert_invalidate)
+{
+    struct c0_negc *nc;
+    merr_t          err;
+    u64             tag = negc_tag(0, 1);
+
+    err = c0_negc_create(1 << 20, &nc);
+    ASSERT_EQ(0, err);
+
+    ASSERT_FALSE(c0_negc_lookup(nc, tag));
+    ASSERT_TRUE(c0_negc_insert(nc, tag, 10));
+    ASSERT_TRUE(c0_negc_lookup(nc, tag));
+    ASSERT_FALSE(c0_negc_lookup(nc, negc_tag(0, 2)));
+
+    ASSERT_TRUE(c0_negc_invalidate(nc, tag, 20));
+    ASSERT_FALSE(c0_negc_lookup(nc, tag));
+    ASSERT_FALSE(c0_negc_invalidate(nc, tag, 20));
+
+    /* A miss seen at a view older than the write may not be cached. */
+    ASSERT_FALSE(c0_negc_insert(nc, tag, 10));
+    ASSERT_FALSE(c0_negc_insert(nc, tag, 20));
+    ASSERT_FALSE(c0_negc_lookup(nc, tag));
+
+    ASSERT_TRUE(c0_negc_insert(nc, tag, 21));
+    ASSERT_TRUE(c0_negc_lookup(nc, tag));
+
+    c0_negc_destroy(nc);
+}
+
+MTF_DEFINE_UTEST(c0_negc_test, hold_release)
+{
+    struct c0_negc *nc;
+    merr_t          err;
+    u64             tag = negc_tag(0, 1);
+
+    err = c0_negc_create(1 << 20, &nc);
+    ASSERT_EQ(0, err);
+
+    c0_negc_hold(nc);
+    c0_negc_hold(nc);
+    ASSERT_FALSE(c0_negc_insert(nc, tag, 10));
+
+    /* An abandoned commit leaves the floor alone. */
+    c0_negc_release(nc, 0);
+    ASSERT_FALSE(c0_negc_insert(nc, tag, 10));
+
+    c0_negc_release(nc, 30);
+    ASSERT_FALSE(c0_negc_insert(nc, tag, 29));
+    ASSERT_TRUE(c0_negc_insert(nc, tag, 30));
+    ASSERT_TRUE(c0_negc_lookup(nc, tag));
+
+    c0_negc_destroy(nc);
+}
+
+MTF_DEFINE_UTEST(c0_negc_test, flush)
+{
+    struct c0_negc *nc;
+    merr_t          err;
+    uint            i;
+
+    err = c0_negc_create(1 << 20, &nc);
+    ASSERT_EQ(0, err);
+
+    for (i = 0; i < 1000; ++i)
+        ASSERT_TRUE(c0_negc_insert(nc, negc_tag(0, i), 10));
+
+    c0_negc_flush(nc, 40);
+
+    for (i = 0; i < 1000; ++i)
+        ASSERT_FALSE(c0_negc_lookup(nc, negc_tag(0, i)));
+
+    ASSERT_FALSE(c0_negc_insert(nc, negc_tag(0, 1), 40));
+    ASSERT_TRUE(c0_negc_insert(nc, negc_tag(0, 1), 41));
+
+    c0_negc_destroy(nc);
+}
+
+MTF_DEFINE_UTEST(c0_negc_test, full)
+{
+    struct c0_negc *nc;
+    merr_t          err;
+    uint            i, hits;
+
+    /* Two buckets per shard hold at most 8 tags each. */
+    err = c0_negc_create(16 * 2 * 40, &nc);
+    ASSERT_EQ(0, err);
+
+    for (i = 0; i < 10000; ++i)
+        ASSERT_TRUE(c0_negc_insert(nc, negc_tag(0, i), 10));
+
+    hits = 0;
+    for (i = 0; i < 10000; ++i)
+        hits += c0_negc_lookup(nc, negc_tag(0, i));
+
+    ASSERT_GT(hits, 0);
+    ASSERT_LE(hits, 16 * 2 * 4);
+
+    c0_negc_destroy(nc);
+}
+
+MTF_END_UTEST_COLLECTION(c0_negc_test)
@@ -0,0 +1,165 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2015-2020 Micron Technology, Inc.  All rights reserved.
+ */
+
+#include <hse_util/platform.h>
+#include <hse_util/timing.h>
+#include <hse_util/seqno.h>
+
+#include <hse_ikvdb/limits.h>
+#include <hse_ikvdb/c0_kvset.h>
+#include <hse_ikvdb/tuple.h>
+
+#include <getopt.h>
+#include <pthread.h>
+
+#ifdef NDEBUG
+const unsigned long keys_per_thread = 256 * 1024;
+#else
+const unsigned long keys_per_thread = 16 * 1024;
+#endif
+
+struct put_thread {
+    pthread_t          pt_tid;
+    struct c0_kvset *  pt_kvs;
+    pthread_barrier_t *pt_barrier;
+    u64                pt_base;
+    unsigned long      pt_nkeys;
+    unsigned long      pt_nput;
+};
+
+static void *
+put_thread(void *arg)
+{
+    struct put_thread *pt = arg;
+    struct kvs_ktuple  kt;
+    struct kvs_vtuple  vt;
+    unsigned long      i;
+    u64                key, val;
+    merr_t             err;
+
+    pthread_barrier_wait(pt->pt_barrier);
+
+    for (i = 0; i < pt->pt_nkeys; ++i) {
+        key = cpu_to_be64(pt->pt_base + i);
+        val = i;
+
+        kvs_ktuple_init(&kt, &key, sizeof(key));
+        kvs_vtuple_init(&vt, &val, sizeof(val));
+
+        err = c0kvs_put(pt->pt_kvs, 0, &kt, &vt, HSE_ORDNL_TO_SQNREF(i));
+        if (err)
+            break;
+
+        ++pt->pt_nput;
+    }
+
+    return NULL;
+}
+
+static int
+run_put_perf(unsigned int nthreads)
+{
+    struct put_thread *ptv;
+    pthread_barrier_t  barrier;
+    struct c0_kvset *  kvs;
+    unsigned long      nput = 0;
+    u64                tstart, tstop;
+    merr_t             err;
+    int                i, rc;
+
+    err = c0kvs_create(HSE_C0_CHEAP_SZ_MAX, 0, 0, false, &kvs);
+    if (err) {
+        fprintf(stderr, "c0kvs_create failed: %d\n", merr_errno(err));
+        return -1;
+    }
+
+    ptv = calloc(nthreads, sizeof(*ptv));
+    if (!ptv) {
+        c0kvs_destroy(kvs);
+        return -1;
+    }
+
+    pthread_barrier_init(&barrier, NULL, nthreads + 1);
+
+    for (i = 0; i < nthreads; ++i) {
+        ptv[i].pt_kvs = kvs;
+        ptv[i].pt_barrier = &barrier;
+        ptv[i].pt_base = (u64)i << 32;
+        ptv[i].pt_nkeys = keys_per_thread;
+
+        rc = pthread_create(&ptv[i].pt_tid, NULL, put_thread, ptv + i);
+        if (rc) {
+            fprintf(stderr, "pthread_create failed: %d\n", rc);
+            exit(-1);
+        }
+    }
+
+    pthread_barrier_wait(&barrier);
+    tstart = get_time_ns();
+
+    for (i = 0; i < nthreads; ++i) {
+        pthread_join(ptv[i].pt_tid, NULL);
+        nput += ptv[i].pt_nput;
+    }
+
+    tstop = get_time_ns();
+
+    printf(
+        "%8u %12lu %12.3f %12.0f %12zu\n",
+        nthreads,
+        nput,
+        (tstop - tstart) / 1000000.0,
+        nput * 1000000000.0 / (tstop - tstart),
+        c0kvs_used(kvs));
+
+    pthread_barrier_destroy(&barrier);
+    free(ptv);
+    c0kvs_destroy(kvs);
+
+    return 0;
+}
+
+void
+usage(void)
+{
+    fprintf(stderr, "Usage: [-t max_threads]\n");
+}
+
+int
+main(int argc, char *argv[])
+{
+    unsigned int maxthreads = 0;
+    unsigned int n;
+    int          opt;
+
+    while ((opt = getopt(argc, argv, "t:h")) != -1) {
+        switch (opt) {
+            case 't':
+                maxthreads = strtoul(optarg, NULL, 0);
+                break;
+            case 'h':
+            default:
+                usage();
+                exit(opt == 'h' ? 0 : -1);
+        }
+    }
+
+    if (maxthreads == 0)
+        maxthreads = min_t(unsigned int, num_online_cpus(), 16);
+
+    printf("\n# c0kvs_put() scaling, %lu keys per thread\n", keys_per_thread);
+    printf("%8s %12s %12s %12s %12s\n", "threads", "puts", "msecs", "puts/sec", "used");
+
+    for (n = 1; n <= maxthreads; n *= 2)
+        if (run_put_perf(n))
+            return -1;
+
+#ifndef NDEBUG
+    printf("\nNote: this is a debug build. "
+           "Use a release build for better performance.\n\n");
+#endif
+
+    return 0;
+}
@@ -11,6 +11,8 @@
 #include <hse_util/slab.h>
 #include <hse_util/page.h>
 #include <hse_util/seqno.h>
+#include <hse_util/keycmp.h>
+#include <hse_util/key_util.h>
 
 #include <hse_ikvdb/limits.h>
 #include <hse_ikvdb/c0.h>
@@ -100,6 +102,7 @@ mocks_set(struct mtf_test_info *info)
     mapi_inject(mapi_idx_kvset_builder_get_mblocks, 0);
     mapi_inject(mapi_idx_kvset_builder_add_key, 0);
     mapi_inject(mapi_idx_kvset_builder_add_val, 0);
+    mapi_inject(mapi_idx_kvset_builder_add_val_expiry, 0);
     mapi_inject(mapi_idx_kvset_builder_add_nonval, 0);
     mapi_inject(mapi_idx_kvset_builder_add_vref, 0);
     mapi_inject(mapi_idx_kvset_builder_destroy, 0);
@@ -613,6 +616,352 @@ MTF_DEFINE_UTEST_PREPOST(c0sk_test, ingest_fail, no_fail_pre, no_fail_post)
     destroy_mock_cn(mock_cn);
 }
 
+/* Parallel ingest merges
+ *
+ * The builders below record the keys and range tombstones of each kvset,
+ * and the mblocks they return carry the builder in bl_vused so that
+ * cn_ingestv() can check the kvsets of each kvs arrive in key order.
+ */
+#define PARTS_KEYS 2500
+
+struct parts_bldr {
+    uint keys;
+    uint rtombs;
+    bool sorted;
+    uint minklen;
+    uint maxklen;
+    char minkey[32];
+    char maxkey[32];
+};
+
+static bool     parts_sorted;
+static uint     parts_kvsetv[HSE_KVS_COUNT_MAX];
+static uint     parts_keyv[HSE_KVS_COUNT_MAX];
+static uint     parts_rtombv[HSE_KVS_COUNT_MAX];
+static uint     parts_createc;
+static merr_t   parts_create_err;
+static int      parts_fail_nth;
+
+static __thread int parts_calloc_fail = -1;
+
+static merr_t
+parts_bldr_create(
+    struct kvset_builder **builder_out,
+    struct cn *            cn,
+    struct perfc_set *     pc,
+    u64                    vgroup,
+    uint                   flags)
+{
+    struct parts_bldr *bldr;
+
+    bldr = calloc(1, sizeof(*bldr));
+    if (!bldr)
+        return merr(ENOMEM);
+
+    bldr->sorted = true;
+
+    *builder_out = (struct kvset_builder *)bldr;
+    return 0;
+}
+
+static merr_t
+parts_bldr_add_key(struct kvset_builder *builder, const struct key_obj *kobj)
+{
+    struct parts_bldr *bldr = (struct parts_bldr *)builder;
+    char               key[sizeof(bldr->maxkey)];
+    uint               klen;
+
+    key_obj_copy(key, sizeof(key), &klen, kobj);
+
+    if (bldr->keys == 0) {
+        memcpy(bldr->minkey, key, klen);
+        bldr->minklen = klen;
+    } else if (keycmp(bldr->maxkey, bldr->maxklen, key, klen) >= 0) {
+        bldr->sorted = false;
+    }
+
+    memcpy(bldr->maxkey, key, klen);
+    bldr->maxklen = klen;
+    bldr->keys++;
+
+    return 0;
+}
+
+static merr_t
+parts_bldr_add_rtomb(struct kvset_builder *builder, const struct rtomb *rt)
+{
+    ((struct parts_bldr *)builder)->rtombs++;
+    return 0;
+}
+
+static merr_t
+parts_bldr_get_mblocks(struct kvset_builder *builder, struct kvset_mblocks *mblocks)
+{
+    memset(mblocks, 0, sizeof(*mblocks));
+    mblocks->bl_vused = (uintptr_t)builder;
+    return 0;
+}
+
+static void
+parts_bldr_destroy(struct kvset_builder *builder)
+{
+    free(builder);
+}
+
+static merr_t
+parts_cn_ingestv(
+    struct cn **           cn,
+    struct kvset_mblocks **mbv,
+    int *                  mbc,
+    u32 *                  vcommitted,
+    u64                    ingestid,
+    int                    ingestc,
+    bool *                 ingested,
+    u64 *                  seqno)
+{
+    int i, j;
+
+    for (i = 0; i < ingestc; i++) {
+        struct parts_bldr *prev = NULL;
+
+        if (!cn[i] || !mbv[i])
+            continue;
+
+        parts_kvsetv[i] = max_t(uint, parts_kvsetv[i], mbc[i]);
+
+        for (j = 0; j < mbc[i]; j++) {
+            struct parts_bldr *bldr = (void *)(uintptr_t)mbv[i][j].bl_vused;
+
+            if (!bldr->sorted)
+                parts_sorted = false;
+
+            if (prev && bldr->keys &&
+                keycmp(prev->maxkey, prev->maxklen, bldr->minkey, bldr->minklen) >= 0)
+                parts_sorted = false;
+
+            parts_keyv[i] += bldr->keys;
+            parts_rtombv[i] += bldr->rtombs;
+            prev = bldr;
+        }
+    }
+
+    *ingested = true;
+    *seqno = 10000;
+
+    return 0;
+}
+
+/* Fail the nth calloc() made by c0sk_ingest_parts_create(), i.e., that
+ * of its nth part.
+ */
+static void *
+parts_calloc(size_t n, size_t sz)
+{
+    if (parts_calloc_fail >= 0 && parts_calloc_fail-- == 0)
+        return NULL;
+
+    return fail_nth_calloc(n, sz);
+}
+
+static merr_t
+parts_create(struct c0sk_merge *merge)
+{
+    merr_t err;
+
+    parts_calloc_fail = parts_fail_nth;
+    err = mtfm_c0sk_internal_c0sk_ingest_parts_create_getreal()(merge);
+    parts_calloc_fail = -1;
+
+    parts_createc++;
+    parts_create_err = err;
+
+    return err;
+}
+
+int
+parts_pre(struct mtf_test_info *info)
+{
+    no_fail_pre(info);
+
+    mapi_inject_unset(mapi_idx_kvset_builder_add_key);
+    mapi_inject_unset(mapi_idx_kvset_builder_get_mblocks);
+    mapi_inject_unset(mapi_idx_kvset_builder_destroy);
+
+    MOCK_SET_FN(kvset_builder, kvset_builder_create, parts_bldr_create);
+    MOCK_SET_FN(kvset_builder, kvset_builder_add_key, parts_bldr_add_key);
+    MOCK_SET_FN(kvset_builder, kvset_builder_add_rtomb, parts_bldr_add_rtomb);
+    MOCK_SET_FN(kvset_builder, kvset_builder_get_mblocks, parts_bldr_get_mblocks);
+    MOCK_SET_FN(kvset_builder, kvset_builder_destroy, parts_bldr_destroy);
+    MOCK_SET_FN(c0sk_internal, c0sk_ingest_parts_create, parts_create);
+    mtfm_allocation_calloc_set(parts_calloc);
+
+    parts_sorted = true;
+    memset(parts_kvsetv, 0, sizeof(parts_kvsetv));
+    memset(parts_keyv, 0, sizeof(parts_keyv));
+    memset(parts_rtombv, 0, sizeof(parts_rtombv));
+    parts_createc = 0;
+    parts_create_err = 0;
+    parts_fail_nth = -1;
+
+    return 0;
+}
+
+int
+parts_post(struct mtf_test_info *info)
+{
+    mtfm_allocation_calloc_set(fail_nth_calloc);
+    MOCK_UNSET_FN(c0sk_internal, c0sk_ingest_parts_create);
+    MOCK_UNSET_FN(kvset_builder, kvset_builder_add_key);
+    MOCK_UNSET_FN(kvset_builder, kvset_builder_add_rtomb);
+    MOCK_UNSET_FN(kvset_builder, kvset_builder_get_mblocks);
+    MOCK_UNSET_FN(kvset_builder, kvset_builder_destroy);
+    MOCK_SET(kvset_builder, _kvset_builder_create);
+    MOCK_UNSET_FN(cn, cn_ingestv);
+
+    return no_fail_post(info);
+}
+
+/* Put PARTS_KEYS keys of 1000 byte values into each of two kvses, add a
+ * range tombstone to the second if asked, and ingest them all at once.
+ * With c0_ingest_part_mb lowered to 1 the ingest is split four ways.
+ */
+static merr_t
+parts_ingest(bool rtomb)
+{
+    struct kvdb_rparams kvdb_rp;
+    struct kvs_rparams  kvs_rp;
+    struct kvs_ktuple   kt, end;
+    struct kvs_vtuple   vt;
+    struct mock_kvdb    mkvdb;
+    struct cn *         mock_cnv[2];
+    atomic64_t          seqno;
+    char                key[16];
+    char                val[1000];
+    u16                 skidx;
+    u64                 rtseq;
+    merr_t              err;
+    int                 i, j;
+
+    kvdb_rp = kvdb_rparams_defaults();
+    kvs_rp = kvs_rparams_defaults();
+
+    kvdb_rp.c0_ingest_parts = 4;
+    kvdb_rp.c0_ingest_part_mb = 1;
+
+    atomic64_set(&seqno, 0);
+    err = c0sk_open(&kvdb_rp, 0, "mock_mp", &mock_health, csched, &seqno, &mkvdb.ikdb_c0sk);
+    if (err)
+        return err;
+
+    for (i = 0; i < NELEM(mock_cnv); i++) {
+        err = create_mock_cn(&mock_cnv[i], false, false, &kvs_rp, 0);
+        if (err)
+            return err;
+
+        err = c0sk_c0_register(mkvdb.ikdb_c0sk, mock_cnv[i], &skidx);
+        if (err)
+            return err;
+    }
+
+    MOCK_SET_FN(cn, cn_ingestv, parts_cn_ingestv);
+
+    memset(val, 'v', sizeof(val));
+    kvs_vtuple_init(&vt, val, sizeof(val));
+
+    for (i = 0; i < NELEM(mock_cnv); i++) {
+        for (j = 0; j < PARTS_KEYS; j++) {
+            snprintf(key, sizeof(key), "key%05d", j);
+            kvs_ktuple_init(&kt, key, strlen(key));
+
+            err = c0sk_put(mkvdb.ikdb_c0sk, i, &kt, &vt, HSE_SQNREF_SINGLE);
+            if (err)
+                return err;
+        }
+    }
+
+    if (rtomb) {
+        kvs_ktuple_init(&kt, "key00100", 8);
+        kvs_ktuple_init(&end, "key00200", 8);
+
+        err = c0sk_range_del(mkvdb.ikdb_c0sk, 1, &kt, &end, &rtseq);
+        if (err)
+            return err;
+    }
+
+    err = c0sk_sync(mkvdb.ikdb_c0sk);
+    if (err)
+        return err;
+
+    err = c0sk_close(mkvdb.ikdb_c0sk);
+
+    for (i = 0; i < NELEM(mock_cnv); i++)
+        destroy_mock_cn(mock_cnv[i]);
+
+    return err;
+}
+
+MTF_DEFINE_UTEST_PREPOST(c0sk_test, ingest_parts, parts_pre, parts_post)
+{
+    merr_t err;
+
+    err = parts_ingest(false);
+    ASSERT_EQ(0, err);
+
+    ASSERT_GE(parts_createc, 1);
+    ASSERT_EQ(0, parts_create_err);
+
+    /* Split keys within a kvs give it a kvset from each part that
+     * covers it, and together the parts add every key in order.
+     */
+    ASSERT_GT(parts_kvsetv[0] + parts_kvsetv[1], 2);
+    ASSERT_EQ(PARTS_KEYS, parts_keyv[0]);
+    ASSERT_EQ(PARTS_KEYS, parts_keyv[1]);
+    ASSERT_TRUE(parts_sorted);
+}
+
+MTF_DEFINE_UTEST_PREPOST(c0sk_test, ingest_parts_kvs, parts_pre, parts_post)
+{
+    merr_t err;
+
+    err = parts_ingest(true);
+    ASSERT_EQ(0, err);
+
+    ASSERT_GE(parts_createc, 1);
+    ASSERT_EQ(0, parts_create_err);
+
+    /* With range tombstones, the split moves to the start of the second
+     * kvs.  The first part must then end with the first kvs, so only the
+     * second part adds the range tombstone.
+     */
+    ASSERT_EQ(1, parts_kvsetv[0]);
+    ASSERT_EQ(1, parts_kvsetv[1]);
+    ASSERT_EQ(0, parts_rtombv[0]);
+    ASSERT_EQ(1, parts_rtombv[1]);
+    ASSERT_EQ(PARTS_KEYS, parts_keyv[0]);
+    ASSERT_EQ(PARTS_KEYS, parts_keyv[1]);
+    ASSERT_TRUE(parts_sorted);
+}
+
+MTF_DEFINE_UTEST_PREPOST(c0sk_test, ingest_parts_fail, parts_pre, parts_post)
+{
+    merr_t err;
+
+    /* Failing to allocate the second part falls back to one merge. */
+    parts_fail_nth = 1;
+
+    err = parts_ingest(false);
+    ASSERT_EQ(0, err);
+
+    ASSERT_GE(parts_createc, 1);
+    ASSERT_EQ(ENOMEM, merr_errno(parts_create_err));
+
+    ASSERT_EQ(1, parts_kvsetv[0]);
+    ASSERT_EQ(1, parts_kvsetv[1]);
+    ASSERT_EQ(PARTS_KEYS, parts_keyv[0]);
+    ASSERT_EQ(PARTS_KEYS, parts_keyv[1]);
+    ASSERT_TRUE(parts_sorted);
+}
+
 MTF_DEFINE_UTEST_PREPOST(c0sk_test, open_test, no_fail_pre, no_fail_post)
 {
     struct kvdb_rparams   kvdb_rp;
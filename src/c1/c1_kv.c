@@ -13,14 +13,14 @@ _Static_assert(
     "Insufficient c1 kvcache size");
 
 static merr_t
-c1_kvcache_create_internal(struct c1_kvcache *cc, size_t alloc_sz)
+c1_kvcache_create_internal(struct c1_kvcache *cc, size_t alloc_sz, uint huge)
 {
     struct cheap *cheap;
 
     cc->c1kvc_free = true;
     mutex_init(&cc->c1kvc_lock);
 
-    cheap = cheap_create(16, alloc_sz);
+    cheap = cheap_create_huge(16, alloc_sz, huge);
     if (!cheap)
         return merr(ev(ENOMEM));
 
@@ -30,7 +30,7 @@ c1_kvcache_create_internal(struct c1_kvcache *cc, size_t alloc_sz)
 }
 
 merr_t
-c1_kvcache_create(struct c1 *c1)
+c1_kvcache_create(struct c1 *c1, uint huge)
 {
     merr_t err;
     int    i;
@@ -39,7 +39,7 @@ c1_kvcache_create(struct c1 *c1)
     alloc_sz = HSE_C1_CACHE_SIZE / HSE_C1_DEFAULT_STRIPE_WIDTH;
 
     for (i = 0; i < HSE_C1_DEFAULT_STRIPE_WIDTH; i++) {
-        err = c1_kvcache_create_internal(&c1->c1_kvc[i], alloc_sz);
+        err = c1_kvcache_create_internal(&c1->c1_kvc[i], alloc_sz, huge);
         if (ev(err)) {
             while (--i >= 0)
                 c1_kvcache_destroy_internal(&c1->c1_kvc[i]);
@@ -280,11 +280,13 @@ c1_vtuple_init(
     u64                      xlen,
     u64                      seqno,
     void *                   data,
+    u32                      expiry,
     bool                     tomb)
 {
     cvt->c1vt_xlen = xlen;
     cvt->c1vt_seqno = seqno;
     cvt->c1vt_data = data;
+    cvt->c1vt_expiry = expiry;
     cvt->c1vt_tomb = tomb;
 }
 
@@ -7,7 +7,7 @@
 #define HSE_C1_KV_H
 
 merr_t
-c1_kvcache_create(struct c1 *c1);
+c1_kvcache_create(struct c1 *c1, uint huge);
 
 void
 c1_kvcache_destroy(struct c1 *c1);
@@ -486,6 +486,8 @@ c1_log_issue_kvb(
             omf_set_c1vt_seqno(&vt[j], nextvt->c1vt_seqno);
             omf_set_c1vt_xlen(&vt[j], nextvt->c1vt_xlen);
             omf_set_c1vt_tomb(&vt[j], nextvt->c1vt_tomb ? 1 : 0);
+            omf_set_c1vt_expiry(&vt[j], nextvt->c1vt_expiry);
+            omf_set_c1vt_rsvd(&vt[j], 0);
 
             assert(i < numiov);
 
@@ -78,6 +78,7 @@ struct c1_vtuple {
     u64                      c1vt_xlen;
     u64                      c1vt_seqno;
     void *                   c1vt_data;
+    u32                      c1vt_expiry;
     bool                     c1vt_tomb;
 };
 
@@ -111,7 +112,7 @@ static __always_inline uint
 c1_vtuple_vlen(const struct c1_vtuple *vt)
 {
     uint clen = vt->c1vt_xlen >> 32;
-    uint vlen = vt->c1vt_xlen & 0xfffffffful;
+    uint vlen = vt->c1vt_xlen & (HSE_XLEN_MOP - 1);
 
     return clen ?: vlen;
 }
@@ -80,9 +80,13 @@ struct c1_unpack_hinfo c1_txn_unpackt[] = {
 /* C1_TYPE_VT */
 struct c1_unpack_hinfo c1_vt_unpackt[] = {
     {
-        omf_c1_vtuple_unpack,
+        omf_c1_vtuple_unpack_v1,
         C1_VERSION1,
     },
+    {
+        omf_c1_vtuple_unpack,
+        C1_VERSION2,
+    },
 };
 
 /* C1_TYPE_MBLK */
@@ -488,6 +492,33 @@ omf_c1_treetxn_unpack(char *omf, union c1_record *rec, u32 *omf_len)
     return 0;
 }
 
+merr_t
+omf_c1_vtuple_unpack_v1(char *omf, union c1_record *rec, u32 *omf_len)
+{
+    struct c1_vtuple_omf_v1 *vt_omf;
+    struct c1_vtuple_meta *  vtm;
+
+    if (omf_len)
+        *omf_len = sizeof(*vt_omf);
+
+    if (!omf || !rec)
+        return 0;
+
+    vt_omf = (struct c1_vtuple_omf_v1 *)omf;
+
+    vtm = &rec->v;
+
+    vtm->c1vm_sign = omf_c1vt_sign_v1(vt_omf);
+    vtm->c1vm_seqno = omf_c1vt_seqno_v1(vt_omf);
+    vtm->c1vm_xlen = omf_c1vt_xlen_v1(vt_omf);
+    vtm->c1vm_tomb = omf_c1vt_tomb_v1(vt_omf);
+    vtm->c1vm_logtype = omf_c1vt_logtype_v1(vt_omf);
+    vtm->c1vm_expiry = 0;
+    vtm->c1vm_data = (char *)vt_omf->c1vt_data;
+
+    return 0;
+}
+
 merr_t
 omf_c1_vtuple_unpack(char *omf, union c1_record *rec, u32 *omf_len)
 {
@@ -509,6 +540,7 @@ omf_c1_vtuple_unpack(char *omf, union c1_record *rec, u32 *omf_len)
     vtm->c1vm_xlen = omf_c1vt_xlen(vt_omf);
     vtm->c1vm_tomb = omf_c1vt_tomb(vt_omf);
     vtm->c1vm_logtype = omf_c1vt_logtype(vt_omf);
+    vtm->c1vm_expiry = omf_c1vt_expiry(vt_omf);
     vtm->c1vm_data = (char *)vt_omf->c1vt_data;
 
     return 0;
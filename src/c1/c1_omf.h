@@ -20,7 +20,8 @@ enum {
     C1_INVALID_SEQNO = 0,
     C1_INITIAL_SEQNO = 1,
     C1_VERSION1 = 1,
-    C1_VERSION = C1_VERSION1,
+    C1_VERSION2 = 2,
+    C1_VERSION = C1_VERSION2,
     C1_TYPE_BASE = 10,
     C1_TYPE_VERSION = C1_TYPE_BASE,
     C1_TYPE_INFO = 11,
@@ -182,6 +183,18 @@ _Static_assert(
     "c1_treetxn_omf and c1_kvbundle_omf size mismatch");
 
 struct c1_vtuple_omf {
+    __le64 c1vt_sign;
+    __le64 c1vt_seqno;
+    __le64 c1vt_xlen;
+    __le32 c1vt_tomb;
+    __le32 c1vt_logtype;
+    __le32 c1vt_expiry;
+    __le32 c1vt_rsvd;
+    u8     c1vt_data[0];
+} __packed;
+
+/* Version 1 vtuples carried no value expiry. */
+struct c1_vtuple_omf_v1 {
     __le64 c1vt_sign;
     __le64 c1vt_seqno;
     __le64 c1vt_xlen;
@@ -265,6 +278,14 @@ OMF_SETGET(struct c1_vtuple_omf, c1vt_seqno, 64)
 OMF_SETGET(struct c1_vtuple_omf, c1vt_xlen, 64)
 OMF_SETGET(struct c1_vtuple_omf, c1vt_tomb, 32)
 OMF_SETGET(struct c1_vtuple_omf, c1vt_logtype, 32)
+OMF_SETGET(struct c1_vtuple_omf, c1vt_expiry, 32)
+OMF_SETGET(struct c1_vtuple_omf, c1vt_rsvd, 32)
+
+OMF_GET_VER(struct c1_vtuple_omf_v1, c1vt_sign, 64, v1)
+OMF_GET_VER(struct c1_vtuple_omf_v1, c1vt_seqno, 64, v1)
+OMF_GET_VER(struct c1_vtuple_omf_v1, c1vt_xlen, 64, v1)
+OMF_GET_VER(struct c1_vtuple_omf_v1, c1vt_tomb, 32, v1)
+OMF_GET_VER(struct c1_vtuple_omf_v1, c1vt_logtype, 32, v1)
 
 OMF_SETGET(struct c1_mblk_omf, c1mblk_id, 64)
 OMF_SETGET(struct c1_mblk_omf, c1mblk_off, 32)
@@ -170,6 +170,9 @@ merr_t
 omf_c1_treetxn_unpack(char *omf, union c1_record *rec, u32 *omf_len);
 
 /* C1_TYPE_VT */
+merr_t
+omf_c1_vtuple_unpack_v1(char *omf, union c1_record *rec, u32 *omf_len);
+
 merr_t
 omf_c1_vtuple_unpack(char *omf, union c1_record *rec, u32 *omf_len);
 
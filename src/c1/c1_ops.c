@@ -88,7 +88,7 @@ err_exit:
 }
 
 struct c1 *
-c1_create(const char *mpname)
+c1_create(const char *mpname, uint huge)
 {
     struct c1 *c1;
     merr_t     err;
@@ -128,7 +128,7 @@ c1_create(const char *mpname)
     memset(&c1->c1_pcset_kv, 0, sizeof(c1->c1_pcset_kv));
     memset(&c1->c1_pcset_tree, 0, sizeof(c1->c1_pcset_tree));
 
-    err = c1_kvcache_create(c1);
+    err = c1_kvcache_create(c1, huge);
     if (ev(err)) {
         free_aligned(c1);
         return NULL;
@@ -168,7 +168,7 @@ c1_free(struct mpool *ds, u64 oid1, u64 oid2)
     if (ev(err))
         return err;
 
-    c1 = c1_create(NULL);
+    c1 = c1_create(NULL, CHEAP_HUGE_NONE);
     if (!c1)
         return merr(ev(ENOMEM));
 
@@ -217,7 +217,7 @@ c1_open(
     if (ev(err))
         return err;
 
-    c1 = c1_create(mpname);
+    c1 = c1_create(mpname, rparams->c0_heap_huge);
     if (!c1) {
         err = merr(ev(ENOMEM));
         goto err_exit;
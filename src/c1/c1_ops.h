@@ -87,7 +87,7 @@ BullseyeCoverageRestore
 
 /* MTF_MOCK */
 struct c1 *
-c1_create(const char *mpname);
+c1_create(const char *mpname, uint huge);
 
 void
 c1_destroy(struct c1 *c1);
@@ -444,6 +444,8 @@ c1_tree_replay_nextkey(
             vlen = 0;
 
         kvs_vtuple_init(&vt, vdata, vlen);
+        if (!tomb)
+            vt.vt_expiry = vtm.c1vm_expiry;
 
         err = c1_tree_replay_exec(c1, cnid, seqno, &kt, &vt, tomb);
 
@@ -34,7 +34,7 @@ MTF_DEFINE_UTEST_PREPOST(c1_kvcache_test, basic, test_pre, test_post)
     merr_t              err;
     void *              obj;
 
-    err = c1_kvcache_create(&c1);
+    err = c1_kvcache_create(&c1, CHEAP_HUGE_NONE);
     ASSERT_EQ(0, err);
 
     kvc = c1_get_kvcache(NULL);
@@ -65,7 +65,7 @@ MTF_DEFINE_UTEST_PREPOST(c1_kvcache_test, get, test_pre, test_post)
     struct c1          c1;
     merr_t             err;
 
-    err = c1_kvcache_create(&c1);
+    err = c1_kvcache_create(&c1, CHEAP_HUGE_NONE);
     ASSERT_EQ(0, err);
 
     kvc = c1_get_kvcache(NULL);
@@ -111,6 +111,7 @@ mocks_set(struct mtf_test_info *info)
     mapi_inject(mapi_idx_kvset_builder_get_mblocks, 0);
     mapi_inject(mapi_idx_kvset_builder_add_key, 0);
     mapi_inject(mapi_idx_kvset_builder_add_val, 0);
+    mapi_inject(mapi_idx_kvset_builder_add_val_expiry, 0);
     mapi_inject(mapi_idx_kvset_builder_add_nonval, 0);
     mapi_inject(mapi_idx_kvset_builder_add_vref, 0);
     mapi_inject(mapi_idx_kvset_builder_destroy, 0);
@@ -165,10 +166,10 @@ MTF_DEFINE_UTEST_PREPOST(c1_test, basic, no_fail_pre, no_fail_post)
     kvdb_rp = kvdb_rparams_defaults();
 
     mapi_inject_once_ptr(mapi_idx_malloc, 1, NULL);
-    c1 = c1_create(NULL);
+    c1 = c1_create(NULL, CHEAP_HUGE_NONE);
     ASSERT_EQ(NULL, c1);
 
-    c1 = c1_create("mp");
+    c1 = c1_create("mp", CHEAP_HUGE_NONE);
     ASSERT_NE(NULL, c1);
 
     /* [HSE_REVISIT These map injections should work but don't, so for
@@ -1602,20 +1603,22 @@ upgrade_test_bytype(char *omf, u32 type, u32 omf_len, struct mtf_test_info *lcl_
 
 MTF_DEFINE_UTEST_PREPOST(c1_test, upgrade2, no_fail_pre, no_fail_post)
 {
-    struct c1_info_omf     info_omf = {};
-    struct c1_desc_omf     desc_omf = {};
-    struct c1_ingest_omf   ing_omf = {};
-    struct c1_kvlog_omf    kv_omf = {};
-    struct c1_kvbundle_omf kvb_omf = {};
-    struct c1_kvtuple_omf  kvt_omf = {};
-    struct c1_complete_omf cmp_omf = {};
-    struct c1_reset_omf    res_omf = {};
-    struct c1_treetxn_omf  ttxn_omf = {};
-    struct c1_vtuple_omf   vt_omf = {};
-    struct c1_mblk_omf     mblk_omf = {};
+    struct c1_info_omf      info_omf = {};
+    struct c1_desc_omf      desc_omf = {};
+    struct c1_ingest_omf    ing_omf = {};
+    struct c1_kvlog_omf     kv_omf = {};
+    struct c1_kvbundle_omf  kvb_omf = {};
+    struct c1_kvtuple_omf   kvt_omf = {};
+    struct c1_complete_omf  cmp_omf = {};
+    struct c1_reset_omf     res_omf = {};
+    struct c1_treetxn_omf   ttxn_omf = {};
+    struct c1_vtuple_omf    vt_omf = {};
+    struct c1_vtuple_omf_v1 vt_omf_v1 = {};
+    struct c1_mblk_omf      mblk_omf = {};
 
     union c1_record rec = {};
 
+    u32    len;
     merr_t err;
     char * omf;
 
@@ -1707,9 +1710,25 @@ MTF_DEFINE_UTEST_PREPOST(c1_test, upgrade2, no_fail_pre, no_fail_post)
     upgrade_test_bytype(omf, C1_TYPE_VT, sizeof(vt_omf), lcl_ti);
 
     omf_set_c1vt_xlen(&vt_omf, 1000);
+    omf_set_c1vt_expiry(&vt_omf, 1050);
     err = c1_record_unpack_bytype(omf, C1_TYPE_VT, C1_VERSION, &rec);
     ASSERT_EQ(0, err);
     ASSERT_EQ(c1_vtuple_meta_vlen(&rec.v), 1000);
+    ASSERT_EQ(rec.v.c1vm_expiry, 1050);
+    ASSERT_EQ((char *)vt_omf.c1vt_data, rec.v.c1vm_data);
+
+    /* Version 1 vtuples are shorter and carry no expiry. */
+    omf = (char *)&vt_omf_v1;
+    err = c1_record_type2len(C1_TYPE_VT, C1_VERSION1, &len);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(sizeof(vt_omf_v1), len);
+
+    vt_omf_v1.c1vt_xlen = cpu_to_le64(1000);
+    err = c1_record_unpack_bytype(omf, C1_TYPE_VT, C1_VERSION1, &rec);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(c1_vtuple_meta_vlen(&rec.v), 1000);
+    ASSERT_EQ(rec.v.c1vm_expiry, 0);
+    ASSERT_EQ((char *)vt_omf_v1.c1vt_data, rec.v.c1vm_data);
 
     /* C1_TYPE_MBLK */
     omf = (char *)&mblk_omf;
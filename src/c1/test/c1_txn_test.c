@@ -137,6 +137,7 @@ mocks_set(struct mtf_test_info *info)
     mapi_inject(mapi_idx_kvset_builder_get_mblocks, 0);
     mapi_inject(mapi_idx_kvset_builder_add_key, 0);
     mapi_inject(mapi_idx_kvset_builder_add_val, 0);
+    mapi_inject(mapi_idx_kvset_builder_add_val_expiry, 0);
     mapi_inject(mapi_idx_kvset_builder_add_nonval, 0);
     mapi_inject(mapi_idx_kvset_builder_add_vref, 0);
     mapi_inject(mapi_idx_kvset_builder_destroy, 0);
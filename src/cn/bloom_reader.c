@@ -9,6 +9,7 @@
 #include <hse_util/alloc.h>
 #include <hse_util/slab.h>
 #include <hse_util/bloom_filter.h>
+#include <hse_util/fuse_filter.h>
 #include <hse_util/bitmap.h>
 
 #include <hse_ikvdb/tuple.h>
@@ -34,6 +35,48 @@
  * The rub is to implement it in a way that doesn't clobber performance.
  */
 
+/* Each of the three fuse filter slots may reside in a different page.
+ */
+static merr_t
+bloom_reader_mcache_lookup_fuse(
+    const struct bloom_desc *   desc,
+    const struct kvs_mblk_desc *kbd,
+    u64                         hash,
+    bool *                      hit)
+{
+    off_t  offsetv[FUSE_ARITY];
+    void * pagev[FUSE_ARITY];
+    u32    idxv[FUSE_ARITY];
+    u32    fpbytes = desc->bd_fpbits / 8;
+    u64    mix;
+    u32    fp;
+    merr_t err;
+    int    i;
+
+    mix = fuse_mix(hash, desc->bd_seed);
+    fuse_hash2idx(mix, desc->bd_modulus, 1u << desc->bd_bktshift, idxv);
+
+    for (i = 0; i < FUSE_ARITY; ++i)
+        offsetv[i] = desc->bd_first_page + ((size_t)idxv[i] * fpbytes) / PAGE_SIZE;
+
+    err = mpool_mcache_getpages(kbd->map, FUSE_ARITY, kbd->map_idx, offsetv, pagev);
+    if (ev(err))
+        return err;
+
+    fp = fuse_fingerprint(mix);
+
+    for (i = 0; i < FUSE_ARITY; ++i) {
+        const u8 *page = pagev[i];
+        u32       slot = ((size_t)idxv[i] * fpbytes) % PAGE_SIZE / fpbytes;
+
+        fp ^= fuse_slot(page, desc->bd_fpbits, slot);
+    }
+
+    *hit = (fp & ((1u << desc->bd_fpbits) - 1)) == 0;
+
+    return 0;
+}
+
 merr_t
 bloom_reader_mcache_lookup(
     const struct bloom_desc *   desc,
@@ -50,7 +93,10 @@ bloom_reader_mcache_lookup(
     if (!kt->kt_hash)
         kt->kt_hash = key_hash64(kt->kt_data, kt->kt_len);
 
-    bkt = bf_hash2bkt(kt->kt_hash, desc->bd_modulus, desc->bd_bktshift);
+    if (desc->bd_version == BLOOM_OMF_VERSION6)
+        return bloom_reader_mcache_lookup_fuse(desc, kbd, kt->kt_hash, hit);
+
+    bkt = bloom_desc_hash2bkt(desc, kt->kt_hash);
     offsetv[0] = desc->bd_first_page + bkt / PAGE_SIZE;
 
     err = mpool_mcache_getpages(kbd->map, 1, kbd->map_idx, offsetv, pagev);
@@ -59,7 +105,10 @@ bloom_reader_mcache_lookup(
 
     bitmap = pagev[0] + (bkt % PAGE_SIZE);
 
-    *hit = bf_lookup(kt->kt_hash, bitmap, desc->bd_n_hashes, desc->bd_rotl, desc->bd_bktmask);
+    if (desc->bd_version == BLOOM_OMF_VERSION4)
+        *hit = bf_lookup(kt->kt_hash, bitmap, desc->bd_n_hashes, desc->bd_rotl, desc->bd_bktmask);
+    else
+        *hit = bf_sb_lookup(kt->kt_hash, bitmap);
 
     return 0;
 }
@@ -70,9 +119,21 @@ bloom_reader_buffer_lookup(const struct bloom_desc *desc, const u8 *bitmap, stru
     if (!kt->kt_hash)
         kt->kt_hash = key_hash64(kt->kt_data, kt->kt_len);
 
-    bitmap += bf_hash2bkt(kt->kt_hash, desc->bd_modulus, desc->bd_bktshift);
+    if (desc->bd_version == BLOOM_OMF_VERSION6)
+        return fuse_lookup(
+            kt->kt_hash,
+            bitmap,
+            desc->bd_seed,
+            desc->bd_modulus,
+            1u << desc->bd_bktshift,
+            desc->bd_fpbits);
+
+    bitmap += bloom_desc_hash2bkt(desc, kt->kt_hash);
+
+    if (desc->bd_version == BLOOM_OMF_VERSION4)
+        return bf_lookup(kt->kt_hash, bitmap, desc->bd_n_hashes, desc->bd_rotl, desc->bd_bktmask);
 
-    return bf_lookup(kt->kt_hash, bitmap, desc->bd_n_hashes, desc->bd_rotl, desc->bd_bktmask);
+    return bf_sb_lookup(kt->kt_hash, bitmap);
 }
 
 merr_t
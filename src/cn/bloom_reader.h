@@ -7,19 +7,26 @@
 #define HSE_KVS_CN_BLOOM_READER_H
 
 #include <hse_util/inttypes.h>
+#include <hse_util/bloom_filter.h>
+#include <hse_util/fuse_filter.h>
 
 #include <hse_ikvdb/tuple.h>
 
+#include "omf.h"
+
 struct mpool;
 struct kvs_mblk_desc;
 
 /**
  * struct bloom_desc - a descriptor for reading data from a Bloom filter
  * @bd_blkid:       ID of mblock containing the Bloom filter
+ * @bd_version:     bloom OMF version (determines the probe algorithm)
  * @bd_first_page:  offset, in pages, from start of mblock to data region
  * @bd_n_pages:     size of data region in pages
  * @bd_n_hashes:
  * @bd_n_bits:      size of bloom filter in bits
+ * @bd_seed:        fuse filter seed (v6)
+ * @bd_fpbits:      fuse filter bits per fingerprint (v6)
  *
  * When a kblock is opened for reading, the @bloom_hdr_omf struct is read from
  * media and the relevant information is stored in a @bloom_desc struct.
@@ -29,8 +36,11 @@ struct kvs_mblk_desc;
  *    So, if @bd_first_page=2 and @bd_n_pages=3, then the Bloom
  *    filter data region occupies pages 2,3 and 4 -- which maps
  *    to bytes 2*4096 to 5*4096-1 (end of page 4).
+ *  - For a fuse filter (v6) @bd_modulus is the segment count length
+ *    and @bd_bktshift is log2 of the segment length.
  */
 struct bloom_desc {
+    u32 bd_version;
     u32 bd_modulus;
     u32 bd_bktshift;
     u32 bd_bktmask;
@@ -39,8 +49,35 @@ struct bloom_desc {
     u32 bd_first_page;
     u32 bd_n_pages;
     u32 bd_bktsz;
+    u32 bd_fpbits;
+    u64 bd_seed;
 };
 
+/**
+ * bloom_desc_hash2bkt() - byte offset of the bucket which contains %hash
+ * @desc:       bloom descriptor
+ * @hash:       key hash
+ *
+ * For a fuse filter this is the offset of the first of the three slots.
+ */
+static __always_inline size_t
+bloom_desc_hash2bkt(const struct bloom_desc *desc, u64 hash)
+{
+    if (desc->bd_version == BLOOM_OMF_VERSION4)
+        return bf_hash2bkt(hash, desc->bd_modulus, desc->bd_bktshift);
+
+    if (desc->bd_version == BLOOM_OMF_VERSION6) {
+        u32 idxv[FUSE_ARITY];
+
+        fuse_hash2idx(
+            fuse_mix(hash, desc->bd_seed), desc->bd_modulus, 1u << desc->bd_bktshift, idxv);
+
+        return (size_t)idxv[0] * (desc->bd_fpbits / 8);
+    }
+
+    return bf_sb_hash2bkt(hash, desc->bd_modulus);
+}
+
 #define BLOOM_LOOKUP_NONE (0)
 #define BLOOM_LOOKUP_MCACHE (1)
 #define BLOOM_LOOKUP_BUFFER (2) /* more efficient */
@@ -44,6 +44,7 @@
 #include "cn_tree.h"
 #include "cn_tree_cursor.h"
 #include "cn_tree_create.h"
+#include "cn_tree_iter.h"
 #include "cn_tree_compact.h"
 #include "cn_tree_stats.h"
 #include "cn_mblocks.h"
@@ -123,6 +124,12 @@ cn_get_mclass_policy(const struct cn *cn)
     return cn->cn_mpolicy;
 }
 
+struct merge_op *
+cn_get_merge_op(struct cn *cn)
+{
+    return &cn->cn_mop;
+}
+
 bool
 cn_is_closing(const struct cn *cn)
 {
@@ -329,6 +336,111 @@ cn_get(
     return cn_tree_lookup(cn->cn_tree, &cn->cn_pc_get, kt, seq, res, &qctx, 0, vbuf);
 }
 
+merr_t
+cn_get_batch(
+    struct cn *          cn,
+    struct kvs_ktuple *  ktv,
+    u64                  seq,
+    enum key_lookup_res *resv,
+    struct kvs_buf *     vbufv,
+    uint                 cnt)
+{
+    if (ev(cnt > CN_GET_BATCH_MAX))
+        return merr(EINVAL);
+
+    return cn_tree_lookup_batch(cn->cn_tree, &cn->cn_pc_get, ktv, seq, resv, vbufv, cnt);
+}
+
+merr_t
+cn_get_pinned(
+    struct cn *          cn,
+    struct kvs_ktuple *  kt,
+    u64                  seq,
+    enum key_lookup_res *res,
+    struct kvs_buf *     vbuf,
+    struct cn_vpin *     vpin)
+{
+    struct query_ctx qctx;
+
+    vpin->vp_kvset = NULL;
+
+    qctx.qtype = QUERY_GET_PIN;
+    qctx.vpin = vpin;
+    return cn_tree_lookup(cn->cn_tree, &cn->cn_pc_get, kt, seq, res, &qctx, 0, vbuf);
+}
+
+void
+cn_vpin_release(struct cn_vpin *vpin)
+{
+    if (!vpin->vp_kvset)
+        return;
+
+    kvset_put_ref(vpin->vp_kvset);
+    vpin->vp_kvset = NULL;
+}
+
+static void
+cn_aget_work(struct work_struct *work)
+{
+    struct cn_aget *ag = container_of(work, struct cn_aget, ag_work);
+    struct kvset *  ks = ag->ag_kvset;
+    merr_t          err;
+
+    err = kvset_lookup_val(ks, &ag->ag_vref, ag->ag_vbuf);
+
+    ag->ag_kvset = NULL;
+    kvset_put_ref(ks);
+
+    ag->ag_cb(ag, err);
+}
+
+merr_t
+cn_get_async(
+    struct cn *          cn,
+    struct kvs_ktuple *  kt,
+    u64                  seq,
+    enum key_lookup_res *res,
+    struct kvs_buf *     vbuf,
+    struct cn_aget *     ag,
+    bool *               pendingp)
+{
+    struct query_ctx qctx;
+    struct kvset *   ks;
+    merr_t           err;
+
+    *pendingp = false;
+
+    ag->ag_vbuf = vbuf;
+    ag->ag_kvset = NULL;
+
+    qctx.qtype = QUERY_GET_ASYNC;
+    qctx.aget = ag;
+
+    err = cn_tree_lookup(cn->cn_tree, &cn->cn_pc_get, kt, seq, res, &qctx, 0, vbuf);
+    if (err || !ag->ag_kvset)
+        return err;
+
+    if (cn->cn_aget_wq) {
+        *pendingp = true;
+
+        INIT_WORK(&ag->ag_work, cn_aget_work);
+        queue_work(cn->cn_aget_wq, &ag->ag_work);
+
+        return 0;
+    }
+
+    /* No async get workers (e.g., cn opened without maintenance),
+     * so read the value here.
+     */
+    ks = ag->ag_kvset;
+    ag->ag_kvset = NULL;
+
+    err = kvset_lookup_val(ks, &ag->ag_vref, vbuf);
+    kvset_put_ref(ks);
+
+    return err;
+}
+
 merr_t
 cn_pfx_probe(
     struct cn *          cn,
@@ -675,12 +787,13 @@ cn_ingestv(
 
     merr_t err = 0;
     u64    txid = 0;
-    uint   i, first, last, count, check;
+    uint   i, j, k, first, last, count, check;
     u64    context = 0; /* must be initialized to zero */
     u64    seqno_max = 0, seqno_min = U64_MAX;
     uint   ext_vblk_count = 0;
     bool   log_ingest = false;
     u64    dgen = 0;
+    bool   locked = false;
 
     /* Ingestc can be large (256), and is typically sparse.
      * Remember the first and last index so we don't have
@@ -692,8 +805,10 @@ cn_ingestv(
         if (!cn[i] || !mbc[i] || !mbv[i])
             continue;
 
-        seqno_max = max_t(u64, seqno_max, mbv[i]->bl_seqno_max);
-        seqno_min = min_t(u64, seqno_min, mbv[i]->bl_seqno_min);
+        for (j = 0; j < mbc[i]; j++) {
+            seqno_max = max_t(u64, seqno_max, mbv[i][j].bl_seqno_max);
+            seqno_min = min_t(u64, seqno_min, mbv[i][j].bl_seqno_min);
+        }
 
         if (ev(seqno_min > seqno_max)) {
             err = merr(EINVAL);
@@ -705,7 +820,7 @@ cn_ingestv(
         if (!count)
             first = i;
         last = i;
-        count++;
+        count += mbc[i];
         perfc_inc(&cn[i]->cn_pc_ingest, PERFC_BA_CNCOMP_START);
     }
 
@@ -727,16 +842,29 @@ cn_ingestv(
         goto done;
     }
 
-    kvsetv = calloc(ingestc, sizeof(*kvsetv));
+    kvsetv = calloc(count, sizeof(*kvsetv));
     if (ev(!kvsetv)) {
         err = merr(EINVAL);
         goto done;
     }
 
+    /* A bulk load commit must not take dgens or add kvsets to the root
+     * node of a cn between our doing so, else the root node would fall
+     * out of dgen order.  The locks are taken in cn index order.
+     */
+    for (i = first; i <= last; i++)
+        if (cn[i] && mbc[i] && mbv[i])
+            mutex_lock(&cn[i]->cn_ingest_lock);
+    locked = true;
+
     err = cndb_txn_start(cndb, &txid, ingestid, count, 0, seqno_max);
     if (ev(err))
         goto done;
 
+    /* A cn may receive several kvsets from one ingest (e.g., when c0
+     * ingest splits a large kvs by key range).  They cover disjoint
+     * key ranges, so each simply gets its own dgen.
+     */
     check = 0;
     for (i = first; i <= last; i++) {
         u32 *vcp;
@@ -751,10 +879,13 @@ cn_ingestv(
         if (vcp)
             ext_vblk_count += *vcp;
 
-        err = cn_ingest_prep(cn[i], mbv[i], mbc[i], txid, &context, vcp, &kvsetv[i]);
-        if (ev(err))
-            goto done;
-        check++;
+        for (j = 0; j < mbc[i]; j++) {
+            err = cn_ingest_prep(cn[i], mbv[i] + j, 1, txid, &context, j ? NULL : vcp,
+                                 &kvsetv[check]);
+            if (ev(err))
+                goto done;
+            check++;
+        }
     }
     assert(check == count);
 
@@ -771,18 +902,21 @@ cn_ingestv(
         if (!cn[i] || !mbc[i] || !mbv[i])
             continue;
 
-        if (log_ingest) {
-            kvset_stats_add(kvset_statsp(kvsetv[i]), &kst);
-            dgen = kvsetv[i]->ks_dgen;
-        }
+        for (j = 0; j < mbc[i]; j++) {
+            k = check++;
 
-        cn_tree_ingest_update(
-            cn[i]->cn_tree,
-            kvsetv[i],
-            mbv[i]->bl_last_ptomb,
-            mbv[i]->bl_last_ptlen,
-            mbv[i]->bl_last_ptseq);
-        check++;
+            if (log_ingest) {
+                kvset_stats_add(kvset_statsp(kvsetv[k]), &kst);
+                dgen = kvsetv[k]->ks_dgen;
+            }
+
+            cn_tree_ingest_update(
+                cn[i]->cn_tree,
+                kvsetv[k],
+                mbv[i][j].bl_last_ptomb,
+                mbv[i][j].bl_last_ptlen,
+                mbv[i][j].bl_last_ptseq);
+        }
     }
     assert(check == count);
 
@@ -812,9 +946,17 @@ done:
     if (err && txid && cndb_txn_nak(cndb, txid))
         ev(1);
 
+    for (i = first; locked && i <= last; i++)
+        if (cn[i] && mbc[i] && mbv[i])
+            mutex_unlock(&cn[i]->cn_ingest_lock);
+
     /* NOTE: we always free the callers kvset mblocks */
     for (i = first; i <= last; i++) {
-        kvset_mblocks_destroy(mbv[i]);
+        if (!mbv[i])
+            continue;
+
+        for (j = 0; j < max_t(int, mbc[i], 1); j++)
+            kvset_mblocks_destroy(mbv[i] + j);
 
         if (cn[i])
             perfc_inc(&cn[i]->cn_pc_ingest, PERFC_BA_CNCOMP_FINISH);
@@ -825,6 +967,314 @@ done:
     return err;
 }
 
+/**
+ * struct cn_load - a bulk load into the root node of a cn tree
+ * @cl_cn:      cn being loaded
+ * @cl_bldr:    builder of the kvset being loaded, NULL until the next key
+ * @cl_mbv:     mblocks of the kvsets built so far
+ * @cl_mbc:     number of kvsets in @cl_mbv
+ * @cl_mbmax:   number of elements allocated in @cl_mbv
+ * @cl_seqno:   seqno of every value in the load
+ * @cl_expiry:  expiry time of every value in the load
+ * @cl_sz:      bytes added to @cl_bldr
+ * @cl_sz_max:  bytes at which to start a new kvset (zero for no limit)
+ * @cl_stale:   set if a write newer than the load overlaps its keys
+ * @cl_minklen: length of @cl_minkey
+ * @cl_minkey:  copy of the first key added
+ * @cl_klen:    length of @cl_kbuf
+ * @cl_kbuf:    copy of the last key added
+ *
+ * Each kvset covers a range of keys disjoint from the others, so their
+ * order in the root node does not matter.
+ */
+struct cn_load {
+    struct cn *           cl_cn;
+    struct kvset_builder *cl_bldr;
+    struct kvset_mblocks *cl_mbv;
+    uint                  cl_mbc;
+    uint                  cl_mbmax;
+    u64                   cl_seqno;
+    u64                   cl_expiry;
+    u64                   cl_sz;
+    u64                   cl_sz_max;
+    bool                  cl_stale;
+    uint                  cl_minklen;
+    char                  cl_minkey[HSE_KVS_KLEN_MAX];
+    uint                  cl_klen;
+    char                  cl_kbuf[HSE_KVS_KLEN_MAX];
+};
+
+merr_t
+cn_load_create(struct cn *cn, u64 seqno, u64 expiry, struct cn_load **loadp)
+{
+    struct cn_load *load;
+
+    if (ev(!cn || !loadp))
+        return merr(EINVAL);
+
+    load = calloc(1, sizeof(*load));
+    if (ev(!load))
+        return merr(ENOMEM);
+
+    load->cl_cn = cn;
+    load->cl_seqno = seqno;
+    load->cl_expiry = expiry;
+    load->cl_sz_max = cn->rp->cn_load_kvset_mb << 20;
+
+    *loadp = load;
+
+    return 0;
+}
+
+/* Finish the kvset being built, keeping its (uncommitted) mblocks.
+ */
+static merr_t
+cn_load_finish(struct cn_load *load)
+{
+    struct kvset_mblocks *mb;
+    merr_t                err;
+
+    if (!load->cl_bldr)
+        return 0;
+
+    if (load->cl_mbc == load->cl_mbmax) {
+        uint  max = load->cl_mbmax ? load->cl_mbmax * 2 : 8;
+        void *mbv;
+
+        mbv = realloc(load->cl_mbv, max * sizeof(*load->cl_mbv));
+        if (ev(!mbv))
+            return merr(ENOMEM);
+
+        load->cl_mbv = mbv;
+        load->cl_mbmax = max;
+    }
+
+    mb = load->cl_mbv + load->cl_mbc;
+    memset(mb, 0, sizeof(*mb));
+
+    err = kvset_builder_get_mblocks(load->cl_bldr, mb);
+    if (ev(err))
+        return err;
+
+    kvset_builder_destroy(load->cl_bldr);
+    load->cl_bldr = NULL;
+    load->cl_sz = 0;
+
+    if (mb->kblks.n_blks == 0) {
+        kvset_mblocks_destroy(mb);
+        return 0;
+    }
+
+    load->cl_mbc++;
+
+    return 0;
+}
+
+merr_t
+cn_load_add(struct cn_load *load, const struct kvs_ktuple *kt, const struct kvs_vtuple *vt)
+{
+    struct cn *    cn = load->cl_cn;
+    struct key_obj ko;
+    uint           vlen, clen;
+    merr_t         err;
+
+    if (load->cl_klen && keycmp(load->cl_kbuf, load->cl_klen, kt->kt_data, kt->kt_len) >= 0)
+        return merr(EINVAL);
+
+    if (ev(HSE_CORE_IS_TOMB(vt->vt_data) || kvs_vtuple_mop(vt)))
+        return merr(EINVAL);
+
+    if (!load->cl_bldr) {
+        err = kvset_builder_create(
+            &load->cl_bldr, cn, cn_get_ingest_perfc(cn), get_time_ns(),
+            KVSET_BUILDER_FLAGS_INGEST);
+        if (ev(err))
+            return err;
+
+        kvset_builder_set_agegroup(load->cl_bldr, HSE_MPOLICY_AGE_ROOT);
+    }
+
+    clen = kvs_vtuple_clen(vt);
+    vlen = vt->vt_xlen & (HSE_XLEN_MOP - 1);
+
+    err = kvset_builder_add_val_expiry(
+        load->cl_bldr, load->cl_seqno, vt->vt_data, vlen, clen, load->cl_expiry);
+    if (ev(err))
+        return err;
+
+    key2kobj(&ko, kt->kt_data, kt->kt_len);
+
+    err = kvset_builder_add_key(load->cl_bldr, &ko);
+    if (ev(err))
+        return err;
+
+    if (!load->cl_klen) {
+        memcpy(load->cl_minkey, kt->kt_data, kt->kt_len);
+        load->cl_minklen = kt->kt_len;
+    }
+
+    memcpy(load->cl_kbuf, kt->kt_data, kt->kt_len);
+    load->cl_klen = kt->kt_len;
+
+    load->cl_sz += kt->kt_len + (clen ?: vlen);
+    if (load->cl_sz_max && load->cl_sz >= load->cl_sz_max)
+        return cn_load_finish(load);
+
+    return 0;
+}
+
+/* Look for a kvset holding a write newer than the load that may fall
+ * within the load's key range.  Prefix and range tombstones can match
+ * keys beyond a kvset's min and max keys, so their kvsets always may.
+ */
+static int
+cn_load_stale_cb(
+    void *               rock,
+    struct cn_tree *     tree,
+    struct cn_tree_node *node,
+    struct cn_node_loc * loc,
+    struct kvset *       kvset)
+{
+    struct cn_load *    load = rock;
+    const struct rtomb *rtv;
+    const void *        key;
+    u16                 klen;
+
+    if (!kvset || kvset_get_seqno_max(kvset) <= load->cl_seqno)
+        return 0;
+
+    if (kvset_pt_start(kvset) < 0 && !kvset_get_rtombs(kvset, &rtv)) {
+        kvset_minkey(kvset, &key, &klen);
+        if (keycmp(key, klen, load->cl_kbuf, load->cl_klen) > 0)
+            return 0;
+
+        kvset_maxkey(kvset, &key, &klen);
+        if (keycmp(key, klen, load->cl_minkey, load->cl_minklen) < 0)
+            return 0;
+    }
+
+    load->cl_stale = true;
+
+    return 1;
+}
+
+merr_t
+cn_load_commit(struct cn_load *load)
+{
+    struct cn *    cn = load->cl_cn;
+    struct kvset **kvsetv;
+    merr_t         err;
+    u64            txid, context = 0;
+    uint           i, j, n, mbc;
+
+    err = cn_load_finish(load);
+    if (ev(err))
+        return err;
+
+    mbc = load->cl_mbc;
+    if (!mbc)
+        return 0;
+
+    kvsetv = calloc(mbc, sizeof(*kvsetv));
+    if (ev(!kvsetv))
+        return merr(ENOMEM);
+
+    /* Neither ingests nor concurrent loads (e.g., a parallel import) may
+     * interleave between allocating dgens and adding kvsets to the root
+     * node.
+     */
+    mutex_lock(&cn->cn_ingest_lock);
+
+    /* The caller synced c0 before committing, so every write made since
+     * the load began is now in cN.  The load's kvsets will get newer
+     * dgens than such writes and would hide them despite their newer
+     * seqnos, so the load must fail if any of them overlap its keys.
+     */
+    load->cl_stale = false;
+    cn_tree_preorder_walk(cn->cn_tree, KVSET_ORDER_NEWEST_FIRST, cn_load_stale_cb, load);
+    if (load->cl_stale) {
+        err = merr(ESTALE);
+        goto unlock;
+    }
+
+    /* Unlike a c0 ingest there is no ingestid, and the seqno may be older
+     * than that of kvsets ingested since the load began.
+     */
+    err = cndb_txn_start(cn->cn_cndb, &txid, CNDB_INVAL_INGESTID, mbc, 0, load->cl_seqno);
+    if (ev(err))
+        goto unlock;
+
+    for (i = 0; i < mbc; i++) {
+        err = cn_ingest_prep(cn, load->cl_mbv + i, 1, txid, &context, NULL, &kvsetv[i]);
+        if (ev(err))
+            break;
+    }
+
+    /* The mblocks of the kvsets prepared so far (and of the one that
+     * failed) are now owned by cndb, cn_load_destroy() aborts the rest.
+     */
+    n = min_t(uint, i + 1, mbc);
+    for (j = 0; j < n; j++)
+        kvset_mblocks_destroy(load->cl_mbv + j);
+
+    load->cl_mbc -= n;
+    memmove(load->cl_mbv, load->cl_mbv + n, load->cl_mbc * sizeof(*load->cl_mbv));
+
+    /* There must not be any failure conditions after successful ACK_C
+     * because the operation has been committed.
+     */
+    if (!err)
+        err = cndb_txn_ack_c(cn->cn_cndb, txid);
+
+    if (ev(err)) {
+        if (cndb_txn_nak(cn->cn_cndb, txid))
+            ev(1);
+
+        for (j = 0; j < i; j++)
+            if (kvsetv[j])
+                kvset_put_ref(kvsetv[j]);
+        goto unlock;
+    }
+
+    for (i = 0; i < mbc; i++)
+        if (kvsetv[i])
+            cn_tree_ingest_update(cn->cn_tree, kvsetv[i], NULL, 0, 0);
+
+unlock:
+    mutex_unlock(&cn->cn_ingest_lock);
+
+    free(kvsetv);
+
+    return err;
+}
+
+void
+cn_load_destroy(struct cn_load *load)
+{
+    uint i;
+
+    if (!load)
+        return;
+
+    if (load->cl_bldr)
+        kvset_builder_destroy(load->cl_bldr);
+
+    /* Abort the mblocks of kvsets that were never committed. */
+    for (i = 0; i < load->cl_mbc; i++) {
+        cn_mblocks_destroy(load->cl_cn->cn_dataset, 1, load->cl_mbv + i, 0, 0);
+        kvset_mblocks_destroy(load->cl_mbv + i);
+    }
+
+    free(load->cl_mbv);
+    free(load);
+}
+
+uint
+cn_split_keys(struct cn *cn, uint splitc, void *keybuf, uint *klenv)
+{
+    return cn_tree_split_keys(cn->cn_tree, splitc, keybuf, klenv);
+}
+
 static void
 cn_maintenance_task(struct work_struct *context)
 {
@@ -1178,6 +1628,7 @@ cn_open(
         return merr(ev(ENOMEM));
 
     memset(cn, 0, sz);
+    mutex_init(&cn->cn_ingest_lock);
 
     if (!rp) {
         rp = (void *)(cn + 1);
@@ -1235,6 +1686,12 @@ cn_open(
         goto err_exit;
     }
 
+    err = merge_op_init(&cn->cn_mop, rp);
+    if (ev(err)) {
+        hse_log(HSE_ERR "%s Invalid merge operator %s", cn->cn_kvsname, rp->merge_op);
+        goto err_exit;
+    }
+
     cn->cn_replay = flags & IKVS_OFLAG_REPLAY;
     maint = cn->csched && !cn->cn_replay && !rp->cn_diag_mode && !rp->rdonly;
 
@@ -1323,6 +1780,15 @@ cn_open(
         goto err_exit;
     }
 
+    /* Work queue for value reads deferred by cn_get_async().  Its
+     * width bounds the number of such reads in flight per cn tree.
+     */
+    cn->cn_aget_wq = alloc_workqueue("cn_aget", 0, cn->rp->cn_aget_threads ?: 4);
+    if (!cn->cn_aget_wq) {
+        err = merr(ev(ENOMEM));
+        goto err_exit;
+    }
+
     /* Work queue for other work such as managing "capped" trees,
      * offloading kvset destroy from client queries, and running
      * vblock readahead operations.
@@ -1359,11 +1825,13 @@ done:
 
 err_exit:
     destroy_workqueue(cn->cn_maint_wq);
+    destroy_workqueue(cn->cn_aget_wq);
     destroy_workqueue(cn->cn_io_wq);
     cn_tree_destroy(cn->cn_tree);
     cn_tstate_destroy(cn->cn_tstate);
     if (!cn->cn_replay)
         cn_perfc_free(cn);
+    mutex_destroy(&cn->cn_ingest_lock);
     free_aligned(cn);
 
     return err ?: merr(ev(EBUG));
@@ -1374,6 +1842,7 @@ cn_close(struct cn *cn)
 {
     u64   report_ns = 5 * NSEC_PER_SEC;
     void *maint_wq = cn->cn_maint_wq;
+    void *aget_wq = cn->cn_aget_wq;
     void *io_wq = cn->cn_io_wq;
     u64   next_report;
     useconds_t dlymax, dly;
@@ -1386,6 +1855,10 @@ cn_close(struct cn *cn)
     if (cancel)
         atomic_set(&cn->cn_maint_cancel, 1);
 
+    /* Complete all async gets, they hold refs on kvsets.
+     */
+    flush_workqueue(aget_wq);
+
     /* Wait for the cn maint thread to exit.  Any async kvset destroys
      * that may have started will be waited on by the cn_refcnt loop.
      */
@@ -1424,6 +1897,7 @@ cn_close(struct cn *cn)
     flush_workqueue(maint_wq);
     flush_workqueue(io_wq);
     cn->cn_maint_wq = NULL;
+    cn->cn_aget_wq = NULL;
     cn->cn_io_wq = NULL;
 
     cndb_cn_close(cn->cn_cndb, cn->cn_cnid);
@@ -1433,9 +1907,11 @@ cn_close(struct cn *cn)
     cn_tstate_destroy(cn->cn_tstate);
 
     destroy_workqueue(maint_wq);
+    destroy_workqueue(aget_wq);
     destroy_workqueue(io_wq);
     cn_perfc_free(cn);
 
+    mutex_destroy(&cn->cn_ingest_lock);
     free_aligned(cn);
 
     return 0;
@@ -1602,6 +2078,11 @@ cn_cursor_create(
     if (!err && attempts != 5)
         hse_log(HSE_NOTICE "cn_cursor_create: corrected");
 
+    if (!err) {
+        perfc_add(&cn->cn_pc_get, PERFC_RA_CNGET_PFXCHK, cur->pfx_check);
+        perfc_add(&cn->cn_pc_get, PERFC_RA_CNGET_PFXSKIP, cur->pfx_skip);
+    }
+
     if (attempts <= 0) {
         cn_pscan_free(cur);
         return merr(ev(EAGAIN));
@@ -23,6 +23,8 @@ struct csched;
 
 #include <hse/hse_limits.h>
 
+#include <hse_ikvdb/merge_op.h>
+
 struct cn {
     struct cn_tree *  cn_tree;
     struct perfc_set  cn_pc_get;
@@ -36,12 +38,18 @@ struct cn {
 
     __aligned(SMP_CACHE_BYTES) atomic64_t cn_ingest_dgen;
 
+    /* serializes ingests and bulk load commits from taking dgens through
+     * adding kvsets to the root node, so that it stays in dgen order
+     */
+    struct mutex cn_ingest_lock;
+
     atomic_t cn_refcnt;
     bool     cn_closing;
     bool     cn_replay;
 
     /* for asynchronous mblock I/O */
     struct workqueue_struct *cn_io_wq;
+    struct workqueue_struct *cn_aget_wq;
 
     /* perf counters */
     struct perfc_set cn_pc_ingest;
@@ -68,6 +76,7 @@ struct cn {
     struct csched *       csched;
     struct kvdb_health *  cn_kvdb_health;
     struct mclass_policy *cn_mpolicy;
+    struct merge_op       cn_mop;
 
     u32 cn_cflags;
 
@@ -21,6 +21,9 @@
  * @kst_valen: sum mpr_alloc_cap for all vblocks
  * @kst_vwlen: sum mpr_write_len for all vblocks
  * @kst_vulen: total referenced user data in all vblocks
+ * @kst_exp_vlen: on-media length of values that have an expiry time
+ * @kst_exp_min: earliest expiry time, zero if none
+ * @kst_exp_max: latest expiry time
  *
  */
 struct kvset_stats {
@@ -30,6 +33,9 @@ struct kvset_stats {
     u64 kst_valen;
     u64 kst_vwlen;
     u64 kst_vulen;
+    u64 kst_exp_vlen;
+    u64 kst_exp_min;
+    u64 kst_exp_max;
     u32 kst_kvsets;
     u32 kst_kblks;
     u32 kst_vblks;
@@ -59,6 +65,30 @@ kvset_vulen(const struct kvset_stats *kst)
     return kst->kst_vulen;
 }
 
+/**
+ * kvset_exp_vlen() - estimate the on-media length of expired values
+ * @kst: kvset stats
+ * @now: current time, see kvs_expiry_now()
+ *
+ * Only the total length and the range of expiry times are known, so
+ * assume the expiry times are evenly spread over the range.
+ */
+static inline u64
+kvset_exp_vlen(const struct kvset_stats *kst, u64 now)
+{
+    u64 pct;
+
+    if (!kst->kst_exp_vlen || now < kst->kst_exp_min)
+        return 0;
+
+    if (now >= kst->kst_exp_max)
+        return kst->kst_exp_vlen;
+
+    pct = 100 * (now - kst->kst_exp_min) / (kst->kst_exp_max - kst->kst_exp_min);
+
+    return kst->kst_exp_vlen * pct / 100;
+}
+
 /**
  * struct cn_node_stats - node metrics used by compacation scheduler
  * @ns_kclen:  estimated total kblock capacity (mpr_alloc_cap) after compaction
@@ -33,7 +33,10 @@ struct perfc_name cn_perfc_get[] = {
     NE(PERFC_LT_CNGET_GET_L5, 3, "Latency of cN get in L5", "l_get_l5(ns)"),
     NE(PERFC_LT_CNGET_PROBEPFX, 3, "Latency of cN pfx probe", "l_pprobe(ns)"),
     NE(PERFC_LT_CNGET_MISS, 3, "Latency of cN misses", "l_mis(ns)"),
-    NE(PERFC_RA_CNGET_TOMB, 3, "Count of cN tombs", "c_tmb(/s)")
+    NE(PERFC_RA_CNGET_TOMB, 3, "Count of cN tombs", "c_tmb(/s)"),
+    NE(PERFC_RA_CNGET_FSKIP, 3, "Count of cN kvsets skipped by fences", "c_fskip(/s)"),
+    NE(PERFC_RA_CNGET_PFXCHK, 3, "Count of cN kvsets checked by prefix blooms", "c_pfxchk(/s)"),
+    NE(PERFC_RA_CNGET_PFXSKIP, 3, "Count of cN kvsets skipped by prefix blooms", "c_pfxskip(/s)")
 };
 
 struct perfc_name cn_perfc_compact[] = {
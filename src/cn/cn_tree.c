@@ -65,6 +65,7 @@
 #include "blk_list.h"
 #include "kv_iterator.h"
 #include "wbt_reader.h"
+#include "bloom_reader.h"
 #include "pscan.h"
 #include "spill.h"
 #include "kcompact.h"
@@ -295,6 +296,7 @@ void
 cn_node_free(struct cn_tree_node *tn)
 {
     if (tn) {
+        free(tn->tn_fidx);
         hlog_destroy(tn->tn_hlog);
         kmem_cache_free(cn_node_cache, tn);
     }
@@ -824,6 +826,97 @@ tn_samp_update_finish(struct cn_tree_node *tn)
     }
 }
 
+/* Rebuild a node's kvset fence index.  This must be called after every
+ * change to the node's kvset list, with the tree write lock held (or before
+ * the tree is visible to readers).  If the index cannot be allocated then
+ * lookups simply visit every kvset in the node.
+ */
+static void
+cn_node_fidx_update(struct cn_tree_node *tn)
+{
+    struct kvset_list_entry *le;
+    struct cn_node_fidx *    fidx;
+    size_t                   sz;
+    uint                     kvsetc, kblkc, k;
+
+    free(tn->tn_fidx);
+    tn->tn_fidx = NULL;
+
+    kvsetc = kblkc = 0;
+    list_for_each_entry (le, &tn->tn_kvset_list, le_link) {
+        kblkc += kvset_get_num_kblocks(le->le_kvset);
+        ++kvsetc;
+    }
+
+    if (!kvsetc)
+        return;
+
+    sz = sizeof(*fidx) + sizeof(*fidx->nf_kvsetv) * kvsetc;
+    sz += (sizeof(*fidx->nf_lov) + sizeof(*fidx->nf_hiv) + sizeof(*fidx->nf_blmv)) * kblkc;
+
+    fidx = malloc(sz);
+    if (ev(!fidx))
+        return;
+
+    fidx->nf_kvsetc = kvsetc;
+    fidx->nf_lov = (void *)(fidx + 1);
+    fidx->nf_hiv = fidx->nf_lov + kblkc;
+    fidx->nf_blmv = (void *)(fidx->nf_hiv + kblkc);
+    fidx->nf_kvsetv = (void *)(fidx->nf_blmv + kblkc);
+
+    k = kblkc = 0;
+    list_for_each_entry (le, &tn->tn_kvset_list, le_link) {
+        struct cn_fidx_kvset *fk = fidx->nf_kvsetv + k++;
+
+        fk->fk_kvset = le->le_kvset;
+        fk->fk_kblk = kblkc;
+        fk->fk_kblkc = kvset_get_num_kblocks(le->le_kvset);
+        fk->fk_fenced = kvset_get_fences(
+            le->le_kvset, fidx->nf_lov + kblkc, fidx->nf_hiv + kblkc, fidx->nf_blmv + kblkc);
+
+        kblkc += fk->fk_kblkc;
+    }
+
+    tn->tn_fidx = fidx;
+}
+
+/* Returns %false if the node's k'th kvset cannot contain the key.  Only the
+ * first word of the key's discriminator is compared against the fences,
+ * which is conservative but keeps the scan over the fence vectors tight.
+ */
+static bool
+cn_node_fidx_plausible(
+    const struct cn_node_fidx *fidx,
+    uint                       k,
+    struct kvs_ktuple *        kt,
+    const struct key_disc *    kdisc)
+{
+    const struct cn_fidx_kvset *fk = fidx->nf_kvsetv + k;
+    const u64 *                 lov, *hiv;
+    u64                         kd;
+    uint                        i;
+
+    if (!fk->fk_fenced)
+        return true;
+
+    lov = fidx->nf_lov + fk->fk_kblk;
+    hiv = fidx->nf_hiv + fk->fk_kblk;
+    kd = kdisc->kdisc[0];
+
+    for (i = 0; i < fk->fk_kblkc; ++i) {
+        const struct kvset_bloom *blm;
+
+        if (kd < lov[i] || kd > hiv[i])
+            continue;
+
+        blm = fidx->nf_blmv + fk->fk_kblk + i;
+        if (!blm->kbl_pages || bloom_reader_buffer_lookup(&blm->kbl_desc, blm->kbl_pages, kt))
+            return true;
+    }
+
+    return false;
+}
+
 /* This function must be serialized with other cn_tree_samp_* functions. */
 static void
 cn_tree_samp_update_compact(struct cn_tree *tree, struct cn_tree_node *tn)
@@ -956,6 +1049,7 @@ cn_tree_insert_kvset(struct cn_tree *tree, struct kvset *kvset, uint level, uint
     }
 
     kvset_list_add_tail(kvset, head);
+    cn_node_fidx_update(node);
 
     return 0;
 }
@@ -1194,6 +1288,98 @@ unlock:
     rmlock_runlock(lock);
 }
 
+struct split_key {
+    const void *sk_key;
+    uint        sk_klen;
+};
+
+static int
+split_key_cmp(const void *lhs, const void *rhs)
+{
+    const struct split_key *l = lhs;
+    const struct split_key *r = rhs;
+
+    return keycmp(l->sk_key, l->sk_klen, r->sk_key, r->sk_klen);
+}
+
+uint
+cn_tree_split_keys(struct cn_tree *tree, uint splitc, void *keybuf, uint *klenv)
+{
+    struct tree_iter         iter;
+    struct cn_tree_node *    node;
+    struct kvset_list_entry *le;
+    struct split_key *       skv;
+    void *                   lock;
+    uint                     skc, skmax, n, i;
+
+    if (!splitc)
+        return 0;
+
+    rmlock_rlock(&tree->ct_lock, &lock);
+
+    skmax = 0;
+    tree_iter_init(tree, &iter, TRAVERSE_TOPDOWN);
+    while (NULL != (node = tree_iter_next(tree, &iter))) {
+        list_for_each_entry (le, &node->tn_kvset_list, le_link)
+            skmax += kvset_get_num_kblocks(le->le_kvset);
+    }
+
+    skv = skmax ? malloc(skmax * sizeof(*skv)) : NULL;
+    if (ev(!skv && skmax)) {
+        rmlock_runlock(lock);
+        return 0;
+    }
+
+    /* Every kblock covers roughly the same amount of key data, so the
+     * quantiles of the kblock min keys divide the tree into ranges that
+     * hold similar amounts of data.
+     */
+    skc = 0;
+    tree_iter_init(tree, &iter, TRAVERSE_TOPDOWN);
+    while (NULL != (node = tree_iter_next(tree, &iter))) {
+        list_for_each_entry (le, &node->tn_kvset_list, le_link) {
+            struct kvset *ks = le->le_kvset;
+            uint          kbc = kvset_get_num_kblocks(ks);
+
+            for (i = 0; i < kbc && skc < skmax; i++) {
+                kvset_get_nth_kblock_minkey(ks, i, &skv[skc].sk_key, &skv[skc].sk_klen);
+                if (skv[skc].sk_klen > 0)
+                    skc++;
+            }
+        }
+    }
+
+    qsort(skv, skc, sizeof(*skv), split_key_cmp);
+
+    /* Copy the keys out while the lock still pins the kvsets. */
+    n = 0;
+    for (i = 1; i <= splitc && skc > 0; i++) {
+        struct split_key *sk = skv + (u64)i * skc / (splitc + 1);
+
+        /* Skip splits that would yield an empty range: a split on the
+         * smallest key leaves nothing before it, and a split on the
+         * previous split key leaves nothing between them.
+         */
+        if (!keycmp(skv->sk_key, skv->sk_klen, sk->sk_key, sk->sk_klen))
+            continue;
+
+        if (n > 0) {
+            const void *prev = keybuf + (n - 1) * HSE_KVS_KLEN_MAX;
+
+            if (keycmp(prev, klenv[n - 1], sk->sk_key, sk->sk_klen) >= 0)
+                continue;
+        }
+
+        memcpy(keybuf + n * HSE_KVS_KLEN_MAX, sk->sk_key, sk->sk_klen);
+        klenv[n++] = sk->sk_klen;
+    }
+
+    rmlock_runlock(lock);
+    free(skv);
+
+    return n;
+}
+
 static __always_inline uint
 khashmap2child(struct cn_khashmap *khashmap, u64 hash, uint shift, uint level)
 {
@@ -1207,6 +1393,54 @@ khashmap2child(struct cn_khashmap *khashmap, u64 hash, uint shift, uint level)
     return child;
 }
 
+/* Search one kvset on behalf of cn_tree_lookup().  Returns %true if the
+ * search of the tree is complete, either because of an error (in *@errp)
+ * or because the key was resolved.
+ */
+static inline bool
+cn_lookup_kvset(
+    struct kvset *         kvset,
+    struct kvs_ktuple *    kt,
+    const struct key_disc *kdisc,
+    u64                    seq,
+    enum key_lookup_res *  res,
+    struct query_ctx *     qctx,
+    void *                 wbti,
+    struct kvs_buf *       kbuf,
+    struct kvs_buf *       vbuf,
+    merr_t *               errp)
+{
+    merr_t err;
+
+    switch (qctx->qtype) {
+        case QUERY_GET:
+            err = kvset_lookup(kvset, kt, kdisc, seq, res, vbuf);
+            break;
+
+        case QUERY_GET_PIN:
+            err = kvset_lookup_pin(kvset, kt, kdisc, seq, res, vbuf, qctx->vpin);
+            break;
+
+        case QUERY_GET_ASYNC:
+            err = kvset_lookup_async(kvset, kt, kdisc, seq, res, vbuf, qctx->aget);
+            break;
+
+        case QUERY_PROBE_PFX:
+            err = kvset_pfx_lookup(kvset, kt, kdisc, seq, res, wbti, kbuf, vbuf, qctx);
+            *errp = err;
+
+            return ev(err) || qctx->seen > 1 || *res == FOUND_PTMB;
+
+        default:
+            assert(0);
+            return false;
+    }
+
+    *errp = err;
+
+    return err || *res != NOT_FOUND;
+}
+
 /**
  * cn_tree_lookup() - search cn tree for a key
  * @tree: cn tree
@@ -1264,16 +1498,18 @@ cn_tree_lookup(
     struct cn_tree_node *    node;
     struct cn_khashmap *     khashmap;
     struct kvset_list_entry *le;
+    struct cn_node_fidx *    fidx;
     struct key_disc          kdisc;
     void *                   lock;
     merr_t                   err;
     u32                      child;
     u32                      shift;
-    uint                     pc_nkvset;
+    uint                     pc_nkvset, pc_nskip, pc_npfxchk, pc_npfxskip, k;
     u64                      pc_start;
     u64                      spill_hash = 0;
+    u64                      pfxhash = 0;
     u16                      pc_lvl, pc_lvl_start, pc_depth;
-    bool                     pfx_hashing, first;
+    bool                     pfx_hashing, first, pfx_filter;
     void *                   wbti;
 
     __builtin_prefetch(tree);
@@ -1281,7 +1517,7 @@ cn_tree_lookup(
     err = 0;
     *res = NOT_FOUND;
 
-    pc_depth = pc_nkvset = 0;
+    pc_depth = pc_nkvset = pc_nskip = pc_npfxchk = pc_npfxskip = 0;
     pc_lvl = CNGET_LMAX;
     pc_lvl_start = 0;
 
@@ -1302,6 +1538,13 @@ cn_tree_lookup(
             return err;
     }
 
+    /* Prefix probes can skip kvsets whose prefix blooms don't have the
+     * probe's tree prefix.
+     */
+    pfx_filter = wbti && tree->ct_pfx_len > 0 && kt->kt_len >= tree->ct_pfx_len;
+    if (pfx_filter)
+        pfxhash = key_hash64(kt->kt_data, tree->ct_pfx_len);
+
     key_disc_init(kt->kt_data, kt->kt_len, &kdisc);
 
     node = tree->ct_root;
@@ -1321,32 +1564,44 @@ cn_tree_lookup(
 
         /* Search kvsets from newest to oldest (head to tail).
          * If an error occurs or a key is found, return immediately.
+         * Point gets use the node's fence index to skip kvsets that
+         * cannot contain the key without touching them.
          */
-        list_for_each_entry (le, &node->tn_kvset_list, le_link) {
-            struct kvset *kvset;
-
-            kvset = le->le_kvset;
-            yield = true;
-            ++pc_nkvset;
-
-            switch (qctx->qtype) {
-                case QUERY_GET:
-                    err = kvset_lookup(kvset, kt, &kdisc, seq, res, vbuf);
-                    if (err || *res != NOT_FOUND) {
-                        rmlock_runlock(lock);
-                        if (pc_lvl < CNGET_LMAX)
-                            perfc_lat_record(pc, pc_lvl, pc_lvl_start);
-                        goto done;
-                    }
-                    break;
+        fidx = wbti ? NULL : node->tn_fidx;
+        if (fidx) {
+            for (k = 0; k < fidx->nf_kvsetc; ++k) {
+                yield = true;
+
+                if (!cn_node_fidx_plausible(fidx, k, kt, &kdisc)) {
+                    ++pc_nskip;
+                    continue;
+                }
+
+                ++pc_nkvset;
+
+                if (cn_lookup_kvset(fidx->nf_kvsetv[k].fk_kvset, kt, &kdisc, seq, res, qctx,
+                                    wbti, kbuf, vbuf, &err))
+                    goto found;
+            }
+        } else {
+            list_for_each_entry (le, &node->tn_kvset_list, le_link) {
+                yield = true;
+
+                /* A kvset with ptombs must be searched regardless. */
+                if (pfx_filter && kvset_pt_start(le->le_kvset) < 0) {
+                    ++pc_npfxchk;
 
-                case QUERY_PROBE_PFX:
-                    err = kvset_pfx_lookup(kvset, kt, &kdisc, seq, res, wbti, kbuf, vbuf, qctx);
-                    if (ev(err) || qctx->seen > 1 || *res == FOUND_PTMB) {
-                        rmlock_runlock(lock);
-                        goto done;
+                    if (kvset_pfx_filter_miss(le->le_kvset, kt->kt_data, kt->kt_len, pfxhash)) {
+                        ++pc_npfxskip;
+                        continue;
                     }
-                    break;
+                }
+
+                ++pc_nkvset;
+
+                if (cn_lookup_kvset(le->le_kvset, kt, &kdisc, seq, res, qctx,
+                                    wbti, kbuf, vbuf, &err))
+                    goto found;
             }
         }
 
@@ -1374,7 +1629,7 @@ cn_tree_lookup(
             } else {
                 size_t hashlen;
 
-                assert(qctx->qtype == QUERY_GET);
+                assert(qctx->qtype != QUERY_PROBE_PFX);
                 hashlen = kt->kt_len - tree->ct_sfx_len;
                 spill_hash = key_hash64(kt->kt_data, hashlen);
             }
@@ -1394,6 +1649,12 @@ cn_tree_lookup(
         ++pc_depth;
     }
     rmlock_runlock(lock);
+    goto done;
+
+found:
+    rmlock_runlock(lock);
+    if (pc_lvl < CNGET_LMAX && !wbti)
+        perfc_lat_record(pc, pc_lvl, pc_lvl_start);
 
 done:
     if (pc && !wbti) {
@@ -1415,12 +1676,234 @@ done:
         perfc_inc(pc, PERFC_RA_CNGET_GET);
         perfc_rec_sample(pc, PERFC_DI_CNGET_DEPTH, pc_depth);
         perfc_rec_sample(pc, PERFC_DI_CNGET_NKVSET, pc_nkvset);
+        perfc_add(pc, PERFC_RA_CNGET_FSKIP, pc_nskip);
     }
 
     if (wbti) {
         kvset_wbti_free(wbti);
-        if (pc)
+        if (pc) {
             perfc_lat_record(pc, PERFC_LT_CNGET_PROBEPFX, pc_start);
+            perfc_add(pc, PERFC_RA_CNGET_PFXCHK, pc_npfxchk);
+            perfc_add(pc, PERFC_RA_CNGET_PFXSKIP, pc_npfxskip);
+        }
+    }
+
+    return err;
+}
+
+/**
+ * struct cn_lookup_batch_ent - per-key descent state for cn_tree_lookup_batch()
+ * @node:        node the key is currently visiting
+ * @kdisc:       key discriminator
+ * @spill_hash:  hash used to route the key to the next child
+ * @pfx_hashing: key is currently descending by prefix hash
+ * @first:       spill hash has not yet been computed
+ * @skip:        key need not be searched for in the current kvset
+ * @idx:         index of the key in the caller's vectors
+ */
+struct cn_lookup_batch_ent {
+    struct cn_tree_node *node;
+    struct key_disc      kdisc;
+    u64                  spill_hash;
+    bool                 pfx_hashing;
+    bool                 first;
+    bool                 skip;
+    u16                  idx;
+};
+
+/* Route a key to the next node using the same prefix/full-hash rules as
+ * cn_tree_lookup().
+ */
+static void
+cn_lookup_batch_descend(
+    struct cn_tree *            tree,
+    struct cn_lookup_batch_ent *ent,
+    struct kvs_ktuple *         kt,
+    uint                        shift,
+    uint                        depth)
+{
+    struct cn_tree_node *node = ent->node;
+    u32                  child;
+
+    if (ent->first && ent->pfx_hashing) {
+        ent->spill_hash = key_hash64(kt->kt_data, tree->ct_pfx_len);
+        ent->first = false;
+    } else if (ent->first || (ent->pfx_hashing && !node->tn_pfx_spill)) {
+        if (ent->pfx_hashing && !node->tn_pfx_spill)
+            ent->pfx_hashing = false;
+        ent->first = false;
+
+        if (!tree->ct_sfx_len) {
+            if (!kt->kt_hash)
+                kt->kt_hash = key_hash64(kt->kt_data, kt->kt_len);
+
+            ent->spill_hash = kt->kt_hash;
+        } else {
+            ent->spill_hash = key_hash64(kt->kt_data, kt->kt_len - tree->ct_sfx_len);
+        }
+    }
+
+    child = khashmap2child(tree->ct_khashmap, ent->spill_hash, shift, depth);
+    child &= tree->ct_fanout_mask;
+
+    ent->node = node->tn_childv[child];
+    __builtin_prefetch(ent->node);
+}
+
+/**
+ * cn_tree_lookup_batch() - search cn tree for a vector of keys
+ * @tree: cn tree
+ * @pc:   perf counters
+ * @ktv:  vector of keys to search for
+ * @seq:  view sequence number
+ * @resv: (output) vector of results
+ * @vbufv: (output) vector of value buffers
+ * @cnt:  number of keys (at most %CN_GET_BATCH_MAX)
+ *
+ * Functionally equivalent to calling cn_tree_lookup() for each key, but the
+ * tree lock is acquired once and all keys descend the tree in lock step.
+ * At each level the keys are grouped by node so that each node's kvset list
+ * is walked once per group, and for each kvset the bloom buckets for all
+ * keys in the group are prefetched before any of them are probed.
+ */
+merr_t
+cn_tree_lookup_batch(
+    struct cn_tree *     tree,
+    struct perfc_set *   pc,
+    struct kvs_ktuple *  ktv,
+    u64                  seq,
+    enum key_lookup_res *resv,
+    struct kvs_buf *     vbufv,
+    uint                 cnt)
+{
+    struct cn_lookup_batch_ent  entv[CN_GET_BATCH_MAX];
+    struct cn_lookup_batch_ent *grpv[CN_GET_BATCH_MAX];
+    struct kvset_list_entry *   le;
+    void *                      lock;
+    merr_t                      err;
+    uint                        shift, depth;
+    uint                        pendc, i, j;
+    u64                         pc_start;
+
+    assert(cnt <= CN_GET_BATCH_MAX);
+
+    pc_start = perfc_lat_start(pc);
+    if (!pc_start)
+        pc = NULL;
+
+    shift = tree->ct_khashmap ? CN_KHASHMAP_SHIFT : tree->ct_fanout_bits;
+    pendc = 0;
+    err = 0;
+
+    for (i = 0; i < cnt; ++i) {
+        struct cn_lookup_batch_ent *ent = entv + pendc++;
+
+        resv[i] = NOT_FOUND;
+
+        key_disc_init(ktv[i].kt_data, ktv[i].kt_len, &ent->kdisc);
+        ent->node = tree->ct_root;
+        ent->pfx_hashing = ktv[i].kt_len > tree->ct_pfx_len && tree->ct_root->tn_pfx_spill;
+        ent->first = true;
+        ent->idx = i;
+    }
+
+    rmlock_rlock(&tree->ct_lock, &lock);
+
+    for (depth = 0; pendc > 0; ++depth) {
+        uint grpc;
+
+        /* Group the pending keys by node (insertion sort, pendc is small).
+         */
+        for (i = 0; i < pendc; ++i) {
+            struct cn_lookup_batch_ent *ent = entv + i;
+
+            for (j = i; j > 0 && grpv[j - 1]->node > ent->node; --j)
+                grpv[j] = grpv[j - 1];
+            grpv[j] = ent;
+        }
+
+        for (i = 0; i < pendc; i += grpc) {
+            struct cn_tree_node *node = grpv[i]->node;
+            struct cn_node_fidx *fidx = node->tn_fidx;
+            uint                 ndone = 0;
+            uint                 k = 0;
+
+            for (grpc = 1; i + grpc < pendc && grpv[i + grpc]->node == node; ++grpc)
+                ; /* do nothing */
+
+            list_for_each_entry (le, &node->tn_kvset_list, le_link) {
+                struct kvset *kvset = le->le_kvset;
+
+                assert(!fidx || fidx->nf_kvsetv[k].fk_kvset == kvset);
+
+                for (j = i; j < i + grpc; ++j) {
+                    struct cn_lookup_batch_ent *ent = grpv[j];
+                    uint                        idx = ent->idx;
+
+                    ent->skip = resv[idx] != NOT_FOUND ||
+                                (fidx && !cn_node_fidx_plausible(fidx, k, ktv + idx, &ent->kdisc));
+
+                    if (!ent->skip)
+                        kvset_lookup_prefetch(kvset, ktv + idx, &ent->kdisc);
+                }
+
+                ++k;
+
+                for (j = i; j < i + grpc; ++j) {
+                    struct cn_lookup_batch_ent *ent = grpv[j];
+                    uint                        idx = ent->idx;
+
+                    if (ent->skip)
+                        continue;
+
+                    err = kvset_lookup(kvset, ktv + idx, &ent->kdisc, seq, resv + idx, vbufv + idx);
+                    if (ev(err))
+                        goto unlock;
+
+                    if (resv[idx] != NOT_FOUND)
+                        ++ndone;
+                }
+
+                if (ndone == grpc)
+                    break;
+            }
+        }
+
+        /* Retire resolved keys and route the rest to their children.
+         */
+        for (i = j = 0; i < pendc; ++i) {
+            struct cn_lookup_batch_ent *ent = entv + i;
+
+            if (resv[ent->idx] != NOT_FOUND)
+                continue;
+
+            cn_lookup_batch_descend(tree, ent, ktv + ent->idx, shift, depth);
+            if (ent->node)
+                entv[j++] = *ent;
+        }
+
+        pendc = j;
+
+        if (pendc > 0)
+            rmlock_yield(&tree->ct_lock, &lock);
+    }
+
+unlock:
+    rmlock_runlock(lock);
+
+    if (pc) {
+        uint nmiss = 0, ntomb = 0;
+
+        for (i = 0; i < cnt; ++i) {
+            nmiss += (resv[i] == NOT_FOUND);
+            ntomb += (resv[i] == FOUND_TMB);
+        }
+
+        perfc_lat_record(pc, PERFC_LT_CNGET_GET, pc_start);
+        perfc_add(pc, PERFC_RA_CNGET_GET, cnt);
+        perfc_add(pc, PERFC_RA_CNGET_MISS, nmiss);
+        perfc_add(pc, PERFC_RA_CNGET_TOMB, ntomb);
+        perfc_rec_sample(pc, PERFC_DI_CNGET_DEPTH, depth);
     }
 
     return err;
@@ -1676,6 +2159,7 @@ cn_tree_capped_compact(struct cn_tree *tree)
      */
     rmlock_wlock(&tree->ct_lock);
     list_trim(&retired, head, &mark->le_link);
+    cn_node_fidx_update(node);
     cn_tree_samp_update_compact(tree, node);
     rmlock_wunlock(&tree->ct_lock);
 
@@ -1702,6 +2186,8 @@ cn_tree_prepare_compaction(struct cn_compaction_work *w)
     struct kvset_vblk_map    vbm = {};
     bool                     oldest;
     struct workqueue_struct *vra_wq;
+    const struct rtomb *     rtv;
+    uint                     rtc;
 
     fanout = 1 << w->cw_tree->ct_fanout_bits;
     n_outs = fanout;
@@ -1752,6 +2238,13 @@ cn_tree_prepare_compaction(struct cn_compaction_work *w)
             goto err_exit;
         }
         kvset_iter_set_stats(*iter, &w->cw_stats);
+
+        rtc = kvset_get_rtombs(le->le_kvset, &rtv);
+        while (rtc-- > 0) {
+            err = rtomb_vec_add(&w->cw_rtombs, rtv + rtc);
+            if (ev(err))
+                goto err_exit;
+        }
     }
 
     /* k-compaction keeps all the vblocks from the source kvsets
@@ -1813,6 +2306,7 @@ err_exit:
         free(ins);
         free(vbm.vbm_blkv);
     }
+    rtomb_vec_free(&w->cw_rtombs);
     free(drop_tombs);
     free(outs);
 
@@ -1923,6 +2417,7 @@ cn_tree_cursor_create(struct pscan *cur, struct cn_tree *tree)
     assert(cur->iterc == 0);
     iterp = NULL;
     iterc = 0;
+    cur->pfx_check = cur->pfx_skip = 0;
 
     /* [HSE_REVISIT] Replace the following code to create table view with
      * cn_tree_view_create().
@@ -1987,10 +2482,12 @@ cn_tree_cursor_create(struct pscan *cur, struct cn_tree *tree)
 
         list_for_each_entry (le, &node->tn_kvset_list, le_link) {
             struct kvset *   kvset = le->le_kvset;
-            struct kvstarts *s;
-            u64              x;
-            int              start;
-            int              pt_start;
+            struct kvstarts *   s;
+            const struct rtomb *rtv;
+            uint                rtc;
+            u64                 x;
+            int                 start;
+            int                 pt_start;
 
             x = kvset_get_dgen(kvset);
             if (ev(x > dgen)) {
@@ -2001,6 +2498,21 @@ cn_tree_cursor_create(struct pscan *cur, struct cn_tree *tree)
             if (x > cur->dgen)
                 cur->dgen = x;
 
+            /* Range tombstones apply to keys in other kvsets, so
+             * collect them even if this kvset doesn't participate.
+             */
+            rtc = kvset_get_rtombs(kvset, &rtv);
+            while (rtc-- > 0) {
+                if (rtv[rtc].rt_seq > cur->seqno)
+                    continue;
+
+                err = rtomb_vec_add(&cur->rtombs, rtv + rtc);
+                if (ev(err))
+                    break;
+            }
+            if (err)
+                break;
+
             /* determine if this kvset participates.
              * If prefixed tree, check if kvset has ptombs.
              */
@@ -2008,6 +2520,20 @@ cn_tree_cursor_create(struct pscan *cur, struct cn_tree *tree)
 
             /* check if key lies within this kvset's range */
             start = kvset_kblk_start(kvset, cur->pfx, -cur->pfx_len, cur->reverse);
+
+            /* The kvset's keys can be left out if its prefix blooms
+             * don't have the cursor's tree prefix, but its ptombs
+             * (if any) must still participate.
+             */
+            if (start >= 0 && cur->ct_pfx_len > 0 && cur->pfx_len >= cur->ct_pfx_len) {
+                cur->pfx_check++;
+
+                if (kvset_pfx_filter_miss(kvset, cur->pfx, cur->pfx_len, cur->pfxhash)) {
+                    cur->pfx_skip++;
+                    start = KVSET_MISS_KEY_TOO_LARGE;
+                }
+            }
+
             if (start < 0 && pt_start < 0)
                 continue;
 
@@ -2387,6 +2913,8 @@ cn_tree_cursor_update(struct pscan *cur, struct cn_tree *tree)
     cur->bh = NULL;
     cur->eof = 0;
 
+    rtomb_vec_reset(&cur->rtombs);
+
     return cn_tree_cursor_create(cur, tree);
 }
 
@@ -2407,6 +2935,8 @@ cn_tree_cursor_destroy(struct pscan *cur)
     cur->iterv = 0;
     cur->esrcv = 0;
 
+    rtomb_vec_free(&cur->rtombs);
+
     /* [HSE_REVISIT] emit statistics */
 }
 
@@ -2479,6 +3009,7 @@ cn_tree_cursor_read(struct pscan *cur, struct kvs_kvtuple *kvt, bool *eof)
     u64                 seq;
     bool                end;
     bool                is_tomb;
+    bool                is_mop = false;
     const void *        vdata;
     uint                vlen;
     uint                complen;
@@ -2550,10 +3081,32 @@ cn_tree_cursor_read(struct pscan *cur, struct kvs_kvtuple *kvt, bool *eof)
             if (ev(cur->merr))
                 return cur->merr;
 
+            is_mop = (vtype == vtype_mop);
         } while (seq > cur->seqno);
         if (end)
             continue;
 
+        /* An expired value hides older values just as a tomb would.
+         */
+        if (kvs_expired(item.vctx.expiry)) {
+            vdata = HSE_CORE_TOMB_REG;
+            vlen = complen = 0;
+            is_mop = false;
+        }
+
+        /* Hide values covered by a newer range tombstone.
+         */
+        if (cur->rtombs.rtv_cnt && !HSE_CORE_IS_PTOMB(vdata)) {
+            const void *kdata;
+
+            kdata = key_obj_copy(cur->buf, cur->bufsz, &klen, &item.kobj);
+            if (rtomb_vec_lookup(&cur->rtombs, kdata, klen, cur->seqno) > seq) {
+                drop_dups(cur, &item);
+                end = true;
+                continue;
+            }
+        }
+
         if (HSE_CORE_IS_PTOMB(vdata) &&
             (!cur->pt_set || key_obj_cmp(&cur->pt_kobj, &item.kobj) != 0)) {
             /* only store ptomb w/ highest seqno (less than cur's
@@ -2597,7 +3150,10 @@ cn_tree_cursor_read(struct pscan *cur, struct kvs_kvtuple *kvt, bool *eof)
     kvt->kvt_key.kt_len = klen;
     // what about kt_hash ??? */
 
-    kvs_vtuple_init(&kvt->kvt_value, cur->buf + kvt->kvt_key.kt_len, vlen);
+    /* Merge operands are resolved by the caller, see ikvs_cursor_next().
+     */
+    kvs_vtuple_init(
+        &kvt->kvt_value, cur->buf + kvt->kvt_key.kt_len, vlen | (is_mop ? HSE_XLEN_MOP : 0));
 
     if (complen) {
         extern struct compress_ops compress_lz4_ops;
@@ -2786,6 +3342,8 @@ cn_comp_update_kvcompact(struct cn_compaction_work *work, struct kvset *new_kvse
 
         if (new_kvset)
             kvset_list_add(new_kvset, &le->le_link);
+
+        cn_node_fidx_update(work->cw_node);
     }
 
     cn_tree_samp(tree, &work->cw_samp_pre);
@@ -2903,6 +3461,8 @@ cn_comp_update_spill(struct cn_compaction_work *work, struct spill_child *childv
 
                 kvset_list_add(kvset, &cnode->tn_kvset_list);
             }
+
+            cn_node_fidx_update(cnode);
         }
 
         /* Move old kvsets from parent node to retired list.
@@ -2919,6 +3479,8 @@ cn_comp_update_spill(struct cn_compaction_work *work, struct spill_child *childv
             list_add(&le->le_link, &retired_kvsets);
         }
 
+        cn_node_fidx_update(pnode);
+
         cn_tree_samp(tree, &work->cw_samp_pre);
 
         cn_tree_samp_update_spill(tree, pnode);
@@ -3308,6 +3870,7 @@ cn_comp_compact(struct cn_compaction_work *w)
             w->cw_inputv[i]->kvi_ops->kvi_release(w->cw_inputv[i]);
     free(w->cw_inputv);
     free(w->cw_drop_tombv);
+    rtomb_vec_free(&w->cw_rtombs);
     if (ev(err)) {
         if (!w->cw_canceled)
             kvdb_health_error(hp, err);
@@ -3470,6 +4033,7 @@ cn_tree_ingest_update(struct cn_tree *tree, struct kvset *kvset, void *ptomb, ui
 
     rmlock_wlock(&tree->ct_lock);
     kvset_list_add(kvset, &tree->ct_root->tn_kvset_list);
+    cn_node_fidx_update(tree->ct_root);
 
     /* Record ptomb as the max ptomb seen by this cn */
     if (cn_get_flags(tree->cn) & CN_CFLAG_CAPPED) {
@@ -59,6 +59,16 @@ cn_tree_lookup(
     struct kvs_buf *     kbuf,
     struct kvs_buf *     vbuf);
 
+merr_t
+cn_tree_lookup_batch(
+    struct cn_tree *     tree,
+    struct perfc_set *   pc,
+    struct kvs_ktuple *  ktv,
+    u64                  seq,
+    enum key_lookup_res *resv,
+    struct kvs_buf *     vbufv,
+    uint                 cnt);
+
 /**
  * cn_tree_initial_dgen() - return most current dgen in tree
  * @tree: tree to query
@@ -123,6 +133,22 @@ cn_tree_get_pfx_pivot(struct cn_tree *tree);
 void
 cn_tree_samp(const struct cn_tree *tree, struct cn_samp_stats *s_out);
 
+/**
+ * cn_tree_split_keys() - choose keys that divide a tree into similar ranges
+ * @tree:   tree to query
+ * @splitc: maximum number of split keys to choose
+ * @keybuf: buffer of @splitc * HSE_KVS_KLEN_MAX bytes, key i is at
+ *          offset i * HSE_KVS_KLEN_MAX
+ * @klenv:  vector of @splitc key lengths
+ *
+ * The split keys are distinct and all greater than the smallest key in
+ * the tree, so none of the ranges they delimit is empty.
+ *
+ * Return: number of split keys chosen (in ascending order), at most @splitc
+ */
+uint
+cn_tree_split_keys(struct cn_tree *tree, uint splitc, void *keybuf, uint *klenv);
+
 merr_t
 cn_tree_init(void);
 
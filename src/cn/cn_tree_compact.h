@@ -13,6 +13,8 @@
 #include <hse_util/perfc.h>
 
 #include <hse_ikvdb/sched_sts.h>
+#include <hse_ikvdb/rtomb.h>
+#include <hse_ikvdb/merge_op.h>
 
 #include "cn_metrics.h"
 #include "kcompact.h"
@@ -152,6 +154,9 @@ struct cn_work_est {
  *                       kvsets during k-compaction
  * @cw_hash_shift:   used to determine output child when spilling
  * @cw_drop_tombv:   if true, then tombstones can be dropped in the merge loop
+ * @cw_rtombs:       range tombstones from all input kvsets
+ * @cw_mop:          merge operator used to fold merge operands while spilling,
+ *                   or NULL to leave them unfolded
  * @cw_work_txid:    the cndb transaction id
  * @cw_commitc:      keeps track of how many output mblocks have been committed
  * @cw_keep_vblks:   indicates whether or not vblocks should be deleted or
@@ -181,6 +186,7 @@ struct cn_compaction_work {
     struct mpool *           cw_ds;
     struct kvs_rparams *     cw_rp;
     struct kvs_cparams *     cw_cp;
+    const struct merge_op *  cw_mop;
 
     /* initialized in constructor (cn_tree_find_compaction_candidate) */
     struct cn_tree *         cw_tree;
@@ -225,6 +231,7 @@ struct cn_compaction_work {
     struct kvset_vblk_map cw_vbmap;
     u32                   cw_hash_shift;
     bool *                cw_drop_tombv;
+    struct rtomb_vec      cw_rtombs;
 
     /* initialized in cn_compaction_worker() */
     u64                   cw_work_txid;
@@ -24,6 +24,8 @@
 #include "csched_sp3.h"
 
 struct hlog;
+struct kvset;
+struct kvset_bloom;
 
 /* Each node in a cN tree contains a list of kvsets that must be protected
  * against concurrent update.  Since update of the list is relatively rare,
@@ -151,6 +153,40 @@ struct cn_tree {
     struct rmlock ct_lock;
 };
 
+/**
+ * struct cn_fidx_kvset - a kvset's entry in its node's fence index
+ * @fk_kvset:   kvset handle
+ * @fk_kblk:    index of the kvset's first kblock in the fence vectors
+ * @fk_kblkc:   number of kblocks in the kvset
+ * @fk_fenced:  %false if the kvset must be searched regardless of its fences
+ */
+struct cn_fidx_kvset {
+    struct kvset *fk_kvset;
+    u32           fk_kblk;
+    u32           fk_kblkc;
+    bool          fk_fenced;
+};
+
+/**
+ * struct cn_node_fidx - per-node kvset fence and filter index
+ * @nf_kvsetc:  number of kvsets in the node
+ * @nf_kvsetv:  kvsets, newest to oldest
+ * @nf_lov:     lower kblock fences (see kvset_get_fences())
+ * @nf_hiv:     upper kblock fences
+ * @nf_blmv:    kblock bloom filters
+ *
+ * The index is rebuilt under the tree write lock whenever the node's kvset
+ * list changes.  It lets point lookups rule out most of a node's kvsets by
+ * scanning a few contiguous vectors rather than visiting each kvset.
+ */
+struct cn_node_fidx {
+    uint                  nf_kvsetc;
+    struct cn_fidx_kvset *nf_kvsetv;
+    u64 *                 nf_lov;
+    u64 *                 nf_hiv;
+    struct kvset_bloom *  nf_blmv;
+};
+
 /**
  * struct cn_tree_node - A node in a k-way cn_tree
  * @tn_rspills_lock:  lock to protect @tn_rspills
@@ -165,6 +201,7 @@ struct cn_tree {
  * @tn_loc:          location of node within tree
  * @tn_kvset_cnt:    number of kvsets  in node
  * @tn_pfx_spill:    true if spills/scans from this node use the prefix hash
+ * @tn_fidx:         kvset fence index, NULL if it could not be built
  * @tn_tree:         ptr to tree struct
  * @tn_parent:       parent node
  * @tn_child:        child nodes
@@ -191,6 +228,7 @@ struct cn_tree_node {
     bool                 tn_terminal_node_warning;
     bool                 tn_pfx_spill;
     struct list_head     tn_kvset_list; /* head = newest kvset */
+    struct cn_node_fidx *tn_fidx;
     struct cn_tree *     tn_tree;
     struct cn_tree_node *tn_parent;
     struct cn_tree_node *tn_childv[];
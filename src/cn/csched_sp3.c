@@ -1064,6 +1064,12 @@ sp3_dirty_node(struct sp3 *sp, struct cn_tree_node *tn)
     garbage = samp_pct_garbage(&tn->tn_samp, 100);
 
     if (cn_node_isleaf(tn)) {
+        u64 expired = kvset_exp_vlen(&tn->tn_ns.ns_kst, kvs_expiry_now());
+
+        /* Expired values are garbage the key samples cannot see.
+         */
+        if (expired && alen)
+            garbage = min_t(u64, 100, garbage + 100 * expired / alen);
 
         /* RBT_L_GARB: leaf nodes sorted by pct garbage.
          * Range: 0 <= rbe_weight <= 100.  If rbe_weight == 3, then
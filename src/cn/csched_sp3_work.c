@@ -789,6 +789,7 @@ sp3_work(
     w->cw_ds = tn->tn_tree->ds;
     w->cw_rp = tn->tn_tree->rp;
     w->cw_cp = tn->tn_tree->ct_cp;
+    w->cw_mop = cn_get_merge_op(tn->tn_tree->cn);
     w->cw_pfx_len = tn->tn_tree->ct_cp->cp_pfx_len;
 
     w->cw_kvset_cnt = n_kvsets;
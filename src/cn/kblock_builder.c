@@ -15,12 +15,14 @@
 #include <hse_ikvdb/kvset_builder.h>
 #include <hse_ikvdb/cn.h>
 #include <hse_ikvdb/kvs_rparams.h>
+#include <hse_ikvdb/rtomb.h>
 
 #include <hse_util/alloc.h>
 #include <hse_util/slab.h>
 #include <hse_util/page.h>
 #include <hse_util/assert.h>
 #include <hse_util/bloom_filter.h>
+#include <hse_util/fuse_filter.h>
 #include <hse_util/event_counter.h>
 #include <hse_util/perfc.h>
 #include <hse_util/hlog.h>
@@ -94,8 +96,17 @@ struct hash_set {
  * @wbt_pgc:  Number of pages reserved for wbtree.
  * @blm_pgc:  Number of pages reserved for Bloom filter.
  * @bloom_elt_cap: Number of keys Bloom filter can hold at current size
+ * @fuse_fpbits: Fingerprint bits if a fuse filter is to be built in place
+ *               of the Bloom filter, zero otherwise.
  * @hash_set:  Hash set to store key hashes. Used to build
  *             Bloom filter at end of kblock construction.
+ * @pbm_pgc:   Number of pages reserved for the prefix Bloom filter.
+ * @pbm_elt_cap: Number of prefixes the prefix Bloom filter can hold
+ * @pfx_len:   Prefix length whose hashes go in the prefix Bloom filter,
+ *             zero if there is no prefix Bloom filter.
+ * @pfx_cnt:   Number of distinct prefixes in @pfx_set.
+ * @pfx_last:  Hash of the most recently added prefix.
+ * @pfx_set:   Hash set to store prefix hashes.
  * @num_keys:  Number of keys in kblock.
  * @num_tombstones:  Number of keys in kblock that have tombstone values.
  * @total_key_bytes: Sum of all key lengths.
@@ -123,6 +134,8 @@ struct hash_set {
  *   Wbtree occupies next wbt_pgc pages.
  *
  *   Bloom tree occupies next blm_pbc pages.
+ *
+ *   Prefix Bloom filter (if any) occupies next pbm_pgc pages.
  */
 struct curr_kblock {
 
@@ -142,19 +155,30 @@ struct curr_kblock {
     uint wbt_pgc;
 
     uint                   blm_elt_cap;
+    uint                   fuse_fpbits;
     struct hash_set        hash_set;
     struct bf_bithash_desc desc;
 
+    uint            pbm_pgc;
+    uint            pbm_elt_cap;
+    uint            pfx_len;
+    uint            pfx_cnt;
+    u64             pfx_last;
+    struct hash_set pfx_set;
+
     void *kblk_hdr;
     void *bloom;
     uint  bloom_len;
     uint  bloom_alloc_len;
+    void *pbloom;
+    uint  pbloom_len;
+    uint  pbloom_alloc_len;
 };
 
 static __always_inline uint
 free_pgc(struct curr_kblock *kblk)
 {
-    uint used = KBLOCK_HDR_PAGES + HLOG_PGC + kblk->blm_pgc + kblk->wbt_pgc;
+    uint used = KBLOCK_HDR_PAGES + HLOG_PGC + kblk->blm_pgc + kblk->pbm_pgc + kblk->wbt_pgc;
 
     assert(kblk->max_pgc >= used);
     if (kblk->max_pgc >= used)
@@ -168,6 +192,13 @@ free_pgc(struct curr_kblock *kblk)
  * @finished_kblks: list of finished kblocks (written, not committed)
  * @curr: the kblock currently being built
  * @finished: mark builder as finished (end of life)
+ * @rt_buf: page aligned buffer of omf-encoded range tombstones
+ * @rt_len: bytes used in @rt_buf
+ * @rt_alloc: bytes allocated for @rt_buf
+ * @rt_cnt: number of range tombstones in @rt_buf
+ * @exp_vlen: on-media length of all values that have an expiry time
+ * @exp_min: earliest expiry time of all values, zero if none
+ * @exp_max: latest expiry time of all values
  */
 struct kblock_builder {
     struct mpool *             ds;
@@ -187,6 +218,13 @@ struct kblock_builder {
     uint                       pt_max_pgc;
     u64                        seqno_min;
     u64                        seqno_max;
+    void *                     rt_buf;
+    uint                       rt_len;
+    uint                       rt_alloc;
+    uint                       rt_cnt;
+    u64                        exp_vlen;
+    u64                        exp_min;
+    u64                        exp_max;
 };
 
 /**
@@ -375,7 +413,7 @@ hash_set_init(struct hash_set *hs)
 }
 
 static merr_t
-hash_set_add(struct hash_set *hs, const struct key_obj *kobj)
+hash_set_add_hash(struct hash_set *hs, u64 hash)
 {
     if (!hs->curr_part) {
         hs->curr_part = malloc(sizeof(*hs->curr_part));
@@ -387,7 +425,7 @@ hash_set_add(struct hash_set *hs, const struct key_obj *kobj)
 
     assert(hs->curr_part->n_hashes < HSP_HASH_MAX_KEYS);
 
-    hs->curr_part->hashvec[hs->curr_part->n_hashes++] = key_obj_hash64(kobj);
+    hs->curr_part->hashvec[hs->curr_part->n_hashes++] = hash;
 
     /* If full, then use next part.  If next is null, allocate new
      * part next time one is added.
@@ -397,6 +435,12 @@ hash_set_add(struct hash_set *hs, const struct key_obj *kobj)
     return 0;
 }
 
+static merr_t
+hash_set_add(struct hash_set *hs, const struct key_obj *kobj)
+{
+    return hash_set_add_hash(hs, key_obj_hash64(kobj));
+}
+
 void
 hash_set_reset(struct hash_set *hs)
 {
@@ -458,6 +502,7 @@ kblock_init(
     memset(kblk, 0, sizeof(*kblk));
 
     hash_set_init(&kblk->hash_set);
+    hash_set_init(&kblk->pfx_set);
 
     kblk->max_size = max_size;
     kblk->max_pgc = max_size / PAGE_SIZE;
@@ -466,6 +511,9 @@ kblock_init(
     kblk->pc = pc;
     kblk->desc = bf_compute_bithash_est(rp->cn_bloom_prob);
 
+    if (rp->cn_bloom_create && rp->cn_bloom_pfx)
+        kblk->pfx_len = cp->cp_pfx_len;
+
     err = wbb_create(&kblk->wbtree, kblk->wbt_pgc + free_pgc(kblk), &kblk->wbt_pgc);
     if (ev(err))
         return err;
@@ -487,7 +535,13 @@ kblock_reset(struct curr_kblock *kblk)
     kblk->blm_elt_cap = 0;
     kblk->bloom_len = 0;
 
+    kblk->pbm_pgc = 0;
+    kblk->pbm_elt_cap = 0;
+    kblk->pfx_cnt = 0;
+    kblk->pbloom_len = 0;
+
     hash_set_reset(&kblk->hash_set);
+    hash_set_reset(&kblk->pfx_set);
 
     wbb_reset(kblk->wbtree, &kblk->wbt_pgc);
 }
@@ -500,9 +554,11 @@ kblock_free(struct curr_kblock *kblk)
 {
     free_aligned(kblk->kblk_hdr);
     free_aligned(kblk->bloom);
+    free_aligned(kblk->pbloom);
 
     wbb_destroy(kblk->wbtree);
     hash_set_free(&kblk->hash_set);
+    hash_set_free(&kblk->pfx_set);
     memset(kblk, 0, sizeof(*kblk));
 }
 
@@ -537,11 +593,18 @@ kblock_add_entry(
         size_t tree_sfx_len = kblk->cp->cp_sfx_len;
 
         /* Ensure we have enough pages reserved for bloom filters. */
-        if (kblk->num_keys + 1 > kblk->blm_elt_cap) {
+        while (kblk->num_keys + 1 > kblk->blm_elt_cap) {
+            size_t blm_sz;
+
             if (!free_pgc(kblk))
                 return 0;
             kblk->blm_pgc++;
-            kblk->blm_elt_cap = bf_element_estimate(kblk->desc, kblk->blm_pgc * PAGE_SIZE);
+
+            blm_sz = kblk->blm_pgc * PAGE_SIZE;
+            if (kblk->fuse_fpbits)
+                kblk->blm_elt_cap = fuse_element_estimate(blm_sz, kblk->fuse_fpbits);
+            else
+                kblk->blm_elt_cap = bf_element_estimate(kblk->desc, blm_sz);
         }
 
         /* Add key's hash to hash_set. Hash only on the soft prefix. */
@@ -561,6 +624,31 @@ kblock_add_entry(
             return err;
     }
 
+    /* Keys are added in order, so each distinct prefix is added to
+     * the prefix bloom only once.  Keys shorter than the prefix are
+     * left out as they can't match a prefix probe or cursor.
+     */
+    if (kblk->pfx_len && key_obj_len(kobj) >= kblk->pfx_len) {
+        u64 hash = pfx_obj_hash64(kobj, kblk->pfx_len);
+
+        if (!kblk->pfx_cnt || hash != kblk->pfx_last) {
+            if (kblk->pfx_cnt + 1 > kblk->pbm_elt_cap) {
+                if (!free_pgc(kblk))
+                    return 0;
+                kblk->pbm_pgc++;
+                kblk->pbm_elt_cap =
+                    bf_element_estimate(kblk->desc, kblk->pbm_pgc * PAGE_SIZE);
+            }
+
+            err = hash_set_add_hash(&kblk->pfx_set, hash);
+            if (ev(err))
+                return err;
+
+            kblk->pfx_last = hash;
+            kblk->pfx_cnt++;
+        }
+    }
+
     /* update wbtree */
     err = wbb_add_entry(
         kblk->wbtree,
@@ -584,6 +672,60 @@ kblock_add_entry(
     return 0;
 }
 
+/**
+ * _kblock_finish_fuse() - build a fuse filter in place of the Bloom filter
+ * @blm_hdr: (output) Bloom filter header
+ *
+ * Return: EAGAIN (or EINVAL, if the filter does not fit the pages reserved
+ * for it) if the caller should fall back to a Bloom filter.
+ */
+static merr_t
+_kblock_finish_fuse(struct curr_kblock *kblk, struct bloom_hdr_omf *blm_hdr)
+{
+    struct fuse_filter    ff;
+    struct hash_set_part *part;
+    u64 *                 hashv;
+    u32                   hashc;
+    merr_t                err;
+
+    err = fuse_filter_init(&ff, kblk->num_keys, kblk->fuse_fpbits, kblk->bloom, kblk->bloom_len);
+    if (ev(err))
+        return err;
+
+    hashv = malloc(sizeof(*hashv) * kblk->num_keys);
+    if (ev(!hashv))
+        return merr(ENOMEM);
+
+    /* The hash set may end with the hash of a key that didn't fit in
+     * the kblock, which must not be copied past the end of hashv.
+     */
+    hashc = 0;
+    list_for_each_entry (part, &kblk->hash_set.part_list, part_link) {
+        u32 n = min_t(u32, part->n_hashes, kblk->num_keys - hashc);
+
+        memcpy(hashv + hashc, part->hashvec, sizeof(*hashv) * n);
+        hashc += n;
+    }
+
+    err = fuse_filter_build(&ff, hashv, hashc);
+    free(hashv);
+    if (ev(err))
+        return err;
+
+    memset(blm_hdr, 0, sizeof(*blm_hdr));
+    omf_set_bh_magic(blm_hdr, BLOOM_OMF_MAGIC);
+    omf_set_bh_version(blm_hdr, BLOOM_OMF_VERSION6);
+    omf_set_bh_bitmapsz(blm_hdr, kblk->bloom_len);
+    omf_set_bh_modulus(blm_hdr, ff.ff_segcntlen);
+    omf_set_bh_bktshift(blm_hdr, ilog2(ff.ff_seglen));
+    omf_set_bh_n_hashes(blm_hdr, FUSE_ARITY);
+    omf_set_bh_fpbits(blm_hdr, ff.ff_fpbits);
+    omf_set_bh_seed_lo(blm_hdr, ff.ff_seed);
+    omf_set_bh_seed_hi(blm_hdr, ff.ff_seed >> 32);
+
+    return 0;
+}
+
 /**
  * _kblock_finish_bloom() - finalize wbtree and Bloom filter regions
  * @blm_hdr: (output) Bloom filter header
@@ -610,8 +752,16 @@ _kblock_finish_bloom(struct curr_kblock *kblk, struct bloom_hdr_omf *blm_hdr)
             kblk->bloom_alloc_len = kblk->bloom_len;
         }
 
+        if (kblk->fuse_fpbits) {
+            merr_t err = _kblock_finish_fuse(kblk, blm_hdr);
+
+            /* Fall back to a Bloom filter if the fuse filter can't be built. */
+            if (!err || (merr_errno(err) != EAGAIN && merr_errno(err) != EINVAL))
+                return err;
+        }
+
         memset(kblk->bloom, 0, kblk->bloom_len);
-        bf_filter_init(&bloom, kblk->desc, kblk->num_keys, kblk->bloom, kblk->bloom_len);
+        bf_filter_init_sb(&bloom, kblk->desc, kblk->num_keys, kblk->bloom, kblk->bloom_len);
         list_for_each_entry (part, &kblk->hash_set.part_list, part_link) {
             bf_filter_insert_by_hashv(&bloom, part->hashvec, part->n_hashes);
         }
@@ -620,7 +770,7 @@ _kblock_finish_bloom(struct curr_kblock *kblk, struct bloom_hdr_omf *blm_hdr)
     /* Construct Bloom header */
     memset(blm_hdr, 0, sizeof(*blm_hdr));
     omf_set_bh_magic(blm_hdr, BLOOM_OMF_MAGIC);
-    omf_set_bh_version(blm_hdr, BLOOM_OMF_VERSION);
+    omf_set_bh_version(blm_hdr, BLOOM_OMF_VERSION5);
     omf_set_bh_bitmapsz(blm_hdr, bloom.bf_bitmapsz);
     omf_set_bh_modulus(blm_hdr, bloom.bf_modulus);
     omf_set_bh_bktshift(blm_hdr, bloom.bf_bktshift);
@@ -630,10 +780,55 @@ _kblock_finish_bloom(struct curr_kblock *kblk, struct bloom_hdr_omf *blm_hdr)
     return 0;
 }
 
+/**
+ * _kblock_finish_pfx_bloom() - finalize the prefix Bloom filter region
+ * @pbm_hdr: (output) prefix Bloom filter header
+ */
+static merr_t
+_kblock_finish_pfx_bloom(struct curr_kblock *kblk, struct bloom_hdr_omf *pbm_hdr)
+{
+    struct bloom_filter   bloom;
+    struct hash_set_part *part;
+
+    memset(pbm_hdr, 0, sizeof(*pbm_hdr));
+
+    if (kblk->pbm_pgc == 0)
+        return 0;
+
+    kblk->pbloom_len = kblk->pbm_pgc * PAGE_SIZE;
+    if (kblk->pbloom_alloc_len < kblk->pbloom_len) {
+        free_aligned(kblk->pbloom);
+        kblk->pbloom = alloc_page_aligned(kblk->pbloom_len, GFP_KERNEL);
+        if (ev(!kblk->pbloom)) {
+            kblk->pbloom_len = 0;
+            kblk->pbloom_alloc_len = 0;
+            return merr(ENOMEM);
+        }
+        kblk->pbloom_alloc_len = kblk->pbloom_len;
+    }
+
+    memset(kblk->pbloom, 0, kblk->pbloom_len);
+    bf_filter_init_sb(&bloom, kblk->desc, kblk->pfx_cnt, kblk->pbloom, kblk->pbloom_len);
+    list_for_each_entry (part, &kblk->pfx_set.part_list, part_link) {
+        bf_filter_insert_by_hashv(&bloom, part->hashvec, part->n_hashes);
+    }
+
+    omf_set_bh_magic(pbm_hdr, BLOOM_OMF_MAGIC);
+    omf_set_bh_version(pbm_hdr, BLOOM_OMF_VERSION5);
+    omf_set_bh_bitmapsz(pbm_hdr, bloom.bf_bitmapsz);
+    omf_set_bh_modulus(pbm_hdr, bloom.bf_modulus);
+    omf_set_bh_bktshift(pbm_hdr, bloom.bf_bktshift);
+    omf_set_bh_rotl(pbm_hdr, bloom.bf_rotl);
+    omf_set_bh_n_hashes(pbm_hdr, bloom.bf_n_hashes);
+
+    return 0;
+}
+
 /**
  * _kblock_make_header() - prepare kblock omf header for writing
  * @wbt_hdr: (input) Wbtree header
  * @blm_hdr: (input) Bloom filter header
+ * @pbm_hdr: (input) prefix Bloom filter header
  *
  * Caller must ensure the kblock is not empty.
  *
@@ -644,6 +839,10 @@ _kblock_finish_bloom(struct curr_kblock *kblk, struct bloom_hdr_omf *blm_hdr)
  *    wbtree header;
  *    pad to 8 bytes;
  *    bloom filter header;
+ *    pad to 8 bytes;
+ *    ptree header;
+ *    pad to 8 bytes;
+ *    prefix bloom filter header;
  *    pad so that min key is at end of page, min & max keys are 8-byte aligned
  *    max key;
  *    pad to 8 bytes;
@@ -656,7 +855,13 @@ _kblock_make_header(
     struct wbt_hdr_omf *   wbt_hdr,
     struct wbt_hdr_omf *   pt_hdr,
     uint                   pt_pgc,
+    uint                   rt_pgc,
+    uint                   rt_cnt,
+    uint                   rt_len,
+    struct key_obj *       rt_min,
+    struct key_obj *       rt_max,
     struct bloom_hdr_omf * blm_hdr,
+    struct bloom_hdr_omf * pbm_hdr,
     u64                    seqno_min,
     u64                    seqno_max,
     struct kblock_hdr_omf *hdr)
@@ -677,8 +882,8 @@ _kblock_make_header(
     off = 0;
 
     assert(
-        sizeof(*hdr) + sizeof(*wbt_hdr) + sizeof(*blm_hdr) + sizeof(pt_hdr) + 4 * align +
-            2 * HSE_KBLOCK_OMF_KLEN_MAX <=
+        sizeof(*hdr) + sizeof(*wbt_hdr) + sizeof(*blm_hdr) + sizeof(pt_hdr) +
+            sizeof(*pbm_hdr) + 5 * align + 2 * HSE_KBLOCK_OMF_KLEN_MAX <=
         PAGE_SIZE);
 
     omf_set_kbh_magic(hdr, KBLOCK_HDR_MAGIC);
@@ -708,6 +913,12 @@ _kblock_make_header(
     omf_set_kbh_pt_hoff(hdr, off);
     omf_set_kbh_pt_hlen(hdr, sizeof(*pt_hdr));
 
+    off += omf_kbh_pt_hlen(hdr);
+    off = (off + align) & ~align;
+
+    omf_set_kbh_pbm_hoff(hdr, off);
+    omf_set_kbh_pbm_hlen(hdr, sizeof(*pbm_hdr));
+
     /* get min/max keys */
     wbb_min_max_keys(kblk->wbtree, &min_kobj, &max_kobj);
     if (ptree) {
@@ -754,6 +965,17 @@ _kblock_make_header(
         }
     }
 
+    /* Like ptombs, range tombstones widen the key range of the kblock
+     * that holds them.
+     */
+    if (rt_min) {
+        if (!key_obj_len(min_kobj) || key_obj_cmp(rt_min, min_kobj) < 0)
+            min_kobj = rt_min;
+
+        if (!key_obj_len(max_kobj) || key_obj_cmp(rt_max, max_kobj) > 0)
+            max_kobj = rt_max;
+    }
+
 #ifndef NDEBUG
     if (omf_wbt_kmd_pgc(wbt_hdr)) {
         uint minkey_len = key_obj_len(min_kobj);
@@ -777,7 +999,7 @@ _kblock_make_header(
     omf_set_kbh_max_klen(hdr, key_obj_len(max_kobj));
 
     /* make sure bloom header doesn't overlap with max key */
-    assert(omf_kbh_max_koff(hdr) >= omf_kbh_pt_hoff(hdr) + sizeof(*pt_hdr));
+    assert(omf_kbh_max_koff(hdr) >= omf_kbh_pbm_hoff(hdr) + sizeof(*pbm_hdr));
 
     /* make sure max key doesn't overlap with min key */
     assert(omf_kbh_min_koff(hdr) >= omf_kbh_max_koff(hdr) + key_obj_len(max_kobj));
@@ -789,14 +1011,28 @@ _kblock_make_header(
     omf_set_kbh_blm_doff_pg(hdr, KBLOCK_HDR_PAGES + kblk->wbt_pgc);
     omf_set_kbh_blm_dlen_pg(hdr, kblk->blm_pgc);
 
-    omf_set_kbh_hlog_doff_pg(hdr, KBLOCK_HDR_PAGES + kblk->wbt_pgc + kblk->blm_pgc);
+    if (kblk->pbm_pgc) {
+        omf_set_kbh_pbm_doff_pg(hdr, KBLOCK_HDR_PAGES + kblk->wbt_pgc + kblk->blm_pgc);
+        omf_set_kbh_pbm_dlen_pg(hdr, kblk->pbm_pgc);
+    }
+
+    off = KBLOCK_HDR_PAGES + kblk->wbt_pgc + kblk->blm_pgc + kblk->pbm_pgc;
+
+    omf_set_kbh_hlog_doff_pg(hdr, off);
     omf_set_kbh_hlog_dlen_pg(hdr, HLOG_PGC);
 
     if (pt_pgc) {
-        omf_set_kbh_pt_doff_pg(hdr, KBLOCK_HDR_PAGES + kblk->wbt_pgc + kblk->blm_pgc + HLOG_PGC);
+        omf_set_kbh_pt_doff_pg(hdr, off + HLOG_PGC);
         omf_set_kbh_pt_dlen_pg(hdr, pt_pgc);
     }
 
+    if (rt_pgc) {
+        omf_set_kbh_rt_doff_pg(hdr, off + HLOG_PGC + pt_pgc);
+        omf_set_kbh_rt_dlen_pg(hdr, rt_pgc);
+        omf_set_kbh_rt_cnt(hdr, rt_cnt);
+        omf_set_kbh_rt_len(hdr, rt_len);
+    }
+
     omf_set_kbh_min_seqno(hdr, seqno_min);
     omf_set_kbh_max_seqno(hdr, seqno_max);
 
@@ -807,11 +1043,40 @@ _kblock_make_header(
     memcpy(base + omf_kbh_wbt_hoff(hdr), wbt_hdr, sizeof(*wbt_hdr));
     memcpy(base + omf_kbh_blm_hoff(hdr), blm_hdr, sizeof(*blm_hdr));
     memcpy(base + omf_kbh_pt_hoff(hdr), pt_hdr, sizeof(*pt_hdr));
+    memcpy(base + omf_kbh_pbm_hoff(hdr), pbm_hdr, sizeof(*pbm_hdr));
 
     key_obj_copy(base + omf_kbh_max_koff(hdr), HSE_KVS_KLEN_MAX, 0, max_kobj);
     key_obj_copy(base + omf_kbh_min_koff(hdr), HSE_KVS_KLEN_MAX, 0, min_kobj);
 }
 
+/**
+ * kbb_rtomb_min_max() - find the smallest start key and largest end key
+ *                       of the range tombstones in the builder
+ */
+static void
+kbb_rtomb_min_max(struct kblock_builder *bld, struct key_obj *min, struct key_obj *max)
+{
+    const void *p = bld->rt_buf;
+    uint        i;
+
+    for (i = 0; i < bld->rt_cnt; i++) {
+        const struct rtomb_omf *omf = p;
+        struct key_obj          start, end;
+        uint                    slen = omf_rto_slen(omf);
+        uint                    elen = omf_rto_elen(omf);
+
+        key2kobj(&start, p + sizeof(*omf), slen);
+        key2kobj(&end, p + sizeof(*omf) + slen, elen);
+
+        if (i == 0 || key_obj_cmp(&start, min) < 0)
+            *min = start;
+        if (i == 0 || key_obj_cmp(&end, max) > 0)
+            *max = end;
+
+        p += sizeof(*omf) + slen + elen;
+    }
+}
+
 size_t
 kbb_estimate_alen(struct cn *cn, size_t wlen, enum mp_media_classp mclass)
 {
@@ -834,9 +1099,11 @@ static merr_t
 kblock_finish(struct kblock_builder *bld, struct wbb *ptree)
 {
     struct bloom_hdr_omf blm_hdr;
+    struct bloom_hdr_omf pbm_hdr;
     struct wbt_hdr_omf   wbt_hdr;
     struct wbt_hdr_omf   pt_hdr = { 0 };
     struct mblock_props  mbprop;
+    struct key_obj       rt_min, rt_max;
 
     struct curr_kblock *   kblk = &bld->curr;
     struct cn_merge_stats *stats = bld->mstats;
@@ -852,6 +1119,7 @@ kblock_finish(struct kblock_builder *bld, struct wbb *ptree)
     merr_t err;
     u64    blkid = 0;
     uint   pt_pgc = 0;
+    uint   rt_pgc = 0;
     u64    tstart = 0;
     u64    kblocksz;
     bool   spare;
@@ -867,13 +1135,20 @@ kblock_finish(struct kblock_builder *bld, struct wbb *ptree)
         }
     }
 
-    /* Include wbtree pages from main and ptree and add 3 more iov members for
-     * the kblock header, bloom and hlog
+    /* Include wbtree pages from main and ptree and add 4 more iov members for
+     * the kblock header, blooms and hlog
      */
-    iov_max = 3 + 1 + wbb_max_inodec_get(kblk->wbtree) + wbb_kmd_pgc_get(kblk->wbtree);
+    iov_max = 4 + 1 + wbb_max_inodec_get(kblk->wbtree) + wbb_kmd_pgc_get(kblk->wbtree);
     if (ptree && wbb_entries(ptree))
         iov_max += 1 + wbb_max_inodec_get(ptree) + wbb_kmd_pgc_get(ptree);
 
+    /* Range tombstones are written along with the ptree, after it.
+     */
+    if (ptree && bld->rt_cnt) {
+        rt_pgc = PAGE_ALIGN(bld->rt_len) / PAGE_SIZE;
+        iov_max += 1;
+    }
+
     iov = malloc(sizeof(*iov) * iov_max);
     if (ev(!iov))
         return merr(ENOMEM);
@@ -907,6 +1182,15 @@ kblock_finish(struct kblock_builder *bld, struct wbb *ptree)
         iov_cnt++;
     }
 
+    err = _kblock_finish_pfx_bloom(kblk, &pbm_hdr);
+    if (ev(err))
+        goto errout;
+    if (kblk->pbloom_len) {
+        iov[iov_cnt].iov_base = kblk->pbloom;
+        iov[iov_cnt].iov_len = kblk->pbloom_len;
+        iov_cnt++;
+    }
+
     /* Finalize HyperLogLog. */
     iov[iov_cnt].iov_base = hlog_data(bld->hlog);
     iov[iov_cnt].iov_len = HLOG_PGC * PAGE_SIZE;
@@ -916,17 +1200,55 @@ kblock_finish(struct kblock_builder *bld, struct wbb *ptree)
     wbb_hdr_init(ptree, &pt_hdr);
     if (ptree && wbb_entries(ptree)) {
         pt_pgc = bld->pt_pgc;
+        assert(free_pgc(kblk) >= rt_pgc);
         err = wbb_freeze(
-            ptree, &pt_hdr, bld->pt_pgc + free_pgc(kblk), &pt_pgc, iov + iov_cnt, iov_max, &i);
+            ptree,
+            &pt_hdr,
+            bld->pt_pgc + free_pgc(kblk) - rt_pgc,
+            &pt_pgc,
+            iov + iov_cnt,
+            iov_max,
+            &i);
         if (ev(err))
             goto errout;
         iov_cnt += i;
     }
 
+    /* Finalize range tombstones */
+    if (rt_pgc) {
+        memset(bld->rt_buf + bld->rt_len, 0, rt_pgc * PAGE_SIZE - bld->rt_len);
+        iov[iov_cnt].iov_base = bld->rt_buf;
+        iov[iov_cnt].iov_len = rt_pgc * PAGE_SIZE;
+        iov_cnt++;
+
+        kbb_rtomb_min_max(bld, &rt_min, &rt_max);
+    }
+
     /* Format kblock header. */
-    kblk->num_keys += ptree ? wbb_entries(ptree) : 0;
+    kblk->num_keys += ptree ? wbb_entries(ptree) + bld->rt_cnt : 0;
     _kblock_make_header(
-        kblk, ptree, &wbt_hdr, &pt_hdr, pt_pgc, &blm_hdr, bld->seqno_min, bld->seqno_max, kblk->kblk_hdr);
+        kblk,
+        ptree,
+        &wbt_hdr,
+        &pt_hdr,
+        pt_pgc,
+        rt_pgc,
+        rt_pgc ? bld->rt_cnt : 0,
+        rt_pgc ? bld->rt_len : 0,
+        rt_pgc ? &rt_min : NULL,
+        rt_pgc ? &rt_max : NULL,
+        &blm_hdr,
+        &pbm_hdr,
+        bld->seqno_min,
+        bld->seqno_max,
+        kblk->kblk_hdr);
+
+    /* The expiry stats accumulate over all the kblocks written so far,
+     * so the final kblock has them for the whole kvset.
+     */
+    omf_set_kbh_exp_vlen(kblk->kblk_hdr, bld->exp_vlen);
+    omf_set_kbh_exp_min(kblk->kblk_hdr, bld->exp_min);
+    omf_set_kbh_exp_max(kblk->kblk_hdr, bld->exp_max);
 
     assert(iov_cnt <= iov_max);
 
@@ -1011,6 +1333,20 @@ errout:
  * Kblock Builder
  */
 
+/* Kblocks in the node types selected by cn_bloom_static (bit 0 for root,
+ * 1 for internal, 2 for leaf nodes) get a fuse filter instead of a bloom.
+ */
+static uint
+kbb_fuse_fpbits(struct kblock_builder *bld)
+{
+    uint bit = bld->agegroup - HSE_MPOLICY_AGE_ROOT;
+
+    if (bld->agegroup < HSE_MPOLICY_AGE_ROOT || !(bld->rp->cn_bloom_static & (1u << bit)))
+        return 0;
+
+    return fuse_fpbits_est(bld->rp->cn_bloom_prob);
+}
+
 /* Create a kblock builder */
 merr_t
 kbb_create(struct kblock_builder **builder_out, struct cn *cn, struct perfc_set *pc, uint flags)
@@ -1044,6 +1380,8 @@ kbb_create(struct kblock_builder **builder_out, struct cn *cn, struct perfc_set
     if (ev(err))
         goto err_exit2;
 
+    bld->curr.fuse_fpbits = kbb_fuse_fpbits(bld);
+
     err = wbb_create(&bld->ptree, kb_size / PAGE_SIZE, &bld->pt_pgc);
     if (ev(err))
         goto err_exit3;
@@ -1072,6 +1410,7 @@ kbb_destroy(struct kblock_builder *bld)
     hlog_destroy(bld->hlog);
     kblock_free(&bld->curr);
     wbb_destroy(bld->ptree);
+    free_aligned(bld->rt_buf);
     abort_mblocks(bld->ds, &bld->finished_kblks);
     blk_list_free(&bld->finished_kblks);
     free(bld);
@@ -1108,6 +1447,52 @@ kbb_add_ptomb(
     return 0;
 }
 
+merr_t
+kbb_add_rtomb(struct kblock_builder *bld, const struct rtomb *rt)
+{
+    struct rtomb_omf *omf;
+    uint              need, pgc;
+
+    assert(!bld->finished);
+    assert(rt->rt_slen > 0 && rt->rt_elen > 0);
+
+    need = sizeof(*omf) + rt->rt_slen + rt->rt_elen;
+
+    /* All rtombs must fit in the final kblock along with the ptree.
+     */
+    pgc = PAGE_ALIGN(bld->rt_len + need) / PAGE_SIZE;
+    if (ev(KBLOCK_HDR_PAGES + HLOG_PGC + bld->pt_pgc + pgc >= bld->curr.max_size / PAGE_SIZE))
+        return merr(EXFULL);
+
+    if (bld->rt_len + need > bld->rt_alloc) {
+        uint  sz = max_t(uint, bld->rt_alloc * 2, pgc * PAGE_SIZE);
+        void *buf;
+
+        buf = alloc_page_aligned(sz, GFP_KERNEL);
+        if (ev(!buf))
+            return merr(ENOMEM);
+
+        if (bld->rt_len)
+            memcpy(buf, bld->rt_buf, bld->rt_len);
+        free_aligned(bld->rt_buf);
+
+        bld->rt_buf = buf;
+        bld->rt_alloc = sz;
+    }
+
+    omf = bld->rt_buf + bld->rt_len;
+    omf_set_rto_seq(omf, rt->rt_seq);
+    omf_set_rto_slen(omf, rt->rt_slen);
+    omf_set_rto_elen(omf, rt->rt_elen);
+    memcpy((void *)(omf + 1), rt->rt_start, rt->rt_slen);
+    memcpy((void *)(omf + 1) + rt->rt_slen, rt->rt_end, rt->rt_elen);
+
+    bld->rt_len += need;
+    bld->rt_cnt++;
+
+    return 0;
+}
+
 /* Add a key with a vref to kblock. Create new kblock if needed. */
 merr_t
 kbb_add_entry(
@@ -1127,6 +1512,12 @@ kbb_add_entry(
     assert(kmd_len);
     assert(stats->nvals);
 
+    if (stats->exp_vlen) {
+        bld->exp_vlen += stats->exp_vlen;
+        bld->exp_min = bld->exp_min ? min_t(u64, bld->exp_min, stats->exp_min) : stats->exp_min;
+        bld->exp_max = max_t(u64, bld->exp_max, stats->exp_max);
+    }
+
     hash = hse_hash64v_seed(
         kobj->ko_pfx, kobj->ko_pfx_len, kobj->ko_sfx, kobj->ko_sfx_len, 271828182845ull);
 
@@ -1194,14 +1585,20 @@ kbb_finish(struct kblock_builder *bld, struct blk_list *kblks, u64 seqno_min, u6
         struct wbb *pt = 0;
         u64         kbsize = (bld->rp->kblock_size_mb << 20);
         u64         ptsize = (wbb_page_cnt_get(bld->ptree)) * PAGE_SIZE;
+        u64         rtsize = PAGE_ALIGN(bld->rt_len);
         u64         kbused =
             (KBLOCK_HDR_PAGES + HLOG_PGC + bld->curr.blm_pgc + wbb_page_cnt_get(bld->curr.wbtree)) *
             PAGE_SIZE;
 
-        hse_log(HSE_DEBUG "kbsize %lu kbused %lu ptsize %lu", kbsize, kbused, ptsize);
+        hse_log(
+            HSE_DEBUG "kbsize %lu kbused %lu ptsize %lu rtsize %lu",
+            kbsize,
+            kbused,
+            ptsize,
+            rtsize);
 
-        /* Write ptree here if we have enough space */
-        if ((kbused + ptsize < kbsize)) {
+        /* Write ptree and rtombs here if we have enough space */
+        if ((kbused + ptsize + rtsize < kbsize)) {
             pt_kblock = false;
             pt = bld->ptree;
         }
@@ -1211,7 +1608,7 @@ kbb_finish(struct kblock_builder *bld, struct blk_list *kblks, u64 seqno_min, u6
             return err;
     }
 
-    if (wbb_entries(bld->ptree) && pt_kblock) {
+    if ((wbb_entries(bld->ptree) || bld->rt_cnt) && pt_kblock) {
         err = kblock_finish(bld, bld->ptree);
         if (ev(err))
             return err;
@@ -1230,6 +1627,10 @@ void
 kbb_set_agegroup(struct kblock_builder *bld, enum hse_mclass_policy_age age)
 {
     bld->agegroup = age;
+
+    /* Switching filters is only safe before any keys are added. */
+    if (kblock_is_empty(&bld->curr))
+        bld->curr.fuse_fpbits = kbb_fuse_fpbits(bld);
 }
 
 enum hse_mclass_policy_age
@@ -17,15 +17,27 @@ struct kblock_builder;
 struct blk_list;
 struct kvs_rparams;
 struct cn_merge_stats;
+struct rtomb;
 
 enum mp_media_classp;
 enum hse_mclass_policy_age;
 
+/**
+ * struct kbb_key_stats - stats of the values of one key
+ * @exp_vlen: on-media length of values that have an expiry time
+ * @exp_min:  earliest expiry time, zero if @exp_vlen is zero
+ * @exp_max:  latest expiry time
+ *
+ * (Other fields are self explanatory.)
+ */
 struct kbb_key_stats {
     uint nvals;
     uint ntombs;
     uint nptombs;
     u64  tot_vlen;
+    u64  exp_vlen;
+    u64  exp_min;
+    u64  exp_max;
     u64  seqno_prev;
     u64  seqno_prev_ptomb;
     u64  c0_vlen;
@@ -86,6 +98,18 @@ kbb_add_ptomb(
     uint                   kmd_len,
     struct kbb_key_stats * stats);
 
+/**
+ * kbb_add_rtomb() - Store a range tombstone in the final kblock.
+ * @bld: builder handle
+ * @rt:  range tombstone, copied by the builder
+ *
+ * Return: EXFULL if the range tombstones would no longer fit in a
+ * single kblock.
+ */
+/* MTF_MOCK */
+merr_t
+kbb_add_rtomb(struct kblock_builder *bld, const struct rtomb *rt);
+
 /**
  * kbb_add_entry() - Store a key and a value reference in a kblock.
  * @bld: builder handle
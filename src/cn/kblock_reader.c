@@ -15,6 +15,7 @@
 
 #include <hse_ikvdb/kvs_rparams.h>
 #include <hse_ikvdb/tuple.h>
+#include <hse_ikvdb/rtomb.h>
 
 #include <mpool/mpool.h>
 
@@ -60,6 +61,7 @@ kbr_read_wbt_region_desc_mem(void *wbt_hdr, struct wbt_desc *desc)
     desc->wbd_version = wbt_hdr_version(wbt_hdr);
 
     switch (desc->wbd_version) {
+        case WBT_TREE_VERSION7:
         case WBT_TREE_VERSION6:
         case WBT_TREE_VERSION5:
         case WBT_TREE_VERSION4:
@@ -139,6 +141,68 @@ kbr_read_seqno_range(struct kvs_mblk_desc *kblkdesc, u64 *seqno_min, u64 *seqno_
     return 0;
 }
 
+merr_t
+kbr_read_rtombs(struct kvs_mblk_desc *kblkdesc, struct rtomb **rtv_out, uint *rtc_out)
+{
+    struct kblock_hdr_omf *kb_hdr;
+    struct rtomb *         rtv;
+    const void *           p, *end;
+    uint                   rtc, i;
+
+    *rtv_out = NULL;
+    *rtc_out = 0;
+
+    kb_hdr = kblkdesc->map_base;
+    if (!kblock_hdr_valid(kb_hdr))
+        return merr(EINVAL);
+
+    if (omf_kbh_version(kb_hdr) <= KBLOCK_HDR_VERSION5)
+        return 0;
+
+    rtc = omf_kbh_rt_cnt(kb_hdr);
+    if (!rtc)
+        return 0;
+
+    if (ev(omf_kbh_rt_len(kb_hdr) > omf_kbh_rt_dlen_pg(kb_hdr) * PAGE_SIZE))
+        return merr(EPROTO);
+
+    rtv = malloc_array(rtc, sizeof(*rtv));
+    if (ev(!rtv))
+        return merr(ENOMEM);
+
+    /* The rtomb region lives in the mcache map for the life of the
+     * kvset, so the rtomb keys are referenced in place.
+     */
+    p = kblkdesc->map_base + PAGE_SIZE * omf_kbh_rt_doff_pg(kb_hdr);
+    end = p + omf_kbh_rt_len(kb_hdr);
+
+    for (i = 0; i < rtc; i++) {
+        const struct rtomb_omf *omf = p;
+
+        if (ev(p + sizeof(*omf) > end))
+            goto err_proto;
+
+        rtv[i].rt_seq = omf_rto_seq(omf);
+        rtv[i].rt_slen = omf_rto_slen(omf);
+        rtv[i].rt_elen = omf_rto_elen(omf);
+        rtv[i].rt_start = p + sizeof(*omf);
+        rtv[i].rt_end = rtv[i].rt_start + rtv[i].rt_slen;
+
+        p = rtv[i].rt_end + rtv[i].rt_elen;
+        if (ev(p > end))
+            goto err_proto;
+    }
+
+    *rtv_out = rtv;
+    *rtc_out = rtc;
+
+    return 0;
+
+err_proto:
+    free(rtv);
+    return merr(EPROTO);
+}
+
 merr_t
 kbr_read_pt_region_desc(struct kvs_mblk_desc *kblkdesc, struct wbt_desc *desc)
 {
@@ -173,31 +237,24 @@ kbr_read_pt_region_desc(struct kvs_mblk_desc *kblkdesc, struct wbt_desc *desc)
     return err;
 }
 
-merr_t
-kbr_read_blm_region_desc(struct kvs_mblk_desc *kbd, struct bloom_desc *desc)
+/**
+ * kbr_bloom_desc_init() - initialize a bloom descriptor from its omf header
+ * @mbid:    kblock id (for logging)
+ * @blm_omf: bloom header
+ * @doff_pg: first page of the bloom region
+ * @dlen_pg: length of the bloom region in pages
+ * @desc:    (output) bloom descriptor, left zeroed if the header is invalid
+ */
+static merr_t
+kbr_bloom_desc_init(
+    ulong                 mbid,
+    struct bloom_hdr_omf *blm_omf,
+    u32                   doff_pg,
+    u32                   dlen_pg,
+    struct bloom_desc *   desc)
 {
-    merr_t                 err;
-    struct kblock_hdr_omf *hdr;
-    struct bloom_hdr_omf * blm_omf = NULL;
-    void *                 pg = NULL;
-    off_t                  pg_idxs[1];
-    ulong                  mbid;
-    u32                    magic;
-    u32                    version;
-
-    memset(desc, 0, sizeof(*desc));
-    mbid = kbd->mb_id;
-
-    pg_idxs[0] = 0;
-    err = mpool_mcache_getpages(kbd->map, 1, kbd->map_idx, pg_idxs, &pg);
-    if (ev(err))
-        return err;
-
-    hdr = pg;
-    if (!kblock_hdr_valid(hdr))
-        return merr(EINVAL);
-
-    blm_omf = (struct bloom_hdr_omf *)(pg + omf_kbh_blm_hoff(hdr));
+    u32 magic;
+    u32 version;
 
     magic = omf_bh_magic(blm_omf);
     if (ev(magic != BLOOM_OMF_MAGIC)) {
@@ -215,7 +272,7 @@ kbr_read_blm_region_desc(struct kvs_mblk_desc *kbd, struct bloom_desc *desc)
      * it's safe to run without blooms, albeit at a big hit to read perf.
      */
     version = omf_bh_version(blm_omf);
-    if (ev(version != BLOOM_OMF_VERSION)) {
+    if (ev(version < BLOOM_OMF_VERSION4 || version > BLOOM_OMF_VERSION6)) {
         hse_log(
             HSE_ERR "%s: bloom %lx invalid version %u (expected %u)",
             __func__,
@@ -225,18 +282,87 @@ kbr_read_blm_region_desc(struct kvs_mblk_desc *kbd, struct bloom_desc *desc)
         return 0;
     }
 
-    desc->bd_first_page = omf_kbh_blm_doff_pg(hdr);
-    desc->bd_n_pages = omf_kbh_blm_dlen_pg(hdr);
+    desc->bd_first_page = doff_pg;
+    desc->bd_n_pages = dlen_pg;
 
+    desc->bd_version = version;
     desc->bd_modulus = omf_bh_modulus(blm_omf);
     desc->bd_bktshift = omf_bh_bktshift(blm_omf);
     desc->bd_n_hashes = omf_bh_n_hashes(blm_omf);
     desc->bd_rotl = omf_bh_rotl(blm_omf);
     desc->bd_bktmask = (1u << desc->bd_bktshift) - 1;
+    desc->bd_fpbits = omf_bh_fpbits(blm_omf);
+    desc->bd_seed = omf_bh_seed_lo(blm_omf) | ((u64)omf_bh_seed_hi(blm_omf) << 32);
+
+    if (ev(version == BLOOM_OMF_VERSION6 && desc->bd_fpbits != 8 && desc->bd_fpbits != 16)) {
+        hse_log(
+            HSE_ERR "%s: bloom %lx invalid fingerprint size %u",
+            __func__,
+            mbid,
+            desc->bd_fpbits);
+        memset(desc, 0, sizeof(*desc));
+    }
 
     return 0;
 }
 
+merr_t
+kbr_read_blm_region_desc(struct kvs_mblk_desc *kbd, struct bloom_desc *desc)
+{
+    merr_t                 err;
+    struct kblock_hdr_omf *hdr;
+    void *                 pg = NULL;
+    off_t                  pg_idxs[1];
+
+    memset(desc, 0, sizeof(*desc));
+
+    pg_idxs[0] = 0;
+    err = mpool_mcache_getpages(kbd->map, 1, kbd->map_idx, pg_idxs, &pg);
+    if (ev(err))
+        return err;
+
+    hdr = pg;
+    if (!kblock_hdr_valid(hdr))
+        return merr(EINVAL);
+
+    return kbr_bloom_desc_init(
+        kbd->mb_id,
+        pg + omf_kbh_blm_hoff(hdr),
+        omf_kbh_blm_doff_pg(hdr),
+        omf_kbh_blm_dlen_pg(hdr),
+        desc);
+}
+
+merr_t
+kbr_read_pbm_region_desc(struct kvs_mblk_desc *kbd, struct bloom_desc *desc)
+{
+    merr_t                 err;
+    struct kblock_hdr_omf *hdr;
+    void *                 pg = NULL;
+    off_t                  pg_idxs[1];
+
+    memset(desc, 0, sizeof(*desc));
+
+    pg_idxs[0] = 0;
+    err = mpool_mcache_getpages(kbd->map, 1, kbd->map_idx, pg_idxs, &pg);
+    if (ev(err))
+        return err;
+
+    hdr = pg;
+    if (!kblock_hdr_valid(hdr))
+        return merr(EINVAL);
+
+    if (omf_kbh_version(hdr) <= KBLOCK_HDR_VERSION7 || !omf_kbh_pbm_dlen_pg(hdr))
+        return 0;
+
+    return kbr_bloom_desc_init(
+        kbd->mb_id,
+        pg + omf_kbh_pbm_hoff(hdr),
+        omf_kbh_pbm_doff_pg(hdr),
+        omf_kbh_pbm_dlen_pg(hdr),
+        desc);
+}
+
 merr_t
 kbr_read_blm_pages(
     struct kvs_mblk_desc *kbd,
@@ -336,6 +462,14 @@ kbr_read_metrics(struct kvs_mblk_desc *kblkdesc, struct kblk_metrics *metrics)
     metrics->tot_wbt_pages = omf_kbh_wbt_dlen_pg(hdr);
     metrics->tot_blm_pages = omf_kbh_blm_dlen_pg(hdr);
 
+    if (omf_kbh_version(hdr) > KBLOCK_HDR_VERSION6) {
+        metrics->exp_vlen = omf_kbh_exp_vlen(hdr);
+        metrics->exp_min = omf_kbh_exp_min(hdr);
+        metrics->exp_max = omf_kbh_exp_max(hdr);
+    } else {
+        metrics->exp_vlen = metrics->exp_min = metrics->exp_max = 0;
+    }
+
     return 0;
 }
 
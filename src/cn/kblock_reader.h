@@ -15,7 +15,15 @@ struct bloom_desc;
 struct wbt_desc;
 struct kvs_mblk_desc;
 struct kvs_rparams;
+struct rtomb;
 
+/**
+ * struct kblk_metrics - kblock header metrics
+ * @exp_vlen: on-media length of values with an expiry time, in this and
+ *            all preceding kblocks of the kvset
+ * @exp_min:  earliest expiry time of those values
+ * @exp_max:  latest expiry time of those values
+ */
 struct kblk_metrics {
     u32 num_keys;
     u32 num_tombstones;
@@ -23,6 +31,9 @@ struct kblk_metrics {
     u64 tot_val_bytes;
     u32 tot_wbt_pages;
     u32 tot_blm_pages;
+    u64 exp_vlen;
+    u64 exp_min;
+    u64 exp_max;
 };
 
 /**
@@ -61,6 +72,16 @@ kbr_read_wbt_region_desc_mem(void *hdr_page, struct wbt_desc *desc);
 merr_t
 kbr_read_blm_region_desc(struct kvs_mblk_desc *kblock_desc, struct bloom_desc *blm_desc);
 
+/**
+ * kbr_read_pbm_region_desc() - Read the prefix Bloom filter region
+ *                          descriptor for the given KBLOCK ID.
+ * @kblock_desc:    KVBLOCK_DESC for KBLOCK to read
+ * @pbm_desc:       (output) prefix bloom region descriptor, zeroed if
+ *                  the kblock has no prefix bloom
+ */
+merr_t
+kbr_read_pbm_region_desc(struct kvs_mblk_desc *kblock_desc, struct bloom_desc *pbm_desc);
+
 /**
  * kbr_read_blm_pages() - Read the Bloom filter pages
  *                          into an allocated buffer.
@@ -87,6 +108,18 @@ kbr_read_pt_region_desc(struct kvs_mblk_desc *kblkdesc, struct wbt_desc *desc);
 merr_t
 kbr_read_seqno_range(struct kvs_mblk_desc *kblkdesc, u64 *seqno_min, u64 *seqno_max);
 
+/**
+ * kbr_read_rtombs() - Read the range tombstones stored in a kblock
+ * @kblkdesc: KVBLOCK_DESC for KBLOCK to read
+ * @rtv_out:  (output) malloc'd vector of rtombs, NULL if none
+ * @rtc_out:  (output) number of rtombs in @rtv_out
+ *
+ * The rtomb keys point into the kblock's mcache map, so @rtv_out
+ * must not outlive the map.  Caller must free @rtv_out.
+ */
+merr_t
+kbr_read_rtombs(struct kvs_mblk_desc *kblkdesc, struct rtomb **rtv_out, uint *rtc_out);
+
 void
 kbr_free_blm_pages(struct kvs_mblk_desc *kbd, ulong cn_bloom_lookup, void *blm_pages);
 
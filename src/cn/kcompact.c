@@ -166,6 +166,11 @@ kcompact(struct cn_compaction_work *w)
 
     uint seqno_errcnt = 0;
 
+    char kbuf[HSE_KVS_KLEN_MAX];
+    uint klen, i;
+    u64  rt_seq = 0;
+    u64  expiry_now = kvs_expiry_now();
+
     /* 'vbm_used' counts only the values referenced after this compaction;
      * however, waste accumulates from compact-to-compact
      */
@@ -178,6 +183,20 @@ kcompact(struct cn_compaction_work *w)
     if (ev(err))
         return err;
 
+    /* Carry range tombstones forward unless they can be dropped
+     * along with the values they hide.
+     */
+    for (i = 0; i < w->cw_rtombs.rtv_cnt; i++) {
+        const struct rtomb *rt = w->cw_rtombs.rtv_v + i;
+
+        if (w->cw_drop_tombv[0] && rt->rt_seq <= w->cw_horizon)
+            continue;
+
+        err = kvset_builder_add_rtomb(w->cw_child[0], rt);
+        if (ev(err))
+            goto done;
+    }
+
     more = get_next_item(bh, w->cw_inputv, &curr, &w->cw_stats, &err);
     if (!more || ev(err))
         goto done;
@@ -208,6 +227,15 @@ new_key:
     dbg_nvals_this_key = 0;
     dbg_dup = false;
 
+    /* Values older than a range tombstone at or below the horizon
+     * are not visible to any view and can be dropped.
+     */
+    if (w->cw_rtombs.rtv_cnt) {
+        const void *kdata = key_obj_copy(kbuf, sizeof(kbuf), &klen, &curr.kobj);
+
+        rt_seq = rtomb_vec_lookup(&w->cw_rtombs, kdata, klen, w->cw_horizon);
+    }
+
 get_values:
     vdata = NULL;
 
@@ -230,11 +258,22 @@ get_values:
         dbg_nvals_this_key++;
         dbg_prev_seq = seq;
 
+        /* An expired value is no longer visible to any view, so it
+         * is compacted as the tomb it has become.
+         */
+        if (kvs_expired_at(curr.vctx.expiry, expiry_now)) {
+            vtype = vtype_tomb;
+            vlen = complen = 0;
+        }
+
         if (seq <= w->cw_horizon) {
             horizon = false;
             if (pt_set && seq < pt_seq)
                 continue; /* skip value */
 
+            if (seq < rt_seq)
+                continue; /* skip value */
+
             if (vtype == vtype_ptomb) {
                 pt_set = true;
                 pt_kobj = curr.kobj;
@@ -244,6 +283,12 @@ get_values:
 
             if (w->cw_drop_tombv[0] && (vtype == vtype_tomb || vtype == vtype_ptomb))
                 continue; /* skip value */
+
+            /* k-compaction does not fold merge operands, so keep
+             * the value (if any) to which they apply.
+             */
+            if (vtype == vtype_mop)
+                horizon = true;
         }
 
         if (vtype == vtype_ptomb)
@@ -262,13 +307,17 @@ get_values:
             switch (vtype) {
                 case vtype_val:
                 case vtype_cval:
-                    err = kvset_builder_add_vref(
+                    err = kvset_builder_add_vref_expiry(
                         w->cw_child[0], seq, vbidx + w->cw_vbmap.vbm_map[curr.src],
-                        vboff, vlen, complen);
+                        vboff, vlen, complen, curr.vctx.expiry);
                     break;
                 case vtype_zval:
                 case vtype_ival:
-                    err = kvset_builder_add_val(w->cw_child[0], seq, vdata, vlen, 0);
+                    err = kvset_builder_add_val_expiry(
+                        w->cw_child[0], seq, vdata, vlen, 0, curr.vctx.expiry);
+                    break;
+                case vtype_mop:
+                    err = kvset_builder_add_mop(w->cw_child[0], seq, vdata, vlen);
                     break;
                 default:
                     err = kvset_builder_add_nonval(w->cw_child[0], seq, vtype);
@@ -35,6 +35,7 @@ struct kvset_iter_vctx {
     uint        nvals;
     uint        next;
     bool        is_ptomb;
+    u64         expiry;
 };
 
 struct cn_kv_item {
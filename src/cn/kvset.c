@@ -24,10 +24,12 @@
 #include <hse/kvdb_perfc.h>
 
 #include <hse_ikvdb/tuple.h>
+#include <hse_ikvdb/cn.h>
 #include <hse_ikvdb/cn_kvdb.h>
 #include <hse_ikvdb/ikvdb.h>
 #include <hse_ikvdb/c1.h>
 #include <hse_ikvdb/kvs_rparams.h>
+#include <hse_ikvdb/rtomb.h>
 
 #include "kvs_mblk_desc.h"
 
@@ -249,6 +251,14 @@ kvset_kblk_init(
     if (ev(err))
         return err;
 
+    err = kbr_read_pbm_region_desc(kbd, &p->kb_pbm_desc);
+    if (ev(err))
+        return err;
+
+    err = kbr_read_blm_pages(kbd, p->kb_cn_bloom_lookup, &p->kb_pbm_desc, &p->kb_pbm_pages);
+    if (ev(err))
+        return err;
+
     err = kbr_read_pt_region_desc(kbd, &p->kb_pt_desc);
     if (ev(err))
         return err;
@@ -583,6 +593,15 @@ kvset_create2(
         /* save ptr to last kblock's hlog */
         ks->ks_hlog = hlog;
 
+        /* Range tombstones live only in the last kblock.  Read them
+         * now, before the kblock header becomes inaccessible.
+         */
+        if (i == n_kblks - 1) {
+            err = kbr_read_rtombs(&kblk->kb_kblk_desc, &ks->ks_rtombv, &ks->ks_rtombc);
+            if (ev(err))
+                goto err_exit;
+        }
+
         /* kvset_stats from kblocks */
         ks->ks_st.kst_kalen += props.mpr_alloc_cap;
         ks->ks_st.kst_kwlen += props.mpr_write_len;
@@ -650,6 +669,10 @@ kvset_create2(
     ks->ks_seqno_max = ks->ks_kblks[n_kblks - 1].kb_seqno_max;
     assert(ks->ks_seqno_max >= ks->ks_seqno_min);
 
+    ks->ks_st.kst_exp_vlen = ks->ks_kblks[n_kblks - 1].kb_metrics.exp_vlen;
+    ks->ks_st.kst_exp_min = ks->ks_kblks[n_kblks - 1].kb_metrics.exp_min;
+    ks->ks_st.kst_exp_max = ks->ks_kblks[n_kblks - 1].kb_metrics.exp_max;
+
     /* Initialize kvset key min/max discriminators - only from main wbt
      */
     ks->ks_kdisc_min = ks->ks_kblks[0].kb_kdisc_min;
@@ -1000,6 +1023,7 @@ _kvset_destroy(struct kvset *ks)
         struct kvset_kblk *kblk = ks->ks_kblks + i;
 
         kbr_free_blm_pages(&kblk->kb_kblk_desc, kblk->kb_cn_bloom_lookup, kblk->kb_blm_pages);
+        kbr_free_blm_pages(&kblk->kb_kblk_desc, kblk->kb_cn_bloom_lookup, kblk->kb_pbm_pages);
     }
 
     cleanup_kblocks(ks);
@@ -1008,6 +1032,7 @@ _kvset_destroy(struct kvset *ks)
         cndb_txn_ack_d(ks->ks_cndb, ks->ks_delete_txid, ks->ks_tag, ks->ks_cnid);
 
     free((void *)ks->ks_klarge);
+    free(ks->ks_rtombv);
 
     if (ks->ks_kvset_sz > kvset_cache[0].sz)
         free_aligned(ks);
@@ -1180,6 +1205,44 @@ kvset_kblk_start(struct kvset *ks, const void *key, int len, bool reverse)
     }
 }
 
+bool
+kvset_pfx_filter_miss(struct kvset *ks, const void *pfx, uint pfx_len, u64 pfxhash)
+{
+    struct kvs_ktuple kt;
+    int               rc, i;
+
+    assert(ks->ks_pfx_len > 0 && pfx_len >= ks->ks_pfx_len);
+
+    kt.kt_data = pfx;
+    kt.kt_len = ks->ks_pfx_len;
+    kt.kt_hash = pfxhash;
+
+    /* Range tombstones widen the bounds of the last kblock, so the
+     * prefix may be plausible in more than one kblock.  The kvset can
+     * be skipped only if the prefix misses in all of them.
+     */
+    for (i = 0; i < ks->ks_st.kst_kblks; ++i) {
+        struct kvset_kblk *kblk = ks->ks_kblks + i;
+
+        rc = kblk_plausible(kblk, NULL, pfx, -(int)pfx_len, 0);
+        if (rc > 0)
+            continue;
+        if (rc < 0)
+            break;
+
+        if (kblk->kb_wbt_desc.wbd_n_pages == 0)
+            continue;
+
+        if (!kblk->kb_pbm_pages)
+            return false;
+
+        if (bloom_reader_buffer_lookup(&kblk->kb_pbm_desc, kblk->kb_pbm_pages, &kt))
+            return false;
+    }
+
+    return true;
+}
+
 static merr_t
 kblk_get_value_ref(
     struct kvset *         ks,
@@ -1319,6 +1382,11 @@ search:
     }
 
 done:
+    if (*result == FOUND_VAL && kvs_expired(vref->vr_expiry)) {
+        *result = FOUND_TMB;
+        vref->vr_type = vtype_tomb;
+    }
+
     if (pt_result == FOUND_PTMB) {
         if (*result == NOT_FOUND || pt_vref.vr_seq > vref->vr_seq) {
             *result = pt_result;
@@ -1326,6 +1394,17 @@ done:
         }
     }
 
+    if (ks->ks_rtombc) {
+        u64 rt_seq;
+
+        rt_seq = rtomb_lookup(ks->ks_rtombv, ks->ks_rtombc, kt->kt_data, kt->kt_len, seq);
+        if (rt_seq && (*result == NOT_FOUND || rt_seq > vref->vr_seq)) {
+            *result = FOUND_TMB;
+            vref->vr_type = vtype_tomb;
+            vref->vr_seq = rt_seq;
+        }
+    }
+
     return 0;
 }
 
@@ -1469,7 +1548,12 @@ kvset_lookup_val_direct_decompress(
     return ev(err);
 }
 
-static
+static inline bool
+kvset_lookup_val_isdirect(struct kvset *ks, uint copylen)
+{
+    return copylen >= ks->ks_vmax || (copylen >= ks->ks_vmin && ks->ks_node_level >= ks->ks_vminlvl);
+}
+
 merr_t
 kvset_lookup_val(struct kvset *ks, struct kvs_vtuple_ref *vref, struct kvs_buf *vbuf)
 {
@@ -1480,6 +1564,7 @@ kvset_lookup_val(struct kvset *ks, struct kvs_vtuple_ref *vref, struct kvs_buf *
     bool direct;
 
     assert(vref->vr_type == vtype_ival
+        || vref->vr_type == vtype_mop
         || vref->vr_type == vtype_zval
         || vref->vr_type == vtype_val
         || vref->vr_type == vtype_cval);
@@ -1489,7 +1574,7 @@ kvset_lookup_val(struct kvset *ks, struct kvs_vtuple_ref *vref, struct kvs_buf *
         return 0;
     }
 
-    if (vref->vr_type == vtype_ival)
+    if (vref->vr_type == vtype_ival || vref->vr_type == vtype_mop)
         return kvset_get_immediate_value(vref, vbuf);
 
     vbd = lvx2vbd(ks, vref->vb.vr_index);
@@ -1503,8 +1588,7 @@ kvset_lookup_val(struct kvset *ks, struct kvs_vtuple_ref *vref, struct kvs_buf *
     dst = vbuf->b_buf;
     copylen = min(vref->vb.vr_len, vbuf->b_buf_sz);
 
-    direct = copylen >= ks->ks_vmax
-        || (copylen >= ks->ks_vmin && ks->ks_node_level >= ks->ks_vminlvl);
+    direct = kvset_lookup_val_isdirect(ks, copylen);
 
     if (vref->vb.vr_complen) {
         uint outlen;
@@ -1661,7 +1745,7 @@ get_more:
                 /* can't be  a ptomb, b/c they're in their own WBT */
                 assert(vref.vr_type != vtype_ptomb);
                 vref.vr_seq = vseq;
-                if (vref.vr_type == vtype_tomb)
+                if (vref.vr_type == vtype_tomb || kvs_expired(vref.vr_expiry))
                     *res = FOUND_TMB;
                 else
                     *res = FOUND_VAL;
@@ -1724,6 +1808,8 @@ get_more:
         if (ev(err))
             return err;
 
+        vbuf->b_seq = (vref.vr_type == vtype_mop) ? vref.vr_seq : 0;
+
         /* [HSE_REVISIT] If the caller passes an insufficiently sized
          * buffer, later comparisons against the key (to identify
          * duplicates) will be incorrect.
@@ -1741,6 +1827,17 @@ done:
     return 0;
 }
 
+/* A merge operand is copied out like an immediate value, but the caller
+ * also needs its seqno to look for the older operands it applies to.
+ */
+static merr_t
+kvset_lookup_mop(struct kvs_vtuple_ref *vref, struct kvs_buf *vbuf)
+{
+    vbuf->b_seq = vref->vr_seq;
+
+    return kvset_get_immediate_value(vref, vbuf);
+}
+
 merr_t
 kvset_lookup(
     struct kvset *         ks,
@@ -1757,12 +1854,148 @@ kvset_lookup(
     if (ev(err))
         return err;
 
+    if (*res == FOUND_MOP)
+        return kvset_lookup_mop(&vref, vbuf);
+
     if (*res != FOUND_VAL)
         return 0;
 
+    vbuf->b_expiry = vref.vr_expiry;
+
     return kvset_lookup_val(ks, &vref, vbuf);
 }
 
+merr_t
+kvset_lookup_pin(
+    struct kvset *         ks,
+    struct kvs_ktuple *    kt,
+    const struct key_disc *kdisc,
+    u64                    seq,
+    enum key_lookup_res *  res,
+    struct kvs_buf *       vbuf,
+    struct cn_vpin *       vpin)
+{
+    struct kvs_vtuple_ref vref;
+    struct vblock_desc *  vbd;
+    merr_t                err;
+
+    err = kvset_lookup_vref(ks, kt, kdisc, seq, res, &vref);
+    if (ev(err))
+        return err;
+
+    if (*res == FOUND_MOP)
+        return kvset_lookup_mop(&vref, vbuf);
+
+    if (*res != FOUND_VAL)
+        return 0;
+
+    /* Immediate, zero-length and compressed values have no in-place
+     * representation the caller could use, so copy them out.
+     */
+    if (vref.vr_type != vtype_val)
+        return kvset_lookup_val(ks, &vref, vbuf);
+
+    vbd = lvx2vbd(ks, vref.vb.vr_index);
+    assert(vbd);
+
+    kvset_get_ref(ks);
+
+    vpin->vp_kvset = ks;
+    vpin->vp_data = vbr_value(vbd, vref.vb.vr_off, vref.vb.vr_len);
+    vpin->vp_len = vref.vb.vr_len;
+
+    vbuf->b_len = vref.vb.vr_len;
+
+    return 0;
+}
+
+merr_t
+kvset_lookup_async(
+    struct kvset *         ks,
+    struct kvs_ktuple *    kt,
+    const struct key_disc *kdisc,
+    u64                    seq,
+    enum key_lookup_res *  res,
+    struct kvs_buf *       vbuf,
+    struct cn_aget *       ag)
+{
+    struct kvs_vtuple_ref vref;
+    merr_t                err;
+
+    err = kvset_lookup_vref(ks, kt, kdisc, seq, res, &vref);
+    if (ev(err))
+        return err;
+
+    if (*res == FOUND_MOP)
+        return kvset_lookup_mop(&vref, vbuf);
+
+    if (*res != FOUND_VAL)
+        return 0;
+
+    if (vref.vr_type != vtype_val && vref.vr_type != vtype_cval)
+        return kvset_lookup_val(ks, &vref, vbuf);
+
+    if (!kvset_lookup_val_isdirect(ks, min(vref.vb.vr_len, vbuf->b_buf_sz)))
+        return kvset_lookup_val(ks, &vref, vbuf);
+
+    kvset_get_ref(ks);
+
+    ag->ag_kvset = ks;
+    ag->ag_vref = vref;
+
+    return 0;
+}
+
+void
+kvset_lookup_prefetch(struct kvset *ks, const struct kvs_ktuple *kt, const struct key_disc *kdisc)
+{
+    struct kvset_kblk *kblk;
+    int                i;
+
+    if (key_disc_cmp(kdisc, &ks->ks_kdisc_max) > 0 || key_disc_cmp(kdisc, &ks->ks_kdisc_min) < 0)
+        return;
+
+    /* Only the discriminators are consulted here, so this may prefetch
+     * for kblocks that kvset_lookup() ultimately skips.  That is fine,
+     * the goal is to get the bloom bucket in flight early.
+     */
+    for (i = 0; i < ks->ks_st.kst_kblks; ++i) {
+        kblk = ks->ks_kblks + i;
+
+        if (key_disc_cmp(kdisc, &kblk->kb_kdisc_max) > 0)
+            continue;
+        if (key_disc_cmp(kdisc, &kblk->kb_kdisc_min) < 0)
+            break;
+
+        if (kblk->kb_blm_pages) {
+            const struct bloom_desc *desc = &kblk->kb_blm_desc;
+
+            __builtin_prefetch(kblk->kb_blm_pages + bloom_desc_hash2bkt(desc, kt->kt_hash));
+        } else {
+            __builtin_prefetch(kblk->kb_koff_max);
+        }
+    }
+}
+
+bool
+kvset_get_fences(struct kvset *ks, u64 *lov, u64 *hiv, struct kvset_bloom *blmv)
+{
+    uint last = ks->ks_st.kst_kblks - 1;
+    uint i;
+
+    for (i = 0; i <= last; ++i) {
+        const struct kvset_kblk *kblk = ks->ks_kblks + i;
+
+        lov[i] = kblk->kb_kdisc_min.kdisc[0];
+        hiv[i] = kblk->kb_kdisc_max.kdisc[0];
+
+        blmv[i].kbl_desc = kblk->kb_blm_desc;
+        blmv[i].kbl_pages = kblk->kb_blm_pages;
+    }
+
+    return !ks->ks_rtombc && !ks->ks_kblks[last].kb_pt_desc.wbd_n_pages;
+}
+
 u64
 kvset_get_dgen(struct kvset *ks)
 {
@@ -1809,6 +2042,15 @@ kvset_defer_compc(struct kvset *ks, u64 totkeys)
     return false;
 }
 
+uint
+kvset_get_rtombs(struct kvset *ks, const struct rtomb **rtv)
+{
+    if (ks->ks_rtombc)
+        *rtv = ks->ks_rtombv;
+
+    return ks->ks_rtombc;
+}
+
 u8 *
 kvset_get_hlog(struct kvset *ks)
 {
@@ -1847,6 +2089,14 @@ kvset_stats_add(const struct kvset_stats *add, struct kvset_stats *result)
     result->kst_valen += add->kst_valen;
     result->kst_vwlen += add->kst_vwlen;
     result->kst_vulen += add->kst_vulen;
+
+    if (add->kst_exp_vlen) {
+        if (!result->kst_exp_vlen || add->kst_exp_min < result->kst_exp_min)
+            result->kst_exp_min = add->kst_exp_min;
+        if (add->kst_exp_max > result->kst_exp_max)
+            result->kst_exp_max = add->kst_exp_max;
+        result->kst_exp_vlen += add->kst_exp_vlen;
+    }
 }
 
 u64
@@ -1897,6 +2147,15 @@ kvset_get_nth_kblock_id(struct kvset *ks, u32 index)
     return (index < ks->ks_st.kst_kblks ? ks->ks_kblks[index].kb_kblk.bk_blkid : 0);
 }
 
+void
+kvset_get_nth_kblock_minkey(struct kvset *ks, u32 index, const void **key, uint *klen)
+{
+    struct kvset_kblk *kb = &ks->ks_kblks[index];
+
+    *key = kb->kb_koff_min;
+    *klen = kb->kb_wbt_desc.wbd_n_pages ? kb->kb_klen_min : 0;
+}
+
 u32
 kvset_get_num_vblocks(struct kvset *ks)
 {
@@ -3401,7 +3660,7 @@ kvset_iter_next_vref(
     if (vc->next >= vc->nvals)
         return false;
 
-    kmd_type_seq(vc->kmd, &vc->off, vtype, seq);
+    kmd_type_seq_expiry(vc->kmd, &vc->off, vtype, seq, &vc->expiry);
     switch (*vtype) {
         case vtype_val:
             kmd_val(vc->kmd, &vc->off, vbidx, vboff, vlen);
@@ -3410,6 +3669,7 @@ kvset_iter_next_vref(
             kmd_cval(vc->kmd, &vc->off, vbidx, vboff, vlen, complen);
             break;
         case vtype_ival:
+        case vtype_mop:
             kmd_ival(vc->kmd, &vc->off, vdata, vlen);
             break;
         case vtype_zval:
@@ -3632,6 +3892,7 @@ kvset_iter_next_val(
             *complen = 0;
             return 0;
         case vtype_ival:
+        case vtype_mop:
             assert(*vdata);
             assert(*vlen);
             *complen = 0;
@@ -3729,8 +3990,8 @@ kvset_from_iter(struct kv_iterator *iv)
 void
 kvset_maxkey(struct kvset *ks, const void **maxkey, u16 *maxklen)
 {
-    *maxkey = ks->ks_minkey;
-    *maxklen = ks->ks_minklen;
+    *maxkey = ks->ks_maxkey;
+    *maxklen = ks->ks_maxklen;
 }
 
 void
@@ -28,9 +28,12 @@ struct kvs_buf;
 struct cndb;
 struct workqueue_struct;
 struct mbset;
+struct rtomb;
 struct cn_kvdb;
 struct cn_tree;
 struct cn_merge_stats;
+struct cn_vpin;
+struct cn_aget;
 
 #include "blk_list.h"
 
@@ -272,6 +275,22 @@ kvset_pt_start(struct kvset *kvset);
 int
 kvset_kblk_start(struct kvset *kvset, const void *key, int len, bool reverse);
 
+/**
+ * kvset_pfx_filter_miss() - check the prefix blooms of a kvset
+ * @kvset:   kvset to check
+ * @pfx:     prefix (at least as long as the kvset's tree prefix)
+ * @pfx_len: length of @pfx
+ * @pfxhash: hash of the first kvset->ks_pfx_len bytes of @pfx
+ *
+ * This does not include ptombs, see kvset_pt_start().
+ *
+ * Returns %true if no key with prefix @pfx is in the kvset, %false
+ * if one might be (or if the kvset has no prefix blooms).
+ */
+/* MTF_MOCK */
+bool
+kvset_pfx_filter_miss(struct kvset *kvset, const void *pfx, uint pfx_len, u64 pfxhash);
+
 /**
  * kvset_lookup() - Search a kvset for a key and return its value
  * @kvset:  kvset to search
@@ -292,6 +311,106 @@ kvset_lookup(
     enum key_lookup_res *  res,
     struct kvs_buf *       vbuf);
 
+/**
+ * kvset_lookup_pin() - Look up a key, referencing its value in place
+ * @kvset:  kvset to be searched
+ * @kt:     key to search for
+ * @kdisc:  key discriminator
+ * @seq:    view sequence number
+ * @res:    (output) one of NOT_FOUND, FOUND_VAL, or FOUND_TMB (tombstone)
+ * @vbuf:   (output) value if it cannot be referenced in place
+ * @vpin:   (output) value reference
+ *
+ * Same as kvset_lookup() except that an uncompressed vblock value is
+ * returned via @vpin as a pointer into the vblock map, and a ref is
+ * taken on @kvset on behalf of @vpin.  Caller must hold the kvset
+ * list read lock (see kvset_get_ref()).
+ */
+merr_t
+kvset_lookup_pin(
+    struct kvset *         kvset,
+    struct kvs_ktuple *    kt,
+    const struct key_disc *kdisc,
+    u64                    seq,
+    enum key_lookup_res *  res,
+    struct kvs_buf *       vbuf,
+    struct cn_vpin *       vpin);
+
+/**
+ * kvset_lookup_async() - Look up a key, deferring a direct value read
+ * @kvset:  kvset to be searched
+ * @kt:     key to search for
+ * @kdisc:  key discriminator
+ * @seq:    view sequence number
+ * @res:    (output) one of NOT_FOUND, FOUND_VAL, or FOUND_TMB (tombstone)
+ * @vbuf:   (output) value if it is not to be read directly from media
+ * @ag:     (output) deferred value read
+ *
+ * Same as kvset_lookup() except that a value that would be read directly
+ * from media is not read.  Instead, a ref is taken on @kvset and the
+ * value's location is saved in @ag for a subsequent kvset_lookup_val().
+ * Caller must hold the kvset list read lock (see kvset_get_ref()).
+ */
+merr_t
+kvset_lookup_async(
+    struct kvset *         kvset,
+    struct kvs_ktuple *    kt,
+    const struct key_disc *kdisc,
+    u64                    seq,
+    enum key_lookup_res *  res,
+    struct kvs_buf *       vbuf,
+    struct cn_aget *       ag);
+
+/**
+ * kvset_lookup_val() - Copy out a value
+ * @kvset:  kvset holding the value
+ * @vref:   location of the value within @kvset
+ * @vbuf:   (output) value
+ */
+merr_t
+kvset_lookup_val(struct kvset *kvset, struct kvs_vtuple_ref *vref, struct kvs_buf *vbuf);
+
+/**
+ * kvset_lookup_prefetch() - Prefetch the memory a kvset_lookup() will touch
+ * @kvset:  kvset to be searched
+ * @kt:     key to search for (kt_hash must be valid)
+ * @kdisc:  key discriminator
+ *
+ * Issues prefetches for the kblock descriptors and in-core bloom buckets
+ * that a subsequent kvset_lookup() for @kt is likely to reference.  Used
+ * by batched lookups to overlap memory latency across several keys.
+ */
+void
+kvset_lookup_prefetch(struct kvset *kvset, const struct kvs_ktuple *kt, const struct key_disc *kdisc);
+
+/**
+ * struct kvset_bloom - a kblock's in-core bloom filter
+ * @kbl_desc:  bloom descriptor
+ * @kbl_pages: bloom pages, NULL if the bloom is not resident
+ */
+struct kvset_bloom {
+    struct bloom_desc kbl_desc;
+    const u8 *        kbl_pages;
+};
+
+/**
+ * kvset_get_fences() - Get the lookup fences of a kvset's kblocks
+ * @kvset:  kvset handle
+ * @lov:    (output) first kdisc word of each kblock's smallest key
+ * @hiv:    (output) first kdisc word of each kblock's largest key
+ * @blmv:   (output) in-core bloom filter of each kblock
+ *
+ * Each vector must have room for kvset_get_num_kblocks() entries.  A key
+ * whose first kdisc word falls outside a kblock's fences, or that misses
+ * its bloom, cannot be in that kblock.
+ *
+ * Return: %false if the kvset has prefix or range tombstones, which can
+ * match keys outside all of its kblocks' fences.
+ */
+/* MTF_MOCK */
+bool
+kvset_get_fences(struct kvset *kvset, u64 *lov, u64 *hiv, struct kvset_bloom *blmv);
+
 struct query_ctx;
 
 merr_t
@@ -351,6 +470,17 @@ kvset_set_scatter_pct(struct kvset *self, uint spct);
 u8 *
 kvset_get_hlog(struct kvset *km);
 
+/**
+ * kvset_get_rtombs() - get the range tombstones stored in a kvset
+ * @ks:   kvset handle
+ * @rtv:  (output) vector of range tombstones, valid while @ks is referenced
+ *
+ * Return: number of elements in @rtv.  @rtv is not set if zero.
+ */
+/* MTF_MOCK */
+uint
+kvset_get_rtombs(struct kvset *ks, const struct rtomb **rtv);
+
 /* MTF_MOCK */
 uint
 kvset_get_compc(struct kvset *km);
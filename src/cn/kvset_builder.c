@@ -8,6 +8,7 @@
 #include <hse_ikvdb/key_hash.h>
 #include <hse_ikvdb/limits.h>
 #include <hse_ikvdb/cn.h>
+#include <hse_ikvdb/rtomb.h>
 
 #include <hse/hse_limits.h>
 
@@ -133,6 +134,9 @@ kvset_builder_add_key(struct kvset_builder *self, const struct key_obj *kobj)
     self->key_stats.ntombs = 0;
     self->key_stats.nptombs = 0;
     self->key_stats.tot_vlen = 0;
+    self->key_stats.exp_vlen = 0;
+    self->key_stats.exp_min = 0;
+    self->key_stats.exp_max = 0;
     self->key_stats.seqno_prev = U64_MAX;
     self->key_stats.seqno_prev_ptomb = U64_MAX;
 
@@ -142,8 +146,18 @@ kvset_builder_add_key(struct kvset_builder *self, const struct key_obj *kobj)
     return ev(err);
 }
 
+static void
+kvset_builder_add_expiry(struct kvset_builder *self, u64 expiry, uint omlen)
+{
+    struct kbb_key_stats *ks = &self->key_stats;
+
+    ks->exp_vlen += omlen;
+    ks->exp_min = ks->exp_min ? min_t(u64, ks->exp_min, expiry) : expiry;
+    ks->exp_max = max_t(u64, ks->exp_max, expiry);
+}
+
 /**
- * kvset_builder_add_val() - Add a value or a tombstone to a kvset entry.
+ * kvset_builder_add_val_expiry() - Add a value or a tombstone to a kvset entry.
  * @builder: Kvset builder object.
  * @seq: Sequence number of value or tombstone.
  * @vdata: Pointer to @vlen bytes of uncompressed value data, @complen
@@ -151,6 +165,7 @@ kvset_builder_add_key(struct kvset_builder *self, const struct key_obj *kobj)
  * @vlen: Length of uncompressed value.
  * @complen: Length of compressed value if value is compressed. Must
  *           be set to 0 if value is not compressed.
+ * @expiry: Expiry time of the value, or 0 if none.  Ignored for tombstones.
  *
  * Notes on compression:
  * - If @complen > 0, then the value is already compressed and will be
@@ -166,12 +181,13 @@ kvset_builder_add_key(struct kvset_builder *self, const struct key_obj *kobj)
  *  - Otherwise, a non-zero length value is added.
  */
 merr_t
-kvset_builder_add_val(
+kvset_builder_add_val_expiry(
     struct kvset_builder   *self,
     u64                     seq,
     const void             *vdata,
     uint                    vlen,
-    uint                    complen)
+    uint                    complen,
+    u64                     expiry)
 {
     merr_t           err;
     u64              seqno_prev;
@@ -180,6 +196,9 @@ kvset_builder_add_val(
     if (ev(reserve_kmd(ki)))
         return merr(ENOMEM);
 
+    if (HSE_CORE_IS_TOMB(vdata))
+        expiry = 0;
+
     if (vdata == HSE_CORE_TOMB_REG) {
         kmd_add_tomb(self->main.kmd, &self->main.kmd_used, seq);
         self->key_stats.ntombs++;
@@ -188,12 +207,12 @@ kvset_builder_add_val(
         self->key_stats.nptombs++;
         self->last_ptseq = seq;
     } else if (!vdata || vlen == 0) {
-        kmd_add_zval(self->main.kmd, &self->main.kmd_used, seq);
+        kmd_add_zval(self->main.kmd, &self->main.kmd_used, seq, expiry);
     } else if (complen == 0 && vlen <= CN_SMALL_VALUE_THRESHOLD) {
         /* Do not currently support compressed valus in KMD as an "ival", so
          * complen must be zero.
          */
-        kmd_add_ival(self->main.kmd, &self->main.kmd_used, seq, vdata, vlen);
+        kmd_add_ival(self->main.kmd, &self->main.kmd_used, seq, expiry, vdata, vlen);
         self->key_stats.tot_vlen += vlen;
     } else {
 
@@ -214,15 +233,19 @@ kvset_builder_add_val(
         self->key_stats.c0_vlen += omlen;
 
         if (complen)
-            kmd_add_cval(self->main.kmd, &self->main.kmd_used, seq, vbidx, vboff, vlen, complen);
+            kmd_add_cval(
+                self->main.kmd, &self->main.kmd_used, seq, expiry, vbidx, vboff, vlen, complen);
         else
-            kmd_add_val(self->main.kmd, &self->main.kmd_used, seq, vbidx, vboff, vlen);
+            kmd_add_val(self->main.kmd, &self->main.kmd_used, seq, expiry, vbidx, vboff, vlen);
 
         /* stats (and space amp) use on-media length */
         self->vused += omlen;
         self->key_stats.tot_vlen += omlen;
     }
 
+    if (expiry)
+        kvset_builder_add_expiry(self, expiry, complen ?: vlen);
+
     self->seqno_max = max_t(u64, self->seqno_max, seq);
     self->seqno_min = min_t(u64, self->seqno_min, seq);
 
@@ -243,20 +266,33 @@ kvset_builder_add_val(
     return 0;
 }
 
+merr_t
+kvset_builder_add_val(
+    struct kvset_builder   *self,
+    u64                     seq,
+    const void             *vdata,
+    uint                    vlen,
+    uint                    complen)
+{
+    return kvset_builder_add_val_expiry(self, seq, vdata, vlen, complen, 0);
+}
+
 /**
- * kvset_builder_add_vref() - add a vtype_val or vtype_cval entry its a kvset
+ * kvset_builder_add_vref_expiry() - add a vtype_val or vtype_cval entry its a kvset
  *
  * If @complen > 0, a vtype_cval entry will written to media.
  * If @complen == 0, a vtype_val entry will written to media.
+ * If @expiry > 0, the entry carries it as its expiry time.
  */
 merr_t
-kvset_builder_add_vref(
+kvset_builder_add_vref_expiry(
     struct kvset_builder   *self,
     u64                     seq,
     uint                    vbidx,
     uint                    vboff,
     uint                    vlen,
-    uint                    complen)
+    uint                    complen,
+    u64                     expiry)
 {
     uint om_len = complen ? complen : vlen; /* on-media length */
 
@@ -264,9 +300,13 @@ kvset_builder_add_vref(
         return merr(ev(ENOMEM));
 
     if (complen > 0)
-        kmd_add_cval(self->main.kmd, &self->main.kmd_used, seq, vbidx, vboff, vlen, complen);
+        kmd_add_cval(
+            self->main.kmd, &self->main.kmd_used, seq, expiry, vbidx, vboff, vlen, complen);
     else
-        kmd_add_val(self->main.kmd, &self->main.kmd_used, seq, vbidx, vboff, vlen);
+        kmd_add_val(self->main.kmd, &self->main.kmd_used, seq, expiry, vbidx, vboff, vlen);
+
+    if (expiry)
+        kvset_builder_add_expiry(self, expiry, om_len);
 
     self->vused += om_len;
     self->key_stats.tot_vlen += om_len;
@@ -278,6 +318,38 @@ kvset_builder_add_vref(
     return 0;
 }
 
+merr_t
+kvset_builder_add_vref(
+    struct kvset_builder   *self,
+    u64                     seq,
+    uint                    vbidx,
+    uint                    vboff,
+    uint                    vlen,
+    uint                    complen)
+{
+    return kvset_builder_add_vref_expiry(self, seq, vbidx, vboff, vlen, complen, 0);
+}
+
+merr_t
+kvset_builder_add_mop(struct kvset_builder *self, u64 seq, const void *vdata, uint vlen)
+{
+    if (ev(!vdata || vlen == 0 || vlen > HSE_KVS_MERGE_LEN_MAX))
+        return merr(EINVAL);
+
+    if (reserve_kmd(&self->main))
+        return merr(ev(ENOMEM));
+
+    kmd_add_mop(self->main.kmd, &self->main.kmd_used, seq, vdata, vlen);
+
+    self->key_stats.tot_vlen += vlen;
+    self->key_stats.nvals++;
+
+    self->seqno_max = max_t(u64, self->seqno_max, seq);
+    self->seqno_min = min_t(u64, self->seqno_min, seq);
+
+    return 0;
+}
+
 merr_t
 kvset_builder_add_nonval(struct kvset_builder *self, u64 seq, enum kmd_vtype vtype)
 {
@@ -304,6 +376,21 @@ kvset_builder_add_nonval(struct kvset_builder *self, u64 seq, enum kmd_vtype vty
     return 0;
 }
 
+merr_t
+kvset_builder_add_rtomb(struct kvset_builder *self, const struct rtomb *rt)
+{
+    merr_t err;
+
+    err = kbb_add_rtomb(self->kbb, rt);
+    if (ev(err))
+        return err;
+
+    self->seqno_max = max_t(u64, self->seqno_max, rt->rt_seq);
+    self->seqno_min = min_t(u64, self->seqno_min, rt->rt_seq);
+
+    return 0;
+}
+
 void
 kvset_builder_destroy(struct kvset_builder *bld)
 {
@@ -15,6 +15,8 @@
 
 #include <mpool/mpool.h>
 
+#include <hse/hse_limits.h>
+
 /* [HSE_REVISIT] - why are these includes not </>? */
 
 #include "hse_ikvdb/kvs_cparams.h"
@@ -468,6 +470,17 @@ wbn_leaf_check(
                     }
                     kb_metrics->val_bytes += ivlen;
                     break;
+                case vtype_mop:
+                    kmd_ival(kb_info->kmd, &off, &ival, &ivlen);
+                    if (ivlen > HSE_KVS_MERGE_LEN_MAX) {
+                        err = true;
+                        kmd_err(
+                            kb_info,
+                            "merge operand larger than "
+                            "HSE_KVS_MERGE_LEN_MAX");
+                    }
+                    kb_metrics->val_bytes += ivlen;
+                    break;
                 default:
                     break;
             }
@@ -755,6 +768,7 @@ _kblock_check(struct kb_info *kb_info, struct vb_meta *vb_meta)
 
     wbt_ver = omf_wbt_version(wbt_hdr);
     switch (wbt_ver) {
+        case WBT_TREE_VERSION7:
         case WBT_TREE_VERSION6:
         case WBT_TREE_VERSION5:
             kb_info->wbt_ops.wops_lfe = wbt_lfe;
@@ -800,11 +814,15 @@ _kblock_check(struct kb_info *kb_info, struct vb_meta *vb_meta)
     kb_info->blm_desc.bd_first_page = omf_kbh_blm_doff_pg(kb_hdr);
     kb_info->blm_desc.bd_n_pages = omf_kbh_blm_dlen_pg(kb_hdr);
 
+    kb_info->blm_desc.bd_version = omf_bh_version(blm_hdr);
     kb_info->blm_desc.bd_modulus = omf_bh_modulus(blm_hdr);
     kb_info->blm_desc.bd_bktshift = omf_bh_bktshift(blm_hdr);
     kb_info->blm_desc.bd_n_hashes = omf_bh_n_hashes(blm_hdr);
     kb_info->blm_desc.bd_rotl = omf_bh_rotl(blm_hdr);
     kb_info->blm_desc.bd_bktmask = (1u << kb_info->blm_desc.bd_bktshift) - 1;
+    kb_info->blm_desc.bd_fpbits = omf_bh_fpbits(blm_hdr);
+    kb_info->blm_desc.bd_seed =
+        omf_bh_seed_lo(blm_hdr) | ((u64)omf_bh_seed_hi(blm_hdr) << 32);
 
     kb_info->blm_data = (void *)kb_hdr + pgoff(kb_info->blm_desc.bd_first_page);
 
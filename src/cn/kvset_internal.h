@@ -45,6 +45,8 @@ struct kvset_kblk {
     u16               kb_cn_bloom_lookup;
     struct bloom_desc kb_blm_desc;  /* Bloom descriptor */
     u8 *              kb_blm_pages; /* Bloom pages */
+    struct bloom_desc kb_pbm_desc;  /* prefix Bloom descriptor */
+    u8 *              kb_pbm_pages; /* prefix Bloom pages */
 
     u64 kb_seqno_min; /* min seqno */
     u64 kb_seqno_max; /* max seqno */
@@ -88,6 +90,8 @@ struct kvset {
     int             ks_lcp;       /* longest common prefix */
 
     const u8 *                ks_klarge; /* large key cache */
+    struct rtomb *            ks_rtombv; /* range tombstones */
+    uint                      ks_rtombc; /* number of range tombstones */
     struct mpool_mcache_map **ks_kmapv;
     struct mbset **           ks_vbsetv;
     uint                      ks_vbsetc;
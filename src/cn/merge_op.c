@@ -0,0 +1,242 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2015-2020 Micron Technology, Inc.  All rights reserved.
+ */
+
+#include <hse_util/platform.h>
+#include <hse_util/alloc.h>
+#include <hse_util/event_counter.h>
+#include <hse_util/vlb.h>
+
+#include <hse_ikvdb/merge_op.h>
+#include <hse_ikvdb/kvs_rparams.h>
+
+merr_t
+merge_op_init(struct merge_op *mop, const struct kvs_rparams *rp)
+{
+    static const char *const namev[] = {
+        [MERGE_OP_NONE] = MERGE_OP_PARAM_NONE,
+        [MERGE_OP_ADD] = MERGE_OP_PARAM_ADD,
+        [MERGE_OP_MAX] = MERGE_OP_PARAM_MAX,
+        [MERGE_OP_APPEND] = MERGE_OP_PARAM_APPEND,
+        [MERGE_OP_USER] = MERGE_OP_PARAM_USER,
+    };
+    int i;
+
+    memset(mop, 0, sizeof(*mop));
+
+    /* Use strnlen() to protect against rp->merge_op not being
+     * null terminated.
+     */
+    if (strnlen(rp->merge_op, sizeof(rp->merge_op)) == sizeof(rp->merge_op))
+        return merr(EINVAL);
+
+    for (i = 0; i < NELEM(namev); i++) {
+        if (!strcmp(rp->merge_op, namev[i])) {
+            mop->mo_type = i;
+            return 0;
+        }
+    }
+
+    return merr(EINVAL);
+}
+
+merr_t
+merge_op_valid(const struct merge_op *mop, const void *data, size_t len)
+{
+    switch (mop->mo_type) {
+        case MERGE_OP_ADD:
+        case MERGE_OP_MAX:
+            return len == sizeof(u64) ? 0 : merr(EINVAL);
+
+        case MERGE_OP_APPEND:
+        case MERGE_OP_USER:
+            if (mop->mo_type == MERGE_OP_USER && !mop->mo_fn)
+                break;
+
+            return (len > 0 && len <= HSE_KVS_MERGE_LEN_MAX) ? 0 : merr(EINVAL);
+
+        default:
+            break;
+    }
+
+    return merr(EINVAL);
+}
+
+merr_t
+merge_opv_add(struct merge_opv *vec, u64 seq, const void *data, uint len)
+{
+    struct merge_operand *mop;
+
+    if (ev(len > HSE_KVS_MERGE_LEN_MAX))
+        return merr(EINVAL);
+
+    if (vec->mov_cnt == vec->mov_max) {
+        uint                  max = vec->mov_max ? vec->mov_max * 2 : 8;
+        struct merge_operand *v;
+
+        v = realloc(vec->mov_v, max * sizeof(*v));
+        if (ev(!v))
+            return merr(ENOMEM);
+
+        vec->mov_v = v;
+        vec->mov_max = max;
+    }
+
+    assert(vec->mov_cnt == 0 || vec->mov_v[vec->mov_cnt - 1].mop_seq >= seq);
+
+    mop = vec->mov_v + vec->mov_cnt++;
+    mop->mop_seq = seq;
+    mop->mop_len = len;
+    memcpy(mop->mop_data, data, len);
+
+    return 0;
+}
+
+void
+merge_opv_free(struct merge_opv *vec)
+{
+    free(vec->mov_v);
+
+    vec->mov_v = NULL;
+    vec->mov_cnt = 0;
+    vec->mov_max = 0;
+}
+
+static u64
+merge_op_u64(const void *data, uint len)
+{
+    u64 val;
+
+    if (!data || len != sizeof(val))
+        return 0;
+
+    memcpy(&val, data, sizeof(val));
+
+    return le64_to_cpu(val);
+}
+
+static merr_t
+merge_op_fold_user(
+    const struct merge_op * mop,
+    const void *            key,
+    uint                    klen,
+    const void *            base,
+    uint                    blen,
+    const struct merge_opv *opv,
+    void *                  out,
+    uint *                  outlen)
+{
+    void * scratch = NULL;
+    merr_t err = 0;
+    int    i, rc;
+
+    if (ev(!mop->mo_fn))
+        return merr(EINVAL);
+
+    /* Alternate between the output and a scratch buffer such that
+     * the newest operand is applied into the output buffer.
+     */
+    if (opv->mov_cnt > 1) {
+        scratch = vlb_alloc(HSE_KVS_VLEN_MAX);
+        if (ev(!scratch))
+            return merr(ENOMEM);
+    }
+
+    for (i = opv->mov_cnt - 1; i >= 0; --i) {
+        const struct merge_operand *op = opv->mov_v + i;
+        void *                      dst = (i % 2) ? scratch : out;
+        size_t                      len = 0;
+
+        rc = mop->mo_fn(
+            mop->mo_arg, key, klen, base, blen, op->mop_data, op->mop_len,
+            dst, HSE_KVS_VLEN_MAX, &len);
+        if (ev(rc)) {
+            err = merr(rc);
+            break;
+        }
+
+        if (ev(len > HSE_KVS_VLEN_MAX)) {
+            err = merr(EFBIG);
+            break;
+        }
+
+        base = dst;
+        blen = len;
+    }
+
+    *outlen = blen;
+
+    if (scratch)
+        vlb_free(scratch, HSE_KVS_VLEN_MAX);
+
+    return err;
+}
+
+merr_t
+merge_op_fold(
+    const struct merge_op * mop,
+    const void *            key,
+    uint                    klen,
+    const void *            base,
+    uint                    blen,
+    const struct merge_opv *opv,
+    void *                  out,
+    uint *                  outlen)
+{
+    const struct merge_operand *op;
+    u64                         acc, val;
+    uint                        len;
+    int                         i;
+
+    switch (mop->mo_type) {
+        case MERGE_OP_ADD:
+        case MERGE_OP_MAX:
+            acc = merge_op_u64(base, blen);
+
+            for (i = opv->mov_cnt - 1; i >= 0; --i) {
+                op = opv->mov_v + i;
+                val = merge_op_u64(op->mop_data, op->mop_len);
+
+                if (mop->mo_type == MERGE_OP_ADD)
+                    acc += val; /* two's complement, same as signed */
+                else if (val > acc)
+                    acc = val;
+            }
+
+            acc = cpu_to_le64(acc);
+            memcpy(out, &acc, sizeof(acc));
+            *outlen = sizeof(acc);
+            return 0;
+
+        case MERGE_OP_APPEND:
+            len = base ? blen : 0;
+
+            for (i = opv->mov_cnt - 1; i >= 0; --i)
+                len += opv->mov_v[i].mop_len;
+
+            if (ev(len > HSE_KVS_VLEN_MAX))
+                return merr(EFBIG);
+
+            len = base ? blen : 0;
+            if (len > 0)
+                memcpy(out, base, len);
+
+            for (i = opv->mov_cnt - 1; i >= 0; --i) {
+                op = opv->mov_v + i;
+                memcpy(out + len, op->mop_data, op->mop_len);
+                len += op->mop_len;
+            }
+
+            *outlen = len;
+            return 0;
+
+        case MERGE_OP_USER:
+            return merge_op_fold_user(mop, key, klen, base, blen, opv, out, outlen);
+
+        default:
+            break;
+    }
+
+    return merr(ev(EINVAL));
+}
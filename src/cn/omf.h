@@ -14,7 +14,7 @@
  *
  ****************************************************************/
 
-#define KBLOCK_HDR_VERSION ((u32)5)
+#define KBLOCK_HDR_VERSION ((u32)8)
 #define KBLOCK_HDR_MAGIC ((u32)0xfadedfad)
 
 /* This is currently set to 1350 which is the max key size supported. However,
@@ -24,6 +24,9 @@
 #define HSE_KBLOCK_OMF_KLEN_MAX ((u32)1350)
 
 /* older versions that are still supported */
+#define KBLOCK_HDR_VERSION7 ((u32)7)
+#define KBLOCK_HDR_VERSION6 ((u32)6)
+#define KBLOCK_HDR_VERSION5 ((u32)5)
 #define KBLOCK_HDR_VERSION4 ((u32)4)
 #define KBLOCK_HDR_VERSION3 ((u32)3)
 #define KBLOCK_HDR_VERSION2 ((u32)2)
@@ -72,6 +75,23 @@ struct kblock_hdr_omf {
     __le64 kbh_min_seqno;
     __le64 kbh_max_seqno;
 
+    /* range tombstones (version 6 and later) */
+    __le32 kbh_rt_doff_pg;
+    __le32 kbh_rt_dlen_pg;
+    __le32 kbh_rt_cnt;
+    __le32 kbh_rt_len;
+
+    /* values with an expiry time (version 7 and later) */
+    __le64 kbh_exp_vlen;
+    __le64 kbh_exp_min;
+    __le64 kbh_exp_max;
+
+    /* prefix bloom header and data (version 8 and later) */
+    __le32 kbh_pbm_hoff;
+    __le32 kbh_pbm_hlen;
+    __le32 kbh_pbm_doff_pg;
+    __le32 kbh_pbm_dlen_pg;
+
 } __packed;
 
 /* Define set/get methods for kblock_hdr_omf */
@@ -107,14 +127,73 @@ OMF_SETGET(struct kblock_hdr_omf, kbh_pt_dlen_pg, 32)
 OMF_SETGET(struct kblock_hdr_omf, kbh_min_seqno, 64)
 OMF_SETGET(struct kblock_hdr_omf, kbh_max_seqno, 64)
 
+OMF_SETGET(struct kblock_hdr_omf, kbh_rt_doff_pg, 32)
+OMF_SETGET(struct kblock_hdr_omf, kbh_rt_dlen_pg, 32)
+OMF_SETGET(struct kblock_hdr_omf, kbh_rt_cnt, 32)
+OMF_SETGET(struct kblock_hdr_omf, kbh_rt_len, 32)
+
+OMF_SETGET(struct kblock_hdr_omf, kbh_exp_vlen, 64)
+OMF_SETGET(struct kblock_hdr_omf, kbh_exp_min, 64)
+OMF_SETGET(struct kblock_hdr_omf, kbh_exp_max, 64)
+
+OMF_SETGET(struct kblock_hdr_omf, kbh_pbm_hoff, 32)
+OMF_SETGET(struct kblock_hdr_omf, kbh_pbm_hlen, 32)
+OMF_SETGET(struct kblock_hdr_omf, kbh_pbm_doff_pg, 32)
+OMF_SETGET(struct kblock_hdr_omf, kbh_pbm_dlen_pg, 32)
+
+/*****************************************************************
+ *
+ * Range tombstone OMF (part of the kblock)
+ *
+ ****************************************************************/
+
+/**
+ * struct rtomb_omf - range tombstone
+ * @rto_seq:   seqno of the range delete
+ * @rto_slen:  length of the start key
+ * @rto_elen:  length of the end key
+ *
+ * Each record is immediately followed by the start key and then the
+ * end key.  Records are packed back-to-back in the rtomb region.
+ */
+struct rtomb_omf {
+    __le64 rto_seq;
+    __le16 rto_slen;
+    __le16 rto_elen;
+} __packed;
+
+OMF_SETGET(struct rtomb_omf, rto_seq, 64)
+OMF_SETGET(struct rtomb_omf, rto_slen, 16)
+OMF_SETGET(struct rtomb_omf, rto_elen, 16)
+
 /*****************************************************************
  *
  * Bloom filter header OMF (part of the kblock)
  *
+ * Version 8 kblocks may carry a second (prefix) bloom, keyed on
+ * pfx_hash64() of each distinct key prefix of the kvs pfx_len, with
+ * a header of the same format.
+ *
+ * OMF v6: Binary fuse filter (see fuse_filter.h) with @bh_fpbits bit
+ *         fingerprints, seeded by @bh_seed_lo/@bh_seed_hi.  @bh_modulus
+ *         is the segment count length, @bh_bktshift is log2 of the
+ *         segment length, and @bh_n_hashes is FUSE_ARITY.  v5 and v6
+ *         may coexist in one kvset.
+ *
+ * OMF v5: Split block bloom.  Each key sets one bit in each of the eight
+ *         32-bit words of a 256-bit bucket, @bh_modulus is the number
+ *         of buckets, and @bh_rotl is unused (see BF_SB_BKTSHIFT).
+ *
+ * OMF v4: Block bloom with BF_BKTSHIFT bits per bucket, probed by
+ *         iterative rotation of the hash.
+ *
  ****************************************************************/
 
 #define BLOOM_OMF_MAGIC ((u32)('b' << 24 | 'l' << 16 | 'm' << 8 | 'h'))
-#define BLOOM_OMF_VERSION ((u32)4)
+#define BLOOM_OMF_VERSION BLOOM_OMF_VERSION6
+#define BLOOM_OMF_VERSION6 ((u32)6)
+#define BLOOM_OMF_VERSION5 ((u32)5)
+#define BLOOM_OMF_VERSION4 ((u32)4)
 
 /**
  * struct bloom_hdr_omf -
@@ -125,6 +204,9 @@ OMF_SETGET(struct kblock_hdr_omf, kbh_max_seqno, 64)
  * @bh_n_hashes:        number of hashes per bucket
  * @bh_bitmapsz:        size of bitmap in bytes
  * @bh_modulus:         modulus used to convert first hash to bucket
+ * @bh_fpbits:          bits per fingerprint (v6)
+ * @bh_seed_lo:         low 32 bits of the filter seed (v6)
+ * @bh_seed_hi:         high 32 bits of the filter seed (v6)
  */
 struct bloom_hdr_omf {
     __le32 bh_magic;
@@ -132,11 +214,11 @@ struct bloom_hdr_omf {
     __le32 bh_bitmapsz;
     __le32 bh_modulus;
     __le32 bh_bktshift;
-    __le16 bh_rsvd1;
+    __le16 bh_fpbits;
     u8     bh_rotl;
     u8     bh_n_hashes;
-    __le32 bh_rsvd2;
-    __le32 bh_rsvd3;
+    __le32 bh_seed_lo;
+    __le32 bh_seed_hi;
 } __packed;
 
 /* Define set/get methods for bloom_hdr_omf */
@@ -147,11 +229,19 @@ OMF_SETGET(struct bloom_hdr_omf, bh_modulus, 32)
 OMF_SETGET(struct bloom_hdr_omf, bh_bktshift, 32)
 OMF_SETGET(struct bloom_hdr_omf, bh_rotl, 8)
 OMF_SETGET(struct bloom_hdr_omf, bh_n_hashes, 8)
+OMF_SETGET(struct bloom_hdr_omf, bh_fpbits, 16)
+OMF_SETGET(struct bloom_hdr_omf, bh_seed_lo, 32)
+OMF_SETGET(struct bloom_hdr_omf, bh_seed_hi, 32)
 
 /*****************************************************************
  *
  * Wanna B-Tree (WBT) On-Media-Format
  *
+ * OMF v7: Added an optional hash index to leaf nodes for point lookups.
+ *         The index is an open addressing table of (fingerprint, entry)
+ *         pairs right after the node's LFEs.  Nodes without an index,
+ *         including all v5 and v6 nodes, have wbn_hidx_nbkts == 0.
+ *
  * OMF v6: Added support for compressed values. Uses a new value type
  *         (vtype_cval) which affects KMD format. Unfortunately,
  *         there is no version field for KMD, so we bump the WBTree
@@ -167,14 +257,15 @@ OMF_SETGET(struct bloom_hdr_omf, bh_n_hashes, 8)
 #define WBT_NODE_SIZE 4096 /* must equal system page size */
 
 #define WBT_TREE_MAGIC ((u32)0x4a3a2a1a)
-#define WBT_TREE_VERSION  WBT_TREE_VERSION6
+#define WBT_TREE_VERSION  WBT_TREE_VERSION7
+#define WBT_TREE_VERSION7 ((u32)7)
 #define WBT_TREE_VERSION6 ((u32)6)
 #define WBT_TREE_VERSION5 ((u32)5)
 #define WBT_TREE_VERSION4 ((u32)4)
 #define WBT_TREE_VERSION3 ((u32)3)
 #define WBT_TREE_VERSION2 ((u32)2)
 
-/* WBT header (OMF v4-v6) */
+/* WBT header (OMF v4-v7) */
 struct wbt_hdr_omf {
     __le32 wbt_magic;
     __le32 wbt_version;
@@ -202,19 +293,20 @@ wbt_hdr_version(void *omf)
 #define WBT_LFE_NODE_MAGIC ((u16)0xabc0)
 #define WBT_INE_NODE_MAGIC ((u16)0xabc1)
 
-/* WBT node header (OMF v5-v6) */
+/* WBT node header (OMF v5-v7) */
 struct wbt_node_hdr_omf {
-    __le16 wbn_magic;    /* magic number, distinguishes INEs from LFEs */
-    __le16 wbn_num_keys; /* number of keys in node */
-    __le32 wbn_kmd;      /* offset in kmd region to this node's kmd */
-    __le16 wbn_pfx_len;  /* length of the longest common prefix */
-    __le16 wbn_padding;  /* unused padding */
+    __le16 wbn_magic;      /* magic number, distinguishes INEs from LFEs */
+    __le16 wbn_num_keys;   /* number of keys in node */
+    __le32 wbn_kmd;        /* offset in kmd region to this node's kmd */
+    __le16 wbn_pfx_len;    /* length of the longest common prefix */
+    __le16 wbn_hidx_nbkts; /* leaf hash index buckets (v7), zero if none */
 } __packed;
 
 OMF_SETGET(struct wbt_node_hdr_omf, wbn_magic, 16)
 OMF_SETGET(struct wbt_node_hdr_omf, wbn_num_keys, 16)
 OMF_SETGET(struct wbt_node_hdr_omf, wbn_kmd, 32)
 OMF_SETGET(struct wbt_node_hdr_omf, wbn_pfx_len, 16)
+OMF_SETGET(struct wbt_node_hdr_omf, wbn_hidx_nbkts, 16)
 
 /* WBT node header (OMF v4) */
 struct wbt4_node_hdr_omf {
@@ -227,7 +319,7 @@ OMF_SETGET(struct wbt4_node_hdr_omf, wbn4_magic, 16)
 OMF_SETGET(struct wbt4_node_hdr_omf, wbn4_num_keys, 16)
 OMF_SETGET(struct wbt4_node_hdr_omf, wbn4_kmd, 32)
 
-/* WBT internal node entry (OMF v4-v6) */
+/* WBT internal node entry (OMF v4-v7) */
 struct wbt_ine_omf {
     __le16 ine_koff;       /* byte offset from start of node to key */
     __le16 ine_left_child; /* node number of left child */
@@ -236,7 +328,7 @@ struct wbt_ine_omf {
 OMF_SETGET(struct wbt_ine_omf, ine_koff, 16)
 OMF_SETGET(struct wbt_ine_omf, ine_left_child, 16)
 
-/* WBT leaf node entry (OMF v4-v6)
+/* WBT leaf node entry (OMF v4-v7)
  * Note, if lfe_kmd == U16_MAX, then the actual kmd offset is stored as a LE32
  * value at lfe_koff, and the actual key is stored at lfe_koff + 4.
  */
@@ -248,6 +340,20 @@ struct wbt_lfe_omf {
 OMF_SETGET(struct wbt_lfe_omf, lfe_koff, 16)
 OMF_SETGET(struct wbt_lfe_omf, lfe_kmd, 16)
 
+/* WBT leaf hash index bucket (OMF v7)
+ * Holds the fingerprint of a key's suffix hash and the key's entry number,
+ * or WBT_HIDX_EMPTY if the bucket is unused.
+ */
+#define WBT_HIDX_EMPTY ((u8)0xff)
+
+struct wbt_hidx_omf {
+    u8 hix_fp;
+    u8 hix_idx;
+} __packed;
+
+OMF_SETGET(struct wbt_hidx_omf, hix_fp, 8)
+OMF_SETGET(struct wbt_hidx_omf, hix_idx, 8)
+
 /******** WB tree Version 3 ********/
 
 BullseyeCoverageSaveOff
@@ -10,6 +10,9 @@
 #include <hse_util/hse_err.h>
 #include <hse_util/inttypes.h>
 #include <hse_util/darray.h>
+
+#include <hse_ikvdb/rtomb.h>
+
 #include "cn_metrics.h"
 
 struct cursor_summary;
@@ -28,6 +31,8 @@ struct cursor_summary;
  * @pfx_len:     length of the prefix
  * @ct_pfx_len:  length of the tree prefix
  * @pfxhash:    hash for this prefix
+ * @pfx_check:  kvsets checked against their prefix blooms by the last tree walk
+ * @pfx_skip:   kvsets skipped by their prefix blooms by the last tree walk
  * @merr:       if cursor is in error state, this is why
  * @shift:      how to find next child node from pfxhash
  * @mask:
@@ -41,6 +46,7 @@ struct cursor_summary;
  * @pt_set:     if the ptomb in pt_kobj, if there is one, is relevant.
  * @pt_kobj:    ptomb key obj (key in kblk OR pt_buf[] right after cur update)
  * @pt_seq:     ptomb's seqno
+ * @rtombs:     range tombstones visible to this cursor
  */
 struct pscan {
     struct bin_heap2 *      bh;
@@ -54,6 +60,8 @@ struct pscan {
     u32                     pfx_len;
     u32                     ct_pfx_len;
     u64                     pfxhash;
+    u32                     pfx_check;
+    u32                     pfx_skip;
     u64                     merr;
     u32                     shift;
     u32                     mask;
@@ -70,6 +78,8 @@ struct pscan {
     u64            pt_seq;
     unsigned char  pt_buf[HSE_KVS_MAX_PFXLEN];
 
+    struct rtomb_vec rtombs;
+
     struct cn_merge_stats stats;
     struct kc_filter *    filter;
     void *                base;
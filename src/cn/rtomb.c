@@ -0,0 +1,64 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2015-2020 Micron Technology, Inc.  All rights reserved.
+ */
+
+#include <hse_util/platform.h>
+#include <hse_util/alloc.h>
+#include <hse_util/event_counter.h>
+
+#include <hse_ikvdb/rtomb.h>
+
+merr_t
+rtomb_vec_add(struct rtomb_vec *vec, const struct rtomb *rt)
+{
+    struct rtomb *dst;
+    char *        keys;
+
+    if (vec->rtv_cnt == vec->rtv_max) {
+        uint          max = vec->rtv_max ? vec->rtv_max * 2 : 8;
+        struct rtomb *v;
+
+        v = realloc(vec->rtv_v, max * sizeof(*v));
+        if (ev(!v))
+            return merr(ENOMEM);
+
+        vec->rtv_v = v;
+        vec->rtv_max = max;
+    }
+
+    keys = malloc(rt->rt_slen + rt->rt_elen);
+    if (ev(!keys))
+        return merr(ENOMEM);
+
+    memcpy(keys, rt->rt_start, rt->rt_slen);
+    memcpy(keys + rt->rt_slen, rt->rt_end, rt->rt_elen);
+
+    dst = vec->rtv_v + vec->rtv_cnt++;
+    *dst = *rt;
+    dst->rt_start = keys;
+    dst->rt_end = keys + rt->rt_slen;
+
+    return 0;
+}
+
+void
+rtomb_vec_reset(struct rtomb_vec *vec)
+{
+    uint i;
+
+    for (i = 0; i < vec->rtv_cnt; i++)
+        free((void *)vec->rtv_v[i].rt_start);
+
+    vec->rtv_cnt = 0;
+}
+
+void
+rtomb_vec_free(struct rtomb_vec *vec)
+{
+    rtomb_vec_reset(vec);
+    free(vec->rtv_v);
+
+    vec->rtv_v = NULL;
+    vec->rtv_max = 0;
+}
@@ -6,6 +6,7 @@
 #include <hse_util/platform.h>
 #include <hse_util/event_counter.h>
 #include <hse_util/slab.h>
+#include <hse_util/vlb.h>
 
 #include <hse_ikvdb/kvs_cparams.h>
 #include <hse_ikvdb/kvs_rparams.h>
@@ -13,6 +14,7 @@
 #include <hse_ikvdb/tuple.h>
 #include <hse_ikvdb/kvset_builder.h>
 #include <hse_ikvdb/kvdb_perfc.h>
+#include <hse_ikvdb/merge_op.h>
 
 /* [HSE_REVISIT] - Why is this at the top of this file? */
 
@@ -177,6 +179,74 @@ kv_spill_abort(struct cn_tstate_omf *omf, void *arg)
 {
 }
 
+/**
+ * spill_mop_flush() - emit the merge operands collected below the horizon
+ * @w:       compaction work
+ * @child:   output kvset builder
+ * @kobj:    key to which the operands belong
+ * @opv:     operands, newest first (reset on return)
+ * @base:    value to which the oldest operand applies, or NULL if none
+ * @blen:    length of @base
+ * @fold:    if false, emit the operands as they are
+ * @bufp:    fold output buffer, allocated on first use
+ * @folded:  (output) true if the operands were folded into one value
+ *
+ * No view older than the horizon can see the individual operands, so they
+ * may be replaced by a single value at the seqno of the newest operand.
+ * If folding fails the operands are carried forward unchanged and will be
+ * resolved by the reader (or by a later spill).
+ */
+static merr_t
+spill_mop_flush(
+    struct cn_compaction_work *w,
+    struct kvset_builder *     child,
+    const struct key_obj *     kobj,
+    struct merge_opv *         opv,
+    const void *               base,
+    uint                       blen,
+    bool                       fold,
+    void **                    bufp,
+    bool *                     folded)
+{
+    char   kbuf[HSE_KVS_KLEN_MAX];
+    uint   klen, outlen, i;
+    merr_t err;
+
+    *folded = false;
+
+    if (fold && !*bufp) {
+        *bufp = vlb_alloc(HSE_KVS_VLEN_MAX);
+        fold = (*bufp != NULL);
+    }
+
+    if (fold) {
+        const void *kdata = key_obj_copy(kbuf, sizeof(kbuf), &klen, kobj);
+
+        err = merge_op_fold(w->cw_mop, kdata, klen, base, blen, opv, *bufp, &outlen);
+        if (!ev(err)) {
+            err = kvset_builder_add_val(child, opv->mov_v[0].mop_seq, *bufp, outlen, 0);
+            w->cw_stats.ms_val_bytes_out += outlen;
+            merge_opv_reset(opv);
+            *folded = true;
+            return err;
+        }
+    }
+
+    for (i = 0; i < opv->mov_cnt; i++) {
+        const struct merge_operand *op = opv->mov_v + i;
+
+        err = kvset_builder_add_mop(child, op->mop_seq, op->mop_data, op->mop_len);
+        if (ev(err))
+            return err;
+
+        w->cw_stats.ms_val_bytes_out += op->mop_len;
+    }
+
+    merge_opv_reset(opv);
+
+    return 0;
+}
+
 /**
  * kv_spill() - merge key-value streams, then partition by child
  * Requirements:
@@ -200,6 +270,10 @@ kv_spill(struct cn_compaction_work *w)
     void *buf = NULL;
     u32   bufsz = 0;
 
+    struct merge_opv mopv = { 0 };
+    void *           mbuf = NULL;
+    bool             mfold, folded;
+
     struct cn_khashmap *khashmap = NULL;
 
     bool emitted_val, bg_val, more;
@@ -216,6 +290,11 @@ kv_spill(struct cn_compaction_work *w)
     u64            pt_seq = 0;
     u32            pt_spread; /* mask: which children get ptomb */
 
+    char kbuf[HSE_KVS_KLEN_MAX];
+    uint klen, rtx;
+    u64  rt_seq = 0;
+    u64  expiry_now = kvs_expiry_now();
+
     uint   seqno_errcnt = 0;
     size_t hashlen, cn_sfx_len;
     uint   direct_read_len;
@@ -234,6 +313,21 @@ kv_spill(struct cn_compaction_work *w)
     if (ev(err))
         return err;
 
+    /* A range tombstone may cover keys in any child, so pass it on
+     * to every child that cannot drop it.
+     */
+    for (rtx = 0; rtx < w->cw_rtombs.rtv_cnt * w->cw_outc; rtx++) {
+        const struct rtomb *rt = w->cw_rtombs.rtv_v + rtx / w->cw_outc;
+        uint                c = rtx % w->cw_outc;
+
+        if (w->cw_drop_tombv[c] && rt->rt_seq <= w->cw_horizon)
+            continue;
+
+        err = kvset_builder_add_rtomb(w->cw_child[c], rt);
+        if (ev(err))
+            goto done;
+    }
+
     more = get_next_item(bh, w->cw_inputv, &curr, &w->cw_stats, &err);
     if (!more || ev(err))
         goto done;
@@ -254,6 +348,8 @@ kv_spill(struct cn_compaction_work *w)
 
     tstart = perfc_ison(w->cw_pc, PERFC_DI_CNCOMP_VGET) ? 1 : 0;
 
+    mfold = w->cw_mop && w->cw_mop->mo_type != MERGE_OP_NONE;
+
 new_key:
     pt_spread = 0;
     childmask = 0;
@@ -320,6 +416,12 @@ new_key:
     dbg_nvals_this_key = 0;
     dbg_dup = false;
 
+    if (w->cw_rtombs.rtv_cnt) {
+        const void *kdata = key_obj_copy(kbuf, sizeof(kbuf), &klen, &curr.kobj);
+
+        rt_seq = rtomb_vec_lookup(&w->cw_rtombs, kdata, klen, w->cw_horizon);
+    }
+
 get_values:
 
     while (!bg_val) {
@@ -338,6 +440,14 @@ get_values:
                 &vdata, &vlen, &complen))
             break;
 
+        /* An expired value is spilled as the tomb it has become,
+         * which also saves reading it.
+         */
+        if (kvs_expired_at(curr.vctx.expiry, expiry_now)) {
+            vtype = vtype_tomb;
+            vlen = complen = 0;
+        }
+
         if (vtype == vtype_val)
             omlen = vlen;
         else if (vtype == vtype_cval)
@@ -426,8 +536,16 @@ get_values:
         bg_val = (seq <= w->cw_horizon);
 
         if (bg_val) {
-            if (pt_set && seq < pt_seq)
-                break; /* drop val */
+            if ((pt_set && seq < pt_seq) || seq < rt_seq) {
+                /* drop val, hidden by a prefix or range tombstone */
+                if (mopv.mov_cnt) {
+                    err = spill_mop_flush(
+                        w, child, &curr.kobj, &mopv, NULL, 0, true, &mbuf, &folded);
+                    if (ev(err))
+                        goto done;
+                }
+                break;
+            }
 
             if (HSE_CORE_IS_PTOMB(vdata)) {
                 pt_set = true;
@@ -443,6 +561,39 @@ get_values:
 
         should_emit = should_emit || !emitted_val;
 
+        if (bg_val && vtype == vtype_mop) {
+            /* Keep going to find the value to which the operand
+             * applies, collecting the operands to fold into it.
+             */
+            bg_val = false;
+
+            if (should_emit && mfold) {
+                err = merge_opv_add(&mopv, seq, vdata, vlen);
+                if (ev(err))
+                    goto done;
+
+                emitted_val = true;
+                emitted_seq = seq;
+                childmask |= (1 << cnum);
+                continue;
+            }
+        } else if (bg_val && should_emit && mopv.mov_cnt) {
+            bool isval = !HSE_CORE_IS_TOMB(vdata) && !HSE_CORE_IS_PTOMB(vdata);
+
+            /* A tombstone (or no value) is the base for the operands.
+             * Compressed values, and values that will expire, are
+             * left to the reader to fold.
+             */
+            err = spill_mop_flush(
+                w, child, &curr.kobj, &mopv, isval ? vdata : NULL, isval ? vlen : 0,
+                !complen && !curr.vctx.expiry, &mbuf, &folded);
+            if (ev(err))
+                goto done;
+
+            if (folded && !HSE_CORE_IS_PTOMB(vdata))
+                break;
+        }
+
         /* Compare seq to emitted_seq to ensure when a key has values
          * in two kvsets with the same sequence number, that only the
          * value from the first kvset is emitted.
@@ -470,7 +621,11 @@ get_values:
                 if (w->cw_drop_tombv[cnum] && HSE_CORE_IS_TOMB(vdata) && bg_val)
                     continue; /* skip value */
 
-                err = kvset_builder_add_val(child, seq, vdata, vlen, complen);
+                if (vtype == vtype_mop)
+                    err = kvset_builder_add_mop(child, seq, vdata, vlen);
+                else
+                    err = kvset_builder_add_val_expiry(
+                        child, seq, vdata, vlen, complen, curr.vctx.expiry);
                 if (ev(err))
                     goto done;
 
@@ -534,6 +689,16 @@ get_values:
         }
     }
 
+    /* The operands apply to no value in the input kvsets, which is
+     * their base only if there are no older kvsets in the child.
+     */
+    if (mopv.mov_cnt) {
+        err = spill_mop_flush(
+            w, child, &prev_kobj, &mopv, NULL, 0, w->cw_drop_tombv[cnum], &mbuf, &folded);
+        if (ev(err))
+            goto done;
+    }
+
     if (emitted_val) {
         if (pt_spread) {
             int i;
@@ -567,6 +732,8 @@ get_values:
 done:
     bin_heap_destroy(bh);
     free_aligned(buf);
+    merge_opv_free(&mopv);
+    vlb_free(mbuf, HSE_KVS_VLEN_MAX);
 
     /* We must ensure the latest version of the key hash map is persisted
      * if it changed while we were using it (regardless of who changed it,
@@ -0,0 +1,272 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2015-2020 Micron Technology, Inc.  All rights reserved.
+ */
+
+/*
+ * Compare false positive rate and lookup throughput of the kblock bloom
+ * filter formats (v4 block bloom vs v5 split block bloom, with and without
+ * the vector lookup, vs v6 fuse filter) across the range of cn_bloom_prob
+ * settings.
+ */
+
+#include <hse_util/platform.h>
+#include <hse_util/alloc.h>
+#include <hse_util/slab.h>
+#include <hse_util/page.h>
+#include <hse_util/timing.h>
+#include <hse_util/bloom_filter.h>
+#include <hse_util/fuse_filter.h>
+#include <hse_test_support/mwc_rand.h>
+
+#include <getopt.h>
+
+#ifdef NDEBUG
+const unsigned long keyc_default = 4ULL * 1024 * 1024;
+#else
+const unsigned long keyc_default = 256ULL * 1024;
+#endif
+
+const u32 probv[] = { 1000, 5000, 10000, 50000, 100000 };
+
+u64 * hashv;
+u64 * missv;
+ulong keyc;
+u32   seed;
+
+enum bloom_fmt { fmt_v4, fmt_v5, fmt_v5_scalar, fmt_v6 };
+
+struct fuse_filter ff;
+
+static const char *
+fmt_name(enum bloom_fmt fmt)
+{
+    switch (fmt) {
+        case fmt_v4:
+            return "v4";
+        case fmt_v5:
+            return "v5";
+        case fmt_v5_scalar:
+            return "v5-scalar";
+        case fmt_v6:
+            return "v6";
+    }
+    return "unknown";
+}
+
+static __always_inline bool
+lookup(enum bloom_fmt fmt, const struct bloom_filter *bf, u64 hash)
+{
+    const u8 *bitmap = bf->bf_bitmap;
+
+    switch (fmt) {
+        case fmt_v4:
+            bitmap += bf_hash2bkt(hash, bf->bf_modulus, bf->bf_bktshift);
+            return bf_lookup(hash, bitmap, bf->bf_n_hashes, bf->bf_rotl, bf->bf_bktmask);
+
+        case fmt_v5:
+            return bf_sb_lookup(hash, bitmap + bf_sb_hash2bkt(hash, bf->bf_modulus));
+
+        case fmt_v5_scalar:
+            return bf_sb_lookup_portable(hash, bitmap + bf_sb_hash2bkt(hash, bf->bf_modulus));
+
+        case fmt_v6:
+            return fuse_lookup(hash, ff.ff_fpv, ff.ff_seed, ff.ff_segcntlen, ff.ff_seglen, ff.ff_fpbits);
+    }
+
+    return true;
+}
+
+static void
+report(
+    enum bloom_fmt         fmt,
+    u32                    prob,
+    struct bf_bithash_desc desc,
+    size_t                 sz,
+    ulong                  fpc,
+    u64                    hit_ns,
+    u64                    miss_ns)
+{
+    uint hashes = BF_SB_WORDS;
+    static int header;
+
+    if (!header) {
+        header = 1;
+        printf("\n# Bloom lookup performance (%lu keys)\n", keyc);
+        printf(
+            "%-10s  %8s  %5s  %6s  %8s  %8s  %8s\n",
+            "Format",
+            "Prob%",
+            "Bits",
+            "Hashes",
+            "FP%",
+            "Hit ns",
+            "Miss ns");
+        printf(
+            "%-10s  %8s  %5s  %6s  %8s  %8s  %8s\n",
+            "----------",
+            "--------",
+            "-----",
+            "------",
+            "--------",
+            "--------",
+            "--------");
+    }
+
+    if (fmt == fmt_v4)
+        hashes = desc.bhd_num_hashes;
+    else if (fmt == fmt_v6)
+        hashes = FUSE_ARITY;
+
+    printf(
+        "%-10s  %8.4f  %5.1f  %6u  %8.4f  %8.2f  %8.2f\n",
+        fmt_name(fmt),
+        prob / 10000.0,
+        (sz * 8.0) / keyc,
+        hashes,
+        (fpc * 100.0) / keyc,
+        (double)hit_ns / keyc,
+        (double)miss_ns / keyc);
+}
+
+static int
+test(enum bloom_fmt fmt, u32 prob)
+{
+    struct bf_bithash_desc desc;
+    struct bloom_filter    bf;
+    u64                    start, hit_ns, miss_ns;
+    ulong                  i, hitc, fpc;
+    size_t                 sz;
+    u8 *                   bitmap;
+
+    desc = bf_compute_bithash_est(prob);
+    if (fmt == fmt_v6)
+        sz = ALIGN(fuse_size_estimate(keyc, fuse_fpbits_est(prob)), PAGE_SIZE);
+    else
+        sz = ALIGN(bf_size_estimate(desc, keyc), PAGE_SIZE);
+
+    bitmap = alloc_page_aligned(sz, GFP_KERNEL);
+    if (!bitmap)
+        return -1;
+
+    memset(bitmap, 0, sz);
+
+    if (fmt == fmt_v6) {
+        u64 *tmpv = malloc(keyc * sizeof(*tmpv));
+
+        /* The build may reorder its input. */
+        if (!tmpv || fuse_filter_init(&ff, keyc, fuse_fpbits_est(prob), bitmap, sz)) {
+            free(tmpv);
+            free_aligned(bitmap);
+            return -1;
+        }
+
+        memcpy(tmpv, hashv, keyc * sizeof(*tmpv));
+        if (fuse_filter_build(&ff, tmpv, keyc)) {
+            printf("%s: unable to build filter\n", fmt_name(fmt));
+            free(tmpv);
+            free_aligned(bitmap);
+            return -1;
+        }
+        free(tmpv);
+    } else {
+        if (fmt == fmt_v4)
+            bf_filter_init(&bf, desc, keyc, bitmap, sz);
+        else
+            bf_filter_init_sb(&bf, desc, keyc, bitmap, sz);
+
+        bf_filter_insert_by_hashv(&bf, hashv, keyc);
+    }
+
+    start = get_time_ns();
+    for (i = hitc = 0; i < keyc; ++i)
+        hitc += lookup(fmt, &bf, hashv[i]);
+    hit_ns = get_time_ns() - start;
+
+    start = get_time_ns();
+    for (i = fpc = 0; i < keyc; ++i)
+        fpc += lookup(fmt, &bf, missv[i]);
+    miss_ns = get_time_ns() - start;
+
+    report(fmt, prob, desc, sz, fpc, hit_ns, miss_ns);
+
+    free_aligned(bitmap);
+
+    if (hitc != keyc) {
+        printf("%s: BUG: %lu of %lu inserted keys not found\n", fmt_name(fmt), keyc - hitc, keyc);
+        return -1;
+    }
+
+    return 0;
+}
+
+void
+usage(void)
+{
+    fprintf(stderr, "Usage: [-s seed] [-n keys]\n");
+}
+
+int
+main(int argc, char *argv[])
+{
+    struct mwc_rand mwc;
+    int             opt, rc, i;
+    ulong           j;
+
+    seed = time(NULL);
+    keyc = keyc_default;
+
+    while ((opt = getopt(argc, argv, "s:n:h")) != -1) {
+        switch (opt) {
+            case 's':
+                seed = atoi(optarg);
+                break;
+            case 'n':
+                keyc = strtoul(optarg, NULL, 0);
+                break;
+            case 'h':
+            default:
+                usage();
+                exit(opt == 'h' ? 0 : -1);
+        }
+    }
+
+    if (optind > argc || keyc == 0) {
+        usage();
+        exit(-1);
+    }
+
+    hashv = malloc(keyc * sizeof(*hashv));
+    missv = malloc(keyc * sizeof(*missv));
+    if (!hashv || !missv)
+        return -1;
+
+    printf("seed = %u\n", seed);
+
+    /* Random 64-bit values stand in for xxhash64 key hashes.
+     */
+    mwc_rand_init(&mwc, seed);
+    for (j = 0; j < keyc; ++j) {
+        hashv[j] = mwc_rand64(&mwc);
+        missv[j] = mwc_rand64(&mwc);
+    }
+
+    rc = 0;
+    for (i = 0; i < NELEM(probv) && !rc; ++i) {
+        rc = rc ?: test(fmt_v4, probv[i]);
+        rc = rc ?: test(fmt_v5, probv[i]);
+        rc = rc ?: test(fmt_v5_scalar, probv[i]);
+        rc = rc ?: test(fmt_v6, probv[i]);
+        printf("\n");
+    }
+
+#ifndef NDEBUG
+    printf("Note: this is a debug build. "
+           "Use a release build for better performance.\n\n");
+#endif
+
+    free(hashv);
+    free(missv);
+
+    return rc ? -1 : 0;
+}
@@ -9,6 +9,9 @@
 #include <hse_util/slab.h>
 #include <hse_util/page.h>
 #include <hse_util/bloom_filter.h>
+#include <hse_util/fuse_filter.h>
+
+#include <hse_ikvdb/key_hash.h>
 
 #include "../omf.h"
 #include "../bloom_reader.h"
@@ -96,7 +99,8 @@ read_blooms(struct mtf_test_info *lcl_ti, char *kblock_file)
     mpm_mblock_read(blkid, &blm_hdr, omf_kbh_blm_hoff(&kb_hdr), omf_kbh_blm_hlen(&kb_hdr));
 
     ASSERT_EQ(omf_bh_magic(&blm_hdr), BLOOM_OMF_MAGIC);
-    ASSERT_EQ(omf_bh_version(&blm_hdr), BLOOM_OMF_VERSION);
+    /* The mblock images predate split block blooms. */
+    ASSERT_EQ(omf_bh_version(&blm_hdr), BLOOM_OMF_VERSION4);
 
     ASSERT_GE(omf_bh_bktshift(&blm_hdr), 9);
     ASSERT_LE(omf_bh_bktshift(&blm_hdr), 16);
@@ -109,6 +113,7 @@ read_blooms(struct mtf_test_info *lcl_ti, char *kblock_file)
     rgndesc.bd_first_page = omf_kbh_blm_doff_pg(&kb_hdr);
     rgndesc.bd_n_pages = omf_kbh_blm_dlen_pg(&kb_hdr);
 
+    rgndesc.bd_version = omf_bh_version(&blm_hdr);
     rgndesc.bd_modulus = omf_bh_modulus(&blm_hdr);
     rgndesc.bd_bktshift = omf_bh_bktshift(&blm_hdr);
     rgndesc.bd_bktmask = (1u << rgndesc.bd_bktshift) - 1;
@@ -169,6 +174,139 @@ MTF_DEFINE_UTEST_PRE(bloom_reader_test, basic_blm_test, test_prehook)
         read_blooms(lcl_ti, kblock_files[i]);
 }
 
+MTF_DEFINE_UTEST_PRE(bloom_reader_test, split_block_test, test_prehook)
+{
+    struct bf_bithash_desc bhdesc;
+    struct bloom_filter    bloom;
+    struct bloom_desc      desc = {};
+    struct kvs_ktuple      ktuple;
+    char                   keybuf[100];
+    size_t                 sz;
+    uint                   i, cnt, fpc;
+    u8 *                   blm_pages;
+    bool                   hit;
+
+    /* Build a bloom the way kblock_builder does, and read it back
+     * through a v5 region descriptor.
+     */
+    cnt = 20000;
+    bhdesc = bf_compute_bithash_est(10000);
+    sz = ALIGN(bf_size_estimate(bhdesc, cnt), PAGE_SIZE);
+
+    blm_pages = alloc_page_aligned(sz, GFP_KERNEL);
+    ASSERT_NE(NULL, blm_pages);
+    memset(blm_pages, 0, sz);
+
+    bf_filter_init_sb(&bloom, bhdesc, cnt, blm_pages, sz);
+    ASSERT_EQ(BF_SB_BKTSHIFT, bloom.bf_bktshift);
+    ASSERT_EQ(BF_SB_WORDS, bloom.bf_n_hashes);
+    ASSERT_EQ((sz * CHAR_BIT) >> BF_SB_BKTSHIFT, bloom.bf_modulus);
+
+    for (i = 0; i < cnt; ++i) {
+        ktuple.kt_len = snprintf(keybuf, sizeof(keybuf), "k%u", i);
+        bf_filter_insert_by_hash(&bloom, key_hash64(keybuf, ktuple.kt_len));
+    }
+
+    desc.bd_version = BLOOM_OMF_VERSION5;
+    desc.bd_modulus = bloom.bf_modulus;
+    desc.bd_bktshift = bloom.bf_bktshift;
+    desc.bd_bktmask = bloom.bf_bktmask;
+    desc.bd_n_hashes = bloom.bf_n_hashes;
+    desc.bd_n_pages = sz / PAGE_SIZE;
+
+    for (i = fpc = 0; i < cnt; ++i) {
+        const u8 *bkt;
+
+        ktuple.kt_data = keybuf;
+        ktuple.kt_hash = 0;
+        ktuple.kt_len = snprintf(keybuf, sizeof(keybuf), "k%u", i);
+
+        hit = bloom_reader_buffer_lookup(&desc, blm_pages, &ktuple);
+        ASSERT_TRUE(hit);
+
+        ktuple.kt_hash = ~ktuple.kt_hash;
+        hit = bloom_reader_buffer_lookup(&desc, blm_pages, &ktuple);
+        if (hit)
+            ++fpc;
+
+        /* The dispatched lookup must agree with the scalar one. */
+        bkt = blm_pages + bloom_desc_hash2bkt(&desc, ktuple.kt_hash);
+        ASSERT_LT(bkt - blm_pages, sz);
+        ASSERT_EQ(hit, bf_sb_lookup_portable(ktuple.kt_hash, bkt));
+    }
+
+    /* The estimate asks for 1%, allow some slack for small samples. */
+    ASSERT_LT((fpc * 1000) / cnt, 15);
+
+    free_aligned(blm_pages);
+}
+
+MTF_DEFINE_UTEST_PRE(bloom_reader_test, fuse_test, test_prehook)
+{
+    struct fuse_filter ff;
+    struct bloom_desc  desc = {};
+    struct kvs_ktuple  ktuple;
+    char               keybuf[100];
+    size_t             sz;
+    uint               i, cnt, fpc;
+    u64 *              hashv;
+    u8 *               blm_pages;
+    merr_t             err;
+    bool               hit;
+
+    /* Build a fuse filter the way kblock_builder does, and read it back
+     * through a v6 region descriptor.
+     */
+    cnt = 20000;
+    sz = ALIGN(fuse_size_estimate(cnt, 8), PAGE_SIZE);
+
+    blm_pages = alloc_page_aligned(sz, GFP_KERNEL);
+    ASSERT_NE(NULL, blm_pages);
+
+    hashv = malloc(sizeof(*hashv) * cnt);
+    ASSERT_NE(NULL, hashv);
+
+    for (i = 0; i < cnt; ++i) {
+        ktuple.kt_len = snprintf(keybuf, sizeof(keybuf), "k%u", i);
+        hashv[i] = key_hash64(keybuf, ktuple.kt_len);
+    }
+
+    err = fuse_filter_init(&ff, cnt, 8, blm_pages, sz);
+    ASSERT_EQ(0, err);
+
+    err = fuse_filter_build(&ff, hashv, cnt);
+    ASSERT_EQ(0, err);
+
+    desc.bd_version = BLOOM_OMF_VERSION6;
+    desc.bd_modulus = ff.ff_segcntlen;
+    desc.bd_bktshift = ilog2(ff.ff_seglen);
+    desc.bd_n_hashes = FUSE_ARITY;
+    desc.bd_fpbits = ff.ff_fpbits;
+    desc.bd_seed = ff.ff_seed;
+    desc.bd_n_pages = sz / PAGE_SIZE;
+
+    for (i = fpc = 0; i < cnt; ++i) {
+        ktuple.kt_data = keybuf;
+        ktuple.kt_hash = 0;
+        ktuple.kt_len = snprintf(keybuf, sizeof(keybuf), "k%u", i);
+
+        hit = bloom_reader_buffer_lookup(&desc, blm_pages, &ktuple);
+        ASSERT_TRUE(hit);
+        ASSERT_LT(bloom_desc_hash2bkt(&desc, ktuple.kt_hash), sz);
+
+        ktuple.kt_hash = ~ktuple.kt_hash;
+        hit = bloom_reader_buffer_lookup(&desc, blm_pages, &ktuple);
+        if (hit)
+            ++fpc;
+    }
+
+    /* 8-bit fingerprints give 1/256, allow some slack. */
+    ASSERT_LT((fpc * 1000) / cnt, 8);
+
+    free(hashv);
+    free_aligned(blm_pages);
+}
+
 MTF_DEFINE_UTEST_PRE(bloom_reader_test, t_bloom_reader_filter_info, test_prehook)
 {
     merr_t            err;
@@ -26,6 +26,7 @@
 #include "../kvset.h"
 
 #include <assert.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -178,6 +179,233 @@ init_mblks(struct kvset_mblocks *p, uint nsets, uint *nk, uint *nv)
     }
 }
 
+/*----------------------------------------------------------------
+ * Mocks for bulk loads
+ */
+struct fake_builder {
+    uint keys;
+};
+
+struct fake_kvset {
+    struct kvset_list_entry kle;
+    u64                     seqno_max;
+    const char *            minkey;
+    const char *            maxkey;
+};
+
+static u64  load_val_seqno;
+static u64  load_val_expiry;
+static u64  load_txn_seqno;
+static uint load_kvsetc;
+static u64  load_dgenv[16];
+static u32  load_levelv[16];
+
+static char load_val[32 * 1024];
+
+static merr_t
+_kvset_builder_create(
+    struct kvset_builder **bld_out,
+    struct cn *            cn,
+    struct perfc_set *     pc,
+    u64                    vgroup,
+    uint                   flags)
+{
+    struct fake_builder *bld;
+
+    bld = mapi_safe_calloc(1, sizeof(*bld));
+    if (!bld)
+        return merr(ENOMEM);
+
+    *bld_out = (struct kvset_builder *)bld;
+    return 0;
+}
+
+static void
+_kvset_builder_set_agegroup(struct kvset_builder *bldr, enum hse_mclass_policy_age age)
+{
+}
+
+static merr_t
+_kvset_builder_add_val_expiry(
+    struct kvset_builder *self,
+    u64                   seq,
+    const void *          vdata,
+    uint                  vlen,
+    uint                  complen,
+    u64                   expiry)
+{
+    load_val_seqno = seq;
+    load_val_expiry = expiry;
+    return 0;
+}
+
+static merr_t
+_kvset_builder_add_key(struct kvset_builder *self, const struct key_obj *kobj)
+{
+    ((struct fake_builder *)self)->keys++;
+    return 0;
+}
+
+/* Each kvset with keys gets one kblock and one vblock.
+ */
+static merr_t
+_kvset_builder_get_mblocks(struct kvset_builder *self, struct kvset_mblocks *mblks)
+{
+    blk_list_init(&mblks->kblks);
+    blk_list_init(&mblks->vblks);
+
+    if (((struct fake_builder *)self)->keys) {
+        blk_list_append(&mblks->kblks, mblk_id++);
+        blk_list_append(&mblks->vblks, mblk_id++);
+    }
+
+    return 0;
+}
+
+static void
+_kvset_builder_destroy(struct kvset_builder *self)
+{
+    mapi_safe_free(self);
+}
+
+static merr_t
+_cndb_txn_start(struct cndb *cndb, u64 *txid, u64 ingestid, int nc, int nd, u64 seqno)
+{
+    *txid = 1;
+    load_txn_seqno = seqno;
+    return 0;
+}
+
+static merr_t
+_kvset_create(struct cn_tree *tree, u64 tag, struct kvset_meta *km, struct kvset **kvset)
+{
+    if (load_kvsetc >= NELEM(load_dgenv))
+        return merr(EBUG);
+
+    load_dgenv[load_kvsetc] = km->km_dgen;
+    load_levelv[load_kvsetc] = km->km_node_level;
+
+    *kvset = (struct kvset *)&load_dgenv[load_kvsetc++];
+    return 0;
+}
+
+static u64
+_kvset_get_seqno_max(struct kvset *kvset)
+{
+    return ((struct fake_kvset *)kvset)->seqno_max;
+}
+
+static int
+_kvset_pt_start(struct kvset *kvset)
+{
+    return -1;
+}
+
+static uint
+_kvset_get_rtombs(struct kvset *kvset, const struct rtomb **rtv)
+{
+    *rtv = NULL;
+    return 0;
+}
+
+static void
+_kvset_minkey(struct kvset *kvset, const void **minkey, u16 *minklen)
+{
+    *minkey = ((struct fake_kvset *)kvset)->minkey;
+    *minklen = strlen(*minkey);
+}
+
+static void
+_kvset_maxkey(struct kvset *kvset, const void **maxkey, u16 *maxklen)
+{
+    *maxkey = ((struct fake_kvset *)kvset)->maxkey;
+    *maxklen = strlen(*maxkey);
+}
+
+int
+load_pre(struct mtf_test_info *info)
+{
+    enable_mocks();
+
+    /* Use the mocks below rather than the injections so that the
+     * txn seqno and created kvsets can be checked.
+     */
+    mapi_inject_unset(mapi_idx_cndb_txn_start);
+    mapi_inject_unset(mapi_idx_kvset_create);
+
+    MOCK_SET(kvset_builder, _kvset_builder_create);
+    MOCK_SET(kvset_builder, _kvset_builder_set_agegroup);
+    MOCK_SET(kvset_builder, _kvset_builder_add_val_expiry);
+    MOCK_SET(kvset_builder, _kvset_builder_add_key);
+    MOCK_SET(kvset_builder, _kvset_builder_get_mblocks);
+    MOCK_SET(kvset_builder, _kvset_builder_destroy);
+
+    MOCK_SET(cndb, _cndb_txn_start);
+    MOCK_SET(kvset, _kvset_create);
+    MOCK_SET(kvset, _kvset_pt_start);
+    MOCK_SET(kvset, _kvset_get_rtombs);
+    MOCK_SET(kvset, _kvset_minkey);
+    MOCK_SET(kvset, _kvset_maxkey);
+    MOCK_SET(kvset_view, _kvset_get_seqno_max);
+
+    load_val_seqno = 0;
+    load_val_expiry = 0;
+    load_txn_seqno = 0;
+    load_kvsetc = 0;
+
+    return 0;
+}
+
+/* With cn_load_kvset_mb of 1, each kvset holds 32 keys of 32KiB values.
+ */
+static merr_t
+load_setup(struct cn *cn, struct kvs_rparams *rp)
+{
+    struct kvs_cparams cp = {};
+
+    *rp = kvs_rparams_defaults();
+    rp->cn_load_kvset_mb = 1;
+
+    memset(cn, 0, sizeof(*cn));
+    cn->rp = rp;
+    cn->cn_dataset = mock_ds;
+    atomic64_set(&cn->cn_ingest_dgen, 41);
+    mutex_init(&cn->cn_ingest_lock);
+
+    cp.cp_fanout = 4;
+
+    return cn_tree_create(&cn->cn_tree, NULL, 0, &cp, &mock_health, rp);
+}
+
+static void
+load_cleanup(struct cn *cn)
+{
+    cn_tree_destroy(cn->cn_tree);
+    mutex_destroy(&cn->cn_ingest_lock);
+}
+
+static merr_t
+load_keys(struct cn_load *load, uint first, uint count)
+{
+    struct kvs_ktuple kt;
+    struct kvs_vtuple vt;
+    char              key[16];
+    merr_t            err;
+    uint              i;
+
+    for (i = first; i < first + count; i++) {
+        snprintf(key, sizeof(key), "key%04u", i);
+        kvs_ktuple_init(&kt, key, strlen(key));
+        kvs_vtuple_init(&vt, load_val, sizeof(load_val));
+
+        err = cn_load_add(load, &kt, &vt);
+        if (err)
+            return err;
+    }
+
+    return 0;
+}
+
 /* ------------------------------------------------------------
  * Unit tests
  */
@@ -296,6 +524,56 @@ MTF_DEFINE_UTEST_PRE(cn_ingest_test, worker, test_pre)
     cn_tree_destroy(cn.cn_tree);
 }
 
+MTF_DEFINE_UTEST_PRE(cn_ingest_test, multi_kvset, test_pre)
+{
+    struct kvset_mblocks m[3];
+    uint                 n_kvsets = NELEM(m);
+
+    u32                k, v;
+    merr_t             err;
+    struct cn          cn = {};
+    struct kvs_rparams rp;
+
+    struct cn *           cnv[1] = { &cn };
+    struct kvset_mblocks *mbv[1] = { &m[0] };
+    int                   mbc[1];
+    bool                  ingested;
+    u64                   seqno;
+    struct kvs_cparams    cp;
+
+    rp = kvs_rparams_defaults();
+    cn.rp = &rp;
+    cn.cn_dataset = mock_ds;
+    atomic64_set(&cn.cn_ingest_dgen, 41);
+
+    cp.cp_fanout = 4;
+    cp.cp_pfx_len = 0;
+    cp.cp_pfx_pivot = 0;
+    cp.cp_sfx_len = 0;
+    err = cn_tree_create(&cn.cn_tree, NULL, 0, &cp, &mock_health, &rp);
+    ASSERT_EQ(err, 0);
+
+    /* Several kvsets for one cn are ingested in one cndb txn,
+     * each with its own dgen.
+     */
+    mapi_calls_clear(mapi_idx_cndb_txn_start);
+    mapi_calls_clear(mapi_idx_kvset_create);
+    mapi_calls_clear(mapi_idx_cn_tree_ingest_update);
+
+    init_mblks(m, n_kvsets, &k, &v);
+    mbc[0] = n_kvsets;
+    err = cn_ingestv(cnv, mbv, mbc, NULL, U64_MAX, (int)NELEM(cnv), &ingested, &seqno);
+    ASSERT_EQ(err, 0);
+    ASSERT_TRUE(ingested);
+    ASSERT_EQ(mapi_calls(mapi_idx_cndb_txn_start), 1);
+    ASSERT_EQ(mapi_calls(mapi_idx_kvset_create), n_kvsets);
+    ASSERT_EQ(mapi_calls(mapi_idx_cn_tree_ingest_update), n_kvsets);
+    ASSERT_EQ(atomic64_read(&cn.cn_ingest_dgen), 41 + n_kvsets);
+    free_mblks(m, n_kvsets);
+
+    cn_tree_destroy(cn.cn_tree);
+}
+
 MTF_DEFINE_UTEST_PRE(cn_ingest_test, fail_cleanup, test_pre)
 {
     struct kvset_mblocks m[1];
@@ -347,4 +625,257 @@ MTF_DEFINE_UTEST_PRE(cn_ingest_test, fail_cleanup, test_pre)
     cn_tree_destroy(cn.cn_tree);
 }
 
+MTF_DEFINE_UTEST_PRE(cn_ingest_test, load_reject, test_pre)
+{
+    struct cn          cn = {};
+    struct kvs_rparams rp;
+    struct kvs_ktuple  kt;
+    struct kvs_vtuple  vt;
+    struct cn_load *   load;
+    merr_t             err;
+
+    rp = kvs_rparams_defaults();
+    cn.rp = &rp;
+    cn.cn_dataset = mock_ds;
+
+    err = cn_load_create(&cn, 42, 0, &load);
+    ASSERT_EQ(err, 0);
+
+    /* Tombstones cannot be bulk loaded. */
+    kvs_ktuple_init(&kt, "key", 3);
+    kvs_vtuple_init(&vt, HSE_CORE_TOMB_REG, 0);
+    err = cn_load_add(load, &kt, &vt);
+    ASSERT_EQ(merr_errno(err), EINVAL);
+
+    /* An empty load commits without starting a cndb txn. */
+    mapi_calls_clear(mapi_idx_cndb_txn_start);
+    err = cn_load_commit(load);
+    ASSERT_EQ(err, 0);
+    ASSERT_EQ(mapi_calls(mapi_idx_cndb_txn_start), 0);
+
+    cn_load_destroy(load);
+}
+
+MTF_DEFINE_UTEST_PRE(cn_ingest_test, load_order, load_pre)
+{
+    struct cn          cn;
+    struct kvs_rparams rp;
+    struct kvs_ktuple  kt;
+    struct kvs_vtuple  vt;
+    struct cn_load *   load;
+    merr_t             err;
+
+    err = load_setup(&cn, &rp);
+    ASSERT_EQ(err, 0);
+
+    err = cn_load_create(&cn, 42, 0, &load);
+    ASSERT_EQ(err, 0);
+
+    err = load_keys(load, 10, 1);
+    ASSERT_EQ(err, 0);
+
+    /* Keys must be added in strictly ascending order. */
+    kvs_vtuple_init(&vt, load_val, 8);
+
+    kvs_ktuple_init(&kt, "key0010", 7);
+    err = cn_load_add(load, &kt, &vt);
+    ASSERT_EQ(merr_errno(err), EINVAL);
+
+    kvs_ktuple_init(&kt, "key0009", 7);
+    err = cn_load_add(load, &kt, &vt);
+    ASSERT_EQ(merr_errno(err), EINVAL);
+
+    kvs_ktuple_init(&kt, "key001", 6);
+    err = cn_load_add(load, &kt, &vt);
+    ASSERT_EQ(merr_errno(err), EINVAL);
+
+    err = load_keys(load, 11, 1);
+    ASSERT_EQ(err, 0);
+
+    cn_load_destroy(load);
+    load_cleanup(&cn);
+}
+
+MTF_DEFINE_UTEST_PRE(cn_ingest_test, load_commit, load_pre)
+{
+    struct cn          cn;
+    struct kvs_rparams rp;
+    struct cn_load *   load;
+    merr_t             err;
+    uint               i;
+
+    err = load_setup(&cn, &rp);
+    ASSERT_EQ(err, 0);
+
+    err = cn_load_create(&cn, 42, 1234, &load);
+    ASSERT_EQ(err, 0);
+
+    /* 80 keys roll over to a new kvset after keys 32 and 64.
+     */
+    mapi_calls_clear(mapi_idx_cn_tree_ingest_update);
+
+    err = load_keys(load, 0, 80);
+    ASSERT_EQ(err, 0);
+    ASSERT_EQ(load_val_seqno, 42);
+    ASSERT_EQ(load_val_expiry, 1234);
+
+    err = cn_load_commit(load);
+    ASSERT_EQ(err, 0);
+    ASSERT_EQ(load_txn_seqno, 42);
+    ASSERT_EQ(load_kvsetc, 3);
+    ASSERT_EQ(mapi_calls(mapi_idx_cn_tree_ingest_update), 3);
+
+    /* Each kvset goes into the root node with its own dgen. */
+    for (i = 0; i < load_kvsetc; i++) {
+        ASSERT_EQ(load_levelv[i], 0);
+        ASSERT_EQ(load_dgenv[i], 42 + i);
+    }
+    ASSERT_EQ(atomic64_read(&cn.cn_ingest_dgen), 44);
+
+    /* Nothing is left to abort once committed. */
+    mapi_calls_clear(mapi_idx_mpool_mblock_abort);
+    cn_load_destroy(load);
+    ASSERT_EQ(mapi_calls(mapi_idx_mpool_mblock_abort), 0);
+
+    load_cleanup(&cn);
+}
+
+MTF_DEFINE_UTEST_PRE(cn_ingest_test, load_abort, load_pre)
+{
+    struct cn          cn;
+    struct kvs_rparams rp;
+    struct cn_load *   load;
+    merr_t             err;
+
+    err = load_setup(&cn, &rp);
+    ASSERT_EQ(err, 0);
+
+    /* The mblocks of the two finished kvsets are aborted, those of
+     * the one still being built belong to its builder.
+     */
+    err = cn_load_create(&cn, 42, 0, &load);
+    ASSERT_EQ(err, 0);
+
+    err = load_keys(load, 0, 80);
+    ASSERT_EQ(err, 0);
+
+    mapi_calls_clear(mapi_idx_mpool_mblock_abort);
+    cn_load_destroy(load);
+    ASSERT_EQ(mapi_calls(mapi_idx_mpool_mblock_abort), 4);
+    ASSERT_EQ(load_kvsetc, 0);
+
+    /* A failed commit leaves all of its mblocks to be aborted. */
+    err = cn_load_create(&cn, 42, 0, &load);
+    ASSERT_EQ(err, 0);
+
+    err = load_keys(load, 0, 80);
+    ASSERT_EQ(err, 0);
+
+    mapi_inject(mapi_idx_cndb_txn_start, merr(ENOMEM));
+    err = cn_load_commit(load);
+    ASSERT_EQ(merr_errno(err), ENOMEM);
+    ASSERT_EQ(load_kvsetc, 0);
+    mapi_inject_unset(mapi_idx_cndb_txn_start);
+
+    mapi_calls_clear(mapi_idx_mpool_mblock_abort);
+    cn_load_destroy(load);
+    ASSERT_EQ(mapi_calls(mapi_idx_mpool_mblock_abort), 6);
+
+    /* If the second kvset cannot be created the first is put, the
+     * committed mblocks of the second are deleted and those of the
+     * third are aborted.
+     */
+    err = cn_load_create(&cn, 42, 0, &load);
+    ASSERT_EQ(err, 0);
+
+    err = load_keys(load, 0, 80);
+    ASSERT_EQ(err, 0);
+
+    mapi_calls_clear(mapi_idx_cndb_txn_nak);
+    mapi_calls_clear(mapi_idx_kvset_put_ref);
+    mapi_calls_clear(mapi_idx_mpool_mblock_delete);
+    mapi_calls_clear(mapi_idx_cn_tree_ingest_update);
+
+    mapi_inject_once(mapi_idx_kvset_create, 2, merr(EBADF));
+    err = cn_load_commit(load);
+    ASSERT_EQ(merr_errno(err), EBADF);
+    mapi_inject_unset(mapi_idx_kvset_create);
+
+    ASSERT_EQ(mapi_calls(mapi_idx_cndb_txn_nak), 1);
+    ASSERT_EQ(mapi_calls(mapi_idx_kvset_put_ref), 1);
+    ASSERT_EQ(mapi_calls(mapi_idx_mpool_mblock_delete), 2);
+    ASSERT_EQ(mapi_calls(mapi_idx_cn_tree_ingest_update), 0);
+
+    mapi_calls_clear(mapi_idx_mpool_mblock_abort);
+    cn_load_destroy(load);
+    ASSERT_EQ(mapi_calls(mapi_idx_mpool_mblock_abort), 2);
+
+    load_cleanup(&cn);
+}
+
+MTF_DEFINE_UTEST_PRE(cn_ingest_test, load_stale, load_pre)
+{
+    struct cn            cn;
+    struct kvs_rparams   rp;
+    struct cn_load *     load;
+    struct fake_kvset    ks = {};
+    struct cn_tree_node *root;
+    merr_t               err;
+
+    err = load_setup(&cn, &rp);
+    ASSERT_EQ(err, 0);
+
+    root = cn.cn_tree->ct_root;
+    ks.kle.le_kvset = (struct kvset *)&ks;
+    list_add(&ks.kle.le_link, &root->tn_kvset_list);
+
+    err = cn_load_create(&cn, 42, 0, &load);
+    ASSERT_EQ(err, 0);
+
+    err = load_keys(load, 10, 20);
+    ASSERT_EQ(err, 0);
+
+    /* Writes older than the load do not make it stale. */
+    ks.seqno_max = 42;
+    ks.minkey = "key0000";
+    ks.maxkey = "key0099";
+    err = cn_load_commit(load);
+    ASSERT_EQ(err, 0);
+    ASSERT_EQ(load_kvsetc, 1);
+    cn_load_destroy(load);
+
+    /* Nor do newer writes outside its key range. */
+    err = cn_load_create(&cn, 42, 0, &load);
+    ASSERT_EQ(err, 0);
+
+    err = load_keys(load, 10, 20);
+    ASSERT_EQ(err, 0);
+
+    ks.seqno_max = 43;
+    ks.minkey = "key0030";
+    ks.maxkey = "key0099";
+    err = cn_load_commit(load);
+    ASSERT_EQ(err, 0);
+    ASSERT_EQ(load_kvsetc, 2);
+    cn_load_destroy(load);
+
+    /* But newer writes that overlap it do. */
+    err = cn_load_create(&cn, 42, 0, &load);
+    ASSERT_EQ(err, 0);
+
+    err = load_keys(load, 10, 20);
+    ASSERT_EQ(err, 0);
+
+    ks.minkey = "key0029";
+    mapi_calls_clear(mapi_idx_mpool_mblock_abort);
+    err = cn_load_commit(load);
+    ASSERT_EQ(merr_errno(err), ESTALE);
+    ASSERT_EQ(load_kvsetc, 2);
+    cn_load_destroy(load);
+    ASSERT_EQ(mapi_calls(mapi_idx_mpool_mblock_abort), 2);
+
+    list_del(&ks.kle.le_link);
+    load_cleanup(&cn);
+}
+
 MTF_END_UTEST_COLLECTION(cn_ingest_test);
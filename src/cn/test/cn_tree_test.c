@@ -49,6 +49,7 @@ struct fake_kvset {
     u64                     vused;
     u64                     workid;
     struct kvset_stats      stats;
+    const char **           minkeys;
     struct fake_kvset *     next;
 };
 
@@ -188,6 +189,17 @@ _kvset_get_max_key(struct kvset *ks, void **key, uint *klen)
     *klen = 3;
 }
 
+/* A NULL min key stands for a kblock that holds only ptombs. */
+static void
+_kvset_get_nth_kblock_minkey(struct kvset *handle, u32 index, const void **key, uint *klen)
+{
+    struct fake_kvset *ks = (struct fake_kvset *)handle;
+    const char *       minkey = ks->minkeys ? ks->minkeys[index] : NULL;
+
+    *key = minkey;
+    *klen = minkey ? strlen(minkey) : 0;
+}
+
 /*----------------------------------------------------------------
  * Mocked kvset iterator
  */
@@ -313,6 +325,9 @@ struct injections injections[] = {
     { 0xabc002, mapi_idx_kvset_get_nth_vblock_id },
     { 128 * 1024, mapi_idx_kvset_get_nth_vblock_len },
 
+    /* fake kvsets are not fenced */
+    { 0, mapi_idx_kvset_get_fences },
+
     /* we need kvset_iter_create, but we should never
      * need the guts of an iterator b/c we mock
      * the actual compact/spill functions. */
@@ -361,6 +376,7 @@ test_setup(struct mtf_test_info *lcl_ti)
     MOCK_SET(kvset_view, _kvset_get_dgen);
     MOCK_SET(kvset_view, _kvset_get_num_kblocks);
     MOCK_SET(kvset_view, _kvset_get_num_vblocks);
+    MOCK_SET(kvset_view, _kvset_get_nth_kblock_minkey);
 
     memset(&mock_health, 0, sizeof(mock_health));
 
@@ -574,6 +590,139 @@ MTF_DEFINE_UTEST_PRE(test, t_cn_tree_ingest_update, test_setup)
         fake_kvset_destroy((struct fake_kvset *)kvsetv[i]);
 }
 
+/* Ingest one fake kvset per vector of kblock min keys into the root,
+ * then split the tree with cn_tree_split_keys().
+ */
+static uint
+split_keys(
+    const char ***minkeysv,
+    const uint *  nkv,
+    uint          kvsetc,
+    uint          splitc,
+    char          keys[][HSE_KVS_KLEN_MAX])
+{
+    struct kvs_cparams   cp = { .cp_fanout = 4 };
+    struct fake_kvset *  kvsetv[4];
+    struct cn_tree *     tree;
+    struct cn_tree_node *node;
+    struct cn_node_loc   loc = { 0 };
+    uint                 klenv[8];
+    uint                 i, n;
+    merr_t               err;
+
+    assert(kvsetc <= NELEM(kvsetv) && splitc <= NELEM(klenv));
+
+    err = cn_tree_create(&tree, NULL, 0, &cp, &mock_health, rp);
+    if (err)
+        return UINT_MAX;
+
+    for (i = 0; i < kvsetc; i++) {
+        kvsetv[i] = fake_kvset_create(0, 100 + i);
+        if (!kvsetv[i])
+            return UINT_MAX;
+
+        kvsetv[i]->nk = nkv[i];
+        kvsetv[i]->minkeys = minkeysv[i];
+
+        cn_tree_ingest_update(tree, (struct kvset *)kvsetv[i], 0, 0, 0);
+    }
+
+    memset(keys, 0, splitc * HSE_KVS_KLEN_MAX);
+    n = cn_tree_split_keys(tree, splitc, keys, klenv);
+
+    /* The split keys are NUL terminated by the memset above. */
+    for (i = 0; i < n; i++)
+        if (klenv[i] != strlen(keys[i]))
+            n = UINT_MAX;
+
+    node = cn_tree_find_node(tree, &loc);
+    if (node)
+        INIT_LIST_HEAD(&node->tn_kvset_list);
+    cn_tree_destroy(tree);
+
+    for (i = 0; i < kvsetc; i++)
+        fake_kvset_destroy(kvsetv[i]);
+
+    return n;
+}
+
+MTF_DEFINE_UTEST_PRE(test, t_cn_tree_split_keys, test_setup)
+{
+    const char *distinct[] = { "e", "a", "g", "c", "b", "h", "d", "f" };
+    const char *odd[] = { "a", "c", "e", "g" };
+    const char *even[] = { "h", "b", "f", "d" };
+    const char *dups[] = { "m", "m", "a", "m", "m", "m", "m", "m" };
+    const char *same[] = { "m", "m", "m", "m", "m", "m", "m", "m" };
+    const char *ptombs[] = { NULL, "b", NULL, "d", NULL, "f", NULL, "h" };
+    const char *onlyptombs[] = { NULL, NULL };
+    const char **minkeysv[2];
+    char         keys[8][HSE_KVS_KLEN_MAX];
+    uint         nkv[2];
+    uint         n;
+
+    /* An empty tree has nothing to split. */
+    n = split_keys(NULL, NULL, 0, 3, keys);
+    ASSERT_EQ(0, n);
+
+    /* Nor has a tree whose kblocks hold only ptombs. */
+    minkeysv[0] = onlyptombs;
+    nkv[0] = NELEM(onlyptombs);
+    n = split_keys(minkeysv, nkv, 1, 3, keys);
+    ASSERT_EQ(0, n);
+
+    /* No split keys asked for. */
+    minkeysv[0] = distinct;
+    nkv[0] = NELEM(distinct);
+    n = split_keys(minkeysv, nkv, 1, 0, keys);
+    ASSERT_EQ(0, n);
+
+    /* Quartiles of the kblock min keys. */
+    n = split_keys(minkeysv, nkv, 1, 3, keys);
+    ASSERT_EQ(3, n);
+    ASSERT_STREQ("c", keys[0]);
+    ASSERT_STREQ("e", keys[1]);
+    ASSERT_STREQ("g", keys[2]);
+
+    /* More splits than kblocks: each range still holds a kblock. */
+    n = split_keys(minkeysv, nkv, 1, 8, keys);
+    ASSERT_EQ(7, n);
+    ASSERT_STREQ("b", keys[0]);
+    ASSERT_STREQ("h", keys[6]);
+
+    /* Min keys are gathered from all the kvsets of the tree. */
+    minkeysv[0] = odd;
+    nkv[0] = NELEM(odd);
+    minkeysv[1] = even;
+    nkv[1] = NELEM(even);
+    n = split_keys(minkeysv, nkv, 2, 3, keys);
+    ASSERT_EQ(3, n);
+    ASSERT_STREQ("c", keys[0]);
+    ASSERT_STREQ("e", keys[1]);
+    ASSERT_STREQ("g", keys[2]);
+
+    /* Duplicate split keys are dropped. */
+    minkeysv[0] = dups;
+    nkv[0] = NELEM(dups);
+    n = split_keys(minkeysv, nkv, 1, 3, keys);
+    ASSERT_EQ(1, n);
+    ASSERT_STREQ("m", keys[0]);
+
+    /* A split on the smallest key would leave the first range empty. */
+    minkeysv[0] = same;
+    nkv[0] = NELEM(same);
+    n = split_keys(minkeysv, nkv, 1, 3, keys);
+    ASSERT_EQ(0, n);
+
+    /* Kblocks that hold only ptombs are ignored. */
+    minkeysv[0] = ptombs;
+    nkv[0] = NELEM(ptombs);
+    n = split_keys(minkeysv, nkv, 1, 3, keys);
+    ASSERT_EQ(3, n);
+    ASSERT_STREQ("d", keys[0]);
+    ASSERT_STREQ("f", keys[1]);
+    ASSERT_STREQ("h", keys[2]);
+}
+
 /*----------------------------------------------------------------
  * Support for the MY_TEST1 and MY_TEST2 macros below
  */
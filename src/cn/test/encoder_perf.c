@@ -564,7 +564,7 @@ run_kmd_write_perf(struct kmd_test_stats *s)
 
         s->nvals += count;
         while (count-- > 0)
-            kmd_add_val(mem, &off, seq++, vbidx, vboff, vlen);
+            kmd_add_val(mem, &off, seq++, 0, vbidx, vboff, vlen);
     }
 
     kmd_set_count(mem, &off, 0);
@@ -604,6 +604,7 @@ run_kmd_read_perf(struct kmd_test_stats *s)
             assert(exp_seq + i == seq);
             switch (vtype) {
                 case vtype_ival:
+                case vtype_mop:
                     kmd_ival(mem, &off, &vdata, &vlen);
                     s->nvals++;
                     break;
@@ -673,6 +674,7 @@ run_kmd_tp(struct kmd_test_profile *tp, struct kmd_test_stats *s, bool writing)
                     s->nzvals++;
                     break;
                 case vtype_ival:
+                case vtype_mop:
                     s->nivals++;
                     break;
                 case vtype_cval:
@@ -689,16 +691,19 @@ run_kmd_tp(struct kmd_test_profile *tp, struct kmd_test_stats *s, bool writing)
                         kmd_add_ptomb(mem, &off, seq);
                         break;
                     case vtype_zval:
-                        kmd_add_zval(mem, &off, seq);
+                        kmd_add_zval(mem, &off, seq, 0);
                         break;
                     case vtype_ival:
-                        kmd_add_ival(mem, &off, seq, vdata, vlen);
+                        kmd_add_ival(mem, &off, seq, 0, vdata, vlen);
+                        break;
+                    case vtype_mop:
+                        kmd_add_mop(mem, &off, seq, vdata, vlen);
                         break;
                     case vtype_cval:
-                        kmd_add_cval(mem, &off, seq, vbidx, vboff, vlen, clen);
+                        kmd_add_cval(mem, &off, seq, 0, vbidx, vboff, vlen, clen);
                         break;
                     case vtype_val:
-                        kmd_add_val(mem, &off, seq, vbidx, vboff, vlen);
+                        kmd_add_val(mem, &off, seq, 0, vbidx, vboff, vlen);
                         break;
                 }
             } else {
@@ -728,6 +733,7 @@ run_kmd_tp(struct kmd_test_profile *tp, struct kmd_test_stats *s, bool writing)
                         assert(actual_clen == clen);
                         break;
                     case vtype_ival:
+                    case vtype_mop:
                         kmd_ival(mem, &off, &actual_vdata, &actual_vlen);
                         assert(actual_vlen == vlen);
                         break;
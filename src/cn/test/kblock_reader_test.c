@@ -55,6 +55,7 @@ struct kb_hdr {
     struct wbt_hdr_omf *   wbt_hdr;
     struct bloom_hdr_omf * blm_hdr;
     struct wbt_hdr_omf *   pt_hdr;
+    struct bloom_hdr_omf * pbm_hdr;
     u8                     data[4096];
 };
 
@@ -71,12 +72,14 @@ init_kb_hdr(struct kb_hdr *kb)
     u32 wbt_off = (sizeof(struct kblock_hdr_omf) + align) & ~(align - 1);
     u32 blm_off = wbt_off + ((sizeof(struct wbt_hdr_omf) + align) & ~(align - 1));
     u32 pt_off = blm_off + ((sizeof(struct bloom_hdr_omf) + align) & ~(align - 1));
+    u32 pbm_off = pt_off + ((sizeof(struct wbt_hdr_omf) + align) & ~(align - 1));
 
     memset(kb->data, 0, 4096);
     kb->kb_hdr = (struct kblock_hdr_omf *)(kb->data);
     kb->wbt_hdr = (struct wbt_hdr_omf *)(kb->data + wbt_off);
     kb->blm_hdr = (struct bloom_hdr_omf *)(kb->data + blm_off);
     kb->pt_hdr = (struct wbt_hdr_omf *)(kb->data + pt_off);
+    kb->pbm_hdr = (struct bloom_hdr_omf *)(kb->data + pbm_off);
 
     omf_set_kbh_magic(kb->kb_hdr, KBLOCK_HDR_MAGIC);
     omf_set_kbh_version(kb->kb_hdr, KBLOCK_HDR_VERSION);
@@ -104,6 +107,10 @@ init_kb_hdr(struct kb_hdr *kb)
     omf_set_kbh_pt_doff_pg(kb->kb_hdr, 13);
     omf_set_kbh_pt_dlen_pg(kb->kb_hdr, 3);
 
+    /* NOTE: no prefix bloom unless a test sets its data pages */
+    omf_set_kbh_pbm_hoff(kb->kb_hdr, pbm_off);
+    omf_set_kbh_pbm_hlen(kb->kb_hdr, sizeof(struct bloom_hdr_omf));
+
     /* fake seqnos */
     omf_set_kbh_min_seqno(kb->kb_hdr, 11);
     omf_set_kbh_max_seqno(kb->kb_hdr, 101);
@@ -115,13 +122,20 @@ init_kb_hdr(struct kb_hdr *kb)
     omf_set_wbt_leaf_cnt(kb->wbt_hdr, 0);
 
     omf_set_bh_magic(kb->blm_hdr, BLOOM_OMF_MAGIC);
-    omf_set_bh_version(kb->blm_hdr, BLOOM_OMF_VERSION);
+    omf_set_bh_version(kb->blm_hdr, BLOOM_OMF_VERSION5);
+
+    omf_set_bh_modulus(kb->blm_hdr, (2 * PAGE_SIZE * CHAR_BIT) >> BF_SB_BKTSHIFT);
+    omf_set_bh_bktshift(kb->blm_hdr, BF_SB_BKTSHIFT);
+    omf_set_bh_rotl(kb->blm_hdr, 0);
+    omf_set_bh_n_hashes(kb->blm_hdr, BF_SB_WORDS);
+    omf_set_bh_bitmapsz(kb->blm_hdr, 2 * PAGE_SIZE);
 
-    omf_set_bh_modulus(kb->blm_hdr, 11730);
-    omf_set_bh_bktshift(kb->blm_hdr, BF_BKTSHIFT);
-    omf_set_bh_rotl(kb->blm_hdr, BF_ROTL);
-    omf_set_bh_n_hashes(kb->blm_hdr, 7);
-    omf_set_bh_bitmapsz(kb->blm_hdr, ALIGN((omf_bh_modulus(kb->blm_hdr) / CHAR_BIT), PAGE_SIZE));
+    omf_set_bh_magic(kb->pbm_hdr, BLOOM_OMF_MAGIC);
+    omf_set_bh_version(kb->pbm_hdr, BLOOM_OMF_VERSION5);
+    omf_set_bh_modulus(kb->pbm_hdr, (PAGE_SIZE * CHAR_BIT) >> BF_SB_BKTSHIFT);
+    omf_set_bh_bktshift(kb->pbm_hdr, BF_SB_BKTSHIFT);
+    omf_set_bh_n_hashes(kb->pbm_hdr, BF_SB_WORDS);
+    omf_set_bh_bitmapsz(kb->pbm_hdr, PAGE_SIZE);
 
     omf_set_wbt_magic(kb->pt_hdr, WBT_TREE_MAGIC);
     omf_set_wbt_version(kb->pt_hdr, WBT_TREE_VERSION);
@@ -241,6 +255,8 @@ MTF_DEFINE_UTEST_PRE(kblock_reader_test, basic_wbt_blm_test, pre)
     ASSERT_EQ(0, err);
     ASSERT_EQ(omf_kbh_blm_doff_pg(kb.kb_hdr), blm_desc.bd_first_page);
     ASSERT_EQ(omf_kbh_blm_dlen_pg(kb.kb_hdr), blm_desc.bd_n_pages);
+    ASSERT_EQ(BLOOM_OMF_VERSION5, blm_desc.bd_version);
+    ASSERT_EQ(omf_bh_modulus(kb.blm_hdr), blm_desc.bd_modulus);
 
     /* BLOOM_LOOKUP_MCACHE will return base address of the bloom
      * blocks in the mcache map.
@@ -526,7 +542,7 @@ MTF_DEFINE_UTEST_PRE(kblock_reader_test, t_corrupt_header, pre)
     /* corrupt blm hdr version */
     /* check should succeed, but with blooms disabled */
     init_kb_hdr(&kb);
-    omf_set_bh_version(kb.blm_hdr, omf_bh_version(kb.blm_hdr) + 1);
+    omf_set_bh_version(kb.blm_hdr, BLOOM_OMF_VERSION + 1);
     err = check_read_hdrs(&kb, &blkdesc, 0, 0, 0, 0);
     ASSERT_EQ(err, 0);
 
@@ -607,4 +623,83 @@ MTF_DEFINE_UTEST_PRE(kblock_reader_test, basic_kblock_error_test, pre)
     ASSERT_EQ(err, 0);
 }
 
+MTF_DEFINE_UTEST_PRE(kblock_reader_test, pfx_bloom_test, pre)
+{
+    merr_t               err;
+    struct mpool *       mp_ds = (void *)-1;
+    struct kb_hdr        kb;
+    struct bloom_desc    pbm_desc;
+    struct kvs_mblk_desc blkdesc;
+    u64                  blkid;
+    u8 *                 pbm_pages;
+
+    memset(&blkdesc, 0, sizeof(blkdesc));
+
+    err = mpm_mblock_alloc(FAKE_KBLOCK_SIZE, &blkid);
+    ASSERT_EQ(0, err);
+    blkdesc.mb_id = blkid;
+
+    err = mpm_mblock_write(blkid, fake_kblock_buf, 0, FAKE_KBLOCK_SIZE);
+    ASSERT_EQ(0, err);
+
+    err = mpool_mcache_mmap(mp_ds, 1, &blkdesc.mb_id, MPC_VMA_COLD, &blkdesc.map);
+    ASSERT_EQ(0, err);
+
+    /* no prefix bloom pages */
+    init_kb_hdr(&kb);
+    err = write_kb_hdr(&kb, &blkdesc);
+    ASSERT_EQ(0, err);
+
+    err = kbr_read_pbm_region_desc(&blkdesc, &pbm_desc);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(0, pbm_desc.bd_n_pages);
+
+    err = kbr_read_blm_pages(&blkdesc, BLOOM_LOOKUP_MCACHE, &pbm_desc, &pbm_pages);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(NULL, pbm_pages);
+
+    /* NOTE: fake prefix bloom shares page 2 with the fake bloom */
+    init_kb_hdr(&kb);
+    omf_set_kbh_pbm_doff_pg(kb.kb_hdr, 2);
+    omf_set_kbh_pbm_dlen_pg(kb.kb_hdr, 1);
+    err = write_kb_hdr(&kb, &blkdesc);
+    ASSERT_EQ(0, err);
+
+    err = kbr_read_pbm_region_desc(&blkdesc, &pbm_desc);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(2, pbm_desc.bd_first_page);
+    ASSERT_EQ(1, pbm_desc.bd_n_pages);
+    ASSERT_EQ(BLOOM_OMF_VERSION5, pbm_desc.bd_version);
+    ASSERT_EQ(BF_SB_WORDS, pbm_desc.bd_n_hashes);
+
+    err = kbr_read_blm_pages(&blkdesc, BLOOM_LOOKUP_BUFFER, &pbm_desc, &pbm_pages);
+    ASSERT_EQ(0, err);
+    ASSERT_NE(NULL, pbm_pages);
+    kbr_free_blm_pages(&blkdesc, BLOOM_LOOKUP_BUFFER, pbm_pages);
+
+    /* older kblocks have no prefix bloom */
+    omf_set_kbh_version(kb.kb_hdr, KBLOCK_HDR_VERSION7);
+    err = write_kb_hdr(&kb, &blkdesc);
+    ASSERT_EQ(0, err);
+
+    err = kbr_read_pbm_region_desc(&blkdesc, &pbm_desc);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(0, pbm_desc.bd_n_pages);
+
+    /* corrupt prefix bloom magic */
+    init_kb_hdr(&kb);
+    omf_set_kbh_pbm_doff_pg(kb.kb_hdr, 2);
+    omf_set_kbh_pbm_dlen_pg(kb.kb_hdr, 1);
+    omf_set_bh_magic(kb.pbm_hdr, omf_bh_magic(kb.pbm_hdr) + 1);
+    err = write_kb_hdr(&kb, &blkdesc);
+    ASSERT_EQ(0, err);
+
+    err = kbr_read_pbm_region_desc(&blkdesc, &pbm_desc);
+    ASSERT_EQ(EINVAL, merr_errno(err));
+    ASSERT_EQ(0, pbm_desc.bd_n_pages);
+
+    err = mpool_mcache_munmap(blkdesc.map);
+    ASSERT_EQ(err, 0);
+}
+
 MTF_END_UTEST_COLLECTION(kblock_reader_test)
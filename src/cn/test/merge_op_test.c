@@ -0,0 +1,241 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2015-2020 Micron Technology, Inc.  All rights reserved.
+ */
+
+#include <hse_ut/conditions.h>
+#include <hse_ut/framework.h>
+
+#include <hse_util/byteorder.h>
+#include <hse_util/string.h>
+#include <hse_util/vlb.h>
+
+#include <hse_ikvdb/merge_op.h>
+#include <hse_ikvdb/kvs_rparams.h>
+
+static void *out;
+
+static int
+setup(struct mtf_test_info *info)
+{
+    out = vlb_alloc(HSE_KVS_VLEN_MAX);
+
+    return out ? 0 : -1;
+}
+
+static int
+teardown(struct mtf_test_info *info)
+{
+    vlb_free(out, HSE_KVS_VLEN_MAX);
+
+    return 0;
+}
+
+static void
+opv_add_u64(struct merge_opv *opv, u64 seq, u64 val)
+{
+    val = cpu_to_le64(val);
+    merge_opv_add(opv, seq, &val, sizeof(val));
+}
+
+static u64
+out_u64(void)
+{
+    u64 val;
+
+    memcpy(&val, out, sizeof(val));
+
+    return le64_to_cpu(val);
+}
+
+/* Reverse the base and prepend the operand. */
+static int
+user_fn(
+    void *      arg,
+    const void *key,
+    size_t      key_len,
+    const void *base,
+    size_t      base_len,
+    const void *operand,
+    size_t      operand_len,
+    void *      dst,
+    size_t      dst_sz,
+    size_t *    dst_len)
+{
+    size_t i;
+
+    ++*(int *)arg;
+
+    if (operand_len + base_len > dst_sz)
+        return EFBIG;
+
+    memcpy(dst, operand, operand_len);
+    for (i = 0; i < base_len; i++)
+        ((char *)dst)[operand_len + i] = ((const char *)base)[base_len - i - 1];
+
+    *dst_len = operand_len + base_len;
+
+    return 0;
+}
+
+MTF_BEGIN_UTEST_COLLECTION_PREPOST(merge_op_test, setup, teardown);
+
+MTF_DEFINE_UTEST(merge_op_test, init)
+{
+    struct kvs_rparams rp = kvs_rparams_defaults();
+    struct merge_op    mop;
+    merr_t             err;
+
+    err = merge_op_init(&mop, &rp);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(MERGE_OP_NONE, mop.mo_type);
+
+    strlcpy(rp.merge_op, "max", sizeof(rp.merge_op));
+    err = merge_op_init(&mop, &rp);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(MERGE_OP_MAX, mop.mo_type);
+
+    strlcpy(rp.merge_op, "sum", sizeof(rp.merge_op));
+    err = merge_op_init(&mop, &rp);
+    ASSERT_EQ(EINVAL, merr_errno(err));
+
+    memset(rp.merge_op, 'a', sizeof(rp.merge_op));
+    err = merge_op_init(&mop, &rp);
+    ASSERT_EQ(EINVAL, merr_errno(err));
+}
+
+MTF_DEFINE_UTEST(merge_op_test, valid)
+{
+    struct merge_op mop = { .mo_type = MERGE_OP_ADD };
+    char            buf[HSE_KVS_MERGE_LEN_MAX + 1] = { 0 };
+    int             calls = 0;
+
+    ASSERT_EQ(0, merge_op_valid(&mop, buf, 8));
+    ASSERT_NE(0, merge_op_valid(&mop, buf, 4));
+
+    mop.mo_type = MERGE_OP_APPEND;
+    ASSERT_EQ(0, merge_op_valid(&mop, buf, HSE_KVS_MERGE_LEN_MAX));
+    ASSERT_NE(0, merge_op_valid(&mop, buf, HSE_KVS_MERGE_LEN_MAX + 1));
+    ASSERT_NE(0, merge_op_valid(&mop, buf, 0));
+
+    mop.mo_type = MERGE_OP_USER;
+    ASSERT_NE(0, merge_op_valid(&mop, buf, 1));
+
+    mop.mo_fn = user_fn;
+    mop.mo_arg = &calls;
+    ASSERT_EQ(0, merge_op_valid(&mop, buf, 1));
+
+    mop.mo_type = MERGE_OP_NONE;
+    ASSERT_NE(0, merge_op_valid(&mop, buf, 8));
+}
+
+MTF_DEFINE_UTEST(merge_op_test, fold_add_max)
+{
+    struct merge_op  mop = { .mo_type = MERGE_OP_ADD };
+    struct merge_opv opv = { 0 };
+    u64              base = cpu_to_le64(100);
+    uint             outlen;
+    merr_t           err;
+
+    opv_add_u64(&opv, 30, 7);
+    opv_add_u64(&opv, 20, -2);
+    opv_add_u64(&opv, 10, 40);
+
+    err = merge_op_fold(&mop, "k", 1, &base, sizeof(base), &opv, out, &outlen);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(sizeof(u64), outlen);
+    ASSERT_EQ(145, out_u64());
+
+    /* No value is zero */
+    err = merge_op_fold(&mop, "k", 1, NULL, 0, &opv, out, &outlen);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(45, out_u64());
+
+    mop.mo_type = MERGE_OP_MAX;
+
+    err = merge_op_fold(&mop, "k", 1, &base, sizeof(base), &opv, out, &outlen);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ((u64)-2, out_u64());
+
+    merge_opv_reset(&opv);
+    opv_add_u64(&opv, 10, 40);
+
+    err = merge_op_fold(&mop, "k", 1, &base, sizeof(base), &opv, out, &outlen);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(100, out_u64());
+
+    merge_opv_free(&opv);
+}
+
+MTF_DEFINE_UTEST(merge_op_test, fold_append)
+{
+    struct merge_op  mop = { .mo_type = MERGE_OP_APPEND };
+    struct merge_opv opv = { 0 };
+    uint             outlen;
+    merr_t           err;
+    int              i;
+
+    merge_opv_add(&opv, 3, "ghi", 3);
+    merge_opv_add(&opv, 2, "def", 3);
+
+    err = merge_op_fold(&mop, "k", 1, "abc", 3, &opv, out, &outlen);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(9, outlen);
+    ASSERT_EQ(0, memcmp(out, "abcdefghi", 9));
+
+    err = merge_op_fold(&mop, "k", 1, NULL, 0, &opv, out, &outlen);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(6, outlen);
+    ASSERT_EQ(0, memcmp(out, "defghi", 6));
+
+    /* The result may not exceed the max value length */
+    merge_opv_reset(&opv);
+    for (i = 0; i <= HSE_KVS_VLEN_MAX / HSE_KVS_MERGE_LEN_MAX; i++) {
+        err = merge_opv_add(&opv, 100000 - i, out, HSE_KVS_MERGE_LEN_MAX);
+        ASSERT_EQ(0, err);
+    }
+
+    err = merge_op_fold(&mop, "k", 1, NULL, 0, &opv, out, &outlen);
+    ASSERT_EQ(EFBIG, merr_errno(err));
+
+    merge_opv_free(&opv);
+}
+
+MTF_DEFINE_UTEST(merge_op_test, fold_user)
+{
+    struct merge_op  mop = { .mo_type = MERGE_OP_USER };
+    struct merge_opv opv = { 0 };
+    uint             outlen;
+    merr_t           err;
+    int              calls = 0;
+
+    merge_opv_add(&opv, 3, "3", 1);
+    merge_opv_add(&opv, 2, "2", 1);
+    merge_opv_add(&opv, 1, "1", 1);
+
+    /* No merge function */
+    err = merge_op_fold(&mop, "k", 1, "ab", 2, &opv, out, &outlen);
+    ASSERT_EQ(EINVAL, merr_errno(err));
+
+    mop.mo_fn = user_fn;
+    mop.mo_arg = &calls;
+
+    /* "ab" -> "1ba" -> "2ab1" -> "31ba2" */
+    err = merge_op_fold(&mop, "k", 1, "ab", 2, &opv, out, &outlen);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(3, calls);
+    ASSERT_EQ(5, outlen);
+    ASSERT_EQ(0, memcmp(out, "31ba2", 5));
+
+    merge_opv_reset(&opv);
+    merge_opv_add(&opv, 1, "1", 1);
+
+    err = merge_op_fold(&mop, "k", 1, NULL, 0, &opv, out, &outlen);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(1, outlen);
+    ASSERT_EQ(0, memcmp(out, "1", 1));
+
+    merge_opv_free(&opv);
+}
+
+MTF_END_UTEST_COLLECTION(merge_op_test);
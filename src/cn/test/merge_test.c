@@ -745,6 +745,9 @@ _kvset_builder_add_val_internal(
             case vtype_ival:
                 tag = "i";
                 break;
+            case vtype_mop:
+                tag = "m";
+                break;
             case vtype_tomb:
                 tag = "t";
                 break;
@@ -952,6 +955,7 @@ _kvset_iter_next_vref(
             *vlen_out = nth_val;
             break;
         case vtype_ival:
+        case vtype_mop:
         case vtype_zval:
         case vtype_tomb:
         case vtype_ptomb:
@@ -1020,6 +1024,7 @@ _kvset_iter_next_val(
             *vdata_out = (void *)vdata;
             return 0;
         case vtype_ival:
+        case vtype_mop:
             return 0;
         case vtype_zval:
             *vdata_out = 0;
@@ -290,6 +290,23 @@ _kvset_get_dgen(struct kvset *kvset)
     return mk->dgen;
 }
 
+static bool
+_kvset_get_fences(struct kvset *kvset, u64 *lov, u64 *hiv, struct kvset_bloom *blmv)
+{
+    struct mock_kvset *mk = (void *)kvset;
+    u32                i;
+
+    /* Mock kvsets have no keys to fence, so make every lookup visit them.
+     */
+    for (i = 0; i < mk->stats.kst_kblks; i++) {
+        lov[i] = 0;
+        hiv[i] = U64_MAX;
+        memset(blmv + i, 0, sizeof(*blmv));
+    }
+
+    return false;
+}
+
 static u64
 _kvset_get_nth_kblock_id(struct kvset *kvset, u32 index)
 {
@@ -651,7 +668,9 @@ mock_kvset_set(void)
     mock_kvset_unset();
 
     mapi_inject(mapi_idx_kvset_kblk_start, 0);
+    mapi_inject(mapi_idx_kvset_pfx_filter_miss, 0);
     mapi_inject(mapi_idx_kvset_get_scatter_score, 10);
+    mapi_inject(mapi_idx_kvset_get_rtombs, 0);
 
     MOCK_SET(kvset, _kvset_create);
     MOCK_SET(kvset, _kvset_get_nth_vblock_len);
@@ -667,6 +686,7 @@ mock_kvset_set(void)
     MOCK_SET(kvset, _kvset_iter_next_key);
     MOCK_SET(kvset, _kvset_iter_next_val);
     MOCK_SET(kvset, _kvset_iter_next_vref);
+    MOCK_SET(kvset, _kvset_get_fences);
 
     MOCK_SET(kvset_view, _kvset_get_dgen);
     MOCK_SET(kvset_view, _kvset_get_num_kblocks);
@@ -693,6 +713,7 @@ mock_kvset_unset(void)
     MOCK_UNSET(kvset, _kvset_iter_next_key);
     MOCK_UNSET(kvset, _kvset_iter_next_val);
     MOCK_UNSET(kvset, _kvset_iter_next_vref);
+    MOCK_UNSET(kvset, _kvset_get_fences);
 
     MOCK_UNSET(kvset_view, _kvset_get_num_kblocks);
     MOCK_UNSET(kvset_view, _kvset_get_nth_kblock_id);
@@ -60,6 +60,18 @@ _kvset_builder_add_nonval(struct kvset_builder *self, u64 seq, enum kmd_vtype vt
     return 0;
 }
 
+static merr_t
+_kvset_builder_add_rtomb(struct kvset_builder *self, const struct rtomb *rt)
+{
+    return 0;
+}
+
+static merr_t
+_kvset_builder_add_mop(struct kvset_builder *self, u64 seq, const void *vdata, uint vlen)
+{
+    return 0;
+}
+
 static merr_t
 _kvset_builder_add_vref(struct kvset_builder *self, u64 seq,
     uint vbidx, uint vboff, uint vlen, uint complen)
@@ -67,6 +79,25 @@ _kvset_builder_add_vref(struct kvset_builder *self, u64 seq,
     return 0;
 }
 
+static merr_t
+_kvset_builder_add_val_expiry(
+    struct kvset_builder *  self,
+    u64                     seq,
+    const void *            vdata,
+    uint                    vlen,
+    uint                    complen,
+    u64                     expiry)
+{
+    return 0;
+}
+
+static merr_t
+_kvset_builder_add_vref_expiry(struct kvset_builder *self, u64 seq,
+    uint vbidx, uint vboff, uint vlen, uint complen, u64 expiry)
+{
+    return 0;
+}
+
 static merr_t
 _kvset_builder_get_mblocks(struct kvset_builder *bld, struct kvset_mblocks *mblks)
 {
@@ -86,7 +117,11 @@ mock_kvset_builder_unset(void)
     MOCK_UNSET(kvset_builder, _kvset_builder_add_key);
     MOCK_UNSET(kvset_builder, _kvset_builder_add_val);
     MOCK_UNSET(kvset_builder, _kvset_builder_add_nonval);
+    MOCK_UNSET(kvset_builder, _kvset_builder_add_rtomb);
+    MOCK_UNSET(kvset_builder, _kvset_builder_add_mop);
     MOCK_UNSET(kvset_builder, _kvset_builder_add_vref);
+    MOCK_UNSET(kvset_builder, _kvset_builder_add_val_expiry);
+    MOCK_UNSET(kvset_builder, _kvset_builder_add_vref_expiry);
     MOCK_UNSET(kvset_builder, _kvset_builder_get_mblocks);
     MOCK_UNSET(kvset_builder, _kvset_builder_set_agegroup);
     MOCK_UNSET(kvset_builder, _kvset_builder_destroy);
@@ -102,7 +137,11 @@ mock_kvset_builder_set(void)
     MOCK_SET(kvset_builder, _kvset_builder_add_key);
     MOCK_SET(kvset_builder, _kvset_builder_add_val);
     MOCK_SET(kvset_builder, _kvset_builder_add_nonval);
+    MOCK_SET(kvset_builder, _kvset_builder_add_rtomb);
+    MOCK_SET(kvset_builder, _kvset_builder_add_mop);
     MOCK_SET(kvset_builder, _kvset_builder_add_vref);
+    MOCK_SET(kvset_builder, _kvset_builder_add_val_expiry);
+    MOCK_SET(kvset_builder, _kvset_builder_add_vref_expiry);
     MOCK_SET(kvset_builder, _kvset_builder_get_mblocks);
     MOCK_SET(kvset_builder, _kvset_builder_set_agegroup);
     MOCK_SET(kvset_builder, _kvset_builder_destroy);
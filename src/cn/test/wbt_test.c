@@ -283,7 +283,7 @@ tree_construct(struct mtf_test_info *lcl_ti, void **tree_out, struct wbt_hdr_omf
         bool           added;
 
         key2kobj(&ko, k->kdata, k->klen);
-        kmd_add_zval(kmd, &kmd_used, 1);
+        kmd_add_zval(kmd, &kmd_used, 1, 0);
         wbb_add_entry(wbb, &ko, 1, kmd, kmd_used, max_pgc, &wbt_pgc, &added);
         ASSERT_TRUE_RET(added, 1);
         kmd_used = 0;
@@ -690,4 +690,179 @@ MTF_DEFINE_UTEST_PREPOST(wbt_test, skip_keys, pre_test, post_test)
     free(ql.buf);
 }
 
+/* Check that every leaf with few enough keys carries a hash index and
+ * that the index maps each of the leaf's keys to its entry.
+ */
+int
+hidx_verify(struct mtf_test_info *lcl_ti, void *tree, struct wbt_hdr_omf *hdr, uint *nidx)
+{
+    uint i, j;
+
+    *nidx = 0;
+
+    for (i = 0; i < omf_wbt_leaf_cnt(hdr); i++) {
+        void *      node = tree + PAGE_SIZE * (omf_wbt_leaf(hdr) + i);
+        uint        nkeys = omf_wbn_num_keys(node);
+        uint        nbkts = omf_wbn_hidx_nbkts(node);
+        const void *kdata;
+        uint        klen;
+
+        ASSERT_EQ_RET(WBT_LFE_NODE_MAGIC, omf_wbn_magic(node), 1);
+        ASSERT_EQ_RET(wbt_hidx_nbkts(nkeys), nbkts, 1);
+        if (!nbkts)
+            continue;
+
+        for (j = 0; j < nkeys; j++) {
+            wbt_lfe_key(node, wbt_lfe(node, j), &kdata, &klen);
+            ASSERT_EQ_RET(j, wbt_hidx_lookup(node, nbkts, kdata, klen), 1);
+        }
+
+        ++*nidx;
+    }
+
+    return 0;
+}
+
+void
+hidx_test(struct mtf_test_info *lcl_ti, struct key_list *ql, bool indexed)
+{
+    struct wbt_hdr_omf hdr;
+    void *             tree = NULL;
+    uint               nidx;
+    int                rc;
+
+    rc = tree_construct(lcl_ti, &tree, &hdr);
+    ASSERT_EQ(0, rc);
+
+    rc = hidx_verify(lcl_ti, tree, &hdr, &nidx);
+    ASSERT_EQ(0, rc);
+    if (indexed)
+        ASSERT_EQ(omf_wbt_leaf_cnt(&hdr), nidx);
+    else
+        ASSERT_LT(nidx, omf_wbt_leaf_cnt(&hdr));
+
+    /* Point gets of present and absent keys, with and without the index. */
+    rc = get_verify(lcl_ti, tree, &hdr, ql);
+    ASSERT_EQ(0, rc);
+
+    rc = cursor_verify(lcl_ti, tree, &hdr, ql, false);
+    ASSERT_EQ(0, rc);
+
+    free(tree);
+}
+
+MTF_DEFINE_UTEST_PREPOST(wbt_test, leaf_hash_index, pre_test, post_test)
+{
+    int             i;
+    char            buf[32];
+    size_t          klen = 24;
+    struct key_list ql = { 0 }; /* query list */
+
+    memset(buf, 0xfe, sizeof(buf));
+    ql.bufsz = BUF_SIZE;
+    ql.buf = malloc(ql.bufsz);
+    ASSERT_NE(NULL, ql.buf);
+
+    for (i = 0; i < 20 * 1000; i++) {
+        bool added;
+
+        snprintf(buf, sizeof(buf), "hidx-%07d", i);
+
+        /* Query every key, but add only every third key to the wbtree */
+        if (i % 3 == 0) {
+            added = add_key(&key_list, buf, klen);
+            ASSERT_TRUE(added);
+            added = reft_insert(buf, klen);
+            ASSERT_TRUE(added);
+        }
+
+        added = add_key(&ql, buf, klen);
+        ASSERT_TRUE(added);
+    }
+
+    /* Keys that are prefixes of, or extend, the keys in the tree. */
+    add_key(&ql, "hidx-", 5);
+    add_key(&ql, "hidx-0000000", 12);
+    add_key(&ql, "hidx-00000000", 13);
+    add_key(&ql, "hidx-9", 6);
+
+    hidx_test(lcl_ti, &ql, true);
+
+    free(ql.buf);
+}
+
+MTF_DEFINE_UTEST_PREPOST(wbt_test, leaf_hash_index_tiny_keys, pre_test, post_test)
+{
+    int             i;
+    unsigned char   buf[2];
+    struct key_list ql = { 0 }; /* query list */
+
+    ql.bufsz = BUF_SIZE;
+    ql.buf = malloc(ql.bufsz);
+    ASSERT_NE(NULL, ql.buf);
+
+    /* Leaves of 2-byte keys hold more keys than the hash index can
+     * address, so lookups in all but the last leaf fall back to the
+     * binary search.
+     */
+    for (i = 0; i < 16 * 1024; i++) {
+        bool added;
+
+        buf[0] = i >> 8;
+        buf[1] = i & 0xff;
+
+        if (i % 2 == 0) {
+            added = add_key(&key_list, buf, sizeof(buf));
+            ASSERT_TRUE(added);
+            added = reft_insert(buf, sizeof(buf));
+            ASSERT_TRUE(added);
+        }
+
+        added = add_key(&ql, buf, sizeof(buf));
+        ASSERT_TRUE(added);
+    }
+
+    hidx_test(lcl_ti, &ql, false);
+
+    free(ql.buf);
+}
+
+MTF_DEFINE_UTEST(wbt_test, kmd_expiry)
+{
+    struct kvs_vtuple_ref vref;
+    char                  kmd[KMD_MAX_ENCODED_ENTRY_LEN * 3];
+    size_t                off = 0, end;
+    u64                   seq, expiry = 1600000000;
+
+    kmd_add_val(kmd, &off, 30, expiry, 1, 4096, 1000);
+    kmd_add_tomb(kmd, &off, 20);
+    kmd_add_zval(kmd, &off, 10, 0);
+    ASSERT_LE(off, sizeof(kmd));
+    end = off;
+    off = 0;
+
+    wbt_read_kmd_vref(kmd, &off, &seq, &vref);
+    ASSERT_EQ(30, seq);
+    ASSERT_EQ(vtype_val, vref.vr_type);
+    ASSERT_EQ(expiry, vref.vr_expiry);
+    ASSERT_EQ(1, vref.vb.vr_index);
+    ASSERT_EQ(4096, vref.vb.vr_off);
+    ASSERT_EQ(1000, vref.vb.vr_len);
+
+    wbt_read_kmd_vref(kmd, &off, &seq, &vref);
+    ASSERT_EQ(20, seq);
+    ASSERT_EQ(vtype_tomb, vref.vr_type);
+    ASSERT_EQ(0, vref.vr_expiry);
+
+    wbt_read_kmd_vref(kmd, &off, &seq, &vref);
+    ASSERT_EQ(10, seq);
+    ASSERT_EQ(vtype_zval, vref.vr_type);
+    ASSERT_EQ(0, vref.vr_expiry);
+    ASSERT_EQ(end, off);
+
+    ASSERT_TRUE(kvs_expired_at(expiry, expiry));
+    ASSERT_FALSE(kvs_expired_at(expiry, expiry - 1));
+    ASSERT_FALSE(kvs_expired_at(0, expiry));
+}
+
 MTF_END_UTEST_COLLECTION(wbt_test)
@@ -234,15 +234,20 @@ wbt_leaf_publish(struct wbb *wbb)
 {
     struct wbt_node_hdr_omf *node_hdr = wbb->cnode;
 
-    size_t              pfx_len = wbb->cnode_pfx_len;
-    struct wbt_lfe_omf *entry; /* (out) current key entry ptr */
-    void *              sfxp;  /* (out) current suffix ptr */
-    int                 i;
+    size_t               pfx_len = wbb->cnode_pfx_len;
+    struct wbt_lfe_omf * entry; /* (out) current key entry ptr */
+    void *               sfxp;  /* (out) current suffix ptr */
+    struct wbt_hidx_omf *hidx;  /* (out) leaf hash index */
+    uint                 nbkts;
+    int                  i;
 
     struct key_stage_entry_leaf *kin = wbb->cnode_key_stage;
 
+    nbkts = wbt_hidx_nbkts(wbb->cnode_nkeys);
+
     omf_set_wbn_num_keys(node_hdr, wbb->cnode_nkeys);
     omf_set_wbn_pfx_len(node_hdr, pfx_len);
+    omf_set_wbn_hidx_nbkts(node_hdr, nbkts);
 
     /* Use the first key to write out the prefix. */
     if (pfx_len) {
@@ -255,12 +260,16 @@ wbt_leaf_publish(struct wbb *wbb)
     entry = wbb->cnode + sizeof(*node_hdr) + pfx_len;
     sfxp = wbb->cnode + PAGE_SIZE;
 
+    /* The hash index (if any) follows the last LFE. */
+    hidx = (void *)(entry + wbb->cnode_nkeys);
+    memset(hidx, WBT_HIDX_EMPTY, nbkts * sizeof(*hidx));
+
     for (i = 0; i < wbb->cnode_nkeys; i++) {
         u16  sfx_len = kin->klen - pfx_len;
         uint key_extra = kin->kmd_off < U16_MAX ? 0 : 4;
 
         sfxp -= sfx_len + key_extra;
-        assert((void *)entry < sfxp);
+        assert((void *)(hidx + nbkts) <= sfxp);
 
         if (key_extra) {
             /* kmdoff is too large for u16 */
@@ -276,6 +285,17 @@ wbt_leaf_publish(struct wbb *wbb)
         memcpy(sfxp + key_extra, kin->kdata + pfx_len, sfx_len);
         omf_set_lfe_koff(entry, sfxp - wbb->cnode);
 
+        if (nbkts) {
+            u64  hash = hse_hash64(kin->kdata + pfx_len, sfx_len);
+            uint bkt = wbt_hidx_bkt(hash, nbkts);
+
+            while (omf_hix_idx(hidx + bkt) != WBT_HIDX_EMPTY)
+                bkt = (bkt + 1 < nbkts) ? bkt + 1 : 0;
+
+            omf_set_hix_fp(hidx + bkt, wbt_hidx_fp(hash));
+            omf_set_hix_idx(hidx + bkt, i);
+        }
+
         /* Store last key. */
         wbb->wbt_last_kobj.ko_pfx = wbb->cnode + sizeof(*node_hdr);
         wbb->wbt_last_kobj.ko_pfx_len = pfx_len;
@@ -362,7 +382,8 @@ wbb_add_entry(
     /* Create a new node if space exceeds PAGE_SIZE */
     space = sizeof(struct wbt_node_hdr_omf) + new_pfx_len +
             ((wbb->cnode_nkeys + 1) * sizeof(struct wbt_lfe_omf)) + wbb->cnode_sumlen +
-            (sizeof(u32) * wbb->cnode_key_extra_cnt) - ((wbb->cnode_nkeys + 1) * new_pfx_len);
+            (sizeof(u32) * wbb->cnode_key_extra_cnt) - ((wbb->cnode_nkeys + 1) * new_pfx_len) +
+            (wbt_hidx_nbkts(wbb->cnode_nkeys + 1) * sizeof(struct wbt_hidx_omf));
 
     if (space > PAGE_SIZE) {
 
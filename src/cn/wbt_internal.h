@@ -10,11 +10,13 @@
 
 #include <hse_util/inttypes.h>
 #include <hse_util/byteorder.h>
+#include <hse_util/hash.h>
+#include <hse_util/keycmp.h>
 
 #include "omf.h"
 
 /*
- * Current version - Version 5
+ * Current version - Version 5 (v6 and v7 share the node layout)
  */
 
 static __always_inline struct wbt_lfe_omf *
@@ -66,6 +68,81 @@ wbt_lfe_kmd(void *node, struct wbt_lfe_omf *lfe)
     return omf_wbn_kmd(node) + kmd_off;
 }
 
+/*
+ * Leaf hash index (v7)
+ *
+ * Leaves with at most WBT_HIDX_KEYS_MAX keys carry an open addressing table
+ * of wbt_hidx_nbkts() buckets right after their LFEs.  Each key's suffix
+ * (the key less the node prefix) is hashed, the upper half of the hash picks
+ * the home bucket, and collisions are resolved by linear probing.  There is
+ * always at least one empty bucket, so a probe sequence always terminates.
+ */
+#define WBT_HIDX_KEYS_MAX (WBT_HIDX_EMPTY)
+
+static __always_inline uint
+wbt_hidx_nbkts(uint nkeys)
+{
+    return nkeys <= WBT_HIDX_KEYS_MAX ? nkeys + nkeys / 2 + 1 : 0;
+}
+
+static __always_inline struct wbt_hidx_omf *
+wbt_hidx(void *node)
+{
+    return (void *)wbt_lfe(node, omf_wbn_num_keys(node));
+}
+
+static __always_inline uint
+wbt_hidx_bkt(u64 hash, uint nbkts)
+{
+    return ((hash >> 32) * nbkts) >> 32;
+}
+
+static __always_inline u8
+wbt_hidx_fp(u64 hash)
+{
+    return hash & 0xff;
+}
+
+/**
+ * wbt_hidx_lookup() - find a key in a leaf node's hash index
+ * @node:    leaf node
+ * @nbkts:   number of buckets in the node's hash index (non-zero)
+ * @sfx:     key less the node prefix
+ * @sfx_len: length of @sfx
+ *
+ * Return: index of the matching LFE, or -1 if the key is not in the node.
+ */
+static __always_inline int
+wbt_hidx_lookup(void *node, uint nbkts, const void *sfx, uint sfx_len)
+{
+    struct wbt_hidx_omf *hidx = wbt_hidx(node);
+    u64                  hash = hse_hash64(sfx, sfx_len);
+    uint                 bkt = wbt_hidx_bkt(hash, nbkts);
+    u8                   fp = wbt_hidx_fp(hash);
+    uint                 i;
+
+    for (i = 0; i < nbkts; ++i) {
+        const void *kdata;
+        uint        klen;
+        uint        idx;
+
+        idx = omf_hix_idx(hidx + bkt);
+        if (idx == WBT_HIDX_EMPTY)
+            break;
+
+        if (omf_hix_fp(hidx + bkt) == fp) {
+            wbt_lfe_key(node, wbt_lfe(node, idx), &kdata, &klen);
+            if (!keycmp(sfx, sfx_len, kdata, klen))
+                return idx;
+        }
+
+        if (++bkt == nbkts)
+            bkt = 0;
+    }
+
+    return -1;
+}
+
 static __always_inline struct wbt_ine_omf *
 wbt_ine(void *node, int nth)
 {
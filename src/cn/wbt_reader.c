@@ -41,7 +41,7 @@ wbt_read_kmd_vref(const void *kmd, size_t *off, u64 *seq, struct kvs_vtuple_ref
     uint           complen = 0;
     const void *   vdata = 0;
 
-    kmd_type_seq(kmd, off, &vtype, seq);
+    kmd_type_seq_expiry(kmd, off, &vtype, seq, &vref->vr_expiry);
 
     switch (vtype) {
         case vtype_val:
@@ -68,6 +68,7 @@ wbt_read_kmd_vref(const void *kmd, size_t *off, u64 *seq, struct kvs_vtuple_ref
             vref->vb.vr_complen = complen;
             break;
         case vtype_ival:
+        case vtype_mop:
             kmd_ival(kmd, off, &vdata, &vlen);
             /* assert no truncation */
             assert(vlen <= U32_MAX);
@@ -87,6 +88,7 @@ bool
 wbti_seek(struct wbti *self, struct kvs_ktuple *seek)
 {
     switch (self->wbd->wbd_version) {
+        case WBT_TREE_VERSION7:
         case WBT_TREE_VERSION6:
         case WBT_TREE_VERSION5:
             return wbti5_seek(self, seek);
@@ -102,6 +104,7 @@ bool
 wbti_next(struct wbti *self, const void **kdata, uint *klen, const void **kmd)
 {
     switch (self->wbd->wbd_version) {
+        case WBT_TREE_VERSION7:
         case WBT_TREE_VERSION6:
         case WBT_TREE_VERSION5:
             return wbti5_next(self, kdata, klen, kmd);
@@ -123,6 +126,7 @@ wbti_reset(
     bool                  cache)
 {
     switch (desc->wbd_version) {
+        case WBT_TREE_VERSION7:
         case WBT_TREE_VERSION6:
         case WBT_TREE_VERSION5:
             wbti5_reset(self, kbd, desc, seek, reverse, cache);
@@ -180,6 +184,7 @@ void
 wbti_prefix(struct wbti *self, const void **pfx, uint *pfx_len)
 {
     switch (self->wbd->wbd_version) {
+        case WBT_TREE_VERSION7:
         case WBT_TREE_VERSION6:
         case WBT_TREE_VERSION5:
             wbt_node_pfx(self->node, pfx, pfx_len);
@@ -202,6 +207,7 @@ wbtr_read_vref(
     struct kvs_vtuple_ref *     vref)
 {
     switch (wbd->wbd_version) {
+        case WBT_TREE_VERSION7:
         case WBT_TREE_VERSION6:
         case WBT_TREE_VERSION5:
             return wbtr5_read_vref(kbd, wbd, kt, lcp, seq, lookup_res, vref);
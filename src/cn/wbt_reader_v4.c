@@ -522,6 +522,8 @@ wbtr4_read_vref(
                         *lookup_res = FOUND_TMB;
                     else if (vref->vr_type == vtype_ptomb)
                         *lookup_res = FOUND_PTMB;
+                    else if (vref->vr_type == vtype_mop)
+                        *lookup_res = FOUND_MOP;
                     else
                         *lookup_res = FOUND_VAL;
 
@@ -683,8 +683,12 @@ wbtr5_read_vref(
     int                      first, last;
     size_t                   pg;
     const void *             kdata, *kt_data;
-    uint                     klen, kt_len;
+    uint                     klen, kt_len, nbkts;
     struct wbt_lfe_omf *     lfe;
+    void *                   kmd;
+    size_t                   off;
+    u64                      vseq;
+    uint                     nvals;
 
     const void *node_pfx;
     uint        node_pfx_len;
@@ -716,12 +720,26 @@ wbtr5_read_vref(
     if (cmp)
         goto done; /* prefix didn't match; key not found */
 
-    /* prefetch first node in binary search */
-    __builtin_prefetch(wbt_lfe(node, (first + last) / 2));
-
     kt_data += node_pfx_len;
     kt_len -= node_pfx_len;
 
+    /* v7 leaves may carry a hash index, which finds the key (or
+     * proves its absence) without a binary search.  Older versions
+     * made no promise about the contents of the header's padding.
+     */
+    nbkts = wbd->wbd_version < WBT_TREE_VERSION7 ? 0 : omf_wbn_hidx_nbkts(node);
+    if (nbkts) {
+        j = wbt_hidx_lookup(node, nbkts, kt_data, kt_len);
+        if (j < 0)
+            goto done;
+
+        lfe = wbt_lfe(node, j);
+        goto found;
+    }
+
+    /* prefetch first node in binary search */
+    __builtin_prefetch(wbt_lfe(node, (first + last) / 2));
+
     while (first <= last) {
         j = (first + last) / 2;
         lfe = wbt_lfe(node, j);
@@ -732,37 +750,36 @@ wbtr5_read_vref(
             last = j - 1;
         else if (cmp > 0)
             first = j + 1;
-        else {
-            /* Found key */
-            void * kmd;
-            size_t off;
-            u64    vseq;
-            uint   nvals;
-
-            kmd = kbd->map_base + PAGE_SIZE * (wbd->wbd_first_page + wbd->wbd_root + 1);
-
-            off = wbt_lfe_kmd(node, lfe);
-            assert(off < wbd->wbd_kmd_pgc * PAGE_SIZE);
-            nvals = kmd_count(kmd, &off);
-            assert(nvals > 0);
-            while (nvals--) {
-                wbt_read_kmd_vref(kmd, &off, &vseq, vref);
-                assert(off <= wbd->wbd_kmd_pgc * PAGE_SIZE);
-                if (seq >= vseq) {
-                    vref->vr_seq = vseq;
-                    if (vref->vr_type == vtype_tomb)
-                        *lookup_res = FOUND_TMB;
-                    else if (vref->vr_type == vtype_ptomb)
-                        *lookup_res = FOUND_PTMB;
-                    else
-                        *lookup_res = FOUND_VAL;
-
-                    return 0;
-                }
-            }
-            break;
+        else
+            goto found;
+    }
+    goto done;
+
+found:
+    kmd = kbd->map_base + PAGE_SIZE * (wbd->wbd_first_page + wbd->wbd_root + 1);
+
+    off = wbt_lfe_kmd(node, lfe);
+    assert(off < wbd->wbd_kmd_pgc * PAGE_SIZE);
+    nvals = kmd_count(kmd, &off);
+    assert(nvals > 0);
+    while (nvals--) {
+        wbt_read_kmd_vref(kmd, &off, &vseq, vref);
+        assert(off <= wbd->wbd_kmd_pgc * PAGE_SIZE);
+        if (seq >= vseq) {
+            vref->vr_seq = vseq;
+            if (vref->vr_type == vtype_tomb)
+                *lookup_res = FOUND_TMB;
+            else if (vref->vr_type == vtype_ptomb)
+                *lookup_res = FOUND_PTMB;
+            else if (vref->vr_type == vtype_mop)
+                *lookup_res = FOUND_MOP;
+            else
+                *lookup_res = FOUND_VAL;
+
+            return 0;
         }
     }
+
 done:
     /* Not finding the key is *not* an error. */
     *lookup_res = NOT_FOUND;
@@ -29,6 +29,7 @@ struct cn;
 struct query_ctx;
 struct kvdb_ctxn;
 struct kc_filter;
+struct kvs_vcache;
 
 struct mpool;
 
@@ -136,6 +137,52 @@ c0_get(
     enum key_lookup_res *    res,
     struct kvs_buf *         vbuf);
 
+/**
+ * c0_miss_lookup() - check whether a key is known to be absent
+ * @self:  Instance of struct c0 to query
+ * @key:   Key (or prefix, if @probe is true)
+ * @probe: true for a prefix probe, false for a get
+ *
+ * Return: %true if a previous non-transaction lookup of @key found
+ * nothing and nothing has been written to it since.
+ */
+/* MTF_MOCK */
+bool
+c0_miss_lookup(struct c0 *self, const struct kvs_ktuple *key, bool probe);
+
+/**
+ * c0_miss_insert() - remember that a non-transaction lookup found nothing
+ * @self:  Instance of struct c0 that was queried
+ * @key:   Key (or prefix, if @probe is true)
+ * @probe: true for a prefix probe, false for a get
+ * @view:  view seqno of the lookup
+ */
+/* MTF_MOCK */
+void
+c0_miss_insert(struct c0 *self, const struct kvs_ktuple *key, bool probe, u64 view);
+
+/**
+ * c0_vcache_set() - register the value cache of the kvs with c0sk
+ * @self: Instance of struct c0
+ * @vc:   Value cache, or NULL to unregister
+ */
+/* MTF_MOCK */
+void
+c0_vcache_set(struct c0 *self, struct kvs_vcache *vc);
+
+/**
+ * c0_vcache_insert() - cache a value that a non-transaction get read from cN
+ * @self: Instance of struct c0 that was queried
+ * @key:  Key (kt_hash must be valid)
+ * @view: View seqno of the lookup
+ * @vbuf: Value as returned by cn_get()
+ *
+ * Return: The number of entries evicted to make room for the value.
+ */
+/* MTF_MOCK */
+uint
+c0_vcache_insert(struct c0 *self, struct kvs_ktuple *key, u64 view, struct kvs_buf *vbuf);
+
 /**
  * c0_del() - delete any value associated with the given key
  * @self:      Instance of struct c0 from which to delete
@@ -171,6 +218,19 @@ c0_pfx_probe(
 merr_t
 c0_prefix_del(struct c0 *self, struct kvs_ktuple *key, u64 seqno);
 
+/**
+ * c0_range_del() - delete all keys in the range [start, end)
+ * @self:      Instance of struct c0 from which to delete
+ * @start:     first key in the range
+ * @end:       end of the range (exclusive)
+ * @seqno:     (output) seqno assigned to the range delete
+ *
+ * Return: [HSE_REVISIT]
+ */
+/* MTF_MOCK */
+merr_t
+c0_range_del(struct c0 *self, struct kvs_ktuple *start, struct kvs_ktuple *end, u64 *seqno);
+
 /**
  * c0_sync() - force ingest of existing c0 data and waits until ingest complete
  * @self:      Instance of struct c0 to flush
@@ -242,6 +302,21 @@ c0_cursor_seek(
 merr_t
 c0_cursor_read(struct c0_cursor *c0cur, struct kvs_kvtuple *kvt, bool *eof);
 
+/**
+ * c0_cursor_rtomb_lookup() - check a key against range tombstones in c0
+ * @c0cur:     Instance of struct c0_cursor
+ * @key:       key to check
+ * @klen:      length of @key
+ *
+ * Since everything in c0 is newer than cn, a cn key for which this
+ * returns non-zero is deleted.
+ *
+ * Return: seqno of the covering range tombstone, or zero if none
+ */
+/* MTF_MOCK */
+u64
+c0_cursor_rtomb_lookup(struct c0_cursor *c0cur, const void *key, u32 klen);
+
 /**
  * c0_cursor_update() - update existing iterators over c0
  * @c0cur:      Instance of struct c0_cursor
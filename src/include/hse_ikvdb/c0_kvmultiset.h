@@ -9,6 +9,7 @@
 #include <hse_ikvdb/kvs.h>
 #include <hse_ikvdb/c0_kvset.h>
 #include <hse_ikvdb/throttle.h>
+#include <hse_ikvdb/rtomb.h>
 
 #include <hse_util/inttypes.h>
 #include <hse_util/hse_err.h>
@@ -38,6 +39,20 @@ struct c0_kvmultiset {
     struct list_head     c0ms_rcu;
 };
 
+/**
+ * struct c0_rtomb - range tombstone in a c0_kvmultiset
+ * @c0rt_next:   next older range tombstone in the kvms
+ * @c0rt_rt:     the range tombstone (keys point into @c0rt_keys)
+ * @c0rt_skidx:  index of the kvs to which the range tombstone applies
+ * @c0rt_keys:   start key immediately followed by the end key
+ */
+struct c0_rtomb {
+    struct c0_rtomb *c0rt_next;
+    struct rtomb     c0rt_rt;
+    u16              c0rt_skidx;
+    char             c0rt_keys[];
+};
+
 /**
  * c0kvms_create() - allocate/initialize a struct c0_kvmultiset
  * @num_sets:        Max number of c0_kvsets to create
@@ -172,6 +187,40 @@ c0kvms_get_c0kvset(struct c0_kvmultiset *mset, u32 index);
 void
 c0kvms_finalize(struct c0_kvmultiset *mset, struct workqueue_struct *wq);
 
+/**
+ * c0kvms_index_build() - index the c0kvsets of a finalized kvms
+ * @mset:  struct c0_kvmultiset
+ * @wq:    workqueue on which to build the indexes
+ *
+ * Builds a wide-node lookup index for each c0kvset asynchronously, to
+ * speed up gets that search the kvms while it awaits and undergoes ingest.
+ * Holds a reference on the kvms until done.
+ */
+void
+c0kvms_index_build(struct c0_kvmultiset *mset, struct workqueue_struct *wq);
+
+/**
+ * c0kvms_numa_bind() - spread the kvms' c0kvsets across NUMA nodes
+ * @mset:  struct c0_kvmultiset
+ * @nodec: number of NUMA nodes
+ *
+ * Binds the memory of each hashed c0kvset to one of %nodec nodes,
+ * round-robin, so that the kvms as a whole is interleaved across nodes
+ * at c0kvset granularity.  The ptomb c0kvset is left unbound.
+ */
+void
+c0kvms_numa_bind(struct c0_kvmultiset *mset, uint nodec);
+
+/**
+ * c0kvms_pfx_dedup() - store key prefixes once per c0kvset
+ * @mset:     struct c0_kvmultiset
+ * @pfx_lenv: prefix length of each kvs, indexed by skidx
+ *
+ * See c0kvs_pfx_dedup().  The ptomb c0kvset is left alone.
+ */
+void
+c0kvms_pfx_dedup(struct c0_kvmultiset *mset, const u8 *pfx_lenv);
+
 /**
  * c0kvms_is_finalized() - return 'true' if finalized/frozen
  * @mset:  struct c0_kvmultiset
@@ -198,6 +247,52 @@ c0kvms_ingest_delay_set(struct c0_kvmultiset *mset, u64 delay);
 u64
 c0kvms_ingest_delay_get(struct c0_kvmultiset *mset);
 
+/**
+ * c0kvms_rtomb_add() - add a range tombstone to a c0_kvmultiset
+ * @mset:   struct c0_kvmultiset
+ * @skidx:  kvs index
+ * @start:  first key in the range (inclusive)
+ * @end:    end of the range (exclusive)
+ * @seqno:  (output) seqno assigned to the range tombstone
+ *
+ * Return: ENOMEM if there is no room for the range tombstone in the kvms
+ */
+merr_t
+c0kvms_rtomb_add(
+    struct c0_kvmultiset *   mset,
+    u16                      skidx,
+    const struct kvs_ktuple *start,
+    const struct kvs_ktuple *end,
+    u64 *                    seqno);
+
+/**
+ * c0kvms_rtomb_lookup() - find the newest range tombstone covering a key
+ * @mset:      struct c0_kvmultiset
+ * @skidx:     kvs index
+ * @key:       key to check
+ * @klen:      length of @key
+ * @view_seq:  ignore range tombstones newer than this seqno
+ *
+ * Return: seqno of the covering range tombstone, or zero if none
+ */
+u64
+c0kvms_rtomb_lookup(
+    struct c0_kvmultiset *mset,
+    u16                   skidx,
+    const void *          key,
+    u32                   klen,
+    u64                   view_seq);
+
+/**
+ * c0kvms_rtombs() - get the list of range tombstones in a c0_kvmultiset
+ * @mset:   struct c0_kvmultiset
+ *
+ * The list is only ever prepended to and remains valid as long as the
+ * caller holds a reference on @mset.
+ */
+struct c0_rtomb *
+c0kvms_rtombs(struct c0_kvmultiset *mset);
+
 /**
  * c0kvms_rsvd_sn_get() - get reserved seqno
  * @mset:   struct c0_kvmultiset
@@ -17,6 +17,7 @@ struct c0_kvset {
 
 struct c0kvs_ingest_ctx;
 struct c0_kvset_iterator;
+struct c0sk_batch_op;
 
 struct c0_usage {
     size_t u_alloc;
@@ -27,18 +28,22 @@ struct c0_usage {
     ulong  u_tombs;
     size_t u_keyb;
     size_t u_valb;
+    ulong  u_lockops;
+    ulong  u_lockcont;
+    u64    u_lockwait;
     int    u_count;
 };
 
 /**
  * c0kvs_reinit() - reinitialize global c0kvs state
  * @cc_max:   set max cache size (bytes)
+ * @huge:     huge page backing for new c0kvs cheaps (enum cheap_huge)
  *
  * Must be called at least once before calling c0kvs APIs.  Subsequent
  * calls are idempotent.
  */
 void
-c0kvs_reinit(size_t cc_max);
+c0kvs_reinit(size_t cc_max, uint huge);
 
 /**
  * c0kvs_init() - initialize global c0kvs state
@@ -91,6 +96,38 @@ c0kvs_create(
 void
 c0kvs_destroy(struct c0_kvset *set);
 
+/**
+ * c0kvs_numa_bind() - prefer the given NUMA node for c0kvs memory
+ * @set:        c0kvs handle
+ * @node:       NUMA node (or -1 for the local node)
+ *
+ * The binding is remembered across c0kvs cheap cache reuse, so
+ * rebinding a c0kvs to the same node is nearly free.
+ */
+void
+c0kvs_numa_bind(struct c0_kvset *set, int node);
+
+/**
+ * c0kvs_pfx_dedup() - store each distinct key prefix only once
+ * @set:        c0kvs handle
+ * @pfx_lenv:   prefix length of each kvs, indexed by skidx
+ *
+ * Subsequent puts split their keys around a copy of the first
+ * @pfx_lenv[skidx] bytes shared by all keys with that prefix.  The
+ * vector must outlive the c0kvs.  Ignored if mutations are tracked.
+ */
+void
+c0kvs_pfx_dedup(struct c0_kvset *set, const u8 *pfx_lenv);
+
+/**
+ * c0kvs_numa_node() - return the NUMA node to which the c0kvs is bound
+ * @set:        c0kvs handle
+ *
+ * Return: NUMA node, or -1 if the c0kvs is not bound
+ */
+int
+c0kvs_numa_node(struct c0_kvset *set);
+
 /**
  * c0kvs_used() - return bytes used in c0kvs cheap
  * @set:        c0kvs handle
@@ -152,6 +189,30 @@ c0kvs_put(
     const struct kvs_vtuple *value,
     uintptr_t                seqnoref);
 
+/**
+ * c0kvs_putdelv() - insert a vector of key/value pairs and tombstones
+ * @set:      Struct c0_kvset to insert into
+ * @opv:      Vector of pointers to the ops to apply, in order
+ * @opc:      Number of ops in @opv
+ * @seqnoref: Seqnoref for all ops
+ * @nputp:    (output) Number of ops from @opv that were applied
+ *
+ * Applies the ops under a single acquisition of the c0kvset mutex.
+ * The space required by the entire vector is checked up front, such
+ * that the per-op space check is only required when the c0kvset is
+ * nearly full.  Stops at the first op that fails.
+ *
+ * Return: 0 if all ops were applied, ENOMEM if the c0kvset is full,
+ * EFBIG if an op can never fit.
+ */
+merr_t
+c0kvs_putdelv(
+    struct c0_kvset *            set,
+    struct c0sk_batch_op *const *opv,
+    uint                         opc,
+    uintptr_t                    seqnoref,
+    uint *                       nputp);
+
 /**
  * c0kvs_del() - delete the key/value pair matching the given key
  * @set:   Struct c0_kvset to delete the key/value from
@@ -186,6 +247,20 @@ c0kvs_prefix_del(
     const struct kvs_ktuple *key,
     const uintptr_t          seqno);
 
+/**
+ * c0kvs_may_contain() - check the c0kvset's membership filter for a key
+ * @handle:     struct c0_kvset to check
+ * @hash:       hash of the key (kt_hash)
+ *
+ * Every key put or deleted in the c0kvset is added to a blocked bloom
+ * filter, keyed on the same hash that selects the c0kvset within its kvms.
+ *
+ * Return: false if the c0kvset definitely does not contain the key,
+ * true if it might.
+ */
+bool
+c0kvs_may_contain(struct c0_kvset *handle, u64 hash);
+
 /**
  * c0kvs_get_rcu() - given a key, retrieve a value from a struct c0_kvset
  * @handle:     Struct c0_kvset to search
@@ -373,6 +448,16 @@ c0kvs_usage(struct c0_kvset *handle, struct c0_usage *usage);
 void
 c0kvs_finalize(struct c0_kvset *set);
 
+/**
+ * c0kvs_index_build() - build a wide-node lookup index for a finalized c0kvs
+ * @set:   c0kvs handle
+ *
+ * Lookups in the c0kvs use the index once it is built (see bn_index_build()).
+ * The index is discarded when the c0kvs is reset.
+ */
+void
+c0kvs_index_build(struct c0_kvset *set);
+
 /**
  * c0kvs_iterator_init() - initialize a forward iterator
  * @set:   Struct c0_kvset to be traversed
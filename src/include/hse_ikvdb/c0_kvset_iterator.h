@@ -95,7 +95,8 @@ c0_kvset_iterator_eof(struct c0_kvset_iterator *handle);
  * be in the direction of the iterator when first initialized.
  * If the seek key is not found, the next lexicographic key in the
  * iterator direction will be used.  If @kt is not null, it will be
- * initialized to point to the key found.
+ * initialized to point to the key found, which must not be split
+ * (see c0kvs_pfx_dedup()).
  */
 void
 c0_kvset_iterator_seek(
@@ -104,6 +105,18 @@ c0_kvset_iterator_seek(
     u32                       seeklen,
     struct kvs_ktuple *       kt);
 
+/**
+ * c0_kvset_iterator_seek_skey() - move a forward iteration to a bonsai key
+ * @iter:            c0_kvset iterator
+ * @skey:            the key (including its index) to find
+ *
+ * Unlike c0_kvset_iterator_seek(), the iterator need not filter on index,
+ * and the next key is the first key greater than or equal to @skey across
+ * all indexes.
+ */
+void
+c0_kvset_iterator_seek_skey(struct c0_kvset_iterator *iter, const struct bonsai_skey *skey);
+
 /**
  * c0_kvset_iterator_skip_pfx() - move iteration past spcified pfx
  * @iter:    c0_kvset iterator
@@ -114,7 +127,7 @@ c0_kvset_iterator_seek(
  * Re-initializes the iterator to start at a key with prefix just larger than
  * @pfx.  The next key will be in the direction of the iterator when first
  * initialized.  If @kt is not null, it will be initialized to point to the
- * next key.
+ * next key, which must not be split (see c0kvs_pfx_dedup()).
  */
 void
 c0_kvset_iterator_skip_pfx(
@@ -30,6 +30,21 @@ struct c1;
 struct csched;
 struct throttle_sensor;
 struct query_ctx;
+struct kvs_vcache;
+
+/**
+ * struct c0sk_batch_op - a single put or delete applied by c0sk_putdelv()
+ * @op_kt:    key (kt_hash must be initialized)
+ * @op_vt:    value (ignored if @op_tomb is true)
+ * @op_skidx: structured key index of the target kvs
+ * @op_tomb:  true for a delete, false for a put
+ */
+struct c0sk_batch_op {
+    struct kvs_ktuple op_kt;
+    struct kvs_vtuple op_vt;
+    u16               op_skidx;
+    bool              op_tomb;
+};
 
 merr_t
 c0sk_init(void);
@@ -135,6 +150,26 @@ c0sk_put(
     const struct kvs_vtuple *value,
     u64                      seq);
 
+/**
+ * c0sk_putdelv() - apply a vector of puts and deletes to the struct c0sk
+ * @self:      Instance of struct c0sk into which to insert
+ * @opv:       Vector of operations
+ * @opc:       Number of operations in @opv
+ * @seq:       Sequence number for all operations
+ *
+ * Equivalent to calling c0sk_put() or c0sk_del() for each element of
+ * @opv in order, but the RCU read lock and each c0kvset's mutex are
+ * acquired once per pass rather than once per operation.  The batch
+ * is not atomic: on error, a subset of @opv may have been applied,
+ * but for any given key the applied operations always precede the
+ * unapplied ones.
+ *
+ * Return: 0 on success, otherwise the error of the first failed op
+ */
+/* MTF_MOCK */
+merr_t
+c0sk_putdelv(struct c0sk *self, struct c0sk_batch_op *opv, uint opc, u64 seq);
+
 /**
  * c0sk_get() - retrieve the value associated with the given key
  * @self:      Instance of struct c0sk from which to retrieve
@@ -199,6 +234,26 @@ c0sk_pfx_probe(
 merr_t
 c0sk_prefix_del(struct c0sk *self, u16 skidx, const struct kvs_ktuple *key, u64 seq);
 
+/**
+ * c0sk_range_del() - delete all keys in the range [start, end)
+ * @self:      Instance of struct c0sk from which to delete
+ * @skidx:     Structured key index
+ * @start:     First key in the range
+ * @end:       End of the range (exclusive)
+ * @seqno:     (output) Sequence number assigned to the range delete
+ *
+ * The range delete is recorded as a single range tombstone in the
+ * active kvms, which hides all older versions of the keys in the range.
+ */
+/* MTF_MOCK */
+merr_t
+c0sk_range_del(
+    struct c0sk *            self,
+    u16                      skidx,
+    const struct kvs_ktuple *start,
+    const struct kvs_ktuple *end,
+    u64 *                    seqno);
+
 /**
  * c0sk_rparams() - Get a ptr to c0sk kvdb rparams
  * @self:       Instance of struct c0sk
@@ -221,6 +276,99 @@ c0sk_rparams(struct c0sk *self);
 merr_t
 c0sk_flush(struct c0sk *self, struct c0_kvmultiset *new);
 
+/**
+ * c0sk_negc_lookup() - check the negative cache for a key or prefix
+ * @self:  c0sk handle
+ * @skidx: kvs index
+ * @kt:    key (or prefix, if @probe is true)
+ * @probe: true for a prefix probe, false for a get
+ *
+ * Return: %true if the key is known to be absent from both c0 and cN
+ * in any view at or after that of a previous miss.  Only non-transaction
+ * lookups may use the cache.
+ */
+/* MTF_MOCK */
+bool
+c0sk_negc_lookup(struct c0sk *self, u16 skidx, const struct kvs_ktuple *kt, bool probe);
+
+/**
+ * c0sk_negc_insert() - record that a lookup found nothing
+ * @self:  c0sk handle
+ * @skidx: kvs index
+ * @kt:    key (or prefix, if @probe is true)
+ * @probe: true for a prefix probe, false for a get
+ * @view:  view seqno of the lookup
+ */
+/* MTF_MOCK */
+void
+c0sk_negc_insert(
+    struct c0sk *            self,
+    u16                      skidx,
+    const struct kvs_ktuple *kt,
+    bool                     probe,
+    u64                      view);
+
+/**
+ * c0sk_vcache_set() - register the value cache of a kvs
+ * @self:  c0sk handle
+ * @skidx: kvs index
+ * @vc:    value cache, or NULL to unregister
+ *
+ * c0sk invalidates entries of the cache as keys are written to the kvs.
+ * The caller must wait for an RCU grace period after unregistering a
+ * cache before destroying it.
+ */
+/* MTF_MOCK */
+void
+c0sk_vcache_set(struct c0sk *self, u16 skidx, struct kvs_vcache *vc);
+
+/**
+ * c0sk_vcache_insert() - cache a value retrieved from cN
+ * @self:  c0sk handle
+ * @skidx: kvs index
+ * @kt:    key (kt_hash must be valid)
+ * @view:  view seqno of the lookup that found the value
+ * @vbuf:  value as returned by cn_get()
+ *
+ * Return: The number of entries evicted to make room for the value.
+ */
+/* MTF_MOCK */
+uint
+c0sk_vcache_insert(
+    struct c0sk *      self,
+    u16                skidx,
+    struct kvs_ktuple *kt,
+    u64                view,
+    struct kvs_buf *   vbuf);
+
+/**
+ * c0sk_cache_flush() - empty the negative and value caches
+ * @self: c0sk handle
+ *
+ * Must be called after writes that bypass c0sk_put() and c0sk_merge()
+ * have become visible (e.g., a bulk load).
+ */
+/* MTF_MOCK */
+void
+c0sk_cache_flush(struct c0sk *self);
+
+/**
+ * c0sk_cache_hold() - suspend cache inserts during a commit
+ * @self: c0sk handle
+ */
+/* MTF_MOCK */
+void
+c0sk_cache_hold(struct c0sk *self);
+
+/**
+ * c0sk_cache_release() - resume cache inserts
+ * @self: c0sk handle
+ * @seq:  commit seqno, or zero if the commit was abandoned
+ */
+/* MTF_MOCK */
+void
+c0sk_cache_release(struct c0sk *self, u64 seq);
+
 /**
  * c0sk_merge() - merge the 'from' kvms into the 'first' kvms
  * @self:     struct c0sk into which to merge
@@ -305,6 +453,18 @@ c0sk_cursor_seek(
 merr_t
 c0sk_cursor_read(struct c0_cursor *cur, struct kvs_kvtuple *kvt, bool *eof);
 
+/**
+ * c0sk_cursor_rtomb_lookup() - check a key against the cursor's range tombstones
+ * @c0cur:      The existing cursor.
+ * @key:        key to check
+ * @klen:       length of @key
+ *
+ * Return: seqno of the newest range tombstone visible to the cursor that
+ * covers @key, or zero if none.
+ */
+u64
+c0sk_cursor_rtomb_lookup(struct c0_cursor *cur, const void *key, u32 klen);
+
 /**
  * c0sk_cursor_update() - update existing iterators over c0
  * @c0cur:      The existing cursor.
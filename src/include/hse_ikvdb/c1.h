@@ -328,6 +328,7 @@ c1_vtuple_alloc(struct c1_kvcache *cc, struct c1_vtuple **cvt);
  * @vlen:
  * @seqno:
  * @data:
+ * @expiry: expiry time of the value (see kvs_expired()), zero if none
  * @tomb:
  */
 void
@@ -336,6 +337,7 @@ c1_vtuple_init(
     u64                      vlen,
     u64                      seqno,
     void *                   data,
+    u32                      expiry,
     bool                     tomb);
 
 /**
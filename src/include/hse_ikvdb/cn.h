@@ -19,16 +19,22 @@
 
 #define CN_CFLAG_CAPPED (1 << 0)
 
+/* Maximum number of keys per cn_get_batch() call */
+#define CN_GET_BATCH_MAX (64)
+
 struct cn;
 struct cn_kvdb;
+struct cn_load;
 struct cndb;
 struct mpool;
 struct kvs_cparams;
 struct kvs_rparams;
 struct kvset_mblocks;
 struct kvdb_kvs;
+struct kvset;
 struct sts;
 struct mclass_policy;
+struct merge_op;
 enum cn_action;
 enum mp_media_classp;
 
@@ -99,6 +105,10 @@ cn_get_dataset(const struct cn *cn);
 struct mclass_policy *
 cn_get_mclass_policy(const struct cn *cn);
 
+/* MTF_MOCK */
+struct merge_op *
+cn_get_merge_op(struct cn *cn);
+
 /* MTF_MOCK */
 void
 cn_disable_maint(struct cn *handle, bool onoff);
@@ -116,6 +126,117 @@ cn_get(
     enum key_lookup_res *res,
     struct kvs_buf *     vbuf);
 
+/**
+ * cn_get_batch() - look up a vector of keys with a single tree descent
+ * @cn:    cn handle
+ * @ktv:   vector of keys (kt_hash must be initialized)
+ * @seq:   view sequence number
+ * @resv:  (output) vector of lookup results
+ * @vbufv: (output) vector of value buffers
+ * @cnt:   number of keys, at most %CN_GET_BATCH_MAX
+ */
+/* MTF_MOCK */
+merr_t
+cn_get_batch(
+    struct cn *          cn,
+    struct kvs_ktuple *  ktv,
+    u64                  seq,
+    enum key_lookup_res *resv,
+    struct kvs_buf *     vbufv,
+    uint                 cnt);
+
+/**
+ * struct cn_vpin - a reference to a value in a mapped vblock
+ * @vp_kvset: kvset held by the reference, or NULL if none
+ * @vp_data:  address of the value within the vblock map
+ * @vp_len:   length of the value
+ *
+ * While @vp_kvset is held the kvset cannot be destroyed by compaction,
+ * hence the vblock map backing @vp_data remains valid until the
+ * reference is dropped by cn_vpin_release().
+ */
+struct cn_vpin {
+    struct kvset *vp_kvset;
+    const void *  vp_data;
+    u32           vp_len;
+};
+
+/**
+ * cn_get_pinned() - look up a key, referencing the value in place if possible
+ * @cn:    cn handle
+ * @kt:    key to look up
+ * @seq:   view sequence number
+ * @res:   (output) lookup result
+ * @vbuf:  (output) value buffer, used if the value cannot be referenced
+ * @vpin:  (output) value reference
+ *
+ * Same as cn_get() except that an uncompressed value stored in a vblock
+ * is not copied into @vbuf.  Instead, @vpin is set to refer to the value
+ * and holds a reference on its kvset which the caller must drop via
+ * cn_vpin_release().  @vpin->vp_kvset is NULL if the value was copied.
+ */
+/* MTF_MOCK */
+merr_t
+cn_get_pinned(
+    struct cn *          cn,
+    struct kvs_ktuple *  kt,
+    u64                  seq,
+    enum key_lookup_res *res,
+    struct kvs_buf *     vbuf,
+    struct cn_vpin *     vpin);
+
+/* MTF_MOCK */
+void
+cn_vpin_release(struct cn_vpin *vpin);
+
+struct cn_aget;
+
+typedef void cn_aget_cb(struct cn_aget *ag, merr_t err);
+
+/**
+ * struct cn_aget - context for an asynchronous cn get
+ * @ag_work:  work struct for the value read
+ * @ag_cb:    called once the value read has completed
+ * @ag_vbuf:  value buffer given to cn_get_async()
+ * @ag_kvset: kvset holding the value, referenced while the read is pending
+ * @ag_vref:  location of the value within @ag_kvset
+ */
+struct cn_aget {
+    struct work_struct    ag_work;
+    cn_aget_cb *          ag_cb;
+    struct kvs_buf *      ag_vbuf;
+    struct kvset *        ag_kvset;
+    struct kvs_vtuple_ref ag_vref;
+};
+
+/**
+ * cn_get_async() - look up a key, deferring the value read if it is large
+ * @cn:       cn handle
+ * @kt:       key to look up
+ * @seq:      view sequence number
+ * @res:      (output) lookup result
+ * @vbuf:     (output) value buffer, must remain valid until completion
+ * @ag:       async get context (caller must initialize @ag->ag_cb)
+ * @pendingp: (output) set to true if the value read was deferred
+ *
+ * The key is looked up synchronously.  If the value is to be read
+ * directly from media (see the cn_mcache_vmin/vmax rparams) then the
+ * read is handed off to the cn's async get workqueue, *@pendingp is
+ * set to true, and @ag->ag_cb is called once the value has been copied
+ * out to @vbuf.  Otherwise, cn_get_async() behaves as cn_get() and
+ * @ag->ag_cb is not called.
+ */
+/* MTF_MOCK */
+merr_t
+cn_get_async(
+    struct cn *          cn,
+    struct kvs_ktuple *  kt,
+    u64                  seq,
+    enum key_lookup_res *res,
+    struct kvs_buf *     vbuf,
+    struct cn_aget *     ag,
+    bool *               pendingp);
+
 struct query_ctx;
 
 merr_t
@@ -132,7 +253,9 @@ cn_pfx_probe(
  * cn_ingestv() - A vectored version of cn_ingest
  * @cn:
  * @mbv:
- *      The first vcommitted[i] vblocks of kvset mbv[i] are already committed.
+ *      mbv[i] is a vector of mbc[i] kvsets to ingest into cn[i].  They must
+ *      cover disjoint key ranges.  The first vcommitted[i] vblocks of kvset
+ *      mbv[i][0] are already committed.
  * @mbc:
  * @vcommitted: indicated in each kvset how many vblocks are already committed.
  *      Also these comitted vblocks ae not deleted by cndb replay [in the case
@@ -158,6 +281,74 @@ cn_ingestv(
     bool *                 ingested_out,
     u64 *                  seqno_max_out);
 
+/**
+ * cn_load_create() - start a bulk load of sorted keys into a cn tree
+ * @cn:     cn to load
+ * @seqno:  seqno given to every value in the load
+ * @expiry: expiry time given to every value in the load, zero for none
+ * @loadp:  (output) load handle
+ *
+ * A bulk load builds kvsets directly from the keys given to cn_load_add(),
+ * bypassing c0 and c1.  Nothing is visible until cn_load_commit() adds
+ * all the kvsets to the root node in a single cndb transaction.
+ */
+/* MTF_MOCK */
+merr_t
+cn_load_create(struct cn *cn, u64 seqno, u64 expiry, struct cn_load **loadp);
+
+/**
+ * cn_load_add() - add a key and its value to a bulk load
+ * @load: load handle from cn_load_create()
+ * @kt:   key, which must be greater than the previous key added
+ * @vt:   value, which may be compressed but not a tomb
+ *
+ * Return: EINVAL if @kt is not greater than the previous key.
+ */
+/* MTF_MOCK */
+merr_t
+cn_load_add(struct cn_load *load, const struct kvs_ktuple *kt, const struct kvs_vtuple *vt);
+
+/**
+ * cn_load_commit() - make the keys of a bulk load visible
+ * @load: load handle from cn_load_create()
+ *
+ * The caller must first sync c0 so that all writes made since the load
+ * began are in cN.  The load handle must still be freed with
+ * cn_load_destroy().
+ *
+ * Return: ESTALE if a kvset holding a write newer than the load may
+ * overlap the load's key range.
+ */
+/* MTF_MOCK */
+merr_t
+cn_load_commit(struct cn_load *load);
+
+/**
+ * cn_load_destroy() - free a load handle
+ * @load: load handle from cn_load_create()
+ *
+ * Discards the keys added to an uncommitted load.
+ */
+/* MTF_MOCK */
+void
+cn_load_destroy(struct cn_load *load);
+
+/**
+ * cn_split_keys() - choose keys that divide a cn into ranges of similar size
+ * @cn:     cn handle
+ * @splitc: maximum number of split keys to choose
+ * @keybuf: buffer of @splitc * HSE_KVS_KLEN_MAX bytes
+ * @klenv:  vector of @splitc key lengths
+ *
+ * Split keys are sampled from kblock min keys.  Key i is returned at
+ * offset i * HSE_KVS_KLEN_MAX in @keybuf, in strictly ascending order.
+ *
+ * Return: number of split keys chosen, at most @splitc
+ */
+/* MTF_MOCK */
+uint
+cn_split_keys(struct cn *cn, uint splitc, void *keybuf, uint *klenv);
+
 /* MTF_MOCK */
 struct perfc_set *
 cn_get_ingest_perfc(const struct cn *cn);
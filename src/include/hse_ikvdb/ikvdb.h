@@ -31,6 +31,7 @@ struct kvdb_rparams;
 struct hse_kvdb_opspec;
 struct kvdb_log;
 struct hse_kvs_cursor;
+struct hse_kvs_load;
 struct mpool;
 struct c0sk;
 struct cndb;
@@ -42,15 +43,20 @@ struct kvs;
 struct hse_kvdb_txn {
 };
 
+/* Max number of key ranges into which ikvdb_export() splits a kvs */
+#define KVDB_EXPORT_RANGES_MAX 64
+
 /**
  * struct kvdb_bak_work
  * @bak_work:
  * @bak_kvs:
- * @bak_fname: data file name
+ * @bak_fname: data file name (prefix of the data file names of a range)
  * @bak_cur: cursor for export
- * @bak_fcnt: number of dumped data files for this kvs
- * @bak_kvcnt: number of k-v pairs in this kvs
+ * @bak_fcnt: number of dumped data files for this kvs (or range)
+ * @bak_kvcnt: number of k-v pairs in this kvs (or range)
  * @bak_err:
+ * @bak_eklen: length of @bak_ekey, zero if the range has no upper bound
+ * @bak_ekey: exclusive upper bound of the range
  */
 struct kvdb_bak_work {
     struct work_struct     bak_work;
@@ -60,6 +66,8 @@ struct kvdb_bak_work {
     int                    bak_fcnt;
     u64                    bak_kvcnt;
     merr_t                 bak_err;
+    uint                   bak_eklen;
+    char                   bak_ekey[HSE_KVS_KLEN_MAX];
 };
 
 /**
@@ -68,6 +76,8 @@ struct kvdb_bak_work {
  * @kvsi_name: kvs name
  * @kvsi_kvcnt: number of k-v pairs in this kvs
  * @kvsi_fcnt: number of data files dumped drung kvdb export
+ * @kvsi_rcnt: number of key ranges, zero for a version 1 export
+ * @kvsi_rfcntv: number of data files dumped for each key range
  */
 struct kvs_import {
     struct hse_params *kvsi_params;
@@ -75,6 +85,22 @@ struct kvs_import {
     u64                kvsi_kvcnt;
     u64                kvsi_fcnt;
     struct hse_kvs *   kvsi_kvs;
+    u32                kvsi_rcnt;
+    u32                kvsi_rfcntv[KVDB_EXPORT_RANGES_MAX];
+};
+
+/**
+ * struct ikvdb_batch_op - a single put or delete in a write batch
+ * @bo_kvs:  target kvs
+ * @bo_kt:   key
+ * @bo_vt:   value (ignored if @bo_tomb is true)
+ * @bo_tomb: true for a delete, false for a put
+ */
+struct ikvdb_batch_op {
+    struct hse_kvs *  bo_kvs;
+    struct kvs_ktuple bo_kt;
+    struct kvs_vtuple bo_vt;
+    bool              bo_tomb;
 };
 
 #define IKVDB_SUB_NAME_SEP ":"
@@ -309,6 +335,31 @@ ikvdb_kvs_put(
     struct kvs_ktuple *      kt,
     const struct kvs_vtuple *vt);
 
+/**
+ * ikvdb_kvs_put_batch() - apply a vector of puts and deletes to a single KVS.
+ * Every op in opv must target kvs.  See ikvdb_write_batch().
+ */
+merr_t
+ikvdb_kvs_put_batch(
+    struct hse_kvs *        kvs,
+    struct hse_kvdb_opspec *opspec,
+    struct ikvdb_batch_op * opv,
+    uint                    opc);
+
+/**
+ * ikvdb_write_batch() - apply a vector of non-transactional puts and deletes
+ * to one or more KVSes within the KVDB.  The health check and throttle are
+ * charged once for the whole batch, and the ops are inserted into c0 with
+ * c0sk_putdelv().  The batch is not atomic: on error, a subset of the ops
+ * may have been applied.
+ */
+merr_t
+ikvdb_write_batch(
+    struct ikvdb *          kvdb,
+    struct hse_kvdb_opspec *opspec,
+    struct ikvdb_batch_op * opv,
+    uint                    opc);
+
 /**
  * ikvdb_kvs_get() - search for the given key within the KVS. HSE allocates
  * memory for the result if vbuf->b_buf is NULL.
@@ -321,6 +372,51 @@ ikvdb_kvs_get(
     enum key_lookup_res *   res,
     struct kvs_buf *        vbuf);
 
+/**
+ * ikvdb_kvs_get_batch() - search for a vector of keys within the KVS, all
+ * at the same view sequence number.
+ */
+merr_t
+ikvdb_kvs_get_batch(
+    struct hse_kvs *        kvs,
+    struct hse_kvdb_opspec *opspec,
+    struct kvs_ktuple *     ktv,
+    enum key_lookup_res *   resv,
+    struct kvs_buf *        vbufv,
+    uint                    cnt);
+
+/**
+ * ikvdb_kvs_get_async() - search for the given key within the KVS, calling
+ * @cb once the value has been copied into @vbuf.  The contents of @vbuf are
+ * copied, but the buffer it describes must remain valid until @cb is called.
+ */
+merr_t
+ikvdb_kvs_get_async(
+    struct hse_kvs *        kvs,
+    struct hse_kvdb_opspec *opspec,
+    struct kvs_ktuple *     kt,
+    struct kvs_buf *        vbuf,
+    hse_kvs_get_cb *        cb,
+    void *                  arg);
+
+struct kvs_pin;
+
+/**
+ * ikvdb_kvs_get_pinned() - search for the given key within the KVS, returning
+ * a reference to its value rather than a copy where possible.  The pin must
+ * be released via ikvdb_kvs_pin_release().
+ */
+merr_t
+ikvdb_kvs_get_pinned(
+    struct hse_kvs *        kvs,
+    struct hse_kvdb_opspec *opspec,
+    struct kvs_ktuple *     kt,
+    enum key_lookup_res *   res,
+    struct kvs_pin **       pinp);
+
+void
+ikvdb_kvs_pin_release(struct kvs_pin *pin);
+
 /**
  * ikvdb_kvs_del() - remove the supplied key and associated value from the KVS
  * indexed by opspec->kop_index.
@@ -352,6 +448,79 @@ ikvdb_kvs_prefix_delete(
     struct kvs_ktuple *     kt,
     size_t *                kvs_pfx_len);
 
+/**
+ * ikvdb_kvs_range_delete() - remove all key/value pairs in [start, end)
+ * from the KVS with a single range tombstone.  Not supported within a
+ * transaction.  Returns once c0 has been ingested into cN, as range
+ * tombstones are not logged to c1.
+ */
+/* MTF_MOCK */
+merr_t
+ikvdb_kvs_range_delete(
+    struct hse_kvs *        kvs,
+    struct hse_kvdb_opspec *opspec,
+    struct kvs_ktuple *     start,
+    struct kvs_ktuple *     end);
+
+/**
+ * ikvdb_kvs_merge() - add a merge operand to the value of a key in the
+ * KVS indexed by opspec->kop_index.  Not supported within a transaction.
+ */
+/* MTF_MOCK */
+merr_t
+ikvdb_kvs_merge(
+    struct hse_kvs *        kvs,
+    struct hse_kvdb_opspec *opspec,
+    struct kvs_ktuple *     kt,
+    const void *            operand,
+    size_t                  len);
+
+/**
+ * ikvdb_kvs_merge_fn_set() - set the function of the KVS's "user" merge
+ * operator
+ */
+/* MTF_MOCK */
+merr_t
+ikvdb_kvs_merge_fn_set(struct hse_kvs *kvs, hse_kvs_merge_fn *fn, void *arg);
+
+/**
+ * ikvdb_kvs_load_begin() - start a bulk load of sorted keys into a KVS,
+ * bypassing c0 and c1.  Not supported within a transaction.
+ */
+/* MTF_MOCK */
+merr_t
+ikvdb_kvs_load_begin(
+    struct hse_kvs *        kvs,
+    struct hse_kvdb_opspec *opspec,
+    struct hse_kvs_load **  loadp);
+
+/**
+ * ikvdb_kvs_load_put() - add the next key of a bulk load
+ */
+/* MTF_MOCK */
+merr_t
+ikvdb_kvs_load_put(
+    struct hse_kvs_load *    load,
+    struct kvs_ktuple *      kt,
+    const struct kvs_vtuple *vt);
+
+/**
+ * ikvdb_kvs_load_commit() - make the keys of a bulk load visible and free
+ * the load, which is discarded if the commit fails
+ *
+ * Return: ESTALE if a write made since the load began may overlap it.
+ */
+/* MTF_MOCK */
+merr_t
+ikvdb_kvs_load_commit(struct hse_kvs_load *load);
+
+/**
+ * ikvdb_kvs_load_abort() - discard a bulk load and free it
+ */
+/* MTF_MOCK */
+void
+ikvdb_kvs_load_abort(struct hse_kvs_load *load);
+
 /**
  * ikvdb_sync() - flush data in all of the KVSes to stable media.
  */
@@ -458,6 +627,21 @@ ikvdb_kvs_cursor_read(
     size_t *                val_len,
     bool *                  eof);
 
+/**
+ * ikvdb_kvs_cursor_read_many() - read a run of key/value pairs from the
+ * cursor into a caller-provided buffer
+ */
+merr_t
+ikvdb_kvs_cursor_read_many(
+    struct hse_kvs_cursor *      cursor,
+    struct hse_kvdb_opspec *     opspec,
+    void *                       buf,
+    size_t                       buf_sz,
+    struct hse_kvs_cursor_kvoff *kvov,
+    uint                         max_cnt,
+    uint *                       cnt,
+    bool *                       eof);
+
 /**
  * ikvdb_kvs_cursor_destroy() - allow the caller to indicate that is is done
  * with the scan and release the associated cursor
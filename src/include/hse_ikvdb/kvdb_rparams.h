@@ -47,6 +47,7 @@ struct kvdb_rparams {
     unsigned long c0_ingest_delay;
     unsigned long c0_ingest_width;
     unsigned long c0_coalesce_sz;
+    unsigned long c0_negc_sz;
 
     unsigned long txn_heap_sz;
     unsigned long txn_ingest_delay;
@@ -92,6 +93,12 @@ struct kvdb_rparams {
     unsigned int  cndb_entries;
     unsigned int  c0_maint_threads;
     unsigned int  c0_ingest_threads;
+    unsigned int  c0_ingest_parts;
+    unsigned int  c0_ingest_part_mb;
+    unsigned int  c0_wide_index;
+    unsigned int  c0_numa_bind;
+    unsigned int  c0_heap_huge;
+    unsigned int  c0_pfx_dedup;
     unsigned int  c0_mutex_pool_sz;
 
     unsigned int  keylock_entries;
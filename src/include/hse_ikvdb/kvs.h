@@ -6,6 +6,8 @@
 #ifndef HSE_KVS_IKVS_H
 #define HSE_KVS_IKVS_H
 
+#include <hse/hse.h>
+
 #include <hse_util/arch.h>
 #include <hse_util/list.h>
 #include <hse_util/inttypes.h>
@@ -34,6 +36,8 @@ struct kvs_cparams;
 struct kvs_rparams;
 struct cn;
 struct cn_kvdb;
+struct c0sk_batch_op;
+struct hse_kvs_cursor_kvoff;
 
 struct kc_filter {
     const void *kcf_maxkey;
@@ -55,6 +59,16 @@ struct hse_kvs_cursor {
     bool kc_on_list;
 };
 
+/**
+ * struct kvs_pin - a value obtained by ikvs_get_pinned()
+ * @kp_data: read-only pointer to the value
+ * @kp_len:  length of the value
+ */
+struct kvs_pin {
+    const void *kp_data;
+    u32         kp_len;
+};
+
 merr_t
 kvs_open(
     struct ikvdb *      kvdb,
@@ -93,6 +107,77 @@ ikvs_get(
     enum key_lookup_res *   res,
     struct kvs_buf *        vbuf);
 
+merr_t
+ikvs_get_batch(
+    struct ikvs *           ikvs,
+    struct hse_kvdb_opspec *os,
+    struct kvs_ktuple *     ktv,
+    u64                     seqno,
+    enum key_lookup_res *   resv,
+    struct kvs_buf *        vbufv,
+    uint                    cnt);
+
+/**
+ * ikvs_get_async() - look up a key, completing a large value read asynchronously
+ * @ikvs:  kvs handle
+ * @os:    opspec (may be NULL)
+ * @kt:    key to look up
+ * @seqno: view sequence number
+ * @vbuf:  value buffer (the buffer must remain valid until @cb is called)
+ * @cb:    completion callback
+ * @arg:   argument for @cb
+ *
+ * @cb is called either before ikvs_get_async() returns, or from a cn
+ * async get worker if the value had to be read from media (see
+ * cn_get_async()).  @cb is not called if an error is returned.
+ */
+merr_t
+ikvs_get_async(
+    struct ikvs *           ikvs,
+    struct hse_kvdb_opspec *os,
+    struct kvs_ktuple *     kt,
+    u64                     seqno,
+    struct kvs_buf *        vbuf,
+    hse_kvs_get_cb *        cb,
+    void *                  arg);
+
+/**
+ * ikvs_get_pinned() - look up a key without copying its value if possible
+ * @ikvs:  kvs handle
+ * @os:    opspec (may be NULL)
+ * @kt:    key to look up
+ * @seqno: view sequence number
+ * @res:   (output) lookup result
+ * @pinp:  (output) value, valid only if @res is FOUND_VAL
+ *
+ * An uncompressed value found in a cN vblock is returned by reference
+ * into the vblock map, its kvset being held until the pin is released
+ * via ikvs_pin_release() or until the pin outlives the "cn_pin_lease"
+ * rparam, whichever comes first.  Any other value is copied into
+ * memory owned by the pin.
+ */
+merr_t
+ikvs_get_pinned(
+    struct ikvs *           ikvs,
+    struct hse_kvdb_opspec *os,
+    struct kvs_ktuple *     kt,
+    u64                     seqno,
+    enum key_lookup_res *   res,
+    struct kvs_pin **       pinp);
+
+void
+ikvs_pin_release(struct kvs_pin *pin);
+
+/**
+ * ikvs_batch_op_init() - prepare a batch op for c0sk_putdelv()
+ * @ikvs: kvs targeted by the op
+ * @op:   op whose key, value and tombstone flag are initialized
+ *
+ * Hashes the key and binds the op to the kvs' structured key index.
+ */
+merr_t
+ikvs_batch_op_init(struct ikvs *ikvs, struct c0sk_batch_op *op);
+
 merr_t
 ikvs_del(struct ikvs *ikvs, struct hse_kvdb_opspec *os, struct kvs_ktuple *key, u64 seqno);
 
@@ -109,6 +194,47 @@ ikvs_pfx_probe(
 merr_t
 ikvs_prefix_del(struct ikvs *ikvs, struct hse_kvdb_opspec *os, struct kvs_ktuple *key, u64 seqno);
 
+/**
+ * ikvs_range_del() - delete all keys in [start, end) with a range tombstone
+ * @ikvs:   kvs handle
+ * @start:  first key of the range
+ * @end:    end of the range (exclusive)
+ * @seqno:  (output) seqno assigned to the range delete
+ */
+merr_t
+ikvs_range_del(
+    struct ikvs *      ikvs,
+    struct kvs_ktuple *start,
+    struct kvs_ktuple *end,
+    u64 *              seqno);
+
+/**
+ * ikvs_merge() - add a merge operand to a key
+ * @ikvs:     kvs handle
+ * @os:       opspec (must not name a txn)
+ * @kt:       key
+ * @operand:  operand, validated against the kvs merge operator
+ * @len:      length of @operand
+ * @seqno:    seqno of the operand
+ *
+ * The operand is folded into the value of the key when read, or
+ * when the key is spilled below the compaction horizon.
+ */
+merr_t
+ikvs_merge(
+    struct ikvs *           ikvs,
+    struct hse_kvdb_opspec *os,
+    struct kvs_ktuple *     kt,
+    const void *            operand,
+    size_t                  len,
+    u64                     seqno);
+
+/**
+ * ikvs_merge_fn_set() - set the function of a "user" merge operator
+ */
+void
+ikvs_merge_fn_set(struct ikvs *ikvs, hse_kvs_merge_fn *fn, void *arg);
+
 u16
 ikvs_index(struct ikvs *ikvs);
 
@@ -145,6 +271,30 @@ ikvs_cursor_update(struct hse_kvs_cursor *cursor, u64 seqno);
 merr_t
 ikvs_cursor_read(struct hse_kvs_cursor *cursor, struct kvs_kvtuple *kvt, bool *eof);
 
+/**
+ * ikvs_cursor_read_many() - read a run of tuples into a caller buffer
+ * @cursor:  cursor handle
+ * @buf:     buffer into which keys and values are packed
+ * @bufsz:   size of @buf
+ * @kvov:    (output) key and value offsets within @buf for each tuple
+ * @kvomax:  max number of tuples to read
+ * @kvocnt:  (output) number of tuples read
+ * @eof:     (output) set if the cursor is exhausted
+ *
+ * A tuple that does not fit in what remains of @buf is retained by the
+ * cursor and returned by the next read.  Returns EMSGSIZE if the next
+ * tuple does not fit in @buf at all.
+ */
+merr_t
+ikvs_cursor_read_many(
+    struct hse_kvs_cursor *      cursor,
+    void *                       buf,
+    size_t                       bufsz,
+    struct hse_kvs_cursor_kvoff *kvov,
+    uint                         kvomax,
+    uint *                       kvocnt,
+    bool *                       eof);
+
 void
 ikvs_cursor_tombspan_check(struct hse_kvs_cursor *handle);
 
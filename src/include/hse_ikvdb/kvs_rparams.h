@@ -10,6 +10,7 @@
 
 #include <hse_ikvdb/mclass_policy.h>
 #include <hse_ikvdb/vcomp_params.h>
+#include <hse_ikvdb/merge_op.h>
 
 #include <hse_util/hse_err.h>
 
@@ -43,6 +44,7 @@ struct kvs_rparams {
 
     unsigned long cn_node_size_lo;
     unsigned long cn_node_size_hi;
+    unsigned long cn_load_kvset_mb;
 
     unsigned long cn_capped_ttl;
     unsigned long cn_capped_vra;
@@ -50,6 +52,7 @@ struct kvs_rparams {
     unsigned long cn_cursor_vra;
     unsigned long cn_cursor_kra;
     unsigned long cn_cursor_seq;
+    unsigned long cn_pin_lease;
 
     unsigned long cn_mcache_wbt;
     unsigned long cn_mcache_vmin;
@@ -64,9 +67,13 @@ struct kvs_rparams {
     unsigned long cn_bloom_prob;
     unsigned long cn_bloom_capped;
     unsigned long cn_bloom_preload;
+    unsigned long cn_bloom_static;
+    unsigned long cn_bloom_pfx;
 
     unsigned long cn_verify;
     unsigned long cn_kcachesz;
+    unsigned long kvs_vcachesz;
+    unsigned long kvs_vcache_vmax;
     unsigned long kblock_size_mb;
     unsigned long vblock_size_mb;
 
@@ -77,6 +84,7 @@ struct kvs_rparams {
     unsigned long c1_vblock_cappct;
 
     unsigned long cn_io_threads;
+    unsigned long cn_aget_threads;
     unsigned long cn_close_wait;
     unsigned long cn_diag_mode;
 
@@ -90,6 +98,7 @@ struct kvs_rparams {
 
     unsigned long vcompmin;
     char value_compression[VCOMP_PARAM_STR_SZ];
+    char merge_op[MERGE_OP_PARAM_STR_SZ];
 
     unsigned long rpmagic;
 };
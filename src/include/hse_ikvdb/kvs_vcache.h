@@ -0,0 +1,89 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2015-2020 Micron Technology, Inc.  All rights reserved.
+ */
+
+#ifndef HSE_KVS_KVS_VCACHE_H
+#define HSE_KVS_KVS_VCACHE_H
+
+#include <hse_util/hse_err.h>
+#include <hse_util/inttypes.h>
+
+/*
+ * The kvs value cache holds copies of small values recently read from cN
+ * so that repeated gets of hot keys need not search the cN tree.
+ *
+ * c0sk invalidates the entry of each key written to its kvs, and of every
+ * key on a prefix or range delete.  To keep a value read from cN before
+ * such a write from being cached after it, each hash bucket carries a
+ * seqno floor raised by invalidation: an insert is refused if the view of
+ * the lookup that read the value is older than the floor of its bucket.
+ * A flush raises a cache-wide floor for bulk loads and for transactions
+ * that were installed in c0 whole.  Transaction commits, whose keys are
+ * invalidated before their commit seqno is known, are fenced by c0sk
+ * (see c0sk_vcache_insert()).
+ */
+
+struct kvs_vcache;
+struct kvs_ktuple;
+struct kvs_buf;
+
+/**
+ * kvs_vcache_create() - create a value cache
+ * @memsz: memory budget (bytes) for keys and values
+ * @vmax:  largest value (bytes) that may be cached
+ * @vcp:   (output) value cache handle
+ */
+merr_t
+kvs_vcache_create(size_t memsz, u32 vmax, struct kvs_vcache **vcp);
+
+void
+kvs_vcache_destroy(struct kvs_vcache *vc);
+
+/**
+ * kvs_vcache_lookup() - retrieve a cached value
+ * @vc:   value cache handle
+ * @kt:   key (kt_hash must be valid)
+ * @vbuf: caller's value buffer
+ *
+ * Return: %true and @vbuf filled in as per cn_get() on a hit.
+ */
+bool
+kvs_vcache_lookup(struct kvs_vcache *vc, struct kvs_ktuple *kt, struct kvs_buf *vbuf);
+
+/**
+ * kvs_vcache_insert() - cache a value retrieved from cN
+ * @vc:   value cache handle
+ * @kt:   key (kt_hash must be valid)
+ * @view: view seqno of the lookup that found the value
+ * @vbuf: value as returned by cn_get()
+ *
+ * Values that were truncated or that exceed the vmax given at create
+ * time are not cached, nor are values read at a view older than the
+ * floor of the key's bucket.
+ *
+ * Return: The number of entries evicted to make room for the new entry.
+ */
+uint
+kvs_vcache_insert(struct kvs_vcache *vc, struct kvs_ktuple *kt, u64 view, struct kvs_buf *vbuf);
+
+/**
+ * kvs_vcache_invalidate() - forget a key that has just been written
+ * @vc:  value cache handle
+ * @kt:  key (kt_hash must be valid)
+ * @seq: current kvdb seqno, read after the write was applied
+ *
+ * Return: %true if the key was cached.
+ */
+bool
+kvs_vcache_invalidate(struct kvs_vcache *vc, const struct kvs_ktuple *kt, u64 seq);
+
+/**
+ * kvs_vcache_flush() - forget all keys
+ * @vc:  value cache handle
+ * @seq: current kvdb seqno, read after the writes were made visible
+ */
+void
+kvs_vcache_flush(struct kvs_vcache *vc, u64 seq);
+
+#endif
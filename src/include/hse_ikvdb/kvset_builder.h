@@ -21,6 +21,7 @@ struct kvset_builder;
 struct kvs_rparams;
 struct perfc_set;
 struct cn_merge_stats;
+struct rtomb;
 
 #define KVSET_BUILDER_FLAGS_NONE    (0)
 #define KVSET_BUILDER_FLAGS_SPARE   (1u << 0)
@@ -91,10 +92,66 @@ kvset_builder_add_vref(
     uint                    vlen,
     uint                    complen);
 
+/**
+ * kvset_builder_add_val_expiry() - kvset_builder_add_val() for a value
+ *                                  that has an expiry time
+ * @expiry: wall clock time (seconds since the epoch) at which the value
+ *          expires, or zero if it never expires
+ */
+/* MTF_MOCK */
+merr_t
+kvset_builder_add_val_expiry(
+    struct kvset_builder *  self,
+    u64                     seq,
+    const void *            vdata,
+    uint                    vlen,
+    uint                    complen,
+    u64                     expiry);
+
+/**
+ * kvset_builder_add_vref_expiry() - kvset_builder_add_vref() for a value
+ *                                   that has an expiry time
+ */
+/* MTF_MOCK */
+merr_t
+kvset_builder_add_vref_expiry(
+    struct kvset_builder   *self,
+    u64                     seq,
+    uint                    vbidx,
+    uint                    vboff,
+    uint                    vlen,
+    uint                    complen,
+    u64                     expiry);
+
+/**
+ * kvset_builder_add_mop() - add a merge operand to the current key
+ * @self:  kvset builder
+ * @seq:   seqno of the operand
+ * @vdata: operand data
+ * @vlen:  length of @vdata, at most %HSE_KVS_MERGE_LEN_MAX
+ *
+ * Merge operands are always stored inline in the key metadata.
+ */
+/* MTF_MOCK */
+merr_t
+kvset_builder_add_mop(struct kvset_builder *self, u64 seq, const void *vdata, uint vlen);
+
 /* MTF_MOCK */
 merr_t
 kvset_builder_add_nonval(struct kvset_builder *self, u64 seq, enum kmd_vtype vtype);
 
+/**
+ * kvset_builder_add_rtomb() - add a range tombstone to the kvset
+ * @self:  kvset builder
+ * @rt:    range tombstone (copied)
+ *
+ * Range tombstones may be added at any time before the builder is
+ * finished.  They are stored in the kvset's final kblock.
+ */
+/* MTF_MOCK */
+merr_t
+kvset_builder_add_rtomb(struct kvset_builder *self, const struct rtomb *rt);
+
 /* MTF_MOCK */
 void
 kvset_builder_destroy(struct kvset_builder *builder);
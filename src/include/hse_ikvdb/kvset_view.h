@@ -60,6 +60,15 @@ kvset_get_nth_kblock_id(struct kvset *kvset, u32 index);
 u64
 kvset_get_nth_vblock_id(struct kvset *kvset, u32 index);
 
+/**
+ * kvset_get_nth_kblock_minkey() - Get the smallest key in the nth kblock
+ *
+ * Sets *klen to zero if the kblock holds only ptombs.
+ */
+/* MTF_MOCK */
+void
+kvset_get_nth_kblock_minkey(struct kvset *kvset, u32 index, const void **key, uint *klen);
+
 /* MTF_MOCK */
 u64
 kvset_get_dgen(struct kvset *kvset);
@@ -24,6 +24,12 @@
 #define HSE_C0_INGEST_THREADS_DFLT (3)
 #define HSE_C0_INGEST_THREADS_MAX (8)
 
+#define HSE_C0_INGEST_PARTS_DFLT (4)
+#define HSE_C0_INGEST_PARTS_MAX (16)
+#define HSE_C0_INGEST_PART_MB_DFLT (64)
+
+#define HSE_C0_INDEX_THREADS_MAX (8)
+
 #define HSE_C0_MAINT_THREADS_DFLT (5)
 #define HSE_C0_MAINT_THREADS_MAX (32)
 
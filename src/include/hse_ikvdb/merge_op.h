@@ -0,0 +1,158 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2015-2020 Micron Technology, Inc.  All rights reserved.
+ */
+
+#ifndef HSE_IKVDB_MERGE_OP_H
+#define HSE_IKVDB_MERGE_OP_H
+
+#include <hse_util/inttypes.h>
+#include <hse_util/hse_err.h>
+
+#include <hse/hse.h>
+#include <hse/hse_limits.h>
+
+/**
+ * enum merge_op_type - merge operators (see kvs rparam "merge_op")
+ * @MERGE_OP_NONE:   hse_kvs_merge() is not permitted
+ * @MERGE_OP_ADD:    add 8-byte little-endian signed integers
+ * @MERGE_OP_MAX:    keep the larger of 8-byte little-endian unsigned integers
+ * @MERGE_OP_APPEND: concatenate the operands to the value
+ * @MERGE_OP_USER:   call the function given to hse_kvs_merge_fn_set()
+ *
+ * For the integer operators a missing value, or one whose length is
+ * not eight bytes, is taken to be zero.
+ */
+enum merge_op_type {
+    MERGE_OP_NONE = 0,
+    MERGE_OP_ADD = 1,
+    MERGE_OP_MAX = 2,
+    MERGE_OP_APPEND = 3,
+    MERGE_OP_USER = 4,
+};
+
+#define MERGE_OP_PARAM_NONE    "none"
+#define MERGE_OP_PARAM_ADD     "add"
+#define MERGE_OP_PARAM_MAX     "max"
+#define MERGE_OP_PARAM_APPEND  "append"
+#define MERGE_OP_PARAM_USER    "user"
+
+#define MERGE_OP_PARAM_SUPPORTED \
+    MERGE_OP_PARAM_NONE " " MERGE_OP_PARAM_ADD " " MERGE_OP_PARAM_MAX " " \
+    MERGE_OP_PARAM_APPEND " " MERGE_OP_PARAM_USER
+#define MERGE_OP_PARAM_STR_SZ 8
+
+struct kvs_rparams;
+
+/**
+ * struct merge_op - a kvs merge operator
+ * @mo_type: operator type
+ * @mo_fn:   user merge function, valid only for %MERGE_OP_USER
+ * @mo_arg:  argument for @mo_fn
+ */
+struct merge_op {
+    enum merge_op_type mo_type;
+    hse_kvs_merge_fn * mo_fn;
+    void *             mo_arg;
+};
+
+/**
+ * struct merge_operand - a copy of one merge operand
+ * @mop_seq:  seqno of the operand
+ * @mop_len:  length of @mop_data
+ * @mop_data: operand data
+ */
+struct merge_operand {
+    u64 mop_seq;
+    u32 mop_len;
+    u8  mop_data[HSE_KVS_MERGE_LEN_MAX];
+};
+
+/**
+ * struct merge_opv - growable vector of merge operands, newest first
+ * @mov_v:   vector of operands
+ * @mov_cnt: number of elements in use
+ * @mov_max: number of elements allocated
+ */
+struct merge_opv {
+    struct merge_operand *mov_v;
+    uint                  mov_cnt;
+    uint                  mov_max;
+};
+
+/**
+ * merge_op_init() - initialize a merge operator from the kvs rparams
+ * @mop: merge operator to initialize
+ * @rp:  kvs rparams
+ *
+ * Return: EINVAL if the "merge_op" rparam is not one of
+ * %MERGE_OP_PARAM_SUPPORTED.
+ */
+merr_t
+merge_op_init(struct merge_op *mop, const struct kvs_rparams *rp);
+
+/**
+ * merge_op_valid() - check an operand against a merge operator
+ * @mop:  merge operator
+ * @data: operand
+ * @len:  length of @data
+ *
+ * Return: EINVAL if the kvs has no merge operator, if a user merge
+ * operator has no function, or if the operand length is not valid
+ * for the operator.
+ */
+merr_t
+merge_op_valid(const struct merge_op *mop, const void *data, size_t len);
+
+/**
+ * merge_opv_add() - append a copy of an operand older than those in @vec
+ * @vec:  vector to append to
+ * @seq:  seqno of the operand
+ * @data: operand
+ * @len:  length of @data, at most %HSE_KVS_MERGE_LEN_MAX
+ */
+merr_t
+merge_opv_add(struct merge_opv *vec, u64 seq, const void *data, uint len);
+
+static inline void
+merge_opv_reset(struct merge_opv *vec)
+{
+    vec->mov_cnt = 0;
+}
+
+/**
+ * merge_opv_free() - release the vector
+ */
+void
+merge_opv_free(struct merge_opv *vec);
+
+/**
+ * merge_op_fold() - apply a vector of operands to a value
+ * @mop:     merge operator
+ * @key:     key to which the value and operands belong
+ * @klen:    length of @key
+ * @base:    value to which the oldest operand applies, or NULL if none
+ * @blen:    length of @base
+ * @opv:     operands, newest first
+ * @out:     output buffer of %HSE_KVS_VLEN_MAX bytes, must not overlap @base
+ * @outlen:  (output) length of the result
+ *
+ * The operands are applied oldest to newest.  A zero-length value is
+ * distinct from no value only to a user merge function.
+ *
+ * Return: EFBIG if the result would exceed %HSE_KVS_VLEN_MAX bytes,
+ * EINVAL if the kvs has no merge operator, or the error returned by
+ * the user merge function.
+ */
+merr_t
+merge_op_fold(
+    const struct merge_op * mop,
+    const void *            key,
+    uint                    klen,
+    const void *            base,
+    uint                    blen,
+    const struct merge_opv *opv,
+    void *                  out,
+    uint *                  outlen);
+
+#endif
@@ -17,6 +17,8 @@
  *   ------  --------    --- --- ---  -----
  *   vtype   u8           1   1   1
  *   seqno   hg64         2   2   8   sequence number
+ *   expiry  hg64         0   0   8   only present if vtype has the
+ *                                    KMD_VTYPE_EXPIRY flag set
  *   vboff   u32          4   4   4   not present for tombs
  *   vbidx   hg16_32k     1   1   2   not present for tombs
  *   vlen    hg32_1024m   1   1   4   not present for tombs
@@ -29,6 +31,7 @@
  *      3      3      9     A key with 1 tombstone entry
  *      9      9     19     A key with a non-zero length value
  *     10     10     23     A compressed key
+ *     16     16     31     A compressed key with an expiry time
  *
  * KMD List:
  *
@@ -47,8 +50,8 @@
  *    kmd_set_count(mem, &off, count);
  *    kmd_add_tomb(mem, &off, seq);
  *    kmd_add_ptomb(mem, &off, seq);
- *    kmd_add_ival(mem, &off, seq, vbase, vlen);
- *    kmd_add_val(mem, &off, seq, vbidx, vboff, vlen);
+ *    kmd_add_ival(mem, &off, seq, 0, vbase, vlen);
+ *    kmd_add_val(mem, &off, seq, expiry, vbidx, vboff, vlen);
  *    assert(off <= memsize);
  *
  * Unpack example:
@@ -67,11 +70,13 @@
  *   - Vblock offfsets are not encoded because the vast majority of offsets in
  *     a large vblock will exceed 16MB and thus require 4-bytes to encode
  *     anyhow.
+ *   - Only values (val, zval, ival and cval) may carry an expiry time.
+ *     kmd_type_seq() skips it, use kmd_type_seq_expiry() to retrieve it.
  */
 
 #define KMD_MAX_COUNT HG32_1024M_MAX
 
-#define KMD_MAX_ENCODED_ENTRY_LEN 23
+#define KMD_MAX_ENCODED_ENTRY_LEN 31
 #define KMD_MAX_ENCODED_COUNT_LEN 4
 
 enum kmd_vtype {
@@ -80,9 +85,12 @@ enum kmd_vtype {
     vtype_tomb = 2,  /* tombstone               */
     vtype_ptomb = 3, /* prefix tombstone        */
     vtype_ival = 4,  /* immediate (short) value */
-    vtype_cval = 5   /* LZ4 compressed value */
+    vtype_cval = 5,  /* LZ4 compressed value */
+    vtype_mop = 6    /* merge operand (immediate) */
 };
 
+#define KMD_VTYPE_EXPIRY 0x80 /* vtype flag, expiry time follows seqno */
+
 static inline uint
 kmd_storage_max(uint count)
 {
@@ -113,31 +121,49 @@ kmd_add_ptomb(void *kmd, size_t *off, u64 seq)
 }
 
 static inline void
-kmd_add_zval(void *kmd, size_t *off, u64 seq)
+kmd_add_type_seq(void *kmd, size_t *off, enum kmd_vtype vtype, u64 seq, u64 expiry)
 {
-    ((u8 *)kmd)[*off] = vtype_zval;
+    ((u8 *)kmd)[*off] = expiry ? (vtype | KMD_VTYPE_EXPIRY) : vtype;
     *off += 1;
     encode_hg64(kmd, off, seq);
+    if (expiry)
+        encode_hg64(kmd, off, expiry);
 }
 
 static inline void
-kmd_add_ival(void *kmd, size_t *off, u64 seq, const void *vdata, u8 vlen)
+kmd_add_zval(void *kmd, size_t *off, u64 seq, u64 expiry)
 {
-    ((u8 *)kmd)[*off] = vtype_ival;
-    *off += 1;
-    encode_hg64(kmd, off, seq);
+    kmd_add_type_seq(kmd, off, vtype_zval, seq, expiry);
+}
+
+static inline void
+kmd_add_ival(void *kmd, size_t *off, u64 seq, u64 expiry, const void *vdata, u8 vlen)
+{
+    kmd_add_type_seq(kmd, off, vtype_ival, seq, expiry);
     ((u8 *)kmd)[*off] = vlen;
     *off += 1;
     memcpy(((u8 *)kmd) + *off, vdata, vlen);
     *off += vlen;
 }
 
+/* A merge operand is encoded exactly as an ival, see kmd_ival().
+ */
 static inline void
-kmd_add_val(void *kmd, size_t *off, u64 seq, uint vbidx, uint vboff, uint vlen)
+kmd_add_mop(void *kmd, size_t *off, u64 seq, const void *vdata, u8 vlen)
 {
-    ((u8 *)kmd)[*off] = vtype_val;
+    ((u8 *)kmd)[*off] = vtype_mop;
     *off += 1;
     encode_hg64(kmd, off, seq);
+    ((u8 *)kmd)[*off] = vlen;
+    *off += 1;
+    memcpy(((u8 *)kmd) + *off, vdata, vlen);
+    *off += vlen;
+}
+
+static inline void
+kmd_add_val(void *kmd, size_t *off, u64 seq, u64 expiry, uint vbidx, uint vboff, uint vlen)
+{
+    kmd_add_type_seq(kmd, off, vtype_val, seq, expiry);
     encode_hg16_32k(kmd, off, vbidx);
     *(u32 *)(kmd + *off) = cpu_to_be32(vboff);
     *off += 4;
@@ -145,11 +171,17 @@ kmd_add_val(void *kmd, size_t *off, u64 seq, uint vbidx, uint vboff, uint vlen)
 }
 
 static inline void
-kmd_add_cval(void *kmd, size_t *off, u64 seq, uint vbidx, uint vboff, uint vlen, uint complen)
+kmd_add_cval(
+    void *  kmd,
+    size_t *off,
+    u64     seq,
+    u64     expiry,
+    uint    vbidx,
+    uint    vboff,
+    uint    vlen,
+    uint    complen)
 {
-    ((u8 *)kmd)[*off] = vtype_cval;
-    *off += 1;
-    encode_hg64(kmd, off, seq);
+    kmd_add_type_seq(kmd, off, vtype_cval, seq, expiry);
     encode_hg16_32k(kmd, off, vbidx);
     *(u32 *)(kmd + *off) = cpu_to_be32(vboff);
     *off += 4;
@@ -164,11 +196,22 @@ kmd_count(const void *kmd, size_t *off)
 }
 
 static inline void
-kmd_type_seq(const void *kmd, size_t *off, enum kmd_vtype *vtype, u64 *seq)
+kmd_type_seq_expiry(const void *kmd, size_t *off, enum kmd_vtype *vtype, u64 *seq, u64 *expiry)
 {
-    *vtype = ((const u8 *)kmd)[*off];
+    u8 type = ((const u8 *)kmd)[*off];
+
     *off += 1;
+    *vtype = type & ~KMD_VTYPE_EXPIRY;
     *seq = decode_hg64(kmd, off);
+    *expiry = (type & KMD_VTYPE_EXPIRY) ? decode_hg64(kmd, off) : 0;
+}
+
+static inline void
+kmd_type_seq(const void *kmd, size_t *off, enum kmd_vtype *vtype, u64 *seq)
+{
+    u64 expiry;
+
+    kmd_type_seq_expiry(kmd, off, vtype, seq, &expiry);
 }
 
 static inline void
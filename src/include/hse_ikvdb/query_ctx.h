@@ -17,8 +17,13 @@ extern pthread_key_t tomb_thread_key;
 enum query_type {
     QUERY_GET = 0,
     QUERY_PROBE_PFX,
+    QUERY_GET_PIN,
+    QUERY_GET_ASYNC,
 };
 
+struct cn_vpin;
+struct cn_aget;
+
 /**
  * struct tomb_elem - an element in the rb tree.
  * @node:    rb node
@@ -40,10 +45,16 @@ struct tomb_elem {
  * @pos:       current position in the memory region backing tomb elems
  * @ntombs:    number of tombstones encountered in current query
  * @seen:      number of unique keys seen
+ * @vpin:      value reference (QUERY_GET_PIN only)
+ * @aget:      async get context (QUERY_GET_ASYNC only)
  */
 struct query_ctx {
     enum query_type qtype;
 
+    /* pinned and async get specific context */
+    struct cn_vpin *vpin;
+    struct cn_aget *aget;
+
     /* prefix probe specific context */
     int            pos;
     uint           ntombs;
@@ -0,0 +1,108 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2015-2020 Micron Technology, Inc.  All rights reserved.
+ */
+
+#ifndef HSE_IKVDB_RTOMB_H
+#define HSE_IKVDB_RTOMB_H
+
+#include <hse_util/inttypes.h>
+#include <hse_util/hse_err.h>
+#include <hse_util/keycmp.h>
+
+/**
+ * struct rtomb - range tombstone
+ * @rt_seq:    seqno of the range delete
+ * @rt_start:  first key of the deleted range (inclusive)
+ * @rt_end:    end key of the deleted range (exclusive)
+ * @rt_slen:   length of @rt_start
+ * @rt_elen:   length of @rt_end
+ *
+ * A range tombstone hides every version of every key k in
+ * [@rt_start, @rt_end) whose seqno is less than @rt_seq.
+ * The key buffers are not owned by the rtomb.
+ */
+struct rtomb {
+    u64         rt_seq;
+    const void *rt_start;
+    const void *rt_end;
+    u16         rt_slen;
+    u16         rt_elen;
+};
+
+static inline bool
+rtomb_covers(const struct rtomb *rt, const void *key, u32 klen)
+{
+    return keycmp(rt->rt_start, rt->rt_slen, key, klen) <= 0 &&
+           keycmp(key, klen, rt->rt_end, rt->rt_elen) < 0;
+}
+
+/**
+ * rtomb_lookup() - find the newest range tombstone covering a key
+ * @rtv:       vector of range tombstones
+ * @rtc:       number of elements in @rtv
+ * @key:       key to check
+ * @klen:      length of @key
+ * @view_seq:  ignore range tombstones newer than this seqno
+ *
+ * Return: seqno of the newest visible range tombstone covering @key,
+ * or zero if there is none.
+ */
+static inline u64
+rtomb_lookup(const struct rtomb *rtv, uint rtc, const void *key, u32 klen, u64 view_seq)
+{
+    u64  seq = 0;
+    uint i;
+
+    for (i = 0; i < rtc; i++) {
+        const struct rtomb *rt = rtv + i;
+
+        if (rt->rt_seq > seq && rt->rt_seq <= view_seq && rtomb_covers(rt, key, klen))
+            seq = rt->rt_seq;
+    }
+
+    return seq;
+}
+
+/**
+ * struct rtomb_vec - growable vector of range tombstones with private keys
+ * @rtv_v:    vector of range tombstones
+ * @rtv_cnt:  number of elements in use
+ * @rtv_max:  number of elements allocated
+ */
+struct rtomb_vec {
+    struct rtomb *rtv_v;
+    uint          rtv_cnt;
+    uint          rtv_max;
+};
+
+/**
+ * rtomb_vec_add() - append a copy of a range tombstone (and its keys)
+ * @vec:  vector to append to
+ * @rt:   range tombstone to copy
+ */
+merr_t
+rtomb_vec_add(struct rtomb_vec *vec, const struct rtomb *rt);
+
+/**
+ * rtomb_vec_lookup() - rtomb_lookup() over an rtomb_vec
+ */
+static inline u64
+rtomb_vec_lookup(const struct rtomb_vec *vec, const void *key, u32 klen, u64 view_seq)
+{
+    return vec->rtv_cnt ? rtomb_lookup(vec->rtv_v, vec->rtv_cnt, key, klen, view_seq) : 0;
+}
+
+/**
+ * rtomb_vec_reset() - release all elements but keep the vector
+ */
+void
+rtomb_vec_reset(struct rtomb_vec *vec);
+
+/**
+ * rtomb_vec_free() - release all elements and the vector
+ */
+void
+rtomb_vec_free(struct rtomb_vec *vec);
+
+#endif
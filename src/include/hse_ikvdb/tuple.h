@@ -10,6 +10,7 @@
 #include <hse_util/hse_err.h>
 #include <hse_util/key_util.h>
 #include <hse_util/seqno.h>
+#include <hse_util/timing.h>
 
 #include <hse_ikvdb/key_hash.h>
 #include <hse_ikvdb/omf_kmd.h>
@@ -23,12 +24,20 @@
 
 #define HSE_CORE_IS_PTOMB(ptr) (((uintptr_t)(ptr) & ~0x0UL) == ~0x0UL)
 
+/* Merge operands are carried through c0 and c1 as ordinary values whose
+ * encoded length has this bit set in its uncompressed length field.
+ * The bit lies above HSE_KVS_VLEN_MAX and is masked by all the length
+ * accessors, so only code that cares about operands need check for it.
+ */
+#define HSE_XLEN_MOP (1ul << 31)
+
 enum key_lookup_res {
     NOT_FOUND = 1,
     FOUND_VAL = 2,
     FOUND_TMB = 3,
     FOUND_PTMB = 4,
     FOUND_MULTIPLE = 5,
+    FOUND_MOP = 6,
 };
 
 struct kvs_ktuple {
@@ -39,8 +48,9 @@ struct kvs_ktuple {
 
 /**
  * struct kvs_vtuple - a container for carrying a value
- * @vt_data: ptr to the value in-core memory or a special tomb value
- * @vt_xlen: opaque encoded length
+ * @vt_data:   ptr to the value in-core memory or a special tomb value
+ * @vt_xlen:   opaque encoded length
+ * @vt_expiry: expiry time of the value (see kvs_expired()), zero if none
  *
  * Always use kvs_vtuple_vlen() to learn the in-core length of a value.
  * If it returns zero then @kt_data likely is not a valid pointer but
@@ -49,12 +59,24 @@ struct kvs_ktuple {
 struct kvs_vtuple {
     void *vt_data;
     u64   vt_xlen;
+    u32   vt_expiry;
 };
 
+/**
+ * struct kvs_buf - a container for retrieving a value
+ * @b_buf:    caller's buffer
+ * @b_buf_sz: size of @b_buf
+ * @b_len:    length of the value (may exceed @b_buf_sz)
+ * @b_seq:    seqno of the merge operand, valid only for %FOUND_MOP, or for
+ *            a prefix probe that copied out a merge operand
+ * @b_expiry: expiry time of the value, valid only for a %FOUND_VAL from cN
+ */
 struct kvs_buf {
     void *b_buf;
     u32   b_buf_sz;
     u32   b_len;
+    u64   b_seq;
+    u32   b_expiry;
 };
 
 struct kvs_kvtuple {
@@ -77,6 +99,7 @@ struct kvs_vtuple_ref {
         } vi;
     };
     u64 vr_seq;
+    u64 vr_expiry;
 };
 
 static inline void
@@ -110,6 +133,7 @@ kvs_vtuple_init(struct kvs_vtuple *vt, void *val, u64 xlen)
 {
     vt->vt_data = val;
     vt->vt_xlen = xlen;
+    vt->vt_expiry = 0;
 }
 
 /**
@@ -131,6 +155,7 @@ kvs_vtuple_cinit(struct kvs_vtuple *vt, void *val, uint vlen, uint clen)
 
     vt->vt_data = val;
     vt->vt_xlen = ((u64)clen << 32) | vlen;
+    vt->vt_expiry = 0;
 }
 
 /**
@@ -144,7 +169,7 @@ static __always_inline uint
 kvs_vtuple_vlen(const struct kvs_vtuple *vt)
 {
     uint clen = vt->vt_xlen >> 32;
-    uint vlen = vt->vt_xlen & 0xfffffffful;
+    uint vlen = vt->vt_xlen & (HSE_XLEN_MOP - 1);
 
     return clen ?: vlen;
 }
@@ -155,11 +180,71 @@ kvs_vtuple_clen(const struct kvs_vtuple *vt)
     return vt->vt_xlen >> 32;
 }
 
+/**
+ * kvs_vtuple_mop() - return true if the vtuple is a merge operand
+ * @vt: ptr to a vtuple
+ */
+static __always_inline bool
+kvs_vtuple_mop(const struct kvs_vtuple *vt)
+{
+    return vt->vt_xlen & HSE_XLEN_MOP;
+}
+
+/*-  Value Expiry  ------------------------------------------------------------*/
+
+/* An expiry time is the wall clock time in seconds since the epoch at which
+ * a value expires, or zero if the value never expires.  An expired value is
+ * treated everywhere as a tombstone with the seqno of the value.
+ */
+
+static inline u64
+kvs_expiry_now(void)
+{
+    struct timespec ts;
+
+    get_realtime(&ts);
+
+    return ts.tv_sec;
+}
+
+/**
+ * kvs_expiry() - convert a time to live into an expiry time
+ * @ttl: time to live in seconds, zero for none
+ */
+static inline u32
+kvs_expiry(uint ttl)
+{
+    u64 expiry;
+
+    if (!ttl)
+        return 0;
+
+    expiry = kvs_expiry_now() + ttl;
+
+    return min_t(u64, expiry, U32_MAX);
+}
+
+static __always_inline bool
+kvs_expired_at(u64 expiry, u64 now)
+{
+    return expiry && expiry <= now;
+}
+
+/* Reads the clock only if the value has an expiry time.
+ */
+static __always_inline bool
+kvs_expired(u64 expiry)
+{
+    return expiry && expiry <= kvs_expiry_now();
+}
+
 static inline void
 kvs_buf_init(struct kvs_buf *vbuf, void *buf, u32 buf_size)
 {
     vbuf->b_buf = buf;
     vbuf->b_buf_sz = buf_size;
     vbuf->b_len = 0;
+    vbuf->b_seq = 0;
+    vbuf->b_expiry = 0;
 }
 #endif
@@ -37,6 +37,7 @@
 #include <hse_ikvdb/hse_params_internal.h>
 #include <hse_ikvdb/mclass_policy.h>
 #include "kvdb_omf.h"
+#include "kvdb_chunk.h"
 
 #include "kvdb_log.h"
 #include "kvdb_kvs.h"
@@ -1174,7 +1175,7 @@ ikvdb_low_mem_adjust(struct ikvdb_impl *self)
     if (rp->txn_ingest_delay == dflt.txn_ingest_delay)
         rp->txn_ingest_delay = 0;
 
-    c0kvs_reinit(rp->c0_heap_cache_sz_max);
+    c0kvs_reinit(rp->c0_heap_cache_sz_max, rp->c0_heap_huge);
 }
 
 merr_t
@@ -2027,6 +2028,14 @@ ikvdb_kvs_put(
         }
     }
 
+    if (os && os->kop_ttl) {
+        if (vt != &vtbuf) {
+            vtbuf = *vt;
+            vt = &vtbuf;
+        }
+        vtbuf.vt_expiry = kvs_expiry(os->kop_ttl);
+    }
+
     put_seqno = kvdb_kop_is_txn(os) ? 0 : HSE_SQNREF_SINGLE;
 
     err = ikvs_put(kk->kk_ikvs, os, kt, vt, put_seqno);
@@ -2045,6 +2054,165 @@ ikvdb_kvs_put(
     return 0;
 }
 
+static merr_t
+ikvdb_write_batch_impl(
+    struct ikvdb_impl *     self,
+    struct hse_kvdb_opspec *os,
+    struct ikvdb_batch_op * opv,
+    uint                    opc)
+{
+    struct c0sk_batch_op *c0opv;
+    size_t                cbufsz = 0, coff = 0, cused = 0;
+    char *                cbuf = NULL;
+    u64                   start, len;
+    merr_t                err;
+    uint                  i, n;
+    u32                   expiry;
+
+    start = kvdb_kop_is_priority(os) ? 0 : get_cycles();
+
+    if (ev(!opv || opc == 0 || opc > HSE_KVS_BATCH_MAX))
+        return merr(EINVAL);
+
+    /* Batches are applied directly to c0sk, bypassing the txn. */
+    if (ev(kvdb_kop_is_txn(os)))
+        return merr(EINVAL);
+
+    if (ev(self->ikdb_rdonly))
+        return merr(EROFS);
+
+    /* puts do not stop on block deletion failures. */
+    err = kvdb_health_check(
+        &self->ikdb_health, KVDB_HEALTH_FLAG_ALL & ~KVDB_HEALTH_FLAG_DELBLKFAIL);
+    if (ev(err))
+        return err;
+
+    c0opv = malloc(sizeof(*c0opv) * opc);
+    if (ev(!c0opv))
+        return merr(ENOMEM);
+
+    expiry = os ? kvs_expiry(os->kop_ttl) : 0;
+
+    for (i = n = 0, len = 0; i < opc; ++i) {
+        struct kvdb_kvs *     kk = (struct kvdb_kvs *)opv[i].bo_kvs;
+        struct c0sk_batch_op *op = c0opv + n;
+        uint                  vlen, clen;
+        size_t                need;
+
+        if (ev(!kk || kk->kk_parent != self)) {
+            err = merr(EINVAL);
+            goto errout;
+        }
+
+        op->op_kt = opv[i].bo_kt;
+        op->op_vt = opv[i].bo_vt;
+        op->op_tomb = opv[i].bo_tomb;
+
+        err = ikvs_batch_op_init(kk->kk_ikvs, op);
+        if (ev(err))
+            goto errout;
+
+        ++n;
+        len += op->op_kt.kt_len;
+
+        if (op->op_tomb)
+            continue;
+
+        op->op_vt.vt_expiry = expiry;
+
+        vlen = kvs_vtuple_vlen(&op->op_vt);
+        clen = kvs_vtuple_clen(&op->op_vt);
+        len += vlen;
+
+        if (clen > 0 || vlen <= kk->kk_vcompmin)
+            continue;
+
+        /* Compressed values are packed into cbuf, which must remain
+         * intact until they have been copied into c0.  If cbuf is full
+         * then flush all the ops preceding this one.
+         */
+        need = vlen + PAGE_SIZE * 2;
+
+        if (coff + need > cbufsz) {
+            if (!cbuf) {
+                cbufsz = VLB_ALLOCSZ_MAX;
+                cbuf = vlb_alloc(cbufsz);
+                if (ev(!cbuf)) {
+                    cbufsz = 0;
+                    continue;
+                }
+            } else {
+                err = c0sk_putdelv(self->ikdb_c0sk, c0opv, n - 1, HSE_SQNREF_SINGLE);
+                if (ev(err))
+                    goto errout;
+
+                c0opv[0] = *op;
+                op = c0opv;
+                n = 1;
+                cused = max_t(size_t, cused, coff);
+                coff = 0;
+            }
+        }
+
+        if (!kk->kk_vcompress(op->op_vt.vt_data, vlen, cbuf + coff, cbufsz - coff, &clen) &&
+            clen < vlen) {
+            kvs_vtuple_cinit(&op->op_vt, cbuf + coff, vlen, clen);
+            op->op_vt.vt_expiry = expiry;
+            coff += clen;
+            len -= vlen - clen;
+        }
+    }
+
+    err = c0sk_putdelv(self->ikdb_c0sk, c0opv, n, HSE_SQNREF_SINGLE);
+    if (err) {
+        ev(merr_errno(err) != ECANCELED);
+        goto errout;
+    }
+
+    if (start > 0)
+        ikvdb_throttle(self, start, min_t(u64, len, U32_MAX));
+
+errout:
+    if (cbuf)
+        vlb_free(cbuf, max_t(size_t, cused, coff));
+    free(c0opv);
+
+    return err;
+}
+
+merr_t
+ikvdb_kvs_put_batch(
+    struct hse_kvs *        handle,
+    struct hse_kvdb_opspec *os,
+    struct ikvdb_batch_op * opv,
+    uint                    opc)
+{
+    struct kvdb_kvs *kk = (struct kvdb_kvs *)handle;
+    uint             i;
+
+    if (ev(!handle))
+        return merr(EINVAL);
+
+    for (i = 0; i < opc; ++i)
+        if (ev(opv[i].bo_kvs != handle))
+            return merr(EINVAL);
+
+    return ikvdb_write_batch_impl(kk->kk_parent, os, opv, opc);
+}
+
+merr_t
+ikvdb_write_batch(
+    struct ikvdb *          handle,
+    struct hse_kvdb_opspec *os,
+    struct ikvdb_batch_op * opv,
+    uint                    opc)
+{
+    if (ev(!handle))
+        return merr(EINVAL);
+
+    return ikvdb_write_batch_impl(ikvdb_h2r(handle), os, opv, opc);
+}
+
 merr_t
 ikvdb_kvs_pfx_probe(
     struct hse_kvs *        handle,
@@ -2110,6 +2278,98 @@ ikvdb_kvs_get(
     return ikvs_get(kk->kk_ikvs, os, kt, view_seqno, res, vbuf);
 }
 
+merr_t
+ikvdb_kvs_get_async(
+    struct hse_kvs *        handle,
+    struct hse_kvdb_opspec *os,
+    struct kvs_ktuple *     kt,
+    struct kvs_buf *        vbuf,
+    hse_kvs_get_cb *        cb,
+    void *                  arg)
+{
+    struct kvdb_kvs *  kk = (struct kvdb_kvs *)handle;
+    struct ikvdb_impl *p;
+    u64                view_seqno;
+
+    if (ev(!handle))
+        return merr(EINVAL);
+
+    p = kk->kk_parent;
+
+    if (kvdb_kop_is_txn(os)) {
+        view_seqno = 0;
+    } else {
+        view_seqno = atomic64_read(&p->ikdb_seqno);
+        kvdb_ctxn_set_wait_commits(p->ikdb_ctxn_set);
+    }
+
+    return ikvs_get_async(kk->kk_ikvs, os, kt, view_seqno, vbuf, cb, arg);
+}
+
+merr_t
+ikvdb_kvs_get_pinned(
+    struct hse_kvs *        handle,
+    struct hse_kvdb_opspec *os,
+    struct kvs_ktuple *     kt,
+    enum key_lookup_res *   res,
+    struct kvs_pin **       pinp)
+{
+    struct kvdb_kvs *  kk = (struct kvdb_kvs *)handle;
+    struct ikvdb_impl *p;
+    u64                view_seqno;
+
+    if (ev(!handle))
+        return merr(EINVAL);
+
+    p = kk->kk_parent;
+
+    if (kvdb_kop_is_txn(os)) {
+        view_seqno = 0;
+    } else {
+        view_seqno = atomic64_read(&p->ikdb_seqno);
+        kvdb_ctxn_set_wait_commits(p->ikdb_ctxn_set);
+    }
+
+    return ikvs_get_pinned(kk->kk_ikvs, os, kt, view_seqno, res, pinp);
+}
+
+void
+ikvdb_kvs_pin_release(struct kvs_pin *pin)
+{
+    ikvs_pin_release(pin);
+}
+
+merr_t
+ikvdb_kvs_get_batch(
+    struct hse_kvs *        handle,
+    struct hse_kvdb_opspec *os,
+    struct kvs_ktuple *     ktv,
+    enum key_lookup_res *   resv,
+    struct kvs_buf *        vbufv,
+    uint                    cnt)
+{
+    struct kvdb_kvs *  kk = (struct kvdb_kvs *)handle;
+    struct ikvdb_impl *p;
+    u64                view_seqno;
+
+    if (ev(!handle))
+        return merr(EINVAL);
+
+    p = kk->kk_parent;
+
+    /* Establish one view for the entire batch so that the commit wait
+     * is paid once rather than once per key.
+     */
+    if (kvdb_kop_is_txn(os)) {
+        view_seqno = 0;
+    } else {
+        view_seqno = atomic64_read(&p->ikdb_seqno);
+        kvdb_ctxn_set_wait_commits(p->ikdb_ctxn_set);
+    }
+
+    return ikvs_get_batch(kk->kk_ikvs, os, ktv, view_seqno, resv, vbufv, cnt);
+}
+
 merr_t
 ikvdb_kvs_del(struct hse_kvs *handle, struct hse_kvdb_opspec *os, struct kvs_ktuple *kt)
 {
@@ -2183,6 +2443,226 @@ ikvdb_kvs_prefix_delete(
     return 0;
 }
 
+merr_t
+ikvdb_kvs_range_delete(
+    struct hse_kvs *        handle,
+    struct hse_kvdb_opspec *os,
+    struct kvs_ktuple *     start,
+    struct kvs_ktuple *     end)
+{
+    struct kvdb_kvs *  kk = (struct kvdb_kvs *)handle;
+    struct ikvdb_impl *parent;
+    merr_t             err;
+    u64                seqno;
+
+    if (ev(!handle))
+        return merr(EINVAL);
+
+    parent = kk->kk_parent;
+    if (ev(parent->ikdb_rdonly))
+        return merr(EROFS);
+
+    /* Range tombstones are applied directly to c0, bypassing the txn. */
+    if (ev(kvdb_kop_is_txn(os)))
+        return merr(EINVAL);
+
+    if (ev(keycmp(start->kt_data, start->kt_len, end->kt_data, end->kt_len) >= 0))
+        return merr(EINVAL);
+
+    err = kvdb_health_check(
+        &parent->ikdb_health, KVDB_HEALTH_FLAG_ALL & ~KVDB_HEALTH_FLAG_DELBLKFAIL);
+    if (ev(err))
+        return err;
+
+    err = ikvs_range_del(kk->kk_ikvs, start, end, &seqno);
+    if (ev(err))
+        return err;
+
+    /* Range tombstones are not logged to c1, so c1 replay after a crash
+     * would restore the keys they delete.  Make the range delete durable
+     * before returning by ingesting it into cN, which also moves c1's
+     * replay point past every write it covers.
+     */
+    return ikvdb_sync_int(parent);
+}
+
+merr_t
+ikvdb_kvs_merge(
+    struct hse_kvs *        handle,
+    struct hse_kvdb_opspec *os,
+    struct kvs_ktuple *     kt,
+    const void *            operand,
+    size_t                  len)
+{
+    struct kvdb_kvs *  kk = (struct kvdb_kvs *)handle;
+    struct ikvdb_impl *parent;
+    merr_t             err;
+    u64                start;
+
+    start = kvdb_kop_is_priority(os) ? 0 : get_cycles();
+
+    if (ev(!handle))
+        return merr(EINVAL);
+
+    parent = kk->kk_parent;
+    if (ev(parent->ikdb_rdonly))
+        return merr(EROFS);
+
+    /* Merge operands are resolved against committed data. */
+    if (ev(kvdb_kop_is_txn(os)))
+        return merr(EINVAL);
+
+    err = kvdb_health_check(
+        &parent->ikdb_health, KVDB_HEALTH_FLAG_ALL & ~KVDB_HEALTH_FLAG_DELBLKFAIL);
+    if (ev(err))
+        return err;
+
+    err = ikvs_merge(kk->kk_ikvs, os, kt, operand, len, HSE_SQNREF_SINGLE);
+    if (err) {
+        ev(merr_errno(err) != ECANCELED);
+        return err;
+    }
+
+    if (start > 0)
+        ikvdb_throttle(parent, start, kt->kt_len + len);
+
+    return 0;
+}
+
+merr_t
+ikvdb_kvs_merge_fn_set(struct hse_kvs *handle, hse_kvs_merge_fn *fn, void *arg)
+{
+    struct kvdb_kvs *kk = (struct kvdb_kvs *)handle;
+
+    if (ev(!handle))
+        return merr(EINVAL);
+
+    ikvs_merge_fn_set(kk->kk_ikvs, fn, arg);
+
+    return 0;
+}
+
+/*-  IKVDB Bulk Load  ------------------------------------------------*/
+
+/**
+ * struct hse_kvs_load - a bulk load into a kvs
+ * @kl_kvs:  kvs being loaded
+ * @kl_load: cn bulk load
+ */
+struct hse_kvs_load {
+    struct kvdb_kvs *kl_kvs;
+    struct cn_load * kl_load;
+};
+
+merr_t
+ikvdb_kvs_load_begin(
+    struct hse_kvs *        handle,
+    struct hse_kvdb_opspec *os,
+    struct hse_kvs_load **  loadp)
+{
+    struct kvdb_kvs *    kk = (struct kvdb_kvs *)handle;
+    struct ikvdb_impl *  parent;
+    struct hse_kvs_load *load;
+    merr_t               err;
+    u64                  seqno;
+
+    if (ev(!handle || !loadp))
+        return merr(EINVAL);
+
+    parent = kk->kk_parent;
+    if (ev(parent->ikdb_rdonly))
+        return merr(EROFS);
+
+    if (ev(kvdb_kop_is_txn(os)))
+        return merr(EINVAL);
+
+    err = kvdb_health_check(&parent->ikdb_health, KVDB_HEALTH_FLAG_ALL);
+    if (ev(err))
+        return err;
+
+    load = malloc(sizeof(*load));
+    if (ev(!load))
+        return merr(ENOMEM);
+
+    /* Like a ptomb, the load takes a new seqno so that it is newer than
+     * everything written before it began.
+     */
+    seqno = atomic64_add_return(1, &parent->ikdb_seqno);
+
+    err = cn_load_create(
+        kvs_cn(kk->kk_ikvs), seqno, os ? kvs_expiry(os->kop_ttl) : 0, &load->kl_load);
+    if (ev(err)) {
+        free(load);
+        return err;
+    }
+
+    load->kl_kvs = kk;
+    *loadp = load;
+
+    return 0;
+}
+
+merr_t
+ikvdb_kvs_load_put(struct hse_kvs_load *load, struct kvs_ktuple *kt, const struct kvs_vtuple *vt)
+{
+    struct kvdb_kvs * kk = load->kl_kvs;
+    struct kvs_vtuple vtbuf;
+    uint              vlen, clen;
+    merr_t            err;
+
+    vlen = kvs_vtuple_vlen(vt);
+    clen = kvs_vtuple_clen(vt);
+
+    /* Only values that fit the thread-local buffer are compressed,
+     * a bulk load cannot afford an allocation per value.
+     */
+    if (clen == 0 && vlen > kk->kk_vcompmin && vlen <= kk->kk_vcompbnd) {
+        err = kk->kk_vcompress(vt->vt_data, vlen, tls_vbuf, tls_vbufsz, &clen);
+
+        if (!err && clen < vlen) {
+            kvs_vtuple_cinit(&vtbuf, tls_vbuf, vlen, clen);
+            vt = &vtbuf;
+        }
+    }
+
+    return cn_load_add(load->kl_load, kt, vt);
+}
+
+merr_t
+ikvdb_kvs_load_commit(struct hse_kvs_load *load)
+{
+    struct ikvdb_impl *parent = load->kl_kvs->kk_parent;
+    merr_t             err;
+
+    /* Everything written before the load began must reach cN ahead of
+     * the load's kvsets, lest it hide the load when ingested later.
+     * Writes made since, which the load would hide, are then in cN for
+     * cn_load_commit() to find.
+     */
+    err = c0sk_sync(parent->ikdb_c0sk);
+    if (!ev(err))
+        err = cn_load_commit(load->kl_load);
+
+    /* The loaded keys bypassed c0, so cached misses and values may
+     * now be stale.
+     */
+    c0sk_cache_flush(parent->ikdb_c0sk);
+
+    ikvdb_kvs_load_abort(load);
+
+    return err;
+}
+
+void
+ikvdb_kvs_load_abort(struct hse_kvs_load *load)
+{
+    if (!load)
+        return;
+
+    cn_load_destroy(load->kl_load);
+    free(load);
+}
+
 /*-  IKVDB Cursors --------------------------------------------------*/
 
 /*
@@ -2700,6 +3180,51 @@ ikvdb_kvs_cursor_read(
     return 0;
 }
 
+merr_t
+ikvdb_kvs_cursor_read_many(
+    struct hse_kvs_cursor *      cur,
+    struct hse_kvdb_opspec *     os,
+    void *                       buf,
+    size_t                       buf_sz,
+    struct hse_kvs_cursor_kvoff *kvov,
+    uint                         max_cnt,
+    uint *                       cnt,
+    bool *                       eof)
+{
+    merr_t err;
+    u64    tstart;
+
+    tstart = perfc_lat_start(cur->kc_pkvsl_pc);
+
+    *cnt = 0;
+
+    if (ev(kvdb_kop_is_txn(os)))
+        return merr(EINVAL);
+
+    if (ev(cur->kc_err)) {
+        if (ev(merr_errno(cur->kc_err) != EAGAIN))
+            return cur->kc_err;
+
+        cur->kc_err = ikvs_cursor_update(cur, cur->kc_seq);
+        if (ev(cur->kc_err))
+            return cur->kc_err;
+    }
+
+    if (cur->kc_bind) {
+        cur->kc_err = cursor_refresh(cur);
+        if (ev(cur->kc_err))
+            return cur->kc_err;
+    }
+
+    err = ikvs_cursor_read_many(cur, buf, buf_sz, kvov, max_cnt, cnt, eof);
+    if (ev(err))
+        return err;
+
+    perfc_lat_record(cur->kc_pkvsl_pc, PERFC_LT_PKVSL_KVS_CURSOR_READMANY, tstart);
+
+    return 0;
+}
+
 merr_t
 ikvdb_kvs_cursor_destroy(struct hse_kvs_cursor *cur)
 {
@@ -3171,12 +3696,168 @@ ikvdb_kvs_import(struct work_struct *work)
     bak->bak_err = err;
 }
 
+/* Uncompressed size of an export data chunk.  A chunk is closed by the
+ * first k-v pair that reaches this size, hence the buffer slop.
+ */
+#define KVDB_EXPORT_CHUNK_SZ (4u << 20)
+#define KVDB_EXPORT_CHUNK_BUFSZ \
+    (KVDB_EXPORT_CHUNK_SZ + sizeof(struct kvdb_kvmeta_omf) + HSE_KVS_KLEN_MAX + HSE_KVS_VLEN_MAX)
+
+/**
+ * ikvdb_kvs_import_file() - feed the chunks of a data file into a bulk load
+ * @load:  bulk load handle
+ * @fname: data file name
+ * @ubuf:  buffer of KVDB_EXPORT_CHUNK_BUFSZ bytes for decompressed chunks
+ * @cnt:   (output) incremented by the number of k-v pairs loaded
+ */
+static merr_t
+ikvdb_kvs_import_file(struct hse_kvs_load *load, const char *fname, void *ubuf, u64 *cnt)
+{
+    struct kvs_ktuple kt;
+    struct kvs_vtuple vt;
+    struct stat       st;
+    const void *      key, *val;
+    const void *      rec, *rend;
+    void *            dbuf, *beg, *end;
+    size_t            klen, vlen, len;
+    uint              ulen;
+    merr_t            err = 0;
+    int               fd;
+
+    fd = open(fname, O_RDONLY, 0);
+    if (fd == -1) {
+        err = merr(errno);
+        hse_elog(HSE_ERR "Failed to open file %s, @@e", err, fname);
+        return err;
+    }
+
+    if (fstat(fd, &st) != 0) {
+        err = merr(ev(errno, HSE_ERR));
+        close(fd);
+        return err;
+    }
+
+    dbuf = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (dbuf == MAP_FAILED) {
+        err = merr(errno);
+        close(fd);
+        hse_elog(HSE_ERR "Failed to mmap file %s %lu, @@e", err, fname, (ulong)st.st_size);
+        return err;
+    }
+
+    /* Each file is read exactly once, front to back. */
+    madvise(dbuf, st.st_size, MADV_SEQUENTIAL);
+
+    beg = dbuf;
+    end = dbuf + st.st_size;
+
+    while (beg < end) {
+        err = kvdb_chunk_unpack(beg, end - beg, ubuf, KVDB_EXPORT_CHUNK_BUFSZ, &rec, &ulen, &len);
+        if (err) {
+            hse_elog(HSE_ERR "Invalid chunk at offset %lu of %s, @@e",
+                     err, (ulong)(beg - dbuf), fname);
+            break;
+        }
+
+        beg += len;
+        rend = rec + ulen;
+
+        while (rec < rend) {
+            err = kvdb_chunk_kv_next(&rec, rend, &key, &klen, &val, &vlen);
+            if (err) {
+                hse_elog(HSE_ERR "Invalid record in chunk ending at offset %lu of %s, @@e",
+                         err, (ulong)(beg - dbuf), fname);
+                goto errout;
+            }
+
+            kvs_ktuple_init_nohash(&kt, key, klen);
+            kvs_vtuple_init(&vt, (void *)val, vlen);
+
+            err = ikvdb_kvs_load_put(load, &kt, &vt);
+            if (err) {
+                hse_elog(HSE_ERR "Failed to load key value pair, @@e", err);
+                goto errout;
+            }
+
+            ++*cnt;
+        }
+    }
+
+errout:
+    munmap(dbuf, st.st_size);
+    close(fd);
+
+    return err;
+}
+
+/**
+ * ikvdb_kvs_import_range() - import one key range of an exported kvs
+ * @work:
+ *
+ * The key ranges of a kvs are disjoint and each range's data files hold
+ * its keys in order, so every range is fed into a bulk load of its own
+ * and the ranges of a kvs are imported in parallel.
+ */
+static void
+ikvdb_kvs_import_range(struct work_struct *work)
+{
+    struct kvdb_bak_work *bak;
+    struct hse_kvs_load * load;
+    char                  fname[PATH_MAX];
+    void *                ubuf;
+    merr_t                err;
+    u64                   cnt = 0;
+    int                   i, len;
+
+    bak = container_of(work, struct kvdb_bak_work, bak_work);
+
+    ubuf = malloc(KVDB_EXPORT_CHUNK_BUFSZ);
+    if (!ubuf) {
+        bak->bak_err = merr(ev(ENOMEM, HSE_ERR));
+        return;
+    }
+
+    err = ikvdb_kvs_load_begin(bak->bak_kvs, NULL, &load);
+    if (ev(err)) {
+        bak->bak_err = err;
+        free(ubuf);
+        return;
+    }
+
+    for (i = 0; i < bak->bak_fcnt && !err; i++) {
+        len = snprintf(fname, sizeof(fname), "%s_%d", bak->bak_fname, i);
+        if (len >= sizeof(fname)) {
+            err = merr(EINVAL);
+            hse_elog(HSE_ERR "File name %s is truncated, @@e", err, fname);
+            break;
+        }
+
+        hse_log(HSE_DEBUG "Import start on %s", fname);
+
+        err = ikvdb_kvs_import_file(load, fname, ubuf, &cnt);
+    }
+
+    if (!err)
+        err = ikvdb_kvs_load_commit(load);
+    else
+        ikvdb_kvs_load_abort(load);
+
+    free(ubuf);
+
+    hse_log(
+        HSE_DEBUG "Import %ld out of %ld k-v pairs from %s", cnt, bak->bak_kvcnt, bak->bak_fname);
+
+    bak->bak_err = err;
+}
+
 /**
  * KVDB_DUMP_CUR_VER - dump version understood by this binary
- * @KVDB_DUMP_VER1:
+ * @KVDB_DUMP_VER1: one stream of raw k-v pairs per kvs
+ * @KVDB_DUMP_VER2: kvs split into key ranges, data stored in lz4 chunks
  */
 #define KVDB_DUMP_VER1 1
-#define KVDB_DUMP_CUR_VER KVDB_DUMP_VER1
+#define KVDB_DUMP_VER2 2
+#define KVDB_DUMP_CUR_VER KVDB_DUMP_VER2
 
 /**
  * ikvdb_import_toc() - import kvdb/kvs meta data from TOC file
@@ -3186,9 +3867,10 @@ ikvdb_kvs_import(struct work_struct *work)
  * @kvscnt: number of kvs in this kvdb
  * @kvsi: import meta data into kvsi structs
  *
- * An example of a TOC file in JSON format
+ * An example of a TOC file in JSON format, "ranges" holds the number of
+ * data files of each key range of a kvs (version 2 and later)
  * {
- *      "version":      1,
+ *      "version":      2,
  *      "name":        "db1",
  *      "kvscnt":       1,
  *      "cndb_captgt":  0,
@@ -3198,6 +3880,7 @@ ikvdb_kvs_import(struct work_struct *work)
  *            "name":        "kvs1",
  *            "filecnt":      64,
  *            "kvcnt":        1000000000,
+ *            "ranges":       [4, 4, ..., 4],
  *            "pfx_len":      0,
  *            "fanout":       8,
  *            "kvs_ext01":    0
@@ -3355,6 +4038,22 @@ ikvdb_import_toc(
         kvsi[i].kvsi_fcnt = cJSON_GetObjectItem(kvs_json, "filecnt")->valueint;
         kvsi[i].kvsi_kvcnt = cJSON_GetObjectItem(kvs_json, "kvcnt")->valueint;
 
+        kvsi[i].kvsi_rcnt = 0;
+        if (ver >= KVDB_DUMP_VER2) {
+            cJSON *ranges = cJSON_GetObjectItem(kvs_json, "ranges");
+            int    r, rcnt = cJSON_GetArraySize(ranges);
+
+            if (rcnt > KVDB_EXPORT_RANGES_MAX) {
+                err = merr(EINVAL);
+                hse_elog(HSE_ERR "Too many key ranges %d in kvs %s, @@e", err, rcnt, name);
+                goto errout;
+            }
+
+            for (r = 0; r < rcnt; r++)
+                kvsi[i].kvsi_rfcntv[r] = cJSON_GetArrayItem(ranges, r)->valueint;
+            kvsi[i].kvsi_rcnt = rcnt;
+        }
+
         snprintf(
             val_buf, sizeof(val_buf), "%d", cJSON_GetObjectItem(kvs_json, "pfx_len")->valueint);
         err = hse_params_set(kvsi[i].kvsi_params, "kvs.pfx_len", val_buf);
@@ -3418,18 +4117,21 @@ ikvdb_import(struct ikvdb *handle, const char *path)
         return err;
     }
 
-    /* Count the total number of data files */
+    /* Count the total number of import jobs */
     total = 0;
     for (i = 0; i < kvscnt; i++) {
-        if (kvsi[i].kvsi_kvcnt > 0)
+        if (kvsi[i].kvsi_rcnt > 0)
+            total += kvsi[i].kvsi_rcnt;
+        else if (kvsi[i].kvsi_kvcnt > 0)
             total += kvsi[i].kvsi_fcnt;
     }
 
     /*
-     * During kvdb export, the data in each kvs is dumped into multiple
-     * data files, 4GB each.
-     * We will next create one workqueue job for each of these data files
-     * and queue them into a workqueue
+     * During kvdb export, the data in each kvs is split into key ranges
+     * and each range is dumped into one or more data files, 4GB each.
+     * We will next create one workqueue job for each of these ranges
+     * (or for each data file of a version 1 export) and queue them into
+     * a workqueue
      */
     bak = calloc(total, sizeof(*bak));
     if (!bak) {
@@ -3438,7 +4140,7 @@ ikvdb_import(struct ikvdb *handle, const char *path)
         return err;
     }
 
-    wq = alloc_workqueue("dbimport", 0, WQ_MAX_ACTIVE);
+    wq = alloc_workqueue("dbimport", 0, num_online_cpus());
     if (!wq) {
         err = merr(ENOMEM);
         hse_elog(HSE_ERR "Failed to alloc import workqueues, @@e", err);
@@ -3465,10 +4167,36 @@ ikvdb_import(struct ikvdb *handle, const char *path)
             break;
         }
 
+        /*
+         * Create one workqueue job for each non-empty key range
+         */
+        for (j = 0; j < kvsi[i].kvsi_rcnt; j++) {
+            if (!kvsi[i].kvsi_rfcntv[j])
+                continue;
+
+            bak[job].bak_kvs = kvsi[i].kvsi_kvs;
+            bak[job].bak_fcnt = kvsi[i].kvsi_rfcntv[j];
+            len = snprintf(
+                bak[job].bak_fname,
+                sizeof(bak[job].bak_fname),
+                "%s/%s_%d",
+                path,
+                kvsi[i].kvsi_name,
+                j);
+            if (len >= sizeof(bak[job].bak_fname)) {
+                err = merr(EINVAL);
+                hse_elog(HSE_ERR "name %s is truncated, @@e", err, bak[job].bak_fname);
+                goto errout;
+            }
+            INIT_WORK(&bak[job].bak_work, ikvdb_kvs_import_range);
+            queue_work(wq, &bak[job].bak_work);
+            job++;
+        }
+
         /*
          * Create one workqueue job for each data file
          */
-        if (kvsi[i].kvsi_kvcnt > 0) {
+        if (kvsi[i].kvsi_rcnt == 0 && kvsi[i].kvsi_kvcnt > 0) {
             for (j = 0; j < kvsi[i].kvsi_fcnt; j++) {
                 bak[job].bak_kvs = kvsi[i].kvsi_kvs;
                 len = snprintf(
@@ -3522,10 +4250,47 @@ errout:
 }
 
 /**
- * ikvdb_kvs_export(): worker function for exporting a kvs into
- *                     one or multiple data files, each data file
- *                     has a 4GB size limit
+ * ikvdb_kvs_export_chunk() - compress and write one chunk of k-v pairs
+ * @f:     data file
+ * @ubuf:  k-v pairs to write
+ * @ulen:  length of @ubuf
+ * @kvcnt: number of k-v pairs in @ubuf
+ * @cbuf:  compression buffer
+ * @cbufsz: size of @cbuf
+ * @wlen:  (output) number of bytes written to @f
+ */
+static merr_t
+ikvdb_kvs_export_chunk(
+    FILE *      f,
+    const void *ubuf,
+    uint        ulen,
+    uint        kvcnt,
+    void *      cbuf,
+    uint        cbufsz,
+    u64 *       wlen)
+{
+    struct kvdb_chunk_omf chnk;
+    const void *          data;
+    uint                  dlen;
+
+    kvdb_chunk_pack(ubuf, ulen, kvcnt, cbuf, cbufsz, &chnk, &data, &dlen);
+
+    if (fwrite(&chnk, sizeof(chnk), 1, f) != 1 || fwrite(data, dlen, 1, f) != 1)
+        return merr(ev(EIO, HSE_ERR));
+
+    *wlen = sizeof(chnk) + dlen;
+
+    return 0;
+}
+
+/**
+ * ikvdb_kvs_export(): worker function for exporting one key range of a
+ *                     kvs into one or multiple data files, each data
+ *                     file has a 4GB size limit
  * @work
+ *
+ * The k-v pairs are gathered into chunks of KVDB_EXPORT_CHUNK_SZ bytes,
+ * each of which is lz4 compressed before it is written out.
  */
 static void
 ikvdb_kvs_export(struct work_struct *work)
@@ -3535,10 +4300,13 @@ ikvdb_kvs_export(struct work_struct *work)
     struct kvdb_kvmeta_omf kvmt;
     const void *           key, *val;
     size_t                 klen, vlen;
+    void *                 ubuf, *cbuf;
+    uint                   ulen, cbufsz, kvcnt;
     bool                   eof;
     FILE *                 f = 0;
     int                    fd;
     u64                    fsize = -1;
+    u64                    wlen;
     int                    filecnt = 0;
     char                   fname[PATH_MAX];
     int                    len;
@@ -3549,9 +4317,48 @@ ikvdb_kvs_export(struct work_struct *work)
 
     cur = bak->bak_cur;
 
+    cbufsz = compress_lz4_ops.cop_estimate(NULL, KVDB_EXPORT_CHUNK_BUFSZ);
+
+    ubuf = malloc(KVDB_EXPORT_CHUNK_BUFSZ);
+    cbuf = malloc(cbufsz);
+    if (!ubuf || !cbuf) {
+        bak->bak_err = merr(ev(ENOMEM, HSE_ERR));
+        goto errout;
+    }
+
+    ulen = kvcnt = 0;
     eof = false;
 
-    while (true) {
+    while (!eof) {
+        bak->bak_err = ikvdb_kvs_cursor_read(cur, 0, &key, &klen, &val, &vlen, &eof);
+        if (ev(bak->bak_err, HSE_ERR))
+            break;
+
+        /* The range ends just before the next range's first key. */
+        if (!eof && bak->bak_eklen && keycmp(key, klen, bak->bak_ekey, bak->bak_eklen) >= 0)
+            eof = true;
+
+        if (!eof) {
+            /* Convert kvmt to little endian, if needed */
+            omf_set_kvmt_klen(&kvmt, klen);
+            omf_set_kvmt_vlen(&kvmt, vlen);
+            memcpy(ubuf + ulen, &kvmt, sizeof(kvmt));
+            ulen += sizeof(kvmt);
+            memcpy(ubuf + ulen, key, klen);
+            ulen += klen;
+            memcpy(ubuf + ulen, val, vlen);
+            ulen += vlen;
+
+            kvcnt++;
+            bak->bak_kvcnt++;
+
+            if (ulen < KVDB_EXPORT_CHUNK_SZ)
+                continue;
+        }
+
+        if (!ulen)
+            break;
+
         /*
          * Create a new data file, if the current one exceeds
          * the size limit
@@ -3592,26 +4399,20 @@ ikvdb_kvs_export(struct work_struct *work)
             }
         }
 
-        bak->bak_err = ikvdb_kvs_cursor_read(cur, 0, &key, &klen, &val, &vlen, &eof);
-        if (ev(bak->bak_err, HSE_ERR))
-            break;
-
-        if (eof)
+        bak->bak_err = ikvdb_kvs_export_chunk(f, ubuf, ulen, kvcnt, cbuf, cbufsz, &wlen);
+        if (ev(bak->bak_err))
             break;
 
-        /* Convert kvmt to little endian, if needed */
-        omf_set_kvmt_klen(&kvmt, klen);
-        omf_set_kvmt_vlen(&kvmt, vlen);
-        fwrite(&kvmt, sizeof(kvmt), 1, f);
-        fwrite(key, sizeof(char), klen, f);
-        fwrite(val, sizeof(char), vlen, f);
-
-        bak->bak_kvcnt++;
-        fsize += klen + vlen + sizeof(klen) + sizeof(vlen);
+        fsize += wlen;
+        ulen = kvcnt = 0;
     }
 
-    if (f)
-        fclose(f);
+    if (f && fclose(f) && !bak->bak_err)
+        bak->bak_err = merr(ev(errno, HSE_ERR));
+
+errout:
+    free(cbuf);
+    free(ubuf);
 
     ikvdb_kvs_cursor_destroy(cur);
 
@@ -3626,22 +4427,26 @@ ikvdb_kvs_export(struct work_struct *work)
  * @kvscnt:
  * @kvsv: kvs names
  * @kvs_cparams:
- * @bak:
+ * @bakv: per kvs vector of export jobs, one per key range
+ * @rcntv: per kvs number of key ranges
  */
 static merr_t
 ikvdb_export_toc(
-    const char *          path,
-    const char *          mp_name,
-    struct kvdb_cparams * kvdb_cparams,
-    int                   kvscnt,
-    char **               kvsv,
-    struct kvs_cparams *  kvs_cparams,
-    struct kvdb_bak_work *bak)
+    const char *           path,
+    const char *           mp_name,
+    struct kvdb_cparams *  kvdb_cparams,
+    int                    kvscnt,
+    char **                kvsv,
+    struct kvs_cparams *   kvs_cparams,
+    struct kvdb_bak_work **bakv,
+    uint *                 rcntv)
 {
     int    i;
+    uint   r;
     cJSON *TOC;
     cJSON *kvs;
     cJSON *KVSs = NULL;
+    cJSON *ranges;
     char * string = NULL;
     merr_t err = 0;
     char   fname[PATH_MAX];
@@ -3650,6 +4455,7 @@ ikvdb_export_toc(
     int    len;
     int    ver = KVDB_DUMP_CUR_VER;
     u32    crc, crc_le;
+    u64    fcnt, kvcnt;
 
     TOC = cJSON_CreateObject();
     if (!TOC) {
@@ -3675,9 +4481,24 @@ ikvdb_export_toc(
             break;
         }
 
+        ranges = cJSON_CreateArray();
+        if (!ranges) {
+            cJSON_Delete(kvs);
+            err = merr(ev(ENOMEM, HSE_ERR));
+            break;
+        }
+
+        fcnt = kvcnt = 0;
+        for (r = 0; r < rcntv[i]; r++) {
+            cJSON_AddItemToArray(ranges, cJSON_CreateNumber(bakv[i][r].bak_fcnt));
+            fcnt += bakv[i][r].bak_fcnt;
+            kvcnt += bakv[i][r].bak_kvcnt;
+        }
+
         cJSON_AddStringToObject(kvs, "name", kvsv[i]);
-        cJSON_AddNumberToObject(kvs, "filecnt", bak[i].bak_fcnt);
-        cJSON_AddNumberToObject(kvs, "kvcnt", bak[i].bak_kvcnt);
+        cJSON_AddNumberToObject(kvs, "filecnt", fcnt);
+        cJSON_AddNumberToObject(kvs, "kvcnt", kvcnt);
+        cJSON_AddItemToObject(kvs, "ranges", ranges);
         cJSON_AddNumberToObject(kvs, "pfx_len", kvs_cparams[i].cp_pfx_len);
         cJSON_AddNumberToObject(kvs, "pfx_pivot", kvs_cparams[i].cp_pfx_pivot);
         cJSON_AddNumberToObject(kvs, "fanout", kvs_cparams[i].cp_fanout);
@@ -3734,15 +4555,20 @@ ikvdb_export(struct ikvdb *handle, struct kvdb_cparams *kvdb_cparams, const char
 {
     struct ikvdb_impl *      kvdb = ikvdb_h2r(handle);
     char **                  kvsv;
-    struct kvs_cparams *     kvs_cparams;
+    struct kvs_cparams *     kvs_cparams = NULL;
     unsigned int             count;
     merr_t                   err;
     int                      i;
     struct hse_kvs *         kvs;
     struct hse_kvs_cursor *  cur;
     struct hse_kvdb_opspec   opspec = { 0 };
-    struct workqueue_struct *wq;
-    struct kvdb_bak_work *   bak;
+    struct hse_kvdb_txn *    txn = NULL;
+    struct workqueue_struct *wq = NULL;
+    struct kvdb_bak_work **  bakv = NULL;
+    uint *                   rcntv = NULL;
+    void *                   keybuf = NULL;
+    uint                     klenv[KVDB_EXPORT_RANGES_MAX];
+    uint                     nranges, j;
     time_t                   t;
     char                     pname[PATH_MAX];
     int                      rc;
@@ -3808,28 +4634,35 @@ ikvdb_export(struct ikvdb *handle, struct kvdb_cparams *kvdb_cparams, const char
     if (count == 0)
         return 0;
 
-    bak = calloc(count, sizeof(*bak));
-    if (!bak) {
-        ikvdb_free_names(handle, kvsv);
-        return merr(ev(ENOMEM, HSE_ERR));
-    }
+    nranges = min_t(uint, num_online_cpus(), KVDB_EXPORT_RANGES_MAX);
 
+    bakv = calloc(count, sizeof(*bakv));
+    rcntv = calloc(count, sizeof(*rcntv));
     kvs_cparams = calloc(count, sizeof(*kvs_cparams));
-    if (!kvs_cparams) {
-        free(bak);
-        ikvdb_free_names(handle, kvsv);
-        return merr(ev(ENOMEM, HSE_ERR));
+    keybuf = malloc(KVDB_EXPORT_RANGES_MAX * HSE_KVS_KLEN_MAX);
+    if (!bakv || !rcntv || !kvs_cparams || !keybuf) {
+        err = merr(ev(ENOMEM, HSE_ERR));
+        goto errout;
     }
 
-    wq = alloc_workqueue("dbexport", 0, count);
+    wq = alloc_workqueue("dbexport", 0, nranges);
     if (!wq) {
         err = merr(ENOMEM);
         hse_elog(HSE_ERR "Failed to alloc export workqueues, @@e", err);
         goto errout;
     }
 
+    txn = ikvdb_txn_alloc(handle);
+    if (!txn) {
+        err = merr(ev(ENOMEM, HSE_ERR));
+        goto errout;
+    }
+
+    opspec.kop_txn = txn;
+
     for (i = 0; i < count; i++) {
-        int n;
+        struct kvdb_kvs *kk;
+        uint             r, splitc;
 
         err = ikvdb_kvs_open(handle, kvsv[i], 0, 0, &kvs);
         if (err) {
@@ -3837,57 +4670,112 @@ ikvdb_export(struct ikvdb *handle, struct kvdb_cparams *kvdb_cparams, const char
             goto errout;
         }
 
-        kvs_cparams[i].cp_pfx_len = ((struct kvdb_kvs *)kvs)->kk_cparams->cp_pfx_len;
-        kvs_cparams[i].cp_pfx_pivot = ((struct kvdb_kvs *)kvs)->kk_cparams->cp_pfx_pivot;
-        kvs_cparams[i].cp_fanout = ((struct kvdb_kvs *)kvs)->kk_cparams->cp_fanout;
-        kvs_cparams[i].cp_kvs_ext01 =
-            (((struct kvdb_kvs *)kvs)->kk_flags & CN_CFLAG_CAPPED) ? 1 : 0;
+        kk = (struct kvdb_kvs *)kvs;
+        kvs_cparams[i].cp_pfx_len = kk->kk_cparams->cp_pfx_len;
+        kvs_cparams[i].cp_pfx_pivot = kk->kk_cparams->cp_pfx_pivot;
+        kvs_cparams[i].cp_fanout = kk->kk_cparams->cp_fanout;
+        kvs_cparams[i].cp_kvs_ext01 = (kk->kk_flags & CN_CFLAG_CAPPED) ? 1 : 0;
 
-        err = ikvdb_kvs_cursor_create(kvs, &opspec, NULL, 0, &cur);
-        if (err) {
-            hse_elog(
-                HSE_ERR "Failed to create cursor for kvdb"
-                        " %s kvs %s, @@e",
-                err,
-                kvdb->ikdb_mpname,
-                kvsv[i]);
+        /* Split the kvs into key ranges of similar size so that a single
+         * large kvs is exported by several workers.
+         */
+        splitc = cn_split_keys(kvs_cn(kk->kk_ikvs), nranges - 1, keybuf, klenv);
+
+        bakv[i] = calloc(splitc + 1, sizeof(*bakv[i]));
+        if (!bakv[i]) {
+            err = merr(ev(ENOMEM, HSE_ERR));
             goto errout;
         }
 
-        bak[i].bak_kvs = kvs;
-        n = snprintf(bak[i].bak_fname, sizeof(bak[i].bak_fname), "%s/%s", pname, kvsv[i]);
-        if (n >= sizeof(bak[i].bak_fname)) {
-            err = merr(EINVAL);
+        /* Create the cursors of all the ranges in the view of one txn
+         * so that together they export a consistent image of the kvs.
+         */
+        err = ikvdb_txn_begin(handle, txn);
+        if (ev(err))
             goto errout;
+
+        for (r = 0; r <= splitc; r++) {
+            struct kvdb_bak_work *bak = &bakv[i][r];
+            int                   n;
+
+            err = ikvdb_kvs_cursor_create(kvs, &opspec, NULL, 0, &cur);
+            if (err) {
+                hse_elog(
+                    HSE_ERR "Failed to create cursor for kvdb"
+                            " %s kvs %s, @@e",
+                    err,
+                    kvdb->ikdb_mpname,
+                    kvsv[i]);
+                goto errout;
+            }
+
+            if (r > 0) {
+                err = ikvdb_kvs_cursor_seek(
+                    cur, NULL, keybuf + (r - 1) * HSE_KVS_KLEN_MAX, klenv[r - 1], NULL, 0, NULL);
+                if (ev(err)) {
+                    ikvdb_kvs_cursor_destroy(cur);
+                    goto errout;
+                }
+            }
+
+            if (r < splitc) {
+                memcpy(bak->bak_ekey, keybuf + r * HSE_KVS_KLEN_MAX, klenv[r]);
+                bak->bak_eklen = klenv[r];
+            }
+
+            bak->bak_kvs = kvs;
+            n = snprintf(bak->bak_fname, sizeof(bak->bak_fname), "%s/%s_%u", pname, kvsv[i], r);
+            if (n >= sizeof(bak->bak_fname)) {
+                err = merr(EINVAL);
+                ikvdb_kvs_cursor_destroy(cur);
+                goto errout;
+            }
+
+            bak->bak_cur = cur;
+            INIT_WORK(&bak->bak_work, ikvdb_kvs_export);
+            queue_work(wq, &bak->bak_work);
+            rcntv[i]++;
         }
 
-        bak[i].bak_cur = cur;
-        INIT_WORK(&bak[i].bak_work, ikvdb_kvs_export);
-        queue_work(wq, &bak[i].bak_work);
+        ikvdb_txn_abort(handle, txn);
     }
 
 errout:
+    if (txn && ikvdb_txn_state(handle, txn) == KVDB_CTXN_ACTIVE)
+        ikvdb_txn_abort(handle, txn);
+    ikvdb_txn_free(handle, txn);
+
     /* Wait for all exporting jobs finish */
-    destroy_workqueue(wq);
+    if (wq)
+        destroy_workqueue(wq);
 
     /* Check the status of all dump threads */
     if (!err) {
         for (i = 0; i < count; i++) {
-            if (bak[i].bak_err)
-                err = bak[i].bak_err;
-            else
-                done++;
+            for (j = 0; j < rcntv[i]; j++) {
+                if (bakv[i][j].bak_err)
+                    err = bakv[i][j].bak_err;
+                else
+                    done++;
+            }
         }
+
+        hse_log(HSE_DEBUG "%d export jobs have completed", done);
     }
 
     /* Dump the export summary/meta data to TOC file */
     if (!err)
-        err =
-            ikvdb_export_toc(pname, kvdb->ikdb_mpname, kvdb_cparams, count, kvsv, kvs_cparams, bak);
+        err = ikvdb_export_toc(
+            pname, kvdb->ikdb_mpname, kvdb_cparams, count, kvsv, kvs_cparams, bakv, rcntv);
+
+    for (i = 0; bakv && i < count; i++)
+        free(bakv[i]);
 
     ikvdb_free_names(handle, kvsv);
+    free(keybuf);
     free(kvs_cparams);
-    free(bak);
+    free(rcntv);
+    free(bakv);
     return err;
 }
 
@@ -0,0 +1,123 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2015-2020 Micron Technology, Inc.  All rights reserved.
+ */
+
+#include <hse/hse_limits.h>
+
+#include <hse_util/platform.h>
+#include <hse_util/event_counter.h>
+#include <hse_util/compression_lz4.h>
+
+#include "kvdb_chunk.h"
+
+void
+kvdb_chunk_pack(
+    const void *           ubuf,
+    uint                   ulen,
+    uint                   kvcnt,
+    void *                 cbuf,
+    uint                   cbufsz,
+    struct kvdb_chunk_omf *chnk,
+    const void **          datap,
+    uint *                 dlenp)
+{
+    struct compress_ops *cops = &compress_lz4_ops;
+    uint                 clen = 0;
+    merr_t               err;
+
+    /* Store the chunk raw if it doesn't compress. */
+    err = cops->cop_compress(ubuf, ulen, cbuf, cbufsz, &clen);
+    if (err || clen >= ulen)
+        clen = 0;
+
+    omf_set_chnk_magic(chnk, KVDB_CHUNK_MAGIC);
+    omf_set_chnk_kvcnt(chnk, kvcnt);
+    omf_set_chnk_ulen(chnk, ulen);
+    omf_set_chnk_clen(chnk, clen);
+
+    *datap = clen ? cbuf : ubuf;
+    *dlenp = clen ?: ulen;
+}
+
+merr_t
+kvdb_chunk_unpack(
+    const void * buf,
+    size_t       buflen,
+    void *       ubuf,
+    uint         ubufsz,
+    const void **recp,
+    uint *       ulenp,
+    size_t *     lenp)
+{
+    struct compress_ops *        cops = &compress_lz4_ops;
+    const struct kvdb_chunk_omf *chnk = buf;
+    uint                         ulen, clen, len;
+    merr_t                       err;
+
+    if (buflen < sizeof(*chnk) || omf_chnk_magic(chnk) != KVDB_CHUNK_MAGIC)
+        return merr(ev(EPROTO));
+
+    ulen = omf_chnk_ulen(chnk);
+    clen = omf_chnk_clen(chnk);
+    buf += sizeof(*chnk);
+    buflen -= sizeof(*chnk);
+
+    if (ulen > ubufsz || (clen ?: ulen) > buflen)
+        return merr(ev(EFAULT));
+
+    *recp = buf;
+    if (clen) {
+        err = cops->cop_decompress(buf, clen, ubuf, ubufsz, &len);
+        if (ev(err))
+            return err;
+
+        if (ev(len != ulen))
+            return merr(EPROTO);
+
+        *recp = ubuf;
+    }
+
+    *ulenp = ulen;
+    *lenp = sizeof(*chnk) + (clen ?: ulen);
+
+    return 0;
+}
+
+merr_t
+kvdb_chunk_kv_next(
+    const void **recp,
+    const void * rend,
+    const void **key,
+    size_t *     klen,
+    const void **val,
+    size_t *     vlen)
+{
+    const struct kvdb_kvmeta_omf *kvmt = *recp;
+    const void *                  rec = *recp;
+
+    if (rec + sizeof(*kvmt) > rend)
+        return merr(ev(EFAULT));
+
+    *klen = omf_kvmt_klen(kvmt);
+    *vlen = omf_kvmt_vlen(kvmt);
+
+    if (*klen > HSE_KVS_KLEN_MAX)
+        return merr(ev(ENAMETOOLONG));
+
+    if (*klen == 0)
+        return merr(ev(ENOENT));
+
+    if (*vlen > HSE_KVS_VLEN_MAX)
+        return merr(ev(EMSGSIZE));
+
+    rec += sizeof(*kvmt);
+    if (rec + *klen + *vlen > rend)
+        return merr(ev(EFAULT));
+
+    *key = rec;
+    *val = rec + *klen;
+    *recp = rec + *klen + *vlen;
+
+    return 0;
+}
@@ -0,0 +1,88 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2015-2020 Micron Technology, Inc.  All rights reserved.
+ */
+
+#ifndef HSE_KVDB_KVDB_CHUNK_H
+#define HSE_KVDB_KVDB_CHUNK_H
+
+#include <hse_util/inttypes.h>
+#include <hse_util/hse_err.h>
+
+#include "kvdb_omf.h"
+
+/*
+ * Export data files are a sequence of chunks.  Each chunk is a
+ * struct kvdb_chunk_omf header followed by a run of k-v records (a
+ * struct kvdb_kvmeta_omf, the key, then the value), lz4 compressed
+ * unless compression would not make the run any smaller.
+ */
+
+/**
+ * kvdb_chunk_pack() - prepare a run of k-v records to be written as a chunk
+ * @ubuf:   k-v records
+ * @ulen:   length of @ubuf
+ * @kvcnt:  number of k-v records in @ubuf
+ * @cbuf:   compression buffer
+ * @cbufsz: size of @cbuf
+ * @chnk:   (output) chunk header
+ * @datap:  (output) chunk payload, either @cbuf or @ubuf
+ * @dlenp:  (output) length of the chunk payload
+ */
+void
+kvdb_chunk_pack(
+    const void *           ubuf,
+    uint                   ulen,
+    uint                   kvcnt,
+    void *                 cbuf,
+    uint                   cbufsz,
+    struct kvdb_chunk_omf *chnk,
+    const void **          datap,
+    uint *                 dlenp);
+
+/**
+ * kvdb_chunk_unpack() - validate and decompress the chunk at the head of a buffer
+ * @buf:    chunk header followed by its payload
+ * @buflen: number of bytes available at @buf
+ * @ubuf:   decompression buffer
+ * @ubufsz: size of @ubuf
+ * @recp:   (output) k-v records of the chunk, in @buf or @ubuf
+ * @ulenp:  (output) length of the k-v records
+ * @lenp:   (output) length of the chunk in @buf, header included
+ *
+ * Return: EPROTO if @buf does not start with a chunk header or if the
+ * payload does not decompress to the length in the header, EFAULT if the
+ * chunk is truncated or its records would not fit in @ubuf.
+ */
+merr_t
+kvdb_chunk_unpack(
+    const void * buf,
+    size_t       buflen,
+    void *       ubuf,
+    uint         ubufsz,
+    const void **recp,
+    uint *       ulenp,
+    size_t *     lenp);
+
+/**
+ * kvdb_chunk_kv_next() - parse the next k-v record of a chunk
+ * @recp: (in/out) next record, advanced past it on success
+ * @rend: end of the chunk's records
+ * @key:  (output) key
+ * @klen: (output) key length
+ * @val:  (output) value
+ * @vlen: (output) value length
+ *
+ * Return: EFAULT if the record is truncated, ENAMETOOLONG, ENOENT or
+ * EMSGSIZE if its key is too long or empty or its value is too long.
+ */
+merr_t
+kvdb_chunk_kv_next(
+    const void **recp,
+    const void * rend,
+    const void **key,
+    size_t *     klen,
+    const void **val,
+    size_t *     vlen);
+
+#endif
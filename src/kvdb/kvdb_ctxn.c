@@ -561,6 +561,11 @@ kvdb_ctxn_commit(struct kvdb_ctxn *handle)
      */
     c0kvms_getref(ctxn->ctxn_kvms);
 
+    /* Keep misses from entering the negative cache until the commit
+     * seqno is known, as our keys are written to c0 before then.
+     */
+    c0sk_cache_hold(ctxn->ctxn_c0sk);
+
     num_retries = 5;
 
 retry:
@@ -607,6 +612,7 @@ retry:
      * persist any mutations made by this transaction, so we abort it.
      */
     if (ev(err)) {
+        c0sk_cache_release(ctxn->ctxn_c0sk, 0);
         kvdb_ctxn_abort_inner(ctxn);
         c0kvms_putref(ctxn->ctxn_kvms);
         kvdb_ctxn_unlock(ctxn);
@@ -750,6 +756,7 @@ retry:
 
     c0skm_set_tseqno(ctxn->ctxn_c0sk, commit_sn);
     atomic64_inc_rel(ctxn->ctxn_tseqno_tail);
+    c0sk_cache_release(ctxn->ctxn_c0sk, commit_sn);
 
     locks = ctxn->ctxn_locks_handle;
     ctxn->ctxn_locks_handle = NULL;
@@ -97,4 +97,26 @@ struct kvdb_kvmeta_omf {
 
 OMF_SETGET(struct kvdb_kvmeta_omf, kvmt_klen, 64);
 OMF_SETGET(struct kvdb_kvmeta_omf, kvmt_vlen, 64);
+
+#define KVDB_CHUNK_MAGIC ((u32)0x6b766368) /* "kvch" */
+
+/** struct kvdb_chunk_omf() - header of an export data chunk
+ * @chnk_magic: KVDB_CHUNK_MAGIC
+ * @chnk_kvcnt: number of k-v pairs in the chunk
+ * @chnk_ulen:  length of the chunk's kvmeta/key/value records
+ * @chnk_clen:  lz4 compressed length, zero if stored uncompressed
+ *
+ * The (possibly compressed) records immediately follow the header.
+ */
+struct kvdb_chunk_omf {
+    __le32 chnk_magic;
+    __le32 chnk_kvcnt;
+    __le32 chnk_ulen;
+    __le32 chnk_clen;
+} __packed;
+
+OMF_SETGET(struct kvdb_chunk_omf, chnk_magic, 32);
+OMF_SETGET(struct kvdb_chunk_omf, chnk_kvcnt, 32);
+OMF_SETGET(struct kvdb_chunk_omf, chnk_ulen, 32);
+OMF_SETGET(struct kvdb_chunk_omf, chnk_clen, 32);
 #endif /* HSE_KVDB_KVDB_OMF_H */
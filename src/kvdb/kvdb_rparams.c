@@ -61,6 +61,7 @@ kvdb_rparams_defaults(void)
         .c0_ingest_width = 0,
         .c0_mutex_pool_sz = 7,
         .c0_coalesce_sz = 2048,
+        .c0_negc_sz = 0,
 
         .txn_heap_sz = HSE_C0_CHEAP_SZ_MAX,
         .txn_ingest_delay = HSE_C0_INGEST_DELAY_DFLT,
@@ -102,6 +103,12 @@ kvdb_rparams_defaults(void)
         .cndb_entries = 0,
         .c0_maint_threads = HSE_C0_MAINT_THREADS_DFLT,
         .c0_ingest_threads = HSE_C0_INGEST_THREADS_DFLT,
+        .c0_ingest_parts = HSE_C0_INGEST_PARTS_DFLT,
+        .c0_ingest_part_mb = HSE_C0_INGEST_PART_MB_DFLT,
+        .c0_wide_index = 0,
+        .c0_numa_bind = 0,
+        .c0_heap_huge = 0,
+        .c0_pfx_dedup = 0,
 
         .keylock_entries = 19997,
         .keylock_tables = 293,
@@ -129,6 +136,7 @@ static struct param_inst   kvdb_rp_table[] = {
     KVDB_PARAM_EXP(c0_ingest_delay, "max ingest coalesce delay (seconds)"),
     KVDB_PARAM_EXP(c0_ingest_width, "number of c0 trees in parallel (min 2)"),
     KVDB_PARAM_EXP(c0_coalesce_sz, "c0 ingest coalesce size in MiB"),
+    KVDB_PARAM_EXP(c0_negc_sz, "negative lookup cache size (bytes, 0: disable)"),
 
     KVDB_PARAM_EXP(txn_heap_sz, "cheap or malloc size"),
     KVDB_PARAM_EXP(txn_ingest_delay, "max ingest coalesce delay (seconds)"),
@@ -173,6 +181,12 @@ static struct param_inst   kvdb_rp_table[] = {
         "representation (0: let system choose)"),
     KVDB_PARAM_U32_EXP(c0_maint_threads, "max number of maintenance threads"),
     KVDB_PARAM_U32_EXP(c0_ingest_threads, "max number of c0 ingest threads"),
+    KVDB_PARAM_U32_EXP(c0_ingest_parts, "max parallel merges per c0 ingest"),
+    KVDB_PARAM_U32_EXP(c0_ingest_part_mb, "min c0 MiB per parallel merge"),
+    KVDB_PARAM_U32_EXP(c0_wide_index, "threads indexing frozen c0 kvsets (0: disable)"),
+    KVDB_PARAM_U32_EXP(c0_numa_bind, "spread c0 kvset memory across numa nodes"),
+    KVDB_PARAM_U32_EXP(c0_heap_huge, "c0/c1 heap huge pages (0:none, 1:thp, 2:2MB, 3:1GB)"),
+    KVDB_PARAM_U32_EXP(c0_pfx_dedup, "store c0 key prefixes once per c0 kvset"),
     KVDB_PARAM_U32_EXP(c0_mutex_pool_sz, "max locks in c0 ingest sync pool"),
 
     KVDB_PARAM_U32_EXP(keylock_entries, "number of keylock entries in a table"),
@@ -8,6 +8,7 @@
 #include <hse_test_support/random_buffer.h>
 
 #include <hse_util/hse_err.h>
+#include <hse_util/byteorder.h>
 
 #include <hse_ikvdb/kvs.h>
 #include <hse_ikvdb/ikvdb.h>
@@ -621,6 +622,564 @@ MTF_DEFINE_UTEST_PREPOST(ikvdb_test, txn_del_test, test_pre, test_post)
     hse_params_destroy(params);
 }
 
+MTF_DEFINE_UTEST_PREPOST(ikvdb_test, range_delete_test, test_pre, test_post)
+{
+    struct ikvdb *         h = NULL;
+    struct hse_kvs *       kvs_h = NULL;
+    const char *           mpool = "mpool";
+    const char *           kvs = "kvs";
+    struct hse_params *    params;
+    merr_t                 err;
+    struct mpool *         ds = (struct mpool *)-1;
+    struct hse_kvdb_opspec opspec;
+    struct kvs_ktuple      kt, start, end;
+    struct kvs_vtuple      vt;
+    struct kvs_buf         vbuf;
+    char                   buf[100];
+    enum key_lookup_res    found;
+    const char *           keyv[] = { "a1", "b1", "b2", "c1" };
+    enum key_lookup_res    expv[] = { FOUND_VAL, FOUND_TMB, FOUND_TMB, FOUND_VAL };
+    int                    i;
+
+    HSE_KVDB_OPSPEC_INIT(&opspec);
+
+    /* we want a valid c0/c0sk here */
+    mock_c0_unset();
+
+    hse_params_create(&params);
+
+    err = hse_params_set(params, "kvdb.c0_diag_mode", "1");
+    ASSERT_EQ(err, 0);
+
+    err = ikvdb_open(mpool, ds, params, &h);
+    ASSERT_EQ(0, err);
+    ASSERT_NE(NULL, h);
+
+    err = ikvdb_kvs_make(h, kvs, NULL);
+    ASSERT_EQ(0, err);
+
+    err = ikvdb_kvs_open(h, kvs, 0, 0, &kvs_h);
+    ASSERT_EQ(0, err);
+    ASSERT_NE(NULL, kvs_h);
+
+    kvs_vtuple_init(&vt, "data", 4);
+
+    for (i = 0; i < NELEM(keyv); i++) {
+        kvs_ktuple_init(&kt, keyv[i], strlen(keyv[i]));
+        err = ikvdb_kvs_put(kvs_h, 0, &kt, &vt);
+        ASSERT_EQ(0, err);
+    }
+
+    kvs_ktuple_init(&start, "b", 1);
+    kvs_ktuple_init(&end, "c", 1);
+
+    /* Empty and inverted ranges are rejected */
+    err = ikvdb_kvs_range_delete(kvs_h, 0, &start, &start);
+    ASSERT_EQ(EINVAL, merr_errno(err));
+
+    err = ikvdb_kvs_range_delete(kvs_h, 0, &end, &start);
+    ASSERT_EQ(EINVAL, merr_errno(err));
+
+    /* Range deletes are not supported within a transaction */
+    opspec.kop_txn = ikvdb_txn_alloc(h);
+    ASSERT_NE(0, opspec.kop_txn);
+
+    err = ikvdb_kvs_range_delete(kvs_h, &opspec, &start, &end);
+    ASSERT_EQ(EINVAL, merr_errno(err));
+
+    ikvdb_txn_free(h, opspec.kop_txn);
+    opspec.kop_txn = 0;
+
+    /* A range delete is made durable by syncing c0, which would move
+     * the keys to the mock cN.
+     */
+    mapi_inject(mapi_idx_c0sk_sync, 0);
+    mapi_calls_clear(mapi_idx_c0sk_sync);
+
+    err = ikvdb_kvs_range_delete(kvs_h, 0, &start, &end);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(1, mapi_calls(mapi_idx_c0sk_sync));
+
+    mapi_inject_unset(mapi_idx_c0sk_sync);
+
+    vbuf.b_buf = buf;
+    vbuf.b_buf_sz = sizeof(buf);
+
+    for (i = 0; i < NELEM(keyv); i++) {
+        kvs_ktuple_init(&kt, keyv[i], strlen(keyv[i]));
+        vbuf.b_len = 0;
+        err = ikvdb_kvs_get(kvs_h, &opspec, &kt, &found, &vbuf);
+        ASSERT_EQ(0, err);
+        ASSERT_EQ(expv[i], found);
+    }
+
+    /* A put after the range delete is visible again */
+    kvs_ktuple_init(&kt, keyv[1], strlen(keyv[1]));
+    err = ikvdb_kvs_put(kvs_h, 0, &kt, &vt);
+    ASSERT_EQ(0, err);
+
+    vbuf.b_len = 0;
+    err = ikvdb_kvs_get(kvs_h, &opspec, &kt, &found, &vbuf);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(FOUND_VAL, found);
+
+    err = ikvdb_kvs_close(kvs_h);
+    ASSERT_EQ(0, err);
+
+    err = ikvdb_close(h);
+    ASSERT_EQ(0, err);
+
+    hse_params_destroy(params);
+}
+
+MTF_DEFINE_UTEST_PREPOST(ikvdb_test, merge_test, test_pre, test_post)
+{
+    struct ikvdb *         h = NULL;
+    struct hse_kvs *       kvs_h = NULL, *kvs_none = NULL;
+    const char *           mpool = "mpool";
+    struct hse_params *    params;
+    merr_t                 err;
+    struct mpool *         ds = (struct mpool *)-1;
+    struct hse_kvdb_opspec opspec;
+    struct kvs_ktuple      kt;
+    struct kvs_vtuple      vt;
+    struct kvs_buf         vbuf;
+    enum key_lookup_res    found;
+    u64                    val, opv[] = { 3, 4, 10 };
+    int                    i;
+
+    HSE_KVDB_OPSPEC_INIT(&opspec);
+
+    /* we want a valid c0/c0sk here */
+    mock_c0_unset();
+
+    hse_params_create(&params);
+
+    err = hse_params_set(params, "kvdb.c0_diag_mode", "1");
+    ASSERT_EQ(err, 0);
+
+    err = hse_params_set(params, "kvs.kvs_add.merge_op", "add");
+    ASSERT_EQ(err, 0);
+
+    err = ikvdb_open(mpool, ds, params, &h);
+    ASSERT_EQ(0, err);
+    ASSERT_NE(NULL, h);
+
+    err = ikvdb_kvs_make(h, "kvs_add", NULL);
+    ASSERT_EQ(0, err);
+
+    err = ikvdb_kvs_make(h, "kvs_none", NULL);
+    ASSERT_EQ(0, err);
+
+    err = ikvdb_kvs_open(h, "kvs_add", params, 0, &kvs_h);
+    ASSERT_EQ(0, err);
+
+    err = ikvdb_kvs_open(h, "kvs_none", params, 0, &kvs_none);
+    ASSERT_EQ(0, err);
+
+    val = cpu_to_le64(5);
+    kvs_ktuple_init(&kt, "k1", 2);
+    kvs_vtuple_init(&vt, &val, sizeof(val));
+    err = ikvdb_kvs_put(kvs_h, 0, &kt, &vt);
+    ASSERT_EQ(0, err);
+
+    /* A kvs without a merge operator rejects operands */
+    err = ikvdb_kvs_merge(kvs_none, 0, &kt, &val, sizeof(val));
+    ASSERT_EQ(EINVAL, merr_errno(err));
+
+    /* The add operator takes only 8-byte operands */
+    err = ikvdb_kvs_merge(kvs_h, 0, &kt, &val, sizeof(val) - 1);
+    ASSERT_EQ(EINVAL, merr_errno(err));
+
+    /* Merges are not supported within a transaction */
+    opspec.kop_txn = ikvdb_txn_alloc(h);
+    ASSERT_NE(0, opspec.kop_txn);
+
+    err = ikvdb_kvs_merge(kvs_h, &opspec, &kt, &val, sizeof(val));
+    ASSERT_EQ(EINVAL, merr_errno(err));
+
+    ikvdb_txn_free(h, opspec.kop_txn);
+    opspec.kop_txn = 0;
+
+    for (i = 0; i < NELEM(opv); i++) {
+        val = cpu_to_le64(opv[i]);
+
+        kvs_ktuple_init(&kt, "k1", 2);
+        err = ikvdb_kvs_merge(kvs_h, 0, &kt, &val, sizeof(val));
+        ASSERT_EQ(0, err);
+
+        /* A key without a value merges as if it were zero */
+        kvs_ktuple_init(&kt, "k2", 2);
+        err = ikvdb_kvs_merge(kvs_h, 0, &kt, &val, sizeof(val));
+        ASSERT_EQ(0, err);
+    }
+
+    kvs_buf_init(&vbuf, &val, sizeof(val));
+
+    kvs_ktuple_init(&kt, "k1", 2);
+    err = ikvdb_kvs_get(kvs_h, &opspec, &kt, &found, &vbuf);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(FOUND_VAL, found);
+    ASSERT_EQ(sizeof(val), vbuf.b_len);
+    ASSERT_EQ(22, le64_to_cpu(val));
+
+    kvs_ktuple_init(&kt, "k2", 2);
+    err = ikvdb_kvs_get(kvs_h, &opspec, &kt, &found, &vbuf);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(FOUND_VAL, found);
+    ASSERT_EQ(17, le64_to_cpu(val));
+
+    /* A delete discards the operands */
+    err = ikvdb_kvs_del(kvs_h, 0, &kt);
+    ASSERT_EQ(0, err);
+
+    err = ikvdb_kvs_get(kvs_h, &opspec, &kt, &found, &vbuf);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(FOUND_TMB, found);
+
+    err = ikvdb_kvs_close(kvs_none);
+    ASSERT_EQ(0, err);
+
+    err = ikvdb_kvs_close(kvs_h);
+    ASSERT_EQ(0, err);
+
+    err = ikvdb_close(h);
+    ASSERT_EQ(0, err);
+
+    hse_params_destroy(params);
+}
+
+MTF_DEFINE_UTEST_PREPOST(ikvdb_test, get_batch_test, test_pre, test_post)
+{
+    struct ikvdb *         h = NULL;
+    struct hse_kvs *       kvs_h = NULL;
+    const char *           mpool = "mpool";
+    const char *           kvs = "kvs";
+    struct hse_params *    params;
+    merr_t                 err;
+    struct mpool *         ds = (struct mpool *)-1;
+    struct hse_kvdb_opspec opspec;
+    struct kvs_ktuple      ktv[3];
+    struct kvs_vtuple      vt;
+    struct kvs_buf         vbufv[3];
+    char                   bufv[3][100];
+    enum key_lookup_res    resv[3];
+    const char *           keyv[] = { "key0", "key1", "nokey" };
+    int                    i;
+
+    HSE_KVDB_OPSPEC_INIT(&opspec);
+
+    /* we want a valid c0/c0sk here */
+    mock_c0_unset();
+
+    hse_params_create(&params);
+
+    err = hse_params_set(params, "kvdb.c0_diag_mode", "1");
+    ASSERT_EQ(err, 0);
+
+    err = ikvdb_open(mpool, ds, params, &h);
+    ASSERT_EQ(0, err);
+    ASSERT_NE(NULL, h);
+
+    err = ikvdb_kvs_make(h, kvs, NULL);
+    ASSERT_EQ(0, err);
+
+    err = ikvdb_kvs_open(h, kvs, 0, 0, &kvs_h);
+    ASSERT_EQ(0, err);
+    ASSERT_NE(NULL, kvs_h);
+
+    for (i = 0; i < 3; ++i) {
+        kvs_ktuple_init(&ktv[i], keyv[i], strlen(keyv[i]));
+        kvs_buf_init(&vbufv[i], bufv[i], sizeof(bufv[i]));
+    }
+
+    kvs_vtuple_init(&vt, "data", 4);
+
+    err = ikvdb_kvs_put(kvs_h, 0, &ktv[0], &vt);
+    ASSERT_EQ(0, err);
+    err = ikvdb_kvs_put(kvs_h, 0, &ktv[1], &vt);
+    ASSERT_EQ(0, err);
+
+    err = ikvdb_kvs_del(kvs_h, 0, &ktv[1]);
+    ASSERT_EQ(0, err);
+
+    err = ikvdb_kvs_get_batch(kvs_h, &opspec, ktv, resv, vbufv, 3);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(FOUND_VAL, resv[0]);
+    ASSERT_EQ(4, vbufv[0].b_len);
+    ASSERT_EQ(0, memcmp(bufv[0], "data", 4));
+    ASSERT_EQ(FOUND_TMB, resv[1]);
+    ASSERT_EQ(NOT_FOUND, resv[2]);
+
+    err = ikvdb_kvs_close(kvs_h);
+    ASSERT_EQ(0, err);
+
+    err = ikvdb_close(h);
+    ASSERT_EQ(0, err);
+
+    hse_params_destroy(params);
+}
+
+struct get_async_res {
+    int    calls;
+    merr_t err;
+    bool   found;
+    size_t vlen;
+};
+
+static void
+get_async_cb(void *arg, hse_err_t err, bool found, size_t vlen)
+{
+    struct get_async_res *r = arg;
+
+    r->calls++;
+    r->err = err;
+    r->found = found;
+    r->vlen = vlen;
+}
+
+MTF_DEFINE_UTEST_PREPOST(ikvdb_test, get_async_test, test_pre, test_post)
+{
+    struct ikvdb *         h = NULL;
+    struct hse_kvs *       kvs_h = NULL;
+    const char *           mpool = "mpool";
+    const char *           kvs = "kvs";
+    struct hse_params *    params;
+    merr_t                 err;
+    struct mpool *         ds = (struct mpool *)-1;
+    struct hse_kvdb_opspec opspec;
+    struct kvs_ktuple      kt;
+    struct kvs_vtuple      vt;
+    struct kvs_buf         vbuf;
+    struct get_async_res   r;
+    char                   buf[100];
+
+    HSE_KVDB_OPSPEC_INIT(&opspec);
+
+    /* we want a valid c0/c0sk here */
+    mock_c0_unset();
+
+    hse_params_create(&params);
+
+    err = hse_params_set(params, "kvdb.c0_diag_mode", "1");
+    ASSERT_EQ(err, 0);
+
+    err = ikvdb_open(mpool, ds, params, &h);
+    ASSERT_EQ(0, err);
+    ASSERT_NE(NULL, h);
+
+    err = ikvdb_kvs_make(h, kvs, NULL);
+    ASSERT_EQ(0, err);
+
+    err = ikvdb_kvs_open(h, kvs, 0, 0, &kvs_h);
+    ASSERT_EQ(0, err);
+    ASSERT_NE(NULL, kvs_h);
+
+    kvs_ktuple_init(&kt, "key0", 4);
+    kvs_vtuple_init(&vt, "data", 4);
+
+    err = ikvdb_kvs_put(kvs_h, 0, &kt, &vt);
+    ASSERT_EQ(0, err);
+
+    /* Values found in c0 complete before ikvdb_kvs_get_async() returns.
+     */
+    memset(&r, 0, sizeof(r));
+    kvs_buf_init(&vbuf, buf, sizeof(buf));
+
+    err = ikvdb_kvs_get_async(kvs_h, &opspec, &kt, &vbuf, get_async_cb, &r);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(1, r.calls);
+    ASSERT_EQ(0, r.err);
+    ASSERT_TRUE(r.found);
+    ASSERT_EQ(4, r.vlen);
+    ASSERT_EQ(0, memcmp(buf, "data", 4));
+
+    kvs_ktuple_init(&kt, "nokey", 5);
+    memset(&r, 0, sizeof(r));
+
+    err = ikvdb_kvs_get_async(kvs_h, &opspec, &kt, &vbuf, get_async_cb, &r);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(1, r.calls);
+    ASSERT_EQ(0, r.err);
+    ASSERT_FALSE(r.found);
+    ASSERT_EQ(0, r.vlen);
+
+    err = ikvdb_kvs_close(kvs_h);
+    ASSERT_EQ(0, err);
+
+    err = ikvdb_close(h);
+    ASSERT_EQ(0, err);
+
+    hse_params_destroy(params);
+}
+
+MTF_DEFINE_UTEST_PREPOST(ikvdb_test, get_pinned_test, test_pre, test_post)
+{
+    struct ikvdb *         h = NULL;
+    struct hse_kvs *       kvs_h = NULL;
+    const char *           mpool = "mpool";
+    const char *           kvs = "kvs";
+    struct hse_params *    params;
+    merr_t                 err;
+    struct mpool *         ds = (struct mpool *)-1;
+    struct hse_kvdb_opspec opspec;
+    struct kvs_ktuple      kt;
+    struct kvs_vtuple      vt;
+    struct kvs_pin *       pin;
+    enum key_lookup_res    res;
+    char                   val[1000];
+
+    HSE_KVDB_OPSPEC_INIT(&opspec);
+
+    /* we want a valid c0/c0sk here */
+    mock_c0_unset();
+
+    hse_params_create(&params);
+
+    err = hse_params_set(params, "kvdb.c0_diag_mode", "1");
+    ASSERT_EQ(err, 0);
+
+    err = ikvdb_open(mpool, ds, params, &h);
+    ASSERT_EQ(0, err);
+    ASSERT_NE(NULL, h);
+
+    err = ikvdb_kvs_make(h, kvs, NULL);
+    ASSERT_EQ(0, err);
+
+    err = ikvdb_kvs_open(h, kvs, 0, 0, &kvs_h);
+    ASSERT_EQ(0, err);
+    ASSERT_NE(NULL, kvs_h);
+
+    /* Larger than the initial pin allocation, so the get must retry.
+     */
+    memset(val, 'x', sizeof(val));
+    kvs_ktuple_init(&kt, "key0", 4);
+    kvs_vtuple_init(&vt, val, sizeof(val));
+
+    err = ikvdb_kvs_put(kvs_h, 0, &kt, &vt);
+    ASSERT_EQ(0, err);
+
+    err = ikvdb_kvs_get_pinned(kvs_h, &opspec, &kt, &res, &pin);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(FOUND_VAL, res);
+    ASSERT_NE(NULL, pin);
+    ASSERT_EQ(sizeof(val), pin->kp_len);
+    ASSERT_EQ(0, memcmp(pin->kp_data, val, sizeof(val)));
+
+    ikvdb_kvs_pin_release(pin);
+
+    err = ikvdb_kvs_del(kvs_h, 0, &kt);
+    ASSERT_EQ(0, err);
+
+    err = ikvdb_kvs_get_pinned(kvs_h, &opspec, &kt, &res, &pin);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(FOUND_TMB, res);
+    ASSERT_EQ(NULL, pin);
+
+    kvs_ktuple_init(&kt, "nokey", 5);
+
+    err = ikvdb_kvs_get_pinned(kvs_h, &opspec, &kt, &res, &pin);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(NOT_FOUND, res);
+    ASSERT_EQ(NULL, pin);
+
+    ikvdb_kvs_pin_release(NULL);
+
+    err = ikvdb_kvs_close(kvs_h);
+    ASSERT_EQ(0, err);
+
+    err = ikvdb_close(h);
+    ASSERT_EQ(0, err);
+
+    hse_params_destroy(params);
+}
+
+MTF_DEFINE_UTEST_PREPOST(ikvdb_test, write_batch_test, test_pre, test_post)
+{
+    struct ikvdb *         h = NULL;
+    struct hse_kvs *       kvs_h = NULL;
+    const char *           mpool = "mpool";
+    const char *           kvs = "kvs";
+    struct hse_params *    params;
+    merr_t                 err;
+    struct mpool *         ds = (struct mpool *)-1;
+    struct hse_kvdb_opspec opspec;
+    struct ikvdb_batch_op  opv[4];
+    struct kvs_ktuple      kt;
+    struct kvs_buf         vbuf;
+    char                   buf[100];
+    enum key_lookup_res    res;
+    const char *           keyv[] = { "key0", "key1", "key2", "key1" };
+    int                    i;
+
+    HSE_KVDB_OPSPEC_INIT(&opspec);
+
+    /* we want a valid c0/c0sk here */
+    mock_c0_unset();
+
+    hse_params_create(&params);
+
+    err = hse_params_set(params, "kvdb.c0_diag_mode", "1");
+    ASSERT_EQ(err, 0);
+
+    err = ikvdb_open(mpool, ds, params, &h);
+    ASSERT_EQ(0, err);
+    ASSERT_NE(NULL, h);
+
+    err = ikvdb_kvs_make(h, kvs, NULL);
+    ASSERT_EQ(0, err);
+
+    err = ikvdb_kvs_open(h, kvs, 0, 0, &kvs_h);
+    ASSERT_EQ(0, err);
+    ASSERT_NE(NULL, kvs_h);
+
+    /* Put three keys then delete the second, all in one batch.
+     */
+    for (i = 0; i < 4; ++i) {
+        opv[i].bo_kvs = kvs_h;
+        opv[i].bo_tomb = (i == 3);
+        kvs_ktuple_init_nohash(&opv[i].bo_kt, keyv[i], strlen(keyv[i]));
+        kvs_vtuple_init(&opv[i].bo_vt, "data", 4);
+    }
+
+    err = ikvdb_write_batch(h, &opspec, opv, 0);
+    ASSERT_EQ(EINVAL, merr_errno(err));
+
+    err = ikvdb_write_batch(h, &opspec, opv, 4);
+    ASSERT_EQ(0, err);
+
+    for (i = 0; i < 3; ++i) {
+        kvs_ktuple_init(&kt, keyv[i], strlen(keyv[i]));
+        kvs_buf_init(&vbuf, buf, sizeof(buf));
+
+        err = ikvdb_kvs_get(kvs_h, &opspec, &kt, &res, &vbuf);
+        ASSERT_EQ(0, err);
+        ASSERT_EQ((i == 1) ? FOUND_TMB : FOUND_VAL, res);
+    }
+
+    ASSERT_EQ(4, vbuf.b_len);
+    ASSERT_EQ(0, memcmp(buf, "data", 4));
+
+    /* Batches cannot be applied within a transaction.
+     */
+    opspec.kop_txn = ikvdb_txn_alloc(h);
+    ASSERT_NE(0, opspec.kop_txn);
+
+    err = ikvdb_kvs_put_batch(kvs_h, &opspec, opv, 3);
+    ASSERT_EQ(EINVAL, merr_errno(err));
+
+    ikvdb_txn_free(h, opspec.kop_txn);
+    opspec.kop_txn = 0;
+
+    err = ikvdb_kvs_close(kvs_h);
+    ASSERT_EQ(0, err);
+
+    err = ikvdb_close(h);
+    ASSERT_EQ(0, err);
+
+    hse_params_destroy(params);
+}
+
 struct tx_info {
     struct ikvdb *  kvdb;
     struct hse_kvs *kvs;
@@ -1012,6 +1571,106 @@ MTF_DEFINE_UTEST_PREPOST(ikvdb_test, cursor_1, test_pre_c0, test_post_c0)
     hse_params_destroy(params);
 }
 
+MTF_DEFINE_UTEST_PREPOST(ikvdb_test, cursor_read_many, test_pre_c0, test_post_c0)
+{
+    struct ikvdb *              h = NULL;
+    struct hse_kvs *            kvs_h = NULL;
+    const char *                mpool = "mpool";
+    const char *                kvs = "kvs";
+    struct mpool *              ds = (struct mpool *)-1;
+    struct hse_params *         params;
+    struct hse_kvdb_opspec      opspec;
+    struct hse_kvs_cursor *     cur;
+    struct kvs_ktuple           kt = { 0 };
+    struct kvs_vtuple           vt = { 0 };
+    struct hse_kvs_cursor_kvoff kvov[3];
+    char                        buf[32];
+    merr_t                      err;
+    bool                        eof;
+    uint                        cnt;
+    int                         i, j;
+
+    struct kvdata {
+        char *key;
+        char *val;
+    } kvdata[] = {
+        { "AABC", "AABC_1" }, { "AC", "AC_1" }, { "AA", "AA_1" },   { "AABB", "AABB_1" },
+        { "ABAA", "ABAA_1" }, { "AB", "AB_1" }, { "ABC", "ABC_1" }, { "AAA", "AAA_1" },
+    };
+
+    struct kvdata sorted[] = {
+        { "AA", "AA_1" }, { "AAA", "AAA_1" },   { "AABB", "AABB_1" }, { "AABC", "AABC_1" },
+        { "AB", "AB_1" }, { "ABAA", "ABAA_1" }, { "ABC", "ABC_1" },   { "AC", "AC_1" },
+    };
+
+    HSE_KVDB_OPSPEC_INIT(&opspec);
+
+    hse_params_create(&params);
+
+    err = hse_params_set(params, "kvdb.c0_diag_mode", "1");
+    ASSERT_EQ(err, 0);
+
+    err = ikvdb_open(mpool, ds, params, &h);
+    ASSERT_EQ(0, err);
+    ASSERT_NE(NULL, h);
+
+    err = ikvdb_kvs_make(h, kvs, NULL);
+    ASSERT_EQ(0, err);
+
+    err = ikvdb_kvs_open(h, kvs, 0, 0, &kvs_h);
+    ASSERT_EQ(0, err);
+
+    for (i = 0; i < NELEM(kvdata); ++i) {
+        kvs_ktuple_init(&kt, kvdata[i].key, strlen(kvdata[i].key));
+        kvs_vtuple_init(&vt, kvdata[i].val, strlen(kvdata[i].val));
+
+        err = ikvdb_kvs_put(kvs_h, &opspec, &kt, &vt);
+        ASSERT_EQ(0, err);
+    }
+
+    err = ikvdb_kvs_cursor_create(kvs_h, &opspec, 0, 0, &cur);
+    ASSERT_EQ(0, err);
+    ASSERT_NE(NULL, cur);
+
+    /* The first pair needs 6 bytes, so it must be retained by the cursor.
+     */
+    err = ikvdb_kvs_cursor_read_many(cur, 0, buf, 5, kvov, NELEM(kvov), &cnt, &eof);
+    ASSERT_EQ(EMSGSIZE, merr_errno(err));
+    ASSERT_EQ(0, cnt);
+
+    /* Pairs are 6 to 10 bytes long, so a 32 byte buffer holds at most
+     * three of them and the pair that doesn't fit is returned next.
+     */
+    for (i = 0;;) {
+        err = ikvdb_kvs_cursor_read_many(cur, 0, buf, sizeof(buf), kvov, NELEM(kvov), &cnt, &eof);
+        ASSERT_EQ(0, err);
+        if (eof && cnt == 0)
+            break;
+
+        ASSERT_GT(cnt, 0);
+
+        for (j = 0; j < cnt; ++j, ++i) {
+            ASSERT_LT(i, NELEM(sorted));
+            ASSERT_EQ(kvov[j].kvo_klen, strlen(sorted[i].key));
+            ASSERT_EQ(kvov[j].kvo_vlen, strlen(sorted[i].val));
+            ASSERT_EQ(0, memcmp(buf + kvov[j].kvo_koff, sorted[i].key, kvov[j].kvo_klen));
+            ASSERT_EQ(0, memcmp(buf + kvov[j].kvo_voff, sorted[i].val, kvov[j].kvo_vlen));
+        }
+    }
+    ASSERT_EQ(i, NELEM(sorted));
+
+    err = ikvdb_kvs_cursor_destroy(cur);
+    ASSERT_EQ(0, err);
+
+    err = ikvdb_kvs_close(kvs_h);
+    ASSERT_EQ(0, err);
+
+    err = ikvdb_close(h);
+    ASSERT_EQ(0, err);
+
+    hse_params_destroy(params);
+}
+
 MTF_DEFINE_UTEST_PREPOST(ikvdb_test, cursor_tx, test_pre_c0, test_post_c0)
 {
     struct ikvdb *         h = NULL;
@@ -0,0 +1,283 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2015-2020 Micron Technology, Inc.  All rights reserved.
+ */
+
+#include <hse_ut/framework.h>
+#include <hse_test_support/random_buffer.h>
+
+#include <hse_util/hse_err.h>
+#include <hse_util/compression_lz4.h>
+
+#include <hse/hse_limits.h>
+
+#include "../kvdb_chunk.h"
+
+#define KVCNT 1000
+#define VLEN 100
+
+static char *ubuf, *cbuf, *dbuf, *chnkbuf;
+static uint  ubufsz, cbufsz;
+static uint  fill_kvcnt, fill_vlen;
+
+static int
+chunk_pre(struct mtf_test_info *lcl_ti)
+{
+    ubufsz = KVCNT * (sizeof(struct kvdb_kvmeta_omf) + 16 + VLEN);
+    cbufsz = compress_lz4_ops.cop_estimate(NULL, ubufsz);
+
+    ubuf = malloc(ubufsz);
+    cbuf = malloc(cbufsz);
+    dbuf = malloc(ubufsz);
+    chnkbuf = malloc(sizeof(struct kvdb_chunk_omf) + ubufsz);
+
+    return !ubuf || !cbuf || !dbuf || !chnkbuf;
+}
+
+static int
+chunk_post(struct mtf_test_info *lcl_ti)
+{
+    free(chnkbuf);
+    free(dbuf);
+    free(cbuf);
+    free(ubuf);
+
+    return 0;
+}
+
+/* Fill ubuf with KVCNT records of compressible values, or with a single
+ * record whose random value takes up the whole buffer and won't compress.
+ */
+static uint
+chunk_fill(bool compressible)
+{
+    struct kvdb_kvmeta_omf kvmt;
+    char                   key[16];
+    uint                   ulen = 0;
+    int                    i, klen;
+
+    fill_kvcnt = compressible ? KVCNT : 1;
+    fill_vlen = compressible ? VLEN : ubufsz - sizeof(kvmt) - 11;
+
+    for (i = 0; i < fill_kvcnt; i++) {
+        klen = snprintf(key, sizeof(key), "key%08d", i);
+
+        omf_set_kvmt_klen(&kvmt, klen);
+        omf_set_kvmt_vlen(&kvmt, fill_vlen);
+        memcpy(ubuf + ulen, &kvmt, sizeof(kvmt));
+        ulen += sizeof(kvmt);
+        memcpy(ubuf + ulen, key, klen);
+        ulen += klen;
+
+        if (compressible)
+            memset(ubuf + ulen, 'a' + i % 26, fill_vlen);
+        else
+            randomize_buffer(ubuf + ulen, fill_vlen, i);
+        ulen += fill_vlen;
+    }
+
+    return ulen;
+}
+
+/* Lay out a chunk as ikvdb_kvs_export_chunk() writes it. */
+static size_t
+chunk_pack(uint ulen, uint *clenp)
+{
+    struct kvdb_chunk_omf chnk;
+    const void *          data;
+    uint                  dlen;
+
+    kvdb_chunk_pack(ubuf, ulen, fill_kvcnt, cbuf, cbufsz, &chnk, &data, &dlen);
+
+    *clenp = omf_chnk_clen(&chnk);
+
+    memcpy(chnkbuf, &chnk, sizeof(chnk));
+    memcpy(chnkbuf + sizeof(chnk), data, dlen);
+
+    return sizeof(chnk) + dlen;
+}
+
+static void
+chunk_verify(const void *rec, uint ulen, struct mtf_test_info *lcl_ti)
+{
+    const void *rend = rec + ulen;
+    const void *key, *val;
+    size_t      klen, vlen;
+    char        kbuf[16];
+    merr_t      err;
+    int         i;
+
+    ASSERT_EQ(0, memcmp(rec, ubuf, ulen));
+
+    for (i = 0; rec < rend; i++) {
+        err = kvdb_chunk_kv_next(&rec, rend, &key, &klen, &val, &vlen);
+        ASSERT_EQ(0, err);
+        ASSERT_EQ(snprintf(kbuf, sizeof(kbuf), "key%08d", i), klen);
+        ASSERT_EQ(0, memcmp(key, kbuf, klen));
+        ASSERT_EQ(fill_vlen, vlen);
+    }
+
+    ASSERT_EQ(fill_kvcnt, i);
+    ASSERT_EQ(rend, rec);
+}
+
+MTF_BEGIN_UTEST_COLLECTION(kvdb_chunk_test)
+
+MTF_DEFINE_UTEST_PREPOST(kvdb_chunk_test, compressed, chunk_pre, chunk_post)
+{
+    const void *rec;
+    size_t      len, clen_total;
+    uint        ulen, clen, rlen;
+    merr_t      err;
+
+    ulen = chunk_fill(true);
+    clen_total = chunk_pack(ulen, &clen);
+
+    ASSERT_GT(clen, 0);
+    ASSERT_LT(clen, ulen);
+    ASSERT_EQ(sizeof(struct kvdb_chunk_omf) + clen, clen_total);
+    ASSERT_EQ(KVCNT, omf_chnk_kvcnt((struct kvdb_chunk_omf *)chnkbuf));
+
+    err = kvdb_chunk_unpack(chnkbuf, clen_total, dbuf, ubufsz, &rec, &rlen, &len);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(clen_total, len);
+    ASSERT_EQ(ulen, rlen);
+    ASSERT_EQ(dbuf, rec);
+
+    chunk_verify(rec, rlen, lcl_ti);
+}
+
+MTF_DEFINE_UTEST_PREPOST(kvdb_chunk_test, raw_fallback, chunk_pre, chunk_post)
+{
+    const void *rec;
+    size_t      len, raw_total;
+    uint        ulen, clen, rlen;
+    merr_t      err;
+
+    /* A random value does not compress, so the chunk is stored raw. */
+    ulen = chunk_fill(false);
+    raw_total = chunk_pack(ulen, &clen);
+
+    ASSERT_EQ(0, clen);
+    ASSERT_EQ(sizeof(struct kvdb_chunk_omf) + ulen, raw_total);
+    ASSERT_EQ(1, omf_chnk_kvcnt((struct kvdb_chunk_omf *)chnkbuf));
+
+    err = kvdb_chunk_unpack(chnkbuf, raw_total, dbuf, ubufsz, &rec, &rlen, &len);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(raw_total, len);
+    ASSERT_EQ(ulen, rlen);
+    ASSERT_EQ(chnkbuf + sizeof(struct kvdb_chunk_omf), rec);
+
+    chunk_verify(rec, rlen, lcl_ti);
+}
+
+MTF_DEFINE_UTEST_PREPOST(kvdb_chunk_test, truncated, chunk_pre, chunk_post)
+{
+    const void *rec;
+    size_t      len, total;
+    uint        ulen, clen, rlen;
+    merr_t      err;
+    int         compressible;
+
+    for (compressible = 0; compressible < 2; compressible++) {
+        ulen = chunk_fill(compressible);
+        total = chunk_pack(ulen, &clen);
+
+        /* Truncated header */
+        err = kvdb_chunk_unpack(chnkbuf, sizeof(struct kvdb_chunk_omf) - 1,
+                                dbuf, ubufsz, &rec, &rlen, &len);
+        ASSERT_EQ(EPROTO, merr_errno(err));
+
+        /* Truncated payload */
+        err = kvdb_chunk_unpack(chnkbuf, total - 1, dbuf, ubufsz, &rec, &rlen, &len);
+        ASSERT_EQ(EFAULT, merr_errno(err));
+
+        /* Records that would not fit in the decompression buffer */
+        err = kvdb_chunk_unpack(chnkbuf, total, dbuf, ulen - 1, &rec, &rlen, &len);
+        ASSERT_EQ(EFAULT, merr_errno(err));
+
+        /* The whole chunk */
+        err = kvdb_chunk_unpack(chnkbuf, total, dbuf, ubufsz, &rec, &rlen, &len);
+        ASSERT_EQ(0, err);
+        ASSERT_EQ(total, len);
+    }
+}
+
+MTF_DEFINE_UTEST_PREPOST(kvdb_chunk_test, corrupt, chunk_pre, chunk_post)
+{
+    struct kvdb_chunk_omf *chnk = (void *)chnkbuf;
+    const void *           rec;
+    size_t                 len, total;
+    uint                   ulen, clen, rlen;
+    merr_t                 err;
+
+    ulen = chunk_fill(true);
+    total = chunk_pack(ulen, &clen);
+    ASSERT_GT(clen, 0);
+
+    /* Bad magic */
+    omf_set_chnk_magic(chnk, KVDB_CHUNK_MAGIC + 1);
+    err = kvdb_chunk_unpack(chnkbuf, total, dbuf, ubufsz, &rec, &rlen, &len);
+    ASSERT_EQ(EPROTO, merr_errno(err));
+    omf_set_chnk_magic(chnk, KVDB_CHUNK_MAGIC);
+
+    /* Uncompressed length disagrees with the payload */
+    omf_set_chnk_ulen(chnk, ulen - 1);
+    err = kvdb_chunk_unpack(chnkbuf, total, dbuf, ubufsz, &rec, &rlen, &len);
+    ASSERT_EQ(EPROTO, merr_errno(err));
+    omf_set_chnk_ulen(chnk, ulen);
+
+    /* Garbage payload */
+    memset(chnkbuf + sizeof(*chnk), 0xff, clen);
+    err = kvdb_chunk_unpack(chnkbuf, total, dbuf, ubufsz, &rec, &rlen, &len);
+    ASSERT_NE(0, err);
+}
+
+MTF_DEFINE_UTEST_PREPOST(kvdb_chunk_test, corrupt_records, chunk_pre, chunk_post)
+{
+    struct kvdb_kvmeta_omf *kvmt = (void *)ubuf;
+    const void *            rec, *key, *val;
+    size_t                  klen, vlen;
+    uint                    ulen;
+    merr_t                  err;
+
+    ulen = chunk_fill(true);
+
+    /* Truncated kvmeta */
+    rec = ubuf;
+    err = kvdb_chunk_kv_next(&rec, ubuf + sizeof(*kvmt) - 1, &key, &klen, &val, &vlen);
+    ASSERT_EQ(EFAULT, merr_errno(err));
+    ASSERT_EQ(ubuf, rec);
+
+    /* Truncated value */
+    rec = ubuf;
+    err = kvdb_chunk_kv_next(&rec, ubuf + sizeof(*kvmt) + 11 + VLEN - 1, &key, &klen, &val, &vlen);
+    ASSERT_EQ(EFAULT, merr_errno(err));
+
+    /* Empty key */
+    omf_set_kvmt_klen(kvmt, 0);
+    rec = ubuf;
+    err = kvdb_chunk_kv_next(&rec, ubuf + ulen, &key, &klen, &val, &vlen);
+    ASSERT_EQ(ENOENT, merr_errno(err));
+
+    /* Key too long */
+    omf_set_kvmt_klen(kvmt, HSE_KVS_KLEN_MAX + 1);
+    rec = ubuf;
+    err = kvdb_chunk_kv_next(&rec, ubuf + ulen, &key, &klen, &val, &vlen);
+    ASSERT_EQ(ENAMETOOLONG, merr_errno(err));
+
+    /* Value too long */
+    omf_set_kvmt_klen(kvmt, 11);
+    omf_set_kvmt_vlen(kvmt, HSE_KVS_VLEN_MAX + 1);
+    rec = ubuf;
+    err = kvdb_chunk_kv_next(&rec, ubuf + ulen, &key, &klen, &val, &vlen);
+    ASSERT_EQ(EMSGSIZE, merr_errno(err));
+
+    /* Value running past the end of the chunk */
+    omf_set_kvmt_vlen(kvmt, ulen);
+    rec = ubuf;
+    err = kvdb_chunk_kv_next(&rec, ubuf + ulen, &key, &klen, &val, &vlen);
+    ASSERT_EQ(EFAULT, merr_errno(err));
+}
+
+MTF_END_UTEST_COLLECTION(kvdb_chunk_test)
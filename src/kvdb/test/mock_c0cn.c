@@ -14,6 +14,7 @@
 #include <hse_ikvdb/c0.h>
 #include <hse_ikvdb/cndb.h>
 #include <hse_ikvdb/kvdb_health.h>
+#include <hse_ikvdb/merge_op.h>
 
 #include "../kvdb/kvdb_log.h"
 #include "../../cn/test/mock_kvset_builder.h"
@@ -60,6 +61,7 @@ struct mock_cn {
     struct c0_data *data;
     struct cndb *   cndb;
     atomic_t        refcnt;
+    struct merge_op mop;
 } __aligned(PAGE_SIZE);
 
 struct mock_c0 {
@@ -222,6 +224,12 @@ _c0_cursor_read(struct c0_cursor *cur, struct kvs_kvtuple *kvt, bool *eof)
     return 0;
 }
 
+static u64
+_c0_cursor_rtomb_lookup(struct c0_cursor *cur, const void *key, u32 klen)
+{
+    return 0;
+}
+
 static merr_t
 _c0_cursor_seek(
     struct c0_cursor * cur,
@@ -305,6 +313,67 @@ _cn_get(
     return 0;
 }
 
+static merr_t
+_cn_get_batch(
+    struct cn *          handle,
+    struct kvs_ktuple *  ktv,
+    u64                  seq,
+    enum key_lookup_res *resv,
+    struct kvs_buf *     vbufv,
+    uint                 cnt)
+{
+    uint i;
+
+    for (i = 0; i < cnt; ++i)
+        resv[i] = NOT_FOUND;
+    return 0;
+}
+
+static merr_t
+_cn_get_pinned(
+    struct cn *          handle,
+    struct kvs_ktuple *  kt,
+    u64                  seq,
+    enum key_lookup_res *res,
+    struct kvs_buf *     vbuf,
+    struct cn_vpin *     vpin)
+{
+    vpin->vp_kvset = NULL;
+    *res = NOT_FOUND;
+    return 0;
+}
+
+static void
+_cn_vpin_release(struct cn_vpin *vpin)
+{
+}
+
+static merr_t
+_cn_get_async(
+    struct cn *          handle,
+    struct kvs_ktuple *  kt,
+    u64                  seq,
+    enum key_lookup_res *res,
+    struct kvs_buf *     vbuf,
+    struct cn_aget *     ag,
+    bool *               pendingp)
+{
+    *pendingp = false;
+    *res = NOT_FOUND;
+    return 0;
+}
+
+static bool
+_c0_miss_lookup(struct c0 *handle, const struct kvs_ktuple *kt, bool probe)
+{
+    return false;
+}
+
+static void
+_c0_miss_insert(struct c0 *handle, const struct kvs_ktuple *kt, bool probe, u64 view)
+{
+}
+
 static merr_t
 _c0_del(struct c0 *handle, struct kvs_ktuple *kt, const uintptr_t seqno)
 {
@@ -324,6 +393,24 @@ _c0_del(struct c0 *handle, struct kvs_ktuple *kt, const uintptr_t seqno)
     return 0;
 }
 
+static merr_t
+_c0_range_del(struct c0 *handle, struct kvs_ktuple *start, struct kvs_ktuple *end, u64 *seqno)
+{
+    struct mock_c0 *m0 = (void *)handle;
+    int             i;
+
+    for (i = 0; i < KEY_CNT; ++i) {
+        struct c0_data *d = &m0->data[i];
+
+        if (d->klen && keycmp(start->kt_data, start->kt_len, d->key, d->klen) <= 0 &&
+            keycmp(d->key, d->klen, end->kt_data, end->kt_len) < 0)
+            d->klen = 0;
+    }
+
+    *seqno = 0;
+    return 0;
+}
+
 static merr_t
 _cn_open(
     struct cn_kvdb *    cn_kvdb,
@@ -356,7 +443,7 @@ _cn_open(
     cn->cndb = cndb;
     *out = (void *)cn;
 
-    return 0;
+    return merge_op_init(&cn->mop, rp);
 }
 
 static merr_t
@@ -403,6 +490,14 @@ _cn_disable_maint(struct cn *cn, bool onoff)
 {
 }
 
+static struct merge_op *
+_cn_get_merge_op(struct cn *h)
+{
+    struct mock_cn *cn = (void *)h;
+
+    return &cn->mop;
+}
+
 static int
 cmp(const void *a_, const void *b_)
 {
@@ -582,6 +677,11 @@ mock_cn_set()
     mapi_inject(mapi_idx_cn_ingestv, 0);
     mapi_inject(mapi_idx_cn_get_sfx_len, 0);
     mapi_inject(mapi_idx_cn_periodic, 0);
+    mapi_inject(mapi_idx_cn_split_keys, 0);
+    mapi_inject(mapi_idx_cn_load_create, 0);
+    mapi_inject(mapi_idx_cn_load_add, 0);
+    mapi_inject(mapi_idx_cn_load_commit, 0);
+    mapi_inject(mapi_idx_cn_load_destroy, 0);
 
     cp.cp_fanout = 8;
     mapi_inject_ptr(mapi_idx_cn_get_cparams, &cp);
@@ -591,11 +691,16 @@ mock_cn_set()
     MOCK_SET(cn, _cn_open);
     MOCK_SET(cn, _cn_close);
     MOCK_SET(cn, _cn_get);
+    MOCK_SET(cn, _cn_get_batch);
+    MOCK_SET(cn, _cn_get_pinned);
+    MOCK_SET(cn, _cn_vpin_release);
+    MOCK_SET(cn, _cn_get_async);
     MOCK_SET(cn, _cn_ref_get);
     MOCK_SET(cn, _cn_ref_put);
     MOCK_SET(cn, _cn_hash_get);
     MOCK_SET(cn, _cn_get_ingest_perfc);
     MOCK_SET(cn, _cn_disable_maint);
+    MOCK_SET(cn, _cn_get_merge_op);
 
     MOCK_SET(cn_cursor, _cn_cursor_create);
     MOCK_SET(cn_cursor, _cn_cursor_update);
@@ -612,17 +717,27 @@ mock_cn_unset()
     mapi_inject_unset(mapi_idx_cn_ingestv);
     mapi_inject_unset(mapi_idx_cn_get_sfx_len);
     mapi_inject_unset(mapi_idx_cn_periodic);
+    mapi_inject_unset(mapi_idx_cn_split_keys);
+    mapi_inject_unset(mapi_idx_cn_load_create);
+    mapi_inject_unset(mapi_idx_cn_load_add);
+    mapi_inject_unset(mapi_idx_cn_load_commit);
+    mapi_inject_unset(mapi_idx_cn_load_destroy);
 
     mock_kvset_builder_unset();
 
     MOCK_UNSET(cn, _cn_open);
     MOCK_UNSET(cn, _cn_close);
     MOCK_UNSET(cn, _cn_get);
+    MOCK_UNSET(cn, _cn_get_batch);
+    MOCK_UNSET(cn, _cn_get_pinned);
+    MOCK_UNSET(cn, _cn_vpin_release);
+    MOCK_UNSET(cn, _cn_get_async);
     MOCK_UNSET(cn, _cn_ref_get);
     MOCK_UNSET(cn, _cn_ref_put);
     MOCK_UNSET(cn, _cn_hash_get);
     MOCK_UNSET(cn, _cn_get_ingest_perfc);
     MOCK_UNSET(cn, _cn_disable_maint);
+    MOCK_UNSET(cn, _cn_get_merge_op);
 
     MOCK_UNSET(cn_cursor, _cn_cursor_create);
     MOCK_UNSET(cn_cursor, _cn_cursor_update);
@@ -641,11 +756,15 @@ mock_c0_set()
     MOCK_SET(c0, _c0_hash_get);
     MOCK_SET(c0, _c0_put);
     MOCK_SET(c0, _c0_get);
+    MOCK_SET(c0, _c0_miss_lookup);
+    MOCK_SET(c0, _c0_miss_insert);
     MOCK_SET(c0, _c0_del);
+    MOCK_SET(c0, _c0_range_del);
     MOCK_SET(c0, _c0_cursor_create);
     MOCK_SET(c0, _c0_cursor_update);
     MOCK_SET(c0, _c0_cursor_bind_txn);
     MOCK_SET(c0, _c0_cursor_read);
+    MOCK_SET(c0, _c0_cursor_rtomb_lookup);
     MOCK_SET(c0, _c0_cursor_seek);
     MOCK_SET(c0, _c0_cursor_save);
     MOCK_SET(c0, _c0_cursor_restore);
@@ -661,12 +780,16 @@ mock_c0_unset()
     MOCK_UNSET(c0, _c0_hash_get);
     MOCK_UNSET(c0, _c0_put);
     MOCK_UNSET(c0, _c0_get);
+    MOCK_UNSET(c0, _c0_miss_lookup);
+    MOCK_UNSET(c0, _c0_miss_insert);
     MOCK_UNSET(c0, _c0_del);
+    MOCK_UNSET(c0, _c0_range_del);
     MOCK_UNSET(c0, _c0_cursor_create);
     MOCK_UNSET(c0, _c0_cursor_update);
     MOCK_UNSET(c0, _c0_cursor_bind_txn);
     MOCK_UNSET(c0, _c0_cursor_seek);
     MOCK_UNSET(c0, _c0_cursor_read);
+    MOCK_UNSET(c0, _c0_cursor_rtomb_lookup);
     MOCK_UNSET(c0, _c0_cursor_save);
     MOCK_UNSET(c0, _c0_cursor_restore);
     MOCK_UNSET(c0, _c0_cursor_destroy);
@@ -20,8 +20,11 @@
 #include <hse_util/fmt.h>
 #include <hse_util/byteorder.h>
 #include <hse_util/slab.h>
+#include <hse_util/vlb.h>
+#include <hse_util/rcu.h>
 
 #include <hse_ikvdb/c0.h>
+#include <hse_ikvdb/c0sk.h>
 #include <hse_ikvdb/cn.h>
 #include <hse_ikvdb/kvs.h>
 #include <hse_ikvdb/limits.h>
@@ -32,6 +35,8 @@
 #include <hse_ikvdb/tuple.h>
 #include <hse_ikvdb/kvdb_health.h>
 #include <hse_ikvdb/cursor.h>
+#include <hse_ikvdb/merge_op.h>
+#include <hse_ikvdb/kvs_vcache.h>
 
 #include "kvs_params.h"
 
@@ -71,6 +76,9 @@ struct ikvs {
     struct perfc_set ikv_pkvsl_pc; /* Public kvs interfaces Lat. */
     struct perfc_set ikv_cc_pc;
     struct perfc_set ikv_cd_pc;
+    struct perfc_set ikv_vc_pc;
+
+    struct kvs_vcache *ikv_vcache;
 
     struct kvs_rparams ikv_rp;
 
@@ -78,9 +86,56 @@ struct ikvs {
     const char *ikv_mpool_name;
     struct cache_bucket *ikv_curcache_bktmem;
 
+    spinlock_t       ikv_pin_lock;
+    struct list_head ikv_pin_list;
+
     struct curcache ikv_curcachev[8];
 };
 
+/**
+ * struct kvs_pin_impl - a pinned value
+ * @kpi_handle: pinned value as seen by the caller
+ * @kpi_link:   ikv_pin_list linkage, valid while @kpi_vpin holds a kvset
+ * @kpi_kvs:    kvs on whose ikv_pin_list the pin was placed, NULL once
+ *              the pin has been detached by ikvs_pin_expire()
+ * @kpi_vpin:   reference to the value within its vblock
+ * @kpi_ctime:  time (ns) at which the value was pinned
+ * @kpi_buf:    copy of the value if it could not be referenced in place
+ *
+ * ikv_pin_list is kept in pin order so that ikvs_pin_expire() can stop
+ * at the first pin that has not yet outlived its lease.
+ */
+struct kvs_pin_impl {
+    struct kvs_pin   kpi_handle;
+    struct list_head kpi_link;
+    struct ikvs *    kpi_kvs;
+    struct cn_vpin   kpi_vpin;
+    u64              kpi_ctime;
+    char             kpi_buf[];
+};
+
+#define pin_h2r(_pin) container_of(_pin, struct kvs_pin_impl, kpi_handle)
+
+/**
+ * struct kvs_aget - an async get whose value read is pending in cn
+ * @ka_cn:   cn async get context
+ * @ka_vbuf: caller's value buffer
+ * @ka_cb:   caller's completion callback
+ * @ka_arg:  argument for @ka_cb
+ */
+struct kvs_aget {
+    struct cn_aget  ka_cn;
+    struct kvs_buf  ka_vbuf;
+    hse_kvs_get_cb *ka_cb;
+    void *          ka_arg;
+};
+
+/* Size of the pin allocation that is tried first.  Values that don't
+ * fit and cannot be referenced in place cause the lookup to be retried
+ * with an allocation large enough to hold the value.
+ */
+#define KVS_PIN_ALLOCSZ (512)
+
 struct perfc_name kvs_cc_perfc_op[] = {
     NE(PERFC_BA_CC_RESTORE, 2, "Count of cursor restores", "c_restores"),
     NE(PERFC_BA_CC_ALLOC, 2, "Count of cursor allocations", "c_allocations"),
@@ -140,14 +195,28 @@ struct perfc_name kvs_cd_perfc_op[] = {
 
 NE_CHECK(kvs_cd_perfc_op, PERFC_EN_CD, "cursor dist perfc ops table/enum mismatch");
 
+struct perfc_name kvs_vc_perfc_op[] = {
+    NE(PERFC_BA_VC_HIT, 2, "Count of value cache hits", "vc_hits"),
+    NE(PERFC_BA_VC_MISS, 2, "Count of value cache misses", "vc_misses"),
+    NE(PERFC_BA_VC_INSERT, 3, "Count of value cache inserts", "vc_inserts"),
+    NE(PERFC_BA_VC_EVICT, 3, "Count of value cache evictions", "vc_evictions"),
+};
+
+NE_CHECK(kvs_vc_perfc_op, PERFC_EN_VC, "value cache perfc ops table/enum mismatch");
+
 /* "pkvsl" stands for Public KVS interface Latencies" */
 struct perfc_name kvs_pkvsl_perfc_op[] = {
     NE(PERFC_LT_PKVSL_KVS_PUT, 3, "kvs_put latency", "kvs_put_lat", 7),
     NE(PERFC_LT_PKVSL_KVS_GET, 3, "kvs_get latency", "kvs_get_lat", 7),
     NE(PERFC_LT_PKVSL_KVS_DEL, 3, "kvs_delete latency", "kvs_del_lat", 7),
+    NE(PERFC_LT_PKVSL_KVS_GET_BATCH, 3, "kvs_get_batch latency", "kvs_get_batch_lat", 7),
+    NE(PERFC_LT_PKVSL_KVS_GET_PINNED, 3, "kvs_get_pinned latency", "kvs_get_pinned_lat", 7),
+    NE(PERFC_LT_PKVSL_KVS_GET_ASYNC, 3, "kvs_get_async latency", "kvs_get_async_lat", 7),
 
     NE(PERFC_LT_PKVSL_KVS_PFX_PROBE, 3, "kvs_prefix_probe latency", "kvs_pfx_probe_lat"),
     NE(PERFC_LT_PKVSL_KVS_PFX_DEL, 3, "kvs_prefix_delete latency", "kvs_pfx_del_lat"),
+    NE(PERFC_LT_PKVSL_KVS_RANGE_DEL, 3, "kvs_range_delete latency", "kvs_range_del_lat"),
+    NE(PERFC_LT_PKVSL_KVS_MERGE, 3, "kvs_merge latency", "kvs_merge_lat"),
 
     NE(PERFC_LT_PKVSL_KVS_CURSOR_CREATE, 3, "kvs_cursor_create latency", "kvs_cursor_create_lat"),
     NE(PERFC_LT_PKVSL_KVS_CURSOR_UPDATE, 3, "kvs_cursor_update latency", "kvs_cursor_update_lat"),
@@ -160,6 +229,10 @@ struct perfc_name kvs_pkvsl_perfc_op[] = {
        3,
        "kvs_cursor_read reverse latency",
        "kvs_cursor_readrev_lat"),
+    NE(PERFC_LT_PKVSL_KVS_CURSOR_READMANY,
+       3,
+       "kvs_cursor_read_many latency",
+       "kvs_cursor_readmany_lat"),
     NE(PERFC_LT_PKVSL_KVS_CURSOR_DESTROY,
        3,
        "kvs_cursor_destroy latency",
@@ -247,12 +320,17 @@ struct kvs_cursor_impl {
     u8 *                kci_last_kbuf;
     u32                 kci_last_klen;
 
+    struct kvs_kvtuple kci_spill; /* tuple read but not yet returned */
+    void *             kci_spill_buf;
+    void *             kci_mop_buf; /* folded merge operands */
+
     u32 kci_ready : 2;
     u32 kci_eof : 2;
     u32 kci_seek : 2;
     u32 kci_peek : 1;
     u32 kci_reverse : 1;
-    u32 kci_unused : 15;
+    u32 kci_spilled : 1;
+    u32 kci_unused : 14;
     u32 kci_pfx_len : 8;
 
     u64    kci_pfxhash;
@@ -273,6 +351,9 @@ kvs_destroy(struct ikvs *kvs);
 static void
 ikvs_cursor_reap(struct ikvs *kvs);
 
+static uint
+ikvs_pin_expire(struct ikvs *kvs, u64 before);
+
 void
 kvs_perfc_init(void)
 {
@@ -338,6 +419,11 @@ kvs_perfc_alloc(const char *mp_name, const char *kvs_name, struct ikvs *kvs)
             COMPNAME, dbname_buf, kvs_cd_perfc_op, PERFC_EN_CD, "set", &kvs->ikv_cd_pc))
         hse_log(HSE_ERR "cannot alloc kvs perf counters");
 
+    if (kvs->ikv_vcache &&
+        perfc_ctrseti_alloc(
+            COMPNAME, dbname_buf, kvs_vc_perfc_op, PERFC_EN_VC, "set", &kvs->ikv_vc_pc))
+        hse_log(HSE_ERR "cannot alloc kvs perf counters");
+
     /* Measure Public KVS interface Latencies */
     if (perfc_ctrseti_alloc(
             COMPNAME, dbname_buf, kvs_pkvsl_perfc_op, PERFC_EN_PKVSL, "set", &kvs->ikv_pkvsl_pc))
@@ -349,6 +435,7 @@ kvs_perfc_free(struct ikvs *ikvs)
 {
     perfc_ctrseti_free(&ikvs->ikv_cc_pc);
     perfc_ctrseti_free(&ikvs->ikv_cd_pc);
+    perfc_ctrseti_free(&ikvs->ikv_vc_pc);
     perfc_ctrseti_free(&ikvs->ikv_pkvsl_pc);
 }
 
@@ -427,6 +514,18 @@ kvs_open(
     ikvs->ikv_pfx_len = c0_get_pfx_len(ikvs->ikv_c0);
     ikvs->ikv_sfx_len = cn_get_sfx_len(ikvs->ikv_cn);
 
+    /* Capped kvs evict kvsets without an ingest, so the value cache
+     * cannot tell when their values disappear.
+     */
+    if (ikvs->ikv_rp.kvs_vcachesz && !cn_is_capped(ikvs->ikv_cn)) {
+        err = kvs_vcache_create(
+            ikvs->ikv_rp.kvs_vcachesz, ikvs->ikv_rp.kvs_vcache_vmax, &ikvs->ikv_vcache);
+        if (ev(err))
+            goto err_exit;
+
+        c0_vcache_set(ikvs->ikv_c0, ikvs->ikv_vcache);
+    }
+
     err = qctx_te_mem_init();
     if (ev(err))
         goto err_exit;
@@ -448,6 +547,8 @@ err_exit:
     if (ikvs) {
         if (ikvs->ikv_c0)
             c0_close(ikvs->ikv_c0);
+        if (ikvs->ikv_vcache)
+            synchronize_rcu();
         if (ikvs->ikv_cn)
             cn_close(ikvs->ikv_cn);
         kvs_destroy(ikvs);
@@ -486,10 +587,19 @@ kvs_close(struct ikvs *ikvs)
 
     ikvs_cursor_reap(ikvs);
 
+    if (ikvs_pin_expire(ikvs, U64_MAX) > 0)
+        hse_log(HSE_WARNING "%s: kvs %s closed with pinned values", __func__, ikvs->ikv_kvs_name);
+
     err = c0_close(ikvs->ikv_c0);
     if (err)
         hse_elog(HSE_ERR "%s: c0_close @@e", err, __func__);
 
+    /* c0_close() unregistered the value cache, wait for any c0sk
+     * flush that may still be using it.
+     */
+    if (ikvs->ikv_vcache)
+        synchronize_rcu();
+
     if (ikvs->ikv_c1 && !ikvs->ikv_rp.rdonly) {
         err = c1_sync(ikvs->ikv_c1);
         if (err)
@@ -566,6 +676,146 @@ ikvs_put(
     return err;
 }
 
+merr_t
+ikvs_merge(
+    struct ikvs *           kvs,
+    struct hse_kvdb_opspec *os,
+    struct kvs_ktuple *     kt,
+    const void *            operand,
+    size_t                  len,
+    u64                     seqno)
+{
+    struct perfc_set *pkvsl_pc = ikvs_perfc_pkvsl(kvs);
+    struct merge_op * mop = cn_get_merge_op(kvs->ikv_cn);
+    struct kvs_vtuple vt;
+    size_t            sfx_len;
+    u64               tstart;
+    merr_t            err;
+
+    /* Operands are resolved against committed data, see
+     * ikvs_merge_resolve(), so they cannot be part of a txn.
+     */
+    if (ev(os && os->kop_txn))
+        return merr(EINVAL);
+
+    err = merge_op_valid(mop, operand, len);
+    if (ev(err))
+        return err;
+
+    tstart = perfc_lat_start(pkvsl_pc);
+
+    sfx_len = kvs->ikv_sfx_len;
+    kt->kt_hash = key_hash64(kt->kt_data, kt->kt_len - sfx_len);
+
+    if (ev(sfx_len && kt->kt_len < sfx_len + kvs->ikv_pfx_len))
+        return merr(EINVAL);
+
+    kvs_vtuple_init(&vt, (void *)operand, len | HSE_XLEN_MOP);
+
+    err = c0_put(kvs->ikv_c0, kt, &vt, seqno);
+
+    perfc_lat_record(pkvsl_pc, PERFC_LT_PKVSL_KVS_MERGE, tstart);
+
+    return err;
+}
+
+void
+ikvs_merge_fn_set(struct ikvs *kvs, hse_kvs_merge_fn *fn, void *arg)
+{
+    struct merge_op *mop = cn_get_merge_op(kvs->ikv_cn);
+
+    mop->mo_arg = arg;
+    mop->mo_fn = fn;
+}
+
+/**
+ * ikvs_merge_resolve() - fold the merge operands of a key into a value
+ * @kvs:    kvs handle
+ * @kt:     key (hashed)
+ * @seqno:  seqno of the newest visible operand
+ * @res:    (output) lookup result
+ * @vbuf:   (output) the folded value
+ *
+ * The operands are collected newest to oldest by repeating the lookup
+ * just below the previous operand until a value, a tombstone or nothing
+ * is found, and are then applied to the value (if any).  The lookups
+ * only see committed data, so the result does not depend on the view
+ * of the caller beyond @seqno.
+ */
+static merr_t
+ikvs_merge_resolve(
+    struct ikvs *        kvs,
+    struct kvs_ktuple *  kt,
+    u64                  seqno,
+    enum key_lookup_res *res,
+    struct kvs_buf *     vbuf)
+{
+    struct merge_opv opv = { 0 };
+    struct kvs_buf   buf;
+    const void *     base = NULL;
+    void *           mem, *out;
+    uint             blen = 0, outlen;
+    merr_t           err;
+
+    /* The first half holds the looked up values, the second the result.
+     */
+    mem = vlb_alloc(VLB_ALLOCSZ_MAX);
+    if (ev(!mem))
+        return merr(ENOMEM);
+
+    out = mem + HSE_KVS_VLEN_MAX;
+
+    while (1) {
+        kvs_buf_init(&buf, mem, HSE_KVS_VLEN_MAX);
+
+        err = c0_get(kvs->ikv_c0, kt, seqno, 0, res, &buf);
+        if (!err && *res == NOT_FOUND)
+            err = cn_get(kvs->ikv_cn, kt, seqno, res, &buf);
+
+        if (ev(err))
+            goto out;
+
+        if (*res != FOUND_MOP)
+            break;
+
+        err = merge_opv_add(&opv, buf.b_seq, mem, buf.b_len);
+        if (ev(err) || buf.b_seq == 0)
+            goto out;
+
+        seqno = buf.b_seq - 1;
+    }
+
+    if (*res == FOUND_VAL) {
+        base = mem;
+        blen = buf.b_len;
+    }
+
+    /* A compaction may have folded the operands since they were found.
+     */
+    if (opv.mov_cnt == 0) {
+        out = mem;
+        outlen = blen;
+    } else {
+        err = merge_op_fold(
+            cn_get_merge_op(kvs->ikv_cn), kt->kt_data, kt->kt_len, base, blen, &opv, out, &outlen);
+        if (ev(err))
+            goto out;
+
+        *res = FOUND_VAL;
+    }
+
+    if (*res == FOUND_VAL && vbuf->b_buf && vbuf->b_buf_sz > 0)
+        memcpy(vbuf->b_buf, out, min_t(u32, outlen, vbuf->b_buf_sz));
+
+    vbuf->b_len = (*res == FOUND_VAL) ? outlen : 0;
+
+out:
+    merge_opv_free(&opv);
+    vlb_free(mem, VLB_ALLOCSZ_MAX);
+
+    return err;
+}
+
 merr_t
 ikvs_get(
     struct ikvs *           kvs,
@@ -581,6 +831,7 @@ ikvs_get(
     struct kvdb_ctxn *ctxn;
     size_t            hashlen;
     u64               tstart;
+    bool              fill = false;
     merr_t            err;
 
     tstart = perfc_lat_start(pkvsl_pc);
@@ -590,6 +841,12 @@ ikvs_get(
 
     ctxn = (os && os->kop_txn) ? kvdb_ctxn_h2h(os->kop_txn) : 0;
 
+    if (!ctxn && c0_miss_lookup(c0, kt, false)) {
+        *res = NOT_FOUND;
+        vbuf->b_len = 0;
+        goto out;
+    }
+
     if (!ctxn)
         err = c0_get(c0, kt, seqno, 0, res, vbuf);
     else
@@ -600,16 +857,415 @@ ikvs_get(
             err = kvdb_ctxn_get_view_seqno(ctxn, &seqno);
             if (ev(err))
                 return err;
+        } else if (kvs->ikv_vcache) {
+            /* A non-transactional view includes everything in cN, so
+             * the value cache may serve it, and be filled from it.
+             * c0sk drops the entry of each key written to c0, hence
+             * an entry is current whenever c0 misses the key.
+             */
+            if (kvs_vcache_lookup(kvs->ikv_vcache, kt, vbuf)) {
+                perfc_inc(&kvs->ikv_vc_pc, PERFC_BA_VC_HIT);
+                *res = FOUND_VAL;
+                goto out;
+            }
+
+            perfc_inc(&kvs->ikv_vc_pc, PERFC_BA_VC_MISS);
+            vbuf->b_expiry = 0;
+            fill = true;
         }
 
         err = cn_get(cn, kt, seqno, res, vbuf);
+
+        if (fill && !err && *res == FOUND_VAL) {
+            uint evicted = c0_vcache_insert(c0, kt, seqno, vbuf);
+
+            perfc_inc(&kvs->ikv_vc_pc, PERFC_BA_VC_INSERT);
+            if (evicted > 0)
+                perfc_add(&kvs->ikv_vc_pc, PERFC_BA_VC_EVICT, evicted);
+        }
     }
 
+    if (!err && *res == FOUND_MOP)
+        err = ikvs_merge_resolve(kvs, kt, vbuf->b_seq, res, vbuf);
+
+    if (!ctxn && !err && (*res == NOT_FOUND || *res == FOUND_TMB || *res == FOUND_PTMB))
+        c0_miss_insert(c0, kt, false, seqno);
+
+out:
     perfc_lat_record(pkvsl_pc, PERFC_LT_PKVSL_KVS_GET, tstart);
 
     return err;
 }
 
+static void
+ikvs_get_async_done(struct cn_aget *cnag, merr_t err)
+{
+    struct kvs_aget *ag = container_of(cnag, struct kvs_aget, ka_cn);
+
+    ag->ka_cb(ag->ka_arg, err, !err, err ? 0 : ag->ka_vbuf.b_len);
+
+    free(ag);
+}
+
+merr_t
+ikvs_get_async(
+    struct ikvs *           kvs,
+    struct hse_kvdb_opspec *os,
+    struct kvs_ktuple *     kt,
+    u64                     seqno,
+    struct kvs_buf *        vbuf,
+    hse_kvs_get_cb *        cb,
+    void *                  arg)
+{
+    struct perfc_set *  pkvsl_pc = ikvs_perfc_pkvsl(kvs);
+    struct c0 *         c0 = kvs->ikv_c0;
+    struct cn *         cn = kvs->ikv_cn;
+    struct kvdb_ctxn *  ctxn;
+    struct kvs_aget *   ag;
+    enum key_lookup_res res;
+    bool                pending;
+    u64                 tstart;
+    merr_t              err;
+
+    tstart = perfc_lat_start(pkvsl_pc);
+
+    kt->kt_hash = key_hash64(kt->kt_data, kt->kt_len - kvs->ikv_sfx_len);
+
+    ctxn = (os && os->kop_txn) ? kvdb_ctxn_h2h(os->kop_txn) : 0;
+
+    if (!ctxn)
+        err = c0_get(c0, kt, seqno, 0, &res, vbuf);
+    else
+        err = kvdb_ctxn_get(ctxn, c0, cn, kt, &res, vbuf);
+
+    if (ev(err))
+        goto out;
+
+    if (res == NOT_FOUND) {
+        if (ctxn) {
+            err = kvdb_ctxn_get_view_seqno(ctxn, &seqno);
+            if (ev(err))
+                goto out;
+        }
+
+        ag = malloc(sizeof(*ag));
+        if (ev(!ag)) {
+            err = merr(ENOMEM);
+            goto out;
+        }
+
+        ag->ka_cn.ag_cb = ikvs_get_async_done;
+        ag->ka_vbuf = *vbuf;
+        ag->ka_cb = cb;
+        ag->ka_arg = arg;
+
+        err = cn_get_async(cn, kt, seqno, &res, &ag->ka_vbuf, &ag->ka_cn, &pending);
+        if (!err && pending)
+            goto out; /* ag is now owned by ikvs_get_async_done() */
+
+        *vbuf = ag->ka_vbuf;
+        free(ag);
+
+        if (ev(err))
+            goto out;
+    }
+
+    /* Merge operands are never pending, they are stored in the kmd.
+     */
+    if (res == FOUND_MOP) {
+        err = ikvs_merge_resolve(kvs, kt, vbuf->b_seq, &res, vbuf);
+        if (ev(err))
+            goto out;
+    }
+
+    cb(arg, 0, res == FOUND_VAL, res == FOUND_VAL ? vbuf->b_len : 0);
+
+out:
+    perfc_lat_record(pkvsl_pc, PERFC_LT_PKVSL_KVS_GET_ASYNC, tstart);
+
+    return err;
+}
+
+merr_t
+ikvs_get_pinned(
+    struct ikvs *           kvs,
+    struct hse_kvdb_opspec *os,
+    struct kvs_ktuple *     kt,
+    u64                     seqno,
+    enum key_lookup_res *   res,
+    struct kvs_pin **       pinp)
+{
+    struct perfc_set *   pkvsl_pc = ikvs_perfc_pkvsl(kvs);
+    struct c0 *          c0 = kvs->ikv_c0;
+    struct cn *          cn = kvs->ikv_cn;
+    struct kvs_pin_impl *pin;
+    struct kvdb_ctxn *   ctxn;
+    struct kvs_buf       vbuf;
+    size_t               bufsz;
+    u64                  tstart;
+    merr_t               err;
+
+    *pinp = NULL;
+
+    tstart = perfc_lat_start(pkvsl_pc);
+
+    kt->kt_hash = key_hash64(kt->kt_data, kt->kt_len - kvs->ikv_sfx_len);
+
+    ctxn = (os && os->kop_txn) ? kvdb_ctxn_h2h(os->kop_txn) : 0;
+
+    /* Fix the view up front so that a retried lookup sees the same value.
+     */
+    if (ctxn) {
+        err = kvdb_ctxn_get_view_seqno(ctxn, &seqno);
+        if (ev(err))
+            return err;
+    }
+
+    bufsz = KVS_PIN_ALLOCSZ - sizeof(*pin);
+
+    while (1) {
+        pin = malloc(sizeof(*pin) + bufsz);
+        if (ev(!pin))
+            return merr(ENOMEM);
+
+        memset(pin, 0, sizeof(*pin));
+        kvs_buf_init(&vbuf, pin->kpi_buf, bufsz);
+
+        if (!ctxn)
+            err = c0_get(c0, kt, seqno, 0, res, &vbuf);
+        else
+            err = kvdb_ctxn_get(ctxn, c0, cn, kt, res, &vbuf);
+
+        if (!err && *res == NOT_FOUND)
+            err = cn_get_pinned(cn, kt, seqno, res, &vbuf, &pin->kpi_vpin);
+
+        if (!err && *res == FOUND_MOP)
+            err = ikvs_merge_resolve(kvs, kt, vbuf.b_seq, res, &vbuf);
+
+        if (err || *res != FOUND_VAL) {
+            free(pin);
+            goto out;
+        }
+
+        if (pin->kpi_vpin.vp_kvset || vbuf.b_len <= bufsz)
+            break;
+
+        bufsz = vbuf.b_len;
+        free(pin);
+    }
+
+    if (pin->kpi_vpin.vp_kvset) {
+        pin->kpi_handle.kp_data = pin->kpi_vpin.vp_data;
+        pin->kpi_handle.kp_len = pin->kpi_vpin.vp_len;
+        pin->kpi_kvs = kvs;
+        pin->kpi_ctime = get_time_ns();
+
+        spin_lock(&kvs->ikv_pin_lock);
+        list_add_tail(&pin->kpi_link, &kvs->ikv_pin_list);
+        spin_unlock(&kvs->ikv_pin_lock);
+    } else {
+        pin->kpi_handle.kp_data = pin->kpi_buf;
+        pin->kpi_handle.kp_len = vbuf.b_len;
+    }
+
+    *pinp = &pin->kpi_handle;
+
+out:
+    perfc_lat_record(pkvsl_pc, PERFC_LT_PKVSL_KVS_GET_PINNED, tstart);
+
+    return err;
+}
+
+void
+ikvs_pin_release(struct kvs_pin *handle)
+{
+    struct kvs_pin_impl *pin;
+    struct cn_vpin       vpin;
+    struct ikvs *        kvs;
+
+    if (!handle)
+        return;
+
+    pin = pin_h2r(handle);
+
+    /* The pin may have been detached by ikvs_pin_expire(), in which
+     * case it is no longer on the pin list and its kvs (which may
+     * since have been closed) must not be touched.  Should the lease
+     * expire after kpi_kvs is read the kvs is still open, and the pin
+     * is found to be detached under the pin lock.
+     */
+    kvs = pin->kpi_kvs;
+    if (kvs) {
+        spin_lock(&kvs->ikv_pin_lock);
+        vpin = pin->kpi_vpin;
+        if (vpin.vp_kvset)
+            list_del(&pin->kpi_link);
+        pin->kpi_vpin.vp_kvset = NULL;
+        pin->kpi_kvs = NULL;
+        spin_unlock(&kvs->ikv_pin_lock);
+
+        cn_vpin_release(&vpin);
+    }
+
+    free(pin);
+}
+
+/*
+ * ikvs_pin_expire() - drop the kvset refs of pins created before @before
+ *
+ * The pins themselves remain owned by the caller of ikvs_get_pinned(),
+ * but their values can no longer be dereferenced, and they are detached
+ * from the kvs so that they may be released after it is closed.  Refs
+ * are collected under the pin lock and dropped outside it as dropping
+ * the last ref on a kvset destroys it.
+ */
+static uint
+ikvs_pin_expire(struct ikvs *kvs, u64 before)
+{
+    struct kvs_pin_impl *pin;
+    struct cn_vpin       vpinv[32];
+    uint                 cnt, n, i;
+
+    cnt = 0;
+
+    do {
+        n = 0;
+
+        spin_lock(&kvs->ikv_pin_lock);
+        while (n < NELEM(vpinv)) {
+            pin = list_first_entry_or_null(&kvs->ikv_pin_list, struct kvs_pin_impl, kpi_link);
+            if (!pin || pin->kpi_ctime >= before)
+                break;
+
+            list_del(&pin->kpi_link);
+            vpinv[n++] = pin->kpi_vpin;
+            pin->kpi_vpin.vp_kvset = NULL;
+            pin->kpi_kvs = NULL;
+        }
+        spin_unlock(&kvs->ikv_pin_lock);
+
+        for (i = 0; i < n; ++i)
+            cn_vpin_release(vpinv + i);
+
+        cnt += n;
+    } while (n == NELEM(vpinv));
+
+    return cnt;
+}
+
+/**
+ * ikvs_get_batch() - look up a vector of keys at a single view seqno
+ *
+ * Each key is first looked up in c0 (or the transaction).  The keys that
+ * miss are gathered into groups of up to %CN_GET_BATCH_MAX and handed to
+ * cn_get_batch() so that the cN tree is descended once per group rather
+ * than once per key.
+ */
+merr_t
+ikvs_get_batch(
+    struct ikvs *           kvs,
+    struct hse_kvdb_opspec *os,
+    struct kvs_ktuple *     ktv,
+    u64                     seqno,
+    enum key_lookup_res *   resv,
+    struct kvs_buf *        vbufv,
+    uint                    cnt)
+{
+    struct perfc_set *  pkvsl_pc = ikvs_perfc_pkvsl(kvs);
+    struct c0 *         c0 = kvs->ikv_c0;
+    struct cn *         cn = kvs->ikv_cn;
+    struct kvdb_ctxn *  ctxn;
+    struct kvs_ktuple   cn_ktv[CN_GET_BATCH_MAX];
+    struct kvs_buf      cn_vbufv[CN_GET_BATCH_MAX];
+    enum key_lookup_res cn_resv[CN_GET_BATCH_MAX];
+    u16                 cn_idxv[CN_GET_BATCH_MAX];
+    uint                cn_cnt, i, j;
+    u64                 tstart;
+    merr_t              err;
+
+    tstart = perfc_lat_start(pkvsl_pc);
+
+    ctxn = (os && os->kop_txn) ? kvdb_ctxn_h2h(os->kop_txn) : 0;
+
+    for (i = 0; i < cnt; ++i)
+        ktv[i].kt_hash = key_hash64(ktv[i].kt_data, ktv[i].kt_len - kvs->ikv_sfx_len);
+
+    if (ctxn) {
+        err = kvdb_ctxn_get_view_seqno(ctxn, &seqno);
+        if (ev(err))
+            return err;
+    }
+
+    cn_cnt = 0;
+
+    for (i = 0; i < cnt; ++i) {
+        if (!ctxn)
+            err = c0_get(c0, ktv + i, seqno, 0, resv + i, vbufv + i);
+        else
+            err = kvdb_ctxn_get(ctxn, c0, cn, ktv + i, resv + i, vbufv + i);
+
+        if (ev(err))
+            return err;
+
+        if (resv[i] == NOT_FOUND) {
+            cn_ktv[cn_cnt] = ktv[i];
+            cn_vbufv[cn_cnt] = vbufv[i];
+            cn_idxv[cn_cnt++] = i;
+        }
+
+        if (cn_cnt < CN_GET_BATCH_MAX && i + 1 < cnt)
+            continue;
+
+        if (cn_cnt > 0) {
+            err = cn_get_batch(cn, cn_ktv, seqno, cn_resv, cn_vbufv, cn_cnt);
+            if (ev(err))
+                return err;
+
+            for (j = 0; j < cn_cnt; ++j) {
+                resv[cn_idxv[j]] = cn_resv[j];
+                vbufv[cn_idxv[j]] = cn_vbufv[j];
+            }
+
+            cn_cnt = 0;
+        }
+    }
+
+    for (i = 0; i < cnt; ++i) {
+        if (resv[i] == FOUND_MOP) {
+            err = ikvs_merge_resolve(kvs, ktv + i, vbufv[i].b_seq, resv + i, vbufv + i);
+            if (ev(err))
+                return err;
+        }
+    }
+
+    perfc_lat_record(pkvsl_pc, PERFC_LT_PKVSL_KVS_GET_BATCH, tstart);
+
+    return 0;
+}
+
+merr_t
+ikvs_batch_op_init(struct ikvs *kvs, struct c0sk_batch_op *op)
+{
+    struct kvs_ktuple *kt = &op->op_kt;
+    size_t             sfx_len = kvs->ikv_sfx_len;
+
+    /* See ikvs_put() */
+    if (ev(sfx_len && !op->op_tomb && kt->kt_len < sfx_len + kvs->ikv_pfx_len)) {
+        hse_log(
+            HSE_ERR "%s is a suffixed kvs. Keys must be at least "
+                    "pfx_len(%u) + sfx_len(%u) bytes long.",
+            kvs->ikv_kvs_name,
+            kvs->ikv_pfx_len,
+            kvs->ikv_sfx_len);
+        return merr(EINVAL);
+    }
+
+    kt->kt_hash = key_hash64(kt->kt_data, kt->kt_len - sfx_len);
+    op->op_skidx = c0_index(kvs->ikv_c0);
+
+    return 0;
+}
+
 merr_t
 ikvs_del(struct ikvs *kvs, struct hse_kvdb_opspec *os, struct kvs_ktuple *kt, u64 seqno)
 {
@@ -664,6 +1320,26 @@ ikvs_prefix_del(struct ikvs *kvs, struct hse_kvdb_opspec *os, struct kvs_ktuple
     return ev(err);
 }
 
+merr_t
+ikvs_range_del(
+    struct ikvs *      kvs,
+    struct kvs_ktuple *start,
+    struct kvs_ktuple *end,
+    u64 *              seqno)
+{
+    struct perfc_set *pkvsl_pc = ikvs_perfc_pkvsl(kvs);
+    u64               tstart;
+    merr_t            err;
+
+    tstart = perfc_lat_start(pkvsl_pc);
+
+    err = c0_range_del(kvs->ikv_c0, start, end, seqno);
+
+    perfc_lat_record(pkvsl_pc, PERFC_LT_PKVSL_KVS_RANGE_DEL, tstart);
+
+    return ev(err);
+}
+
 /*-  Prefix Probe -----------------------------------------------------*/
 
 merr_t
@@ -682,6 +1358,7 @@ ikvs_pfx_probe(
     struct kvdb_ctxn *ctxn;
     struct query_ctx  qctx;
     u64               tstart;
+    bool              cacheable;
     merr_t            err;
     int               i;
 
@@ -703,6 +1380,20 @@ ikvs_pfx_probe(
         kt->kt_hash = key_hash64(kt->kt_data, kt->kt_len);
 
     ctxn = (os && os->kop_txn) ? kvdb_ctxn_h2h(os->kop_txn) : 0;
+
+    /* Only probes for exactly the kvs prefix use the negative cache,
+     * see c0sk_negc_inval().
+     */
+    cacheable = !ctxn && kt->kt_len == kvs->ikv_pfx_len;
+
+    if (cacheable && c0_miss_lookup(c0, kt, true)) {
+        *res = NOT_FOUND;
+        kbuf->b_len = 0;
+        vbuf->b_len = 0;
+        perfc_lat_record(pkvsl_pc, PERFC_LT_PKVSL_KVS_PFX_PROBE, tstart);
+        return 0;
+    }
+
     if (!ctxn)
         err = c0_pfx_probe(c0, kt, seqno, 0, res, &qctx, kbuf, vbuf);
     else
@@ -732,6 +1423,8 @@ done:
     switch (qctx.seen) {
         case 0:
             *res = NOT_FOUND;
+            if (cacheable)
+                c0_miss_insert(c0, kt, true, seqno);
             break;
         case 1:
             *res = FOUND_VAL;
@@ -740,6 +1433,20 @@ done:
             *res = FOUND_MULTIPLE;
     }
 
+    /* The value copied out for the first match may be a merge operand.
+     */
+    if (qctx.seen > 0 && vbuf->b_seq && kbuf->b_len <= kbuf->b_buf_sz) {
+        struct kvs_ktuple   mkt;
+        enum key_lookup_res mres;
+
+        kvs_ktuple_init_nohash(&mkt, kbuf->b_buf, kbuf->b_len);
+        mkt.kt_hash = key_hash64(mkt.kt_data, mkt.kt_len - kvs->ikv_sfx_len);
+
+        err = ikvs_merge_resolve(kvs, &mkt, vbuf->b_seq, &mres, vbuf);
+        if (ev(err))
+            return err;
+    }
+
     perfc_lat_record(pkvsl_pc, PERFC_LT_PKVSL_KVS_PFX_PROBE, tstart);
 
     return 0;
@@ -914,7 +1621,8 @@ ikvs_curcache_preen(
  * This routine must be called periodically to give back resources
  * that have been held too long.  Both c0 and cn have resources claimed
  * by cursors in applications, which may not be cooperative with the
- * underlying needs.  This task works against the cursor cache.
+ * underlying needs.  This task works against the cursor cache, and
+ * against pinned values that have outlived their lease.
  *
  * HSE_REVISIT:
  * There will be a peer task in ikvdb that works against the active cursors.
@@ -937,6 +1645,13 @@ ikvs_maint_task(struct ikvs *kvs, u64 now)
     if (cn_retired > 0)
         perfc_add(&kvs->ikv_cc_pc, PERFC_BA_CC_RETIRE_CN, cn_retired);
 
+    if (kvs->ikv_rp.cn_pin_lease > 0 && !list_empty(&kvs->ikv_pin_list)) {
+        u64 lease = kvs->ikv_rp.cn_pin_lease * 1048576;
+
+        if (now > lease)
+            ikvs_pin_expire(kvs, now - lease);
+    }
+
     cn_periodic(kvs->ikv_cn, now);
 }
 
@@ -1118,6 +1833,7 @@ ikvs_cursor_reset(struct kvs_cursor_impl *cursor, int bit)
     cursor->kci_eof &= ~bit;
     cursor->kci_seek &= ~bit;
     cursor->kci_peek &= ~bit;
+    cursor->kci_spilled = 0;
 
     cursor->kci_cc_pc = NULL;
     cursor->kci_cd_pc = NULL;
@@ -1567,6 +2283,12 @@ ikvs_cursor_destroy(struct hse_kvs_cursor *handle)
     if (cursor->kci_cncur)
         cn_cursor_destroy(cursor->kci_cncur);
 
+    if (cursor->kci_spill_buf)
+        vlb_free(cursor->kci_spill_buf, HSE_KVS_KLEN_MAX + HSE_KVS_VLEN_MAX);
+
+    if (cursor->kci_mop_buf)
+        vlb_free(cursor->kci_mop_buf, HSE_KVS_VLEN_MAX);
+
     kmem_cache_free(kvs_cursor_zone, cursor);
 }
 
@@ -1976,6 +2698,12 @@ repeat:
             toss = true;
     }
 
+    /* Everything in c0 is newer than cn, so toss cn keys covered by
+     * a range tombstone in c0.
+     */
+    if (bit == BIT_CN && !eof && !err && c0_cursor_rtomb_lookup(cursor->kci_c0cur, key, klen))
+        toss = true;
+
     if (eof)
         cursor->kci_eof |= bit;
     else if (!err)
@@ -2110,12 +2838,47 @@ ikvs_cursor_replenish(struct kvs_cursor_impl *cursor, bool *eofp)
     return 0;
 }
 
-merr_t
-ikvs_cursor_read(struct hse_kvs_cursor *handle, struct kvs_kvtuple *kvt, bool *eofp)
+/*
+ * Replace the merge operand in @kvt with the value folded at the view of
+ * the cursor.  A key whose operands apply to no value reads as a value
+ * folded from nothing, as it does for a get.
+ */
+static merr_t
+ikvs_cursor_merge(struct kvs_cursor_impl *cursor, struct kvs_kvtuple *kvt)
 {
-    struct kvs_cursor_impl *cursor = (void *)handle;
-    int                     oready;
-    int                     rc;
+    struct kvs_ktuple   kt;
+    struct kvs_buf      vbuf;
+    enum key_lookup_res res;
+    merr_t              err;
+
+    if (unlikely(!cursor->kci_mop_buf)) {
+        cursor->kci_mop_buf = vlb_alloc(HSE_KVS_VLEN_MAX);
+        if (ev(!cursor->kci_mop_buf))
+            return merr(ENOMEM);
+    }
+
+    kvs_ktuple_init_nohash(&kt, kvt->kvt_key.kt_data, kvt->kvt_key.kt_len);
+    kt.kt_hash = key_hash64(kt.kt_data, kt.kt_len - cursor->kci_kvs->ikv_sfx_len);
+
+    kvs_buf_init(&vbuf, cursor->kci_mop_buf, HSE_KVS_VLEN_MAX);
+
+    err = ikvs_merge_resolve(cursor->kci_kvs, &kt, cursor->kci_handle.kc_seq, &res, &vbuf);
+    if (ev(err))
+        return err;
+
+    kvs_vtuple_init(&kvt->kvt_value, cursor->kci_mop_buf, res == FOUND_VAL ? vbuf.b_len : 0);
+
+    return 0;
+}
+
+/*
+ * Merge the next tuple from c0 and cn and consume it from the cursor.
+ * The caller is responsible for the peek and read perf counters.
+ */
+static merr_t
+ikvs_cursor_next(struct kvs_cursor_impl *cursor, struct kvs_kvtuple *kvt, bool *eofp, int *oreadyp)
+{
+    int rc;
 
     if (ev(cursor->kci_err)) {
         if (ev(merr_errno(cursor->kci_err) != EAGAIN))
@@ -2148,7 +2911,7 @@ ikvs_cursor_read(struct hse_kvs_cursor *handle, struct kvs_kvtuple *kvt, bool *e
     }
 
     cursor->kci_summary.util++;
-    oready = cursor->kci_ready;
+    *oreadyp = cursor->kci_ready;
 
     /*
      * If this cursor tracks a tombspan, note the key we need to seek the cn
@@ -2176,8 +2939,6 @@ ikvs_cursor_read(struct hse_kvs_cursor *handle, struct kvs_kvtuple *kvt, bool *e
     }
 
     if (rc <= 0) {
-        perfc_inc(cursor->kci_cc_pc, PERFC_BA_CC_READ_C0);
-
         ++cursor->kci_summary.read_c0;
         cursor->kci_last = &cursor->kci_c0kv;
         cursor->kci_ready &= ~BIT_C0;
@@ -2187,8 +2948,6 @@ ikvs_cursor_read(struct hse_kvs_cursor *handle, struct kvs_kvtuple *kvt, bool *e
             cursor->kci_ready &= ~BIT_CN;
 
     } else {
-        perfc_inc(cursor->kci_cc_pc, PERFC_BA_CC_READ_CN);
-
         ++cursor->kci_summary.read_cn;
         cursor->kci_last = &cursor->kci_cnkv;
         cursor->kci_ready &= ~BIT_CN;
@@ -2196,6 +2955,58 @@ ikvs_cursor_read(struct hse_kvs_cursor *handle, struct kvs_kvtuple *kvt, bool *e
 
     *kvt = *cursor->kci_last;
 
+    if (unlikely(kvs_vtuple_mop(&kvt->kvt_value)))
+        return ikvs_cursor_merge(cursor, kvt);
+
+    return 0;
+}
+
+/*
+ * Retain a tuple that has been consumed from the merge but could not be
+ * returned to the caller, such that it is returned by the next read.  The
+ * tuple must be copied since its key and value may not remain addressable
+ * across a cursor update.
+ */
+static void
+ikvs_cursor_spill(struct kvs_cursor_impl *cursor, const struct kvs_kvtuple *kvt)
+{
+    u32   klen = kvt->kvt_key.kt_len;
+    u32   vlen = kvs_vtuple_vlen(&kvt->kvt_value);
+    char *buf = cursor->kci_spill_buf;
+
+    assert(buf && klen + vlen <= HSE_KVS_KLEN_MAX + HSE_KVS_VLEN_MAX);
+
+    memcpy(buf, kvt->kvt_key.kt_data, klen);
+    memcpy(buf + klen, kvt->kvt_value.vt_data, vlen);
+
+    kvs_ktuple_init_nohash(&cursor->kci_spill.kvt_key, buf, klen);
+    kvs_vtuple_init(&cursor->kci_spill.kvt_value, buf + klen, vlen);
+
+    cursor->kci_spilled = 1;
+}
+
+merr_t
+ikvs_cursor_read(struct hse_kvs_cursor *handle, struct kvs_kvtuple *kvt, bool *eofp)
+{
+    struct kvs_cursor_impl *cursor = (void *)handle;
+    int                     oready;
+    merr_t                  err;
+
+    if (unlikely(cursor->kci_spilled)) {
+        cursor->kci_spilled = 0;
+        *kvt = cursor->kci_spill;
+        *eofp = false;
+        return 0;
+    }
+
+    err = ikvs_cursor_next(cursor, kvt, eofp, &oready);
+    if (err || *eofp)
+        return err;
+
+    perfc_inc(
+        cursor->kci_cc_pc,
+        (cursor->kci_last == &cursor->kci_c0kv) ? PERFC_BA_CC_READ_C0 : PERFC_BA_CC_READ_CN);
+
     /* see comments in seek; do not change data state if peek */
     if (cursor->kci_peek) {
         cursor->kci_peek = 0;
@@ -2205,6 +3016,99 @@ ikvs_cursor_read(struct hse_kvs_cursor *handle, struct kvs_kvtuple *kvt, bool *e
     return 0;
 }
 
+merr_t
+ikvs_cursor_read_many(
+    struct hse_kvs_cursor *      handle,
+    void *                       buf,
+    size_t                       bufsz,
+    struct hse_kvs_cursor_kvoff *kvov,
+    uint                         kvomax,
+    uint *                       kvocntp,
+    bool *                       eofp)
+{
+    struct kvs_cursor_impl *cursor = (void *)handle;
+    struct kvs_kvtuple      kvt;
+    u64                     nc0 = 0, ncn = 0;
+    size_t                  off = 0;
+    merr_t                  err = 0;
+    uint                    n = 0;
+    int                     oready;
+
+    *eofp = false;
+
+    /* A seek that found eof leaves the peek flag set (see ikvs_cursor_seek()),
+     * but tuples read here are always consumed.
+     */
+    cursor->kci_peek = 0;
+
+    /* Offsets are reported as u32 */
+    bufsz = min_t(size_t, bufsz, U32_MAX);
+
+    /* The spill buffer must exist before a tuple is consumed that may
+     * not fit in the caller's buffer.
+     */
+    if (unlikely(!cursor->kci_spill_buf)) {
+        cursor->kci_spill_buf = vlb_alloc(HSE_KVS_KLEN_MAX + HSE_KVS_VLEN_MAX);
+        if (ev(!cursor->kci_spill_buf))
+            return merr(ENOMEM);
+    }
+
+    while (n < kvomax) {
+        u32 klen, vlen;
+
+        if (cursor->kci_spilled) {
+            kvt = cursor->kci_spill;
+        } else {
+            err = ikvs_cursor_next(cursor, &kvt, eofp, &oready);
+            if (err || *eofp)
+                break;
+
+            if (cursor->kci_last == &cursor->kci_c0kv)
+                ++nc0;
+            else
+                ++ncn;
+        }
+
+        klen = kvt.kvt_key.kt_len;
+        vlen = kvs_vtuple_vlen(&kvt.kvt_value);
+
+        if (klen + vlen > bufsz - off) {
+            if (!cursor->kci_spilled)
+                ikvs_cursor_spill(cursor, &kvt);
+            if (n == 0)
+                err = merr(EMSGSIZE);
+            break;
+        }
+
+        kvov[n].kvo_koff = off;
+        kvov[n].kvo_klen = klen;
+        memcpy(buf + off, kvt.kvt_key.kt_data, klen);
+        off += klen;
+
+        kvov[n].kvo_voff = off;
+        kvov[n].kvo_vlen = vlen;
+        memcpy(buf + off, kvt.kvt_value.vt_data, vlen);
+        off += vlen;
+
+        cursor->kci_spilled = 0;
+        ++n;
+    }
+
+    perfc_add2(cursor->kci_cc_pc, PERFC_BA_CC_READ_C0, nc0, PERFC_BA_CC_READ_CN, ncn);
+
+    *kvocntp = n;
+
+    /* Return what was read, the cursor retains any error from the merge
+     * (see ikvs_cursor_replenish()) and reports it on the next read.
+     */
+    if (err && n > 0) {
+        *eofp = false;
+        err = 0;
+    }
+
+    return err;
+}
+
 #undef bit_on
 
 static merr_t
@@ -2225,6 +3129,9 @@ kvs_create(struct ikvs **ikvs_out, struct kvs_rparams *rp)
     memset(ikvs, 0, sizeof(*ikvs));
     ikvs->ikv_rp = *rp;
 
+    spin_lock_init(&ikvs->ikv_pin_lock);
+    INIT_LIST_HEAD(&ikvs->ikv_pin_list);
+
     nmax = (PAGE_SIZE * 4) / sizeof(*bkt);
     n = NELEM(ikvs->ikv_curcachev) * nmax;
     sz = sizeof(*bkt) * n;
@@ -2271,6 +3178,8 @@ kvs_destroy(struct ikvs *kvs)
         mutex_destroy(&kvs->ikv_curcachev[i].cca_lock);
     free_aligned(kvs->ikv_curcache_bktmem);
 
+    kvs_vcache_destroy(kvs->ikv_vcache);
+
     free((void *)kvs->ikv_mpool_name);
     free((void *)kvs->ikv_kvs_name);
     free_aligned(kvs);
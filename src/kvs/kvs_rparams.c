@@ -50,9 +50,12 @@ kvs_rparams_defaults(void)
         .cn_bloom_prob = 10000,
         .cn_bloom_capped = 0,
         .cn_bloom_preload = 0,
+        .cn_bloom_static = 0,
+        .cn_bloom_pfx = 1,
 
         .cn_node_size_lo = 20 * 1024,
         .cn_node_size_hi = 28 * 1024,
+        .cn_load_kvset_mb = 8 * 1024,
 
         .cn_compact_vblk_ra = 256 * 1024,
         .cn_compact_kblk_ra = 512 * 1024,
@@ -68,6 +71,8 @@ kvs_rparams_defaults(void)
         .cn_cursor_kra = 0,
         .cn_cursor_seq = 0,
 
+        .cn_pin_lease = 10000,
+
         .cn_mcache_wbt = 0,
         .cn_mcache_vmin = 256,
         .cn_mcache_vmax = 4096,
@@ -84,11 +89,14 @@ kvs_rparams_defaults(void)
 
         .cn_compaction_debug = 0,
         .cn_io_threads = 13,
+        .cn_aget_threads = 16,
         .cn_maint_delay = 100,
         .cn_close_wait = 0,
 
         .cn_verify = 0,
         .cn_kcachesz = 1024 * 1024,
+        .kvs_vcachesz = 0,
+        .kvs_vcache_vmax = 1024,
         .kblock_size_mb = 32,
         .vblock_size_mb = 32,
 
@@ -108,6 +116,7 @@ kvs_rparams_defaults(void)
 
         .vcompmin = CN_SMALL_VALUE_THRESHOLD,
         .value_compression = VCOMP_PARAM_NONE,
+        .merge_op = MERGE_OP_PARAM_NONE,
 
         .rpmagic = RPARAMS_MAGIC,
     };
@@ -123,6 +132,7 @@ static struct param_inst  kvs_rp_table[] = {
 
     KVS_PARAM_EXP(cn_node_size_lo, "low end of max node size range (MiB)"),
     KVS_PARAM_EXP(cn_node_size_hi, "high end of max node size range (MiB)"),
+    KVS_PARAM_EXP(cn_load_kvset_mb, "max size of a kvset built by a bulk load (MiB)"),
 
     KVS_PARAM_EXP(cn_compact_vblk_ra, "compaction vblk read-ahead (bytes)"),
     KVS_PARAM_EXP(cn_compact_vra, "compaction vblk read-ahead via mcache"),
@@ -136,6 +146,8 @@ static struct param_inst  kvs_rp_table[] = {
     KVS_PARAM_EXP(cn_cursor_kra, "cursor kblk madvise-ahead (boolean)"),
     KVS_PARAM_EXP(cn_cursor_seq, "optimize cn_tree for longer sequential cursor accesses"),
 
+    KVS_PARAM_EXP(cn_pin_lease, "max time a pinned value may hold its kvset (ms, 0: no limit)"),
+
     KVS_PARAM_EXP(
         cn_mcache_wbt,
         "eagerly cache wbt nodes"
@@ -167,10 +179,16 @@ static struct param_inst  kvs_rp_table[] = {
     KVS_PARAM_EXP(cn_bloom_prob, "bloom create probability"),
     KVS_PARAM_EXP(cn_bloom_capped, "bloom create probability (capped kvs)"),
     KVS_PARAM_EXP(cn_bloom_preload, "preload mcache bloom filters"),
+    KVS_PARAM_EXP(
+        cn_bloom_static,
+        "use fuse filters instead of blooms in"
+        " (1:root, 2:internal, 4:leaf) nodes"),
+    KVS_PARAM_EXP(cn_bloom_pfx, "create prefix blooms (prefixed kvs)"),
 
     KVS_PARAM_EXP(cn_compaction_debug, "cn compaction debug flags"),
     KVS_PARAM_EXP(cn_maint_delay, "ms of delay between checks when idle"),
     KVS_PARAM_EXP(cn_io_threads, "number of cn mblock i/o threads"),
+    KVS_PARAM_EXP(cn_aget_threads, "number of cn async get i/o threads"),
     KVS_PARAM_EXP(
         cn_close_wait,
         "force close to wait until all active"
@@ -178,6 +196,8 @@ static struct param_inst  kvs_rp_table[] = {
 
     KVS_PARAM_EXP(cn_verify, "verify kvsets as they are created"),
     KVS_PARAM_EXP(cn_kcachesz, "max per-kvset key cache size (in bytes)"),
+    KVS_PARAM_EXP(kvs_vcachesz, "hot value cache size (in bytes, 0: disabled)"),
+    KVS_PARAM_EXP(kvs_vcache_vmax, "max value length held in the hot value cache"),
     KVS_PARAM_EXP(kblock_size_mb, "preferred kblock size (in MiB)"),
     KVS_PARAM_EXP(vblock_size_mb, "preferred vblock size (in MiB)"),
 
@@ -197,6 +217,7 @@ static struct param_inst  kvs_rp_table[] = {
 
     KVS_PARAM_EXP(vcompmin, "value length above which compression is considered"),
     KVS_PARAM_STR(value_compression, "value compression algorithm (lz4 or none)"),
+    KVS_PARAM_STR(merge_op, "merge operator (none, add, max, append or user)"),
 
     PARAM_INST_END
 };
@@ -299,6 +320,11 @@ kvs_rparams_validate(struct kvs_rparams *params)
         return merr(EINVAL);
     }
 
+    if (params->cn_bloom_static > 7) {
+        hse_log(HSE_ERR "cn_bloom_static must be a mask of 1 (root), 2 (internal) and 4 (leaf)");
+        return merr(EINVAL);
+    }
+
     if (params->cn_maint_delay < 20) {
         hse_log(HSE_ERR "cn_maint_delay must be greater than 20ms");
         return merr(EINVAL);
@@ -326,6 +352,11 @@ kvs_rparams_validate(struct kvs_rparams *params)
         return merr(EINVAL);
     }
 
+    if (params->kvs_vcachesz && !params->kvs_vcache_vmax) {
+        hse_log(HSE_ERR "kvs_vcache_vmax cannot be zero when kvs_vcachesz is set");
+        return merr(EINVAL);
+    }
+
     if (params->c1_vblock_cap > 1024) {
         hse_log(HSE_ERR "c1_vblock_cap must be less than 1024");
         return merr(EINVAL);
@@ -353,6 +384,16 @@ kvs_rparams_validate(struct kvs_rparams *params)
         return merr(EINVAL);
     }
 
+    {
+        struct merge_op mop;
+
+        if (merge_op_init(&mop, params)) {
+            hse_log(HSE_ERR "invalid setting for merge_op, valid settings are: %s",
+                MERGE_OP_PARAM_SUPPORTED);
+            return merr(EINVAL);
+        }
+    }
+
     return 0;
 }
 
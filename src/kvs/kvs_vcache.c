@@ -0,0 +1,376 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2015-2020 Micron Technology, Inc.  All rights reserved.
+ */
+
+#include <hse_util/platform.h>
+#include <hse_util/alloc.h>
+#include <hse_util/slab.h>
+#include <hse_util/atomic.h>
+#include <hse_util/spinlock.h>
+#include <hse_util/list.h>
+#include <hse_util/log2.h>
+#include <hse_util/minmax.h>
+#include <hse_util/event_counter.h>
+
+#include <hse_ikvdb/tuple.h>
+#include <hse_ikvdb/kvs_vcache.h>
+
+#define VC_SHARDS_MAX   (16)
+#define VC_BKT_PER_MEM  (256)
+
+/**
+ * struct vc_ent - a cached key and value
+ * @ve_next:   hash bucket chain linkage
+ * @ve_link:   clock ring linkage
+ * @ve_hash:   key hash
+ * @ve_expiry: value expiry time (see kvs_expired())
+ * @ve_klen:   key length
+ * @ve_vlen:   value length
+ * @ve_ref:    clock reference bit
+ * @ve_data:   key followed by value
+ */
+struct vc_ent {
+    struct vc_ent *  ve_next;
+    struct list_head ve_link;
+    u64              ve_hash;
+    u32              ve_expiry;
+    u32              ve_klen;
+    u32              ve_vlen;
+    bool             ve_ref;
+    char             ve_data[];
+};
+
+/**
+ * struct vc_shard - an independently locked partition of the cache
+ * @vs_lock:  protects all fields
+ * @vs_used:  bytes consumed by cached entries
+ * @vs_max:   memory budget of this shard
+ * @vs_hand:  clock hand, last ring position examined
+ * @vs_ring:  clock ring of all entries in the shard
+ * @vs_mask:  number of hash buckets minus one
+ * @vs_bktv:  hash buckets
+ * @vs_floorv: per-bucket floors, values read at views older than a
+ *            bucket's floor may not be inserted into it
+ */
+struct vc_shard {
+    spinlock_t       vs_lock;
+    size_t           vs_used;
+    size_t           vs_max;
+    struct list_head *vs_hand;
+    struct list_head vs_ring;
+    uint             vs_mask;
+    struct vc_ent ** vs_bktv;
+    u64 *            vs_floorv;
+} __aligned(SMP_CACHE_BYTES);
+
+/**
+ * struct kvs_vcache - a kvs value cache
+ * @vc_vmax:   largest value that may be cached
+ * @vc_shardc: number of shards in use
+ * @vc_floor:  values read at views older than this may not be inserted
+ * @vc_shardv: shards
+ */
+struct kvs_vcache {
+    u32             vc_vmax;
+    uint            vc_shardc;
+    atomic64_t      vc_floor;
+    struct vc_shard vc_shardv[VC_SHARDS_MAX];
+};
+
+static inline size_t
+vc_ent_size(const struct vc_ent *ent)
+{
+    return sizeof(*ent) + ent->ve_klen + ent->ve_vlen;
+}
+
+static void
+vc_ent_remove(struct vc_shard *vs, struct vc_ent *ent)
+{
+    struct vc_ent **pp = &vs->vs_bktv[ent->ve_hash & vs->vs_mask];
+
+    while (*pp != ent)
+        pp = &(*pp)->ve_next;
+    *pp = ent->ve_next;
+
+    if (vs->vs_hand == &ent->ve_link)
+        vs->vs_hand = ent->ve_link.prev;
+    list_del(&ent->ve_link);
+
+    vs->vs_used -= vc_ent_size(ent);
+    free(ent);
+}
+
+static struct vc_ent *
+vc_ent_find(struct vc_shard *vs, const struct kvs_ktuple *kt)
+{
+    struct vc_ent *ent;
+
+    for (ent = vs->vs_bktv[kt->kt_hash & vs->vs_mask]; ent; ent = ent->ve_next) {
+        if (ent->ve_hash == kt->kt_hash && ent->ve_klen == kt->kt_len &&
+            !memcmp(ent->ve_data, kt->kt_data, kt->kt_len))
+            return ent;
+    }
+
+    return NULL;
+}
+
+/* Advance the clock hand, giving a second chance to each referenced
+ * entry, until there is room for @sz more bytes.
+ */
+static uint
+vc_evict(struct vc_shard *vs, size_t sz)
+{
+    uint evicted = 0;
+
+    while (vs->vs_used + sz > vs->vs_max && !list_empty(&vs->vs_ring)) {
+        struct list_head *pos = vs->vs_hand->next;
+        struct vc_ent *   ent;
+
+        if (pos == &vs->vs_ring)
+            pos = pos->next;
+
+        ent = list_entry(pos, struct vc_ent, ve_link);
+        if (ent->ve_ref) {
+            ent->ve_ref = false;
+            vs->vs_hand = pos;
+            continue;
+        }
+
+        vc_ent_remove(vs, ent);
+        ++evicted;
+    }
+
+    return evicted;
+}
+
+static inline struct vc_shard *
+vc_shard(struct kvs_vcache *vc, const struct kvs_ktuple *kt)
+{
+    /* The low bits of the hash select the bucket, use the high bits
+     * to select the shard.
+     */
+    return vc->vc_shardv + ((kt->kt_hash >> 48) % vc->vc_shardc);
+}
+
+static void
+vc_floor_raise(atomic64_t *floor, u64 seq)
+{
+    u64 old = atomic64_read(floor);
+
+    while (old < seq) {
+        u64 cur = atomic64_cmpxchg(floor, old, seq);
+
+        if (cur == old)
+            break;
+        old = cur;
+    }
+}
+
+bool
+kvs_vcache_lookup(struct kvs_vcache *vc, struct kvs_ktuple *kt, struct kvs_buf *vbuf)
+{
+    struct vc_shard *vs = vc_shard(vc, kt);
+    struct vc_ent *  ent;
+
+    spin_lock(&vs->vs_lock);
+    ent = vc_ent_find(vs, kt);
+    if (!ent) {
+        spin_unlock(&vs->vs_lock);
+        return false;
+    }
+
+    if (kvs_expired(ent->ve_expiry)) {
+        vc_ent_remove(vs, ent);
+        spin_unlock(&vs->vs_lock);
+        return false;
+    }
+
+    if (vbuf->b_buf && vbuf->b_buf_sz > 0)
+        memcpy(vbuf->b_buf, ent->ve_data + ent->ve_klen, min_t(u32, ent->ve_vlen, vbuf->b_buf_sz));
+
+    vbuf->b_len = ent->ve_vlen;
+    vbuf->b_expiry = ent->ve_expiry;
+
+    if (!ent->ve_ref)
+        ent->ve_ref = true;
+    spin_unlock(&vs->vs_lock);
+
+    return true;
+}
+
+uint
+kvs_vcache_insert(struct kvs_vcache *vc, struct kvs_ktuple *kt, u64 view, struct kvs_buf *vbuf)
+{
+    struct vc_shard *vs;
+    struct vc_ent *  ent, *old;
+    uint             evicted;
+    size_t           sz;
+
+    if (!vbuf->b_buf || vbuf->b_len > vbuf->b_buf_sz || vbuf->b_len > vc->vc_vmax)
+        return 0;
+
+    if (view < atomic64_read(&vc->vc_floor))
+        return 0;
+
+    sz = sizeof(*ent) + kt->kt_len + vbuf->b_len;
+
+    ent = malloc(sz);
+    if (ev(!ent))
+        return 0;
+
+    ent->ve_next = NULL;
+    ent->ve_hash = kt->kt_hash;
+    ent->ve_expiry = vbuf->b_expiry;
+    ent->ve_klen = kt->kt_len;
+    ent->ve_vlen = vbuf->b_len;
+    ent->ve_ref = false;
+    memcpy(ent->ve_data, kt->kt_data, kt->kt_len);
+    memcpy(ent->ve_data + kt->kt_len, vbuf->b_buf, vbuf->b_len);
+
+    vs = vc_shard(vc, kt);
+
+    /* Recheck the cache-wide floor under the lock, a flush that raised
+     * it after the check above may already have emptied this shard.
+     */
+    spin_lock(&vs->vs_lock);
+    if (view < vs->vs_floorv[ent->ve_hash & vs->vs_mask] ||
+        view < atomic64_read(&vc->vc_floor)) {
+        spin_unlock(&vs->vs_lock);
+        free(ent);
+        return 0;
+    }
+
+    /* Any entry already present for the key is at least as new, as
+     * it would otherwise have been invalidated.
+     */
+    old = vc_ent_find(vs, kt);
+    if (old) {
+        spin_unlock(&vs->vs_lock);
+        free(ent);
+        return 0;
+    }
+
+    evicted = vc_evict(vs, sz);
+
+    ent->ve_next = vs->vs_bktv[ent->ve_hash & vs->vs_mask];
+    vs->vs_bktv[ent->ve_hash & vs->vs_mask] = ent;
+
+    /* Insert behind the hand so that a new entry is examined last.
+     */
+    list_add_tail(&ent->ve_link, vs->vs_hand);
+    vs->vs_used += sz;
+    spin_unlock(&vs->vs_lock);
+
+    return evicted;
+}
+
+bool
+kvs_vcache_invalidate(struct kvs_vcache *vc, const struct kvs_ktuple *kt, u64 seq)
+{
+    struct vc_shard *vs = vc_shard(vc, kt);
+    struct vc_ent *  ent;
+    u64 *            floor;
+
+    spin_lock(&vs->vs_lock);
+    ent = vc_ent_find(vs, kt);
+    if (ent)
+        vc_ent_remove(vs, ent);
+
+    floor = vs->vs_floorv + (kt->kt_hash & vs->vs_mask);
+    *floor = max_t(u64, *floor, seq + 1);
+    spin_unlock(&vs->vs_lock);
+
+    return ent;
+}
+
+void
+kvs_vcache_flush(struct kvs_vcache *vc, u64 seq)
+{
+    uint i;
+
+    vc_floor_raise(&vc->vc_floor, seq + 1);
+
+    for (i = 0; i < vc->vc_shardc; ++i) {
+        struct vc_shard *vs = vc->vc_shardv + i;
+        struct vc_ent *  ent, *next;
+
+        spin_lock(&vs->vs_lock);
+        list_for_each_entry_safe(ent, next, &vs->vs_ring, ve_link)
+            vc_ent_remove(vs, ent);
+        spin_unlock(&vs->vs_lock);
+    }
+}
+
+merr_t
+kvs_vcache_create(size_t memsz, u32 vmax, struct kvs_vcache **vcp)
+{
+    struct kvs_vcache *vc;
+    size_t             shardsz;
+    uint               nbkts, i;
+
+    *vcp = NULL;
+
+    if (ev(memsz == 0 || vmax == 0))
+        return merr(EINVAL);
+
+    vc = alloc_aligned(sizeof(*vc), __alignof(*vc), GFP_KERNEL);
+    if (ev(!vc))
+        return merr(ENOMEM);
+
+    memset(vc, 0, sizeof(*vc));
+    atomic64_set(&vc->vc_floor, 0);
+    vc->vc_vmax = vmax;
+    vc->vc_shardc = clamp_t(size_t, memsz / (1u << 20), 1, VC_SHARDS_MAX);
+
+    shardsz = memsz / vc->vc_shardc;
+    nbkts = roundup_pow_of_two(max_t(size_t, shardsz / VC_BKT_PER_MEM, 16));
+
+    for (i = 0; i < vc->vc_shardc; ++i) {
+        struct vc_shard *vs = vc->vc_shardv + i;
+
+        INIT_LIST_HEAD(&vs->vs_ring);
+
+        vs->vs_bktv = calloc(nbkts, sizeof(*vs->vs_bktv));
+        vs->vs_floorv = calloc(nbkts, sizeof(*vs->vs_floorv));
+        if (ev(!vs->vs_bktv || !vs->vs_floorv)) {
+            kvs_vcache_destroy(vc);
+            return merr(ENOMEM);
+        }
+
+        spin_lock_init(&vs->vs_lock);
+        vs->vs_hand = &vs->vs_ring;
+        vs->vs_mask = nbkts - 1;
+        vs->vs_max = shardsz;
+    }
+
+    *vcp = vc;
+
+    return 0;
+}
+
+void
+kvs_vcache_destroy(struct kvs_vcache *vc)
+{
+    uint i;
+
+    if (!vc)
+        return;
+
+    for (i = 0; i < vc->vc_shardc; ++i) {
+        struct vc_shard *vs = vc->vc_shardv + i;
+        struct vc_ent *  ent, *next;
+
+        free(vs->vs_floorv);
+
+        if (!vs->vs_bktv)
+            continue;
+
+        list_for_each_entry_safe(ent, next, &vs->vs_ring, ve_link)
+            free(ent);
+
+        free(vs->vs_bktv);
+    }
+
+    free_aligned(vc);
+}
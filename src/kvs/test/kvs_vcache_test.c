@@ -0,0 +1,227 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2015-2020 Micron Technology, Inc.  All rights reserved.
+ */
+
+#include <hse_ut/framework.h>
+#include <hse_util/hse_err.h>
+
+#include <hse_ikvdb/tuple.h>
+#include <hse_ikvdb/kvs_vcache.h>
+
+static void
+vc_key(struct kvs_ktuple *kt, char *buf, size_t bufsz, uint i)
+{
+    int n = snprintf(buf, bufsz, "key%08u", i);
+
+    kvs_ktuple_init(kt, buf, n);
+}
+
+static uint
+vc_put(struct kvs_vcache *vc, struct kvs_ktuple *kt, u64 view, const char *val, u32 expiry)
+{
+    struct kvs_buf vbuf;
+
+    kvs_buf_init(&vbuf, (void *)val, strlen(val));
+    vbuf.b_len = strlen(val);
+    vbuf.b_expiry = expiry;
+
+    return kvs_vcache_insert(vc, kt, view, &vbuf);
+}
+
+MTF_BEGIN_UTEST_COLLECTION(kvs_vcache_test)
+
+MTF_DEFINE_UTEST(kvs_vcache_test, create)
+{
+    struct kvs_vcache *vc;
+    merr_t             err;
+
+    err = kvs_vcache_create(0, 1024, &vc);
+    ASSERT_EQ(EINVAL, merr_errno(err));
+    ASSERT_EQ(NULL, vc);
+
+    err = kvs_vcache_create(1 << 20, 0, &vc);
+    ASSERT_EQ(EINVAL, merr_errno(err));
+
+    err = kvs_vcache_create(1 << 20, 1024, &vc);
+    ASSERT_EQ(0, err);
+    ASSERT_NE(NULL, vc);
+
+    kvs_vcache_destroy(vc);
+    kvs_vcache_destroy(NULL);
+}
+
+MTF_DEFINE_UTEST(kvs_vcache_test, lookup)
+{
+    struct kvs_vcache *vc;
+    struct kvs_ktuple  kt;
+    struct kvs_buf     vbuf;
+    char               kbuf[32], out[32];
+    merr_t             err;
+    bool               hit;
+
+    err = kvs_vcache_create(1 << 20, 16, &vc);
+    ASSERT_EQ(0, err);
+
+    vc_key(&kt, kbuf, sizeof(kbuf), 1);
+    kvs_buf_init(&vbuf, out, sizeof(out));
+
+    hit = kvs_vcache_lookup(vc, &kt, &vbuf);
+    ASSERT_FALSE(hit);
+
+    vc_put(vc, &kt, 1, "value1", 0);
+
+    hit = kvs_vcache_lookup(vc, &kt, &vbuf);
+    ASSERT_TRUE(hit);
+    ASSERT_EQ(6, vbuf.b_len);
+    ASSERT_EQ(0, memcmp(out, "value1", 6));
+
+    /* A short buffer gets a partial copy and the full length. */
+    memset(out, 0, sizeof(out));
+    kvs_buf_init(&vbuf, out, 3);
+    hit = kvs_vcache_lookup(vc, &kt, &vbuf);
+    ASSERT_TRUE(hit);
+    ASSERT_EQ(6, vbuf.b_len);
+    ASSERT_EQ(0, memcmp(out, "val\0", 4));
+
+    /* An entry already present is kept. */
+    kvs_buf_init(&vbuf, out, sizeof(out));
+    vc_put(vc, &kt, 2, "value2", 0);
+    hit = kvs_vcache_lookup(vc, &kt, &vbuf);
+    ASSERT_TRUE(hit);
+    ASSERT_EQ(0, memcmp(out, "value1", 6));
+
+    /* Expired values are not returned. */
+    kvs_vcache_invalidate(vc, &kt, 2);
+    vc_put(vc, &kt, 3, "value3", 1);
+    hit = kvs_vcache_lookup(vc, &kt, &vbuf);
+    ASSERT_FALSE(hit);
+
+    /* Values longer than vmax are not cached. */
+    vc_put(vc, &kt, 4, "a value longer than vmax", 0);
+    hit = kvs_vcache_lookup(vc, &kt, &vbuf);
+    ASSERT_FALSE(hit);
+
+    kvs_vcache_destroy(vc);
+}
+
+MTF_DEFINE_UTEST(kvs_vcache_test, evict)
+{
+    struct kvs_vcache *vc;
+    struct kvs_ktuple  kt;
+    struct kvs_buf     vbuf;
+    char               kbuf[32], out[32];
+    uint               i, evicted, hits;
+    merr_t             err;
+
+    err = kvs_vcache_create(64 * 1024, 32, &vc);
+    ASSERT_EQ(0, err);
+
+    kvs_buf_init(&vbuf, out, sizeof(out));
+
+    /* Keep referencing key 0 so that the clock spares it. */
+    evicted = 0;
+    for (i = 0; i < 8192; ++i) {
+        vc_key(&kt, kbuf, sizeof(kbuf), i);
+        evicted += vc_put(vc, &kt, 1, "0123456789abcdef", 0);
+
+        vc_key(&kt, kbuf, sizeof(kbuf), 0);
+        kvs_vcache_lookup(vc, &kt, &vbuf);
+    }
+
+    ASSERT_GT(evicted, 0);
+
+    vc_key(&kt, kbuf, sizeof(kbuf), 0);
+    ASSERT_TRUE(kvs_vcache_lookup(vc, &kt, &vbuf));
+
+    hits = 0;
+    for (i = 1; i < 8192; ++i) {
+        vc_key(&kt, kbuf, sizeof(kbuf), i);
+        hits += kvs_vcache_lookup(vc, &kt, &vbuf);
+    }
+
+    ASSERT_GT(hits, 0);
+    ASSERT_LT(hits + evicted, 8192 + 1);
+
+    kvs_vcache_destroy(vc);
+}
+
+MTF_DEFINE_UTEST(kvs_vcache_test, invalidate)
+{
+    struct kvs_vcache *vc;
+    struct kvs_ktuple  kt, kt2;
+    struct kvs_buf     vbuf;
+    char               kbuf[32], kbuf2[32], out[32];
+    merr_t             err;
+    bool               found;
+
+    err = kvs_vcache_create(1 << 20, 16, &vc);
+    ASSERT_EQ(0, err);
+
+    vc_key(&kt, kbuf, sizeof(kbuf), 1);
+    vc_key(&kt2, kbuf2, sizeof(kbuf2), 2);
+    kvs_buf_init(&vbuf, out, sizeof(out));
+
+    vc_put(vc, &kt, 10, "value1", 0);
+    vc_put(vc, &kt2, 10, "value2", 0);
+
+    found = kvs_vcache_invalidate(vc, &kt, 20);
+    ASSERT_TRUE(found);
+    ASSERT_FALSE(kvs_vcache_lookup(vc, &kt, &vbuf));
+    ASSERT_TRUE(kvs_vcache_lookup(vc, &kt2, &vbuf));
+
+    found = kvs_vcache_invalidate(vc, &kt, 20);
+    ASSERT_FALSE(found);
+
+    /* A value read at a view that predates the write is refused. */
+    vc_put(vc, &kt, 15, "value1", 0);
+    ASSERT_FALSE(kvs_vcache_lookup(vc, &kt, &vbuf));
+
+    vc_put(vc, &kt, 20, "value1", 0);
+    ASSERT_FALSE(kvs_vcache_lookup(vc, &kt, &vbuf));
+
+    vc_put(vc, &kt, 21, "value3", 0);
+    ASSERT_TRUE(kvs_vcache_lookup(vc, &kt, &vbuf));
+    ASSERT_EQ(0, memcmp(out, "value3", 6));
+
+    kvs_vcache_destroy(vc);
+}
+
+MTF_DEFINE_UTEST(kvs_vcache_test, flush)
+{
+    struct kvs_vcache *vc;
+    struct kvs_ktuple  kt;
+    struct kvs_buf     vbuf;
+    char               kbuf[32], out[32];
+    merr_t             err;
+    uint               i;
+
+    err = kvs_vcache_create(1 << 20, 16, &vc);
+    ASSERT_EQ(0, err);
+
+    kvs_buf_init(&vbuf, out, sizeof(out));
+
+    for (i = 0; i < 100; ++i) {
+        vc_key(&kt, kbuf, sizeof(kbuf), i);
+        vc_put(vc, &kt, 10, "value", 0);
+    }
+
+    kvs_vcache_flush(vc, 30);
+
+    for (i = 0; i < 100; ++i) {
+        vc_key(&kt, kbuf, sizeof(kbuf), i);
+        ASSERT_FALSE(kvs_vcache_lookup(vc, &kt, &vbuf));
+    }
+
+    /* The flush floor applies to every key. */
+    vc_key(&kt, kbuf, sizeof(kbuf), 200);
+    vc_put(vc, &kt, 30, "value", 0);
+    ASSERT_FALSE(kvs_vcache_lookup(vc, &kt, &vbuf));
+
+    vc_put(vc, &kt, 31, "value", 0);
+    ASSERT_TRUE(kvs_vcache_lookup(vc, &kt, &vbuf));
+
+    kvs_vcache_destroy(vc);
+}
+
+MTF_END_UTEST_COLLECTION(kvs_vcache_test)
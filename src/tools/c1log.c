@@ -387,13 +387,14 @@ c1_log_print_vtuple(struct c1 *c1, u64 n, char *vtomf, struct c1_vtuple_meta *vt
 
     printf(
         "   value[%ld] sign 0x%lx seqno 0x%lx vlen %ld "
-        "tomb 0x%x type 0x%x\n",
+        "tomb 0x%x type 0x%x expiry %u\n",
         (unsigned long)n,
         (unsigned long)vtm->c1vm_sign,
         (unsigned long)vtm->c1vm_seqno,
         (unsigned long)c1_vtuple_meta_vlen(vtm),
         (unsigned int)vtm->c1vm_tomb,
-        (unsigned int)vtm->c1vm_logtype);
+        (unsigned int)vtm->c1vm_logtype,
+        (unsigned int)vtm->c1vm_expiry);
 
     if (!dump_value)
         return 0;
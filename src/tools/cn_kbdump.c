@@ -207,6 +207,13 @@ print_kblk(struct blk *blk)
         omf_kbh_blm_hlen(p),
         omf_kbh_blm_doff_pg(p),
         omf_kbh_blm_dlen_pg(p));
+    if (omf_kbh_version(p) > KBLOCK_HDR_VERSION7)
+        printf(
+            "    pbm: hdr %d %d  data_pg %d %d\n",
+            omf_kbh_pbm_hoff(p),
+            omf_kbh_pbm_hlen(p),
+            omf_kbh_pbm_doff_pg(p),
+            omf_kbh_pbm_dlen_pg(p));
     printf("    kmd: start_pg %u\n", omf_kbh_wbt_doff_pg(p) + omf_wbt_root(wbt_hdr) + 1);
     printf(
         "    keymin: off %u len %u key %s\n",
@@ -270,6 +277,22 @@ print_blm(struct blk *blk)
 
     hdr = off2addr(blk->buf, omf_kbh_blm_hoff(kblk));
 
+    /* A fuse filter has no buckets to report on. */
+    if (omf_bh_version(hdr) == BLOOM_OMF_VERSION6) {
+        printf(
+            "    blmhdr: magic 0x%08x  ver %u (fuse)"
+            "  fpbits %u  seed 0x%08x%08x  seglen %u  bitmapsz %u  segcntlen %u\n",
+            omf_bh_magic(hdr),
+            omf_bh_version(hdr),
+            omf_bh_fpbits(hdr),
+            omf_bh_seed_hi(hdr),
+            omf_bh_seed_lo(hdr),
+            1u << omf_bh_bktshift(hdr),
+            omf_bh_bitmapsz(hdr),
+            omf_bh_modulus(hdr));
+        return;
+    }
+
     bktsz = (1u << omf_bh_bktshift(hdr)) >> BYTE_SHIFT;
     if (bh_bktsz > 0)
         bktsz = bh_bktsz;
@@ -445,6 +468,10 @@ val_get_next(void *kmd, size_t *off, struct kmd_vref *vref)
             kmd_ival(kmd, off, &vdata, &vlen);
             snprintf(vref->vinfo, sizeof(vref->vinfo), "type=iv %u", vlen);
             break;
+        case vtype_mop:
+            kmd_ival(kmd, off, &vdata, &vlen);
+            snprintf(vref->vinfo, sizeof(vref->vinfo), "type=mop %u", vlen);
+            break;
         case vtype_zval:
             strlcpy(vref->vinfo, "type=zv", sizeof(vref->vinfo));
             break;
@@ -494,12 +521,13 @@ print_wbt_node(void *h, uint version, void *kmd, int pgno, int root)
 
     printf(
         "w: pg %d  magic 0x%04x nkeys %u kmdoff %u pfx_len %u "
-        "pfx %s # type %c\n",
+        "hidx %u pfx %s # type %c\n",
         pgno,
         omf_wbn_magic(h),
         omf_wbn_num_keys(h),
         omf_wbn_kmd(h),
         pfx_len,
+        version < WBT_TREE_VERSION7 ? 0 : omf_wbn_hidx_nbkts(h),
         fmt_data(pfx, pfx_len, opt.klen),
         fmt_wtype(omf_wbn_magic(h), pgno == root));
 
@@ -663,6 +691,7 @@ void
 print_wbt(void *wbt_hdr, void *kblk, bool ptomb)
 {
     switch (wbt_hdr_version(wbt_hdr)) {
+        case WBT_TREE_VERSION7:
         case WBT_TREE_VERSION6:
         case WBT_TREE_VERSION5:
         case WBT_TREE_VERSION4:
@@ -259,6 +259,13 @@ atomic64_sub(long i, atomic64_t *v)
     (void)__atomic_fetch_sub(&v->counter, i, __ATOMIC_RELAXED);
 }
 
+/* Atomically sets in @v the bits that are set in @i. */
+static inline void
+atomic64_or(long i, atomic64_t *v)
+{
+    (void)__atomic_fetch_or(&v->counter, i, __ATOMIC_RELAXED);
+}
+
 /* Atomically increments @v by 1. */
 static inline void
 atomic64_inc(atomic64_t *v)
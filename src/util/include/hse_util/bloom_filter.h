@@ -11,6 +11,7 @@
 #include <hse_util/compiler.h>
 #include <hse_util/inttypes.h>
 #include <hse_util/bitmap.h>
+#include <hse_util/byteorder.h>
 
 /* [HSE_REVISIT] This block bloom implementation is less of an abstraction
  * than it is a loose collection of parts from which a client may construct
@@ -34,6 +35,23 @@ _Static_assert(BF_BKTSHIFT >= 9 && BF_BKTSHIFT <= 15, "BF_BKTSHIFT is too large
 
 _Static_assert(BF_ROTL >= 1 && BF_ROTL <= 63, "BF_ROTL is too large or too small");
 
+/* A split block bloom divides the bitmap into 256-bit buckets of eight
+ * 32-bit words, and sets exactly one bit in each word of the bucket for
+ * each element.  All probes for a key therefore land in one cache line
+ * and are independent of each other, such that a lookup can test all of
+ * them at once in a single 256-bit vector register.
+ *
+ * The bucket is chosen from the upper half of a remixed hash by a
+ * multiply-shift range reduction (the modulus is the number of buckets),
+ * and the bit within each word from the lower half multiplied by a per
+ * word odd salt.  The remix is required because the cN tree routes keys
+ * on the low-order bits of the very same hash.
+ */
+#define BF_SB_BKTSHIFT (8)
+#define BF_SB_WORDS (1u << (BF_SB_BKTSHIFT - 5))
+
+_Static_assert(BF_SB_WORDS == 8, "BF_SB_WORDS must fill one 256-bit vector");
+
 struct bf_bithash_desc {
     u32 bhd_bits_per_elt;
     u32 bhd_num_hashes;
@@ -47,6 +65,7 @@ struct bloom_filter {
     u32 bf_bktshift;
     u32 bf_bktmask;
     u32 bf_rotl;
+    bool bf_sb;
 };
 
 struct bloom_filter_stats {
@@ -158,6 +177,87 @@ bf_populate(const struct bloom_filter *bf, u64 hash)
         hse_bitmap_set32(bitmap, bf_hash2bit(&hash, rotl, mask));
 }
 
+extern const u32 bf_sb_saltv[BF_SB_WORDS];
+
+static __always_inline u64
+bf_sb_remix(u64 hash)
+{
+    return (hash ^ (hash >> 33)) * 0xff51afd7ed558ccdul;
+}
+
+/**
+ * bf_sb_hash2bkt() - determine byte offset of split block bucket for %hash
+ * @hash:       hash used to select the bucket
+ * @nbkts:      number of buckets in the bitmap
+ */
+static __always_inline size_t
+bf_sb_hash2bkt(u64 hash, u32 nbkts)
+{
+    size_t bkt = ((bf_sb_remix(hash) >> 32) * nbkts) >> 32;
+
+    return bkt << (BF_SB_BKTSHIFT - BYTE_SHIFT);
+}
+
+/**
+ * bf_sb_hash2bit() - determine bit offset of %hash within the nth bucket word
+ * @hash:       hash used to select the bucket
+ * @nth:        bucket word index
+ */
+static __always_inline u32
+bf_sb_hash2bit(u64 hash, u32 nth)
+{
+    return ((u32)bf_sb_remix(hash) * bf_sb_saltv[nth]) >> 27;
+}
+
+/**
+ * bf_sb_lookup_portable() - check to see if hash is in a split block bucket
+ * @hash:       hash used to select the bucket
+ * @bitmap:     base byte address of the bucket
+ *
+ * Use bf_sb_lookup() unless the scalar implementation is specifically
+ * required, it dispatches to a vector implementation if available.
+ */
+static __always_inline bool
+bf_sb_lookup_portable(u64 hash, const u8 *bitmap)
+{
+    const u32 *wordv = (const u32 *)bitmap;
+    u32        i;
+
+    for (i = 0; i < BF_SB_WORDS; ++i)
+        if (!(le32_to_cpu(wordv[i]) & (1u << bf_sb_hash2bit(hash, i))))
+            return false;
+
+    return true;
+}
+
+/**
+ * bf_sb_lookup() - check to see if hash is in a split block bucket
+ * @hash:       hash used to select the bucket
+ * @bitmap:     base byte address of the bucket (from bf_sb_hash2bkt())
+ *
+ * Return:
+ *     Returns %true if all bucket words have their bit set,
+ *     otherwise returns %false.
+ */
+bool
+bf_sb_lookup(u64 hash, const u8 *bitmap);
+
+/**
+ * bf_sb_populate() - populate a split block bucket with given %hash
+ * @hash:       hash used to select the bucket
+ */
+static __always_inline void
+bf_sb_populate(const struct bloom_filter *bf, u64 hash)
+{
+    u32 *wordv;
+    u32  i;
+
+    wordv = (u32 *)(bf->bf_bitmap + bf_sb_hash2bkt(hash, bf->bf_modulus));
+
+    for (i = 0; i < BF_SB_WORDS; ++i)
+        wordv[i] |= cpu_to_le32(1u << bf_sb_hash2bit(hash, i));
+}
+
 struct bf_bithash_desc
 bf_compute_bithash_est(u32 probability);
 
@@ -175,6 +275,20 @@ bf_filter_init(
     u8 *                   storage,
     size_t                 storage_sz);
 
+/**
+ * bf_filter_init_sb() - initialize a split block bloom filter
+ *
+ * Same as bf_filter_init(), but the number of hashes is fixed at one
+ * per bucket word and @desc is used only for the sizing estimate.
+ */
+void
+bf_filter_init_sb(
+    struct bloom_filter *  filter,
+    struct bf_bithash_desc desc,
+    u32                    exp_elmts,
+    u8 *                   storage,
+    size_t                 storage_sz);
+
 void
 bf_filter_insert_by_hash(struct bloom_filter *filter, u64 hash);
 
@@ -48,10 +48,19 @@ enum bonsai_ior_code {
  * struct bonsai_skey - input key argument
  * @key:
  * @key_imm:
+ * @bsk_pfx:     interned copy of the first @bsk_pfx_len bytes of the key
+ * @bsk_pfx_len: length of @bsk_pfx, zero if the key is not to be split
+ *
+ * If @bsk_pfx_len is non-zero then a kv created for this key stores a
+ * pointer to @bsk_pfx followed by only the remainder of the key (see
+ * bn_kv_kobj()).  The caller must keep @bsk_pfx alive for the life of
+ * the tree.
  */
 struct bonsai_skey {
     const void *         bsk_key;
     struct key_immediate bsk_key_imm;
+    const void *         bsk_pfx;
+    uint                 bsk_pfx_len;
 };
 
 /**
@@ -61,6 +70,7 @@ struct bonsai_skey {
  * @bv_seqnoref:  sequence number reference
  * @bv_priv:      client's private value
  * @bv_flags:     flags, used by the client
+ * @bv_expiry:    expiry time, used by the client
  * @bv_xlen:      opaque encoded value length
  * @bv_valuep:    ptr to value
  * @bv_value:     value data
@@ -78,6 +88,7 @@ struct bonsai_val {
     uintptr_t          bv_seqnoref;
     atomic64_t         bv_priv;
     unsigned int       bv_flags;
+    u32                bv_expiry;
     u64                bv_xlen;
     void              *bv_valuep;
     char               bv_value[];
@@ -94,7 +105,7 @@ struct bonsai_val {
 static __always_inline uint
 bonsai_val_ulen(const struct bonsai_val *bv)
 {
-    return bv->bv_xlen & 0xfffffffful;
+    return bv->bv_xlen & 0x7ffffffful; /* see HSE_XLEN_MOP */
 }
 
 /**
@@ -130,15 +141,21 @@ bonsai_val_vlen(const struct bonsai_val *bv)
  * @bsv_val:      pointer to value data
  * @bsv_xlen:     opaque encoded value length
  * @bsv_seqnoref: sequence number reference
+ * @bsv_expiry:   expiry time, used by the client
+ * @bsv_prep_kv:  kv built by bn_kv_prep(), or NULL
+ * @bsv_prep_val: value built by bn_kv_prep(), or NULL
  *
  * Note that the value length (@bsv_xlen) is an opaque encoding of compressed
  * and uncompressed value lengths so one must use the bonsai_sval_vlen()
  * function decode it.
  */
 struct bonsai_sval {
-    void     *bsv_val;
-    u64       bsv_xlen;
-    uintptr_t bsv_seqnoref;
+    void              *bsv_val;
+    u64                bsv_xlen;
+    uintptr_t          bsv_seqnoref;
+    u32                bsv_expiry;
+    struct bonsai_kv  *bsv_prep_kv;
+    struct bonsai_val *bsv_prep_val;
 };
 
 /**
@@ -152,7 +169,7 @@ static __always_inline uint
 bonsai_sval_vlen(const struct bonsai_sval *bsv)
 {
     uint clen = bsv->bsv_xlen >> 32;
-    uint vlen = bsv->bsv_xlen & 0xfffffffful;
+    uint vlen = bsv->bsv_xlen & 0x7ffffffful; /* see HSE_XLEN_MOP */
 
     return clen ?: vlen;
 }
@@ -164,6 +181,7 @@ bonsai_sval_vlen(const struct bonsai_sval *bsv)
  * struct bonsai_kv - bonsai tree key/value node
  * @bkv_key_imm:
  * @bkv_flags:
+ * @bkv_pfx_len:
  * @bkv_refcnt:
  * @bkv_values:
  * @bkv_prev:
@@ -175,10 +193,16 @@ bonsai_sval_vlen(const struct bonsai_sval *bsv)
  * @bkv_key:
  *
  * A bonsai_kv includes the key and a list of bonsai_val objects.
+ *
+ * If @bkv_pfx_len is zero then @bkv_key holds the entire key.  Otherwise
+ * it holds a pointer to an interned prefix of @bkv_pfx_len bytes followed
+ * by the rest of the key, and readers must go through bn_kv_kobj(),
+ * bn_kv_key() or the bn_kv_*cmp() functions rather than @bkv_key.
  */
 struct bonsai_kv {
     struct key_immediate   bkv_key_imm;
     u16                    bkv_flags;
+    u16                    bkv_pfx_len;
     struct bonsai_val *    bkv_values;
     struct bonsai_kv *     bkv_prev;
     struct bonsai_kv *     bkv_next;
@@ -260,10 +284,13 @@ struct bonsai_client {
     struct bonsai_node *bc_slab_end;
 };
 
+struct bonsai_index;
+
 /**
  * struct bonsai_root - bonsai tree parameters
  * @br_root:      pointer to the root of bonsai_tree
  * @br_bounds:    indicates bounds are established and lcp
+ * @br_index:     wide-node search index of a finalized tree (may be NULL)
  * @br_client:    bonsai client instance
  * @br_stack:     used by bn_ior_impl() to eliminate recursion
  * @br_kv:        a circular k/v list, next=head, prev=tail
@@ -273,6 +300,7 @@ struct bonsai_client {
 struct bonsai_root {
     struct bonsai_node  *br_root;
     atomic_t             br_bounds;
+    struct bonsai_index *br_index;
     struct bonsai_client br_client;
     uintptr_t            br_stack[40];
     struct bonsai_kv     br_kv;
@@ -409,6 +437,23 @@ bn_find_pfx_GT(struct bonsai_root *tree, const struct bonsai_skey *skey, struct
 bool
 bn_findLE(struct bonsai_root *tree, const struct bonsai_skey *skey, struct bonsai_kv **kv);
 
+/**
+ * bn_split_keys() - Find keys that divide the tree into parts of similar size
+ * @tree:  bonsai tree instance
+ * @depth: number of levels to visit, from the root down
+ * @kvv:   (output) vector of at least (1 << @depth) - 1 kvs
+ *
+ * Visits the nodes in the top @depth levels of the tree in order.  Since
+ * the tree is balanced their keys split it into as many as 1 << @depth
+ * ranges of roughly equal population.
+ *
+ * - Caller must hold rcu_read_lock() across this call and while looking at kvv.
+ *
+ * Return: number of kvs stored in @kvv, in ascending key order
+ */
+uint
+bn_split_keys(struct bonsai_root *tree, uint depth, struct bonsai_kv **kvv);
+
 /**
  * bn_traverse() - In-order tree traversal for debugging purposes.
  * @tree: bonsai tree instance
@@ -434,6 +479,25 @@ bn_traverse(struct bonsai_root *tree);
 void
 bn_finalize(struct bonsai_root *tree);
 
+/**
+ * bn_index_build() - build a wide-node search index for a finalized tree
+ * @tree: bonsai tree instance
+ *
+ * Builds a static B+-tree over the ordered kv list of the given finalized
+ * tree, whose nodes each pack eight 8-byte key words into a cache line so
+ * that a lookup visits one line per level rather than one per binary tree
+ * level.  Once published, bn_find(), bn_findGE() and bn_findLE() search
+ * the index rather than the tree.  The index is freed by bn_reset().
+ *
+ * This function must only be called on a bonsai tree in the quiescent
+ * state for which no further updates will occur.  It may be called
+ * concurrently with readers.
+ *
+ * Return: 0 upon success (or if the tree is empty), error code otherwise
+ */
+merr_t
+bn_index_build(struct bonsai_root *tree);
+
 /**
  * Accessor functions for bonsai client specific fields
  */
@@ -450,6 +514,24 @@ bn_skey_init(const void *key, s32 klen, u16 index, struct bonsai_skey *skey)
 {
     skey->bsk_key = key;
     key_immediate_init(key, klen, index, &skey->bsk_key_imm);
+    skey->bsk_pfx = NULL;
+    skey->bsk_pfx_len = 0;
+}
+
+/**
+ * bn_skey_pfx() - store the key split around an interned prefix
+ * @skey:    key initialized by bn_skey_init()
+ * @pfx:     copy of the first @pfx_len bytes of the key
+ * @pfx_len: prefix length, less than the key length
+ */
+static inline void
+bn_skey_pfx(struct bonsai_skey *skey, const void *pfx, uint pfx_len)
+{
+    assert(pfx_len < key_imm_klen(&skey->bsk_key_imm));
+    assert(!memcmp(pfx, skey->bsk_key, pfx_len));
+
+    skey->bsk_pfx = pfx;
+    skey->bsk_pfx_len = pfx_len;
 }
 
 /**
@@ -465,6 +547,182 @@ bn_sval_init(void *val, u64 xlen, uintptr_t seqnoref, struct bonsai_sval *sval)
     sval->bsv_val = val;
     sval->bsv_xlen = xlen;
     sval->bsv_seqnoref = seqnoref;
+    sval->bsv_expiry = 0;
+    sval->bsv_prep_kv = NULL;
+    sval->bsv_prep_val = NULL;
+}
+
+/**
+ * bn_kv_prep_sz() - size of the memory required by bn_kv_prep()
+ * @skey: key
+ * @sval: value
+ */
+size_t
+bn_kv_prep_sz(const struct bonsai_skey *skey, const struct bonsai_sval *sval);
+
+/**
+ * bn_kv_prep() - build a kv and its value ahead of bn_insert_or_replace()
+ * @skey: key
+ * @sval: value, updated to refer to the prepared kv and value
+ * @mem:  bn_kv_prep_sz() bytes of pointer aligned memory
+ *
+ * bn_kv_prep() lets the caller copy the key and value outside of whatever
+ * serializes updates to the tree.  bn_insert_or_replace() then links in the
+ * prepared kv if the key is new, otherwise only the prepared value, in which
+ * case bn_kv_prep_used() returns %false and the bytes of @mem beyond
+ * bn_kv_prep_kvoff() may be reused.
+ */
+void
+bn_kv_prep(const struct bonsai_skey *skey, struct bonsai_sval *sval, void *mem);
+
+/**
+ * bn_kv_prep_kvoff() - offset of the prepared kv within bn_kv_prep() memory
+ * @sval: value prepared by bn_kv_prep()
+ */
+static inline size_t
+bn_kv_prep_kvoff(const struct bonsai_sval *sval)
+{
+    return (void *)sval->bsv_prep_kv - (void *)sval->bsv_prep_val;
+}
+
+/**
+ * bn_kv_prep_used() - did bn_insert_or_replace() link in the prepared kv
+ * @sval: value prepared by bn_kv_prep()
+ */
+static inline bool
+bn_kv_prep_used(const struct bonsai_sval *sval)
+{
+    return sval->bsv_prep_kv->bkv_next != NULL;
+}
+
+/**
+ * bn_kv_pfx() - return the interned prefix of a kv's key
+ * @kv: bonsai kv
+ *
+ * Return: the prefix, or NULL if @kv->bkv_key holds the entire key
+ */
+static inline const void *
+bn_kv_pfx(const struct bonsai_kv *kv)
+{
+    const void *pfx;
+
+    if (!kv->bkv_pfx_len)
+        return NULL;
+
+    memcpy(&pfx, kv->bkv_key, sizeof(pfx));
+
+    return pfx;
+}
+
+/**
+ * bn_kv_sfx() - return the part of a kv's key that follows its prefix
+ * @kv: bonsai kv
+ */
+static inline const void *
+bn_kv_sfx(const struct bonsai_kv *kv)
+{
+    return kv->bkv_pfx_len ? kv->bkv_key + sizeof(void *) : kv->bkv_key;
+}
+
+/**
+ * bn_kv_kobj() - describe a kv's key as a key object
+ * @kv:   bonsai kv
+ * @kobj: (output) key object
+ */
+static inline struct key_obj *
+bn_kv_kobj(const struct bonsai_kv *kv, struct key_obj *kobj)
+{
+    kobj->ko_pfx = bn_kv_pfx(kv);
+    kobj->ko_pfx_len = kv->bkv_pfx_len;
+    kobj->ko_sfx = bn_kv_sfx(kv);
+    kobj->ko_sfx_len = key_imm_klen(&kv->bkv_key_imm) - kv->bkv_pfx_len;
+
+    return kobj;
+}
+
+/**
+ * bn_kv_key() - return a kv's key as a contiguous byte string
+ * @kv:  bonsai kv
+ * @buf: buffer of at least key_imm_klen(&kv->bkv_key_imm) bytes
+ *
+ * Return: @kv->bkv_key if it holds the entire key, otherwise @buf
+ * filled in with a copy of the key
+ */
+static inline const void *
+bn_kv_key(const struct bonsai_kv *kv, void *buf)
+{
+    struct key_obj ko;
+
+    if (!kv->bkv_pfx_len)
+        return kv->bkv_key;
+
+    return key_obj_copy(buf, key_imm_klen(&kv->bkv_key_imm), NULL, bn_kv_kobj(kv, &ko));
+}
+
+/**
+ * bn_kv_inner_cmp() - compare a key with a kv's key from a given offset
+ * @key:  key data
+ * @klen: key length, at least @off
+ * @kv:   bonsai kv whose key is at least @off bytes long
+ * @off:  number of leading bytes known to be equal
+ *
+ * Return: as key_inner_cmp(@key + @off, ..., kv key + @off, ...)
+ */
+static inline int
+bn_kv_inner_cmp(const void *key, int klen, const struct bonsai_kv *kv, int off)
+{
+    int kvlen = key_imm_klen(&kv->bkv_key_imm);
+    int plen = kv->bkv_pfx_len;
+    int rc;
+
+    if (!plen)
+        return key_inner_cmp(key + off, klen - off, kv->bkv_key + off, kvlen - off);
+
+    if (off < plen) {
+        rc = memcmp(key + off, bn_kv_pfx(kv) + off, min(klen, plen) - off);
+        if (rc || klen <= plen)
+            return rc ?: klen - kvlen;
+
+        off = plen;
+    }
+
+    return key_inner_cmp(key + off, klen - off, bn_kv_sfx(kv) + off - plen, kvlen - off);
+}
+
+/**
+ * bn_kv_key_cmp() - compare a key with a kv's key
+ * @ki:  key immediate of @key
+ * @key: key data
+ * @kv:  bonsai kv
+ *
+ * Return: as key_full_cmp()
+ */
+static inline s32
+bn_kv_key_cmp(const struct key_immediate *ki, const void *key, const struct bonsai_kv *kv)
+{
+    s32 rc;
+
+    rc = key_immediate_cmp(ki, &kv->bkv_key_imm);
+
+    if (rc == S32_MIN)
+        rc = bn_kv_inner_cmp(key, key_imm_klen(ki), kv, KI_DLEN_MAX);
+
+    return rc;
+}
+
+/* Compare the first (at most) @len bytes of the keys of two kvs.
+ */
+static inline int
+bn_kv_ncmp(const struct bonsai_kv *l, const struct bonsai_kv *r, uint len)
+{
+    struct key_obj lko, rko;
+
+    if (!(l->bkv_pfx_len | r->bkv_pfx_len))
+        return key_inner_cmp(
+            l->bkv_key, min_t(uint, len, key_imm_klen(&l->bkv_key_imm)),
+            r->bkv_key, min_t(uint, len, key_imm_klen(&r->bkv_key_imm)));
+
+    return key_obj_ncmp(bn_kv_kobj(l, &lko), bn_kv_kobj(r, &rko), len);
 }
 
 static inline s32
@@ -472,8 +730,18 @@ bn_kv_cmp(const void *lhs, const void *rhs)
 {
     const struct bonsai_kv *l = lhs;
     const struct bonsai_kv *r = rhs;
+    struct key_obj          lko, rko;
+    s32                     rc;
+
+    if (!(l->bkv_pfx_len | r->bkv_pfx_len))
+        return key_full_cmp(&l->bkv_key_imm, l->bkv_key, &r->bkv_key_imm, r->bkv_key);
+
+    rc = key_immediate_cmp(&l->bkv_key_imm, &r->bkv_key_imm);
+
+    if (rc == S32_MIN)
+        rc = key_obj_cmp(bn_kv_kobj(l, &lko), bn_kv_kobj(r, &rko));
 
-    return key_full_cmp(&l->bkv_key_imm, l->bkv_key, &r->bkv_key_imm, r->bkv_key);
+    return rc;
 }
 
 /*
@@ -494,9 +762,7 @@ bn_kv_cmp_rev(const void *lhs, const void *rhs)
     const struct bonsai_kv *l = lhs;
     const struct bonsai_kv *r = rhs;
 
-    const void *r_key = r->bkv_key;
     int         r_klen = key_imm_klen(&r->bkv_key_imm);
-    const void *l_key = l->bkv_key;
     int         l_klen = key_imm_klen(&l->bkv_key_imm);
     bool        l_ptomb = !!(l->bkv_flags & BKV_FLAG_PTOMB);
     bool        r_ptomb = !!(r->bkv_flags & BKV_FLAG_PTOMB);
@@ -509,20 +775,20 @@ bn_kv_cmp_rev(const void *lhs, const void *rhs)
         return rc;
 
     if (!(l_ptomb ^ r_ptomb))
-        return key_inner_cmp(r_key, r_klen, l_key, l_klen);
+        return bn_kv_ncmp(r, l, UINT_MAX);
 
     /* exactly one of lhs and rhs is a ptomb */
     if (l_ptomb && l_klen <= r_klen) {
-        rc = key_inner_cmp(r_key, l_klen, l_key, l_klen);
+        rc = bn_kv_ncmp(r, l, l_klen);
         if (rc == 0)
             return -1; /* l wins */
     } else if (r_ptomb && r_klen <= l_klen) {
-        rc = key_inner_cmp(r_key, r_klen, l_key, r_klen);
+        rc = bn_kv_ncmp(r, l, r_klen);
         if (rc == 0)
             return 1; /* r wins */
     }
 
-    return key_inner_cmp(r_key, r_klen, l_key, l_klen);
+    return bn_kv_ncmp(r, l, UINT_MAX);
 }
 
 static inline void
@@ -25,6 +25,20 @@
 #define CHEAP_POISON_SZ (SMP_CACHE_BYTES * 2)
 #endif
 
+/**
+ * enum cheap_huge - huge page backing for a cheap
+ * @CHEAP_HUGE_NONE:  base pages only
+ * @CHEAP_HUGE_THP:   2MB aligned and advised for transparent huge pages
+ * @CHEAP_HUGE_2M:    2MB hugetlb pages, else as per CHEAP_HUGE_THP
+ * @CHEAP_HUGE_1G:    1GB hugetlb pages, else as per CHEAP_HUGE_2M
+ */
+enum cheap_huge {
+    CHEAP_HUGE_NONE,
+    CHEAP_HUGE_THP,
+    CHEAP_HUGE_2M,
+    CHEAP_HUGE_1G,
+};
+
 /* Everything in this structure is opaque to callers (but not really,
  * because the cheap unit tests need access to the implementation).
  */
@@ -36,6 +50,8 @@ struct cheap {
     u64       base;
     u64       brk;
     void *    mem;
+    size_t    memsz;
+    uint      huge;
     uintptr_t magic;
 };
 
@@ -49,6 +65,31 @@ struct cheap {
 struct cheap *
 cheap_create(size_t alignment, size_t size);
 
+/**
+ * cheap_create_huge() - Create a cursor heap backed by huge pages
+ * @alignment:  Alignment for cheap_alloc() (must be a power of 2 from 0 to 64)
+ * @size:       Maximum size of the heap (in bytes)
+ * @huge:       Largest acceptable backing (enum cheap_huge)
+ *
+ * Falls back to successively smaller page sizes when hugetlb pages of
+ * the requested size are not available.  Note that hugetlb pages are
+ * reserved for the whole heap when it is created, and cannot be
+ * released by cheap_trim().
+ *
+ * Return: Returns a ptr to a struct cheap if successful, otherwise NULL.
+ */
+struct cheap *
+cheap_create_huge(size_t alignment, size_t size, uint huge);
+
+/**
+ * cheap_huge_stats() - report huge page coverage of all cheaps
+ * @mapped:     bytes mapped by all live cheaps
+ * @hugetlb:    bytes of %mapped backed by hugetlb pages
+ * @thp:        bytes of %mapped advised for transparent huge pages
+ */
+void
+cheap_huge_stats(size_t *mapped, size_t *hugetlb, size_t *thp);
+
 /**
  * cheap_destroy() - destroy a cheap
  * @h:  the cheap to destroy
@@ -79,6 +120,20 @@ cheap_reset(struct cheap *h, size_t base_offset);
 void
 cheap_trim(struct cheap *h, size_t rss);
 
+/**
+ * cheap_bind() - set the preferred NUMA node for a cheap
+ * @h:          the cheap to bind
+ * @node:       preferred NUMA node (or -1 for the local node)
+ *
+ * Future page faults in the cheap are satisfied from %node whenever
+ * possible, and resident pages are migrated to %node on a best-effort
+ * basis.
+ *
+ * Return: 0 on success, merr_t otherwise
+ */
+merr_t
+cheap_bind(struct cheap *h, int node);
+
 /**
  * cheap_malloc() - allocate space from a cheap
  * @h:      the cheap from which to allocate
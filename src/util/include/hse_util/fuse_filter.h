@@ -0,0 +1,178 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2015-2020 Micron Technology, Inc.  All rights reserved.
+ */
+
+#ifndef HSE_PLATFORM_FUSE_FILTER_H
+#define HSE_PLATFORM_FUSE_FILTER_H
+
+#include <hse_util/inttypes.h>
+#include <hse_util/compiler.h>
+#include <hse_util/byteorder.h>
+#include <hse_util/hse_err.h>
+
+/* A binary fuse filter is a static approximate membership filter (Graf and
+ * Lemire, "Binary Fuse Filters: Fast and Smaller Than Xor Filters").  Each
+ * element maps to three slots in an array of fingerprints, confined to
+ * three consecutive segments, and the filter is built such that the xor of
+ * an element's three slots equals its fingerprint.  With 8-bit (16-bit)
+ * fingerprints it needs about 9 (18) bits per element for a false positive
+ * rate of 1/256 (1/65536), versus roughly 12 (23) bits for a bloom filter.
+ *
+ * The set of elements must be known in advance, and building may fail
+ * (with tiny probability) in which case the client should fall back to
+ * another filter.
+ *
+ * FUSE_SEGLEN_MAX caps the segment length, which bounds the distance
+ * between an element's three slots.
+ */
+#define FUSE_ARITY (3)
+#define FUSE_SEGLEN_MAX (1u << 18)
+
+/**
+ * struct fuse_filter - a binary fuse filter
+ * @ff_fpv:       fingerprint array
+ * @ff_seed:      seed mixed into every element hash
+ * @ff_fpbits:    bits per fingerprint (8 or 16)
+ * @ff_seglen:    number of slots per segment (power of two)
+ * @ff_segcntlen: number of slots across which the first hash is spread
+ * @ff_arraylen:  number of slots in @ff_fpv
+ */
+struct fuse_filter {
+    u8 *ff_fpv;
+    u64 ff_seed;
+    u32 ff_fpbits;
+    u32 ff_seglen;
+    u32 ff_segcntlen;
+    u32 ff_arraylen;
+};
+
+static __always_inline u64
+fuse_mix(u64 hash, u64 seed)
+{
+    hash += seed;
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdul;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ul;
+    hash ^= hash >> 33;
+
+    return hash;
+}
+
+static __always_inline u32
+fuse_fingerprint(u64 mix)
+{
+    return (u32)(mix ^ (mix >> 32));
+}
+
+/**
+ * fuse_hash2idx() - determine the three slots of a mixed hash
+ * @mix:        hash from fuse_mix()
+ * @segcntlen:  see struct fuse_filter
+ * @seglen:     see struct fuse_filter
+ * @idxv:       (output) slot indices
+ */
+static __always_inline void
+fuse_hash2idx(u64 mix, u32 segcntlen, u32 seglen, u32 *idxv)
+{
+    u32 h0 = ((__uint128_t)mix * segcntlen) >> 64;
+
+    idxv[0] = h0;
+    idxv[1] = (h0 + seglen) ^ ((u32)(mix >> 18) & (seglen - 1));
+    idxv[2] = (h0 + 2 * seglen) ^ ((u32)mix & (seglen - 1));
+}
+
+static __always_inline u32
+fuse_slot(const u8 *fpv, u32 fpbits, u32 idx)
+{
+    if (fpbits == 8)
+        return fpv[idx];
+
+    return le16_to_cpu(((const u16 *)fpv)[idx]);
+}
+
+/**
+ * fuse_lookup() - check to see if hash is in a fuse filter
+ * @hash:       element hash
+ * @fpv:        fingerprint array
+ * @seed:       see struct fuse_filter
+ * @segcntlen:  see struct fuse_filter
+ * @seglen:     see struct fuse_filter
+ * @fpbits:     see struct fuse_filter
+ *
+ * Return:
+ *     Returns %true if hash might be in the filter, %false if it
+ *     definitely is not.
+ */
+static __always_inline bool
+fuse_lookup(u64 hash, const u8 *fpv, u64 seed, u32 segcntlen, u32 seglen, u32 fpbits)
+{
+    u64 mix = fuse_mix(hash, seed);
+    u32 idxv[FUSE_ARITY];
+    u32 fp;
+
+    fuse_hash2idx(mix, segcntlen, seglen, idxv);
+
+    fp = fuse_fingerprint(mix);
+    fp ^= fuse_slot(fpv, fpbits, idxv[0]);
+    fp ^= fuse_slot(fpv, fpbits, idxv[1]);
+    fp ^= fuse_slot(fpv, fpbits, idxv[2]);
+
+    return (fp & ((1u << fpbits) - 1)) == 0;
+}
+
+/**
+ * fuse_fpbits_est() - fingerprint width for a given false positive rate
+ * @probability: false positive probability (times 1000000, as for
+ *               bf_compute_bithash_est())
+ */
+u32
+fuse_fpbits_est(u32 probability);
+
+/**
+ * fuse_size_estimate() - size (in bytes) of a fuse filter
+ * @num_elmnts: number of elements
+ * @fpbits:     bits per fingerprint
+ */
+size_t
+fuse_size_estimate(u32 num_elmnts, u32 fpbits);
+
+/**
+ * fuse_element_estimate() - number of elements that fit in a fuse filter
+ * @size_in_bytes: size of the fingerprint array
+ * @fpbits:        bits per fingerprint
+ */
+u32
+fuse_element_estimate(size_t size_in_bytes, u32 fpbits);
+
+/**
+ * fuse_filter_init() - size a fuse filter for a given number of elements
+ * @filter:     fuse filter
+ * @num_elmnts: number of elements
+ * @fpbits:     bits per fingerprint (8 or 16)
+ * @storage:    fingerprint array storage
+ * @storage_sz: size of @storage in bytes
+ *
+ * Return: EINVAL if @storage is too small for @num_elmnts.
+ */
+merr_t
+fuse_filter_init(
+    struct fuse_filter *filter,
+    u32                 num_elmnts,
+    u32                 fpbits,
+    u8 *                storage,
+    size_t              storage_sz);
+
+/**
+ * fuse_filter_build() - populate a fuse filter
+ * @filter:     fuse filter from fuse_filter_init()
+ * @hashv:      element hashes (need not be unique, may be reordered)
+ * @hashc:      number of hashes, at most @num_elmnts given to fuse_filter_init()
+ *
+ * Return: ENOMEM, or EAGAIN if no suitable seed was found.
+ */
+merr_t
+fuse_filter_build(struct fuse_filter *filter, u64 *hashv, u32 hashc);
+
+#endif
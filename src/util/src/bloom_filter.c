@@ -8,8 +8,20 @@
 #include <hse_util/logging.h>
 #include <hse_util/page.h>
 
+#if __amd64__
+#include <immintrin.h>
+#endif
+
 #include "bf_size2bits.i"
 
+/* Per-word salts for split block blooms.  Arbitrary odd constants, but
+ * they are part of the media format and hence may never be changed.
+ */
+const u32 bf_sb_saltv[BF_SB_WORDS] __aligned(32) = {
+    0x47b6137bu, 0x44974d91u, 0x8824ad5bu, 0xa2b7289du,
+    0x705495c7u, 0x2df1424bu, 0x9efc4947u, 0x5c6bfb31u,
+};
+
 struct bf_prob_range {
     u32                    bfpr_min;
     u32                    bfpr_max;
@@ -152,6 +164,7 @@ bf_filter_init(
     filter->bf_bitmap = storage;
     filter->bf_bitmapsz = storage_sz;
     filter->bf_modulus = bf_size2bits(storage_sz);
+    filter->bf_sb = false;
 
     /* We set filter bits to the largest prime not to exceed the size
      * of the bitmap (in bits) in order to obtain an optimal modulus.
@@ -161,10 +174,34 @@ bf_filter_init(
     assert(filter->bf_modulus > (storage_sz - PAGE_SIZE) << BYTE_SHIFT);
 }
 
+void
+bf_filter_init_sb(
+    struct bloom_filter *  filter,
+    struct bf_bithash_desc desc,
+    u32                    exp_elmts,
+    u8 *                   storage,
+    size_t                 storage_sz)
+{
+    assert(IS_ALIGNED(storage_sz, PAGE_SIZE));
+    assert(storage_sz >= PAGE_SIZE);
+
+    filter->bf_n_hashes = BF_SB_WORDS;
+    filter->bf_bktshift = BF_SB_BKTSHIFT;
+    filter->bf_bktmask = (1u << BF_SB_BKTSHIFT) - 1;
+    filter->bf_rotl = 0;
+    filter->bf_bitmap = storage;
+    filter->bf_bitmapsz = storage_sz;
+    filter->bf_modulus = (storage_sz << BYTE_SHIFT) >> BF_SB_BKTSHIFT;
+    filter->bf_sb = true;
+}
+
 void
 bf_filter_insert_by_hash(struct bloom_filter *bf, u64 hash)
 {
-    bf_populate(bf, hash);
+    if (bf->bf_sb)
+        bf_sb_populate(bf, hash);
+    else
+        bf_populate(bf, hash);
 }
 
 void
@@ -172,6 +209,58 @@ bf_filter_insert_by_hashv(struct bloom_filter *bf, u64 *keyv, u32 keyc)
 {
     int i;
 
+    if (bf->bf_sb) {
+        for (i = 0; i < keyc; ++i)
+            bf_sb_populate(bf, keyv[i]);
+        return;
+    }
+
     for (i = 0; i < keyc; ++i)
         bf_populate(bf, keyv[i]);
 }
+
+static bool
+bf_sb_lookup_scalar(u64 hash, const u8 *bitmap)
+{
+    return bf_sb_lookup_portable(hash, bitmap);
+}
+
+#if __amd64__
+/* The build does not assume AVX2, so the vector lookup is compiled for it
+ * explicitly and selected at load time by bf_sb_lookup_resolve().  All
+ * eight bits are computed in one register (salt multiply, shift, and
+ * variable shift of 1) and tested against the bucket with a single vptest.
+ */
+__attribute__((target("avx2"))) static bool
+bf_sb_lookup_avx2(u64 hash, const u8 *bitmap)
+{
+    __m256i salt, bits, bkt;
+
+    salt = _mm256_load_si256((const __m256i *)bf_sb_saltv);
+    bits = _mm256_set1_epi32((u32)bf_sb_remix(hash));
+    bits = _mm256_mullo_epi32(bits, salt);
+    bits = _mm256_srli_epi32(bits, 27);
+    bits = _mm256_sllv_epi32(_mm256_set1_epi32(1), bits);
+    bkt = _mm256_loadu_si256((const __m256i *)bitmap);
+
+    return _mm256_testc_si256(bkt, bits);
+}
+
+static bool (*bf_sb_lookup_resolve(void))(u64, const u8 *)
+{
+    __builtin_cpu_init();
+
+    return __builtin_cpu_supports("avx2") ? bf_sb_lookup_avx2 : bf_sb_lookup_scalar;
+}
+
+bool
+bf_sb_lookup(u64 hash, const u8 *bitmap) __attribute__((ifunc("bf_sb_lookup_resolve")));
+
+#else
+
+bool
+bf_sb_lookup(u64 hash, const u8 *bitmap)
+{
+    return bf_sb_lookup_scalar(hash, bitmap);
+}
+#endif
@@ -41,18 +41,17 @@ bn_ior_replace(
 
 static struct bonsai_node *
 bn_ior_insert(
-    struct bonsai_root         *tree,
-    const struct key_immediate *key_imm,
-    const void                 *key,
-    const struct bonsai_sval   *sval,
-    struct bonsai_kv           *parent,
-    u32                         flags)
+    struct bonsai_root       *tree,
+    const struct bonsai_skey *skey,
+    const struct bonsai_sval *sval,
+    struct bonsai_kv         *parent,
+    u32                       flags)
 {
     struct bonsai_kv *head, *prev_span, *next_span;
     struct bonsai_node *node;
     enum bonsai_ior_code code;
 
-    node = bn_node_alloc(tree, key_imm, key, sval);
+    node = bn_node_alloc(tree, skey, sval);
     if (!node)
         return NULL;
 
@@ -120,15 +119,16 @@ _Static_assert(BN_IOR_RIGHT > 0 && BN_IOR_RIGHT < BN_IOR_MASK,
 
 static struct bonsai_node *
 bn_ior_impl(
-    struct bonsai_root         *tree,
-    struct bonsai_node         *node,
-    const struct key_immediate *key_imm,
-    const void                 *key,
-    const struct bonsai_sval   *sval,
-    struct bonsai_kv           *parent,
-    u32                         flags)
+    struct bonsai_root       *tree,
+    struct bonsai_node       *node,
+    const struct bonsai_skey *skey,
+    const struct bonsai_sval *sval,
+    struct bonsai_kv         *parent,
+    u32                       flags)
 {
-    struct bonsai_node *prev;
+    const struct key_immediate *key_imm = &skey->bsk_key_imm;
+    const void                 *key = skey->bsk_key;
+    struct bonsai_node         *prev;
     int n = 0;
     s32 res;
 
@@ -136,7 +136,7 @@ bn_ior_impl(
      * of all nodes visited and which way (left or right) we went...
      */
     while (node) {
-        res = key_full_cmp(key_imm, key, &node->bn_key_imm, node->bn_kv->bkv_key);
+        res = bn_node_key_cmp(key_imm, key, node);
 
         if (unlikely(res == 0))
             break;
@@ -165,7 +165,7 @@ bn_ior_impl(
     if (node)
         node = bn_ior_replace(tree, node, sval, flags);
     else
-        node = bn_ior_insert(tree, key_imm, key, sval, parent, flags);
+        node = bn_ior_insert(tree, skey, sval, parent, flags);
 
     if (!node)
         return NULL;
@@ -216,8 +216,13 @@ bn_find_next_pfx(struct bonsai_root *tree, const struct bonsai_skey *skey)
         u32 node_skidx = key_immediate_index(&node->bn_kv->bkv_key_imm);
 
         res = skidx - node_skidx;
-        if (res == 0)
+        if (res == 0 && node->bn_kv->bkv_pfx_len) {
+            struct key_obj ko, kvko;
+
+            res = key_obj_ncmp(key2kobj(&ko, key, klen), bn_kv_kobj(node->bn_kv, &kvko), klen);
+        } else if (res == 0) {
             res = key_inner_cmp(key, klen, node->bn_kv->bkv_key, klen);
+        }
 
         if (res < 0) {
             mnode = node;
@@ -229,18 +234,247 @@ bn_find_next_pfx(struct bonsai_root *tree, const struct bonsai_skey *skey)
     return mnode ? mnode->bn_kv : NULL;
 }
 
+/* Each node of a bonsai index packs BN_INDEX_FANOUT key words into one
+ * cache line.  BN_INDEX_LEVELS_MAX levels suffice for 8^12 keys.
+ */
+#define BN_INDEX_FANOUT     (SMP_CACHE_BYTES / sizeof(u64))
+#define BN_INDEX_LEVELS_MAX (12)
+
+typedef u64 bn_index_vec_t __attribute__((vector_size(32)));
+typedef s64 bn_index_mask_t __attribute__((vector_size(32)));
+
+/**
+ * struct bonsai_index - static wide-node search index over a finalized tree
+ * @bi_kvc:     number of keys in the tree
+ * @bi_lcp:     length of the prefix common to all keys, zero if none or if
+ *              the keys are from more than one kvs
+ * @bi_levelc:  number of levels in the index, including the leaf level
+ * @bi_levelv:  offset in @bi_words of each level, leaf level first
+ * @bi_kvv:     kvs in key order
+ * @bi_words:   key words of each level
+ *
+ * The leaf level holds one word per key, in key order.  Each word is the
+ * big-endian value of the 8 key bytes that follow the common prefix, or
+ * the key's ki_data[0] (i.e., its skidx and first 7 bytes) if @bi_lcp is
+ * zero.  Either way key order implies word order, so a search
+ * on the words narrows the search for a key to the run of keys that have
+ * the same word, which is usually just one key.
+ *
+ * Each entry of the level above the leaves is the largest word of the
+ * corresponding leaf node, and so on up to a single root node.  Levels
+ * are padded to whole nodes with U64_MAX.
+ */
+struct bonsai_index {
+    uint               bi_kvc;
+    uint               bi_lcp;
+    uint               bi_levelc;
+    uint               bi_levelv[BN_INDEX_LEVELS_MAX];
+    struct bonsai_kv **bi_kvv;
+    u64 *              bi_words;
+};
+
+static __always_inline u64
+bn_index_word(uint lcp, const struct key_immediate *ki, const void *key)
+{
+    u64  word = 0;
+    uint len;
+
+    if (!lcp)
+        return ki->ki_data[0];
+
+    len = key_imm_klen(ki) - lcp;
+    memcpy(&word, key + lcp, min_t(uint, len, sizeof(word)));
+
+    return be64toh(word);
+}
+
+/* Same as bn_index_word(), but for a kv whose key may be split.
+ */
+static u64
+bn_kv_index_word(uint lcp, const struct bonsai_kv *kv)
+{
+    const u8 *pfx, *sfx;
+    u8        bytev[sizeof(u64)] = { 0 };
+    uint      plen, n, i;
+    u64       word;
+
+    if (!lcp || !kv->bkv_pfx_len)
+        return bn_index_word(lcp, &kv->bkv_key_imm, kv->bkv_key);
+
+    pfx = bn_kv_pfx(kv);
+    sfx = bn_kv_sfx(kv);
+    plen = kv->bkv_pfx_len;
+    n = min_t(uint, key_imm_klen(&kv->bkv_key_imm) - lcp, sizeof(bytev));
+
+    for (i = 0; i < n; ++i, ++lcp)
+        bytev[i] = (lcp < plen) ? pfx[lcp] : sfx[lcp - plen];
+
+    memcpy(&word, bytev, sizeof(word));
+
+    return be64toh(word);
+}
+
+/* Return the length of the common prefix (up to len bytes) of a kv's key
+ * and another key, given that their first off bytes are equal and that
+ * key points to the byte at offset off of the other key.
+ */
+static size_t
+bn_kv_lcp(const void *key, const struct bonsai_kv *kv, size_t off, size_t len)
+{
+    size_t plen = kv->bkv_pfx_len;
+    size_t n;
+
+    if (!plen)
+        return off + memlcp(key, kv->bkv_key + off, len - off);
+
+    if (off < plen) {
+        n = memlcp(key, bn_kv_pfx(kv) + off, min_t(size_t, len, plen) - off);
+        off += n;
+        if (off < plen || off == len)
+            return off;
+
+        key += n;
+    }
+
+    return off + memlcp(key, bn_kv_sfx(kv) + off - plen, len - off);
+}
+
+/* Return the length of the common prefix (up to len bytes) of the keys
+ * of two kvs.
+ */
+static size_t
+bn_kv_lcp2(const struct bonsai_kv *kv0, const struct bonsai_kv *kv1, size_t len)
+{
+    size_t plen = kv0->bkv_pfx_len;
+    size_t lcp;
+
+    if (!plen)
+        return bn_kv_lcp(kv0->bkv_key, kv1, 0, len);
+
+    lcp = bn_kv_lcp(bn_kv_pfx(kv0), kv1, 0, min_t(size_t, len, plen));
+    if (lcp < plen || lcp == len)
+        return lcp;
+
+    return bn_kv_lcp(bn_kv_sfx(kv0), kv1, plen, len);
+}
+
+/* Return the number of words in the given index node that are less
+ * than the given word.  The node is compared a half line at a time.
+ */
+static __always_inline uint
+bn_index_rank(const u64 *node, u64 word)
+{
+    const bn_index_vec_t *vec = (const void *)node;
+    bn_index_vec_t        wvec = { word, word, word, word };
+    bn_index_mask_t       lt;
+
+    lt = (vec[0] < wvec) + (vec[1] < wvec);
+
+    return -(lt[0] + lt[1] + lt[2] + lt[3]);
+}
+
+/* Return the index of the first leaf word not less than the given word,
+ * which must not be greater than the largest word in the index.
+ */
+static uint
+bn_index_lb(const struct bonsai_index *idx, u64 word)
+{
+    uint level = idx->bi_levelc;
+    uint i = 0;
+
+    while (level-- > 0) {
+        const u64 *node = idx->bi_words + idx->bi_levelv[level] + i * BN_INDEX_FANOUT;
+
+        i = i * BN_INDEX_FANOUT + bn_index_rank(node, word);
+    }
+
+    assert(i < idx->bi_kvc);
+
+    return i;
+}
+
+static struct bonsai_kv *
+bn_index_find(
+    const struct bonsai_index *idx,
+    const struct bonsai_skey * skey,
+    enum bonsai_match_type     mtype)
+{
+    const struct key_immediate *ki = &skey->bsk_key_imm;
+    const void *                key = skey->bsk_key;
+    struct bonsai_kv *          bkv;
+    uint                        lo, hi, mid;
+    u64                         word;
+    s32                         res;
+
+    /* Only keys within the bounds of the tree are guaranteed to
+     * share the common prefix, so check the bounds first.
+     */
+    bkv = idx->bi_kvv[idx->bi_kvc - 1];
+    res = bn_kv_key_cmp(ki, key, bkv);
+    if (res >= 0)
+        return (res == 0 || mtype == B_MATCH_LE) ? bkv : NULL;
+
+    bkv = idx->bi_kvv[0];
+    res = bn_kv_key_cmp(ki, key, bkv);
+    if (res <= 0)
+        return (res == 0 || mtype == B_MATCH_GE) ? bkv : NULL;
+
+    word = bn_index_word(idx->bi_lcp, ki, key);
+    lo = bn_index_lb(idx, word);
+    hi = lo;
+
+    /* Keys before lo are less than the search key and keys at or
+     * after the end of the run of words equal to the search word
+     * are greater, so only the run need be compared.
+     */
+    if (idx->bi_words[lo] == word) {
+        hi = lo + 1;
+
+        if (hi < idx->bi_kvc && idx->bi_words[hi] == word)
+            hi = (idx->bi_words[idx->bi_kvc - 1] > word) ? bn_index_lb(idx, word + 1) : idx->bi_kvc;
+    }
+
+    while (lo < hi) {
+        mid = (lo + hi) / 2;
+        bkv = idx->bi_kvv[mid];
+
+        res = bn_kv_key_cmp(ki, key, bkv);
+        if (res == 0)
+            return bkv;
+
+        if (res > 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    /* The search key lies between the keys at lo - 1 and lo. */
+    if (mtype == B_MATCH_GE)
+        return idx->bi_kvv[lo];
+
+    if (mtype == B_MATCH_LE)
+        return idx->bi_kvv[lo - 1];
+
+    return NULL;
+}
+
 static inline struct bonsai_kv *
 bn_find_impl(struct bonsai_root *tree, const struct bonsai_skey *skey, enum bonsai_match_type mtype)
 {
     struct bonsai_node *        node;
     struct bonsai_node *        mnode;
     const struct key_immediate *ki;
+    struct bonsai_index *       idx;
     const void *                key;
 
     uint klen;
     uint lcp, bounds;
     s32  res;
 
+    idx = rcu_dereference(tree->br_index);
+    if (idx)
+        return bn_index_find(idx, skey, mtype);
+
     ki = &skey->bsk_key_imm;
     key = skey->bsk_key;
     klen = key_imm_klen(ki);
@@ -264,7 +498,11 @@ bn_find_impl(struct bonsai_root *tree, const struct bonsai_skey *skey, enum bons
         if (lcp > KI_DLEN_MAX &&
             key_immediate_index(ki) == key_immediate_index(&bkv->bkv_key_imm)) {
 
-            lcp = memlcpq(key, bkv->bkv_key, lcp);
+            if (bkv->bkv_pfx_len)
+                lcp = bn_kv_lcp(key, bkv, 0, lcp);
+            else
+                lcp = memlcpq(key, bkv->bkv_key, lcp);
+
             if (lcp > KI_DLEN_MAX) {
                 assert(key_immediate_cmp(ki, &bkv->bkv_key_imm) == S32_MIN);
                 goto search;
@@ -293,9 +531,6 @@ bn_find_impl(struct bonsai_root *tree, const struct bonsai_skey *skey, enum bons
     }
 
 search:
-    key += lcp;
-    klen -= lcp;
-
     node = rcu_dereference(tree->br_root);
     mnode = NULL;
 
@@ -307,8 +542,7 @@ search:
             /* At this point we are assured that both keys'
              * ki_dlen are greater than KI_DLEN_MAX.
              */
-            res = key_inner_cmp(
-                key, klen, node->bn_kv->bkv_key + lcp, key_imm_klen(&node->bn_key_imm) - lcp);
+            res = bn_kv_inner_cmp(key, klen, node->bn_kv, lcp);
         }
 
         if (unlikely(res == 0))
@@ -356,8 +590,7 @@ bn_insert_or_replace(
     oldroot = tree->br_root;
     flags = is_tomb ? BN_INSERT_FLAG_TOMB : 0;
 
-    newroot = bn_ior_impl(tree, oldroot, &skey->bsk_key_imm, skey->bsk_key,
-                          sval, &tree->br_kv, flags);
+    newroot = bn_ior_impl(tree, oldroot, skey, sval, &tree->br_kv, flags);
     if (!newroot)
         return merr(ENOMEM);
 
@@ -414,6 +647,24 @@ bn_findLE(struct bonsai_root *tree, const struct bonsai_skey *skey, struct bonsa
     return false;
 }
 
+static uint
+bn_split_keys_impl(struct bonsai_node *node, uint depth, struct bonsai_kv **kvv, uint kvc)
+{
+    if (!node || depth == 0)
+        return kvc;
+
+    kvc = bn_split_keys_impl(rcu_dereference(node->bn_left), depth - 1, kvv, kvc);
+    kvv[kvc++] = node->bn_kv;
+
+    return bn_split_keys_impl(rcu_dereference(node->bn_right), depth - 1, kvv, kvc);
+}
+
+uint
+bn_split_keys(struct bonsai_root *tree, uint depth, struct bonsai_kv **kvv)
+{
+    return bn_split_keys_impl(rcu_dereference(tree->br_root), depth, kvv, 0);
+}
+
 bool
 bn_find_pfx_GT(struct bonsai_root *tree, const struct bonsai_skey *skey, struct bonsai_kv **kv)
 {
@@ -488,6 +739,9 @@ bn_reset(struct bonsai_root *tree)
 
     atomic_set(&tree->br_bounds, 0);
 
+    free_aligned(tree->br_index);
+    tree->br_index = NULL;
+
     client->bc_slab_cur = NULL;
     client->bc_slab_end = NULL;
 }
@@ -526,8 +780,12 @@ bn_create(
 void
 bn_destroy(struct bonsai_root *tree)
 {
-    if (tree)
+    if (tree) {
         rcu_assign_pointer(tree->br_root, NULL);
+
+        free_aligned(tree->br_index);
+        tree->br_index = NULL;
+    }
 }
 
 void
@@ -550,7 +808,11 @@ bn_finalize(struct bonsai_root *tree)
         if (lcp > KI_DLEN_MAX &&
             key_immediate_index(&kmin->bkv_key_imm) == key_immediate_index(&kmax->bkv_key_imm)) {
 
-            lcp = memlcpq(kmin->bkv_key, kmax->bkv_key, lcp);
+            if (kmin->bkv_pfx_len | kmax->bkv_pfx_len)
+                lcp = bn_kv_lcp2(kmin, kmax, lcp);
+            else
+                lcp = memlcpq(kmin->bkv_key, kmax->bkv_key, lcp);
+
             if (lcp > KI_DLEN_MAX) {
                 assert(key_immediate_cmp(&kmin->bkv_key_imm, &kmax->bkv_key_imm) == S32_MIN);
                 set_lcp = lcp;
@@ -562,6 +824,133 @@ bn_finalize(struct bonsai_root *tree)
     }
 }
 
+merr_t
+bn_index_build(struct bonsai_root *tree)
+{
+    struct bonsai_index *idx;
+    struct bonsai_kv **  kvv, *bkv;
+    struct bonsai_kv *   kmin, *kmax;
+    u64 *                wordv;
+    size_t               sz, nwords;
+    uint                 kvc, kvmax, lcp, n, i, j;
+
+    assert(!tree->br_index);
+
+    /* If all keys are in the same kvs then index the bytes that follow
+     * their common prefix, which in c0 is often longer than the seven
+     * key bytes in ki_data[0].
+     */
+    lcp = 0;
+    kmin = tree->br_kv.bkv_next;
+    kmax = tree->br_kv.bkv_prev;
+
+    if (kmin == &tree->br_kv)
+        return 0;
+
+    if (key_immediate_index(&kmin->bkv_key_imm) == key_immediate_index(&kmax->bkv_key_imm)) {
+        lcp = min_t(uint, key_imm_klen(&kmin->bkv_key_imm), key_imm_klen(&kmax->bkv_key_imm));
+        lcp = bn_kv_lcp2(kmin, kmax, lcp);
+    }
+
+    /* Collect the kvs and their words in one pass over the kv list,
+     * which is typically scattered throughout the c0kvset.
+     */
+    kvv = NULL;
+    wordv = NULL;
+    kvmax = kvc = 0;
+
+    for (bkv = tree->br_kv.bkv_next; bkv != &tree->br_kv; bkv = bkv->bkv_next) {
+        if (kvc >= kvmax) {
+            void *mem;
+
+            kvmax = kvmax ? kvmax * 2 : 4096;
+
+            mem = realloc(kvv, kvmax * sizeof(*kvv));
+            if (ev(!mem))
+                goto errout;
+            kvv = mem;
+
+            mem = realloc(wordv, kvmax * sizeof(*wordv));
+            if (ev(!mem))
+                goto errout;
+            wordv = mem;
+        }
+
+        __builtin_prefetch(bkv->bkv_next);
+
+        kvv[kvc] = bkv;
+        wordv[kvc++] = bn_kv_index_word(lcp, bkv);
+    }
+
+    if (!kvc)
+        goto errout;
+
+    sz = ALIGN(sizeof(*idx), SMP_CACHE_BYTES);
+    sz += kvc * sizeof(*kvv);
+    sz = ALIGN(sz, SMP_CACHE_BYTES);
+
+    for (nwords = 0, n = kvc; ; n = ALIGN(n, BN_INDEX_FANOUT) / BN_INDEX_FANOUT) {
+        nwords += ALIGN(n, BN_INDEX_FANOUT);
+        if (n <= BN_INDEX_FANOUT)
+            break;
+    }
+
+    idx = alloc_aligned(sz + nwords * sizeof(*wordv), SMP_CACHE_BYTES, GFP_KERNEL);
+    if (ev(!idx))
+        goto errout;
+
+    idx->bi_kvc = kvc;
+    idx->bi_lcp = lcp;
+    idx->bi_kvv = (void *)idx + ALIGN(sizeof(*idx), SMP_CACHE_BYTES);
+    idx->bi_words = (void *)idx + sz;
+
+    memcpy(idx->bi_kvv, kvv, kvc * sizeof(*kvv));
+
+    /* Fill in the leaf level from wordv[], then each level above it
+     * with the largest word of each node of the level below.
+     */
+    for (i = 0, n = kvc, nwords = 0; ; ++i) {
+        u64 *words = idx->bi_words + nwords;
+
+        assert(i < BN_INDEX_LEVELS_MAX);
+        idx->bi_levelv[i] = nwords;
+
+        if (i == 0) {
+            memcpy(words, wordv, n * sizeof(*words));
+        } else {
+            const u64 *below = idx->bi_words + idx->bi_levelv[i - 1];
+
+            for (j = 0; j < n; ++j)
+                words[j] = below[j * BN_INDEX_FANOUT + BN_INDEX_FANOUT - 1];
+        }
+
+        for (j = n; j < ALIGN(n, BN_INDEX_FANOUT); ++j)
+            words[j] = U64_MAX;
+
+        nwords += ALIGN(n, BN_INDEX_FANOUT);
+
+        if (n <= BN_INDEX_FANOUT)
+            break;
+
+        n = ALIGN(n, BN_INDEX_FANOUT) / BN_INDEX_FANOUT;
+    }
+
+    idx->bi_levelc = i + 1;
+
+    rcu_assign_pointer(tree->br_index, idx);
+
+    free(wordv);
+    free(kvv);
+
+    return 0;
+
+errout:
+    free(wordv);
+    free(kvv);
+
+    return kvc ? merr(ENOMEM) : 0;
+}
+
 __attribute__((__cold__))
 static void
 _bn_traverse(struct bonsai_node *node)
@@ -135,7 +135,7 @@ bn_balance_left(
     if (!newnode)
         return node;
 
-    res = key_full_cmp(key_imm, key, &left->bn_key_imm, left->bn_kv->bkv_key);
+    res = bn_node_key_cmp(key_imm, key, left);
 
     assert(res != 0);
 
@@ -168,7 +168,7 @@ bn_balance_right(
     if (!newnode)
         return node;
 
-    res = key_full_cmp(key_imm, key, &right->bn_key_imm, right->bn_kv->bkv_key);
+    res = bn_node_key_cmp(key_imm, key, right);
 
     assert(res != 0);
 
@@ -24,21 +24,40 @@ enum bonsai_match_type {
     B_MATCH_LE = 2,
 };
 
+/**
+ * bn_node_key_cmp() - compare a key with the key of a node
+ * @ki:   key immediate of @key
+ * @key:  key data
+ * @node: bonsai node
+ *
+ * Return: as key_full_cmp()
+ */
+static inline s32
+bn_node_key_cmp(const struct key_immediate *ki, const void *key, const struct bonsai_node *node)
+{
+    s32 rc;
+
+    rc = key_immediate_cmp(ki, &node->bn_key_imm);
+
+    if (rc == S32_MIN)
+        rc = bn_kv_inner_cmp(key, key_imm_klen(ki), node->bn_kv, KI_DLEN_MAX);
+
+    return rc;
+}
+
 /**
  * bn_node_alloc() -
  * @tree:    bonsai tree instance
- * @key_imm:
- * @key:
+ * @skey:
  * @sval:
  *
  * Return:
  */
 struct bonsai_node *
 bn_node_alloc(
-    struct bonsai_root *        tree,
-    const struct key_immediate *key_imm,
-    const void *                key,
-    const struct bonsai_sval *  sval);
+    struct bonsai_root *      tree,
+    const struct bonsai_skey *skey,
+    const struct bonsai_sval *sval);
 
 /**
  * bn_val_alloc() -
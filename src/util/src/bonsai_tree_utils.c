@@ -39,53 +39,61 @@ bn_node_alloc_impl(struct bonsai_root *tree)
     return client->bc_slab_cur++;
 }
 
-struct bonsai_val *
-bn_val_alloc(struct bonsai_root *tree, const struct bonsai_sval *sval)
+static void
+bn_val_init(struct bonsai_val *v, const struct bonsai_sval *sval)
 {
-    struct bonsai_val *v;
-    size_t             sz;
-    uint               vlen;
-
-    vlen = bonsai_sval_vlen(sval);
-    sz = sizeof(*v) + vlen;
-
-    v = bn_alloc(tree, sz);
-    if (ev(!v))
-        return NULL;
+    uint vlen = bonsai_sval_vlen(sval);
 
     v->bv_next = NULL;
     v->bv_free = NULL;
     v->bv_seqnoref = sval->bsv_seqnoref;
     v->bv_flags = 0;
+    v->bv_expiry = sval->bsv_expiry;
     v->bv_xlen = sval->bsv_xlen;
     v->bv_valuep = sval->bsv_val;
     atomic64_set(&v->bv_priv, 0);
 
     if (vlen > 0)
         memcpy(v->bv_value, sval->bsv_val, vlen);
-
-    return v;
 }
 
-static inline merr_t
-bn_kv_init(
-    struct bonsai_root *        tree,
-    const struct key_immediate *key_imm,
-    const void *                key,
-    const struct bonsai_sval *  sval,
-    struct bonsai_kv **         kv_out)
+struct bonsai_val *
+bn_val_alloc(struct bonsai_root *tree, const struct bonsai_sval *sval)
 {
     struct bonsai_val *v;
-    struct bonsai_kv * kv;
+    size_t             sz;
 
-    size_t sz;
-    int    i;
+    if (sval->bsv_prep_val)
+        return sval->bsv_prep_val;
 
-    sz = sizeof(*kv) + key_imm_klen(key_imm);
+    sz = sizeof(*v) + bonsai_sval_vlen(sval);
 
-    kv = bn_alloc(tree, sz);
-    if (ev(!kv))
-        return merr(ENOMEM);
+    v = bn_alloc(tree, sz);
+    if (ev(!v))
+        return NULL;
+
+    bn_val_init(v, sval);
+
+    return v;
+}
+
+/* A kv whose key is split stores a pointer to the interned prefix
+ * in place of the prefix bytes.
+ */
+static inline size_t
+bn_kv_keysz(const struct bonsai_skey *skey)
+{
+    size_t klen = key_imm_klen(&skey->bsk_key_imm);
+
+    return skey->bsk_pfx_len ? klen - skey->bsk_pfx_len + sizeof(void *) : klen;
+}
+
+static void
+bn_kv_init_impl(struct bonsai_kv *kv, const struct bonsai_skey *skey)
+{
+    const struct key_immediate *key_imm = &skey->bsk_key_imm;
+    uint                        plen = skey->bsk_pfx_len;
+    int                         i;
 
     kv->bkv_next = NULL;
     kv->bkv_prev = NULL;
@@ -99,8 +107,39 @@ bn_kv_init(
     INIT_S_LIST_HEAD(&kv->bkv_txpend);
 
     kv->bkv_flags = 0;
+    kv->bkv_pfx_len = plen;
     kv->bkv_key_imm = *key_imm;
-    memcpy(kv->bkv_key, key, key_imm_klen(key_imm));
+
+    if (plen) {
+        memcpy(kv->bkv_key, &skey->bsk_pfx, sizeof(skey->bsk_pfx));
+        memcpy(kv->bkv_key + sizeof(skey->bsk_pfx), skey->bsk_key + plen,
+               key_imm_klen(key_imm) - plen);
+        return;
+    }
+
+    memcpy(kv->bkv_key, skey->bsk_key, key_imm_klen(key_imm));
+}
+
+static inline merr_t
+bn_kv_init(
+    struct bonsai_root *      tree,
+    const struct bonsai_skey *skey,
+    const struct bonsai_sval *sval,
+    struct bonsai_kv **       kv_out)
+{
+    struct bonsai_val *v;
+    struct bonsai_kv * kv;
+
+    if (sval->bsv_prep_kv) {
+        *kv_out = sval->bsv_prep_kv;
+        return 0;
+    }
+
+    kv = bn_alloc(tree, sizeof(*kv) + bn_kv_keysz(skey));
+    if (ev(!kv))
+        return merr(ENOMEM);
+
+    bn_kv_init_impl(kv, skey);
 
     v = bn_val_alloc(tree, sval);
     if (ev(!v))
@@ -113,6 +152,36 @@ bn_kv_init(
     return 0;
 }
 
+size_t
+bn_kv_prep_sz(const struct bonsai_skey *skey, const struct bonsai_sval *sval)
+{
+    size_t sz = sizeof(struct bonsai_val) + bonsai_sval_vlen(sval);
+
+    return ALIGN(sz, __alignof(struct bonsai_kv)) + sizeof(struct bonsai_kv) +
+           bn_kv_keysz(skey);
+}
+
+void
+bn_kv_prep(const struct bonsai_skey *skey, struct bonsai_sval *sval, void *mem)
+{
+    struct bonsai_val *v = mem;
+    struct bonsai_kv * kv;
+    size_t             sz;
+
+    /* The kv goes last so that the caller can release it cheaply
+     * if bn_insert_or_replace() ends up using only the value.
+     */
+    sz = sizeof(*v) + bonsai_sval_vlen(sval);
+    kv = mem + ALIGN(sz, __alignof(*kv));
+
+    bn_val_init(v, sval);
+    bn_kv_init_impl(kv, skey);
+    kv->bkv_values = v;
+
+    sval->bsv_prep_kv = kv;
+    sval->bsv_prep_val = v;
+}
+
 static struct bonsai_node *
 bn_node_make(
     struct bonsai_root *        tree,
@@ -139,10 +208,9 @@ bn_node_make(
 
 struct bonsai_node *
 bn_node_alloc(
-    struct bonsai_root *        tree,
-    const struct key_immediate *key_imm,
-    const void *                key,
-    const struct bonsai_sval *  sval)
+    struct bonsai_root *      tree,
+    const struct bonsai_skey *skey,
+    const struct bonsai_sval *sval)
 {
     struct bonsai_node *node;
     struct bonsai_kv *  kv;
@@ -150,11 +218,11 @@ bn_node_alloc(
     merr_t err;
 
     kv = NULL;
-    err = bn_kv_init(tree, key_imm, key, sval, &kv);
+    err = bn_kv_init(tree, skey, sval, &kv);
     if (err)
         return NULL;
 
-    node = bn_node_make(tree, NULL, NULL, kv, key_imm);
+    node = bn_node_make(tree, NULL, NULL, kv, &skey->bsk_key_imm);
     if (node)
         bn_height_update(node);
 
@@ -12,8 +12,79 @@
 #include <hse_util/event_counter.h>
 #include <hse_util/cursor_heap.h>
 
+#include <linux/mempolicy.h>
+#include <syscall.h>
+
+static atomic64_t cheap_mapped;
+static atomic64_t cheap_hugetlb;
+static atomic64_t cheap_thp;
+
+/* Map a cheap region of at least *sizep bytes, trying each page size
+ * from the largest permitted by %huge down to base pages.  Returns the
+ * backing actually obtained in *hugep and the mapped length in *sizep.
+ */
+static void *
+cheap_mmap(size_t *sizep, uint *hugep)
+{
+    int    prot = PROT_READ | PROT_WRITE;
+    int    flags = MAP_ANON | MAP_PRIVATE; /* so cheap_trim() can release pages */
+    size_t size = *sizep;
+    size_t hugesz = 2u << 20;
+    void * mem, *base;
+    size_t sz;
+
+    /* Only bother with 1GB pages if the heap is large enough to
+     * fill at least one of them.
+     */
+    if (*hugep >= CHEAP_HUGE_1G && size >= (1ul << 30)) {
+        sz = ALIGN(size, 1ul << 30);
+
+        mem = mmap(NULL, sz, prot, flags | MAP_HUGETLB | MAP_HUGE_1GB, -1, 0);
+        if (mem != MAP_FAILED) {
+            *hugep = CHEAP_HUGE_1G;
+            *sizep = sz;
+            return mem;
+        }
+        ev(1);
+    }
+
+    if (*hugep >= CHEAP_HUGE_2M) {
+        mem = mmap(NULL, size, prot, flags | MAP_HUGETLB | MAP_HUGE_2MB, -1, 0);
+        if (mem != MAP_FAILED) {
+            *hugep = CHEAP_HUGE_2M;
+            return mem;
+        }
+        ev(1);
+    }
+
+    /* Transparent huge pages can back only 2MB aligned extents, so
+     * over-allocate the address space and trim it to alignment.
+     */
+    if (*hugep >= CHEAP_HUGE_THP) {
+        base = mmap(NULL, size + hugesz, prot, flags, -1, 0);
+        if (base != MAP_FAILED) {
+            mem = PTR_ALIGN(base, hugesz);
+            if (mem > base)
+                munmap(base, mem - base);
+
+            sz = hugesz - (mem - base);
+            if (sz > 0)
+                munmap(mem + size, sz);
+
+            *hugep = madvise(mem, size, MADV_HUGEPAGE) ? CHEAP_HUGE_NONE : CHEAP_HUGE_THP;
+            ev(*hugep == CHEAP_HUGE_NONE);
+            return mem;
+        }
+        ev(1);
+    }
+
+    *hugep = CHEAP_HUGE_NONE;
+
+    return mmap(NULL, size, prot, flags, -1, 0);
+}
+
 struct cheap *
-cheap_create(size_t alignment, size_t size)
+cheap_create_huge(size_t alignment, size_t size, uint huge)
 {
     struct cheap *h = NULL;
     void *        mem;
@@ -30,9 +101,7 @@ cheap_create(size_t alignment, size_t size)
      */
     size = ALIGN(size, 2u << 20);
 
-    /* Use MAP_PRIVATE so that cheap_trim() can release pages.
-     */
-    mem = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_ANON | MAP_PRIVATE, -1, 0);
+    mem = cheap_mmap(&size, &huge);
 
     if (mem != MAP_FAILED) {
         size_t halign = ALIGN(sizeof(*h), SMP_CACHE_BYTES);
@@ -44,6 +113,8 @@ cheap_create(size_t alignment, size_t size)
          */
         h = mem + offset;
         h->mem = mem;
+        h->memsz = size;
+        h->huge = huge;
         h->magic = (uintptr_t)h;
         h->alignment = alignment;
         h->size = size - offset - halign - CHEAP_POISON_SZ;
@@ -51,12 +122,24 @@ cheap_create(size_t alignment, size_t size)
         h->cursorp = h->base;
         h->brk = PAGE_ALIGN(h->cursorp);
         h->lastp = 0;
+
+        atomic64_add(size, &cheap_mapped);
+        if (huge >= CHEAP_HUGE_2M)
+            atomic64_add(size, &cheap_hugetlb);
+        else if (huge == CHEAP_HUGE_THP)
+            atomic64_add(size, &cheap_thp);
         ev(1);
     }
 
     return h;
 }
 
+struct cheap *
+cheap_create(size_t alignment, size_t size)
+{
+    return cheap_create_huge(alignment, size, CHEAP_HUGE_NONE);
+}
+
 void
 cheap_destroy(struct cheap *h)
 {
@@ -66,10 +149,24 @@ cheap_destroy(struct cheap *h)
     assert(h->magic == (uintptr_t)h);
     h->magic = ~h->magic;
 
-    munmap(h->mem, ALIGN(h->size, PAGE_SIZE));
+    atomic64_sub(h->memsz, &cheap_mapped);
+    if (h->huge >= CHEAP_HUGE_2M)
+        atomic64_sub(h->memsz, &cheap_hugetlb);
+    else if (h->huge == CHEAP_HUGE_THP)
+        atomic64_sub(h->memsz, &cheap_thp);
+
+    munmap(h->mem, h->memsz);
     ev(1);
 }
 
+void
+cheap_huge_stats(size_t *mapped, size_t *hugetlb, size_t *thp)
+{
+    *mapped = atomic64_read(&cheap_mapped);
+    *hugetlb = atomic64_read(&cheap_hugetlb);
+    *thp = atomic64_read(&cheap_thp);
+}
+
 void
 cheap_reset(struct cheap *h, size_t size)
 {
@@ -96,6 +193,10 @@ cheap_trim(struct cheap *h, size_t rss)
 
     assert(h->magic == (uintptr_t)h);
 
+    /* hugetlb pages cannot be released piecemeal. */
+    if (h->huge >= CHEAP_HUGE_2M)
+        return;
+
     if (h->brk < h->cursorp)
         h->brk = PAGE_ALIGN(h->cursorp);
 
@@ -118,6 +219,37 @@ cheap_trim(struct cheap *h, size_t rss)
     ev(rc);
 }
 
+merr_t
+cheap_bind(struct cheap *h, int node)
+{
+    unsigned long nodemask;
+    size_t        len;
+    long          rc;
+
+    assert(h->magic == (uintptr_t)h);
+
+    if (node >= (int)(sizeof(nodemask) * 8))
+        return merr(EINVAL);
+
+    len = h->memsz;
+
+    /* A negative node reverts the cheap to the default (local) policy.
+     */
+    if (node < 0) {
+        rc = syscall(SYS_mbind, h->mem, len, MPOL_DEFAULT, NULL, 0, 0);
+    } else {
+        nodemask = 1ul << node;
+        rc = syscall(
+            SYS_mbind, h->mem, len, MPOL_PREFERRED, &nodemask, sizeof(nodemask) * 8 + 1,
+            MPOL_MF_MOVE);
+    }
+
+    if (rc)
+        return merr(ev(errno));
+
+    return 0;
+}
+
 static inline void *
 cheap_memalign_impl(struct cheap *h, size_t alignment, size_t size)
 {
@@ -0,0 +1,348 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2015-2020 Micron Technology, Inc.  All rights reserved.
+ */
+
+#include <hse_util/platform.h>
+#include <hse_util/alloc.h>
+#include <hse_util/slab.h>
+#include <hse_util/event_counter.h>
+#include <hse_util/fuse_filter.h>
+
+#include <math.h>
+
+/* Construction is retried with a new seed this many times before giving up.
+ * For a reasonably sized set a single attempt almost always succeeds.
+ */
+#define FUSE_BUILD_TRIES (100)
+
+u32
+fuse_fpbits_est(u32 probability)
+{
+    /* 8-bit fingerprints give 1/256, or 3906 per million. */
+    return (probability >= 1000000 / 256) ? 8 : 16;
+}
+
+static void
+fuse_params(struct fuse_filter *ff, u32 n, u32 fpbits)
+{
+    u32    seglen, segcnt, capacity;
+    double factor;
+
+    /* The segment length and the over-provisioning factor below are the
+     * empirically chosen values from the paper for arity three.
+     */
+    seglen = 4;
+    if (n > 1) {
+        int shift = floor(log((double)n) / log(3.33) + 2.25);
+
+        seglen = (shift < 31) ? (1u << shift) : FUSE_SEGLEN_MAX;
+    }
+
+    seglen = min_t(u32, seglen, FUSE_SEGLEN_MAX);
+
+    factor = 0;
+    if (n > 1)
+        factor = max_t(double, 1.125, 0.875 + 0.25 * log(1000000.0) / log((double)n));
+
+    capacity = round(n * factor);
+
+    segcnt = (capacity + seglen - 1) / seglen;
+    segcnt = (segcnt > FUSE_ARITY - 1) ? segcnt - (FUSE_ARITY - 1) : 1;
+
+    ff->ff_fpbits = fpbits;
+    ff->ff_seglen = seglen;
+    ff->ff_segcntlen = segcnt * seglen;
+    ff->ff_arraylen = (segcnt + FUSE_ARITY - 1) * seglen;
+}
+
+size_t
+fuse_size_estimate(u32 n, u32 fpbits)
+{
+    struct fuse_filter ff;
+
+    fuse_params(&ff, n, fpbits);
+
+    return (size_t)ff.ff_arraylen * (fpbits / 8);
+}
+
+u32
+fuse_element_estimate(size_t size_in_bytes, u32 fpbits)
+{
+    u32 lo = 0, hi;
+
+    /* Every element costs at least one fingerprint, and the size
+     * grows (very nearly) monotonically with the element count.
+     */
+    hi = min_t(size_t, (size_in_bytes << 3) / fpbits, U32_MAX - 1);
+
+    while (lo < hi) {
+        u32 mid = lo + (hi - lo + 1) / 2;
+
+        if (fuse_size_estimate(mid, fpbits) <= size_in_bytes)
+            lo = mid;
+        else
+            hi = mid - 1;
+    }
+
+    return lo;
+}
+
+merr_t
+fuse_filter_init(struct fuse_filter *ff, u32 n, u32 fpbits, u8 *storage, size_t storage_sz)
+{
+    if (ev(fpbits != 8 && fpbits != 16))
+        return merr(EINVAL);
+
+    memset(ff, 0, sizeof(*ff));
+    fuse_params(ff, n, fpbits);
+
+    if (ev((size_t)ff->ff_arraylen * (fpbits / 8) > storage_sz))
+        return merr(EINVAL);
+
+    ff->ff_fpv = storage;
+
+    return 0;
+}
+
+static u64
+fuse_rng(u64 *state)
+{
+    u64 z = (*state += 0x9e3779b97f4a7c15ul);
+
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ul;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebul;
+
+    return z ^ (z >> 31);
+}
+
+static int
+fuse_u64_cmp(const void *lhs, const void *rhs)
+{
+    const u64 l = *(const u64 *)lhs;
+    const u64 r = *(const u64 *)rhs;
+
+    return (l > r) - (l < r);
+}
+
+static u32
+fuse_dedup(u64 *hashv, u32 hashc)
+{
+    u32 i, j;
+
+    if (hashc < 2)
+        return hashc;
+
+    qsort(hashv, hashc, sizeof(*hashv), fuse_u64_cmp);
+
+    for (i = j = 1; i < hashc; ++i)
+        if (hashv[i] != hashv[j - 1])
+            hashv[j++] = hashv[i];
+
+    return j;
+}
+
+static __always_inline u32
+fuse_mod3(u32 x)
+{
+    return (x > 2) ? x - 3 : x;
+}
+
+static void
+fuse_slot_set(struct fuse_filter *ff, u32 idx, u32 fp)
+{
+    if (ff->ff_fpbits == 8)
+        ff->ff_fpv[idx] = fp;
+    else
+        ((u16 *)ff->ff_fpv)[idx] = cpu_to_le16(fp);
+}
+
+/*
+ * Each slot tracks the xor of the mixed hashes mapped to it (t2hash), and
+ * a count of them times four (t2count) whose low two bits hold the xor of
+ * the slot's position (0, 1 or 2) among the three slots of each of those
+ * hashes.  Slots holding exactly one hash are peeled off one at a time
+ * (which may leave other slots with one hash), and the order of peeling
+ * is then reversed to assign the fingerprints.  If not every hash can be
+ * peeled the filter is retried with a different seed.
+ */
+merr_t
+fuse_filter_build(struct fuse_filter *ff, u64 *hashv, u32 hashc)
+{
+    u64 *  orderv, *t2hash;
+    u32 *  alonev, *startv;
+    u8 *   t2count, *orderh;
+    u32    blkbits, blkcnt, cap, n, tries, i;
+    u64    rng = 0x726b2b9d438b9d4dul;
+    merr_t err = 0;
+    size_t sz;
+
+    cap = ff->ff_arraylen;
+    n = hashc;
+
+    for (blkbits = 1; (1u << blkbits) < ff->ff_segcntlen / ff->ff_seglen; ++blkbits)
+        ;
+    blkcnt = 1u << blkbits;
+
+    sz = sizeof(*orderv) * (n + 1) + sizeof(*t2hash) * cap;
+    sz += sizeof(*alonev) * cap + sizeof(*startv) * blkcnt + cap + n;
+
+    orderv = malloc(sz);
+    if (ev(!orderv))
+        return merr(ENOMEM);
+
+    t2hash = orderv + n + 1;
+    alonev = (u32 *)(t2hash + cap);
+    startv = alonev + cap;
+    t2count = (u8 *)(startv + blkcnt);
+    orderh = t2count + cap;
+
+    for (tries = 0; tries < FUSE_BUILD_TRIES; ++tries) {
+        u32  qlen, stacklen, dups;
+        bool error;
+
+        ff->ff_seed = fuse_rng(&rng);
+
+        memset(orderv, 0, sizeof(*orderv) * (n + 1));
+        memset(t2hash, 0, sizeof(*t2hash) * cap);
+        memset(t2count, 0, cap);
+        orderv[n] = 1;
+
+        /* Bucket the mixed hashes roughly by segment for cache locality
+         * while counting.
+         */
+        for (i = 0; i < blkcnt; ++i)
+            startv[i] = ((u64)i * n) >> blkbits;
+
+        for (i = 0; i < n; ++i) {
+            u64 mix = fuse_mix(hashv[i], ff->ff_seed);
+            u32 blk = mix >> (64 - blkbits);
+
+            while (orderv[startv[blk]])
+                blk = (blk + 1) & (blkcnt - 1);
+
+            orderv[startv[blk]++] = mix;
+        }
+
+        error = false;
+        dups = 0;
+
+        for (i = 0; i < n; ++i) {
+            u64 mix = orderv[i];
+            u32 idxv[FUSE_ARITY];
+
+            fuse_hash2idx(mix, ff->ff_segcntlen, ff->ff_seglen, idxv);
+
+            t2count[idxv[0]] += 4;
+            t2hash[idxv[0]] ^= mix;
+            t2count[idxv[1]] += 4;
+            t2count[idxv[1]] ^= 1;
+            t2hash[idxv[1]] ^= mix;
+            t2count[idxv[2]] += 4;
+            t2count[idxv[2]] ^= 2;
+            t2hash[idxv[2]] ^= mix;
+
+            /* A duplicate cancels out its twin, back it out. */
+            if ((t2hash[idxv[0]] & t2hash[idxv[1]] & t2hash[idxv[2]]) == 0) {
+                if ((t2hash[idxv[0]] == 0 && t2count[idxv[0]] == 8) ||
+                    (t2hash[idxv[1]] == 0 && t2count[idxv[1]] == 8) ||
+                    (t2hash[idxv[2]] == 0 && t2count[idxv[2]] == 8)) {
+                    ++dups;
+                    t2count[idxv[0]] -= 4;
+                    t2hash[idxv[0]] ^= mix;
+                    t2count[idxv[1]] -= 4;
+                    t2count[idxv[1]] ^= 1;
+                    t2hash[idxv[1]] ^= mix;
+                    t2count[idxv[2]] -= 4;
+                    t2count[idxv[2]] ^= 2;
+                    t2hash[idxv[2]] ^= mix;
+                }
+            }
+
+            /* The 8-bit count wrapped. */
+            if (t2count[idxv[0]] < 4 || t2count[idxv[1]] < 4 || t2count[idxv[2]] < 4)
+                error = true;
+        }
+
+        if (error)
+            continue;
+
+        qlen = 0;
+        for (i = 0; i < cap; ++i) {
+            alonev[qlen] = i;
+            qlen += ((t2count[i] >> 2) == 1);
+        }
+
+        stacklen = 0;
+        while (qlen > 0) {
+            u32 idx = alonev[--qlen];
+            u32 idxv[FUSE_ARITY * 2 - 1];
+            u32 found, other;
+            u64 mix;
+
+            if ((t2count[idx] >> 2) != 1)
+                continue;
+
+            mix = t2hash[idx];
+            fuse_hash2idx(mix, ff->ff_segcntlen, ff->ff_seglen, idxv);
+            idxv[3] = idxv[0];
+            idxv[4] = idxv[1];
+
+            found = t2count[idx] & 3;
+            orderh[stacklen] = found;
+            orderv[stacklen] = mix;
+            ++stacklen;
+
+            other = idxv[found + 1];
+            alonev[qlen] = other;
+            qlen += ((t2count[other] >> 2) == 2);
+            t2count[other] -= 4;
+            t2count[other] ^= fuse_mod3(found + 1);
+            t2hash[other] ^= mix;
+
+            other = idxv[found + 2];
+            alonev[qlen] = other;
+            qlen += ((t2count[other] >> 2) == 2);
+            t2count[other] -= 4;
+            t2count[other] ^= fuse_mod3(found + 2);
+            t2hash[other] ^= mix;
+        }
+
+        if (stacklen + dups == n) {
+            n = stacklen;
+            break;
+        }
+
+        if (dups > 0)
+            n = fuse_dedup(hashv, n);
+    }
+
+    if (ev(tries >= FUSE_BUILD_TRIES)) {
+        err = merr(EAGAIN);
+        goto out;
+    }
+
+    memset(ff->ff_fpv, 0, (size_t)cap * (ff->ff_fpbits / 8));
+
+    for (i = n; i-- > 0;) {
+        u64 mix = orderv[i];
+        u32 idxv[FUSE_ARITY * 2 - 1];
+        u32 found = orderh[i];
+        u32 fp;
+
+        fuse_hash2idx(mix, ff->ff_segcntlen, ff->ff_seglen, idxv);
+        idxv[3] = idxv[0];
+        idxv[4] = idxv[1];
+
+        fp = fuse_fingerprint(mix);
+        fp ^= fuse_slot(ff->ff_fpv, ff->ff_fpbits, idxv[found + 1]);
+        fp ^= fuse_slot(ff->ff_fpv, ff->ff_fpbits, idxv[found + 2]);
+
+        fuse_slot_set(ff, idxv[found], fp & ((1u << ff->ff_fpbits) - 1));
+    }
+
+out:
+    free(orderv);
+
+    return err;
+}
@@ -139,6 +139,71 @@ MTF_DEFINE_UTEST(bloom_filter_basic, BasicInsert)
     }
 }
 
+MTF_DEFINE_UTEST(bloom_filter_basic, SplitBlockInsert)
+{
+    struct bf_bithash_desc desc;
+    struct bloom_filter    f;
+    u8 *                   bits;
+    u32                    n_elts;
+    u32                    i, n, prob;
+    u64                    hash;
+    char                   buf[100];
+
+    n_elts = 10000;
+
+    for (prob = 1000; prob < 90000; prob += 1773) {
+        u32    fpc = 0;
+        size_t sz;
+
+        desc = bf_compute_bithash_est(prob);
+
+        sz = ALIGN(bf_size_estimate(desc, n_elts), PAGE_SIZE);
+        bits = alloc_aligned(sz, PAGE_SIZE, 0);
+        ASSERT_NE(NULL, bits);
+        memset(bits, 0, sz);
+
+        bf_filter_init_sb(&f, desc, n_elts, bits, sz);
+        ASSERT_TRUE(f.bf_sb);
+        ASSERT_EQ(BF_SB_WORDS, f.bf_n_hashes);
+        ASSERT_EQ((sz * CHAR_BIT) >> BF_SB_BKTSHIFT, f.bf_modulus);
+
+        for (i = 0; i < n_elts; ++i) {
+            n = sprintf(buf, "%x:%d", i, i);
+            hash = hse_hash64(buf, n);
+            bf_filter_insert_by_hash(&f, hash);
+        }
+
+        for (i = 0; i < n_elts; ++i) {
+            const u8 *bitmap;
+            bool      hit;
+
+            n = sprintf(buf, "%x:%d", i, i);
+            hash = hse_hash64(buf, n);
+
+            bitmap = bits + bf_sb_hash2bkt(hash, f.bf_modulus);
+            ASSERT_LE(bitmap + (1u << (BF_SB_BKTSHIFT - BYTE_SHIFT)), bits + sz);
+
+            hit = bf_sb_lookup(hash, bitmap);
+            ASSERT_TRUE(hit);
+            ASSERT_TRUE(bf_sb_lookup_portable(hash, bitmap));
+
+            bitmap = bits + bf_sb_hash2bkt(~hash, f.bf_modulus);
+
+            hit = bf_sb_lookup(~hash, bitmap);
+            ASSERT_EQ(hit, bf_sb_lookup_portable(~hash, bitmap));
+            if (hit)
+                ++fpc;
+        }
+
+        /* Unlike BasicInsert the bitmap is sized by the estimate, so allow
+         * twice the requested probability (the estimate table is tight).
+         */
+        ASSERT_LE(fpc, ((u64)prob * n_elts * 2) / 1000000);
+
+        free_aligned(bits);
+    }
+}
+
 MTF_DEFINE_UTEST(bloom_filter_basic, RepeatableBasic)
 {
     const char *buf1 = "The cow jumped over the moon";
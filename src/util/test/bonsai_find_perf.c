@@ -0,0 +1,177 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2015-2020 Micron Technology, Inc.  All rights reserved.
+ */
+
+#include <hse_util/platform.h>
+#include <hse_util/timing.h>
+#include <hse_util/seqno.h>
+#include <hse_util/cursor_heap.h>
+#include <hse_util/bonsai_tree.h>
+
+#include <hse_test_support/mwc_rand.h>
+
+#include <getopt.h>
+
+#ifdef NDEBUG
+const unsigned long nkeys_dflt = 4 * 1024 * 1024;
+#else
+const unsigned long nkeys_dflt = 256 * 1024;
+#endif
+
+static struct mwc_rand mwc;
+
+static void
+insert_cb(
+    void *                rock,
+    enum bonsai_ior_code *code,
+    struct bonsai_kv *    kv,
+    struct bonsai_val *   new_val,
+    struct bonsai_val **  old_val)
+{
+    if (IS_IOR_REPORADD(*code)) {
+        new_val->bv_next = kv->bkv_values;
+        kv->bkv_values = new_val;
+        SET_IOR_ADD(*code);
+    }
+}
+
+static void
+make_key(u64 *key, unsigned int pfx, u64 v)
+{
+    memset(key, 0xa5, pfx);
+    v = cpu_to_be64(v);
+    memcpy((char *)key + pfx, &v, sizeof(v));
+}
+
+/* Time nfind random lookups, half of them for keys not in the tree.
+ */
+static double
+run_find(struct bonsai_root *tree, unsigned int pfx, unsigned long nkeys, unsigned long nfind)
+{
+    struct bonsai_skey skey;
+    struct bonsai_kv * kv;
+    unsigned long      i, found = 0;
+    u64                key[8];
+    u64                tstart;
+
+    mwc_rand_init(&mwc, 1234);
+
+    tstart = get_time_ns();
+
+    rcu_read_lock();
+    for (i = 0; i < nfind; ++i) {
+        make_key(key, pfx, (mwc_rand64(&mwc) % nkeys) * 2 + (i & 1));
+        bn_skey_init(key, pfx + sizeof(u64), 0, &skey);
+
+        found += bn_find(tree, &skey, &kv);
+    }
+    rcu_read_unlock();
+
+    if (found != nfind / 2)
+        fprintf(stderr, "found %lu of %lu keys\n", found, nfind / 2);
+
+    return (get_time_ns() - tstart) / (double)nfind;
+}
+
+static int
+run_perf(unsigned int pfx, unsigned long nkeys)
+{
+    struct bonsai_root *tree;
+    struct bonsai_skey  skey;
+    struct bonsai_sval  sval;
+    struct cheap *      cheap;
+    unsigned long       i;
+    double              bonsai_ns, index_ns;
+    u64                 key[8], tstart, build_ns;
+    merr_t              err;
+
+    cheap = cheap_create(16, nkeys * 512);
+    if (!cheap)
+        return -1;
+
+    err = bn_create(cheap, 32 * 1024, insert_cb, NULL, &tree);
+    if (err) {
+        cheap_destroy(cheap);
+        return -1;
+    }
+
+    /* Insert the even keys in a scrambled order so that the kvs are
+     * scattered throughout the cheap, as they are in c0.
+     */
+    for (i = 0; i < nkeys; ++i) {
+        make_key(key, pfx, ((i * 2654435761ul) % nkeys) * 2);
+        bn_skey_init(key, pfx + sizeof(u64), 0, &skey);
+        bn_sval_init(key, sizeof(u64), HSE_ORDNL_TO_SQNREF(i), &sval);
+
+        err = bn_insert_or_replace(tree, &skey, &sval, false);
+        if (err) {
+            fprintf(stderr, "insert failed: %d\n", merr_errno(err));
+            break;
+        }
+    }
+
+    bn_finalize(tree);
+
+    bonsai_ns = run_find(tree, pfx, nkeys, nkeys);
+
+    tstart = get_time_ns();
+    err = bn_index_build(tree);
+    build_ns = get_time_ns() - tstart;
+
+    index_ns = err ? 0 : run_find(tree, pfx, nkeys, nkeys);
+
+    printf(
+        "%8u %12lu %12.1f %12.1f %12.3f\n",
+        pfx,
+        nkeys,
+        bonsai_ns,
+        index_ns,
+        build_ns / 1000000.0);
+
+    bn_destroy(tree);
+    cheap_destroy(cheap);
+
+    return err ? -1 : 0;
+}
+
+void
+usage(void)
+{
+    fprintf(stderr, "Usage: [-n nkeys]\n");
+}
+
+int
+main(int argc, char *argv[])
+{
+    unsigned long nkeys = nkeys_dflt;
+    unsigned long n;
+    int           opt;
+
+    while ((opt = getopt(argc, argv, "n:h")) != -1) {
+        switch (opt) {
+            case 'n':
+                nkeys = strtoul(optarg, NULL, 0);
+                break;
+            case 'h':
+            default:
+                usage();
+                exit(opt == 'h' ? 0 : -1);
+        }
+    }
+
+    printf("\n# bn_find() latency, bonsai tree vs wide-node index\n");
+    printf("%8s %12s %12s %12s %12s\n", "pfxlen", "keys", "bonsai_ns", "index_ns", "build_ms");
+
+    for (n = 1024; n <= nkeys; n *= 16) {
+        if (run_perf(0, n) || run_perf(24, n))
+            return -1;
+    }
+
+#ifndef NDEBUG
+    printf("\nNote: this is a debug build. "
+           "Use a release build for better performance.\n\n");
+#endif
+
+    return 0;
+}
@@ -1617,6 +1617,242 @@ MTF_DEFINE_UTEST_PREPOST(bonsai_tree_test, original, no_fail_pre, no_fail_post)
     bonsai_original_test(HSE_ALLOC_CURSOR, lcl_ti);
 }
 
+MTF_DEFINE_UTEST_PREPOST(bonsai_tree_test, split_keys, no_fail_pre, no_fail_post)
+{
+    const int           LEN = 4096;
+    struct bonsai_root *tree;
+    struct bonsai_skey  skey = { 0 };
+    struct bonsai_sval  sval = { 0 };
+    struct bonsai_kv *  kvv[15];
+    u64                 key, prev;
+    uint                kvc, i;
+    merr_t              err;
+
+    init_tree(&tree, HSE_ALLOC_CURSOR);
+    ASSERT_NE(NULL, tree);
+
+    rcu_read_lock();
+    kvc = bn_split_keys(tree, 4, kvv);
+    ASSERT_EQ(0, kvc);
+    rcu_read_unlock();
+
+    for (i = 0; i < LEN; ++i) {
+        key = cpu_to_be64(i);
+
+        bn_skey_init(&key, sizeof(key), 0, &skey);
+        bn_sval_init(&key, sizeof(key), HSE_ORDNL_TO_SQNREF(1), &sval);
+
+        rcu_read_lock();
+        err = bn_insert_or_replace(tree, &skey, &sval, false);
+        rcu_read_unlock();
+        ASSERT_EQ(0, err);
+    }
+
+    /* The top four levels of a balanced tree yield 15 ascending keys
+     * that divide it into 16 parts of roughly LEN / 16 keys each.
+     */
+    rcu_read_lock();
+    kvc = bn_split_keys(tree, 4, kvv);
+    ASSERT_EQ(NELEM(kvv), kvc);
+
+    prev = 0;
+    for (i = 0; i < kvc; ++i) {
+        memcpy(&key, kvv[i]->bkv_key, sizeof(key));
+        key = be64_to_cpu(key);
+
+        ASSERT_GT(key, prev);
+        ASSERT_LT(key - prev, LEN / 8);
+        prev = key;
+    }
+    ASSERT_LT(LEN - prev, LEN / 8);
+    rcu_read_unlock();
+
+    bn_destroy(tree);
+    cheap_destroy(cheap);
+    cheap = NULL;
+}
+
+static void
+wide_index_key(char *key, uint *klenp, uint pfx, uint fill, uint group, u32 v)
+{
+    u32 hi = cpu_to_be32(v / group);
+    u32 lo = cpu_to_be32(v);
+
+    memset(key, 'p', pfx);
+    memcpy(key + pfx, &hi, sizeof(hi));
+    memset(key + pfx + sizeof(hi), 'f', fill);
+    memcpy(key + pfx + sizeof(hi) + fill, &lo, sizeof(lo));
+
+    *klenp = pfx + sizeof(hi) + fill + sizeof(lo);
+}
+
+MTF_DEFINE_UTEST_PREPOST(bonsai_tree_test, wide_index, no_fail_pre, no_fail_post)
+{
+    const uint          LEN = 3000;
+    const uint          pfxv[] = { 0, 32, 32 };
+    const uint          fillv[] = { 0, 0, 8 };
+    const uint          groupv[] = { 1, 1, 8 };
+    struct bonsai_kv ** expv;
+    struct bonsai_root *tree;
+    struct bonsai_skey  skey = { 0 };
+    struct bonsai_sval  sval = { 0 };
+    struct bonsai_kv *  kv;
+    char                key[64];
+    uint                klen, skidx, v, t;
+    merr_t              err;
+
+    expv = calloc((LEN * 2 + 2) * 3, sizeof(*expv));
+    ASSERT_NE(NULL, expv);
+
+    /* Keys with distinct first words and several skidxs, keys with a
+     * long common prefix, and keys with runs of identical index words.
+     * Odd values are present, even values are not.
+     */
+    for (t = 0; t < NELEM(pfxv); ++t) {
+        init_tree(&tree, HSE_ALLOC_CURSOR);
+        ASSERT_NE(NULL, tree);
+
+        for (v = 1; v < LEN * 2; v += 2) {
+            wide_index_key(key, &klen, pfxv[t], fillv[t], groupv[t], v);
+            skidx = t ? 0 : (v / 2) % 3;
+
+            bn_skey_init(key, klen, skidx, &skey);
+            bn_sval_init(key, klen, HSE_ORDNL_TO_SQNREF(1), &sval);
+
+            rcu_read_lock();
+            err = bn_insert_or_replace(tree, &skey, &sval, false);
+            rcu_read_unlock();
+            ASSERT_EQ(0, err);
+        }
+
+        bn_finalize(tree);
+
+        rcu_read_lock();
+        for (v = 0; v < LEN * 2 + 2; ++v) {
+            wide_index_key(key, &klen, pfxv[t], fillv[t], groupv[t], v);
+            skidx = t ? 0 : (v / 2) % 3;
+            bn_skey_init(key, klen, skidx, &skey);
+
+            expv[v * 3] = bn_find(tree, &skey, &kv) ? kv : NULL;
+            expv[v * 3 + 1] = bn_findGE(tree, &skey, &kv) ? kv : NULL;
+            expv[v * 3 + 2] = bn_findLE(tree, &skey, &kv) ? kv : NULL;
+
+            ASSERT_EQ(v % 2 && v < LEN * 2, !!expv[v * 3]);
+        }
+        rcu_read_unlock();
+
+        err = bn_index_build(tree);
+        ASSERT_EQ(0, err);
+        ASSERT_NE(NULL, tree->br_index);
+
+        /* The index must yield exactly what the tree did.
+         */
+        rcu_read_lock();
+        for (v = 0; v < LEN * 2 + 2; ++v) {
+            wide_index_key(key, &klen, pfxv[t], fillv[t], groupv[t], v);
+            skidx = t ? 0 : (v / 2) % 3;
+            bn_skey_init(key, klen, skidx, &skey);
+
+            ASSERT_EQ(expv[v * 3], bn_find(tree, &skey, &kv) ? kv : NULL);
+            ASSERT_EQ(expv[v * 3 + 1], bn_findGE(tree, &skey, &kv) ? kv : NULL);
+            ASSERT_EQ(expv[v * 3 + 2], bn_findLE(tree, &skey, &kv) ? kv : NULL);
+        }
+        rcu_read_unlock();
+
+        bn_reset(tree);
+        ASSERT_EQ(NULL, tree->br_index);
+
+        bn_destroy(tree);
+        cheap_destroy(cheap);
+        cheap = NULL;
+    }
+
+    free(expv);
+}
+
+MTF_DEFINE_UTEST_PREPOST(bonsai_tree_test, split_prefix, no_fail_pre, no_fail_post)
+{
+    const uint          LEN = 3000;
+    const uint          pfxv[] = { 13, 30 };
+    struct bonsai_root *tree;
+    struct bonsai_skey  skey = { 0 };
+    struct bonsai_sval  sval = { 0 };
+    struct bonsai_kv *  kv, *prev;
+    char                key[64], pfx[64], kbuf[64];
+    uint                klen, v, t, n;
+    merr_t              err;
+
+    /* Odd keys are inserted with their prefix stored out of line, even
+     * keys are probed with contiguous keys both before and after the
+     * index is built.
+     */
+    for (t = 0; t < NELEM(pfxv); ++t) {
+        init_tree(&tree, HSE_ALLOC_CURSOR);
+        ASSERT_NE(NULL, tree);
+
+        wide_index_key(pfx, &klen, pfxv[t], 0, 1, 0);
+
+        for (v = 1; v < LEN * 2; v += 2) {
+            wide_index_key(key, &klen, pfxv[t], 0, 1, v);
+
+            bn_skey_init(key, klen, 0, &skey);
+            bn_skey_pfx(&skey, pfx, pfxv[t]);
+            bn_sval_init(key, klen, HSE_ORDNL_TO_SQNREF(1), &sval);
+
+            rcu_read_lock();
+            err = bn_insert_or_replace(tree, &skey, &sval, false);
+            rcu_read_unlock();
+            ASSERT_EQ(0, err);
+        }
+
+        for (n = 0; n < 2; ++n) {
+            if (n) {
+                err = bn_index_build(tree);
+                ASSERT_EQ(0, err);
+            } else {
+                bn_finalize(tree);
+            }
+
+            rcu_read_lock();
+            for (v = 0; v < LEN * 2 + 2; ++v) {
+                wide_index_key(key, &klen, pfxv[t], 0, 1, v);
+                bn_skey_init(key, klen, 0, &skey);
+
+                ASSERT_EQ(v % 2 && v < LEN * 2, bn_find(tree, &skey, &kv));
+
+                if (bn_findGE(tree, &skey, &kv)) {
+                    wide_index_key(key, &klen, pfxv[t], 0, 1, v | 1);
+                    ASSERT_EQ(pfxv[t], kv->bkv_pfx_len);
+                    ASSERT_EQ(klen, key_imm_klen(&kv->bkv_key_imm));
+                    ASSERT_EQ(0, memcmp(bn_kv_key(kv, kbuf), key, klen));
+                } else {
+                    ASSERT_GE(v, LEN * 2);
+                }
+            }
+            rcu_read_unlock();
+        }
+
+        /* The kv list must be in key order.
+         */
+        rcu_read_lock();
+        prev = NULL;
+        n = 0;
+        for (kv = rcu_dereference(tree->br_kv.bkv_next); kv != &tree->br_kv;
+             kv = rcu_dereference(kv->bkv_next)) {
+            if (prev)
+                ASSERT_LT(bn_kv_cmp(prev, kv), 0);
+            prev = kv;
+            ++n;
+        }
+        ASSERT_EQ(LEN, n);
+        rcu_read_unlock();
+
+        bn_destroy(tree);
+        cheap_destroy(cheap);
+        cheap = NULL;
+    }
+}
+
 MTF_DEFINE_UTEST_PREPOST(bonsai_tree_test, complicated, no_fail_pre, no_fail_post)
 {
     enum { LEN = 349 };
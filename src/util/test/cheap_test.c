@@ -497,4 +497,76 @@ MTF_DEFINE_UTEST(cheap_test, cheap_test_trim)
     cheap_destroy(h);
 }
 
+MTF_DEFINE_UTEST(cheap_test, cheap_test_bind)
+{
+    struct cheap *h;
+    merr_t        err;
+    char *        p;
+
+    h = cheap_create(0, 4 << 20);
+    ASSERT_NE(NULL, h);
+
+    p = cheap_malloc(h, PAGE_SIZE * 4);
+    ASSERT_NE(NULL, p);
+    memset(p, 0xa5, PAGE_SIZE * 4);
+
+    /* Node 0 always exists, resident pages must survive migration.
+     */
+    err = cheap_bind(h, 0);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(0xa5, (u8)p[PAGE_SIZE * 3]);
+
+    err = cheap_bind(h, -1);
+    ASSERT_EQ(0, err);
+
+    err = cheap_bind(h, 64);
+    ASSERT_EQ(EINVAL, merr_errno(err));
+
+    p = cheap_malloc(h, PAGE_SIZE);
+    ASSERT_NE(NULL, p);
+
+    cheap_destroy(h);
+}
+
+MTF_DEFINE_UTEST(cheap_test, cheap_test_huge)
+{
+    size_t        mapped, hugetlb, thp;
+    size_t        mapped0, hugetlb0, thp0;
+    struct cheap *h;
+    uint          huge;
+    char *        p;
+
+    cheap_huge_stats(&mapped0, &hugetlb0, &thp0);
+
+    /* Huge pages may not be available, in which case the cheap must
+     * fall back to a smaller page size but otherwise work normally.
+     */
+    for (huge = CHEAP_HUGE_NONE; huge <= CHEAP_HUGE_1G; ++huge) {
+        h = cheap_create_huge(16, 8 << 20, huge);
+        ASSERT_NE(NULL, h);
+        ASSERT_LE(h->huge, huge);
+        ASSERT_GE(h->memsz, 8 << 20);
+
+        if (h->huge != CHEAP_HUGE_NONE)
+            ASSERT_EQ(0, (uintptr_t)h->mem % (2 << 20));
+
+        cheap_huge_stats(&mapped, &hugetlb, &thp);
+        ASSERT_EQ(mapped0 + h->memsz, mapped);
+        ASSERT_EQ(hugetlb0 + (h->huge >= CHEAP_HUGE_2M ? h->memsz : 0), hugetlb);
+        ASSERT_EQ(thp0 + (h->huge == CHEAP_HUGE_THP ? h->memsz : 0), thp);
+
+        p = cheap_malloc(h, 4 << 20);
+        ASSERT_NE(NULL, p);
+        memset(p, 0xa5, 4 << 20);
+
+        cheap_trim(h, 0);
+        cheap_destroy(h);
+
+        cheap_huge_stats(&mapped, &hugetlb, &thp);
+        ASSERT_EQ(mapped0, mapped);
+        ASSERT_EQ(hugetlb0, hugetlb);
+        ASSERT_EQ(thp0, thp);
+    }
+}
+
 MTF_END_UTEST_COLLECTION(cheap_test)
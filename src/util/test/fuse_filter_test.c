@@ -0,0 +1,147 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2015-2020 Micron Technology, Inc.  All rights reserved.
+ */
+
+#include <hse_ut/framework.h>
+
+#include <hse_util/fuse_filter.h>
+#include <hse_util/hse_err.h>
+#include <hse_util/alloc.h>
+#include <hse_util/slab.h>
+
+#include <hse_test_support/mwc_rand.h>
+
+static bool
+ff_lookup(struct fuse_filter *ff, u64 hash)
+{
+    return fuse_lookup(hash, ff->ff_fpv, ff->ff_seed, ff->ff_segcntlen, ff->ff_seglen, ff->ff_fpbits);
+}
+
+/* Build a filter over n random hashes, every dupmod'th of which repeats
+ * its predecessor, and check that all are found.  Returns the number
+ * of false positives among n other random hashes.
+ */
+static int
+ff_build_check(u32 n, u32 fpbits, u32 dupmod, u32 *fpcp)
+{
+    struct fuse_filter ff;
+    struct mwc_rand    mwc;
+    u64 *              hashv, *savev;
+    u8 *               fpv;
+    size_t             sz;
+    merr_t             err;
+    u32                i, fpc;
+
+    sz = fuse_size_estimate(n, fpbits);
+
+    fpv = malloc(sz + 1);
+    hashv = malloc(sizeof(*hashv) * (n + 1));
+    savev = malloc(sizeof(*savev) * (n + 1));
+    if (!fpv || !hashv || !savev)
+        return -1;
+
+    mwc_rand_init(&mwc, n);
+    for (i = 0; i < n; ++i)
+        hashv[i] = (dupmod && i > 0 && i % dupmod == 0) ? hashv[i - 1] : mwc_rand64(&mwc);
+    memcpy(savev, hashv, sizeof(*hashv) * n);
+
+    err = fuse_filter_init(&ff, n, fpbits, fpv, sz);
+    if (err)
+        return -1;
+
+    err = fuse_filter_build(&ff, hashv, n);
+    if (err)
+        return -1;
+
+    for (i = 0; i < n; ++i)
+        if (!ff_lookup(&ff, savev[i]))
+            return -1;
+
+    for (i = fpc = 0; i < n; ++i)
+        fpc += ff_lookup(&ff, mwc_rand64(&mwc));
+
+    *fpcp = fpc;
+
+    free(savev);
+    free(hashv);
+    free(fpv);
+
+    return 0;
+}
+
+MTF_BEGIN_UTEST_COLLECTION(fuse_filter_test);
+
+MTF_DEFINE_UTEST(fuse_filter_test, Params)
+{
+    struct fuse_filter ff;
+    u8                 buf[64];
+    merr_t             err;
+    u32                n;
+
+    ASSERT_EQ(8, fuse_fpbits_est(10000));
+    ASSERT_EQ(8, fuse_fpbits_est(1000000 / 256));
+    ASSERT_EQ(16, fuse_fpbits_est(1000));
+
+    err = fuse_filter_init(&ff, 10, 12, buf, sizeof(buf));
+    ASSERT_EQ(EINVAL, merr_errno(err));
+
+    err = fuse_filter_init(&ff, 1000, 8, buf, sizeof(buf));
+    ASSERT_EQ(EINVAL, merr_errno(err));
+
+    /* A fuse filter needs about 9 (18) bits per element, a bit more
+     * for small sets.
+     */
+    for (n = 1000; n <= 1000 * 1000; n *= 10) {
+        size_t sz8 = fuse_size_estimate(n, 8);
+        size_t sz16 = fuse_size_estimate(n, 16);
+
+        ASSERT_EQ(sz8 * 2, sz16);
+        ASSERT_LT(sz8 * 8, n * 12);
+
+        ASSERT_LE(fuse_size_estimate(fuse_element_estimate(sz8, 8), 8), sz8);
+        ASSERT_GT(fuse_size_estimate(fuse_element_estimate(sz8, 8) + 1, 8), sz8);
+        ASSERT_LE(n, fuse_element_estimate(sz8, 8));
+    }
+}
+
+MTF_DEFINE_UTEST(fuse_filter_test, Lookup8)
+{
+    u32 n, fpc;
+    int rc;
+
+    for (n = 0; n < 1000 * 1000; n = n * 3 + 1) {
+        rc = ff_build_check(n, 8, 0, &fpc);
+        ASSERT_EQ(0, rc);
+
+        /* Expect 1/256, allow some slack for small samples. */
+        ASSERT_LE(fpc, n / 128 + 4);
+    }
+}
+
+MTF_DEFINE_UTEST(fuse_filter_test, Lookup16)
+{
+    u32 n, fpc;
+    int rc;
+
+    for (n = 0; n < 1000 * 1000; n = n * 3 + 1) {
+        rc = ff_build_check(n, 16, 0, &fpc);
+        ASSERT_EQ(0, rc);
+
+        ASSERT_LE(fpc, n / 16384 + 4);
+    }
+}
+
+MTF_DEFINE_UTEST(fuse_filter_test, Duplicates)
+{
+    u32 fpc;
+    int rc;
+
+    rc = ff_build_check(100 * 1000, 8, 10, &fpc);
+    ASSERT_EQ(0, rc);
+
+    rc = ff_build_check(100 * 1000, 16, 2, &fpc);
+    ASSERT_EQ(0, rc);
+}
+
+MTF_END_UTEST_COLLECTION(fuse_filter_test)